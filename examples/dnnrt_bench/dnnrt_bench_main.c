@@ -0,0 +1,300 @@
+/****************************************************************************
+ * dnnrt_bench/dnnrt_bench_main.c
+ *
+ *   Copyright 2018 Sony Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Corporation nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <nuttx/config.h>
+#include <dnnrt/runtime.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+#define DNN_NNB_PATH    "/mnt/sd0/lenet-5/model/lenet-5.nnb"
+#define DNN_MAX_CPUS    (6)
+#define DNN_MAX_INPUTS  (4)
+#define DNN_MAX_LAYERS  (64)
+#define DNN_LOOPS       (10)
+
+/****************************************************************************
+ * Type Definition
+ ****************************************************************************/
+typedef struct
+  {
+    char *nnb_path;
+    int max_cpus;
+    int loops;
+    unsigned long cache_bsize;
+  } my_setting_t;
+
+typedef struct
+  {
+    int layer_num;
+    dnn_profile_t layer[DNN_MAX_LAYERS];
+    unsigned long total_usec;
+  } my_result_t;
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+static my_result_t s_result[DNN_MAX_CPUS];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+static int input_bsize(dnn_runtime_t * rt, unsigned char index)
+{
+  nn_variable_t *var = dnn_runtime_input_variable(rt, index);
+  int size = dnn_runtime_input_size(rt, index);
+
+  if (var->type == NN_DATA_TYPE_FLOAT)
+    {
+      return size * sizeof(float);
+    }
+  else if (var->type == NN_DATA_TYPE_INT16)
+    {
+      return size * sizeof(int16_t);
+    }
+  return size * sizeof(int8_t);
+}
+
+static const char *function_name(unsigned short function)
+{
+  switch (function)
+    {
+      case NN_FUNCTION_CONVOLUTION:
+        return "Convolution";
+      case NN_FUNCTION_DEPTHWISE_CONVOLUTION:
+        return "DWConv";
+      case NN_FUNCTION_AFFINE:
+        return "Affine";
+      case NN_FUNCTION_RELU:
+        return "ReLU";
+      case NN_FUNCTION_MAX_POOLING:
+        return "MaxPooling";
+      case NN_FUNCTION_AVERAGE_POOLING:
+        return "AvgPooling";
+      case NN_FUNCTION_SOFTMAX:
+        return "Softmax";
+      default:
+        return "Unknown";
+    }
+}
+
+static float speedup(unsigned long base, unsigned long usec)
+{
+  return usec ? (float)base / (float)usec : 0.0f;
+}
+
+/* run inference "loops" times on cpu_num CPUs, and keep the average
+ * end-to-end time and per-layer time of the last run in result */
+
+static int run_bench(nn_network_t * network, int cpu_num, int loops,
+                     my_result_t * result)
+{
+  int ret, i, input_num;
+  void *inputs[DNN_MAX_INPUTS] = { 0 };
+  dnn_config_t config = { .cpu_num = cpu_num };
+  dnn_runtime_t rt;
+  struct timeval begin, end;
+
+  ret = dnn_initialize(&config);
+  if (ret)
+    {
+      printf("dnn_initialize(cpu_num=%d) failed due to %d\n", cpu_num, ret);
+      return ret;
+    }
+
+  ret = dnn_runtime_initialize(&rt, network);
+  if (ret)
+    {
+      printf("dnn_runtime_initialize() failed due to %d\n", ret);
+      goto rt_error;
+    }
+
+  /* all-zero inputs, as time does not depend on values */
+  input_num = dnn_runtime_input_num(&rt);
+  if (input_num > DNN_MAX_INPUTS)
+    {
+      ret = -EINVAL;
+      goto fin;
+    }
+  for (i = 0; i < input_num; i++)
+    {
+      inputs[i] = calloc(1, input_bsize(&rt, i));
+      if (inputs[i] == NULL)
+        {
+          ret = -ENOMEM;
+          goto fin;
+        }
+    }
+
+  /* warm-up */
+  ret = dnn_runtime_forward(&rt, (const void **)inputs, input_num);
+  if (ret)
+    {
+      printf("dnn_runtime_forward() failed due to %d\n", ret);
+      goto fin;
+    }
+
+  gettimeofday(&begin, 0);
+  for (i = 0; i < loops && ret == 0; i++)
+    {
+      ret = dnn_runtime_forward(&rt, (const void **)inputs, input_num);
+    }
+  gettimeofday(&end, 0);
+
+  result->total_usec = ((end.tv_sec - begin.tv_sec) * 1000000 +
+                        (end.tv_usec - begin.tv_usec)) / loops;
+  result->layer_num = dnn_runtime_profile(&rt, result->layer,
+                                          DNN_MAX_LAYERS);
+
+fin:
+  for (i = 0; i < DNN_MAX_INPUTS; i++)
+    {
+      free(inputs[i]);
+    }
+  dnn_runtime_finalize(&rt);
+rt_error:
+  dnn_finalize();
+  return ret;
+}
+
+static void print_result(int cpu_num)
+{
+  my_result_t *base = &s_result[0];
+  my_result_t *r = &s_result[cpu_num - 1];
+  int i;
+
+  printf("==== %d CPU(s) ====\n", cpu_num);
+  printf("layer function     split       usec  speedup\n");
+  for (i = 0; i < r->layer_num; i++)
+    {
+      unsigned long base_usec = (i < base->layer_num) ?
+        base->layer[i].usec : 0;
+
+      printf("%5d %-12s %5u %10lu  x%.2f\n", i,
+             function_name(r->layer[i].function), r->layer[i].cpu_num,
+             r->layer[i].usec, speedup(base_usec, r->layer[i].usec));
+    }
+  printf("total                    %10lu  x%.2f\n", r->total_usec,
+         speedup(base->total_usec, r->total_usec));
+}
+
+static void parse_args(int argc, char *argv[], my_setting_t * setting)
+{
+  /* parse options by getopt() */
+  int opt;
+  while ((opt = getopt(argc, argv, "c:n:m:")) != -1)
+    {
+      switch (opt)
+        {
+          case 'c': /* maximum number of CPUs */
+            setting->max_cpus = atoi(optarg);
+            break;
+          case 'n': /* number of inferences to average */
+            setting->loops = atoi(optarg);
+            break;
+          case 'm': /* KiB of RAM to cache parameters read from nnb */
+            setting->cache_bsize = strtoul(optarg, NULL, 10) * 1024;
+            break;
+        }
+    }
+
+  if (setting->max_cpus < 1 || setting->max_cpus > DNN_MAX_CPUS)
+    {
+      setting->max_cpus = DNN_MAX_CPUS;
+    }
+  if (setting->loops < 1)
+    {
+      setting->loops = DNN_LOOPS;
+    }
+  setting->nnb_path = (optind < argc) ? argv[optind] : DNN_NNB_PATH;
+
+  printf("Load nnb file: %s\n", setting->nnb_path);
+  printf("CPUs: 1 - %d, loops: %d\n", setting->max_cpus, setting->loops);
+  if (setting->cache_bsize)
+    {
+      printf("Parameter cache: %lu bytes\n", setting->cache_bsize);
+    }
+}
+
+/****************************************************************************
+ * dnnrt_bench_main
+ ****************************************************************************/
+#ifdef CONFIG_BUILD_KERNEL
+int main(int argc, FAR char *argv[])
+#else
+int dnnrt_bench_main(int argc, char *argv[])
+#endif
+{
+  int cpu_num;
+  int ret;
+  dnn_nnb_t nnb;
+  dnn_nnb_config_t config = { 0 };
+  my_setting_t setting = { 0 };
+
+  parse_args(argc, argv, &setting);
+
+  /* with -m, parameters are read from nnb on demand into a cache of
+   * the given size instead of reading whole nnb into RAM
+   */
+  config.cache_bsize = setting.cache_bsize;
+  ret = dnn_nnb_open(&nnb, setting.nnb_path, &config);
+  if (ret)
+    {
+      printf("load nnb file failed due to %d\n", ret);
+      return ret;
+    }
+
+  /* 1 CPU is the baseline of speedup */
+  for (cpu_num = 1; cpu_num <= setting.max_cpus; cpu_num++)
+    {
+      if (run_bench(nnb.network, cpu_num, setting.loops,
+                    &s_result[cpu_num - 1]) != 0)
+        {
+          break;
+        }
+      print_result(cpu_num);
+    }
+
+  dnn_nnb_close(&nnb);
+  return 0;
+}
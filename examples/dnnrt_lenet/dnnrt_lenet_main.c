@@ -42,7 +42,6 @@
 #include <sys/time.h>
 #include <nuttx/config.h>
 #include <dnnrt/runtime.h>
-#include "loader_nnb.h"
 #include "pnm_util.h"
 
 /****************************************************************************
@@ -145,7 +144,7 @@ int dnnrt_lenet_main(int argc, char *argv[])
   float *output_buffer, proc_time, norm_factor;
   const void *inputs[1] = { s_img_buffer };
   dnn_runtime_t rt;
-  nn_network_t *network;
+  dnn_nnb_t nnb;
   my_setting_t setting = { 0 };
   struct timeval begin, end;
 
@@ -161,12 +160,12 @@ int dnnrt_lenet_main(int argc, char *argv[])
       goto pgm_error;
     }
 
-  /* load an nnb file, which holds a network structure and weight values,
-     into a heap memory */
-  network = alloc_nnb_network(setting.nnb_path);
-  if (network == NULL)
+  /* open an nnb file, which holds a network structure and weight values.
+     it is read into a heap memory unless the file system can map it */
+  ret = dnn_nnb_open(&nnb, setting.nnb_path, NULL);
+  if (ret)
     {
-      printf("load nnb file failed\n");
+      printf("load nnb file failed due to %d\n", ret);
       goto pgm_error;
     }
 
@@ -180,7 +179,7 @@ int dnnrt_lenet_main(int argc, char *argv[])
 
   /* Step-B: instantiate a neural network defined
              by nn_network_t as a dnn_runtime_t object */
-  ret = dnn_runtime_initialize(&rt, network);
+  ret = dnn_runtime_initialize(&rt, nnb.network);
   if (ret)
     {
       printf("dnn_runtime_initialize() failed due to %d\n", ret);
@@ -220,8 +219,8 @@ rt_error:
   /* Step-G: finalize the whole dnnrt subsystem */
   dnn_finalize();
 dnn_error:
-  /* just call free() */
-  destroy_nnb_network(network);
+  /* free the network read by dnn_nnb_open() */
+  dnn_nnb_close(&nnb);
 pgm_error:
   return ret;
 }
@@ -47,6 +47,7 @@
 #include <arch/chip/pm.h>
 #include "apus/dsp_audio_version.h"
 #include "wien2_internal_packet.h"
+#include "debug/audio_trace.h"
 
 #define DBG_MODULE DBG_MODULE_AS
 
@@ -84,6 +85,59 @@ static void get_time(uint64_t *time)
 }
 #endif
 
+/*--------------------------------------------------------------------*/
+static bool get_dsp_image(AudioCodec codec,
+                          FAR const char *path,
+                          FAR char *filepath,
+                          size_t size,
+                          FAR uint32_t *dsp_version)
+{
+  switch (codec)
+    {
+      case AudCodecMP3:
+        snprintf(filepath, size, "%s/MP3DEC", path);
+        *dsp_version = DSP_MP3DEC_VERSION;
+        break;
+
+      case AudCodecLPCM:
+        snprintf(filepath, size, "%s/WAVDEC", path);
+        *dsp_version = DSP_WAVDEC_VERSION;
+        break;
+
+      case AudCodecAAC:
+        snprintf(filepath, size, "%s/AACDEC", path);
+        *dsp_version = DSP_AACDEC_VERSION;
+        break;
+
+      case AudCodecOPUS:
+        snprintf(filepath, size, "%s/OPUSDEC", path);
+        *dsp_version = DSP_OPUSDEC_VERSION;
+        break;
+
+      default:
+        return false;
+    }
+
+  return true;
+}
+
+/*--------------------------------------------------------------------*/
+static uint32_t get_decoder_delay(AudioCodec codec)
+{
+  /* Samples (of input rate) by which decoded PCM lags behind ES.
+   * Only known for MP3 (synthesis filterbank and overlap of IMDCT).
+   */
+
+  switch (codec)
+    {
+      case AudCodecMP3:
+        return 529;
+
+      default:
+        return 0;
+    }
+}
+
 extern "C" {
 /*--------------------------------------------------------------------
     C Interface
@@ -104,6 +158,21 @@ uint32_t AS_decode_init(const InitDecCompParam *param,
   return ((DecoderComponent *)p_instance)->init_apu(*param, dsp_inf);
 }
 
+/*--------------------------------------------------------------------*/
+bool AS_decode_get_output(OutDecCompParam *param, void *p_instance)
+{
+  /* Parameter check */
+
+  if (param == NULL || p_instance == NULL)
+    {
+      return false;
+    }
+
+  ((DecoderComponent *)p_instance)->get_output(param);
+
+  return true;
+}
+
 /*--------------------------------------------------------------------*/
 bool AS_decode_exec(const ExecDecCompParam *param, void *p_instance)
 {
@@ -200,6 +269,61 @@ bool AS_decode_deactivate(void *p_instance)
   return false;
 }
 
+/*--------------------------------------------------------------------*/
+uint32_t AS_decode_preload(AudioCodec codec, FAR const char *path)
+{
+  char filepath[64];
+  uint32_t dsp_version;
+
+  if (!get_dsp_image(codec, path, filepath, sizeof(filepath), &dsp_version))
+    {
+      DECODER_ERR(AS_ATTENTION_SUB_CODE_UNEXPECTED_PARAM);
+      return AS_ECODE_COMMAND_PARAM_CODEC_TYPE;
+    }
+
+#ifdef CONFIG_CPUFREQ_RELEASE_LOCK
+  g_decode_hvlock.count = 0;
+  g_decode_hvlock.info = PM_CPUFREQLOCK_TAG('D', 'C', 0x1199);
+  g_decode_hvlock.flag = PM_CPUFREQLOCK_FLAG_HV;
+
+  up_pm_acquire_freqlock(&g_decode_hvlock);
+#endif
+
+  int ret = DD_Preload(filepath);
+
+#ifdef CONFIG_CPUFREQ_RELEASE_LOCK
+  up_pm_release_freqlock(&g_decode_hvlock);
+#endif
+
+  if (ret == DSPDRV_NOT_SUPPORTED)
+    {
+      return AS_ECODE_COMMAND_NOT_SUPPOT;
+    }
+  else if (ret != DSPDRV_NOERROR)
+    {
+      logerr("DD_Preload(%s) failure. %d\n", filepath, ret);
+      DECODER_ERR(AS_ATTENTION_SUB_CODE_DSP_LOAD_ERROR);
+      return AS_ECODE_DSP_LOAD_ERROR;
+    }
+
+  return AS_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------*/
+bool AS_decode_purge(void)
+{
+  int ret = DD_Purge(NULL);
+
+  if (ret != DSPDRV_NOERROR && ret != DSPDRV_NOT_SUPPORTED)
+    {
+      logerr("DD_Purge() failure. %d\n", ret);
+      DECODER_ERR(AS_ATTENTION_SUB_CODE_DSP_UNLOAD_ERROR);
+      return false;
+    }
+
+  return true;
+}
+
 /*--------------------------------------------------------------------*/
 void cbRcvDspRes(void *p_response, void *p_instance)
 {
@@ -318,6 +442,12 @@ uint32_t DecoderComponent::init_apu(const InitDecCompParam& param,
   p_apu_cmd->init_dec_cmd.out_pcm_param.decoder_output_sample =
     param.frame_sample_num;
 
+  m_out_param.sampling_rate =
+    p_apu_cmd->init_dec_cmd.out_pcm_param.sampling_rate;
+  m_out_param.channel_num   = TwoChannels;
+  m_out_param.bit_width     = param.bit_width;
+  m_out_param.delay         = get_decoder_delay(param.codec_type);
+
   p_apu_cmd->init_dec_cmd.debug_dump_info.addr = NULL;
   p_apu_cmd->init_dec_cmd.debug_dump_info.size = 0;
 
@@ -371,10 +501,21 @@ uint32_t DecoderComponent::init_apu(const InitDecCompParam& param,
     }
 #endif
 
+#ifdef CONFIG_AUDIOUTILS_DECODER_TIME_MEASUREMENT
+  uint64_t init_start;
+  uint64_t init_end;
+  get_time(&init_start);
+#endif
+
   send_apu(p_apu_cmd);
 
   uint32_t rst = dsp_init_check(m_apu_mid, dsp_inf);
 
+#ifdef CONFIG_AUDIOUTILS_DECODER_TIME_MEASUREMENT
+  get_time(&init_end);
+  syslog(LOG_DEBUG, "DEC init time %08d ms\n", init_end - init_start);
+#endif
+
   return rst;
 }
 
@@ -398,6 +539,8 @@ bool DecoderComponent::exec_apu(const ExecDecCompParam& param)
   p_apu_cmd->exec_dec_cmd.output_buffer = param.output_buffer;
   p_apu_cmd->exec_dec_cmd.num_of_au     = param.num_of_au;
 
+  AUDIO_TRACE(AudioTraceDecReq, 0);
+
   send_apu(p_apu_cmd);
 
 #ifdef CONFIG_AUDIOUTILS_DECODER_TIME_MEASUREMENT
@@ -513,6 +656,11 @@ bool DecoderComponent::recv_apu(void *p_response)
       return true;
     }
 
+  if (Apu::ExecEvent == packet->header.event_type)
+    {
+      AUDIO_TRACE(AudioTraceDecDone, packet->result.exec_result);
+    }
+
 #ifdef CONFIG_AUDIOUTILS_DECODER_TIME_MEASUREMENT
   if (Apu::ExecEvent == packet->header.event_type)
     {
@@ -534,31 +682,14 @@ uint32_t DecoderComponent::activate(FAR ActDecCompParam *param)
 
   DECODER_DBG("ACT: codec %d\n", param);
 
-  switch (param->codec)
+  if (!get_dsp_image(param->codec,
+                     param->path,
+                     filepath,
+                     sizeof(filepath),
+                     &decoder_dsp_version))
     {
-      case AudCodecMP3:
-        snprintf(filepath, sizeof(filepath), "%s/MP3DEC", param->path);
-        decoder_dsp_version = DSP_MP3DEC_VERSION;
-        break;
-
-      case AudCodecLPCM:
-        snprintf(filepath, sizeof(filepath), "%s/WAVDEC", param->path);
-        decoder_dsp_version = DSP_WAVDEC_VERSION;
-        break;
-
-      case AudCodecAAC:
-        snprintf(filepath, sizeof(filepath), "%s/AACDEC", param->path);
-        decoder_dsp_version = DSP_AACDEC_VERSION;
-        break;
-
-      case AudCodecOPUS:
-        snprintf(filepath, sizeof(filepath), "%s/OPUSDEC", param->path);
-        decoder_dsp_version = DSP_OPUSDEC_VERSION;
-        break;
-
-      default:
-        DECODER_ERR(AS_ATTENTION_SUB_CODE_UNEXPECTED_PARAM);
-        return AS_ECODE_COMMAND_PARAM_CODEC_TYPE;
+      DECODER_ERR(AS_ATTENTION_SUB_CODE_UNEXPECTED_PARAM);
+      return AS_ECODE_COMMAND_PARAM_CODEC_TYPE;
     }
 
 #ifdef CONFIG_CPUFREQ_RELEASE_LOCK
@@ -571,9 +702,36 @@ uint32_t DecoderComponent::activate(FAR ActDecCompParam *param)
   up_pm_acquire_freqlock(&g_decode_hvlock);
 #endif
 
-  /* Load DSP */
+  /* Load DSP.
+   *
+   * Single core decoder reuses a resident worker of the image. Its codec
+   * state is carried over until init_apu(), whose InitEvent initializes
+   * the codec library again on the work buffer given then, so nothing
+   * of the former owner is used. Workers are made resident by
+   * deactivate() only after decoding is stopped.
+   *
+   * Master and slave of multi core decoder are the same image, but the
+   * master is bound to the cpu of its slave at InitEvent. They are
+   * always loaded anew and not kept resident, so that a worker never
+   * serves in the other role or with a slave which is gone.
+   */
 
-  int ret = DD_Load(filepath, cbRcvDspRes, (void*)this, &m_dsp_handler);
+  int ret;
+
+  if (param->dsp_multi_core)
+    {
+      ret = DD_Load(filepath,
+                    cbRcvDspRes,
+                    (void*)this,
+                    &m_dsp_handler);
+    }
+  else
+    {
+      ret = DD_LoadCached(filepath,
+                          cbRcvDspRes,
+                          (void*)this,
+                          &m_dsp_handler);
+    }
 
 #ifdef CONFIG_CPUFREQ_RELEASE_LOCK
   up_pm_release_freqlock(&g_decode_hvlock);
@@ -590,6 +748,16 @@ uint32_t DecoderComponent::activate(FAR ActDecCompParam *param)
 
   dsp_boot_check(m_apu_mid, param->dsp_inf);
 
+#ifdef CONFIG_AUDIOUTILS_DECODER_TIME_MEASUREMENT
+  DspDrvLoadTime_t load_time;
+  DD_GetLoadTime(m_dsp_handler, &load_time);
+  syslog(LOG_DEBUG, "DEC load %s time %d us boot %d us%s\n",
+         filepath,
+         load_time.load_us,
+         load_time.boot_us,
+         load_time.cached ? " (resident)" : "");
+#endif
+
   /* DSP version check */
 
   bool is_version_matched = true;
@@ -608,7 +776,10 @@ uint32_t DecoderComponent::activate(FAR ActDecCompParam *param)
 
   if (param->dsp_multi_core)
     {
-      ret = DD_Load(filepath, cbRcvDspRes, (void*)this, &m_dsp_slave_handler);
+      ret = DD_Load(filepath,
+                    cbRcvDspRes,
+                    (void*)this,
+                    &m_dsp_slave_handler);
       if (ret != DSPDRV_NOERROR)
         {
           logerr("DD_Load(%s) failure. %d\n", filepath, ret);
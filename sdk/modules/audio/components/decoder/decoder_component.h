@@ -75,6 +75,16 @@ struct InitDecCompParam
   bool             dsp_multi_core;
 };
 
+/* Format of decoded PCM, fixed by AS_decode_init(). */
+
+struct OutDecCompParam
+{
+  uint32_t         sampling_rate;
+  AudioChannelNum  channel_num;
+  AudioPcmBitWidth bit_width;
+  uint32_t         delay;  /* Decoder delay in samples of input rate */
+};
+
 struct ExecDecCompParam
 {
   BufferHeader input_buffer;
@@ -122,6 +132,8 @@ uint32_t AS_decode_init(const InitDecCompParam *param,
                         void *p_instance,
                         uint32_t *dsp_inf);
 
+bool AS_decode_get_output(OutDecCompParam *param, void *p_instance);
+
 bool AS_decode_exec(const ExecDecCompParam *param, void *p_instance);
 
 bool AS_decode_stop(const StopDecCompParam *param, void *p_instance);
@@ -136,6 +148,10 @@ uint32_t AS_decode_activate(FAR ActDecCompParam *param);
 
 bool AS_decode_deactivate(void *p_instance);
 
+uint32_t AS_decode_preload(AudioCodec codec, FAR const char *path);
+
+bool AS_decode_purge(void);
+
 } /* extern "C" */
 
 
@@ -147,10 +163,12 @@ public:
     m_apu_pool_id = apu_pool_id;
     m_apu_mid = apu_mid;
     m_dsp_slave_handler = NULL;
+    m_out_param = OutDecCompParam();
   }
   ~DecoderComponent() {}
 
   uint32_t init_apu(const InitDecCompParam& param, uint32_t *dsp_inf);
+  void get_output(OutDecCompParam *param) { *param = m_out_param; };
   bool exec_apu(const ExecDecCompParam& param);
   bool flush_apu(const StopDecCompParam& param);
   bool setparam_apu(const SetDecCompParam& param);
@@ -177,6 +195,8 @@ private:
 
   void *m_p_requester;
 
+  OutDecCompParam m_out_param;
+
 #ifdef CONFIG_AUDIOUTILS_DSP_DEBUG_DUMP
   DecDebugLogInfo m_debug_log_info;
 #endif
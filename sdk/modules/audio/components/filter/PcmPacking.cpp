@@ -0,0 +1,484 @@
+/****************************************************************************
+ * modules/audio/components/filter/PcmPacking.cpp
+ *
+ *   Copyright 2018 Sony Semiconductor Solutions Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Semiconductor Solutions Corporation nor
+ *    the names of its contributors may be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include <string.h>
+
+#include "common/PcmPacking.h"
+
+/* All kernels are for little endian data.
+ *
+ * Word kernels handle a group of 4 samples (or 2 for 16bit <-> 32bit)
+ * with 32bit loads and stores, and the samples left over are handed
+ * to the byte kernel.
+ */
+
+#define PCM_PACKING_ALIGNED(p)  ((reinterpret_cast<uintptr_t>(p) & 3) == 0)
+
+/*--------------------------------------------------------------------------*/
+static inline bool pcm_packing_is_unsigned(PcmPackingFormat fmt)
+{
+  return (fmt == PcmPackingU16 || fmt == PcmPackingU24 || fmt == PcmPackingU32);
+}
+
+/*--------------------------------------------------------------------------*/
+static void pcm_packing_bytes(const uint8_t *in,
+                              uint32_t in_bytes,
+                              uint8_t *out,
+                              uint32_t out_bytes,
+                              uint32_t samples)
+{
+  /* Keep upper bytes of each sample, and fill the rest with 0. */
+
+  uint32_t keep = (in_bytes < out_bytes) ? in_bytes : out_bytes;
+  uint32_t fill = out_bytes - keep;
+  uint32_t skip = in_bytes - keep;
+
+  for (uint32_t i = 0; i < samples; i++)
+    {
+      uint32_t j;
+
+      for (j = 0; j < fill; j++)
+        {
+          *out++ = 0;
+        }
+
+      in += skip;
+
+      for (j = 0; j < keep; j++)
+        {
+          *out++ = *in++;
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------*/
+static uint32_t pcm_packing_32to24(const uint32_t *in,
+                                   uint32_t *out,
+                                   uint32_t samples)
+{
+  uint32_t groups = samples / 4;
+
+  for (uint32_t i = 0; i < groups; i++)
+    {
+      uint32_t s0 = in[0];
+      uint32_t s1 = in[1];
+      uint32_t s2 = in[2];
+      uint32_t s3 = in[3];
+
+      out[0] = (s0 >> 8)  | ((s1 >> 8) << 24);
+      out[1] = (s1 >> 16) | ((s2 >> 8) << 16);
+      out[2] = (s2 >> 24) | (s3 & 0xFFFFFF00);
+
+      in  += 4;
+      out += 3;
+    }
+
+  return groups * 4;
+}
+
+/*--------------------------------------------------------------------------*/
+static uint32_t pcm_packing_24to32(const uint32_t *in,
+                                   uint32_t *out,
+                                   uint32_t samples)
+{
+  uint32_t groups = samples / 4;
+
+  for (uint32_t i = 0; i < groups; i++)
+    {
+      uint32_t w0 = in[0];
+      uint32_t w1 = in[1];
+      uint32_t w2 = in[2];
+
+      out[0] = w0 << 8;
+      out[1] = ((w0 >> 16) & 0x0000FF00) | (w1 << 16);
+      out[2] = ((w1 >> 8)  & 0x00FFFF00) | (w2 << 24);
+      out[3] = w2 & 0xFFFFFF00;
+
+      in  += 3;
+      out += 4;
+    }
+
+  return groups * 4;
+}
+
+/*--------------------------------------------------------------------------*/
+static uint32_t pcm_packing_32to16(const uint32_t *in,
+                                   uint32_t *out,
+                                   uint32_t samples)
+{
+  uint32_t pairs = samples / 2;
+
+  /* Upper halves of 2 samples into 1 word (PKHTB). */
+
+  for (uint32_t i = 0; i < pairs; i++)
+    {
+      out[i] = (in[0] >> 16) | (in[1] & 0xFFFF0000);
+      in += 2;
+    }
+
+  return pairs * 2;
+}
+
+/*--------------------------------------------------------------------------*/
+static uint32_t pcm_packing_16to32(const uint32_t *in,
+                                   uint32_t *out,
+                                   uint32_t samples)
+{
+  uint32_t pairs = samples / 2;
+
+  for (uint32_t i = 0; i < pairs; i++)
+    {
+      uint32_t w = in[i];
+
+      out[0] = w << 16;
+      out[1] = w & 0xFFFF0000;
+      out += 2;
+    }
+
+  return pairs * 2;
+}
+
+/*--------------------------------------------------------------------------*/
+static uint32_t pcm_packing_24to16(const uint32_t *in,
+                                   uint32_t *out,
+                                   uint32_t samples)
+{
+  uint32_t groups = samples / 4;
+
+  for (uint32_t i = 0; i < groups; i++)
+    {
+      uint32_t w0 = in[0];
+      uint32_t w1 = in[1];
+      uint32_t w2 = in[2];
+
+      out[0] = ((w0 >> 8) & 0x0000FFFF) | (w1 << 16);
+      out[1] = (w1 >> 24) | ((w2 << 8) & 0x0000FF00) | (w2 & 0xFFFF0000);
+
+      in  += 3;
+      out += 2;
+    }
+
+  return groups * 4;
+}
+
+/*--------------------------------------------------------------------------*/
+static uint32_t pcm_packing_16to24(const uint32_t *in,
+                                   uint32_t *out,
+                                   uint32_t samples)
+{
+  uint32_t groups = samples / 4;
+
+  for (uint32_t i = 0; i < groups; i++)
+    {
+      uint32_t w0 = in[0];
+      uint32_t w1 = in[1];
+
+      out[0] = (w0 << 8) & 0x00FFFF00;
+      out[1] = (w0 >> 16) | (w1 << 24);
+      out[2] = ((w1 >> 8) & 0x000000FF) | (w1 & 0xFFFF0000);
+
+      in  += 2;
+      out += 3;
+    }
+
+  return groups * 4;
+}
+
+/*--------------------------------------------------------------------------*/
+static void pcm_packing_toggle_sign(uint8_t *buf,
+                                    uint32_t bytes,
+                                    uint32_t samples)
+{
+  /* Flip MSB of each sample. 4 samples are "bytes" words. */
+
+  static const uint32_t s_mask[3][4] =
+  {
+    { 0x80008000, 0x80008000, 0,          0          },  /* 16bit */
+    { 0x00800000, 0x00008000, 0x80000080, 0          },  /* 24bit */
+    { 0x80000000, 0x80000000, 0x80000000, 0x80000000 },  /* 32bit */
+  };
+
+  uint32_t i = 0;
+
+  if (PCM_PACKING_ALIGNED(buf))
+    {
+      const uint32_t *mask = s_mask[bytes - 2];
+      uint32_t *p = reinterpret_cast<uint32_t *>(buf);
+      uint32_t words = bytes;
+      uint32_t groups = samples / 4;
+
+      for (uint32_t g = 0; g < groups; g++)
+        {
+          for (uint32_t w = 0; w < words; w++)
+            {
+              p[w] ^= mask[w];
+            }
+
+          p += words;
+        }
+
+      i = groups * 4;
+    }
+
+  for (; i < samples; i++)
+    {
+      buf[i * bytes + bytes - 1] ^= 0x80;
+    }
+}
+
+/*--------------------------------------------------------------------------*/
+uint32_t PcmPacking_bytesPerSample(PcmPackingFormat fmt)
+{
+  static const uint8_t s_bytes[PcmPackingFormatNum] = { 2, 2, 3, 3, 4, 4 };
+
+  return (fmt < PcmPackingFormatNum) ? s_bytes[fmt] : 0;
+}
+
+/*--------------------------------------------------------------------------*/
+uint32_t PcmPacking_convert(const void *in,
+                            PcmPackingFormat in_fmt,
+                            void *out,
+                            PcmPackingFormat out_fmt,
+                            uint32_t samples)
+{
+  uint32_t in_bytes  = PcmPacking_bytesPerSample(in_fmt);
+  uint32_t out_bytes = PcmPacking_bytesPerSample(out_fmt);
+
+  if (in_bytes == 0 || out_bytes == 0)
+    {
+      return 0;
+    }
+
+  const uint8_t *src = static_cast<const uint8_t *>(in);
+  uint8_t       *dst = static_cast<uint8_t *>(out);
+  uint32_t      done = 0;
+
+  if (in_bytes == out_bytes)
+    {
+      if (src != dst)
+        {
+          memmove(dst, src, samples * in_bytes);
+        }
+
+      done = samples;
+    }
+  else if (PCM_PACKING_ALIGNED(src) && PCM_PACKING_ALIGNED(dst))
+    {
+      uint32_t (*kernel)(const uint32_t *, uint32_t *, uint32_t) = NULL;
+
+      switch (in_bytes * 8 + out_bytes)
+        {
+          case 4 * 8 + 3:
+            kernel = pcm_packing_32to24;
+            break;
+
+          case 3 * 8 + 4:
+            kernel = pcm_packing_24to32;
+            break;
+
+          case 4 * 8 + 2:
+            kernel = pcm_packing_32to16;
+            break;
+
+          case 2 * 8 + 4:
+            kernel = pcm_packing_16to32;
+            break;
+
+          case 3 * 8 + 2:
+            kernel = pcm_packing_24to16;
+            break;
+
+          case 2 * 8 + 3:
+            kernel = pcm_packing_16to24;
+            break;
+
+          default:
+            break;
+        }
+
+      done = kernel(reinterpret_cast<const uint32_t *>(src),
+                    reinterpret_cast<uint32_t *>(dst),
+                    samples);
+    }
+
+  /* Left over samples */
+
+  pcm_packing_bytes(src + done * in_bytes,
+                    in_bytes,
+                    dst + done * out_bytes,
+                    out_bytes,
+                    samples - done);
+
+  if (pcm_packing_is_unsigned(in_fmt) != pcm_packing_is_unsigned(out_fmt))
+    {
+      pcm_packing_toggle_sign(dst, out_bytes, samples);
+    }
+
+  return samples * out_bytes;
+}
+
+/*--------------------------------------------------------------------------*/
+uint32_t PcmPacking_selectChannels(const void *in,
+                                   PcmPackingFormat fmt,
+                                   uint32_t in_ch,
+                                   void *out,
+                                   const uint8_t *ch_map,
+                                   uint32_t out_ch,
+                                   uint32_t frames)
+{
+  uint32_t bytes = PcmPacking_bytesPerSample(fmt);
+
+  if (bytes == 0)
+    {
+      return 0;
+    }
+
+  if (bytes == 3)
+    {
+      const uint8_t *src = static_cast<const uint8_t *>(in);
+      uint8_t       *dst = static_cast<uint8_t *>(out);
+
+      for (uint32_t f = 0; f < frames; f++)
+        {
+          for (uint32_t c = 0; c < out_ch; c++)
+            {
+              const uint8_t *s = src + ch_map[c] * 3;
+
+              dst[0] = s[0];
+              dst[1] = s[1];
+              dst[2] = s[2];
+              dst += 3;
+            }
+
+          src += in_ch * 3;
+        }
+    }
+  else if (bytes == 2)
+    {
+      const uint16_t *src = static_cast<const uint16_t *>(in);
+      uint16_t       *dst = static_cast<uint16_t *>(out);
+
+      for (uint32_t f = 0; f < frames; f++)
+        {
+          for (uint32_t c = 0; c < out_ch; c++)
+            {
+              *dst++ = src[ch_map[c]];
+            }
+
+          src += in_ch;
+        }
+    }
+  else
+    {
+      const uint32_t *src = static_cast<const uint32_t *>(in);
+      uint32_t       *dst = static_cast<uint32_t *>(out);
+
+      for (uint32_t f = 0; f < frames; f++)
+        {
+          for (uint32_t c = 0; c < out_ch; c++)
+            {
+              *dst++ = src[ch_map[c]];
+            }
+
+          src += in_ch;
+        }
+    }
+
+  return frames * out_ch * bytes;
+}
+
+/*--------------------------------------------------------------------------*/
+void PcmPacking_deinterleave(const void *in,
+                             PcmPackingFormat fmt,
+                             uint32_t ch_num,
+                             void *const *out,
+                             uint32_t frames)
+{
+  for (uint32_t c = 0; c < ch_num; c++)
+    {
+      uint8_t ch = static_cast<uint8_t>(c);
+
+      PcmPacking_selectChannels(in, fmt, ch_num, out[c], &ch, 1, frames);
+    }
+}
+
+/*--------------------------------------------------------------------------*/
+void PcmPacking_interleave(const void *const *in,
+                           PcmPackingFormat fmt,
+                           uint32_t ch_num,
+                           void *out,
+                           uint32_t frames)
+{
+  uint32_t bytes = PcmPacking_bytesPerSample(fmt);
+  uint32_t frame_size = bytes * ch_num;
+
+  for (uint32_t c = 0; c < ch_num; c++)
+    {
+      const uint8_t *src = static_cast<const uint8_t *>(in[c]);
+      uint8_t       *dst = static_cast<uint8_t *>(out) + c * bytes;
+
+      switch (bytes)
+        {
+          case 2:
+            for (uint32_t f = 0; f < frames; f++)
+              {
+                *reinterpret_cast<uint16_t *>(dst) =
+                  reinterpret_cast<const uint16_t *>(src)[f];
+                dst += frame_size;
+              }
+            break;
+
+          case 4:
+            for (uint32_t f = 0; f < frames; f++)
+              {
+                *reinterpret_cast<uint32_t *>(dst) =
+                  reinterpret_cast<const uint32_t *>(src)[f];
+                dst += frame_size;
+              }
+            break;
+
+          default:
+            for (uint32_t f = 0; f < frames; f++)
+              {
+                dst[0] = src[0];
+                dst[1] = src[1];
+                dst[2] = src[2];
+                src += 3;
+                dst += frame_size;
+              }
+            break;
+        }
+    }
+}
@@ -79,34 +79,29 @@ uint32_t PackingComponent::init_apu(InitPackingParam param)
 /*--------------------------------------------------------------------*/
 bool PackingComponent::exec_apu(ExecPackingParam param)
 {
-  void (PackingComponent::*convfunc)(uint32_t, int8_t *, int8_t *);
-  uint32_t outsize = 0;
+  PcmPackingFormat in_fmt;
+  PcmPackingFormat out_fmt;
   bool result = false;
 
-  if ((m_in_bitwidth == BitWidth32bit) && (m_out_bitwidth == BitWidth24bit))
-    {
-      convfunc = &PackingComponent::cnv32to24;
-      outsize  = param.in_buffer.size * BitWidth24bit / BitWidth32bit;
-    }
-  else if ((m_in_bitwidth == BitWidth24bit) && (m_out_bitwidth == BitWidth32bit))
-    {
-      convfunc = &PackingComponent::cnv24to32;
-      outsize  = param.in_buffer.size * BitWidth32bit / BitWidth24bit;
-    }
-  else
+  if (!get_format(m_in_bitwidth, &in_fmt) ||
+      !get_format(m_out_bitwidth, &out_fmt))
     {
       return false;
     }
 
+  uint32_t samples = param.in_buffer.size / (m_in_bitwidth / 8);
+  uint32_t outsize = samples * (m_out_bitwidth / 8);
+
   /* Excec convert */
 
   if (outsize <= param.out_buffer.size)
     {
-      (this->*convfunc)(param.in_buffer.size / (m_in_bitwidth / 8),
-                        reinterpret_cast<int8_t *>(param.in_buffer.p_buffer),
-                        reinterpret_cast<int8_t *>(param.out_buffer.p_buffer));
-
-      param.out_buffer.size = outsize;
+      param.out_buffer.size =
+        PcmPacking_convert(param.in_buffer.p_buffer,
+                           in_fmt,
+                           param.out_buffer.p_buffer,
+                           out_fmt,
+                           samples);
 
       result = true;
     }
@@ -129,42 +124,27 @@ bool PackingComponent::flush_apu(StopPackingParam param)
 }
 
 /*--------------------------------------------------------------------*/
-void PackingComponent::cnv32to24(uint32_t samples, int8_t *in, int8_t *out)
+bool PackingComponent::get_format(uint16_t bitwidth, PcmPackingFormat *fmt)
 {
-  /** For Little endian data ! **/
-
-  uint32_t *p_in  = (uint32_t *)in;
-  uint32_t *p_out = (uint32_t *)out;
-
-  for (uint32_t cnt = 0; cnt < samples / 4; cnt++)
+  switch (bitwidth)
     {
-      *(p_out+0) = (uint32_t)(((*(p_in+0) & 0xFFFFFF00) >> 8 ) + ((*(p_in+1) & 0x0000FF00) << 16));
-      *(p_out+1) = (uint32_t)(((*(p_in+1) & 0xFFFF0000) >> 16) + ((*(p_in+2) & 0x00FFFF00) << 8 ));
-      *(p_out+2) = (uint32_t)(((*(p_in+2) & 0xFF000000) >> 24) + ((*(p_in+3) & 0xFFFFFF00) >> 0 ));
+      case BitWidth16bit:
+        *fmt = PcmPackingS16;
+        break;
 
-      p_out +=3;
-      p_in  +=4;
-    }
-}
-
-/*--------------------------------------------------------------------*/
-void PackingComponent::cnv24to32(uint32_t samples, int8_t *in, int8_t *out)
-{
-  /** For Little endian data ! **/
+      case BitWidth24bit:
+        *fmt = PcmPackingS24;
+        break;
 
-  uint32_t *p_in  = (uint32_t *)in;
-  uint32_t *p_out = (uint32_t *)out;
+      case BitWidth32bit:
+        *fmt = PcmPackingS32;
+        break;
 
-  for (uint32_t cnt = 0; cnt < samples / 4; cnt++)
-    {
-      *(p_out+0) = (uint32_t)( (*(p_in+0) & 0x00FFFFFF) << 8 );
-      *(p_out+1) = (uint32_t)(((*(p_in+0) & 0xFF000000) >> 16) + ((*(p_in+1) & 0x0000FFFF) << 16));
-      *(p_out+2) = (uint32_t)(((*(p_in+1) & 0xFFFF0000) >> 8 ) + ((*(p_in+2) & 0x000000FF) << 24));
-      *(p_out+3) = (uint32_t)(  *(p_in+2) & 0xFFFFFF00);
-
-      p_out +=4;
-      p_in  +=3;
+      default:
+        return false;
     }
+
+  return true;
 }
 
 /*--------------------------------------------------------------------*/
@@ -40,6 +40,7 @@
 #include "wien2_common_defs.h"
 #include "apus/apu_cmd.h"
 #include "dsp_driver/include/dsp_drv.h"
+#include "common/PcmPacking.h"
 
 
 #include "debug/dbg_log.h"
@@ -50,6 +51,7 @@ using namespace MemMgrLite;
 /*--------------------------------------------------------------------*/
 enum BitWidth
 {
+  BitWidth16bit = 16,
   BitWidth24bit = 24,
   BitWidth32bit = 32,
 };
@@ -102,8 +104,7 @@ private:
   uint16_t m_in_bitwidth;
   uint16_t m_out_bitwidth;
 
-  void cnv32to24(uint32_t samples, int8_t *in, int8_t *out);
-  void cnv24to32(uint32_t samples, int8_t *in, int8_t *out);
+  bool get_format(uint16_t bitwidth, PcmPackingFormat *fmt);
   void notify_reply(uint8_t evt, bool result, BufferHeader outbuf);
 };
 
@@ -89,6 +89,23 @@ bool AS_postfilter_flush(const FlushPostfilterParam *param, void *p_instance)
   return ((PostfilterBase *)p_instance)->flush_apu(*param);
 }
 
+/*--------------------------------------------------------------------*/
+bool AS_postfilter_setparam(const SetParamPostfilterParam *param,
+                            void *p_instance)
+{
+  /* Parameter check */
+
+  if (param == NULL || p_instance == NULL)
+    {
+      POSTFILTER_ERR(AS_ATTENTION_SUB_CODE_UNEXPECTED_PARAM);
+      return false;
+    }
+
+  /* Execute */
+
+  return ((PostfilterBase *)p_instance)->setparam_apu(*param);
+}
+
 /*--------------------------------------------------------------------*/
 bool AS_postfilter_recv_done(void *p_instance, PostfilterCmpltParam *output)
 {
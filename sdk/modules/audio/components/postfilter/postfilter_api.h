@@ -49,6 +49,9 @@ bool AS_postfilter_exec(const ExecPostfilterParam *param, void *p_instance);
 
 bool AS_postfilter_flush(const FlushPostfilterParam *param, void *p_instance);
 
+bool AS_postfilter_setparam(const SetParamPostfilterParam *param,
+                            void *p_instance);
+
 bool AS_postfilter_recv_done(void *p_instance, PostfilterCmpltParam *cmplt);
 
 uint32_t AS_postfilter_activate(void **p_instance,
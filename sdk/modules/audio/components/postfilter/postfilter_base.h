@@ -68,6 +68,11 @@ struct FlushPostfilterParam
   MemMgrLite::MemHandle output_mh;
 };
 
+struct SetParamPostfilterParam
+{
+  Wien2::Apu::ApuSetParamPostFilterCmd param;
+};
+
 struct PostfilterCmpltParam
 {
   bool           result;
@@ -83,6 +88,7 @@ public:
   virtual uint32_t init_apu(const InitPostfilterParam& param, uint32_t *dsp_inf) = 0;
   virtual bool exec_apu(const ExecPostfilterParam& param) = 0;
   virtual bool flush_apu(const FlushPostfilterParam& param) = 0;
+  virtual bool setparam_apu(const SetParamPostfilterParam& param) = 0;
   virtual bool recv_done(PostfilterCmpltParam *cmplt) = 0;
   virtual bool recv_done(void) = 0;
   virtual uint32_t activate(uint32_t *dsp_inf) = 0;
@@ -194,6 +194,35 @@ bool PostfilterComponent::flush_apu(const FlushPostfilterParam& param)
   return true;
 }
 
+/*--------------------------------------------------------------------*/
+bool PostfilterComponent::setparam_apu(const SetParamPostfilterParam& param)
+{
+  POSTFILTER_DBG("SETPARAM: type %d\n", param.param.param_type);
+
+  /* Reply of SetParam is also notified by callback and
+   * the requester must release it by recv_done(void).
+   */
+
+  Wien2::Apu::Wien2ApuCmd *p_cmd =
+    reinterpret_cast<Wien2::Apu::Wien2ApuCmd*>(allocApuBufs());
+
+  if (p_cmd == NULL)
+    {
+      return false;
+    }
+
+  memset(p_cmd, 0x00, sizeof(Wien2::Apu::Wien2ApuCmd));
+
+  p_cmd->header.process_mode = Wien2::Apu::FilterMode;
+  p_cmd->header.event_type   = Wien2::Apu::SetParamEvent;
+
+  p_cmd->setparam_postfilter_cmd = param.param;
+
+  send_apu(p_cmd);
+
+  return true;
+}
+
 /*--------------------------------------------------------------------*/
 void PostfilterComponent::send_apu(Wien2::Apu::Wien2ApuCmd *p_cmd)
 {
@@ -61,6 +61,7 @@ public:
   virtual uint32_t init_apu(const InitPostfilterParam& param, uint32_t *dsp_inf);
   virtual bool exec_apu(const ExecPostfilterParam& param);
   virtual bool flush_apu(const FlushPostfilterParam& param);
+  virtual bool setparam_apu(const SetParamPostfilterParam& param);
   virtual bool recv_done(PostfilterCmpltParam *cmplt);
   virtual bool recv_done(void) { return freeApuCmdBuf(); };
   virtual uint32_t activate(uint32_t *dsp_inf);
@@ -80,6 +80,14 @@ bool PostfilterThrough::flush_apu(const FlushPostfilterParam& param)
   return true;
 }
 
+/*--------------------------------------------------------------------*/
+bool PostfilterThrough::setparam_apu(const SetParamPostfilterParam& param)
+{
+  /* Nothing to set, and no reply because there is no request queued. */
+
+  return true;
+}
+
 /*--------------------------------------------------------------------*/
 bool PostfilterThrough::recv_done(PostfilterCmpltParam *cmplt)
 {
@@ -50,6 +50,14 @@
 
 __WIEN2_BEGIN_NAMESPACE
 
+/* Number of requests stored before DMA start. */
+
+#ifdef CONFIG_AUDIOUTILS_RENDERER_LARGE_DMA_SPLIT
+#  define RENDERER_PREFILL_NUM \
+     CONFIG_AUDIOUTILS_RENDERER_LARGE_DMA_SPLIT_PREFILL
+#else
+#  define RENDERER_PREFILL_NUM 2
+#endif
 
 typedef uint32_t RenderComponentHandler;
 typedef void (*RenderDoneCB)(AudioDrvDmaResult *p_param, void *p_requester);
@@ -176,7 +184,8 @@ private:
 
   AudioState<State> m_state;
 
-  typedef s_std::Queue<asWriteDmacParam, 2> WriteDmacCmdQue;
+  typedef s_std::Queue<asWriteDmacParam, RENDERER_PREFILL_NUM>
+    WriteDmacCmdQue;
   WriteDmacCmdQue m_write_dmac_cmd_que;
 
   typedef bool (RendererComponent::*EvtProc)(const RendererComponentParam&);
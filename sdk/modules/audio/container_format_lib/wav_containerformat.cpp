@@ -34,6 +34,7 @@
  ****************************************************************************/
 
 #include <string.h>
+#include <unistd.h>
 #include "wav_containerformat.h"
 
 /*--------------------------------------------------------------------------*/
@@ -128,8 +129,8 @@ bool WavContainerFormat::getHeader(WAVHEADER *wav_header, uint32_t data_size)
   wav_header->format     = FORMAT_ID_PCM;
   wav_header->channel    = m_channel_number;
   wav_header->rate       = m_sampling_rate;
-  wav_header->avgbyte    = m_sampling_rate * m_channel_number * 2;
-  wav_header->block      = m_channel_number * 2;
+  wav_header->block      = m_channel_number * (m_bitwidth / 8);
+  wav_header->avgbyte    = m_sampling_rate * wav_header->block;
   wav_header->bit        = m_bitwidth;
   if (data_size == 0)
     {
@@ -144,3 +145,121 @@ bool WavContainerFormat::getHeader(WAVHEADER *wav_header, uint32_t data_size)
 
   return true;
 }
+
+/*--------------------------------------------------------------------------*/
+bool WavContainerFormat::getHeader(WAVHEADER64 *wav_header,
+                                   uint64_t data_size)
+{
+  if (wav_header == NULL)
+    {
+      return false;
+    }
+
+  memset(wav_header, 0, sizeof(WAVHEADER64));
+
+  memcpy(wav_header->wave, FORMAT_WAVE,     strlen(FORMAT_WAVE));
+  memcpy(wav_header->fmt,  SUBCHUNKID_FMT,  strlen(SUBCHUNKID_FMT));
+  memcpy(wav_header->data, SUBCHUNKID_DATA, strlen(SUBCHUNKID_DATA));
+  wav_header->ds64_size  = DS64_SIZE;
+  wav_header->fmt_size   = FMT_SIZE;
+  wav_header->format     = FORMAT_ID_PCM;
+  wav_header->channel    = m_channel_number;
+  wav_header->rate       = m_sampling_rate;
+  wav_header->block      = m_channel_number * (m_bitwidth / 8);
+  wav_header->avgbyte    = m_sampling_rate * wav_header->block;
+  wav_header->bit        = m_bitwidth;
+
+  uint64_t riff_size = data_size + sizeof(WAVHEADER64) - 8;
+
+  if (riff_size <= RIFF_SIZE_MAX)
+    {
+      memcpy(wav_header->riff, CHUNKID_RIFF,     strlen(CHUNKID_RIFF));
+      memcpy(wav_header->ds64, SUBCHUNKID_JUNK,  strlen(SUBCHUNKID_JUNK));
+      wav_header->total_size = (data_size == 0) ? 0 : (uint32_t)riff_size;
+      wav_header->data_size  = (uint32_t)data_size;
+    }
+  else
+    {
+      uint64_t sample_count = (wav_header->block == 0) ?
+                                0 : data_size / wav_header->block;
+
+      memcpy(wav_header->riff, CHUNKID_RF64,    strlen(CHUNKID_RF64));
+      memcpy(wav_header->ds64, SUBCHUNKID_DS64, strlen(SUBCHUNKID_DS64));
+      wav_header->total_size        = RIFF_SIZE_MAX;
+      wav_header->data_size         = RIFF_SIZE_MAX;
+      wav_header->riff_size_low     = (uint32_t)riff_size;
+      wav_header->riff_size_high    = (uint32_t)(riff_size >> 32);
+      wav_header->data_size_low     = (uint32_t)data_size;
+      wav_header->data_size_high    = (uint32_t)(data_size >> 32);
+      wav_header->sample_count_low  = (uint32_t)sample_count;
+      wav_header->sample_count_high = (uint32_t)(sample_count >> 32);
+    }
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool WavContainerFormat::updateHeader(FILE *fp, uint64_t data_size)
+{
+  WAVHEADER64 wav_header;
+
+  if (fp == NULL || !getHeader(&wav_header, data_size))
+    {
+      return false;
+    }
+
+  long pos = ftell(fp);
+  if (pos < 0 || fseek(fp, 0, SEEK_SET) != 0)
+    {
+      return false;
+    }
+
+  bool ret = (fwrite(&wav_header, 1, sizeof(WAVHEADER64), fp) ==
+              sizeof(WAVHEADER64));
+
+  if (fseek(fp, pos, SEEK_SET) != 0)
+    {
+      return false;
+    }
+
+  /* Data written so far and the new header reach the media together. */
+
+  if (!ret || fflush(fp) != 0 || fsync(fileno(fp)) != 0)
+    {
+      return false;
+    }
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool WavContainerFormat::updateHeader(int fd, uint64_t data_size)
+{
+  WAVHEADER64 wav_header;
+
+  if (fd < 0 || !getHeader(&wav_header, data_size))
+    {
+      return false;
+    }
+
+  off_t pos = lseek(fd, 0, SEEK_CUR);
+  if (pos < 0 || lseek(fd, 0, SEEK_SET) != 0)
+    {
+      return false;
+    }
+
+  bool ret = (write(fd, &wav_header, sizeof(WAVHEADER64)) ==
+              (ssize_t)sizeof(WAVHEADER64));
+
+  if (lseek(fd, pos, SEEK_SET) != pos)
+    {
+      return false;
+    }
+
+  if (!ret || fsync(fd) != 0)
+    {
+      return false;
+    }
+
+  return true;
+}
@@ -36,6 +36,9 @@
 #ifndef MODULES_AUDIO_CONTAINER_FORMAT_LIB_WAV_CONTAINERFORMAT_H
 #define MODULES_AUDIO_CONTAINER_FORMAT_LIB_WAV_CONTAINERFORMAT_H
 
+#include <stdint.h>
+#include <stdio.h>
+
 /* Channel number */
 
 #define CHANNEL_1CH  1  /* MONO   */
@@ -80,6 +83,17 @@
 #define SUBCHUNKID_DATA   "data"
 #define FMT_SIZE          0x10
 
+/* For RF64 (EBU Tech 3306) header.
+ * Header is written as RIFF with JUNK chunk of ds64 size. When the
+ * file grows over 4GB, RIFF and JUNK are replaced with RF64 and ds64.
+ */
+
+#define CHUNKID_RF64      "RF64"
+#define SUBCHUNKID_DS64   "ds64"
+#define SUBCHUNKID_JUNK   "JUNK"
+#define DS64_SIZE         0x1C
+#define RIFF_SIZE_MAX     0xFFFFFFFF
+
 struct wav_header_s
 {
   uint8_t  riff[4];    /* "RIFF"             */
@@ -98,6 +112,33 @@ struct wav_header_s
 };
 typedef struct wav_header_s WAVHEADER;
 
+struct wav_header64_s
+{
+  uint8_t  riff[4];    /* "RIFF" or "RF64"   */
+  uint32_t total_size; /* 0xFFFFFFFF if RF64 */
+  uint8_t  wave[4];    /* "WAVE"             */
+  uint8_t  ds64[4];    /* "JUNK" or "ds64"   */
+  uint32_t ds64_size;  /* ds64 chunk size    */
+  uint32_t riff_size_low;
+  uint32_t riff_size_high;
+  uint32_t data_size_low;
+  uint32_t data_size_high;
+  uint32_t sample_count_low;
+  uint32_t sample_count_high;
+  uint32_t table_length;
+  uint8_t  fmt[4];     /* "fmt "             */
+  uint32_t fmt_size;   /* fmt chunk size     */
+  uint16_t format;     /* format type        */
+  uint16_t channel;    /* channel number     */
+  uint32_t rate;       /* sampling rate      */
+  uint32_t avgbyte;    /* rate * block       */
+  uint16_t block;      /* channels * bit / 8 */
+  uint16_t bit;        /* bit length         */
+  uint8_t  data[4];    /* "data"             */
+  uint32_t data_size;  /* 0xFFFFFFFF if RF64 */
+};
+typedef struct wav_header64_s WAVHEADER64;
+
 class WavContainerFormat
 {
 public:
@@ -127,6 +168,29 @@ public:
 
   bool getHeader(WAVHEADER *wav_header,
            uint32_t data_size);
+
+  /* Get header which can be RF64.
+   *
+   * Header is RIFF while the file is smaller than 4GB.
+   * Size of header does not change when it becomes RF64.
+   */
+
+  bool getHeader(WAVHEADER64 *wav_header,
+                 uint64_t data_size);
+
+  /* Rewrite header at the top of file by data size written so far
+   * and flush the file to media. Calling this periodically while
+   * recording keeps the file readable if recording is interrupted.
+   * File position is not changed.
+   */
+
+  bool updateHeader(FILE *fp,
+                    uint64_t data_size);
+
+  /* Same as above for a file descriptor. */
+
+  bool updateHeader(int fd,
+                    uint64_t data_size);
 private:
   uint16_t  m_format_id;
   uint16_t  m_channel_number;
@@ -38,6 +38,68 @@
 #include <stdlib.h>
 #include "wav_containerformat_parser.h"
 
+#define FORMAT_WAVE        0x45564157  /* WAVE */
+
+#define RIFF_HEADER_SIZE   12
+#define CHUNK_HEADER_SIZE  8
+#define DS64_MIN_SIZE      24          /* RIFF size, data size, samples */
+#define CHUNK_SIZE_USE_DS64 0xFFFFFFFF
+#define CHUNK_LIST_INIT    16
+
+/*--------------------------------------------------------------------------*/
+static inline uint32_t get_le32(const uint8_t *p)
+{
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+         ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/*--------------------------------------------------------------------------*/
+static inline uint64_t get_le64(const uint8_t *p)
+{
+  return (uint64_t)get_le32(p) | ((uint64_t)get_le32(p + 4) << 32);
+}
+
+/*--------------------------------------------------------------------------*/
+static uint32_t read_block(FILE *fd, uint64_t offset, uint8_t *buf)
+{
+  if (fseek(fd, (long)offset, SEEK_SET) != 0)
+    {
+      return 0;
+    }
+
+  return fread(buf, 1, HEADER_READ_SIZE, fd);
+}
+
+/*--------------------------------------------------------------------------*/
+bool WavContainerFormatParser::addChunk(handel_wav_parser_t* wav_parser,
+                                        uint32_t chunk_id,
+                                        uint64_t size,
+                                        uint64_t offset)
+{
+  if (wav_parser->chunk_num == wav_parser->chunk_max)
+    {
+      uint32_t max = (wav_parser->chunk_max == 0) ?
+                       CHUNK_LIST_INIT : wav_parser->chunk_max * 2;
+      wav_chunk_info_t *chunk =
+        (wav_chunk_info_t *)realloc(wav_parser->chunk,
+                                    max * sizeof(wav_chunk_info_t));
+      if (chunk == NULL)
+        {
+          return false;
+        }
+      wav_parser->chunk     = chunk;
+      wav_parser->chunk_max = max;
+    }
+
+  wav_chunk_info_t *info = &wav_parser->chunk[wav_parser->chunk_num++];
+
+  info->chunk_id = chunk_id;
+  info->size     = size;
+  info->offset   = offset;
+
+  return true;
+}
+
 /*--------------------------------------------------------------------------*/
 handel_wav_parser WavContainerFormatParser::parseChunk(const char* file_path,
                                                        fmt_chunk_t* fmt)
@@ -50,88 +112,172 @@ handel_wav_parser WavContainerFormatParser::parseChunk(const char* file_path,
     }
   memset((void *)wav_parser, 0, sizeof(handel_wav_parser_t));
 
-  FILE *fd = fopen(file_path, "r");
-  if (fd == 0)
+  uint8_t *buf = (uint8_t *)malloc(HEADER_READ_SIZE);
+  if (buf == NULL)
     {
       free((void *)wav_parser);
       return NULL;
     }
-  setvbuf(fd, NULL, _IOLBF, STDIO_BUFFER_SIZE);
 
-  int ret;
-  riff_chunk_t riff_chunk;
-  ret = fread((void*)&riff_chunk, 1, sizeof(riff_chunk_t), fd);
-  if (ret < 0 || sizeof(riff_chunk_t) != ret)
+  FILE *fd = fopen(file_path, "r");
+  if (fd == 0)
     {
-      fclose(fd);
+      free(buf);
       free((void *)wav_parser);
       return NULL;
     }
-  if (riff_chunk.chunk.chunk_id == CHUNKID_RIFF)
+  setvbuf(fd, NULL, _IOFBF, STDIO_BUFFER_SIZE);
+
+  /* Length of file is used to recover the size of data chunk
+   * which was not written because recording was interrupted.
+   */
+
+  fseek(fd, 0, SEEK_END);
+  uint64_t file_len = (uint64_t)ftell(fd);
+
+  /* Chunks before data are parsed from a block read at once.
+   * Another block is read only when a chunk header is out of it.
+   */
+
+  uint64_t buf_offset = 0;
+  uint32_t buf_len    = read_block(fd, 0, buf);
+
+  if (buf_len < RIFF_HEADER_SIZE || get_le32(buf + 8) != FORMAT_WAVE)
     {
-      uint32_t offset = sizeof(riff_chunk_t);
-      wav_parser->file_size = riff_chunk.chunk.size;
-      chunk_t chunk;
-      while (1)
-        {
-          ret = fread((void*)&chunk, 1, sizeof(chunk_t), fd);
-          if (ret < 0 || sizeof(chunk_t) != ret)
-             {
-               fclose(fd);
-               free((void *)wav_parser);
-               return NULL;
-             }
-
-          wav_parser->chunk_list.chunk[wav_parser->chunk_list.cnt].chunk_id =
-            chunk.chunk_id;
-          wav_parser->chunk_list.chunk[wav_parser->chunk_list.cnt].size =
-            chunk.size;
-          wav_parser->chunk_offset[wav_parser->chunk_list.cnt] =
-            offset + sizeof(chunk_t);
-          wav_parser->chunk_list.cnt++;
-          offset += sizeof(chunk_t);
-          switch (chunk.chunk_id)
-            {
-              case SUBCHUNKID_FMT:
+      goto error;
+    }
+
+  {
+    uint32_t riff_id = get_le32(buf);
+    bool     is_64   = (riff_id == CHUNKID_RF64 || riff_id == CHUNKID_BW64);
+    bool     has_fmt = false;
+    uint64_t ds64_data_size = 0;
+    uint64_t offset  = RIFF_HEADER_SIZE;
+
+    if (riff_id != CHUNKID_RIFF && !is_64)
+      {
+        goto error;
+      }
+
+    wav_parser->file_size = get_le32(buf + 4);
+
+    while (1)
+      {
+        uint64_t body_offset = offset + CHUNK_HEADER_SIZE;
+
+        if (body_offset > buf_offset + buf_len)
+          {
+            buf_offset = offset;
+            buf_len    = read_block(fd, offset, buf);
+            if (buf_len < CHUNK_HEADER_SIZE)
+              {
+                goto error;
+              }
+          }
+
+        const uint8_t *p = buf + (offset - buf_offset);
+        uint32_t chunk_id = get_le32(p);
+        uint64_t size     = get_le32(p + 4);
+
+        if (is_64 && chunk_id == SUBCHUNKID_DATA &&
+            size == CHUNK_SIZE_USE_DS64)
+          {
+            size = ds64_data_size;
+          }
+
+        /* Contents of ds64 and fmt are used. Both are small. */
+
+        uint32_t need = 0;
+
+        if (chunk_id == SUBCHUNKID_DS64)
+          {
+            if (size < DS64_MIN_SIZE)
+              {
+                goto error;
+              }
+            need = DS64_MIN_SIZE;
+          }
+        else if (chunk_id == SUBCHUNKID_FMT)
+          {
+            need = (size < sizeof(fmt_chunk_t)) ?
+                     (uint32_t)size : sizeof(fmt_chunk_t);
+          }
+
+        if (body_offset + need > buf_offset + buf_len)
+          {
+            buf_offset = offset;
+            buf_len    = read_block(fd, offset, buf);
+            if (buf_len < CHUNK_HEADER_SIZE + need)
+              {
+                goto error;
+              }
+            p = buf;
+          }
+
+        p += CHUNK_HEADER_SIZE;
+
+        switch (chunk_id)
+          {
+            case SUBCHUNKID_DS64:
+              wav_parser->file_size = get_le64(p);
+              ds64_data_size        = get_le64(p + 8);
+              break;
+
+            case SUBCHUNKID_FMT:
+              memset(fmt, 0, sizeof(fmt_chunk_t));
+              memcpy(fmt, p, need);
+              has_fmt = true;
+              break;
+
+            case SUBCHUNKID_DATA:
+              if (!has_fmt)
                 {
-                  fmt_chunk_t  fmt_chunk;
-                  ret = fread((void*)&fmt_chunk, 1, chunk.size, fd);
-                  if (ret < 0 || ret != chunk.size)
-                    {
-                      fclose(fd);
-                      free((void *)wav_parser);
-                      return NULL;
-                    }
-                  offset += chunk.size;
-                  memcpy(fmt, &fmt_chunk, sizeof(fmt_chunk_t));
-                  if ((int32_t)sizeof(fmt_chunk_t) > chunk.size)
-                    {
-                      fmt->extended_size = 0;
-                    }
+                  goto error;
                 }
-                break;
-
-              case SUBCHUNKID_DATA:
-                wav_parser->data_offset = offset;
-                wav_parser->data_size = chunk.size;
-                wav_parser->cur_offset = offset;
-                wav_parser->read_size = chunk.size;
-                wav_parser->fd = fd;
-                return (handel_wav_parser)wav_parser;
-
-              default:
-                int8_t data;
-                for (int32_t i = 0; i < chunk.size; i++)
-                 {
-                   ret = fread((void*)&data, 1, 1, fd);
-                 }
-                offset += chunk.size;
-                break;
-            }
-        }
-    }
 
+              /* Size is 0 or over the end of file if header was not
+               * updated at the end of recording. Use rest of file.
+               */
+
+              if (size == 0 || body_offset + size > file_len)
+                {
+                  size = (file_len > body_offset) ?
+                           (file_len - body_offset) : 0;
+                }
+
+              if (!addChunk(wav_parser, chunk_id, size, body_offset) ||
+                  fseek(fd, (long)body_offset, SEEK_SET) != 0)
+                {
+                  goto error;
+                }
+
+              wav_parser->data_offset = body_offset;
+              wav_parser->data_size   = size;
+              wav_parser->cur_offset  = body_offset;
+              wav_parser->read_size   = size;
+              wav_parser->fd          = fd;
+              free(buf);
+              return (handel_wav_parser)wav_parser;
+
+            default:
+              break;
+          }
+
+        if (!addChunk(wav_parser, chunk_id, size, body_offset))
+          {
+            goto error;
+          }
+
+        /* Chunks are aligned to 2 bytes. */
+
+        offset = body_offset + size + (size & 1);
+      }
+  }
+
+error:
   fclose(fd);
+  free(buf);
+  free((void *)wav_parser->chunk);
   free((void *)wav_parser);
 
   return NULL;
@@ -147,12 +293,44 @@ bool WavContainerFormatParser::getChunkList(handel_wav_parser handel,
     }
   handel_wav_parser_t* wav_parser = (handel_wav_parser_t *)handel;
 
-  list->cnt = wav_parser->chunk_list.cnt;
-  for (uint8_t i = 0; i < wav_parser->chunk_list.cnt; i++)
+  list->cnt = (wav_parser->chunk_num < MAX_CHUNK_LIST) ?
+                wav_parser->chunk_num : MAX_CHUNK_LIST;
+  for (uint8_t i = 0; i < list->cnt; i++)
+    {
+      list->chunk[i].chunk_id = wav_parser->chunk[i].chunk_id;
+      list->chunk[i].size = (int32_t)wav_parser->chunk[i].size;
+    }
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+uint32_t WavContainerFormatParser::getChunkNum(handel_wav_parser handel)
+{
+  if (handel == NULL)
+    {
+      return 0;
+    }
+
+  return ((handel_wav_parser_t *)handel)->chunk_num;
+}
+
+/*--------------------------------------------------------------------------*/
+bool WavContainerFormatParser::getChunkInfo(handel_wav_parser handel,
+                                            uint32_t          index,
+                                            wav_chunk_info_t* info)
+{
+  if (handel == NULL)
+    {
+      return false;
+    }
+  handel_wav_parser_t* wav_parser = (handel_wav_parser_t *)handel;
+
+  if (index >= wav_parser->chunk_num)
     {
-      list->chunk[i].chunk_id = wav_parser->chunk_list.chunk[i].chunk_id;
-      list->chunk[i].size = wav_parser->chunk_list.chunk[i].size;
+      return false;
     }
+
+  *info = wav_parser->chunk[index];
   return true;
 }
 
@@ -167,16 +345,16 @@ bool WavContainerFormatParser::getChunk(handel_wav_parser handel,
     }
   handel_wav_parser_t* wav_parser = (handel_wav_parser_t *)handel;
 
-  for (uint8_t i = 0; i < wav_parser->chunk_list.cnt; i++)
+  for (uint32_t i = 0; i < wav_parser->chunk_num; i++)
     {
-      if (wav_parser->chunk_list.chunk[i].chunk_id == chunk_id)
+      if (wav_parser->chunk[i].chunk_id == chunk_id)
         {
-          int ret;
-          fseek(wav_parser->fd, wav_parser->chunk_offset[i], 0);
-          ret = fread(buffer, 1, wav_parser->chunk_list.chunk[i].size,
-                      wav_parser-> fd);
-          fseek(wav_parser->fd, wav_parser->cur_offset, 0);
-          if (ret < 0 || ret != wav_parser->chunk_list.chunk[i].size)
+          size_t size = (size_t)wav_parser->chunk[i].size;
+          size_t ret;
+          fseek(wav_parser->fd, (long)wav_parser->chunk[i].offset, SEEK_SET);
+          ret = fread(buffer, 1, size, wav_parser->fd);
+          fseek(wav_parser->fd, (long)wav_parser->cur_offset, SEEK_SET);
+          if (ret != size)
             {
               return false;
             }
@@ -187,6 +365,17 @@ bool WavContainerFormatParser::getChunk(handel_wav_parser handel,
   return false;
 }
 
+/*--------------------------------------------------------------------------*/
+uint64_t WavContainerFormatParser::getDataSize(handel_wav_parser handel)
+{
+  if (handel == NULL)
+    {
+      return 0;
+    }
+
+  return ((handel_wav_parser_t *)handel)->data_size;
+}
+
 /*--------------------------------------------------------------------------*/
 int32_t WavContainerFormatParser::getDataChunk(handel_wav_parser handel,
                                                uint16_t          format,
@@ -237,5 +426,6 @@ int32_t WavContainerFormatParser::getDataChunk(handel_wav_parser handel,
 void WavContainerFormatParser::resetParser(handel_wav_parser handel)
 {
   fclose(((handel_wav_parser_t *)handel)->fd);
+  free(((handel_wav_parser_t *)handel)->chunk);
   free(handel);
 }
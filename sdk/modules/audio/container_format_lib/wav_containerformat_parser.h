@@ -36,6 +36,9 @@
 #ifndef MODULES_AUDIO_CONTAINER_FORMAT_LIB_WAV_CONTAINERFORMAT_PARSER_H
 #define MODULES_AUDIO_CONTAINER_FORMAT_LIB_WAV_CONTAINERFORMAT_PARSER_H
 
+#include <stdint.h>
+#include <stdio.h>
+
 typedef void* handel_wav_parser;
 
 /* format */
@@ -149,6 +152,9 @@ typedef void* handel_wav_parser;
 /* Required chunk. */
 
 #define CHUNKID_RIFF     0x46464952  /* RIFF */
+#define CHUNKID_RF64     0x34364652  /* RF64 */
+#define CHUNKID_BW64     0x34365742  /* BW64 */
+#define SUBCHUNKID_DS64  0x34367364  /* ds64 (RF64 and BW64 only) */
 #define SUBCHUNKID_FMT   0x20746D66  /* fmt  */
 #define SUBCHUNKID_DATA  0x61746164  /* data */
 
@@ -174,10 +180,21 @@ typedef void* handel_wav_parser;
 #define SUBCHUNKID_AXML  0x6C6D7861  /* axml */
 #define SUBCHUNKID_CONT  0x746E6F63  /* cont */
 
-/* For line buffer mode. */
+/* Buffer size of stdio for data chunk. */
 
 #define STDIO_BUFFER_SIZE 4096
 
+/* Headers are parsed from blocks of this size. Chunks before data
+ * chunk fit in one block in most files, so only one read is done.
+ */
+
+#define HEADER_READ_SIZE  4096
+
+/* Number of chunks returned by getChunkList().
+ * The parser itself has no limit, use getChunkNum() and getChunkInfo()
+ * to get all of them.
+ */
+
 #define MAX_CHUNK_LIST 128
 
 struct chunk_s
@@ -194,6 +211,15 @@ struct chunk_list_s
 };
 typedef struct chunk_list_s chunk_list_t;
 
+/* Chunk information with 64bit size (RF64) */
+
+struct wav_chunk_info_s
+{
+  uint32_t chunk_id;
+  uint64_t size;
+  uint64_t offset;  /* File offset of chunk data */
+};
+typedef struct wav_chunk_info_s wav_chunk_info_t;
 
 struct riff_chunk_s
 {
@@ -216,13 +242,14 @@ typedef struct fmt_chunk_s fmt_chunk_t;
 
 struct handel_wav_parser_s
 {
-  chunk_list_t  chunk_list;
-  uint32_t      chunk_offset[MAX_CHUNK_LIST];
-  uint32_t      data_offset;
-  uint32_t      cur_offset;
-  uint32_t      file_size;
-  uint32_t      data_size;
-  uint32_t      read_size;
+  wav_chunk_info_t *chunk;
+  uint32_t      chunk_num;
+  uint32_t      chunk_max;
+  uint64_t      data_offset;
+  uint64_t      cur_offset;
+  uint64_t      file_size;
+  uint64_t      data_size;
+  uint64_t      read_size;
   FILE          *fd;
 };
 typedef struct handel_wav_parser_s handel_wav_parser_t;
@@ -236,10 +263,14 @@ public:
 
   handel_wav_parser parseChunk(const char*, fmt_chunk_t*);
   bool getChunkList(handel_wav_parser, chunk_list_t*);
+  uint32_t getChunkNum(handel_wav_parser);
+  bool getChunkInfo(handel_wav_parser, uint32_t, wav_chunk_info_t*);
   bool getChunk(handel_wav_parser, uint32_t, int8_t*);
+  uint64_t getDataSize(handel_wav_parser);
   int32_t getDataChunk(handel_wav_parser, uint16_t, int8_t*, uint32_t);
   void resetParser(handel_wav_parser);
 private:
+  bool addChunk(handel_wav_parser_t*, uint32_t, uint64_t, uint64_t);
 };
 
 #endif /* MODULES_AUDIO_CONTAINER_FORMAT_LIB_WAV_CONTAINERFORMAT_PARSER_H */
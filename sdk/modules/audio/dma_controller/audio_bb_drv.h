@@ -86,6 +86,8 @@ typedef struct AudioDrvDmaInfo_
   uint32_t    ready_wait;
   uint32_t    ready_empty;
   asDmaState  state;
+  uint32_t    cmplt_cnt;   /* DMA completions since start */
+  uint32_t    elapsed_ms;  /* Time since start */
   E_AS_BB     result;
 } AudioDrvDmaInfo;
 
@@ -34,12 +34,14 @@
  ****************************************************************************/
 
 #include <nuttx/kmalloc.h>
+#include <nuttx/clock.h>
 #include <debug.h>
 #include <arch/chip/cxd56_audio.h>
 
 #include "memutils/os_utils/chateau_osal.h"
 #include "audio/audio_high_level_api.h"
 #include "debug/dbg_log.h"
+#include "debug/audio_trace.h"
 #include "audio_dma_drv.h"
 #include "audio_dma_buffer.h"
 
@@ -268,6 +270,20 @@ bool AsDmaDrv::init(void *p_param)
   m_ch_num = initParam->ch_num;
   m_dmadone_func = initParam->p_dmadone_func;
 
+  /* Capture side is limited by the size of m_dma_buffer. */
+
+  switch (initParam->dmac_id)
+    {
+      case CXD56_AUDIO_DMAC_I2S0_DOWN:
+      case CXD56_AUDIO_DMAC_I2S1_DOWN:
+        m_split_max_size = DMA_OUTPUT_MAX_SIZE;
+        break;
+
+      default:
+        m_split_max_size = DMA_BUFFER_MAX_SIZE;
+        break;
+    }
+
   drv_ret = cxd56_audio_init_dma(initParam->dmac_id,
                                  initParam->format,
                                  &m_ch_num);
@@ -373,18 +389,19 @@ void AsDmaDrv::runDmaSplitRequest(AudioDrvDmaRunParam *pDmaParam,
             addr + ((size - sizeCalc) * m_ch_num * m_dma_byte_len);
         }
 
-      /* If sample num is over 1024(DMA_BUFFER_MAX_SIZE), transfer unit is
-       * divided into every 1024 samples. However, the sample num is.
-       * 1024 < x <= 2048, transfer unit will be half of it. This is to
+      /* If sample num is over m_split_max_size (1024, or larger split
+       * size for output), transfer unit is divided into every
+       * m_split_max_size samples. However, the sample num is.
+       * max < x <= max * 2, transfer unit will be half of it. This is to
        * prevent too fewer transfer unit will be.
        */
 
-      if (sizeCalc > DMA_BUFFER_MAX_SIZE * 2)
+      if (sizeCalc > m_split_max_size * 2)
         {
-          pDmaParam->split_size = DMA_BUFFER_MAX_SIZE;
+          pDmaParam->split_size = m_split_max_size;
         }
-      else if ((DMA_BUFFER_MAX_SIZE < sizeCalc)
-            && (sizeCalc <= DMA_BUFFER_MAX_SIZE * 2))
+      else if ((m_split_max_size < sizeCalc)
+            && (sizeCalc <= m_split_max_size * 2))
         {
           pDmaParam->split_size = sizeCalc / 2;
         }
@@ -448,14 +465,14 @@ bool AsDmaDrv::pushRequest(void *p_param, bool use_callback)
 
   /* Process of DMA request */
 
-  size1_cnt = dmaParam.run_dmac_param.size / DMA_BUFFER_MAX_SIZE;
-  if (dmaParam.run_dmac_param.size % DMA_BUFFER_MAX_SIZE)
+  size1_cnt = dmaParam.run_dmac_param.size / m_split_max_size;
+  if (dmaParam.run_dmac_param.size % m_split_max_size)
     {
       size1_cnt += 1;
     }
 
-  size2_cnt = dmaParam.run_dmac_param.size2 / DMA_BUFFER_MAX_SIZE;
-  if (dmaParam.run_dmac_param.size2 % DMA_BUFFER_MAX_SIZE)
+  size2_cnt = dmaParam.run_dmac_param.size2 / m_split_max_size;
+  if (dmaParam.run_dmac_param.size2 % m_split_max_size)
     {
       size2_cnt += 1;
     }
@@ -549,6 +566,9 @@ bool AsDmaDrv::startDma(void *p_param)
   E_AS rtCode = E_AS_OK;
   m_dmac_id = *(reinterpret_cast<cxd56_audio_dma_t*>(p_param));
 
+  m_cmplt_cnt  = 0;
+  m_start_tick = (uint32_t)clock_systimer();
+
   /* Move request from ready queue to running queue (= DMA transfer queue). */
 
   while ((m_ready_que.size() > 0)
@@ -597,6 +617,8 @@ void AsDmaDrv::dmaCmplt(void)
 {
   const AudioDrvDmaRunParam& dmaParam = m_running_que.top();
 
+  m_cmplt_cnt++;
+
   if (((m_ch_num % 2) == 1) && (m_dma_byte_len == AS_DMAC_BYTE_WT_16BIT))
     {
       AS_AudioDrvDmaGetMicInput(dmaParam.split_size,
@@ -623,6 +645,16 @@ void AsDmaDrv::dmaCmplt(void)
 
   if (dmaParam.overlap_cnt == 0)
     {
+      if (m_dmac_id == CXD56_AUDIO_DMAC_I2S0_DOWN ||
+          m_dmac_id == CXD56_AUDIO_DMAC_I2S1_DOWN)
+        {
+          /* Number of requests still queued is the margin left
+           * before underflow.
+           */
+
+          AUDIO_TRACE(AudioTraceDmaDone, m_ready_que.size());
+        }
+
       if (dmaParam.p_dmadone_func != NULL)
         {
           AudioDrvDmaResult resultParam;
@@ -698,6 +730,8 @@ bool AsDmaDrv::dmaCmpltOnRun(void *p_param)
 
       readyQuePop();
 
+      AUDIO_TRACE(AudioTraceUnderflow, 1);
+
       dmaErrCb(E_AS_BB_DMA_UNDERFLOW);
     }
 #endif  /* CONFIG_AUDIOUTILS_RENDERER_UNDERFLOW */
@@ -706,6 +740,8 @@ bool AsDmaDrv::dmaCmpltOnRun(void *p_param)
     {
       cxd56_audio_stop_dma(m_dmac_id);
 
+      AUDIO_TRACE(AudioTraceUnderflow, 1);
+
       dmaErrCb(E_AS_BB_DMA_UNDERFLOW);
 
       m_state = AS_DMA_STATE_PREPARE;
@@ -896,6 +932,9 @@ bool AsDmaDrv::getInfo(void *p_param)
   dmaInfo->ready_wait    = m_ready_que.size();
   dmaInfo->ready_empty   = READY_QUEUE_NUM - dmaInfo->ready_wait;
   dmaInfo->state         = m_state;
+  dmaInfo->cmplt_cnt     = m_cmplt_cnt;
+  dmaInfo->elapsed_ms    = (m_start_tick == 0) ?
+                             0 : TICK2MSEC((uint32_t)clock_systimer() - m_start_tick);
 
   return true;
 }
@@ -85,7 +85,20 @@ E_AS AS_DeactivateDmac(cxd56_audio_dma_t dmacId);
  * (192000/882000 * 1024sample / 1024(DMA MAX) = 2.17)
  */
 
-#define READY_QUEUE_NUM 30
+#ifdef CONFIG_AUDIOUTILS_RENDERER_LARGE_DMA_SPLIT
+/* Output is split into larger transfers, and more of them are queued,
+ * so that DMA completion interrupts (= CPU wakeups) are fewer.
+ * DMAC has no chained descriptors and raises an interrupt for each
+ * transfer, which is also limited to one request and DMAC_MAX_SIZE.
+ */
+
+#  define READY_QUEUE_NUM CONFIG_AUDIOUTILS_RENDERER_LARGE_DMA_SPLIT_QUEUE
+#  define DMA_OUTPUT_MAX_SIZE CONFIG_AUDIOUTILS_RENDERER_LARGE_DMA_SPLIT_SIZE
+#else
+#  define READY_QUEUE_NUM 30
+#  define DMA_OUTPUT_MAX_SIZE 1024
+#endif  /* CONFIG_AUDIOUTILS_RENDERER_LARGE_DMA_SPLIT */
+
 #define RUNNING_QUEUE_NUM 3
 #define PREPARE_SAVE_NUM RUNNING_QUEUE_NUM
 
@@ -114,6 +127,9 @@ public:
       , m_dma_buf_cnt(0)
       , m_min_size(0)
       , m_fade_required_sample(0)
+      , m_split_max_size(0)
+      , m_cmplt_cnt(0)
+      , m_start_tick(0)
   {
     m_ready_que.clear();
     m_running_que.clear();
@@ -156,6 +172,15 @@ private:
   uint32_t    m_min_size;
   uint32_t    m_fade_required_sample;
 
+  /* Maximum samples of one DMA transfer */
+
+  uint32_t    m_split_max_size;
+
+  /* Number of DMA completions and the time counting started */
+
+  uint32_t    m_cmplt_cnt;
+  uint32_t    m_start_tick;
+
   Queue<AudioDrvDmaRunParam, READY_QUEUE_NUM> m_ready_que;
   Queue<AudioDrvDmaRunParam, RUNNING_QUEUE_NUM> m_running_que;
 
@@ -352,6 +352,33 @@ E_AS AS_GetReadyCmdNumDmac(cxd56_audio_dma_t dmacId, uint32_t *pResult)
   return rtCode;
 }
 
+/*--------------------------------------------------------------------*/
+E_AS AS_GetWakeupInfoDmac(cxd56_audio_dma_t dmacId, asDmacWakeupInfo *pInfo)
+{
+  E_AS_BB rtCodeBB = E_AS_BB_DMA_OK;
+  AudioDrvDmaInfo dmaInfo;
+
+  if (pInfo == NULL)
+    {
+      DMAC_ERR(AS_ATTENTION_SUB_CODE_UNEXPECTED_PARAM);
+      return E_AS_GETREADYCMD_RESULT_NULL;
+    }
+
+  rtCodeBB = AS_AudioDrvDmaGetInfo(dmacId, &dmaInfo);
+
+  if (rtCodeBB != E_AS_BB_DMA_OK)
+    {
+      return E_AS_DMAC_MSG_SEND_ERR;
+    }
+
+  pInfo->wakeup_cnt     = dmaInfo.cmplt_cnt;
+  pInfo->elapsed_ms     = dmaInfo.elapsed_ms;
+  pInfo->wakeup_per_sec = (dmaInfo.elapsed_ms == 0) ? 0 :
+    (uint32_t)(((uint64_t)dmaInfo.cmplt_cnt * 1000) / dmaInfo.elapsed_ms);
+
+  return E_AS_OK;
+}
+
 /*--------------------------------------------------------------------*/
 E_AS AS_RegistDmaIntCb(cxd56_audio_dma_t dmacId,
                        cxd56_audio_dma_cb_t p_dmaIntCb)
@@ -330,6 +330,14 @@ typedef enum
   AS_DMASTOPMODE_MAX_ENTRY  /* MAX ENTRY */
 } asDmacStopMode;
 
+/** AS_GetWakeupInfoDmac function parameter */
+typedef struct
+{
+  uint32_t wakeup_cnt;     /* [out] DMA completion interrupts since start */
+  uint32_t elapsed_ms;     /* [out] Time since start */
+  uint32_t wakeup_per_sec; /* [out] Average wakeups per second */
+} asDmacWakeupInfo;
+
 /**
  * @brief Stop DMAC
  *
@@ -350,6 +358,19 @@ E_AS AS_StopDmac(cxd56_audio_dma_t dmacId, asDmacStopMode stopMode);
  */
 E_AS AS_GetReadyCmdNumDmac(cxd56_audio_dma_t dmacId, uint32_t *pResult);
 
+/**
+ * @brief Get CPU wakeup statistics of the DMAC
+ *
+ * Each DMA completion interrupt wakes up the CPU. The count is
+ * cleared when DMAC is started.
+ *
+ * @param[in] cxd56_audio_dma_t DMAC ID
+ * @param[out] asDmacWakeupInfo* Wakeup statistics
+ *
+ * @retval E_AS return code
+ */
+E_AS AS_GetWakeupInfoDmac(cxd56_audio_dma_t dmacId, asDmacWakeupInfo *pInfo);
+
 /**
  * @brief Regist DMA callback from interrupt handler
  *
@@ -50,7 +50,7 @@
 
 /* Postfilter Version. */
 
-#define DSP_POSTFLTR_VERSION  0x010101    /* 01.01.01 */
+#define DSP_POSTFLTR_VERSION  0x010201    /* 01.02.01 */
 
 /****************************************************************************
  * Public Types
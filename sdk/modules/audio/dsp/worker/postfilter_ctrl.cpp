@@ -99,7 +99,12 @@ void PostFilterCtrl::init(Wien2::Apu::Wien2ApuCmd *cmd)
 {
   Wien2::Apu::ApuInitPostFilterCmd *init_cmd = &cmd->init_postfilter_cmd;
 
-  (void)init_cmd;
+  if (!m_engine.init(init_cmd->ch_num, init_cmd->bit_width))
+    {
+      cmd->result.exec_result = Wien2::Apu::ApuExecError;
+      return;
+    }
+
   cmd->result.exec_result = Wien2::Apu::ApuExecOK;
 
   m_state = ReadyStatus;
@@ -110,39 +115,17 @@ void PostFilterCtrl::exec(Wien2::Apu::Wien2ApuCmd *cmd)
 {
   Wien2::Apu::ApuExecPostFilterCmd *exec_cmd = &cmd->exec_postfilter_cmd;
 
-  /* !!tentative!! simply copy from input to output */
-
-  memcpy(exec_cmd->output_buffer.p_buffer,
-         exec_cmd->input_buffer.p_buffer,
-         exec_cmd->input_buffer.size);
-
-  //{
-  //  /* RC filter example */
-
-  //  int16_t *ls = (int16_t*)exec_cmd->output_buffer.p_buffer;
-  //  int16_t *rs = ls + 1;
-
-  //  static int16_t ls_l = 0;
-  //  static int16_t rs_l = 0;
+  if (exec_cmd->output_buffer.size < exec_cmd->input_buffer.size)
+    {
+      cmd->result.exec_result = Wien2::Apu::ApuExecError;
+      return;
+    }
 
-  //  if (!ls_l && !rs_l)
-  //    {
-  //      ls_l = *ls;
-  //      rs_l = *rs;
-  //    }
+  /* Filter is done in place when output buffer is same as input. */
 
-  //  for (uint32_t cnt = 0; cnt < exec_cmd->input_buffer.size; cnt += 4)
-  //    {
-  //      *ls = (ls_l * 99 / 100) + (*ls * 1 / 100);
-  //      *rs = (rs_l * 99 / 100) + (*rs * 1 / 100);
-
-  //      ls_l = *ls;
-  //      rs_l = *rs;
-
-  //      ls += 2;
-  //      rs += 2;
-  //    }
-  //}
+  m_engine.exec(exec_cmd->input_buffer.p_buffer,
+                exec_cmd->output_buffer.p_buffer,
+                exec_cmd->input_buffer.size);
 
   cmd->result.exec_result = Wien2::Apu::ApuExecOK;
 
@@ -155,6 +138,9 @@ void PostFilterCtrl::flush(Wien2::Apu::Wien2ApuCmd *cmd)
   Wien2::Apu::ApuFlushPostFilterCmd *flush_cmd = &cmd->flush_postfilter_cmd;
 
   (void)flush_cmd;
+
+  m_engine.flush();
+
   cmd->result.exec_result = Wien2::Apu::ApuExecOK;
 
   m_state = ReadyStatus;
@@ -163,7 +149,9 @@ void PostFilterCtrl::flush(Wien2::Apu::Wien2ApuCmd *cmd)
 /*--------------------------------------------------------------------*/
 void PostFilterCtrl::setparam(Wien2::Apu::Wien2ApuCmd *cmd)
 {
-  cmd->result.exec_result = Wien2::Apu::ApuExecOK;
+  cmd->result.exec_result =
+    (m_engine.set(cmd->setparam_postfilter_cmd)) ?
+      Wien2::Apu::ApuExecOK : Wien2::Apu::ApuExecError;
 }
 
 /*--------------------------------------------------------------------*/
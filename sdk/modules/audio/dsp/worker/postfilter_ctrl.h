@@ -40,6 +40,7 @@
 
 #include "apus/apu_cmd.h"
 #include "postfilter_command.h"
+#include "postfilter_engine.h"
 
 class PostFilterCtrl
 {
@@ -60,6 +61,8 @@ private:
   };
 
   StateType m_state;
+  PostFilterEngine m_engine;
+
   typedef void (PostFilterCtrl::*CtrlProc)(Wien2::Apu::Wien2ApuCmd *cmd);
   static CtrlProc CtrlFuncTbl[Wien2::Apu::ApuEventTypeNum][StateNum];
 
@@ -0,0 +1,524 @@
+/****************************************************************************
+ * modules/audio/dsp/worker/postfilter_engine.cpp
+ *
+ *   Copyright 2018 Sony Semiconductor Solutions Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Semiconductor Solutions Corporation nor
+ *    the names of its contributors may be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include <string.h>
+
+#ifdef __ARM_FEATURE_DSP
+#include <arm_acle.h>
+#endif
+
+#include "postfilter_engine.h"
+
+#define Q30_ONE      (1 << 30)
+#define GAIN_ONE     (1 << 16)
+#define AHEAD_MASK   (POSTFILTER_LIMITER_MAX_AHEAD - 1)
+
+/*--------------------------------------------------------------------*/
+static inline int32_t clip_q31(int64_t val)
+{
+  if (static_cast<int32_t>(val) != val)
+    {
+      return static_cast<int32_t>((val >> 63) ^ 0x7fffffff);
+    }
+
+  return static_cast<int32_t>(val);
+}
+
+/*--------------------------------------------------------------------*/
+static inline int16_t round_q15(int32_t val)
+{
+  /* Round Q31 to Q15 with saturation. */
+
+#ifdef __ARM_FEATURE_DSP
+  return static_cast<int16_t>(__ssat(__qadd(val, 0x8000) >> 16, 16));
+#else
+  int64_t tmp = (static_cast<int64_t>(val) + 0x8000) >> 16;
+
+  return (tmp > 32767) ? 32767 : static_cast<int16_t>(tmp);
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+static inline uint32_t abs_q15(int32_t val)
+{
+  /* |INT32_MIN| becomes 32768. */
+
+  return static_cast<uint32_t>((val < 0) ? -static_cast<int64_t>(val) : val)
+           >> 16;
+}
+
+/*--------------------------------------------------------------------*/
+bool PostFilterEngine::init(uint32_t ch_num, uint32_t bit_width)
+{
+  if (ch_num == 0 || POSTFILTER_MAX_CH < ch_num)
+    {
+      return false;
+    }
+
+  /* Accept both bit count and AudioPcmBitWidth. */
+
+  switch (bit_width)
+    {
+      case 16:
+      case Wien2::AudPcm16Bit:
+        m_bytes_per_sample = 2;
+        break;
+
+      case 24:
+      case 32:
+      case Wien2::AudPcm24Bit:
+      case Wien2::AudPcm32Bit:
+        m_bytes_per_sample = 4;
+        break;
+
+      default:
+        return false;
+    }
+
+  m_ch_num = ch_num;
+
+  clear_state();
+
+  return true;
+}
+
+/*--------------------------------------------------------------------*/
+bool PostFilterEngine::set(const Wien2::Apu::ApuSetParamPostFilterCmd &param)
+{
+  switch (param.param_type)
+    {
+      case Wien2::Apu::PostFilterParamEnable:
+        if (param.enable & ~(Wien2::Apu::PostFilterBlockEq |
+                             Wien2::Apu::PostFilterBlockWidth |
+                             Wien2::Apu::PostFilterBlockLimiter))
+          {
+            return false;
+          }
+
+        /* Start from silence state not to use old history */
+
+        if (param.enable != m_enable)
+          {
+            clear_state();
+          }
+
+        m_enable = param.enable;
+        break;
+
+      case Wien2::Apu::PostFilterParamEq:
+        if (POSTFILTER_EQ_BAND_NUM <= param.set_eq.band)
+          {
+            return false;
+          }
+
+        memcpy(m_eq[param.set_eq.band].coef,
+               param.set_eq.coef,
+               sizeof(m_eq[0].coef));
+        memset(m_eq[param.set_eq.band].state,
+               0,
+               sizeof(m_eq[0].state));
+        break;
+
+      case Wien2::Apu::PostFilterParamLimiter:
+        if (32767 < param.set_limiter.threshold
+         || param.set_limiter.lookahead == 0
+         || POSTFILTER_LIMITER_MAX_AHEAD < param.set_limiter.lookahead
+         || 32768 < param.set_limiter.release)
+          {
+            return false;
+          }
+
+        set_limiter(param.set_limiter.threshold,
+                    param.set_limiter.lookahead,
+                    param.set_limiter.release);
+        break;
+
+      case Wien2::Apu::PostFilterParamWidth:
+        if (param.set_width.width < 0)
+          {
+            return false;
+          }
+
+        set_width(param.set_width.width);
+        break;
+
+      default:
+        return false;
+    }
+
+  return true;
+}
+
+/*--------------------------------------------------------------------*/
+uint32_t PostFilterEngine::exec(const void *input, void *output, uint32_t size)
+{
+  uint32_t frame_size = m_bytes_per_sample * m_ch_num;
+  uint32_t frames = size / frame_size;
+
+  if (m_enable == 0)
+    {
+      if (input != output)
+        {
+          memmove(output, input, size);
+        }
+
+      return size;
+    }
+
+  const uint8_t *in  = static_cast<const uint8_t *>(input);
+  uint8_t       *out = static_cast<uint8_t *>(output);
+
+  while (frames > 0)
+    {
+      uint32_t chunk = (frames < POSTFILTER_WORK_FRAMES) ?
+                         frames : POSTFILTER_WORK_FRAMES;
+
+      load(in, chunk);
+
+      if (m_enable & Wien2::Apu::PostFilterBlockEq)
+        {
+          exec_eq(chunk);
+        }
+
+      if (m_enable & Wien2::Apu::PostFilterBlockWidth)
+        {
+          exec_width(chunk);
+        }
+
+      if (m_enable & Wien2::Apu::PostFilterBlockLimiter)
+        {
+          exec_limiter(chunk);
+        }
+
+      store(out, chunk);
+
+      in     += chunk * frame_size;
+      out    += chunk * frame_size;
+      frames -= chunk;
+    }
+
+  return size - (size % frame_size);
+}
+
+/*--------------------------------------------------------------------*/
+void PostFilterEngine::flush(void)
+{
+  /* Samples left in look-ahead buffer are discarded. */
+
+  clear_state();
+}
+
+/*--------------------------------------------------------------------*/
+void PostFilterEngine::reset_eq(void)
+{
+  /* Pass through (b0 = 1.0) */
+
+  memset(m_eq, 0, sizeof(m_eq));
+
+  for (uint32_t band = 0; band < POSTFILTER_EQ_BAND_NUM; band++)
+    {
+      m_eq[band].coef[0] = Q30_ONE;
+    }
+}
+
+/*--------------------------------------------------------------------*/
+void PostFilterEngine::set_width(int32_t width)
+{
+  m_width = width;
+}
+
+/*--------------------------------------------------------------------*/
+void PostFilterEngine::set_limiter(uint32_t threshold,
+                                   uint32_t ahead,
+                                   uint32_t release)
+{
+  bool reset = (ahead != m_limiter.ahead);
+
+  m_limiter.threshold = threshold;
+  m_limiter.ahead     = ahead;
+  m_limiter.release   = release;
+
+  /* Length of history is changed, restart limiter. */
+
+  if (reset)
+    {
+      m_limiter.pos      = 0;
+      m_limiter.gain     = GAIN_ONE;
+      m_limiter.gain_sum = GAIN_ONE * ahead;
+      m_limiter.min_head = 0;
+      m_limiter.min_tail = 0;
+
+      for (uint32_t i = 0; i < POSTFILTER_LIMITER_MAX_AHEAD; i++)
+        {
+          m_limiter.gain_hist[i] = GAIN_ONE;
+        }
+
+      memset(m_limiter.delay, 0, sizeof(m_limiter.delay));
+    }
+}
+
+/*--------------------------------------------------------------------*/
+void PostFilterEngine::clear_state(void)
+{
+  for (uint32_t band = 0; band < POSTFILTER_EQ_BAND_NUM; band++)
+    {
+      memset(m_eq[band].state, 0, sizeof(m_eq[band].state));
+    }
+
+  /* Force to restart limiter */
+
+  uint32_t ahead = m_limiter.ahead;
+
+  m_limiter.ahead = 0;
+  set_limiter(m_limiter.threshold, ahead, m_limiter.release);
+}
+
+/*--------------------------------------------------------------------*/
+void PostFilterEngine::load(const void *input, uint32_t frames)
+{
+  uint32_t samples = frames * m_ch_num;
+
+  if (m_bytes_per_sample == 2)
+    {
+      const int16_t *src = static_cast<const int16_t *>(input);
+
+      for (uint32_t i = 0; i < samples; i++)
+        {
+          m_work[i] = static_cast<int32_t>(src[i]) << 16;
+        }
+    }
+  else
+    {
+      memcpy(m_work, input, samples * sizeof(int32_t));
+    }
+}
+
+/*--------------------------------------------------------------------*/
+void PostFilterEngine::store(void *output, uint32_t frames)
+{
+  uint32_t samples = frames * m_ch_num;
+
+  if (m_bytes_per_sample == 2)
+    {
+      int16_t *dst = static_cast<int16_t *>(output);
+
+      for (uint32_t i = 0; i < samples; i++)
+        {
+          dst[i] = round_q15(m_work[i]);
+        }
+    }
+  else
+    {
+      memcpy(output, m_work, samples * sizeof(int32_t));
+    }
+}
+
+/*--------------------------------------------------------------------*/
+void PostFilterEngine::exec_eq(uint32_t frames)
+{
+  /* Direct form I biquad cascade, same as arm_biquad_cascade_df1_q31()
+   * with postShift = 1. Each stage is applied on the whole chunk so
+   * that coefficients and state stay in registers.
+   */
+
+  for (uint32_t band = 0; band < POSTFILTER_EQ_BAND_NUM; band++)
+    {
+      Biquad *bq = &m_eq[band];
+
+      int32_t b0 = bq->coef[0];
+      int32_t b1 = bq->coef[1];
+      int32_t b2 = bq->coef[2];
+      int32_t a1 = bq->coef[3];
+      int32_t a2 = bq->coef[4];
+
+      /* Skip stage which is pass through */
+
+      if (b0 == Q30_ONE && (b1 | b2 | a1 | a2) == 0)
+        {
+          continue;
+        }
+
+      for (uint32_t ch = 0; ch < m_ch_num; ch++)
+        {
+          int32_t x1 = bq->state[ch][0];
+          int32_t x2 = bq->state[ch][1];
+          int32_t y1 = bq->state[ch][2];
+          int32_t y2 = bq->state[ch][3];
+
+          int32_t *p = &m_work[ch];
+
+          for (uint32_t n = 0; n < frames; n++)
+            {
+              int32_t x0 = *p;
+              int64_t acc = static_cast<int64_t>(b0) * x0;
+
+              acc += static_cast<int64_t>(b1) * x1;
+              acc += static_cast<int64_t>(b2) * x2;
+              acc += static_cast<int64_t>(a1) * y1;
+              acc += static_cast<int64_t>(a2) * y2;
+
+              int32_t y0 = clip_q31(acc >> 30);
+
+              x2 = x1;
+              x1 = x0;
+              y2 = y1;
+              y1 = y0;
+
+              *p = y0;
+              p += m_ch_num;
+            }
+
+          bq->state[ch][0] = x1;
+          bq->state[ch][1] = x2;
+          bq->state[ch][2] = y1;
+          bq->state[ch][3] = y2;
+        }
+    }
+}
+
+/*--------------------------------------------------------------------*/
+void PostFilterEngine::exec_width(uint32_t frames)
+{
+  /* Scale side signal of M/S. Only for stereo. */
+
+  if (m_ch_num != 2 || m_width == Q30_ONE)
+    {
+      return;
+    }
+
+  int32_t *p = m_work;
+
+  for (uint32_t n = 0; n < frames; n++)
+    {
+      int32_t mid  = (p[0] >> 1) + (p[1] >> 1);
+      int32_t side = (p[0] >> 1) - (p[1] >> 1);
+      int64_t wide = (static_cast<int64_t>(side) * m_width) >> 30;
+
+      p[0] = clip_q31(mid + wide);
+      p[1] = clip_q31(mid - wide);
+
+      p += 2;
+    }
+}
+
+/*--------------------------------------------------------------------*/
+void PostFilterEngine::exec_limiter(uint32_t frames)
+{
+  /* Look-ahead peak limiter (stereo linked).
+   *
+   * Required gain of each frame is passed through a sliding minimum
+   * and a moving average of the same length L, and output is delayed
+   * by L - 1 frames. Every gain averaged for a delayed frame is less
+   * than the gain the frame requires, so output never exceeds
+   * threshold while gain changes smoothly over L frames.
+   */
+
+  Limiter *lim = &m_limiter;
+  uint32_t ahead = lim->ahead;
+  int32_t  *p = m_work;
+
+  for (uint32_t n = 0; n < frames; n++)
+    {
+      uint32_t pos = lim->pos;
+      uint32_t peak = 0;
+
+      for (uint32_t ch = 0; ch < m_ch_num; ch++)
+        {
+          uint32_t level = abs_q15(p[ch]);
+
+          peak = (level > peak) ? level : peak;
+        }
+
+      uint32_t need = (peak <= lim->threshold) ?
+                        GAIN_ONE : (lim->threshold << 16) / peak;
+
+      /* Sliding minimum over last L frames */
+
+      while (lim->min_head != lim->min_tail
+          && ahead <= pos - lim->min_pos[lim->min_head & AHEAD_MASK])
+        {
+          lim->min_head++;
+        }
+
+      while (lim->min_head != lim->min_tail
+          && need <= lim->min_val[(lim->min_tail - 1) & AHEAD_MASK])
+        {
+          lim->min_tail--;
+        }
+
+      lim->min_val[lim->min_tail & AHEAD_MASK] = need;
+      lim->min_pos[lim->min_tail & AHEAD_MASK] = pos;
+      lim->min_tail++;
+
+      /* Release */
+
+      uint32_t gain = lim->gain;
+
+      if (gain < GAIN_ONE)
+        {
+          uint32_t step = ((GAIN_ONE - gain) * lim->release) >> 15;
+
+          gain += (step > 0) ? step : 1;
+        }
+
+      uint32_t floor = lim->min_val[lim->min_head & AHEAD_MASK];
+
+      gain = (gain < floor) ? gain : floor;
+      lim->gain = gain;
+
+      /* Moving average */
+
+      lim->gain_sum -= lim->gain_hist[(pos - ahead) & AHEAD_MASK];
+      lim->gain_sum += gain;
+      lim->gain_hist[pos & AHEAD_MASK] = gain;
+
+      uint32_t apply = lim->gain_sum / ahead;
+
+      /* Delay and apply gain */
+
+      int32_t *in  = lim->delay[pos & AHEAD_MASK];
+      int32_t *out = lim->delay[(pos - ahead + 1) & AHEAD_MASK];
+
+      for (uint32_t ch = 0; ch < m_ch_num; ch++)
+        {
+          in[ch] = p[ch];
+          p[ch] = static_cast<int32_t>
+                    ((static_cast<int64_t>(out[ch]) * apply) >> 16);
+        }
+
+      lim->pos++;
+      p += m_ch_num;
+    }
+}
@@ -0,0 +1,146 @@
+/****************************************************************************
+ * modules/audio/dsp/worker/postfilter_engine.h
+ *
+ *   Copyright 2018 Sony Semiconductor Solutions Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Semiconductor Solutions Corporation nor
+ *    the names of its contributors may be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __POSTFILTER_ENGINE_H__
+#define __POSTFILTER_ENGINE_H__
+
+#include <stdint.h>
+
+#include "apus/apu_cmd.h"
+
+/* Number of biquad stages of equalizer. */
+
+#define POSTFILTER_EQ_BAND_NUM        5
+
+/* Maximum look-ahead length of limiter in frames.
+ * Must be a power of 2.
+ */
+
+#define POSTFILTER_LIMITER_MAX_AHEAD  128
+
+/* Number of frames converted to Q31 at once. */
+
+#define POSTFILTER_WORK_FRAMES        256
+
+#define POSTFILTER_MAX_CH             2
+
+/* Processing chain of postfilter DSP.
+ *
+ *   input -> EQ (biquad cascade) -> stereo widening -> limiter -> output
+ *
+ * All processing is done on Q1.31 samples. 16bit PCM and 24bit PCM
+ * (left justified in 32bit container) are supported. Each block is
+ * enabled by ApuPostFilterBlock mask and if nothing is enabled, data
+ * is passed through as it is.
+ */
+
+class PostFilterEngine
+{
+public:
+  PostFilterEngine()
+    : m_ch_num(POSTFILTER_MAX_CH)
+    , m_bytes_per_sample(2)
+    , m_enable(0)
+  {
+    /* EQ and widening are pass through. Limiter is 0dBFS clipper
+     * which releases in about 50ms at 48kHz.
+     */
+
+    reset_eq();
+    set_width(1 << 30);
+
+    m_limiter.ahead = 0;
+    set_limiter(32767, 1, 14);
+  }
+
+  bool init(uint32_t ch_num, uint32_t bit_width);
+  bool set(const Wien2::Apu::ApuSetParamPostFilterCmd &param);
+  uint32_t exec(const void *input, void *output, uint32_t size);
+  void flush(void);
+
+private:
+  struct Biquad
+  {
+    int32_t coef[5];                      /* b0, b1, b2, a1, a2 (Q2.30) */
+    int32_t state[POSTFILTER_MAX_CH][4];  /* x[n-1], x[n-2], y[n-1], y[n-2] */
+  };
+
+  struct Limiter
+  {
+    uint32_t threshold;  /* Peak level (Q15) */
+    uint32_t ahead;      /* Look-ahead length (frames) */
+    uint32_t release;    /* Gain recovery per frame (Q15) */
+
+    uint32_t pos;        /* Frame counter */
+    uint32_t gain;       /* Gain after release (Q16) */
+    uint32_t gain_sum;   /* Sum of gain history (Q16) */
+
+    /* Sliding window minimum of required gain */
+
+    uint32_t min_head;
+    uint32_t min_tail;
+    uint32_t min_val[POSTFILTER_LIMITER_MAX_AHEAD];
+    uint32_t min_pos[POSTFILTER_LIMITER_MAX_AHEAD];
+
+    /* History of gain and delayed samples */
+
+    uint32_t gain_hist[POSTFILTER_LIMITER_MAX_AHEAD];
+    int32_t  delay[POSTFILTER_LIMITER_MAX_AHEAD][POSTFILTER_MAX_CH];
+  };
+
+  uint32_t m_ch_num;
+  uint32_t m_bytes_per_sample;
+  uint32_t m_enable;
+
+  Biquad   m_eq[POSTFILTER_EQ_BAND_NUM];
+  int32_t  m_width;
+  Limiter  m_limiter;
+
+  int32_t  m_work[POSTFILTER_WORK_FRAMES * POSTFILTER_MAX_CH];
+
+  void reset_eq(void);
+  void set_width(int32_t width);
+  void set_limiter(uint32_t threshold, uint32_t ahead, uint32_t release);
+  void clear_state(void);
+
+  void load(const void *input, uint32_t frames);
+  void store(void *output, uint32_t frames);
+
+  void exec_eq(uint32_t frames);
+  void exec_width(uint32_t frames);
+  void exec_limiter(uint32_t frames);
+};
+
+#endif /* __POSTFILTER_ENGINE_H__ */
@@ -44,6 +44,7 @@
 #include <asmp/mptask.h>
 #include <asmp/mpmq.h>
 #include <pthread.h>
+#include <semaphore.h>
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -52,6 +53,10 @@
 #define DSP_COM_DATA_TYPE_STRUCT_ADDRESS  0
 #define DSP_COM_DATA_TYPE_32BIT_VALUE     1
 
+/* Maximum length of DSP image path which can be kept resident. */
+
+#define DSPDRV_FILENAME_LEN               64
+
 typedef enum {
   DSPDRV_NOERROR = 0,       /* Dsp driver load success.                */
   DSPDRV_FILENAME_EMPTY,    /* No file name.                           */
@@ -60,7 +65,8 @@ typedef enum {
   DSPDRV_CREATE_FAIL,       /* Failed to Create DspDrv Class instance. */
   DSPDRV_INIT_MPTASK_FAIL,  /* Failed on DspDrv Init mptask sequence.  */
   DSPDRV_INIT_MPMQ_FAIL,    /* Failed on DspDrv Init mpmq sequence.    */
-  DSPDRV_INIT_PTHREAD_FAIL  /* Failed on DspDrv Init pthread sequence. */
+  DSPDRV_INIT_PTHREAD_FAIL, /* Failed on DspDrv Init pthread sequence. */
+  DSPDRV_NOT_SUPPORTED      /* DSP image cache is not enabled.         */
 } dspdrv_errorcode_e;
 
 struct DspDrvComPrm_s
@@ -83,6 +89,29 @@ typedef struct DspDrvComPrm_s DspDrvComPrm_t;
 
 typedef void (*DspDoneCallback)(FAR void *, FAR void *);
 
+/* Time taken to make a DSP ready. */
+
+struct DspDrvLoadTime_s
+{
+  uint32_t load_us;  /* From start of load to start of worker.      */
+  uint32_t boot_us;  /* From start of load to boot notification.
+                      * 0 until the worker boots. */
+  bool     cached;   /* Resident image was reused. Times above are
+                      * of the original load. */
+};
+typedef struct DspDrvLoadTime_s DspDrvLoadTime_t;
+
+/* Statistics of DSP image cache. */
+
+struct DspDrvCacheStat_s
+{
+  uint32_t hit;       /* Loads served by a resident image.   */
+  uint32_t miss;      /* Loads which read image from a file. */
+  uint32_t evict;     /* Resident images unloaded.           */
+  uint32_t resident;  /* Images resident now.                */
+};
+typedef struct DspDrvCacheStat_s DspDrvCacheStat_t;
+
 #ifdef __cplusplus
 class DspDrv
 {
@@ -95,7 +124,24 @@ public:
   int send(FAR const DspDrvComPrm_t *p_param);
   int receive();
 
-  DspDrv() {}
+  void setCallback(DspDoneCallback p_cbfunc, FAR void *p_parent_instance);
+  void waitBoot(void);
+  void notifyBoot(void);
+  void getLoadTime(FAR DspDrvLoadTime_t *p_time);
+
+  bool setName(FAR const char *pfilename);
+  bool isNamed(FAR const char *pfilename);
+  bool isCacheable(void) { return m_filename[0] != '\0' && m_booted; }
+
+  DspDrv()
+    : m_booted(false)
+    , m_cached(false)
+    , m_boot_inf(0)
+    , m_load_us(0)
+    , m_boot_us(0)
+  {
+    m_filename[0] = '\0';
+  }
   ~DspDrv() {}
 
 private:
@@ -106,6 +152,19 @@ private:
   pthread_t m_thread_id;
 
   FAR void *m_p_parent_instance;
+
+  /* Boot notification is kept to replay it when the worker is reused. */
+
+  sem_t     m_boot_sem;
+  bool      m_booted;
+  bool      m_cached;
+  uint32_t  m_boot_inf;
+
+  uint64_t  m_start_us;
+  uint32_t  m_load_us;
+  uint32_t  m_boot_us;
+
+  char      m_filename[DSPDRV_FILENAME_LEN];
 };
 #endif
 
@@ -130,4 +189,39 @@ extern int DD_Unload(FAR const void *p_instance);
 
 extern int DD_force_Unload(FAR const void *p_instance);
 
+/* DSP image cache (CONFIG_AUDIOUTILS_DSP_CACHE).
+ *
+ * DD_LoadCached() is DD_Load() which reuses a resident worker of the
+ * same image if there is one. Its boot notification is replayed to the
+ * new callback, so callers wait for boot as usual. DD_Unload() of such a
+ * worker keeps it running as resident instead of destroying it, the
+ * least recently used one is destroyed when the cache is full.
+ * Without the cache, DD_LoadCached() is the same as DD_Load().
+ * Workers are keyed by image only, and the worker keeps its state of the
+ * former owner. The new owner must initialize it before use, and images
+ * loaded in different roles (e.g. master and slave) must use DD_Load().
+ * Resident workers are destroyed when any of DD_Load(), DD_Load_Secure()
+ * or DD_LoadCached() fails to create a worker task, and it is retried.
+ */
+
+extern int DD_LoadCached(FAR const char  *filename,
+                         DspDoneCallback p_cbfunc,
+                         FAR void        *p_parent_instance,
+                         FAR void        **dsp_handler);
+
+/* Load and boot a worker and keep it resident. Nothing is done if the
+ * image is already resident.
+ */
+
+extern int DD_Preload(FAR const char *filename);
+
+/* Destroy resident workers of the image. NULL destroys all of them. */
+
+extern int DD_Purge(FAR const char *filename);
+
+extern int DD_GetLoadTime(FAR const void       *p_instance,
+                          FAR DspDrvLoadTime_t *p_time);
+
+extern void DD_GetCacheStat(FAR DspDrvCacheStat_t *p_stat);
+
 #endif /* __MODULES_AUDIO_DSP_DRIVER_INCLUDE_DSP_DRV_H */
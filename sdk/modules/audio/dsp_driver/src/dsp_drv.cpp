@@ -47,6 +47,7 @@
 #include <debug.h>
 #include <errno.h>
 #include <assert.h>
+#include <time.h>
 
 #include "dsp_drv.h"
 
@@ -60,6 +61,11 @@
 
 #define KEY_MQ 2
 
+/* Boot notification of worker. Must be synchronized with worker. */
+
+#define BOOT_PROCESS_MODE 0
+#define BOOT_EVENT_TYPE   0
+
 /* Check configuration.  This is not all of the configuration settings that
  * are required -- only the more obvious.
  */
@@ -100,10 +106,25 @@
  * Private Types
  ****************************************************************************/
 
+#ifdef CONFIG_AUDIOUTILS_DSP_CACHE
+struct DspCacheEntry
+{
+  FAR DspDrv *p_drv;      /* Resident worker, NULL if entry is free. */
+  uint32_t   last_used;   /* Value of s_cache_clock when it was put. */
+};
+#endif
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
 
+#ifdef CONFIG_AUDIOUTILS_DSP_CACHE
+static DspCacheEntry s_cache[CONFIG_AUDIOUTILS_DSP_CACHE_NUM];
+static uint32_t s_cache_clock;
+static DspDrvCacheStat_t s_cache_stat;
+static pthread_mutex_t s_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
 /****************************************************************************
  * Symbols from Auto-Generated Code
  ****************************************************************************/
@@ -112,6 +133,16 @@
  * Private Functions
  ****************************************************************************/
 
+static uint64_t get_time_us(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+/*--------------------------------------------------------------------------*/
 extern "C" CODE void *dd_receiver_thread(FAR void *p_instance)
 {
   do
@@ -137,6 +168,10 @@ int DspDrv::init(FAR const char  *pfilename,
   m_p_cb_func = p_cbfunc;
   m_p_parent_instance = p_parent_instance;
 
+  m_start_us = get_time_us();
+  m_booted   = false;
+  sem_init(&m_boot_sem, 0, 0);
+
   if (is_secure)
     {
       /* Initialize MP task. */
@@ -145,6 +180,7 @@ int DspDrv::init(FAR const char  *pfilename,
       if (ret < 0)
         {
           err("mptask_init_secure() failure. %d\n", ret);
+          sem_destroy(&m_boot_sem);
           return DSPDRV_INIT_MPTASK_FAIL;
         }
     }
@@ -156,6 +192,7 @@ int DspDrv::init(FAR const char  *pfilename,
       if (ret < 0)
         {
           err("mptask_init() failure. %d\n", ret);
+          sem_destroy(&m_boot_sem);
           return DSPDRV_INIT_MPTASK_FAIL;
         }
     }
@@ -164,6 +201,7 @@ int DspDrv::init(FAR const char  *pfilename,
   if (ret < 0)
     {
       err("mptask_assign() failure. %d\n", ret);
+      sem_destroy(&m_boot_sem);
       return DSPDRV_INIT_MPTASK_FAIL;
     }
 
@@ -230,6 +268,7 @@ int DspDrv::init(FAR const char  *pfilename,
     }
   else
     {
+      m_load_us = (uint32_t)(get_time_us() - m_start_us);
       return DSPDRV_NOERROR;
     }
 
@@ -241,6 +280,8 @@ dsp_drv_errout_with_mptask_destroy:
   ret = mptask_destroy(&m_mptask, false, NULL);
   DEBUGASSERT(ret == 0);
 
+  sem_destroy(&m_boot_sem);
+
   return errout_ret;
 }
 
@@ -284,6 +325,8 @@ int DspDrv::destroy(bool force)
       return DSPDRV_INIT_MPMQ_FAIL;
     }
 
+  sem_destroy(&m_boot_sem);
+
   return DSPDRV_NOERROR;
 }
 
@@ -331,6 +374,19 @@ int DspDrv::receive()
       param.event_type   = (command >> 1) & 0x7;
       param.type         = (command >> 0) & 0x1;
       param.data.value   = msgdata;
+
+      if (!m_booted &&
+          param.process_mode == BOOT_PROCESS_MODE &&
+          param.event_type == BOOT_EVENT_TYPE)
+        {
+          /* Keep boot notification to replay it on reuse. */
+
+          m_boot_inf = msgdata;
+          m_boot_us  = (uint32_t)(get_time_us() - m_start_us);
+          m_booted   = true;
+          sem_post(&m_boot_sem);
+        }
+
       m_p_cb_func((FAR void *)&param, m_p_parent_instance);
 
       if (param.event_type == 7)
@@ -342,6 +398,282 @@ int DspDrv::receive()
   return DSPDRV_NOERROR;
 }
 
+/*--------------------------------------------------------------------------*/
+void DspDrv::setCallback(DspDoneCallback p_cbfunc,
+                         FAR void        *p_parent_instance)
+{
+  /* Only called while worker has no command in process, so receiver
+   * thread does not use these at the same time.
+   */
+
+  m_p_parent_instance = p_parent_instance;
+  m_p_cb_func = p_cbfunc;
+}
+
+/*--------------------------------------------------------------------------*/
+void DspDrv::waitBoot(void)
+{
+  while (sem_wait(&m_boot_sem) != 0)
+    {
+      DEBUGASSERT(errno == EINTR);
+    }
+}
+
+/*--------------------------------------------------------------------------*/
+void DspDrv::notifyBoot(void)
+{
+  DspDrvComPrm_t param;
+
+  param.process_mode = BOOT_PROCESS_MODE;
+  param.event_type   = BOOT_EVENT_TYPE;
+  param.type         = DSP_COM_DATA_TYPE_32BIT_VALUE;
+  param.data.value   = m_boot_inf;
+
+  m_cached = true;
+  m_p_cb_func((FAR void *)&param, m_p_parent_instance);
+}
+
+/*--------------------------------------------------------------------------*/
+void DspDrv::getLoadTime(FAR DspDrvLoadTime_t *p_time)
+{
+  p_time->load_us = m_load_us;
+  p_time->boot_us = m_booted ? m_boot_us : 0;
+  p_time->cached  = m_cached;
+}
+
+/*--------------------------------------------------------------------------*/
+bool DspDrv::setName(FAR const char *pfilename)
+{
+  if (strlen(pfilename) >= sizeof(m_filename))
+    {
+      return false;
+    }
+
+  strncpy(m_filename, pfilename, sizeof(m_filename));
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool DspDrv::isNamed(FAR const char *pfilename)
+{
+  return strncmp(m_filename, pfilename, sizeof(m_filename)) == 0;
+}
+
+#ifdef CONFIG_AUDIOUTILS_DSP_CACHE
+/*--------------------------------------------------------------------------*/
+static void dd_idle_callback(FAR void *p_response, FAR void *p_instance)
+{
+  /* Resident worker has no owner. Nothing to do. */
+}
+
+/*--------------------------------------------------------------------------*/
+static FAR DspDrv *dd_cache_take(FAR const char *filename)
+{
+  FAR DspDrv *p_drv = NULL;
+
+  pthread_mutex_lock(&s_cache_lock);
+
+  for (int i = 0; i < CONFIG_AUDIOUTILS_DSP_CACHE_NUM; i++)
+    {
+      if (s_cache[i].p_drv != NULL && s_cache[i].p_drv->isNamed(filename))
+        {
+          p_drv = s_cache[i].p_drv;
+          s_cache[i].p_drv = NULL;
+          s_cache_stat.resident--;
+          break;
+        }
+    }
+
+  if (p_drv != NULL)
+    {
+      s_cache_stat.hit++;
+    }
+  else
+    {
+      s_cache_stat.miss++;
+    }
+
+  pthread_mutex_unlock(&s_cache_lock);
+
+  return p_drv;
+}
+
+/*--------------------------------------------------------------------------*/
+static FAR DspDrv *dd_cache_put(FAR DspDrv *p_drv)
+{
+  /* Returns the worker to be destroyed, NULL if none. */
+
+  FAR DspDrv *p_victim = NULL;
+  int slot = 0;
+
+  pthread_mutex_lock(&s_cache_lock);
+
+  for (int i = 0; i < CONFIG_AUDIOUTILS_DSP_CACHE_NUM; i++)
+    {
+      if (s_cache[i].p_drv == NULL)
+        {
+          slot = i;
+          break;
+        }
+
+      if ((int32_t)(s_cache[i].last_used - s_cache[slot].last_used) < 0)
+        {
+          slot = i;
+        }
+    }
+
+  if (s_cache[slot].p_drv != NULL)
+    {
+      p_victim = s_cache[slot].p_drv;
+      s_cache_stat.evict++;
+    }
+  else
+    {
+      s_cache_stat.resident++;
+    }
+
+  s_cache[slot].p_drv     = p_drv;
+  s_cache[slot].last_used = s_cache_clock++;
+
+  pthread_mutex_unlock(&s_cache_lock);
+
+  return p_victim;
+}
+
+/*--------------------------------------------------------------------------*/
+static bool dd_cache_exist(FAR const char *filename)
+{
+  bool exist = false;
+
+  pthread_mutex_lock(&s_cache_lock);
+
+  for (int i = 0; i < CONFIG_AUDIOUTILS_DSP_CACHE_NUM; i++)
+    {
+      if (s_cache[i].p_drv != NULL && s_cache[i].p_drv->isNamed(filename))
+        {
+          exist = true;
+          break;
+        }
+    }
+
+  pthread_mutex_unlock(&s_cache_lock);
+
+  return exist;
+}
+
+/*--------------------------------------------------------------------------*/
+static int dd_cache_purge(FAR const char *filename, FAR int *p_count)
+{
+  FAR DspDrv *victim[CONFIG_AUDIOUTILS_DSP_CACHE_NUM];
+  int num = 0;
+  int ret = DSPDRV_NOERROR;
+
+  pthread_mutex_lock(&s_cache_lock);
+
+  for (int i = 0; i < CONFIG_AUDIOUTILS_DSP_CACHE_NUM; i++)
+    {
+      if (s_cache[i].p_drv != NULL &&
+          (filename == NULL || s_cache[i].p_drv->isNamed(filename)))
+        {
+          victim[num++] = s_cache[i].p_drv;
+          s_cache[i].p_drv = NULL;
+          s_cache_stat.resident--;
+          s_cache_stat.evict++;
+        }
+    }
+
+  pthread_mutex_unlock(&s_cache_lock);
+
+  /* Destroy out of lock, it waits for worker and receiver thread. */
+
+  for (int i = 0; i < num; i++)
+    {
+      int result = victim[i]->destroy(false);
+      if (result == DSPDRV_NOERROR)
+        {
+          delete victim[i];
+        }
+      else
+        {
+          ret = result;
+        }
+    }
+
+  if (p_count != NULL)
+    {
+      *p_count = num;
+    }
+
+  return ret;
+}
+#endif /* CONFIG_AUDIOUTILS_DSP_CACHE */
+
+/*--------------------------------------------------------------------------*/
+static int dd_init(FAR const char  *filename,
+                   DspDoneCallback p_cbfunc,
+                   FAR void        *p_parent_instance,
+                   bool            is_secure,
+                   FAR DspDrv      **pp_instance)
+{
+  FAR DspDrv *p_instance = new DspDrv;
+
+  if (p_instance == NULL)
+    {
+      return DSPDRV_CREATE_FAIL;
+    }
+
+  int ret = p_instance->init(filename,
+                             p_cbfunc,
+                             p_parent_instance,
+                             is_secure);
+  if (ret != DSPDRV_NOERROR)
+    {
+      delete p_instance;
+      return ret;
+    }
+
+  *pp_instance = p_instance;
+
+  return DSPDRV_NOERROR;
+}
+
+/*--------------------------------------------------------------------------*/
+static int dd_create(FAR const char  *filename,
+                     DspDoneCallback p_cbfunc,
+                     FAR void        *p_parent_instance,
+                     bool            is_secure,
+                     FAR DspDrv      **pp_instance)
+{
+  int ret = dd_init(filename,
+                    p_cbfunc,
+                    p_parent_instance,
+                    is_secure,
+                    pp_instance);
+
+#ifdef CONFIG_AUDIOUTILS_DSP_CACHE
+  if (ret == DSPDRV_INIT_MPTASK_FAIL)
+    {
+      /* Resident workers may occupy the CPU or memory needed.
+       * Release them and try once more.
+       */
+
+      int count;
+      dd_cache_purge(NULL, &count);
+      if (count > 0)
+        {
+          ret = dd_init(filename,
+                        p_cbfunc,
+                        p_parent_instance,
+                        is_secure,
+                        pp_instance);
+        }
+    }
+#endif
+
+  return ret;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -363,27 +695,21 @@ int DD_Load(FAR const char  *filename,
     {
       return DSPDRV_INVALID_VALUE;
     }
-  FAR DspDrv *p_instance = new DspDrv;
-  *dsp_handler = p_instance;
 
-  if (p_instance == NULL)
+  FAR DspDrv *p_instance;
+
+  int ret = dd_create(filename,
+                      p_cbfunc,
+                      p_parent_instance,
+                      false,
+                      &p_instance);
+  if (ret != DSPDRV_NOERROR)
     {
-      return DSPDRV_CREATE_FAIL;
+      return ret;
     }
-  else
-    {
-      /* Initialize DspDriver. */
 
-      int ret = p_instance->init(filename,
-                                 p_cbfunc,
-                                 p_parent_instance,
-                                 false);
-      if (ret != DSPDRV_NOERROR)
-        {
-          delete ((FAR DspDrv*)p_instance);
-          return ret;
-        }
-    }
+  *dsp_handler = p_instance;
+
   return DSPDRV_NOERROR;
 }
 
@@ -397,7 +723,7 @@ int DD_Load_Secure(FAR const char  *filename,
     {
       return DSPDRV_FILENAME_EMPTY;
     }
-  if ( p_cbfunc == NULL)
+  if (p_cbfunc == NULL)
     {
       return DSPDRV_CALLBACK_ERROR;
     }
@@ -406,27 +732,20 @@ int DD_Load_Secure(FAR const char  *filename,
       return DSPDRV_INVALID_VALUE;
     }
 
-  FAR DspDrv *p_instance = new DspDrv;
-  *dsp_handler = p_instance;
+  FAR DspDrv *p_instance;
 
-  if (p_instance == NULL)
+  int ret = dd_create(filename,
+                      p_cbfunc,
+                      p_parent_instance,
+                      true,
+                      &p_instance);
+  if (ret != DSPDRV_NOERROR)
     {
-      return DSPDRV_CREATE_FAIL;
+      return ret;
     }
-  else
-    {
-      /* Initialize DspDriver. */
 
-      int ret = p_instance->init(filename,
-                                 p_cbfunc,
-                                 p_parent_instance,
-                                 true);
-      if (ret != DSPDRV_NOERROR)
-        {
-          delete ((FAR DspDrv*)p_instance);
-          return ret;
-        }
-    }
+  *dsp_handler = p_instance;
+
   return DSPDRV_NOERROR;
 }
 
@@ -452,10 +771,29 @@ int DD_Unload(FAR const void *p_instance)
       return DSPDRV_INVALID_VALUE;
     }
 
-  int ret = ((FAR DspDrv*)p_instance)->destroy(false);
+  FAR DspDrv *p_drv = (FAR DspDrv*)p_instance;
+
+#ifdef CONFIG_AUDIOUTILS_DSP_CACHE
+  if (p_drv->isCacheable())
+    {
+      /* Keep worker running and destroy the oldest resident one
+       * instead if cache is full.
+       */
+
+      p_drv->setCallback(dd_idle_callback, NULL);
+
+      p_drv = dd_cache_put(p_drv);
+      if (p_drv == NULL)
+        {
+          return DSPDRV_NOERROR;
+        }
+    }
+#endif
+
+  int ret = p_drv->destroy(false);
   if (ret == DSPDRV_NOERROR)
     {
-      delete ((FAR DspDrv*)p_instance);
+      delete p_drv;
     }
 
   return ret;
@@ -478,3 +816,147 @@ int DD_force_Unload(FAR const void *p_instance)
   return ret;
 }
 
+
+/*--------------------------------------------------------------------------*/
+int DD_LoadCached(FAR const char  *filename,
+                  DspDoneCallback p_cbfunc,
+                  FAR void        *p_parent_instance,
+                  FAR void        **dsp_handler)
+{
+#ifdef CONFIG_AUDIOUTILS_DSP_CACHE
+  if (filename == NULL)
+    {
+      return DSPDRV_FILENAME_EMPTY;
+    }
+  if (p_cbfunc == NULL)
+    {
+      return DSPDRV_CALLBACK_ERROR;
+    }
+  if (dsp_handler == NULL)
+    {
+      return DSPDRV_INVALID_VALUE;
+    }
+
+  FAR DspDrv *p_instance = dd_cache_take(filename);
+
+  if (p_instance != NULL)
+    {
+      /* Worker is already booted. Give its boot notification to
+       * new owner as if it was loaded now.
+       */
+
+      p_instance->setCallback(p_cbfunc, p_parent_instance);
+      *dsp_handler = p_instance;
+      p_instance->notifyBoot();
+
+      return DSPDRV_NOERROR;
+    }
+
+  int ret = dd_create(filename,
+                      p_cbfunc,
+                      p_parent_instance,
+                      false,
+                      &p_instance);
+  if (ret != DSPDRV_NOERROR)
+    {
+      return ret;
+    }
+
+  /* Image of too long path is loaded but not kept resident. */
+
+  (void)p_instance->setName(filename);
+
+  *dsp_handler = p_instance;
+
+  return DSPDRV_NOERROR;
+#else
+  return DD_Load(filename, p_cbfunc, p_parent_instance, dsp_handler);
+#endif
+}
+
+/*--------------------------------------------------------------------------*/
+int DD_Preload(FAR const char *filename)
+{
+#ifdef CONFIG_AUDIOUTILS_DSP_CACHE
+  if (filename == NULL)
+    {
+      return DSPDRV_FILENAME_EMPTY;
+    }
+
+  if (dd_cache_exist(filename))
+    {
+      return DSPDRV_NOERROR;
+    }
+
+  FAR DspDrv *p_instance;
+
+  int ret = dd_create(filename, dd_idle_callback, NULL, false, &p_instance);
+  if (ret != DSPDRV_NOERROR)
+    {
+      return ret;
+    }
+
+  (void)p_instance->setName(filename);
+
+  p_instance->waitBoot();
+
+  if (!p_instance->isCacheable())
+    {
+      /* Path is too long to be looked up later. */
+
+      p_instance->destroy(false);
+      delete p_instance;
+      return DSPDRV_INVALID_VALUE;
+    }
+
+  FAR DspDrv *p_victim = dd_cache_put(p_instance);
+  if (p_victim != NULL)
+    {
+      ret = p_victim->destroy(false);
+      if (ret == DSPDRV_NOERROR)
+        {
+          delete p_victim;
+        }
+    }
+
+  return ret;
+#else
+  return DSPDRV_NOT_SUPPORTED;
+#endif
+}
+
+/*--------------------------------------------------------------------------*/
+int DD_Purge(FAR const char *filename)
+{
+#ifdef CONFIG_AUDIOUTILS_DSP_CACHE
+  return dd_cache_purge(filename, NULL);
+#else
+  return DSPDRV_NOT_SUPPORTED;
+#endif
+}
+
+/*--------------------------------------------------------------------------*/
+int DD_GetLoadTime(FAR const void       *p_instance,
+                   FAR DspDrvLoadTime_t *p_time)
+{
+  if (p_instance == NULL || p_time == NULL)
+    {
+      return DSPDRV_INVALID_VALUE;
+    }
+
+  ((FAR DspDrv*)p_instance)->getLoadTime(p_time);
+
+  return DSPDRV_NOERROR;
+}
+
+/*--------------------------------------------------------------------------*/
+void DD_GetCacheStat(FAR DspDrvCacheStat_t *p_stat)
+{
+#ifdef CONFIG_AUDIOUTILS_DSP_CACHE
+  pthread_mutex_lock(&s_cache_lock);
+  *p_stat = s_cache_stat;
+  pthread_mutex_unlock(&s_cache_lock);
+#else
+  memset(p_stat, 0, sizeof(DspDrvCacheStat_t));
+#endif
+}
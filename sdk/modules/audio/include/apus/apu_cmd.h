@@ -630,10 +630,52 @@ public:
  * Set paramter processing
  */
 
+/* Biquad stage of equalizer */
+
+struct SetPostFilterEqParam
+{
+public:
+  uint8_t  band;     /**< Index of biquad stage */
+  int32_t  coef[5];  /**< b0, b1, b2, a1, a2 in Q2.30. a1 and a2 are */
+                     /**<  sign inverted, i.e. y[n] = b0 * x[n] + ... */
+                     /**<  + a1 * y[n-1] + a2 * y[n-2] */
+};
+
+/* Look-ahead limiter */
+
+struct SetPostFilterLimiterParam
+{
+public:
+  uint16_t  threshold;  /**< Peak level in Q15 (32767 = 0dBFS) */
+  uint16_t  lookahead;  /**< Look-ahead length in frames */
+                        /**<  (1 means no look-ahead) */
+  uint16_t  release;    /**< Gain recovery per frame in Q15 */
+};
+
+/* Stereo widening */
+
+struct SetPostFilterWidthParam
+{
+public:
+  int32_t  width;  /**< Gain of side signal in Q2.30 (1.0 = unchanged) */
+};
+
 struct ApuSetParamPostFilterCmd
 {
 public:
+  ApuPostFilterParamType  param_type;  /**< Type of parameter */
+  union
+  {
+    uint32_t                   enable;       /**< ApuPostFilterBlock mask */
+    SetPostFilterEqParam       set_eq;       /**< Equalizer stage */
+    SetPostFilterLimiterParam  set_limiter;  /**< Limiter parameter */
+    SetPostFilterWidthParam    set_width;    /**< Widening parameter */
+  };
+#if !defined(__CC_ARM)
 };
+#else
+} __attribute__((transparent_union));
+#endif
 
 /****************************************************************************/
 /**
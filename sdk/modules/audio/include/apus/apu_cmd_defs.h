@@ -123,6 +123,25 @@ enum SetParamType
   SetParamTypeNum
 };
 
+enum ApuPostFilterParamType
+{
+  InvalidPostFilterParamType = 0xFF,
+  PostFilterParamEnable = 0,
+  PostFilterParamEq,
+  PostFilterParamLimiter,
+  PostFilterParamWidth,
+  PostFilterParamTypeNum
+};
+
+/* Processing blocks of postfilter (bit mask) */
+
+enum ApuPostFilterBlock
+{
+  PostFilterBlockEq      = 0x01,
+  PostFilterBlockWidth   = 0x02,
+  PostFilterBlockLimiter = 0x04
+};
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -312,12 +312,39 @@ typedef struct info_stream_mux_config_s InfoStreamMuxConfig;
  * Get top of next LATM
  *
  * arg1 : Top of LOAS/LATM(ex, top of payload)
- * arg2 : Top of information structure (see above)
+ * arg2 : Size of the data from arg1 (bytes after it are not read)
+ * arg3 : Top of information structure (see above)
  *
  * return : Top of next LATM frame begin with current LATM frame which is appointed by arg1.
  *          0=NG(AudioObjectType which is written in LATM header is out of support)
+ *
+ * note : Bits after arg2 bytes are taken as 0.
  */
 FAR uint8_t *AACLC_getNextLatm(FAR uint8_t *ptr_readbuff,
+                               uint32_t readbuff_size,
                                FAR InfoStreamMuxConfig *ptr_stream_mux_config);
 
+/*
+ * AACLC_findLoas()
+ *
+ * Search top of LOAS frame (AudioSyncStream) to synchronize with
+ *
+ * arg1 : Top of the data to search
+ * arg2 : Size of the data from arg1 (bytes after it are not read)
+ * arg3 : [out] Size of the found frame (3 bytes header + AudioMuxElement)
+ *
+ * return : Top of the LOAS frame. 0=NG(No frame in the data)
+ *
+ * note : A syncword is taken as a frame if its length is not 0 and
+ *        the next 2 frames begin with a valid header as well. Headers
+ *        after arg2 bytes can not be checked, and are trusted.
+ *        A frame holding other frames which end at its end is taken
+ *        as a false one (e.g. a cut frame), and the first of them is
+ *        returned.
+ *        The AudioMuxElement begins at 3 bytes from the returned top.
+ */
+FAR uint8_t *AACLC_findLoas(FAR uint8_t *ptr_readbuff,
+                            uint32_t readbuff_size,
+                            FAR uint32_t *ptr_frame_size);
+
 #endif /* __MODULES_AUDIO_INCLUDE_COMMON_LATMAACLC_H_ */
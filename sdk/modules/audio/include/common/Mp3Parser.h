@@ -83,6 +83,14 @@
 #define MP3PARSER_SYNCWORD_1    0xFF
 #define MP3PARSER_SYNCWORD_2    0xF0
 
+/* 1st and 2nd byte of syncword as one 16bit pattern
+ * for the syncword scanner.
+ */
+
+#define MP3PARSER_SYNCWORD_MASK     ((MP3PARSER_SYNCWORD_1 << 8) | \
+                                     MP3PARSER_SYNCWORD_2)
+#define MP3PARSER_SYNCWORD_PATTERN  MP3PARSER_SYNCWORD_MASK
+
 /* For checking any items (reserved will not use) */
 
 #define MP3PARSER_FS_RESERVED        3    /* '11' */
@@ -250,6 +258,38 @@
 #define MP3PARSER_ID3V1_ID3     0x47  /* 'G' */
 #define MP3PARSER_ID3V1_ID4     0x2B  /* '+' */
 
+/* Xing/Info and VBRI header (in the 1st frame of VBR streams) */
+
+#define MP3PARSER_XING_FLAG_FRAMES  0x01
+#define MP3PARSER_XING_FLAG_BYTES   0x02
+#define MP3PARSER_XING_FLAG_TOC     0x04
+#define MP3PARSER_XING_FLAG_QUALITY 0x08
+
+/* LAME extension placed after the Xing/Info header.
+ * version string(9) ... delay(12bit) padding(12bit) at offset 21
+ */
+
+#define MP3PARSER_LAME_TAG_LEN      24
+#define MP3PARSER_LAME_DELAY_OFFSET 21
+
+/* Offset of VBRI tag from the frame header (fixed) */
+
+#define MP3PARSER_VBRI_OFFSET       (MP3PARSER_HEADSIZE + 32)
+
+/* Number of TOC entries (1 entry per 1% of the stream duration) */
+
+#define MP3PARSER_TOC_NUM           100
+
+/* Max number of VBRI table entries used for TOC conversion */
+
+#define MP3PARSER_VBRI_TOC_MAX      512
+
+/* Seek table source */
+
+#define MP3PARSER_TOC_NONE          0
+#define MP3PARSER_TOC_XING          1
+#define MP3PARSER_TOC_VBRI          2
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -295,6 +335,52 @@ struct mp3parser_config_s
 };
 typedef struct mp3parser_config_s MP3PARSER_Config;
 
+/** Seek information
+ *  (Collected while frames are extracted)
+ *
+ *  * Offsets are counted in bytes from the top of the stream
+ *    which was given to the parser after initialize.
+ */
+
+struct mp3parser_seek_info_s
+{
+  uint32_t stream_offset;     /* Bytes consumed from the stream */
+  uint32_t audio_offset;      /* Offset of the 1st audio frame */
+  uint32_t frame_count;       /* Number of audio frames extracted */
+  uint32_t sampling_rate;     /* Of the 1st frame (0: not yet found) */
+  uint32_t samples_per_frame; /* Of the 1st frame */
+  uint32_t bitrate;           /* Of the 1st frame (bit/s) */
+  uint32_t total_frames;      /* From Xing/VBRI header (0: unknown) */
+  uint32_t total_bytes;       /* From Xing/VBRI header (0: unknown) */
+  uint32_t toc_offset;        /* Offset which TOC is counted from
+                               * (Xing: the Xing frame itself,
+                               *  VBRI: the 1st audio frame)
+                               */
+
+  /* Frame offset index (Buffer is allocated by calling source)
+   * Entry i holds the offset of frame (i * index_interval).
+   * When full, every other entry is dropped and the interval doubles.
+   */
+
+  FAR uint32_t *index;
+  uint32_t index_size;        /* Number of entries of index buffer */
+  uint32_t index_num;         /* Number of valid entries */
+  uint32_t index_interval;    /* Frames per entry */
+
+  uint8_t  toc_type;          /* MP3PARSER_TOC_XXX */
+  uint8_t  index_suspend;     /* frame_count is an estimate after seek
+                               * by TOC or bitrate. Stop indexing.
+                               */
+  uint8_t  enc_info;          /* enc_delay and enc_padding are valid */
+  uint8_t  reserved;
+  uint16_t enc_delay;         /* Samples added at the top by encoder */
+  uint16_t enc_padding;       /* Samples added at the end by encoder */
+  uint8_t  toc[MP3PARSER_TOC_NUM]; /* Offset of each 1% as 1/256 of
+                                    * total_bytes
+                                    */
+};
+typedef struct mp3parser_seek_info_s MP3PARSER_SeekInfo;
+
 /** Handle information for API call
  *  (Buffer for handle information should be allocated by calling source)
  *
@@ -328,6 +414,7 @@ struct mp3parser_handle_s
 
   uint32_t current_offset;
   FAR MP3PARSER_Config  *pConfig;      /* Othe parameters information */
+  MP3PARSER_SeekInfo seek;             /* Seek information */
 };
 typedef struct mp3parser_handle_s MP3PARSER_Handle;
 
@@ -723,6 +810,49 @@ int32_t Mp3Parser_finalize(FAR MP3PARSER_Handle *ptr_hndl);
 int32_t Mp3Parser_getSamplingRate(FAR MP3PARSER_Handle *ptr_hndl,
                                   FAR uint32_t *ptr_sampling_rate);
 
+/* Seek support
+ *
+ * setSeekIndex : Give a buffer for the frame offset index.
+ *                To reuse an index saved (e.g. to a sidecar file) after
+ *                a previous playback, pass its interval and number of
+ *                entries. Otherwise pass interval = 1 and num = 0.
+ * getSeekIndex : Get the interval and number of entries of the index,
+ *                to save the index buffer for later use.
+ * getDuration  : Duration of the stream. Uses the Xing/VBRI header if
+ *                present, otherwise estimates from the bitrate of the
+ *                1st frame and file_size (0 if unknown).
+ * seekToTime   : Get the stream offset to restart extraction from for
+ *                time_ms. The calling source must refill the FIFO from
+ *                *ptr_offset (after clearing it) before next poll.
+ */
+
+int32_t Mp3Parser_setSeekIndex(FAR MP3PARSER_Handle *ptr_hndl,
+                               FAR uint32_t *index,
+                               uint32_t index_size,
+                               uint32_t interval,
+                               uint32_t num);
+int32_t Mp3Parser_getSeekIndex(FAR MP3PARSER_Handle *ptr_hndl,
+                               FAR uint32_t *ptr_interval,
+                               FAR uint32_t *ptr_num);
+int32_t Mp3Parser_getDuration(FAR MP3PARSER_Handle *ptr_hndl,
+                              uint32_t file_size,
+                              FAR uint32_t *ptr_duration_ms);
+int32_t Mp3Parser_seekToTime(FAR MP3PARSER_Handle *ptr_hndl,
+                             uint32_t time_ms,
+                             FAR uint32_t *ptr_offset);
+
+/* Gapless support
+ *
+ * getEncoderDelay : Encoder delay and padding in samples, from the LAME
+ *                   tag of the Xing/Info header. Available after the 1st
+ *                   frame is extracted (MP3PARSER_NO_CAPABILITY if the
+ *                   stream has no LAME tag).
+ */
+
+int32_t Mp3Parser_getEncoderDelay(FAR MP3PARSER_Handle *ptr_hndl,
+                                  FAR uint32_t *ptr_delay,
+                                  FAR uint32_t *ptr_padding);
+
 /* Internal functions */
 
 uint32_t mp3parser_extract_frame(FAR MP3PARSER_Handle *ptr_hndl,
@@ -0,0 +1,180 @@
+/****************************************************************************
+ * modules/audio/include/common/PcmPacking.h
+ *
+ *   Copyright 2018 Sony Semiconductor Solutions Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Semiconductor Solutions Corporation nor
+ *    the names of its contributors may be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __MODULES_AUDIO_INCLUDE_COMMON_PCMPACKING_H
+#define __MODULES_AUDIO_INCLUDE_COMMON_PCMPACKING_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Sample formats (little endian).
+ *
+ * 24bit is packed in 3 bytes. 32bit is a 32bit container and
+ * 24bit data from the audio driver is left justified in it.
+ * Unsigned formats are offset binary (signed value ^ MSB).
+ */
+
+enum PcmPackingFormat
+{
+  PcmPackingS16 = 0,
+  PcmPackingU16,
+  PcmPackingS24,
+  PcmPackingU24,
+  PcmPackingS32,
+  PcmPackingU32,
+  PcmPackingFormatNum
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/*!
+ * @brief Get bytes per sample of a format
+ *
+ * @param[in] fmt Sample format
+ *
+ * @return Bytes per sample (2, 3 or 4)
+ */
+
+uint32_t PcmPacking_bytesPerSample(PcmPackingFormat fmt);
+
+/*!
+ * @brief Convert sample format
+ *
+ * Narrowing drops lower bytes, widening fills them with 0.
+ * Buffers aligned to 4 bytes are processed a word at a time,
+ * any alignment and any number of samples are accepted.
+ * In-place conversion is allowed when output is not wider than input.
+ *
+ * @param[in]  in      Input samples
+ *
+ * @param[in]  in_fmt  Format of input
+ *
+ * @param[out] out     Output samples
+ *
+ * @param[in]  out_fmt Format of output
+ *
+ * @param[in]  samples Number of samples (all channels)
+ *
+ * @return Size of output in bytes
+ */
+
+uint32_t PcmPacking_convert(const void *in,
+                            PcmPackingFormat in_fmt,
+                            void *out,
+                            PcmPackingFormat out_fmt,
+                            uint32_t samples);
+
+/*!
+ * @brief Pick channels from interleaved samples
+ *
+ * Output is interleaved samples of out_ch channels, where channel "i"
+ * is channel ch_map[i] of input. Format is not changed.
+ * In-place is allowed when out_ch <= in_ch.
+ *
+ * @param[in]  in     Interleaved input
+ *
+ * @param[in]  fmt    Sample format
+ *
+ * @param[in]  in_ch  Number of input channels
+ *
+ * @param[out] out    Interleaved output
+ *
+ * @param[in]  ch_map Input channel of each output channel
+ *
+ * @param[in]  out_ch Number of output channels
+ *
+ * @param[in]  frames Number of frames
+ *
+ * @return Size of output in bytes
+ */
+
+uint32_t PcmPacking_selectChannels(const void *in,
+                                   PcmPackingFormat fmt,
+                                   uint32_t in_ch,
+                                   void *out,
+                                   const uint8_t *ch_map,
+                                   uint32_t out_ch,
+                                   uint32_t frames);
+
+/*!
+ * @brief Split interleaved samples into one buffer per channel
+ *
+ * @param[in]  in     Interleaved input
+ *
+ * @param[in]  fmt    Sample format
+ *
+ * @param[in]  ch_num Number of channels
+ *
+ * @param[out] out    Output buffer of each channel
+ *
+ * @param[in]  frames Number of frames
+ */
+
+void PcmPacking_deinterleave(const void *in,
+                             PcmPackingFormat fmt,
+                             uint32_t ch_num,
+                             void *const *out,
+                             uint32_t frames);
+
+/*!
+ * @brief Join one buffer per channel into interleaved samples
+ *
+ * @param[in]  in     Input buffer of each channel
+ *
+ * @param[in]  fmt    Sample format
+ *
+ * @param[in]  ch_num Number of channels
+ *
+ * @param[out] out    Interleaved output
+ *
+ * @param[in]  frames Number of frames
+ */
+
+void PcmPacking_interleave(const void *const *in,
+                           PcmPackingFormat fmt,
+                           uint32_t ch_num,
+                           void *out,
+                           uint32_t frames);
+
+#endif /* __MODULES_AUDIO_INCLUDE_COMMON_PCMPACKING_H */
@@ -111,6 +111,13 @@
 
 #define ADTSPARSER_SYNCWORD_SEARCH_SIZE 3
 
+/* Syncword followed by id = 0 (MPEG-4) and layer = 0, as one 16bit
+ * pattern for the syncword scanner. The protection bit is not masked.
+ */
+
+#define ADTSPARSER_SYNCWORD_MASK     0xFFFE
+#define ADTSPARSER_SYNCWORD_PATTERN  0xFFF0
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
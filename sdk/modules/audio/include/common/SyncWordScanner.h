@@ -0,0 +1,114 @@
+/****************************************************************************
+ * modules/audio/include/common/SyncWordScanner.h
+ *
+ *   Copyright 2026 Sony Semiconductor Solutions Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Semiconductor Solutions Corporation nor
+ *    the names of its contributors may be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __MODULES_AUDIO_INCLUDE_COMMON_SYNCWORDSCANNER_H
+#define __MODULES_AUDIO_INCLUDE_COMMON_SYNCWORDSCANNER_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stddef.h>
+#include <stdint.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/*!
+ * @brief Search a byte aligned 16bit syncword in a span
+ *
+ * Finds the first offset "i" at which
+ * ((buf[i] << 8) | buf[i + 1]) & mask == word.
+ * The span is walked a word at a time and only words holding
+ * a candidate of the 1st syncword byte are checked byte by byte,
+ * so long runs of payload are skipped quickly.
+ *
+ * @param[in] buf  Pointer to the span to search
+ *
+ * @param[in] size Size of the span
+ *
+ * @param[in] mask Mask applied to the 2 bytes (upper byte is the 1st byte)
+ *
+ * @param[in] word Syncword to find (already masked)
+ *
+ * @return Offset of the syncword, or size if it was not found.
+ *         Offsets up to (size - 2) are checked.
+ */
+
+uint32_t SyncWordScanner_find(const uint8_t *buf,
+                              uint32_t size,
+                              uint16_t mask,
+                              uint16_t word);
+
+/*!
+ * @brief Search a byte aligned 16bit syncword in a split span
+ *
+ * Same as SyncWordScanner_find(), but the data is given as two
+ * regions such as the ones of a ring buffer, and the search starts
+ * from "offset" of the joined data. A syncword straddling the two
+ * regions is also found.
+ *
+ * @param[in] buf0   Pointer to the 1st region
+ *
+ * @param[in] size0  Size of the 1st region
+ *
+ * @param[in] buf1   Pointer to the 2nd region (NULL if size1 is 0)
+ *
+ * @param[in] size1  Size of the 2nd region
+ *
+ * @param[in] offset Offset of the joined data to start searching from
+ *
+ * @param[in] mask   Mask applied to the 2 bytes
+ *
+ * @param[in] word   Syncword to find (already masked)
+ *
+ * @return Offset of the syncword in the joined data,
+ *         or (size0 + size1) if it was not found.
+ */
+
+uint32_t SyncWordScanner_findSplit(const uint8_t *buf0,
+                                   uint32_t size0,
+                                   const uint8_t *buf1,
+                                   uint32_t size1,
+                                   uint32_t offset,
+                                   uint16_t mask,
+                                   uint16_t word);
+
+#endif /* __MODULES_AUDIO_INCLUDE_COMMON_SYNCWORDSCANNER_H */
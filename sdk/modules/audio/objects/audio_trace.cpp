@@ -0,0 +1,185 @@
+/****************************************************************************
+ * modules/audio/objects/audio_trace.cpp
+ *
+ *   Copyright 2018 Sony Semiconductor Solutions Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Semiconductor Solutions Corporation nor
+ *    the names of its contributors may be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <sdk/config.h>
+
+#include "debug/audio_trace.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Cycle counter of Cortex-M4 (DWT) is used as time stamp. */
+
+#define DEMCR           (*(volatile uint32_t *)0xe000edfc)
+#define DEMCR_TRCENA    (1u << 24)
+#define DWT_CTRL        (*(volatile uint32_t *)0xe0001000)
+#define DWT_CTRL_CYCENA (1u << 0)
+#define DWT_CYCCNT      (*(volatile uint32_t *)0xe0001004)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct AudioTraceEvent
+{
+  uint32_t time;   /* CPU cycles */
+  uint16_t seq;    /* Sequence number in the stage */
+  uint8_t  stage;  /* AudioTraceStage */
+  uint8_t  arg;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static AudioTraceEvent s_trace_buf[CONFIG_AUDIOUTILS_TRACE_NUM];
+
+/* Total number of recorded events, the latest
+ * CONFIG_AUDIOUTILS_TRACE_NUM of them are in s_trace_buf.
+ */
+
+static uint32_t s_trace_pos;
+
+static uint16_t s_trace_seq[AudioTraceStageNum];
+
+static const char *s_stage_name[AudioTraceStageNum] =
+{
+  "PlayStart",
+  "EsRead",
+  "DecReq",
+  "DecDone",
+  "PcmSend",
+  "MixIn",
+  "RenderReq",
+  "DmaDone",
+  "Underflow",
+};
+
+extern "C" uint32_t cxd56_get_cpu_baseclk(void);
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static inline uint32_t get_cycle(void)
+{
+  if ((DWT_CTRL & DWT_CTRL_CYCENA) == 0)
+    {
+      DEMCR    |= DEMCR_TRCENA;
+      DWT_CTRL |= DWT_CTRL_CYCENA;
+    }
+
+  return DWT_CYCCNT;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+extern "C" {
+
+/*--------------------------------------------------------------------------*/
+void AS_TraceAudioEvent(AudioTraceStage stage, uint8_t arg)
+{
+  if (stage >= AudioTraceStageNum)
+    {
+      return;
+    }
+
+  uint32_t pos = __atomic_fetch_add(&s_trace_pos, 1, __ATOMIC_RELAXED);
+
+  AudioTraceEvent *ev = &s_trace_buf[pos % CONFIG_AUDIOUTILS_TRACE_NUM];
+
+  if (stage == AudioTracePlayStart)
+    {
+      memset(s_trace_seq, 0, sizeof(s_trace_seq));
+      ev->seq = 0;
+    }
+  else
+    {
+      ev->seq = __atomic_fetch_add(&s_trace_seq[stage], 1, __ATOMIC_RELAXED);
+    }
+
+  ev->time  = get_cycle();
+  ev->stage = stage;
+  ev->arg   = arg;
+}
+
+/*--------------------------------------------------------------------------*/
+void AS_DumpAudioTrace(void)
+{
+  uint32_t end   = s_trace_pos;
+  uint32_t begin = 0;
+
+  if (end > CONFIG_AUDIOUTILS_TRACE_NUM)
+    {
+      begin = end - CONFIG_AUDIOUTILS_TRACE_NUM;
+    }
+
+  printf("audiotrace: begin clk %u num %u lost %u\n",
+         (unsigned int)cxd56_get_cpu_baseclk(),
+         (unsigned int)(end - begin),
+         (unsigned int)begin);
+
+  for (uint32_t pos = begin; pos != end; pos++)
+    {
+      const AudioTraceEvent *ev =
+        &s_trace_buf[pos % CONFIG_AUDIOUTILS_TRACE_NUM];
+
+      printf("audiotrace: %08x %s %u %u\n",
+             (unsigned int)ev->time,
+             s_stage_name[ev->stage],
+             ev->seq,
+             ev->arg);
+    }
+
+  printf("audiotrace: end\n");
+}
+
+/*--------------------------------------------------------------------------*/
+void AS_ClearAudioTrace(void)
+{
+  s_trace_pos = 0;
+  memset(s_trace_seq, 0, sizeof(s_trace_seq));
+}
+
+} /* extern "C" */
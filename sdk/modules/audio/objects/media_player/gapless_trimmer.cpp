@@ -0,0 +1,192 @@
+/****************************************************************************
+ * modules/audio/objects/media_player/gapless_trimmer.cpp
+ *
+ *   Copyright 2018 Sony Semiconductor Solutions Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Semiconductor Solutions Corporation nor
+ *    the names of its contributors may be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <string.h>
+
+#include "objects/media_player/gapless_trimmer.h"
+
+__WIEN2_BEGIN_NAMESPACE
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/*--------------------------------------------------------------------------*/
+uint64_t GaplessTrimmer::toOutFrames(uint64_t samples)
+{
+  /* Input samples of the decoder to its output frames. */
+
+  return (samples + m_dec_delay) * m_out_fs / m_in_fs;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/*--------------------------------------------------------------------------*/
+void GaplessTrimmer::setOutput(uint32_t in_fs,
+                               uint32_t out_fs,
+                               uint32_t dec_delay,
+                               uint32_t frame_size)
+{
+  m_in_fs      = in_fs;
+  m_out_fs     = out_fs;
+  m_dec_delay  = dec_delay;
+  m_frame_size = frame_size;
+}
+
+/*--------------------------------------------------------------------------*/
+void GaplessTrimmer::reset()
+{
+  while (!m_seg_que.empty())
+    {
+      m_seg_que.pop();
+    }
+
+  m_active   = false;
+  m_base     = 0;
+  m_pos      = 0;
+  m_max_size = 0;
+}
+
+/*--------------------------------------------------------------------------*/
+bool GaplessTrimmer::addStream(uint32_t delay, uint32_t length)
+{
+  if ((m_in_fs == 0) || (m_frame_size == 0))
+    {
+      return false;
+    }
+
+  /* Previous stream ends at the top of this stream at the latest. */
+
+  uint64_t top = toOutFrames(m_base);
+
+  if (!m_seg_que.empty())
+    {
+      Segment &prev = m_seg_que.writable_at(m_seg_que.size() - 1);
+
+      if (prev.end > top)
+        {
+          prev.end = top;
+        }
+    }
+
+  Segment seg;
+
+  seg.start = toOutFrames(m_base + delay);
+  seg.end   = (length != 0) ?
+                toOutFrames(m_base + delay + length) : UINT64_MAX;
+
+  if (m_seg_que.full())
+    {
+      m_seg_que.pop();
+    }
+
+  if (!m_seg_que.push(seg))
+    {
+      return false;
+    }
+
+  m_active = true;
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+uint32_t GaplessTrimmer::trim(uint8_t *p_pcm, uint32_t size)
+{
+  uint32_t frames = size / m_frame_size;
+  uint64_t pos    = m_pos;
+  uint32_t kept   = 0;
+
+  if (size > m_max_size)
+    {
+      m_max_size = size;
+    }
+
+  m_pos += frames;
+
+  /* Nothing is kept after the last segment (padding of last stream). */
+
+  while (!m_seg_que.empty())
+    {
+      const Segment &seg = m_seg_que.top();
+
+      uint64_t from = (pos > seg.start) ? pos : seg.start;
+      uint64_t to   = (pos + frames < seg.end) ? pos + frames : seg.end;
+
+      if (from < to)
+        {
+          memmove(p_pcm + kept * m_frame_size,
+                  p_pcm + (uint32_t)(from - pos) * m_frame_size,
+                  (uint32_t)(to - from) * m_frame_size);
+          kept += (uint32_t)(to - from);
+        }
+
+      if (seg.end > pos + frames)
+        {
+          break;
+        }
+
+      m_seg_que.pop();
+    }
+
+  return kept * m_frame_size;
+}
+
+/*--------------------------------------------------------------------------*/
+uint32_t GaplessTrimmer::join(uint8_t *p_hold,
+                              uint32_t hold_size,
+                              uint8_t *p_data,
+                              uint32_t data_size)
+{
+  uint32_t min_size = getMinSize();
+  uint32_t move     = data_size;
+
+  if ((hold_size + move > m_max_size) && (hold_size + move > min_size))
+    {
+      move = (hold_size < min_size) ? min_size - hold_size : 0;
+    }
+
+  memcpy(p_hold + hold_size, p_data, move);
+  memmove(p_data, p_data + move, data_size - move);
+
+  return move;
+}
+
+__WIEN2_END_NAMESPACE
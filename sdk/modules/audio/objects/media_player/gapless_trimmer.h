@@ -0,0 +1,139 @@
+/****************************************************************************
+ * modules/audio/objects/media_player/gapless_trimmer.h
+ *
+ *   Copyright 2018 Sony Semiconductor Solutions Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Semiconductor Solutions Corporation nor
+ *    the names of its contributors may be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __MODULES_AUDIO_OBJECTS_MEDIA_PLAYER_GAPLESS_TRIMMER_H
+#define __MODULES_AUDIO_OBJECTS_MEDIA_PLAYER_GAPLESS_TRIMMER_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include "memutils/s_stl/queue.h"
+#include "wien2_common_defs.h"
+
+__WIEN2_BEGIN_NAMESPACE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Output mixer drops PCM shorter than DMA minimum. */
+
+#define GAPLESS_MIN_FRAMES   240
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Trimming of encoder delay and padding from decoded PCM, and joining
+ * of PCM which became too short to be rendered.
+ *
+ * Segments are ranges of valid PCM in output frames counted from
+ * decoder start. Current stream and next stream are queued.
+ */
+
+class GaplessTrimmer
+{
+public:
+  GaplessTrimmer()
+  {
+    m_in_fs      = 0;
+    m_out_fs     = 0;
+    m_dec_delay  = 0;
+    m_frame_size = 0;
+    reset();
+  }
+  ~GaplessTrimmer() {}
+
+  /* Output of the decoder, given by its initialization. */
+
+  void setOutput(uint32_t in_fs,
+                 uint32_t out_fs,
+                 uint32_t dec_delay,
+                 uint32_t frame_size);
+
+  void reset();
+
+  /* Stream whose top is after all samples given by endStream(). */
+
+  bool addStream(uint32_t delay, uint32_t length);
+  void endStream(uint32_t samples) { m_base += samples; }
+
+  /* Keep only valid frames of decoded PCM, packed to the top.
+   * Returns the size kept.
+   */
+
+  uint32_t trim(uint8_t *p_pcm, uint32_t size);
+
+  /* Move PCM from the top of data to the end of held PCM, as long
+   * as held PCM is within the largest size the decoder made (or is
+   * shorter than minimum). Returns the size moved.
+   */
+
+  uint32_t join(uint8_t *p_hold,
+                uint32_t hold_size,
+                uint8_t *p_data,
+                uint32_t data_size);
+
+  bool isActive() { return m_active; }
+  uint32_t getMinSize() { return GAPLESS_MIN_FRAMES * m_frame_size; }
+
+private:
+  struct Segment
+  {
+    uint64_t start;
+    uint64_t end;
+  };
+
+  #define MAX_GAPLESS_SEG_NUM 2
+
+  s_std::Queue<Segment, MAX_GAPLESS_SEG_NUM> m_seg_que;
+
+  uint32_t m_in_fs;
+  uint32_t m_out_fs;
+  uint32_t m_dec_delay;    /* Decoder delay in samples of input rate */
+  uint32_t m_frame_size;   /* Bytes of a frame of all channels */
+
+  bool     m_active;
+  uint64_t m_base;         /* Input samples of finished streams */
+  uint64_t m_pos;          /* Output frames decoded so far */
+  uint32_t m_max_size;     /* Largest PCM size from decoder */
+
+  uint64_t toOutFrames(uint64_t samples);
+};
+
+__WIEN2_END_NAMESPACE
+
+#endif /* __MODULES_AUDIO_OBJECTS_MEDIA_PLAYER_GAPLESS_TRIMMER_H */
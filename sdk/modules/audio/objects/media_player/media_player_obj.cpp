@@ -50,6 +50,7 @@
 #include "components/decoder/decoder_component.h"
 #include "dsp_driver/include/dsp_drv.h"
 #include "debug/dbg_log.h"
+#include "debug/audio_trace.h"
 
 __USING_WIEN2
 using namespace MemMgrLite;
@@ -215,6 +216,12 @@ PlayerObj::PlayerObj(AsPlayerMsgQueId_t msgq_id, AsPlayerPoolId_t pool_id):
   m_callback(NULL),
   m_pcm_path(AsPcmDataReply)
 {
+#ifdef CONFIG_AUDIOUTILS_PLAYER_GAPLESS
+  m_has_next     = false;
+  m_switching    = false;
+  m_dsp_path[0]  = '\0';
+  m_trim_holding = false;
+#endif
 }
 
 /*--------------------------------------------------------------------------*/
@@ -288,7 +295,7 @@ PlayerObj::MsgProc PlayerObj::MsgProcTbl[AUD_PLY_MSG_NUM][PlayerStateNum] =
     &PlayerObj::illegalEvt,          /*   ReadyState.         */
     &PlayerObj::parseSubState,       /*   PrePlayParentState. */
     &PlayerObj::stopOnPlay,          /*   PlayState.          */
-    &PlayerObj::illegalEvt,          /*   StoppingState.      */
+    &PlayerObj::stopOnStopping,      /*   StoppingState.      */
     &PlayerObj::stopOnWaitEsEnd,     /*   WaitEsEndState.     */
     &PlayerObj::stopOnUnderflow,     /*   UnderflowState.     */
     &PlayerObj::stopOnWait           /*   WaitStopState.      */
@@ -317,6 +324,19 @@ PlayerObj::MsgProc PlayerObj::MsgProcTbl[AUD_PLY_MSG_NUM][PlayerStateNum] =
     &PlayerObj::setGain,             /*   WaitEsEndState.     */
     &PlayerObj::setGain,             /*   UnderflowState.     */
     &PlayerObj::setGain,             /*   WaitStopState.      */
+  },
+
+  /* Message type: MSG_AUD_PLY_CMD_SETNEXT */
+
+  {                                  /* Player status:        */
+    &PlayerObj::illegalEvt,          /*   BootedState.        */
+    &PlayerObj::illegalEvt,          /*   ReadyState.         */
+    &PlayerObj::parseSubState,       /*   PrePlayParentState. */
+    &PlayerObj::setNext,             /*   PlayState.          */
+    &PlayerObj::illegalEvt,          /*   StoppingState.      */
+    &PlayerObj::illegalEvt,          /*   WaitEsEndState.     */
+    &PlayerObj::illegalEvt,          /*   UnderflowState.     */
+    &PlayerObj::illegalEvt           /*   WaitStopState.      */
   }
 };
 
@@ -375,6 +395,15 @@ PlayerObj::MsgProc PlayerObj::PlayerSubStateTbl[AUD_PLY_MSG_NUM][SubStateNum] =
     &PlayerObj::setGain,                   /*   SubStatePrePlayStopping.  */
     &PlayerObj::setGain,                   /*   SubStatePrePlayWaitEsEnd. */
     &PlayerObj::setGain,                   /*   SubStatePrePlayUnderflow. */
+  },
+
+  /* Message type: MSG_AUD_PLY_CMD_SETNEXT. */
+
+  {                                        /* Player sub status:          */
+    &PlayerObj::setNext,                   /*   SubStatePrePlay.          */
+    &PlayerObj::illegalEvt,                /*   SubStatePrePlayStopping.  */
+    &PlayerObj::illegalEvt,                /*   SubStatePrePlayWaitEsEnd. */
+    &PlayerObj::illegalEvt,                /*   SubStatePrePlayUnderflow. */
   }
 };
 
@@ -512,7 +541,8 @@ void PlayerObj::illegalEvt(MsgPacket *msg)
     AsPlayerEventPlay,
     AsPlayerEventStop,
     AsPlayerEventDeact,
-    AsPlayerEventSetGain
+    AsPlayerEventSetGain,
+    AsPlayerEventSetNext
   };
 
   reply(table[idx], (MsgType)msgtype, AS_ECODE_STATE_VIOLATION);
@@ -614,6 +644,12 @@ void PlayerObj::init(MsgPacket *msg)
 
   result = m_input_device_handler->setParam(param);
 
+#ifdef CONFIG_AUDIOUTILS_PLAYER_GAPLESS
+  /* Keep DSP path to reload codec when switching to next stream. */
+
+  memcpy(m_dsp_path, param.dsp_path, sizeof(m_dsp_path));
+#endif
+
   if (result == AS_ECODE_OK)
     {
       /* Update codec accordingt to audio data type. */
@@ -852,7 +888,7 @@ void PlayerObj::nextReqOnPlay(MsgPacket *msg)
       else
         {
           stopPlay();
-          if (m_state == PlayState)
+          if ((m_state == PlayState) && !isSwitching())
             {
               m_state = UnderflowState;
               MEDIA_PLAYER_WARN(AS_ATTENTION_SUB_CODE_SIMPLE_FIFO_UNDERFLOW);
@@ -874,6 +910,18 @@ void PlayerObj::nextReqOnStopping(MsgPacket *msg)
     {
       finalize();
 
+#ifdef CONFIG_AUDIOUTILS_PLAYER_GAPLESS
+      if (m_switching)
+        {
+          /* Current stream is stopped. Restart with next stream. */
+
+          m_switching = false;
+          freeSrcWorkBuf();
+          restartStream();
+          return;
+        }
+#endif
+
       if (m_external_cmd_que.empty())
         {
           MEDIA_PLAYER_ERR(AS_ATTENTION_SUB_CODE_QUEUE_MISSING_ERROR);
@@ -973,7 +1021,7 @@ void PlayerObj::decDoneOnPlay(MsgPacket *msg)
         /* There is no stream data. */
 
         stopPlay();
-        if (m_state == PlayState)
+        if ((m_state == PlayState) && !isSwitching())
           {
             m_state = UnderflowState;
             MEDIA_PLAYER_WARN(AS_ATTENTION_SUB_CODE_SIMPLE_FIFO_UNDERFLOW);
@@ -1263,6 +1311,72 @@ void PlayerObj::setGain(MsgPacket *msg)
   /* Response is sent after decoder_component done */
 }
 
+/*--------------------------------------------------------------------------*/
+void PlayerObj::setNext(MsgPacket *msg)
+{
+#ifdef CONFIG_AUDIOUTILS_PLAYER_GAPLESS
+  AsSetNextPlayerParam param = msg->moveParam<PlayerCommand>().set_next_param;
+
+  MEDIA_PLAYER_DBG("SETNEXT: ch num %d, bit len %d, codec %d, fs %d\n",
+                   param.channel_number,
+                   param.bit_length,
+                   param.codec_type,
+                   param.sampling_rate);
+
+  if (param.ram_handler == NULL)
+    {
+      reply(AsPlayerEventSetNext,
+            msg->getType(),
+            AS_ECODE_COMMAND_PARAM_INPUT_HANDLER);
+      return;
+    }
+
+  /* Switched to when ES of current stream runs out.
+   * (Replaces next stream which was set before)
+   */
+
+  m_next_param = param;
+  m_has_next   = true;
+
+  reply(AsPlayerEventSetNext, msg->getType(), AS_ECODE_OK);
+#else
+  msg->moveParam<PlayerCommand>();
+
+  reply(AsPlayerEventSetNext, msg->getType(), AS_ECODE_COMMAND_NOT_SUPPOT);
+#endif
+}
+
+/*--------------------------------------------------------------------------*/
+void PlayerObj::stopOnStopping(MsgPacket *msg)
+{
+#ifdef CONFIG_AUDIOUTILS_PLAYER_GAPLESS
+  if (m_switching)
+    {
+      /* Decoder is stopping to switch to next stream.
+       * Complete stop instead of restart.
+       */
+
+      msg->moveParam<PlayerCommand>();
+
+      MEDIA_PLAYER_DBG("STOP:\n");
+
+      if (!m_external_cmd_que.push(AsPlayerEventStop))
+        {
+          MEDIA_PLAYER_ERR(AS_ATTENTION_SUB_CODE_QUEUE_PUSH_ERROR);
+          reply(AsPlayerEventStop,
+                msg->getType(),
+                AS_ECODE_QUEUE_OPERATION_ERROR);
+          return;
+        }
+
+      m_switching = false;
+      return;
+    }
+#endif
+
+  illegalEvt(msg);
+}
+
 /*--------------------------------------------------------------------------*/
 void PlayerObj::parseSubState(MsgPacket *msg)
 {
@@ -1351,6 +1465,12 @@ uint32_t PlayerObj::startPlay(uint32_t* dsp_inf)
   uint32_t   rst = AS_ECODE_OK;
   InitDecCompParam init_dec_comp_param;
 
+  AUDIO_TRACE(AudioTracePlayStart, 0);
+
+#ifdef CONFIG_AUDIOUTILS_PLAYER_GAPLESS
+  resetTrim();
+#endif
+
   rst = m_input_device_handler->start();
   if (rst != AS_ECODE_OK)
     {
@@ -1383,6 +1503,21 @@ uint32_t PlayerObj::startPlay(uint32_t* dsp_inf)
       return rst;
     }
 
+#ifdef CONFIG_AUDIOUTILS_PLAYER_GAPLESS
+  /* Trimming position is counted in frames of decoder output. */
+
+  OutDecCompParam out_param;
+
+  if (AS_decode_get_output(&out_param, m_p_dec_instance))
+    {
+      m_trimmer.setOutput(init_dec_comp_param.input_sampling_rate,
+                          out_param.sampling_rate,
+                          out_param.delay,
+                          out_param.channel_num *
+                            ((out_param.bit_width == AudPcm16Bit) ? 2 : 4));
+    }
+#endif
+
   if (!AS_decode_recv_done(m_p_dec_instance))
     {
       freeSrcWorkBuf();
@@ -1400,6 +1535,10 @@ uint32_t PlayerObj::startPlay(uint32_t* dsp_inf)
       return  AS_ECODE_SIMPLE_FIFO_UNDERFLOW;
     }
 
+#ifdef CONFIG_AUDIOUTILS_PLAYER_GAPLESS
+  startTrim();
+#endif
+
   decode(es_addr, es_size);
 
   return AS_ECODE_OK;
@@ -1427,6 +1566,64 @@ void PlayerObj::stopPlay(void)
 /*--------------------------------------------------------------------------*/
 void PlayerObj::sendPcmToOwner(AsPcmDataParam& data)
 {
+#ifdef CONFIG_AUDIOUTILS_PLAYER_GAPLESS
+  if (!m_trimmer.isActive())
+    {
+      deliverPcm(data);
+      return;
+    }
+
+  uint32_t min_size = m_trimmer.getMinSize();
+
+  data.size = m_trimmer.trim(static_cast<uint8_t *>(data.mh.getVa()),
+                             data.size);
+
+  /* Output mixer drops short PCM. Join it with following PCM
+   * within the largest size the decoder made.
+   */
+
+  if (m_trim_holding)
+    {
+      uint32_t move =
+        m_trimmer.join(static_cast<uint8_t *>(m_trim_hold.mh.getVa()),
+                       m_trim_hold.size,
+                       static_cast<uint8_t *>(data.mh.getVa()),
+                       data.size);
+
+      m_trim_hold.size += move;
+      data.size        -= move;
+
+      if ((m_trim_hold.size >= min_size) || data.is_end)
+        {
+          deliverPcm(m_trim_hold);
+          m_trim_hold.mh.freeSeg();
+          m_trim_holding = false;
+        }
+    }
+
+  if (data.is_end)
+    {
+      deliverPcm(data);
+    }
+  else if (data.size >= min_size)
+    {
+      deliverPcm(data);
+    }
+  else if (data.size > 0)
+    {
+      m_trim_hold    = data;
+      m_trim_holding = true;
+    }
+#else
+  deliverPcm(data);
+#endif
+}
+
+/*--------------------------------------------------------------------------*/
+void PlayerObj::deliverPcm(AsPcmDataParam& data)
+{
+  AUDIO_TRACE(AudioTracePcmSend, data.is_valid);
+
   data.bit_length = m_input_device_handler->getBitLen();
   if (m_pcm_path == AsPcmDataReply)
     {
@@ -1509,9 +1706,45 @@ void* PlayerObj::getEs(uint32_t* size)
           MEDIA_PLAYER_ERR(AS_ATTENTION_SUB_CODE_QUEUE_PUSH_ERROR);
           return NULL;
         }
+
+    AUDIO_TRACE(AudioTraceEsRead, 0);
+
     return mh.getPa();
   }
 
+#ifdef CONFIG_AUDIOUTILS_PLAYER_GAPLESS
+  /* End of current stream. Continue with next stream if it is
+   * compatible, otherwise stop the decoder and restart later.
+   */
+
+  if (isSwitchable())
+    {
+      uint32_t req_size = *size;
+
+      if (switchStream())
+        {
+          *size = req_size;
+          if (m_input_device_handler->getEs(mh.getVa(), size))
+            {
+              if (!m_es_buf_mh_que.push(mh))
+                {
+                  MEDIA_PLAYER_ERR(AS_ATTENTION_SUB_CODE_QUEUE_PUSH_ERROR);
+                  return NULL;
+                }
+
+              AUDIO_TRACE(AudioTraceEsRead, 0);
+
+              startTrim();
+              notifyNextStream(AS_ECODE_OK);
+
+              return mh.getPa();
+            }
+
+          notifyNextStream(AS_ECODE_SIMPLE_FIFO_UNDERFLOW);
+        }
+    }
+#endif
+
   return NULL;
 }
 
@@ -1585,6 +1818,13 @@ void PlayerObj::finalize()
           break;
         }
     }
+
+#ifdef CONFIG_AUDIOUTILS_PLAYER_GAPLESS
+  /* Next stream which was not switched to is discarded. */
+
+  m_has_next = false;
+  resetTrim();
+#endif
 }
 
 /*--------------------------------------------------------------------------*/
@@ -1651,6 +1891,209 @@ bool PlayerObj::judgeMultiCore(uint32_t sampling_rate, uint8_t bit_length)
   return false;
 }
 
+#ifdef CONFIG_AUDIOUTILS_PLAYER_GAPLESS
+/*--------------------------------------------------------------------------*/
+bool PlayerObj::isSwitchable()
+{
+  /* Not after stop was requested (WaitEsEnd). */
+
+  if (!m_has_next)
+    {
+      return false;
+    }
+
+  return ((m_state == PlayState) ||
+          ((m_state == PrePlayParentState) &&
+           (m_sub_state == SubStatePrePlay)));
+}
+
+/*--------------------------------------------------------------------------*/
+bool PlayerObj::switchStream()
+{
+  m_has_next = false;
+
+  uint32_t cur_fs    = m_input_device_handler->getSamplingRate();
+  uint8_t  cur_ch    = m_input_device_handler->getChannelNum();
+  uint8_t  cur_bit   = m_input_device_handler->getBitLen();
+  AudioCodec cur_codec = m_input_device_handler->getCodecType();
+
+  /* Samples of current stream, to place next stream after it. */
+
+  GaplessInfo info;
+
+  if (m_trimmer.isActive() && m_input_device_handler->getGaplessInfo(&info))
+    {
+      m_trimmer.endStream(info.samples);
+    }
+
+  /* Close current stream and open next stream. */
+
+  m_input_device_handler->stop();
+
+  PlayerInputDeviceHandler::PlayerInHandle in_device_handle;
+  in_device_handle.p_ram_device_handle = m_next_param.ram_handler;
+
+  AsInitPlayerParam init_param;
+  init_param.channel_number = m_next_param.channel_number;
+  init_param.bit_length     = m_next_param.bit_length;
+  init_param.codec_type     = m_next_param.codec_type;
+  init_param.sampling_rate  = m_next_param.sampling_rate;
+  memcpy(init_param.dsp_path, m_dsp_path, sizeof(init_param.dsp_path));
+
+  uint32_t rst = AS_ECODE_COMMAND_PARAM_INPUT_HANDLER;
+
+  if (m_input_device_handler->initialize(&in_device_handle))
+    {
+      rst = m_input_device_handler->setParam(init_param);
+      if (rst == AS_ECODE_OK)
+        {
+          /* Sampling rate is fixed here if it is AUTO. */
+
+          rst = m_input_device_handler->start();
+        }
+    }
+
+  if (rst != AS_ECODE_OK)
+    {
+      notifyNextStream(rst);
+      return false;
+    }
+
+  uint32_t next_fs  = m_input_device_handler->getSamplingRate();
+  uint8_t  next_bit = m_input_device_handler->getBitLen();
+
+  m_switch_reload =
+    (cur_codec != m_input_device_handler->getCodecType()) ||
+    (judgeMultiCore(cur_fs, cur_bit) != judgeMultiCore(next_fs, next_bit));
+
+  if (!m_switch_reload &&
+      (cur_fs == next_fs) &&
+      (cur_bit == next_bit) &&
+      (cur_ch == m_input_device_handler->getChannelNum()))
+    {
+      /* Decoder continues with ES of next stream. */
+
+      return true;
+    }
+
+  /* Decoder must be initialized again. Stop it after all PCM of
+   * current stream is rendered. (Not while PCM is prebuffered)
+   */
+
+  if (m_state.get() != PlayState)
+    {
+      notifyNextStream(AS_ECODE_STATE_VIOLATION);
+      return false;
+    }
+
+  m_switching = true;
+  return false;
+}
+
+/*--------------------------------------------------------------------------*/
+void PlayerObj::restartStream()
+{
+  uint32_t rst     = AS_ECODE_OK;
+  uint32_t dsp_inf = 0;
+
+  MEDIA_PLAYER_DBG("RESTART: codec %d, fs %d\n",
+                   m_input_device_handler->getCodecType(),
+                   m_input_device_handler->getSamplingRate());
+
+  if (m_switch_reload)
+    {
+      AsInitPlayerParam init_param;
+      init_param.channel_number = m_input_device_handler->getChannelNum();
+      init_param.bit_length     = m_input_device_handler->getBitLen();
+      init_param.codec_type     = m_next_param.codec_type;
+      init_param.sampling_rate  = m_input_device_handler->getSamplingRate();
+      memcpy(init_param.dsp_path, m_dsp_path, sizeof(init_param.dsp_path));
+
+      rst = unloadCodec();
+      if (rst == AS_ECODE_OK)
+        {
+          rst = loadCodec(m_input_device_handler->getCodecType(),
+                          &init_param,
+                          &dsp_inf);
+        }
+    }
+
+  if (rst == AS_ECODE_OK)
+    {
+      rst = startPlay(&dsp_inf);
+    }
+
+  if (rst == AS_ECODE_OK)
+    {
+      m_sub_state = SubStatePrePlay;
+      m_state = PrePlayParentState;
+    }
+  else
+    {
+      m_state = ReadyState;
+    }
+
+  notifyNextStream(rst);
+}
+
+/*--------------------------------------------------------------------------*/
+void PlayerObj::notifyNextStream(uint32_t result)
+{
+  /* There is no request to reply to. Notify only by callback. */
+
+  if (m_callback != NULL)
+    {
+      m_callback(AsPlayerEventNextStream, result, 0);
+    }
+}
+
+/*--------------------------------------------------------------------------*/
+void PlayerObj::resetTrim()
+{
+  if (m_trim_holding)
+    {
+      m_trim_hold.mh.freeSeg();
+      m_trim_holding = false;
+    }
+
+  m_trimmer.reset();
+}
+
+/*--------------------------------------------------------------------------*/
+void PlayerObj::startTrim()
+{
+  /* Call after the 1st ES of the stream is got. Only MP3 has the
+   * encoder delay and padding (LAME tag). Streams without it are
+   * not trimmed, except that they are kept whole while following a
+   * trimmed stream.
+   */
+
+  GaplessInfo info;
+
+  if ((m_codec_type != AudCodecMP3) ||
+      !m_input_device_handler->getGaplessInfo(&info))
+    {
+      return;
+    }
+
+  if (!info.trim)
+    {
+      if (!m_trimmer.isActive())
+        {
+          return;
+        }
+
+      info.delay  = 0;
+      info.length = 0;
+    }
+
+  if (!m_trimmer.addStream(info.delay, info.length))
+    {
+      MEDIA_PLAYER_ERR(AS_ATTENTION_SUB_CODE_QUEUE_PUSH_ERROR);
+    }
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -1884,6 +2327,35 @@ bool AS_SetPlayerGain(AsPlayerId id, FAR AsSetGainParam *gainparam)
   return true;
 }
 
+/*--------------------------------------------------------------------------*/
+bool AS_SetNextPlayer(AsPlayerId id, FAR AsSetNextPlayerParam *nextparam)
+{
+  /* Parameter check */
+
+  if (nextparam == NULL)
+    {
+      return false;
+    }
+
+  /* Set next stream */
+
+  MsgQueId msgq_id = (id == AS_PLAYER_ID_0) ? s_msgq_id.player : s_sub_msgq_id.player;
+
+  PlayerCommand cmd;
+
+  cmd.player_id      = id;
+  cmd.set_next_param = *nextparam;
+
+  err_t er = MsgLib::send<PlayerCommand>(msgq_id,
+                                         MsgPriNormal,
+                                         MSG_AUD_PLY_CMD_SETNEXT,
+                                         s_msgq_id.mng,
+                                         cmd);
+  F_ASSERT(er == ERR_OK);
+
+  return true;
+}
+
 /*--------------------------------------------------------------------------*/
 bool AS_RequestNextPlayerProcess(AsPlayerId id, FAR AsRequestNextParam *nextparam)
 {
@@ -1988,6 +2460,48 @@ bool AS_DeletePlayer(AsPlayerId id)
   return true;
 }
 
+/*--------------------------------------------------------------------------*/
+bool AS_PreloadPlayerCodec(uint8_t codec_type, FAR const char *dsp_path)
+{
+  AudioCodec codec;
+
+  switch (codec_type)
+    {
+      case AS_CODECTYPE_MP3:
+        codec = AudCodecMP3;
+        break;
+
+      case AS_CODECTYPE_WAV:
+        codec = AudCodecLPCM;
+        break;
+
+      case AS_CODECTYPE_AAC:
+      case AS_CODECTYPE_MEDIA:
+        codec = AudCodecAAC;
+        break;
+
+      case AS_CODECTYPE_OPUS:
+        codec = AudCodecOPUS;
+        break;
+
+      default:
+        return false;
+    }
+
+  if (dsp_path == NULL)
+    {
+      dsp_path = CONFIG_AUDIOUTILS_DSP_MOUNTPT;
+    }
+
+  return (AS_decode_preload(codec, dsp_path) == AS_ECODE_OK);
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_PurgePlayerCodec(void)
+{
+  return AS_decode_purge();
+}
+
 void PlayerObj::create(FAR void **obj,
                        AsPlayerMsgQueId_t msgq_id,
                        AsPlayerPoolId_t pool_id)
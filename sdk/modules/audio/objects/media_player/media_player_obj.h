@@ -49,6 +49,9 @@
 #include "audio_state.h"
 #include "audio/audio_message_types.h"
 #include "player_input_device_handler.h"
+#ifdef CONFIG_AUDIOUTILS_PLAYER_GAPLESS
+#  include "gapless_trimmer.h"
+#endif
 #include "wien2_internal_packet.h"
 
 __WIEN2_BEGIN_NAMESPACE
@@ -142,6 +145,22 @@ private:
   AsPcmDataDest m_pcm_dest;
   AsPcmDataPath m_pcm_path;
 
+#ifdef CONFIG_AUDIOUTILS_PLAYER_GAPLESS
+  /* Next stream */
+
+  AsSetNextPlayerParam m_next_param;
+  bool m_has_next;
+  bool m_switching;      /* Waiting for decoder stop to switch stream */
+  bool m_switch_reload;  /* Codec must be reloaded to switch stream */
+  char m_dsp_path[AS_AUDIO_DSP_PATH_LEN];
+
+  /* Trimming of encoder delay and padding */
+
+  GaplessTrimmer m_trimmer;
+  bool           m_trim_holding;
+  AsPcmDataParam m_trim_hold;      /* PCM too short to render alone */
+#endif
+
   void run(void);
   void parse(MsgPacket *);
   void parseSubState(MsgPacket *);
@@ -189,6 +208,9 @@ private:
 
   void setGain(MsgPacket *);
 
+  void setNext(MsgPacket *);
+  void stopOnStopping(MsgPacket *);
+
   uint32_t loadCodec(AudioCodec codec,
                      AsInitPlayerParam *param,
                      uint32_t* dsp_inf);
@@ -198,6 +220,7 @@ private:
   void stopPlay(void);
 
   void sendPcmToOwner(AsPcmDataParam& data);
+  void deliverPcm(AsPcmDataParam& data);
 
   void decode(void* p_es, uint32_t es_size);
 
@@ -241,8 +264,26 @@ private:
     }
 
   void finalize();
+  bool isSwitching()
+    {
+#ifdef CONFIG_AUDIOUTILS_PLAYER_GAPLESS
+      return m_switching;
+#else
+      return false;
+#endif
+    }
   bool checkAndSetMemPool();
   bool judgeMultiCore(uint32_t sampling_rate, uint8_t bit_length);
+
+#ifdef CONFIG_AUDIOUTILS_PLAYER_GAPLESS
+  bool isSwitchable();
+  bool switchStream();
+  void restartStream();
+  void notifyNextStream(uint32_t result);
+
+  void resetTrim();
+  void startTrim();
+#endif
 };
 
 /****************************************************************************
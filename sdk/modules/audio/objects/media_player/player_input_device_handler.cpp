@@ -259,6 +259,14 @@ bool InputHandlerOfRAM::stop()
   return true;
 }
 
+#ifdef CONFIG_AUDIOUTILS_PLAYER_GAPLESS
+/*--------------------------------------------------------------------*/
+bool InputHandlerOfRAM::getGaplessInfo(FAR GaplessInfo *p_info)
+{
+  return m_p_es_source_hdl->getGaplessInfo(p_info);
+}
+#endif
+
 /*--------------------------------------------------------------------*/
 bool InputHandlerOfRAM::getEs(void* p_es, uint32_t* es_byte_size)
 {
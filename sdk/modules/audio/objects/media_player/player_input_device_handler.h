@@ -92,6 +92,9 @@ public:
   virtual uint32_t start() = 0;
   virtual bool getEs(void* p_es, uint32_t* es_byte_size) = 0;
   virtual bool stop() = 0;
+#ifdef CONFIG_AUDIOUTILS_PLAYER_GAPLESS
+  virtual bool getGaplessInfo(FAR GaplessInfo *p_info) = 0;
+#endif
 
   uint32_t getSamplingRate()
     {
@@ -171,6 +174,9 @@ public:
   virtual uint32_t start();
   virtual bool getEs(void* p_es, uint32_t* es_byte_size);
   virtual bool stop();
+#ifdef CONFIG_AUDIOUTILS_PLAYER_GAPLESS
+  virtual bool getGaplessInfo(FAR GaplessInfo *p_info);
+#endif
 
 private:
   uint32_t                m_wav_au_size;
@@ -0,0 +1,556 @@
+/****************************************************************************
+ * modules/audio/objects/media_recorder/audio_recorder_file_sink.cpp
+ *
+ *   Copyright 2018 Sony Semiconductor Solutions Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Semiconductor Solutions Corporation nor
+ *    the names of its contributors may be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sched.h>
+#include "audio_recorder_file_sink.h"
+#include "debug/dbg_log.h"
+
+__WIEN2_BEGIN_NAMESPACE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static uint32_t get_write_size(const AsRecorderFileSinkParam &param)
+{
+  return (param.write_size != 0) ?
+    param.write_size : CONFIG_AUDIOUTILS_RECORDER_FILE_SINK_WRITE_SIZE;
+}
+
+/*--------------------------------------------------------------------------*/
+static uint32_t get_buffer_size(const AsRecorderFileSinkParam &param)
+{
+  uint32_t write_size = get_write_size(param);
+  uint32_t size = (param.buffer_size != 0) ?
+    param.buffer_size : CONFIG_AUDIOUTILS_RECORDER_FILE_SINK_BUFFER_SIZE;
+
+  /* At least 2 units, so that recorder can store data while
+   * one unit is being written.
+   */
+
+  size = (size + write_size - 1) & ~(write_size - 1);
+
+  return (size < write_size * 2) ? write_size * 2 : size;
+}
+
+/*--------------------------------------------------------------------------*/
+static uint32_t get_header_size(const AsRecorderFileSinkParam &param)
+{
+  return (param.container == AS_RECORDER_FILE_SINK_CONTAINER_WAV) ?
+    sizeof(WAVHEADER64) : param.header_size;
+}
+
+/*--------------------------------------------------------------------------*/
+void *AudioRecorderFileSink::writer_entry(void *arg)
+{
+  static_cast<AudioRecorderFileSink *>(arg)->writer();
+  return NULL;
+}
+
+/*--------------------------------------------------------------------------*/
+void AudioRecorderFileSink::writer(void)
+{
+  pthread_mutex_lock(&m_lock);
+
+  for (;;)
+    {
+      /* Write only whole units while recording. Rest of data is
+       * written at close.
+       */
+
+      uint32_t size = static_cast<uint32_t>(m_wp - m_rp);
+
+      if (size >= m_write_size)
+        {
+          size = m_write_size;
+        }
+      else if (!m_closing)
+        {
+          pthread_cond_wait(&m_cond, &m_lock);
+          continue;
+        }
+      else if (size == 0)
+        {
+          break;
+        }
+
+      /* Area from m_rofs is not touched by recorder until m_rp is
+       * updated. m_rofs is aligned to write size, so the area does
+       * not wrap around.
+       */
+
+      bool closing = m_closing;
+
+      pthread_mutex_unlock(&m_lock);
+
+      int err = write_file(m_buf + m_rofs, size);
+
+      /* Header is rewritten with data written so far. It is also done
+       * at close, so not here while closing.
+       */
+
+      int header_err = 0;
+
+      if (err == 0 && !closing && m_header_update_interval != 0 &&
+          ++m_writes_since_update >= m_header_update_interval)
+        {
+          m_writes_since_update = 0;
+          header_err = update_header(m_rp + size);
+        }
+
+      pthread_mutex_lock(&m_lock);
+
+      if (err == 0)
+        {
+          m_rp += size;
+          m_rofs += size;
+          if (m_rofs == m_buf_size)
+            {
+              m_rofs = 0;
+            }
+
+          err = header_err;
+        }
+
+      if (err != 0)
+        {
+          /* Recorder sees the error at next write and stops. */
+
+          m_stats->error = err;
+          MEDIA_RECORDER_ERR(AS_ATTENTION_SUB_CODE_FILE_WRITE_ERROR);
+          break;
+        }
+    }
+
+  pthread_mutex_unlock(&m_lock);
+}
+
+/*--------------------------------------------------------------------------*/
+int AudioRecorderFileSink::write_file(const uint8_t *data, uint32_t size)
+{
+  struct timespec start;
+  struct timespec end;
+  uint32_t remain = size;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  while (remain > 0)
+    {
+      ssize_t ret = ::write(m_fd, data, remain);
+      if (ret < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+
+          return errno;
+        }
+
+      data   += ret;
+      remain -= ret;
+    }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  uint32_t usec = (end.tv_sec - start.tv_sec) * 1000000 +
+                  (end.tv_nsec - start.tv_nsec) / 1000;
+
+  update_stats(size, usec);
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------*/
+int AudioRecorderFileSink::update_header(uint64_t file_size)
+{
+  if (m_container != AS_RECORDER_FILE_SINK_CONTAINER_WAV)
+    {
+      return 0;
+    }
+
+  /* Header is written even if recording stopped before the first
+   * write, so that the file is a valid (empty) WAV file.
+   */
+
+  uint64_t data_size = (file_size > m_header_size) ?
+                         file_size - m_header_size : 0;
+
+  errno = 0;
+  if (!m_wav.updateHeader(m_fd, data_size))
+    {
+      return (errno != 0) ? errno : EIO;
+    }
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------*/
+void AudioRecorderFileSink::update_stats(uint32_t size, uint32_t usec)
+{
+  /* Exclude reserved header area from written size. */
+
+  uint32_t header = 0;
+  if (m_rp < m_header_size)
+    {
+      header = m_header_size - static_cast<uint32_t>(m_rp);
+      header = (header < size) ? header : size;
+    }
+
+  m_total_write_time += usec;
+
+  m_stats->written_size += size - header;
+  m_stats->write_num++;
+  m_stats->avg_write_time =
+    static_cast<uint32_t>(m_total_write_time / m_stats->write_num);
+
+  if (usec > m_stats->max_write_time)
+    {
+      m_stats->max_write_time = usec;
+    }
+
+  if (m_stall_threshold != 0 && usec > m_stall_threshold)
+    {
+      m_stats->stall_num++;
+      MEDIA_RECORDER_WARN(AS_ATTENTION_SUB_CODE_FILE_WRITE_STALL);
+    }
+
+  if (m_callback != NULL && size > header)
+    {
+      m_callback(size - header);
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+bool AudioRecorderFileSink::isValidParam(const AsRecorderFileSinkParam &param)
+{
+  uint32_t write_size = get_write_size(param);
+
+  if (param.path == NULL)
+    {
+      return false;
+    }
+
+  if (param.container >= AS_RECORDER_FILE_SINK_CONTAINER_NUM)
+    {
+      return false;
+    }
+
+  if (write_size == 0 || (write_size & (write_size - 1)) != 0)
+    {
+      return false;
+    }
+
+  /* Leave at least one unit for data. */
+
+  if (get_header_size(param) > get_buffer_size(param) - write_size)
+    {
+      return false;
+    }
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+uint32_t AudioRecorderFileSink::open(
+  const AsRecorderFileSinkParam &param,
+  AudioSimpleFifoWriteDoneCallbackFunction callback,
+  uint8_t channel_num,
+  uint32_t sampling_rate,
+  uint8_t bit_width)
+{
+  if (!isValidParam(param))
+    {
+      return AS_ECODE_COMMAND_PARAM_OUTPUT_HANDLER;
+    }
+
+  if (param.container == AS_RECORDER_FILE_SINK_CONTAINER_WAV &&
+      !m_wav.init(FORMAT_ID_PCM, channel_num, sampling_rate, bit_width))
+    {
+      return AS_ECODE_COMMAND_PARAM_OUTPUT_HANDLER;
+    }
+
+  m_write_size      = get_write_size(param);
+  m_buf_size        = get_buffer_size(param);
+  m_header_size     = get_header_size(param);
+  m_prealloc_size   = param.prealloc_size;
+  m_stall_threshold = param.stall_threshold * 1000;
+  m_callback        = callback;
+
+  m_container              = param.container;
+  m_header_update_interval = param.header_update_interval;
+  m_writes_since_update    = 0;
+
+  m_stats = (param.stats != NULL) ? param.stats : &m_local_stats;
+  memset(m_stats, 0, sizeof(AsRecorderFileSinkStats));
+  m_total_write_time = 0;
+
+  m_buf = static_cast<uint8_t *>(malloc(m_buf_size));
+  if (m_buf == NULL)
+    {
+      MEDIA_RECORDER_ERR(AS_ATTENTION_SUB_CODE_ALLOC_HEAP_MEMORY);
+      return AS_ECODE_FILE_ACCESS_ERROR;
+    }
+
+  m_fd = ::open(param.path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (m_fd < 0)
+    {
+      m_stats->error = errno;
+      free(m_buf);
+      m_buf = NULL;
+      return AS_ECODE_FILE_ACCESS_ERROR;
+    }
+
+  /* Preallocation lets the file system reserve clusters at once.
+   * It is optional, so failure is not an error.
+   */
+
+  if (m_prealloc_size > m_header_size)
+    {
+      (void)ftruncate(m_fd, m_prealloc_size);
+    }
+
+  /* Header area is written with the first unit. WAV header without
+   * size is valid for the parser, which then takes size from the file.
+   */
+
+  if (m_container == AS_RECORDER_FILE_SINK_CONTAINER_WAV)
+    {
+      m_wav.getHeader(reinterpret_cast<WAVHEADER64 *>(m_buf), 0);
+    }
+  else
+    {
+      memset(m_buf, 0, m_header_size);
+    }
+
+  m_wp      = m_header_size;
+  m_rp      = 0;
+  m_wofs    = m_header_size;
+  m_rofs    = 0;
+  m_closing = false;
+
+  pthread_mutex_init(&m_lock, NULL);
+  pthread_cond_init(&m_cond, NULL);
+
+  pthread_attr_t attr;
+  struct sched_param sch_param;
+
+  pthread_attr_init(&attr);
+  sch_param.sched_priority = CONFIG_AUDIOUTILS_RECORDER_FILE_SINK_PRIORITY;
+  pthread_attr_setschedparam(&attr, &sch_param);
+  pthread_attr_setstacksize(&attr,
+                            CONFIG_AUDIOUTILS_RECORDER_FILE_SINK_STACKSIZE);
+
+  int ret = pthread_create(&m_thread,
+                           &attr,
+                           writer_entry,
+                           static_cast<pthread_addr_t>(this));
+
+  pthread_attr_destroy(&attr);
+
+  if (ret != 0)
+    {
+      m_stats->error = ret;
+      pthread_cond_destroy(&m_cond);
+      pthread_mutex_destroy(&m_lock);
+      ::close(m_fd);
+      m_fd = -1;
+      free(m_buf);
+      m_buf = NULL;
+      return AS_ECODE_FILE_ACCESS_ERROR;
+    }
+
+  return AS_ECODE_OK;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AudioRecorderFileSink::write(const void *data, uint32_t size)
+{
+  if (m_fd < 0)
+    {
+      return false;
+    }
+
+  pthread_mutex_lock(&m_lock);
+
+  uint32_t used = static_cast<uint32_t>(m_wp - m_rp);
+  bool rst = (m_stats->error == 0 && size <= m_buf_size - used);
+
+  pthread_mutex_unlock(&m_lock);
+
+  if (!rst)
+    {
+      return false;
+    }
+
+  /* Area from m_wofs is not read by writer until m_wp is updated. */
+
+  const uint8_t *src = static_cast<const uint8_t *>(data);
+  uint32_t first = m_buf_size - m_wofs;
+
+  if (size < first)
+    {
+      memcpy(m_buf + m_wofs, src, size);
+      m_wofs += size;
+    }
+  else
+    {
+      memcpy(m_buf + m_wofs, src, first);
+      memcpy(m_buf, src + first, size - first);
+      m_wofs = size - first;
+    }
+
+  pthread_mutex_lock(&m_lock);
+
+  /* Wake up writer only when a unit is completed. */
+
+  uint64_t unit_mask = ~static_cast<uint64_t>(m_write_size - 1);
+  bool wakeup = ((m_wp & unit_mask) != ((m_wp + size) & unit_mask));
+
+  m_wp += size;
+
+  used = static_cast<uint32_t>(m_wp - m_rp);
+  if (used > m_stats->max_buffered_size)
+    {
+      m_stats->max_buffered_size = used;
+    }
+
+  if (wakeup)
+    {
+      pthread_cond_signal(&m_cond);
+    }
+
+  pthread_mutex_unlock(&m_lock);
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AudioRecorderFileSink::close(void)
+{
+  if (m_fd < 0)
+    {
+      return true;
+    }
+
+  /* Writer writes rest of data and exits. */
+
+  pthread_mutex_lock(&m_lock);
+  m_closing = true;
+  pthread_cond_signal(&m_cond);
+  pthread_mutex_unlock(&m_lock);
+
+  pthread_join(m_thread, NULL);
+
+  pthread_cond_destroy(&m_cond);
+  pthread_mutex_destroy(&m_lock);
+
+  bool rst = (m_stats->error == 0);
+
+  /* Finalize header by the size actually written. */
+
+  int err = update_header(m_rp);
+  if (err != 0 && rst)
+    {
+      m_stats->error = err;
+      MEDIA_RECORDER_ERR(AS_ATTENTION_SUB_CODE_FILE_WRITE_ERROR);
+      rst = false;
+    }
+
+  /* Drop preallocated area after data. */
+
+  if (m_prealloc_size > m_rp)
+    {
+      if (ftruncate(m_fd, static_cast<off_t>(m_rp)) < 0)
+        {
+          m_stats->error = errno;
+          rst = false;
+        }
+    }
+
+  if (fsync(m_fd) < 0 && rst)
+    {
+      m_stats->error = errno;
+      rst = false;
+    }
+
+  if (::close(m_fd) < 0 && rst)
+    {
+      m_stats->error = errno;
+      rst = false;
+    }
+
+  m_fd = -1;
+
+  free(m_buf);
+  m_buf = NULL;
+
+  return rst;
+}
+
+__WIEN2_END_NAMESPACE
@@ -0,0 +1,174 @@
+/****************************************************************************
+ * modules/audio/objects/media_recorder/audio_recorder_file_sink.h
+ *
+ *   Copyright 2018 Sony Semiconductor Solutions Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Semiconductor Solutions Corporation nor
+ *    the names of its contributors may be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __MODULES_AUDIO_OBJECTS_MEDIA_RECORDER_AUDIO_RECORDER_FILE_SINK_H
+#define __MODULES_AUDIO_OBJECTS_MEDIA_RECORDER_AUDIO_RECORDER_FILE_SINK_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <pthread.h>
+#include <sdk/config.h>
+#include "audio/audio_high_level_api.h"
+#include "wien2_common_defs.h"
+#include "container_format_lib/wav_containerformat.h"
+
+__WIEN2_BEGIN_NAMESPACE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_AUDIOUTILS_RECORDER_FILE_SINK_BUFFER_SIZE
+#  define CONFIG_AUDIOUTILS_RECORDER_FILE_SINK_BUFFER_SIZE 65536
+#endif
+
+#ifndef CONFIG_AUDIOUTILS_RECORDER_FILE_SINK_WRITE_SIZE
+#  define CONFIG_AUDIOUTILS_RECORDER_FILE_SINK_WRITE_SIZE 16384
+#endif
+
+#ifndef CONFIG_AUDIOUTILS_RECORDER_FILE_SINK_PRIORITY
+#  define CONFIG_AUDIOUTILS_RECORDER_FILE_SINK_PRIORITY 100
+#endif
+
+#ifndef CONFIG_AUDIOUTILS_RECORDER_FILE_SINK_STACKSIZE
+#  define CONFIG_AUDIOUTILS_RECORDER_FILE_SINK_STACKSIZE 2048
+#endif
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* File output of recorder.
+ *
+ * write() is called from recorder object and only copies data to a
+ * ring buffer. A writer thread writes the buffer to file in units of
+ * write size, so each write covers whole clusters at a cluster aligned
+ * offset and write latency of the storage is absorbed by the buffer.
+ *
+ * Buffer positions are counted in file offset. Reserved header area
+ * is put in the buffer as 0 (or an empty WAV header) before data, so
+ * that data written by the writer thread is always aligned and no seek
+ * is needed. WAV header is rewritten in place by the writer thread
+ * every header update interval and at close.
+ *
+ * The writer thread is a pthread of recorder task, because file
+ * descriptors are not shared between tasks.
+ */
+
+class AudioRecorderFileSink
+{
+public:
+  AudioRecorderFileSink()
+    : m_fd(-1)
+    , m_buf(NULL)
+  {
+  }
+
+  ~AudioRecorderFileSink() { close(); }
+
+  /* channel_num, sampling_rate and bit_width (8 * bytes per sample)
+   * are used only for WAV container.
+   */
+
+  uint32_t open(const AsRecorderFileSinkParam &param,
+                AudioSimpleFifoWriteDoneCallbackFunction callback,
+                uint8_t channel_num,
+                uint32_t sampling_rate,
+                uint8_t bit_width);
+  bool write(const void *data, uint32_t size);
+  bool close(void);
+
+  static bool isValidParam(const AsRecorderFileSinkParam &param);
+
+private:
+  int      m_fd;
+  uint8_t *m_buf;
+  uint32_t m_buf_size;
+  uint32_t m_write_size;
+  uint32_t m_header_size;
+  uint32_t m_prealloc_size;
+  uint32_t m_stall_threshold;  /* usec */
+
+  uint8_t  m_container;
+  uint32_t m_header_update_interval;
+  uint32_t m_writes_since_update;
+  WavContainerFormat m_wav;
+
+  /* File offset of next data from recorder (m_wp) and of next write
+   * to file (m_rp), and their index in buffer.
+   */
+
+  uint64_t m_wp;
+  uint64_t m_rp;
+  uint32_t m_wofs;
+  uint32_t m_rofs;
+
+  bool     m_closing;
+  uint64_t m_total_write_time;
+
+  AsRecorderFileSinkStats *m_stats;
+  AsRecorderFileSinkStats  m_local_stats;
+
+  AudioSimpleFifoWriteDoneCallbackFunction m_callback;
+
+  pthread_t       m_thread;
+  pthread_mutex_t m_lock;
+  pthread_cond_t  m_cond;
+
+  static void *writer_entry(void *arg);
+  void writer(void);
+  int write_file(const uint8_t *data, uint32_t size);
+  int update_header(uint64_t file_size);
+  void update_stats(uint32_t size, uint32_t usec);
+};
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/****************************************************************************
+ * Inline Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+__WIEN2_END_NAMESPACE
+
+#endif /* __MODULES_AUDIO_OBJECTS_MEDIA_RECORDER_AUDIO_RECORDER_FILE_SINK_H */
@@ -68,15 +68,41 @@ __WIEN2_BEGIN_NAMESPACE
  * Private Functions
  ****************************************************************************/
 
-bool AudioRecorderSink::init(const InitAudioRecSinkParam_s &param)
+uint32_t AudioRecorderSink::init(const InitAudioRecSinkParam_s &param)
 {
+  m_output_device = param.output_device;
+
+#ifdef CONFIG_AUDIOUTILS_RECORDER_FILE_SINK
+  if (m_output_device == AS_SETRECDR_STS_OUTPUTDEVICE_FILE)
+    {
+      return m_file_sink.open(param.init_audio_file_sink.file_sink_param,
+                              param.init_audio_file_sink.callback_function,
+                              param.init_audio_file_sink.channel_num,
+                              param.init_audio_file_sink.sampling_rate,
+                              param.init_audio_file_sink.bit_width);
+    }
+#endif
+
   m_output_device_hdlr = param.init_audio_ram_sink.output_device_hdlr;
-  return true;
+  return AS_ECODE_OK;
 }
 
 /*--------------------------------------------------------------------------*/
 bool AudioRecorderSink::write(const AudioRecSinkData_s &param)
 {
+#ifdef CONFIG_AUDIOUTILS_RECORDER_FILE_SINK
+  if (m_output_device == AS_SETRECDR_STS_OUTPUTDEVICE_FILE)
+    {
+      if (param.byte_size > 0 &&
+          !m_file_sink.write(param.mh.getVa(), param.byte_size))
+        {
+          MEDIA_RECORDER_WARN(AS_ATTENTION_SUB_CODE_SIMPLE_FIFO_OVERFLOW);
+          return false;
+        }
+      return true;
+    }
+#endif
+
   if (param.byte_size > 0) {
     if (CMN_SimpleFifoGetVacantSize(static_cast<CMN_SimpleFifoHandle *>
         (m_output_device_hdlr.simple_fifo_handler)) < param.byte_size)
@@ -101,6 +127,13 @@ bool AudioRecorderSink::write(const AudioRecSinkData_s &param)
 /*--------------------------------------------------------------------------*/
 bool AudioRecorderSink::finalize(void)
 {
+#ifdef CONFIG_AUDIOUTILS_RECORDER_FILE_SINK
+  if (m_output_device == AS_SETRECDR_STS_OUTPUTDEVICE_FILE)
+    {
+      return m_file_sink.close();
+    }
+#endif
+
   return true;
 }
 
@@ -40,8 +40,12 @@
  * Included Files
  ****************************************************************************/
 
+#include <sdk/config.h>
 #include "wien2_common_defs.h"
 #include "wien2_internal_packet.h"
+#ifdef CONFIG_AUDIOUTILS_RECORDER_FILE_SINK
+#include "audio_recorder_file_sink.h"
+#endif
 
 __WIEN2_BEGIN_NAMESPACE
 
@@ -65,12 +69,31 @@ public:
   AsRecorderOutputDeviceHdlr output_device_hdlr;
 };
 
+/* Parameters for initializing sinker of voice recorder
+ * that writes output data to a file.
+ */
+
+struct InitAudioRecFileSinkParam_s
+{
+public:
+  AsRecorderFileSinkParam file_sink_param;
+  AudioSimpleFifoWriteDoneCallbackFunction callback_function;
+
+  /* PCM format for WAV container */
+
+  uint8_t  channel_num;
+  uint32_t sampling_rate;
+  uint8_t  bit_width;
+};
+
 /* Parameters for initializing sinker of voice recorder. */
 
 struct InitAudioRecSinkParam_s
 {
 public:
+  AsSetRecorderStsOutputDevice output_device;
   InitAudioRecRamSinkParam_s init_audio_ram_sink;
+  InitAudioRecFileSinkParam_s init_audio_file_sink;
 };
 
 /* Data to the sinker of voice recorder. */
@@ -85,16 +108,23 @@ public:
 class AudioRecorderSink
 {
 public:
-  AudioRecorderSink() {}
+  AudioRecorderSink()
+    : m_output_device(AS_SETRECDR_STS_OUTPUTDEVICE_RAM)
+  {}
 
   ~AudioRecorderSink() {}
 
-  bool init(const InitAudioRecSinkParam_s &param);
+  uint32_t init(const InitAudioRecSinkParam_s &param);
   bool write(const AudioRecSinkData_s &param);
   bool finalize(void);
 
 private:
+  AsSetRecorderStsOutputDevice m_output_device;
   AsRecorderOutputDeviceHdlr m_output_device_hdlr;
+
+#ifdef CONFIG_AUDIOUTILS_RECORDER_FILE_SINK
+  AudioRecorderFileSink m_file_sink;
+#endif
 };
 
 /****************************************************************************
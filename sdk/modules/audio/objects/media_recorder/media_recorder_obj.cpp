@@ -540,6 +540,9 @@ void MediaRecorderObjectTask::activate(MsgPacket *msg)
   switch (m_output_device)
     {
       case AS_SETRECDR_STS_OUTPUTDEVICE_RAM:
+#ifdef CONFIG_AUDIOUTILS_RECORDER_FILE_SINK
+      case AS_SETRECDR_STS_OUTPUTDEVICE_FILE:
+#endif
         m_p_output_device_handler =
           act.param.output_device_handler;
         break;
@@ -711,14 +714,6 @@ void MediaRecorderObjectTask::startOnReady(MsgPacket *msg)
 
   MEDIA_RECORDER_DBG("START:\n");
 
-  InitAudioRecSinkParam_s init_sink;
-  if (m_output_device == AS_SETRECDR_STS_OUTPUTDEVICE_RAM)
-    {
-      init_sink.init_audio_ram_sink.output_device_hdlr =
-        *m_p_output_device_handler;
-    }
-  m_rec_sink.init(init_sink);
-
   CaptureComponentParam cap_comp_param;
   bool result = true;
   uint32_t apu_result = AS_ECODE_OK;
@@ -813,6 +808,46 @@ void MediaRecorderObjectTask::startOnReady(MsgPacket *msg)
 
   m_output_buf_mh_que.clear();
 
+  InitAudioRecSinkParam_s init_sink;
+  init_sink.output_device = m_output_device;
+  if (m_output_device == AS_SETRECDR_STS_OUTPUTDEVICE_RAM)
+    {
+      init_sink.init_audio_ram_sink.output_device_hdlr =
+        *m_p_output_device_handler;
+    }
+  else if (m_output_device == AS_SETRECDR_STS_OUTPUTDEVICE_FILE)
+    {
+      init_sink.init_audio_file_sink.file_sink_param =
+        *m_p_output_device_handler->file_sink;
+      init_sink.init_audio_file_sink.callback_function =
+        m_p_output_device_handler->callback_function;
+      init_sink.init_audio_file_sink.channel_num   = m_channel_num;
+      init_sink.init_audio_file_sink.sampling_rate = m_sampling_rate;
+      init_sink.init_audio_file_sink.bit_width     =
+        (m_pcm_bit_width == AudPcm16Bit) ? 16 :
+        (m_pcm_bit_width == AudPcm24Bit) ? 24 : 32;
+
+      /* WAV container holds only LPCM. */
+
+      if (m_p_output_device_handler->file_sink->container ==
+            AS_RECORDER_FILE_SINK_CONTAINER_WAV &&
+          m_codec_type != AudCodecLPCM)
+        {
+          MEDIA_RECORDER_ERR(AS_ATTENTION_SUB_CODE_UNEXPECTED_PARAM);
+          m_callback(AsRecorderEventStart,
+                     AS_ECODE_COMMAND_PARAM_OUTPUT_HANDLER,
+                     0);
+          return;
+        }
+    }
+
+  uint32_t sink_result = m_rec_sink.init(init_sink);
+  if (sink_result != AS_ECODE_OK)
+    {
+      m_callback(AsRecorderEventStart, sink_result, 0);
+      return;
+    }
+
   if (startCapture())
     {
       m_state = RecorderStateRecording;
@@ -822,6 +857,7 @@ void MediaRecorderObjectTask::startOnReady(MsgPacket *msg)
     }
   else
     {
+      m_rec_sink.finalize();
       m_callback(AsRecorderEventStart, AS_ECODE_DMAC_READ_ERROR, 0);
     }
 }
@@ -1382,6 +1418,20 @@ uint32_t MediaRecorderObjectTask::isValidActivateParam(
         m_output_device = AS_SETRECDR_STS_OUTPUTDEVICE_RAM;
         break;
 
+#ifdef CONFIG_AUDIOUTILS_RECORDER_FILE_SINK
+      case AS_SETRECDR_STS_OUTPUTDEVICE_FILE:
+        if (param.output_device_handler == NULL ||
+            param.output_device_handler->file_sink == NULL ||
+            !AudioRecorderFileSink::isValidParam(
+              *param.output_device_handler->file_sink))
+          {
+            MEDIA_RECORDER_ERR(AS_ATTENTION_SUB_CODE_UNEXPECTED_PARAM);
+            return AS_ECODE_COMMAND_PARAM_OUTPUT_HANDLER;
+          }
+        m_output_device = AS_SETRECDR_STS_OUTPUTDEVICE_FILE;
+        break;
+#endif
+
       default:
         MEDIA_RECORDER_ERR(AS_ATTENTION_SUB_CODE_UNEXPECTED_PARAM);
         return AS_ECODE_COMMAND_PARAM_OUTPUT_DEVICE;
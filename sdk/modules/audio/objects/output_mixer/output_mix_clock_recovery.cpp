@@ -0,0 +1,317 @@
+/****************************************************************************
+ * modules/audio/objects/output_mixer/output_mix_clock_recovery.cpp
+ *
+ *   Copyright 2018 Sony Semiconductor Solutions Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Semiconductor Solutions Corporation nor
+ *    the names of its contributors may be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <string.h>
+#include "audio/audio_common_defs.h"
+#include "output_mix_clock_recovery.h"
+
+__WIEN2_BEGIN_NAMESPACE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define RATE_PER_PPM   4295        /* 2^32 / 1000000 */
+#define DIV6_Q32       715827883   /* 2^32 / 6 */
+
+#define PCM24_MAX      ((1 << 23) - 1)
+#define PCM24_MIN      (-(1 << 23))
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* Cubic Lagrange interpolation between x0 and x1 in Farrow form.
+ * x is {x[-1], x[0], x[1], x[2]}, mu is Q31. Inputs are up to 24bit,
+ * all terms are kept in 64bit.
+ */
+
+static inline int32_t interpolate(int64_t xm, int64_t x0,
+                                  int64_t x1, int64_t x2, int64_t mu)
+{
+  int64_t a3 = (x2 - xm) + 3 * (x0 - x1);
+  int64_t a2 = 3 * (xm + x1) - 6 * x0;
+  int64_t a1 = -2 * xm - 3 * x0 + 6 * x1 - x2;
+
+  int64_t t = ((a3 * mu) >> 31) + a2;
+  t = ((t * mu) >> 31) + a1;
+  t = ((t * mu) >> 31) + 6 * x0;
+
+  return static_cast<int32_t>((t * DIV6_Q32 + (1LL << 31)) >> 32);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/*--------------------------------------------------------------------------*/
+void OutputMixClockRecovery::reset(uint32_t target)
+{
+  m_config_target = target;
+  restart();
+}
+
+/*--------------------------------------------------------------------------*/
+void OutputMixClockRecovery::restart(void)
+{
+  m_target    = m_config_target;
+  m_learn_cnt = 0;
+  m_learn_sum = 0;
+  m_level     = 0;
+  m_integ     = 0;
+  m_ppm       = 0;
+
+  m_bit_length = 0;
+  clear_filter();
+}
+
+/*--------------------------------------------------------------------------*/
+void OutputMixClockRecovery::clear_filter(void)
+{
+  m_frac     = 0;
+  m_pending  = 0;
+  m_ring_rd  = 0;
+  m_ring_cnt = 0;
+
+  memset(m_window, 0, sizeof(m_window));
+}
+
+/*--------------------------------------------------------------------------*/
+void OutputMixClockRecovery::push_input(const void *buf,
+                                        uint32_t idx,
+                                        bool is_16)
+{
+  int32_t *dst = m_ring[(m_ring_rd + m_ring_cnt) & (RingSize - 1)];
+
+  if (is_16)
+    {
+      const int16_t *src = static_cast<const int16_t *>(buf) + idx * 2;
+
+      dst[0] = src[0];
+      dst[1] = src[1];
+    }
+  else
+    {
+      const int32_t *src = static_cast<const int32_t *>(buf) + idx * 2;
+
+      dst[0] = src[0] >> 8;
+      dst[1] = src[1] >> 8;
+    }
+
+  m_ring_cnt++;
+}
+
+/*--------------------------------------------------------------------------*/
+int32_t OutputMixClockRecovery::update(uint32_t level)
+{
+  /* Learn target level from the first frames. Level at start is
+   * what the source was able to buffer, keep it.
+   */
+
+  if (m_learn_cnt < LearnFrames)
+    {
+      m_learn_sum += level;
+      m_learn_cnt++;
+
+      if (m_learn_cnt == LearnFrames)
+        {
+          if (m_target == 0)
+            {
+              m_target = m_learn_sum / LearnFrames;
+            }
+
+          m_level = static_cast<int32_t>((m_learn_sum / LearnFrames) << 8);
+        }
+
+      return m_ppm;
+    }
+
+  /* Level jumps by a frame at each render request and done,
+   * smooth it before use.
+   */
+
+  m_level += ((static_cast<int32_t>(level) << 8) - m_level) >> 3;
+
+  int32_t err = (m_level >> 8) - static_cast<int32_t>(m_target);
+
+  /* More data than target means source is faster than I2S,
+   * so consume faster (positive ppm).
+   */
+
+  const int32_t integ_max =
+    (CONFIG_AUDIOUTILS_OUTPUTMIX_CLKRCV_MAX_PPM << 16) / Ki;
+
+  m_integ += err;
+  m_integ = (m_integ > integ_max) ? integ_max : m_integ;
+  m_integ = (m_integ < -integ_max) ? -integ_max : m_integ;
+
+  int64_t ppm = ((int64_t)err * Kp + (int64_t)m_integ * Ki) >> 16;
+
+  if (ppm > CONFIG_AUDIOUTILS_OUTPUTMIX_CLKRCV_MAX_PPM)
+    {
+      ppm = CONFIG_AUDIOUTILS_OUTPUTMIX_CLKRCV_MAX_PPM;
+    }
+  else if (ppm < -CONFIG_AUDIOUTILS_OUTPUTMIX_CLKRCV_MAX_PPM)
+    {
+      ppm = -CONFIG_AUDIOUTILS_OUTPUTMIX_CLKRCV_MAX_PPM;
+    }
+
+  m_ppm = static_cast<int32_t>(ppm);
+
+  return m_ppm;
+}
+
+/*--------------------------------------------------------------------------*/
+uint32_t OutputMixClockRecovery::exec(void *buf,
+                                      uint32_t frames,
+                                      uint32_t max_frames,
+                                      uint8_t bit_length)
+{
+  int16_t *buf16 = static_cast<int16_t *>(buf);
+  int32_t *buf32 = static_cast<int32_t *>(buf);
+  bool     is_16 = (bit_length == AS_BITLENGTH_16);
+
+  if (bit_length != m_bit_length)
+    {
+      clear_filter();
+      m_bit_length = bit_length;
+    }
+
+  if (max_frames > frames + MaxExtra)
+    {
+      max_frames = frames + MaxExtra;
+    }
+
+  uint64_t step = (1ULL << 32) + (int64_t)m_ppm * RATE_PER_PPM;
+  uint32_t rd   = 0;
+  uint32_t wr   = 0;
+
+  for (;;)
+    {
+      /* Output is written over input, so read input up to the
+       * write position ahead.
+       */
+
+      while (rd < frames && rd <= wr && m_ring_cnt < RingSize)
+        {
+          push_input(buf, rd++, is_16);
+        }
+
+      /* Shift consumed input into window. */
+
+      while (m_pending > 0)
+        {
+          if (m_ring_cnt == 0)
+            {
+              if (rd >= frames)
+                {
+                  break;
+                }
+
+              push_input(buf, rd++, is_16);
+            }
+
+          for (uint32_t ch = 0; ch < 2; ch++)
+            {
+              m_window[0][ch] = m_window[1][ch];
+              m_window[1][ch] = m_window[2][ch];
+              m_window[2][ch] = m_window[3][ch];
+              m_window[3][ch] = m_ring[m_ring_rd][ch];
+            }
+
+          m_ring_rd = (m_ring_rd + 1) & (RingSize - 1);
+          m_ring_cnt--;
+          m_pending--;
+        }
+
+      if (m_pending > 0 || wr >= max_frames || (rd <= wr && rd < frames))
+        {
+          break;
+        }
+
+      int64_t mu = m_frac >> 1;
+
+      for (uint32_t ch = 0; ch < 2; ch++)
+        {
+          int32_t y = interpolate(m_window[0][ch], m_window[1][ch],
+                                  m_window[2][ch], m_window[3][ch], mu);
+
+          if (is_16)
+            {
+              y = (y > INT16_MAX) ? INT16_MAX : y;
+              y = (y < INT16_MIN) ? INT16_MIN : y;
+              buf16[wr * 2 + ch] = static_cast<int16_t>(y);
+            }
+          else
+            {
+              y = (y > PCM24_MAX) ? PCM24_MAX : y;
+              y = (y < PCM24_MIN) ? PCM24_MIN : y;
+              buf32[wr * 2 + ch] = static_cast<int32_t>(
+                                     static_cast<uint32_t>(y) << 8);
+            }
+        }
+
+      wr++;
+
+      uint64_t pos = m_frac + step;
+
+      m_pending = static_cast<uint32_t>(pos >> 32);
+      m_frac    = static_cast<uint32_t>(pos);
+    }
+
+  /* Keep input which was not used for next frame. This happens only
+   * when output is limited by max_frames. If the ring is full, the
+   * oldest data is dropped.
+   */
+
+  while (rd < frames)
+    {
+      if (m_ring_cnt == RingSize)
+        {
+          m_ring_rd = (m_ring_rd + 1) & (RingSize - 1);
+          m_ring_cnt--;
+        }
+
+      push_input(buf, rd++, is_16);
+    }
+
+  return wr;
+}
+
+__WIEN2_END_NAMESPACE
@@ -0,0 +1,142 @@
+/****************************************************************************
+ * modules/audio/objects/output_mixer/output_mix_clock_recovery.h
+ *
+ *   Copyright 2018 Sony Semiconductor Solutions Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Semiconductor Solutions Corporation nor
+ *    the names of its contributors may be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __MODULES_AUDIO_OBJECTS_OUTPUT_MIXER_OUTPUT_MIX_CLOCK_RECOVERY_H
+#define __MODULES_AUDIO_OBJECTS_OUTPUT_MIXER_OUTPUT_MIX_CLOCK_RECOVERY_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <sdk/config.h>
+#include "wien2_common_defs.h"
+
+__WIEN2_BEGIN_NAMESPACE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_AUDIOUTILS_OUTPUTMIX_CLKRCV_MAX_PPM
+#  define CONFIG_AUDIOUTILS_OUTPUTMIX_CLKRCV_MAX_PPM 1000
+#endif
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Automatic clock recovery.
+ *
+ * update() is called once per frame with the fill level of the output
+ * path. A PI controller turns the distance of the level from target
+ * into a rate offset in ppm. exec() resamples the frame in place by
+ * the rate with a cubic (Farrow structure Lagrange) interpolator, so
+ * the number of output samples changes by a fraction of a sample per
+ * frame instead of one whole sample at a time.
+ *
+ * Data is always interleaved stereo, 16bit or 24bit in 32bit container.
+ */
+
+class OutputMixClockRecovery
+{
+public:
+  OutputMixClockRecovery() { reset(0); }
+
+  /* Restart learning. target is the fill level to keep in samples,
+   * 0 means the average level of the first frames.
+   */
+
+  void reset(uint32_t target);
+
+  /* Restart learning with target given by reset(). */
+
+  void restart(void);
+
+  int32_t update(uint32_t level);
+
+  /* Resample frames of buf in place. Up to max_frames are written.
+   * Returns number of output frames.
+   */
+
+  uint32_t exec(void *buf,
+                uint32_t frames,
+                uint32_t max_frames,
+                uint8_t bit_length);
+
+  int32_t get_ppm(void) const { return m_ppm; }
+
+private:
+  static const uint32_t LearnFrames = 16;
+  static const uint32_t RingSize    = 32;  /* Must be a power of 2 */
+  static const uint32_t MaxExtra    = 8;   /* Frames over input per call */
+
+  /* Level error (samples) to ppm gains (Q16). Kp is 1ppm per sample
+   * and Ki is chosen for damping of about 0.7 with 1024 sample frames.
+   */
+
+  static const int32_t  Kp = 65536;
+  static const int32_t  Ki = 37;
+
+  /* Controller */
+
+  uint32_t m_config_target;
+  uint32_t m_target;
+  uint32_t m_learn_cnt;
+  uint32_t m_learn_sum;
+  int32_t  m_level;     /* Filtered level (Q8) */
+  int32_t  m_integ;
+  int32_t  m_ppm;
+
+  /* Interpolator */
+
+  uint8_t  m_bit_length;
+  uint32_t m_frac;      /* Position between window[1] and window[2] (Q32) */
+  uint32_t m_pending;   /* Input frames to shift in before next output */
+  int32_t  m_window[4][2];
+
+  /* Input frames read ahead from buffer */
+
+  uint32_t m_ring_rd;
+  uint32_t m_ring_cnt;
+  int32_t  m_ring[RingSize][2];
+
+  void clear_filter(void);
+  void push_input(const void *buf, uint32_t idx, bool is_16);
+};
+
+__WIEN2_END_NAMESPACE
+
+#endif /* __MODULES_AUDIO_OBJECTS_OUTPUT_MIXER_OUTPUT_MIX_CLOCK_RECOVERY_H */
@@ -95,6 +95,19 @@ OutputMixObjectTask::OutputMixObjectTask(AsOutputMixMsgQueId_t msgq_id,
     m_output_mix_to_hpi2s[1].set_apu_pool_id(pool_id.render_path1_filter_dsp);
   }
 
+/*--------------------------------------------------------------------------*/
+bool OutputMixObjectTask::setSourceLevel(uint8_t handle, uint32_t level)
+{
+  if (handle >= HPI2SoutChNum)
+    {
+      return false;
+    }
+
+  m_output_mix_to_hpi2s[handle].set_source_level(level);
+
+  return true;
+}
+
 /*--------------------------------------------------------------------------*/
 int OutputMixObjectTask::getHandle(MsgPacket* msg)
 {
@@ -106,6 +119,7 @@ int OutputMixObjectTask::getHandle(MsgPacket* msg)
       case MSG_AUD_MIX_CMD_ACT:
       case MSG_AUD_MIX_CMD_DEACT:
       case MSG_AUD_MIX_CMD_CLKRECOVERY:
+      case MSG_AUD_MIX_CMD_SETPFPARAM:
         handle = msg->peekParam<OutputMixerCommand>().handle;
         break;
 
@@ -305,6 +319,49 @@ bool AS_FrameTermFineControlOutputMixer(uint8_t handle, FAR AsFrameTermFineContr
   return true;
 }
 
+/*--------------------------------------------------------------------------*/
+bool AS_SetPostFilterParamOutputMixer(uint8_t handle,
+                                      FAR AsSetPostFilterParam *pfparam)
+{
+  /* Parameter check */
+
+  if (pfparam == NULL)
+    {
+      return false;
+    }
+
+  /* Set postfilter parameter */
+
+  OutputMixerCommand cmd;
+
+  cmd.handle        = handle;
+  cmd.pfparam_param = *pfparam;
+
+  err_t er = MsgLib::send<OutputMixerCommand>(s_msgq_id.mixer,
+                                              MsgPriNormal,
+                                              MSG_AUD_MIX_CMD_SETPFPARAM,
+                                              s_msgq_id.mng,
+                                              cmd);
+  F_ASSERT(er == ERR_OK);
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool AS_SetSourceLevelOutputMixer(uint8_t handle, uint32_t level)
+{
+  /* Level is read by output mixer task at each frame,
+   * no need to send message.
+   */
+
+  if (s_omix_ojb == NULL)
+    {
+      return false;
+    }
+
+  return s_omix_ojb->setSourceLevel(handle, level);
+}
+
 /*--------------------------------------------------------------------------*/
 bool AS_DeactivateOutputMixer(uint8_t handle, FAR AsDeactivateOutputMixer *deactparam)
 {
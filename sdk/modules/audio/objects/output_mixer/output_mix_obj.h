@@ -66,6 +66,8 @@ public:
   OutputMixObjectTask(AsOutputMixMsgQueId_t msgq_id,
                       AsOutputMixPoolId_t pool_id);
 
+  bool setSourceLevel(uint8_t handle, uint32_t level);
+
 private:
   AsOutputMixMsgQueId_t m_msgq_id;
   static const int HPI2SoutChNum = 2;
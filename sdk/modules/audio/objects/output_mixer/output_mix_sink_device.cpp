@@ -40,6 +40,7 @@
 #include <arch/chip/cxd56_audio.h>
 #include "output_mix_sink_device.h"
 #include "debug/dbg_log.h"
+#include "debug/audio_trace.h"
 
 __WIEN2_BEGIN_NAMESPACE
 
@@ -207,6 +208,15 @@ OutputMixToHPI2S::MsgProc OutputMixToHPI2S::MsgProcTbl[AUD_MIX_MSG_NUM][StateNum
     &OutputMixToHPI2S::clock_recovery,        /*  Stopping               */
     &OutputMixToHPI2S::clock_recovery         /*  Underflow              */
   },
+
+  /* Message type: SETPFPARAM */
+  {                                           /* OutputMixToHPI2S State: */
+    &OutputMixToHPI2S::illegal,               /*  Booted                 */
+    &OutputMixToHPI2S::set_postfilter_param,  /*  Ready                  */
+    &OutputMixToHPI2S::set_postfilter_param,  /*  Active                 */
+    &OutputMixToHPI2S::set_postfilter_param,  /*  Stopping               */
+    &OutputMixToHPI2S::set_postfilter_param   /*  Underflow              */
+  },
 };
 
 /*--------------------------------------------------------------------------*/
@@ -261,6 +271,7 @@ void OutputMixToHPI2S::illegal(MsgPacket* msg)
       case MSG_AUD_MIX_CMD_ACT:
       case MSG_AUD_MIX_CMD_DEACT:
       case MSG_AUD_MIX_CMD_CLKRECOVERY:
+      case MSG_AUD_MIX_CMD_SETPFPARAM:
         msg->moveParam<OutputMixerCommand>();
         break;
 
@@ -367,6 +378,10 @@ void OutputMixToHPI2S::deact(MsgPacket* msg)
 
   AS_postfilter_deactivate(m_p_postfliter_instance);
 
+  /* Parameters are not taken over to next activation */
+
+  m_pfparam_pending = 0;
+
   /* Replay */
 
   done_param.handle    = handle;
@@ -384,6 +399,8 @@ void OutputMixToHPI2S::input_data_on_ready(MsgPacket* msg)
   AsPcmDataParam input =
     msg->moveParam<AsPcmDataParam>();
 
+  AUDIO_TRACE(AudioTraceMixIn, m_state.get());
+
   /* Init post filter */
 
   InitPostfilterParam init;
@@ -395,6 +412,12 @@ void OutputMixToHPI2S::input_data_on_ready(MsgPacket* msg)
   init.callback    = postfilter_done_callback;
   init.p_requester = static_cast<void*>(this);
 
+#ifdef CONFIG_AUDIOUTILS_OUTPUTMIX_AUTO_CLKRCV
+  /* Learn target level again for new stream. */
+
+  m_clock_recovery.restart();
+#endif
+
   if (AS_ECODE_OK != AS_postfilter_init(&init,
                                         m_p_postfliter_instance,
                                         &dsp_info))
@@ -409,6 +432,10 @@ void OutputMixToHPI2S::input_data_on_ready(MsgPacket* msg)
       return;
     }
 
+  /* Send postfilter parameter held until DSP is initialized */
+
+  send_postfilter_param();
+
   /* Exec postfilter */
 
   ExecPostfilterParam exec;
@@ -441,6 +468,12 @@ void OutputMixToHPI2S::input_data_on_active(MsgPacket* msg)
   AsPcmDataParam input =
     msg->moveParam<AsPcmDataParam>();
 
+  AUDIO_TRACE(AudioTraceMixIn, m_state.get());
+
+  /* Send postfilter parameter if changed */
+
+  send_postfilter_param();
+
   /* Exec postfilter */
 
   ExecPostfilterParam exec;
@@ -481,6 +514,14 @@ void OutputMixToHPI2S::postdone_on_active(MsgPacket* msg)
   OutputMixObjPostfilterDoneCmd post_done =
     msg->moveParam<OutputMixObjParam>().postfilterdone_param;
 
+  /* Reply of SetParam has no data, just release it */
+
+  if (post_done.event_type == Apu::SetParamEvent)
+    {
+      AS_postfilter_recv_done(m_p_postfliter_instance, NULL);
+      return;
+    }
+
   /* Get postfilter result */
 
   PostfilterCmpltParam cmplt;
@@ -491,6 +532,13 @@ void OutputMixToHPI2S::postdone_on_active(MsgPacket* msg)
 
   if (check_sample(&cmplt.output))
     {
+#ifdef CONFIG_AUDIOUTILS_OUTPUTMIX_AUTO_CLKRCV
+      if (m_adjust_direction == OutputMixAutoAdjust)
+        {
+          auto_clock_recovery(&cmplt.output);
+        }
+#endif
+
       send_renderer(m_render_comp_handler,
                     cmplt.output.mh.getPa(),
                     cmplt.output.size,
@@ -532,6 +580,8 @@ void OutputMixToHPI2S::input_data_on_under(MsgPacket* msg)
   AsPcmDataParam input =
     msg->moveParam<AsPcmDataParam>();
 
+  AUDIO_TRACE(AudioTraceMixIn, m_state.get());
+
   /* If end-data, publish render stop */
 
   if (input.is_end)
@@ -573,6 +623,8 @@ void OutputMixToHPI2S::done_on_active(MsgPacket* msg)
 
   if (param.renderdone_param.error_flag)
     {
+      AUDIO_TRACE(AudioTraceUnderflow, 0);
+
       m_error_callback(m_self_handle);
       m_state = Underflow;
       return;
@@ -651,7 +703,12 @@ void OutputMixToHPI2S::clock_recovery(MsgPacket* msg)
   if (cmd.fterm_param.direction < OutputMixAdvance
    || OutputMixDelay < cmd.fterm_param.direction)
     {
-      return;
+#ifdef CONFIG_AUDIOUTILS_OUTPUTMIX_AUTO_CLKRCV
+      if (cmd.fterm_param.direction != OutputMixAutoAdjust)
+#endif
+        {
+          return;
+        }
     }
 
   /* Set recovery parameters. */
@@ -659,6 +716,16 @@ void OutputMixToHPI2S::clock_recovery(MsgPacket* msg)
   m_adjust_direction = cmd.fterm_param.direction;
   m_adjustment_times = cmd.fterm_param.times;
 
+#ifdef CONFIG_AUDIOUTILS_OUTPUTMIX_AUTO_CLKRCV
+  if (m_adjust_direction == OutputMixAutoAdjust)
+    {
+      /* Times is target level. Whole sample adjustment is not used. */
+
+      m_adjustment_times = 0;
+      m_clock_recovery.reset(cmd.fterm_param.times);
+    }
+#endif
+
   AsOutputMixDoneParam done_param;
 
   done_param.handle    = cmd.handle;
@@ -669,6 +736,101 @@ void OutputMixToHPI2S::clock_recovery(MsgPacket* msg)
   return;
 }
 
+/*--------------------------------------------------------------------------*/
+void OutputMixToHPI2S::set_postfilter_param(MsgPacket* msg)
+{
+  OutputMixerCommand cmd = msg->moveParam<OutputMixerCommand>();
+
+  OUTPUT_MIX_DBG("SET PFPARAM: type %d\n", cmd.pfparam_param.param_type);
+
+  /* Postfilter DSP accepts parameters only after initialization, and
+   * its command queue is shared with data. So parameter is held here
+   * and sent before postfilter exec of next frame. Newer one of the
+   * same kind overwrites the older one which is not sent yet.
+   */
+
+  Wien2::Apu::ApuSetParamPostFilterCmd param;
+  uint32_t slot;
+
+  switch (cmd.pfparam_param.param_type)
+    {
+      case OutputMixPostFilterEnable:
+        param.param_type = Wien2::Apu::PostFilterParamEnable;
+        param.enable     = cmd.pfparam_param.enable;
+        slot             = OUTPUTMIX_PF_SLOT_ENABLE;
+        break;
+
+      case OutputMixPostFilterEq:
+        if (OUTPUTMIX_PF_EQ_BAND_NUM <= cmd.pfparam_param.eq.band)
+          {
+            OUTPUT_MIX_ERR(AS_ATTENTION_SUB_CODE_UNEXPECTED_PARAM);
+            return;
+          }
+
+        param.param_type  = Wien2::Apu::PostFilterParamEq;
+        param.set_eq.band = cmd.pfparam_param.eq.band;
+        memcpy(param.set_eq.coef,
+               cmd.pfparam_param.eq.coef,
+               sizeof(param.set_eq.coef));
+        slot = cmd.pfparam_param.eq.band;
+        break;
+
+      case OutputMixPostFilterLimiter:
+        param.param_type            = Wien2::Apu::PostFilterParamLimiter;
+        param.set_limiter.threshold = cmd.pfparam_param.limiter.threshold;
+        param.set_limiter.lookahead = cmd.pfparam_param.limiter.lookahead;
+        param.set_limiter.release   = cmd.pfparam_param.limiter.release;
+        slot                        = OUTPUTMIX_PF_SLOT_LIMITER;
+        break;
+
+      case OutputMixPostFilterWidth:
+        param.param_type      = Wien2::Apu::PostFilterParamWidth;
+        param.set_width.width = cmd.pfparam_param.width;
+        slot                  = OUTPUTMIX_PF_SLOT_WIDTH;
+        break;
+
+      default:
+        OUTPUT_MIX_ERR(AS_ATTENTION_SUB_CODE_UNEXPECTED_PARAM);
+        return;
+    }
+
+  m_pfparam[slot].param = param;
+  m_pfparam_pending |= (1 << slot);
+
+  AsOutputMixDoneParam done_param;
+
+  done_param.handle    = cmd.handle;
+  done_param.done_type = OutputMixSetPostFilterDone;
+
+  reply(m_requester_dtq, MSG_AUD_MIX_CMD_SETPFPARAM, &done_param);
+
+  return;
+}
+
+/*--------------------------------------------------------------------------*/
+void OutputMixToHPI2S::send_postfilter_param(void)
+{
+  /* Send one parameter per frame not to run out of DSP command buffer.
+   * Reply is released at postfilter done.
+   */
+
+  for (uint32_t slot = 0; slot < OUTPUTMIX_PF_SLOT_NUM; slot++)
+    {
+      if (m_pfparam_pending & (1 << slot))
+        {
+          m_pfparam_pending &= ~(1 << slot);
+
+          if (!AS_postfilter_setparam(&m_pfparam[slot],
+                                      m_p_postfliter_instance))
+            {
+              OUTPUT_MIX_ERR(AS_ATTENTION_SUB_CODE_DSP_EXEC_ERROR);
+            }
+
+          return;
+        }
+    }
+}
+
 /*--------------------------------------------------------------------------*/
 int8_t OutputMixToHPI2S::get_period_adjustment(void)
 {
@@ -712,6 +874,47 @@ int8_t OutputMixToHPI2S::get_period_adjustment(void)
   return adjust_sample;
 }
 
+#ifdef CONFIG_AUDIOUTILS_OUTPUTMIX_AUTO_CLKRCV
+/*--------------------------------------------------------------------------*/
+void OutputMixToHPI2S::auto_clock_recovery(AsPcmDataParam *data)
+{
+  uint32_t byte_size_per_sample = ((data->bit_length == AS_BITLENGTH_16) ?
+                                   BYTE_SIZE_PER_SAMPLE :
+                                   BYTE_SIZE_PER_SAMPLE_HIGHRES);
+
+  /* Fill level is data waiting for I2S (sent to renderer and not
+   * done yet) and data buffered before the player.
+   */
+
+  uint32_t level = m_source_level;
+
+  for (int i = 0; i < m_render_data_queue.size(); i++)
+    {
+      level += m_render_data_queue.at(i).size / byte_size_per_sample;
+    }
+
+  m_clock_recovery.update(level);
+
+  uint32_t samples = m_clock_recovery.exec(data->mh.getPa(),
+                                           data->size / byte_size_per_sample,
+                                           data->mh.getSize() /
+                                             byte_size_per_sample,
+                                           data->bit_length);
+
+  /* Keep DMA minimum size, repeat last sample if short. */
+
+  for (; samples < DMA_MIN_SAMPLE; samples++)
+    {
+      memcpy((char *)data->mh.getPa() + samples * byte_size_per_sample,
+             (char *)data->mh.getPa() + (samples - 1) * byte_size_per_sample,
+             byte_size_per_sample);
+    }
+
+  data->size   = samples * byte_size_per_sample;
+  data->sample = samples;
+}
+#endif
+
 /*--------------------------------------------------------------------------*/
 static void send_renderer(RenderComponentHandler handle,
                           void *p_addr,
@@ -741,6 +944,8 @@ static void send_renderer(RenderComponentHandler handle,
 
   /* Send to renderer. */
 
+  AUDIO_TRACE(AudioTraceRenderReq, is_valid);
+
   if (!AS_exec_renderer(handle,
                         p_addr,
                         byte_size / byte_size_per_sample,
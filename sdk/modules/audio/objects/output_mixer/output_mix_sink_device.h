@@ -53,6 +53,7 @@
 #include "components/postfilter/postfilter_api.h"
 #include "objects/stream_parser/ram_lpcm_data_source.h"
 #include "objects/stream_parser/mp3_stream_mng.h"
+#include "output_mix_clock_recovery.h"
 
 __WIEN2_BEGIN_NAMESPACE
 
@@ -60,6 +61,17 @@ __WIEN2_BEGIN_NAMESPACE
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* Postfilter parameters held until sent to DSP.
+ * One for each EQ stage, limiter, widening and enable. Enable is the
+ * last one so that blocks are enabled after their coefficients are set.
+ */
+
+#define OUTPUTMIX_PF_EQ_BAND_NUM     5
+#define OUTPUTMIX_PF_SLOT_LIMITER    (OUTPUTMIX_PF_EQ_BAND_NUM)
+#define OUTPUTMIX_PF_SLOT_WIDTH      (OUTPUTMIX_PF_EQ_BAND_NUM + 1)
+#define OUTPUTMIX_PF_SLOT_ENABLE     (OUTPUTMIX_PF_EQ_BAND_NUM + 2)
+#define OUTPUTMIX_PF_SLOT_NUM        (OUTPUTMIX_PF_EQ_BAND_NUM + 3)
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -99,7 +111,9 @@ public:
     m_state(AS_MODULE_ID_OUTPUT_MIX_OBJ, "", Booted),
     m_callback(NULL),
     m_adjust_direction(OutputMixNoAdjust),
-    m_adjustment_times(0)
+    m_adjustment_times(0),
+    m_source_level(0),
+    m_pfparam_pending(0)
     {}
 
     MsgQueId m_self_dtq, m_requester_dtq, m_apu_dtq;
@@ -130,6 +144,10 @@ public:
     {
       m_apu_pool_id = poolid;
     }
+  void set_source_level(uint32_t level)
+    {
+      m_source_level = level;
+    }
 
 private:
   enum State
@@ -159,6 +177,19 @@ private:
   int8_t m_adjust_direction;
   int32_t m_adjustment_times;
 
+  /* Level of source buffer notified by application (samples) */
+
+  volatile uint32_t m_source_level;
+
+#ifdef CONFIG_AUDIOUTILS_OUTPUTMIX_AUTO_CLKRCV
+  OutputMixClockRecovery m_clock_recovery;
+#endif
+
+  /* Postfilter parameters not sent yet (bit of slot is set) */
+
+  SetParamPostfilterParam m_pfparam[OUTPUTMIX_PF_SLOT_NUM];
+  uint32_t m_pfparam_pending;
+
   void reply(MsgQueId requester_dtq,
              MsgType msg_type,
              AsOutputMixDoneParam *done_param);
@@ -179,10 +210,17 @@ private:
   void done_on_stopping(MsgPacket *msg);
 
   void clock_recovery(MsgPacket *msg);
+  void set_postfilter_param(MsgPacket *msg);
+
+  void send_postfilter_param(void);
 
   void parseOutputMixRst(MsgPacket *msg);
 
   int8_t get_period_adjustment(void);
+
+#ifdef CONFIG_AUDIOUTILS_OUTPUTMIX_AUTO_CLKRCV
+  void auto_clock_recovery(AsPcmDataParam *data);
+#endif
 };
 
 /****************************************************************************
@@ -35,6 +35,12 @@
 
 #include "sound_effect_object.h"
 
+#ifdef CONFIG_AUDIOUTILS_SOUND_EFFECTOR_LOW_LATENCY
+#include <sched.h>
+#include <syslog.h>
+#include <time.h>
+#endif
+
 #include "memutils/common_utils/common_assert.h"
 #ifdef CONFIG_AUDIOUTILS_VOICE_COMMAND
 #include "objects/sound_recognizer/voice_recognition_command_object.h"
@@ -89,6 +95,25 @@ SoundEffectObject* s_effec_obj = NULL;
 /* TODO: Why not use macro created by memory library? */
 #define MAX_MFE_OUT_PCM_BUF_SIZE (MFE_OUT_SAMPLE_NUM * MFE_OUT_BYTE_LEN)
 
+#ifdef CONFIG_AUDIOUTILS_SOUND_EFFECTOR_LOW_LATENCY
+/* Time length of one captured frame (usec). Capture is 48kHz. */
+
+#define LOW_LATENCY_FRAME_USEC (MAX_CAPTURE_SAMPLE_NUM * 1000000 / 48000)
+
+static uint8_t s_ll_i2s_out_buf[LOW_LATENCY_BUF_NUM * MAX_I2S_OUT_PCM_BUF_SIZE]
+  __attribute__((aligned(4)));
+static uint8_t s_ll_hp_out_buf[LOW_LATENCY_BUF_NUM * MAX_HP_OUT_PCM_BUF_SIZE]
+  __attribute__((aligned(4)));
+
+static uint64_t get_time_us(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000 +
+         (uint64_t)now.tv_nsec / 1000;
+}
+#endif
+
 /*--------------------------------------------------------------------*/
 int AS_SoundEffectObjEntry(int argc, char *argv[])
 {
@@ -173,6 +198,15 @@ extern "C" {
 /*--------------------------------------------------------------------*/
 static void capture_done_callback(CaptureDataParam param)
 {
+#ifdef CONFIG_AUDIOUTILS_SOUND_EFFECTOR_LOW_LATENCY
+  /* Process here if fast path is active, otherwise go to object. */
+
+  if ((s_effec_obj != NULL) && s_effec_obj->inputLowLatency(param))
+    {
+      return;
+    }
+#endif
+
   err_t er = MsgLib::send<CaptureDataParam>(s_self_dtq,
                                             MsgPriNormal,
                                             MSG_AUD_SEF_CMD_INPUT,
@@ -855,6 +889,27 @@ void SoundEffectObject::startOnReady(MsgPacket *msg)
         }
     }
 
+#ifdef CONFIG_AUDIOUTILS_SOUND_EFFECTOR_LOW_LATENCY
+  /* Without filter, captured data is sent to renderer directly
+   * from capture done notification. Enable it before the first
+   * capture request so that all frames take the same path.
+   */
+
+  m_low_latency = (m_filter_mode == FILTER_MODE_THROUGH);
+
+  if (m_low_latency)
+    {
+      initLowLatencyOut(m_i2s_ll_out,
+                        s_ll_i2s_out_buf,
+                        MAX_I2S_OUT_PCM_BUF_SIZE);
+      initLowLatencyOut(m_hp_ll_out,
+                        s_ll_hp_out_buf,
+                        MAX_HP_OUT_PCM_BUF_SIZE);
+    }
+
+  m_fast_path = m_low_latency;
+#endif
+
   /* Multiple capture commands are issued to I2S-in and Mic-in respectively */
 
   for (int i = 0; i < CAPTURE_DELAY_STAGE_NUM; i++)
@@ -866,6 +921,9 @@ void SoundEffectObject::startOnReady(MsgPacket *msg)
 
       if (!AS_exec_capture(&cap_comp_param))
         {
+#ifdef CONFIG_AUDIOUTILS_SOUND_EFFECTOR_LOW_LATENCY
+          m_fast_path = false;
+#endif
           sendAudioCmdCmplt(cmd, AS_ECODE_DMAC_READ_ERROR);
           return;
         }
@@ -875,6 +933,9 @@ void SoundEffectObject::startOnReady(MsgPacket *msg)
 
       if (!AS_exec_capture(&cap_comp_param))
         {
+#ifdef CONFIG_AUDIOUTILS_SOUND_EFFECTOR_LOW_LATENCY
+          m_fast_path = false;
+#endif
           sendAudioCmdCmplt(cmd, AS_ECODE_DMAC_READ_ERROR);
           return;
         }
@@ -905,6 +966,16 @@ void SoundEffectObject::stopOnActive(MsgPacket* msg)
       return;
     }
 
+#ifdef CONFIG_AUDIOUTILS_SOUND_EFFECTOR_LOW_LATENCY
+  /* Remaining frames are handled by stop sequence of this object.
+   * Lock to wait for the frame being processed in fast path.
+   */
+
+  sched_lock();
+  m_fast_path = false;
+  sched_unlock();
+#endif
+
   m_state = SoundFXStoppingState;
 }
 
@@ -980,6 +1051,11 @@ void SoundEffectObject::input(CaptureDataParam& param)
           render_param.exec_mfe_param.output_buffer.p_buffer =
             reinterpret_cast<unsigned long*>(allocI2SOutBuf());
 
+          if (render_param.exec_mfe_param.output_buffer.p_buffer == NULL)
+            {
+              return;
+            }
+
           render_param.exec_mfe_param.output_buffer.size =
             param.buf.sample * m_i2s_out_ch_num * AC_IN_BYTE_LEN;
 
@@ -1037,6 +1113,11 @@ void SoundEffectObject::input(CaptureDataParam& param)
           render_param.exec_xloud_param.output_buffer.p_buffer =
             reinterpret_cast<unsigned long*>(allocHpOutBuf());
 
+          if (render_param.exec_xloud_param.output_buffer.p_buffer == NULL)
+            {
+              return;
+            }
+
           render_param.exec_xloud_param.output_buffer.size =
             param.buf.sample * MAX_I2S_IN_CH_NUM * I2S_IN_BYTE_LEN;
 
@@ -1091,33 +1172,124 @@ void SoundEffectObject::inputOnActive(MsgPacket *msg)
 
   /* Set next command. */
 
-  if (CaptureDeviceAnalogMic == param.output_device)
+  execCapture(param.output_device);
+}
+
+/*--------------------------------------------------------------------*/
+void SoundEffectObject::execCapture(CaptureDevice device)
+{
+  CaptureComponentParam cap_comp_param;
+
+  if (CaptureDeviceAnalogMic == device)
+    {
+      cap_comp_param.handle = m_capture_from_mic_hdlr;
+    }
+  else if (CaptureDeviceI2S == device)
+    {
+      cap_comp_param.handle = m_capture_from_i2s_hdlr;
+    }
+  else
     {
-      /* set next command */
+      SOUNDFX_ERR(AS_ATTENTION_SUB_CODE_UNEXPECTED_PARAM);
+      return;
+    }
 
-      CaptureComponentParam cap_comp_param;
+  cap_comp_param.exec_param.pcm_sample = MAX_CAPTURE_SAMPLE_NUM;
 
-      cap_comp_param.handle                = m_capture_from_mic_hdlr;
-      cap_comp_param.exec_param.pcm_sample = MAX_CAPTURE_SAMPLE_NUM;
+  AS_exec_capture(&cap_comp_param);
+}
 
-      AS_exec_capture(&cap_comp_param);
-    }
-  else if (CaptureDeviceI2S == param.output_device)
+#ifdef CONFIG_AUDIOUTILS_SOUND_EFFECTOR_LOW_LATENCY
+/*--------------------------------------------------------------------*/
+bool SoundEffectObject::inputLowLatency(CaptureDataParam& param)
+{
+  /* This is called in context of capture component.
+   * Scheduler is locked so that stop request is not handled
+   * in the middle of a frame.
+   */
+
+  bool done = false;
+
+  sched_lock();
+
+  if (m_fast_path)
     {
-      /* set next command */
+      input(param);
+      execCapture(param.output_device);
+      done = true;
+    }
 
-      CaptureComponentParam cap_comp_param;
+  sched_unlock();
 
-      cap_comp_param.handle                = m_capture_from_i2s_hdlr;
-      cap_comp_param.exec_param.pcm_sample = MAX_CAPTURE_SAMPLE_NUM;
+  return done;
+}
 
-      AS_exec_capture(&cap_comp_param);
+/*--------------------------------------------------------------------*/
+void SoundEffectObject::initLowLatencyOut(LowLatencyOut& out,
+                                          uint8_t *base,
+                                          uint32_t size)
+{
+  out.base    = base;
+  out.size    = size;
+  out.wp      = 0;
+  out.rp      = 0;
+  out.lat_min = UINT32_MAX;
+  out.lat_max = 0;
+  out.lat_sum = 0;
+  out.lat_cnt = 0;
+}
+
+/*--------------------------------------------------------------------*/
+void* SoundEffectObject::allocLowLatencyOut(LowLatencyOut& out)
+{
+  uint8_t next = (out.wp + 1) % LOW_LATENCY_BUF_NUM;
+
+  if (next == out.rp)
+    {
+      SOUNDFX_WARN(AS_ATTENTION_SUB_CODE_MEMHANDLE_ALLOC_ERROR);
+      return NULL;
     }
-  else
+
+  uint8_t *buf = out.base + out.size * out.wp;
+
+  out.cap_time[out.wp] = get_time_us();
+  out.wp = next;
+
+  return buf;
+}
+
+/*--------------------------------------------------------------------*/
+bool SoundEffectObject::freeLowLatencyOut(LowLatencyOut& out)
+{
+  if (isLowLatencyOutEmpty(out))
     {
-      SOUNDFX_ERR(AS_ATTENTION_SUB_CODE_UNEXPECTED_PARAM);
+      SOUNDFX_ERR(AS_ATTENTION_SUB_CODE_MEMHANDLE_FREE_ERROR);
+      return false;
     }
+
+  /* Render done is notified at the end of the frame,
+   * so the frame started one frame time before.
+   */
+
+  uint64_t elapsed = get_time_us() - out.cap_time[out.rp];
+  uint32_t latency = (elapsed > LOW_LATENCY_FRAME_USEC) ?
+                       (uint32_t)(elapsed - LOW_LATENCY_FRAME_USEC) : 0;
+
+  out.lat_min  = (latency < out.lat_min) ? latency : out.lat_min;
+  out.lat_max  = (latency > out.lat_max) ? latency : out.lat_max;
+  out.lat_sum += latency;
+  out.lat_cnt++;
+
+#ifdef CONFIG_AUDIOUTILS_SOUND_EFFECTOR_LATENCY_LOG
+  syslog(LOG_DEBUG, "SEF %s latency %d us\n",
+         (&out == &m_i2s_ll_out) ? "I2S" : "HP", latency);
+#endif
+
+  out.rp = (out.rp + 1) % LOW_LATENCY_BUF_NUM;
+
+  return true;
 }
+#endif /* CONFIG_AUDIOUTILS_SOUND_EFFECTOR_LOW_LATENCY */
 
 /*--------------------------------------------------------------------*/
 void SoundEffectObject::inputOnStopping(MsgPacket *msg)
@@ -1272,7 +1444,7 @@ void SoundEffectObject::dmaOutDoneCmpltOnStopping(MsgPacket *msg)
 
   /* TODO: It's better to check with end-flag(component). */
 
-  if (m_i2s_out_buf_mh_que.empty() && m_hp_out_buf_mh_que.empty())
+  if (isOutBufEmpty())
     {
       if (m_external_cmd_que.empty())
         {
@@ -1287,6 +1459,24 @@ void SoundEffectObject::dmaOutDoneCmpltOnStopping(MsgPacket *msg)
           SOUNDFX_ERR(AS_ATTENTION_SUB_CODE_QUEUE_POP_ERROR);
         }
 
+#ifdef CONFIG_AUDIOUTILS_SOUND_EFFECTOR_LOW_LATENCY
+      if (m_low_latency)
+        {
+          SOUNDFX_DBG("LATENCY: i2s %d/%d/%d hp %d/%d/%d us "
+                      "(min/avg/max)\n",
+                      m_i2s_ll_out.lat_min,
+                      (m_i2s_ll_out.lat_cnt == 0) ? 0 :
+                        (uint32_t)(m_i2s_ll_out.lat_sum /
+                                   m_i2s_ll_out.lat_cnt),
+                      m_i2s_ll_out.lat_max,
+                      m_hp_ll_out.lat_min,
+                      (m_hp_ll_out.lat_cnt == 0) ? 0 :
+                        (uint32_t)(m_hp_ll_out.lat_sum /
+                                   m_hp_ll_out.lat_cnt),
+                      m_hp_ll_out.lat_max);
+        }
+#endif
+
       m_state = SoundFXReadyState;
       sendAudioCmdCmplt(ext_cmd, AS_ECODE_OK);
     }
@@ -1638,6 +1828,13 @@ void SoundEffectObject::execMpp(MemMgrLite::MemHandle mh,
 /*--------------------------------------------------------------------*/
 void* SoundEffectObject::allocHpOutBuf()
 {
+#ifdef CONFIG_AUDIOUTILS_SOUND_EFFECTOR_LOW_LATENCY
+  if (m_low_latency)
+    {
+      return allocLowLatencyOut(m_hp_ll_out);
+    }
+#endif
+
   MemMgrLite::MemHandle mh;
 
   if (mh.allocSeg(s_hp_out_pool_id, MAX_HP_OUT_PCM_BUF_SIZE) != ERR_OK)
@@ -1664,6 +1861,13 @@ void* SoundEffectObject::allocHpOutBuf()
 /*--------------------------------------------------------------------*/
 void* SoundEffectObject::allocI2SOutBuf()
 {
+#ifdef CONFIG_AUDIOUTILS_SOUND_EFFECTOR_LOW_LATENCY
+  if (m_low_latency)
+    {
+      return allocLowLatencyOut(m_i2s_ll_out);
+    }
+#endif
+
   MemMgrLite::MemHandle mh;
 
   if (mh.allocSeg(s_i2s_out_pool_id, MAX_I2S_OUT_PCM_BUF_SIZE) != ERR_OK)
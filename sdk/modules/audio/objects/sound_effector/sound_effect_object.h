@@ -66,6 +66,14 @@ __WIEN2_BEGIN_NAMESPACE
 #define FILTER_MODE_MFE     (0x01)
 #define FILTER_MODE_MPPEAX  (0x02)
 
+#ifdef CONFIG_AUDIOUTILS_SOUND_EFFECTOR_LOW_LATENCY
+/* Number of pre-allocated output buffers for each output device.
+ * One of them is always unused to tell full from empty.
+ */
+
+#define LOW_LATENCY_BUF_NUM (CAPTURE_DELAY_STAGE_NUM + 2)
+#endif
+
 class SoundEffectObject
 {
 public:
@@ -73,6 +81,10 @@ public:
                      MsgQueId manager_dtq,
                      MsgQueId voice_recognition_dtq);
 
+#ifdef CONFIG_AUDIOUTILS_SOUND_EFFECTOR_LOW_LATENCY
+  bool inputLowLatency(CaptureDataParam& param);
+#endif
+
 private:
   SoundEffectObject(MsgQueId self_dtq,
                     MsgQueId manager_dtq,
@@ -89,7 +101,12 @@ private:
     , m_select_output_mic(AS_SELECT_MIC1_OR_MIC2)
     , m_mic_in_sync_cnt(0)
     , m_i2s_in_sync_cnt(0)
-    , m_capt_sync_wait_flg(true){}
+    , m_capt_sync_wait_flg(true)
+#ifdef CONFIG_AUDIOUTILS_SOUND_EFFECTOR_LOW_LATENCY
+    , m_low_latency(false)
+    , m_fast_path(false)
+#endif
+  {}
 
   enum SoundEffectState
   {
@@ -151,6 +168,48 @@ private:
 
   s_std::Queue<AudioCommand, 1> m_external_cmd_que;
 
+#ifdef CONFIG_AUDIOUTILS_SOUND_EFFECTOR_LOW_LATENCY
+  /* Output buffers of low latency path. They are filled on capture
+   * side and released by render done in the same order, so write and
+   * read positions are updated by one side each.
+   */
+
+  struct LowLatencyOut
+  {
+    uint8_t          *base;
+    uint32_t         size;
+    uint64_t         cap_time[LOW_LATENCY_BUF_NUM];
+    volatile uint8_t wp;
+    volatile uint8_t rp;
+
+    /* Latency from capture done to render start (usec) */
+
+    uint32_t         lat_min;
+    uint32_t         lat_max;
+    uint64_t         lat_sum;
+    uint32_t         lat_cnt;
+  };
+
+  /* m_low_latency is set at start when no filter is used, then output
+   * buffers are taken from LowLatencyOut instead of memory pool.
+   * m_fast_path is set while captured data is processed in capture
+   * done notification.
+   */
+
+  bool          m_low_latency;
+  volatile bool m_fast_path;
+  LowLatencyOut m_i2s_ll_out;
+  LowLatencyOut m_hp_ll_out;
+
+  void  initLowLatencyOut(LowLatencyOut& out, uint8_t *base, uint32_t size);
+  void* allocLowLatencyOut(LowLatencyOut& out);
+  bool  freeLowLatencyOut(LowLatencyOut& out);
+  bool  isLowLatencyOutEmpty(const LowLatencyOut& out)
+  {
+    return (out.wp == out.rp);
+  }
+#endif
+
   RenderComponentHandler m_i2s_render_comp_handler, m_hp_render_comp_handler;
   CaptureComponentHandler m_capture_from_mic_hdlr, m_capture_from_i2s_hdlr;
 
@@ -177,6 +236,7 @@ private:
   void filterDoneCmplt(MsgPacket* msg);
 
   void input(CaptureDataParam& param);
+  void execCapture(CaptureDevice device);
 
   uint32_t initMfe(const AudioCommand& cmd);
   uint32_t initMpp(const AudioCommand& cmd);
@@ -212,6 +272,12 @@ private:
 
   bool freeHpOutBuf()
   {
+#ifdef CONFIG_AUDIOUTILS_SOUND_EFFECTOR_LOW_LATENCY
+    if (m_low_latency)
+      {
+        return freeLowLatencyOut(m_hp_ll_out);
+      }
+#endif
     if (!m_hp_out_buf_mh_que.pop())
       {
         SOUNDFX_ERR(AS_ATTENTION_SUB_CODE_MEMHANDLE_FREE_ERROR);
@@ -222,6 +288,12 @@ private:
 
   bool freeI2SOutBuf()
   {
+#ifdef CONFIG_AUDIOUTILS_SOUND_EFFECTOR_LOW_LATENCY
+    if (m_low_latency)
+      {
+        return freeLowLatencyOut(m_i2s_ll_out);
+      }
+#endif
     if (!m_i2s_out_buf_mh_que.pop())
       {
         SOUNDFX_ERR(AS_ATTENTION_SUB_CODE_MEMHANDLE_FREE_ERROR);
@@ -242,6 +314,18 @@ private:
 
   void freeOutBuf(cxd56_audio_dma_t dmac_select_id);
 
+  bool isOutBufEmpty()
+  {
+#ifdef CONFIG_AUDIOUTILS_SOUND_EFFECTOR_LOW_LATENCY
+    if (m_low_latency)
+      {
+        return isLowLatencyOutEmpty(m_i2s_ll_out)
+            && isLowLatencyOutEmpty(m_hp_ll_out);
+      }
+#endif
+    return m_i2s_out_buf_mh_que.empty() && m_hp_out_buf_mh_que.empty();
+  }
+
   void sendAudioCmdCmplt(const AudioCommand& cmd,
                          uint32_t result,
                          uint32_t sub_result = 0)
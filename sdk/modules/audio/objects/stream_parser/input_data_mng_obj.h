@@ -64,6 +64,19 @@ public:
 };
 typedef struct init_input_data_mng_param_s InitInputDataManagerParam;
 
+#ifdef CONFIG_AUDIOUTILS_PLAYER_GAPLESS
+/* Position of valid samples in the stream (in samples of input rate). */
+
+struct gapless_info_s
+{
+  bool     trim;     /* Delay and length are known (LAME tag) */
+  uint32_t delay;    /* Samples to be trimmed at the top */
+  uint32_t length;   /* Valid samples after delay (0: unknown) */
+  uint32_t samples;  /* Samples of all ES given out by getEs() so far */
+};
+typedef struct gapless_info_s GaplessInfo;
+#endif
+
 class InputDataManagerObject
 {
 public:
@@ -85,6 +98,12 @@ public:
   virtual GetEsResult getEs(FAR void *es_buff, FAR uint32_t *es_size) = 0;
   virtual bool getSamplingRate(FAR uint32_t *sampling_rate) = 0;
   virtual bool getChNum(FAR uint32_t *p_ch_num) = 0;
+#ifdef CONFIG_AUDIOUTILS_PLAYER_GAPLESS
+  virtual bool getGaplessInfo(FAR GaplessInfo *p_info)
+    {
+      return false;
+    }
+#endif
 
   bool checkSimpleFifoHandler(const InitInputDataManagerParam &param)
     {
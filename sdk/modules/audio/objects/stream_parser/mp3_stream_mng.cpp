@@ -82,6 +82,9 @@ bool Mp3StreamMng::init(const InitInputDataManagerParam &param)
       if (result == MP3PARSER_SUCCESS)
         {
           m_done_open = true;
+#ifdef CONFIG_AUDIOUTILS_PLAYER_GAPLESS
+          m_info_frames = 0;
+#endif
           return true;
         }
     }
@@ -102,6 +105,9 @@ InputDataManagerObject::GetEsResult
         }
 
       uint32_t max_buf_size = *es_size;
+#ifdef CONFIG_AUDIOUTILS_PLAYER_GAPLESS
+      uint32_t frame_count = m_handle.seek.frame_count;
+#endif
       if (MP3PARSER_SUCCESS ==
             Mp3Parser_pollSingleFrame((FAR MP3PARSER_Handle *)&m_handle,
                                       (FAR uint8_t *)es_buf,
@@ -110,6 +116,40 @@ InputDataManagerObject::GetEsResult
         {
           ret = EsExist;
         }
+
+#ifdef CONFIG_AUDIOUTILS_PLAYER_GAPLESS
+      /* Xing/Info frame is not counted as audio. It decodes to
+       * silence which is not in the encoder delay, so drop it if the
+       * stream is trimmed by the encoder delay of its LAME tag.
+       * Otherwise it is decoded as before.
+       */
+
+      uint32_t delay;
+      uint32_t padding;
+
+      if ((ret == EsExist) && (frame_count == m_handle.seek.frame_count))
+        {
+          if (MP3PARSER_SUCCESS !=
+                Mp3Parser_getEncoderDelay((FAR MP3PARSER_Handle *)&m_handle,
+                                          &delay, &padding))
+            {
+              m_info_frames++;
+              return ret;
+            }
+
+          *es_size = max_buf_size;
+          ret = EsEnd;
+          if (getOccupiedSize(&size) &&
+              (MP3PARSER_SUCCESS ==
+                 Mp3Parser_pollSingleFrame((FAR MP3PARSER_Handle *)&m_handle,
+                                           (FAR uint8_t *)es_buf,
+                                           max_buf_size, es_size,
+                                           &ready_to_extract_frames)))
+            {
+              ret = EsExist;
+            }
+        }
+#endif
     }
   return ret;
 }
@@ -159,6 +199,41 @@ bool Mp3StreamMng::getBitPerSample(FAR uint32_t *p_bit_per_sample)
   return false;
 }
 
+#ifdef CONFIG_AUDIOUTILS_PLAYER_GAPLESS
+bool Mp3StreamMng::getGaplessInfo(FAR GaplessInfo *p_info)
+{
+  if (!m_done_open || (m_handle.seek.sampling_rate == 0))
+    {
+      return false;
+    }
+
+  uint32_t spf = m_handle.seek.samples_per_frame;
+  uint32_t delay = 0;
+  uint32_t padding = 0;
+
+  p_info->trim    = false;
+  p_info->delay   = 0;
+  p_info->length  = 0;
+  p_info->samples = (m_handle.seek.frame_count + m_info_frames) * spf;
+
+  if (MP3PARSER_SUCCESS ==
+        Mp3Parser_getEncoderDelay((FAR MP3PARSER_Handle *)&m_handle,
+                                  &delay, &padding))
+    {
+      uint32_t total = m_handle.seek.total_frames * spf;
+
+      p_info->trim  = true;
+      p_info->delay = delay;
+      if (total > delay + padding)
+        {
+          p_info->length = total - delay - padding;
+        }
+    }
+
+  return true;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
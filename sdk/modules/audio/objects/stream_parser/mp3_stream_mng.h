@@ -68,12 +68,18 @@ public:
   virtual bool getSamplingRate(FAR uint32_t *p_sampling_rate);
   virtual bool getChNum(FAR uint32_t *p_ch_num);
   virtual bool getBitPerSample(FAR uint32_t *p_bit_per_sample);
+#ifdef CONFIG_AUDIOUTILS_PLAYER_GAPLESS
+  virtual bool getGaplessInfo(FAR GaplessInfo *p_info);
+#endif
 
 private:
   MP3PARSER_Handle m_handle;
   MP3PARSER_Config m_config;
 
   bool    m_done_open;
+#ifdef CONFIG_AUDIOUTILS_PLAYER_GAPLESS
+  uint32_t m_info_frames;  /* Xing/Info frames given out as audio */
+#endif
 };
 
 /****************************************************************************
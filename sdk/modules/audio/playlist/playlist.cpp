@@ -44,6 +44,26 @@
 
 #include "playlist.h"
 
+#ifdef CONFIG_AUDIOUTILS_PLAYLIST_TRACK_INDEX
+static const char TrackIndexFileName[] = "track_index.bin";
+
+/*--------------------------------------------------------------------------*/
+static uint32_t hashTrackKey(FAR const char *key_str)
+{
+  /* FNV-1a of the part compared by isTargetTrack(). */
+
+  uint32_t hash = 0x811c9dc5;
+  size_t   len  = strnlen(key_str, sizeof(Track::author));
+
+  for (size_t i = 0; i < len; i++)
+    {
+      hash = (hash ^ static_cast<uint8_t>(key_str[i])) * 0x01000193;
+    }
+
+  return hash;
+}
+#endif
+
 /*--------------------------------------------------------------------------*/
 bool Playlist::init(const char *playlist_path)
 {
@@ -55,6 +75,15 @@ bool Playlist::init(const char *playlist_path)
 
   this->open("r");
 
+#ifdef CONFIG_AUDIOUTILS_PLAYLIST_TRACK_INDEX
+  /* Open track index, or compile it if it is missing or old. */
+
+  if (!this->openTrackIndex())
+    {
+      this->buildTrackIndex();
+    }
+#endif
+
   /* Create alias list. */
 
   this->updatePlaylist(ListTypeAllTrack, "");
@@ -90,6 +119,10 @@ bool Playlist::open(FAR const char *mode)
 /*--------------------------------------------------------------------------*/
 bool Playlist::close(void)
 {
+#ifdef CONFIG_AUDIOUTILS_PLAYLIST_TRACK_INDEX
+  this->closeTrackIndex();
+#endif
+
   if (this->m_track_db_fp != NULL)
   {
     if (fclose(this->m_track_db_fp) != 0)
@@ -187,6 +220,24 @@ bool Playlist::getNextTrack(FAR Track *track)
 
   this->m_play_idx++;
 
+#ifdef CONFIG_AUDIOUTILS_PLAYLIST_TRACK_INDEX
+  if (this->m_track_index_fp != NULL)
+    {
+      /* Get parsed track info from track index. */
+
+      TrackIndexRecord record;
+      if (!this->searchTrackIndex(this->m_alias_list.at(this->m_play_idx),
+                                  &record))
+        {
+          this->m_play_idx--;
+          return false;
+        }
+
+      *track = record.track;
+      return (record.is_valid != 0);
+    }
+#endif
+
   /* Move a file pointer of track database to the head of next track. */
 
   int seek_rst = fseek(this->m_track_db_fp,
@@ -248,6 +299,24 @@ bool Playlist::getPrevTrack(Track *track)
 
   this->m_play_idx--;
 
+#ifdef CONFIG_AUDIOUTILS_PLAYLIST_TRACK_INDEX
+  if (this->m_track_index_fp != NULL)
+    {
+      /* Get parsed track info from track index. */
+
+      TrackIndexRecord record;
+      if (!this->searchTrackIndex(this->m_alias_list.at(this->m_play_idx),
+                                  &record))
+        {
+          this->m_play_idx++;
+          return false;
+        }
+
+      *track = record.track;
+      return (record.is_valid != 0);
+    }
+#endif
+
   /* Move a file pointer of track database to the head of next track. */
 
   int seek_rst = fseek(this->m_track_db_fp,
@@ -310,6 +379,48 @@ bool Playlist::updatePlaylist(ListType type, FAR const char *key_str)
       return false;
     }
 
+#ifdef CONFIG_AUDIOUTILS_PLAYLIST_TRACK_INDEX
+  if (this->updatePlaylistByKey(type, key_str, list_fp))
+    {
+      fclose(list_fp);
+
+      return true;
+    }
+
+  if (this->m_track_index_fp != NULL)
+    {
+      /* Check parsed track info in track index instead of
+       * reading track database line by line.
+       */
+
+      clearerr(this->m_track_index_fp);
+      fseek(this->m_track_index_fp, sizeof(TrackIndexHeader), SEEK_SET);
+
+      for (uint32_t i = 0; i < this->m_track_num; i++)
+        {
+          TrackIndexRecord record;
+          if (fread(&record, sizeof(record), 1, this->m_track_index_fp) != 1)
+            {
+              break;
+            }
+
+          if (this->isTargetTrack(type, key_str, &record.track))
+            {
+              fpos_t fp_offset = record.db_offset;
+              size_t wsize = fwrite(&fp_offset, sizeof(fp_offset), 1, list_fp);
+              if (wsize != 1)
+                {
+                  printf("File write error. [%d]\n", wsize);
+                }
+            }
+        }
+
+      fclose(list_fp);
+
+      return true;
+    }
+#endif
+
   /* Move file pointer to top of file. */
 
   if (fseek(this->m_track_db_fp, 0, SEEK_SET) != 0)
@@ -494,7 +605,9 @@ bool Playlist::removeTrack(FAR const char *key_str, uint32_t remove_pos)
 /*--------------------------------------------------------------------------*/
 bool Playlist::updateTrackDb(const char *audiofile_root_path)
 {
-  /* Reopen track database with write mode. */
+  /* Reopen track database with write mode.
+   * (Track index is closed together, as it gets old)
+   */
 
   this->close();
   this->open("w");
@@ -575,6 +688,12 @@ bool Playlist::updateTrackDb(const char *audiofile_root_path)
 
   this->deleteAll();
 
+#ifdef CONFIG_AUDIOUTILS_PLAYLIST_TRACK_INDEX
+  /* Compile track index from new track database. */
+
+  this->buildTrackIndex();
+#endif
+
   /* Update playlist(type All). */
 
   this->updatePlaylist(ListTypeAllTrack, "");
@@ -612,6 +731,18 @@ bool Playlist::deleteAll(void)
           int ret = strncmp(dir_ent->d_name,
                             this->m_track_db_file_name,
                             strlen(this->m_track_db_file_name));
+#ifdef CONFIG_AUDIOUTILS_PLAYLIST_TRACK_INDEX
+          /* Track index is also kept. It is checked against
+           * track database when opened.
+           */
+
+          if (ret != 0)
+            {
+              ret = strncmp(dir_ent->d_name,
+                            TrackIndexFileName,
+                            sizeof(TrackIndexFileName));
+            }
+#endif
           if (ret != 0)
             {
               if (unlink(dir_ent->d_name) != 0)
@@ -1033,3 +1164,518 @@ bool Playlist::getFileName(ListType       type,
 
   return true;
 }
+
+#ifdef CONFIG_AUDIOUTILS_PLAYLIST_TRACK_INDEX
+/*--------------------------------------------------------------------------*/
+bool Playlist::buildTrackIndex(void)
+{
+  if (this->m_track_db_fp == NULL)
+    {
+      _err("file not opened.\n");
+      return false;
+    }
+
+  this->closeTrackIndex();
+
+  char file_name[FileNameMaxLength];
+  this->getTrackIndexFileName(file_name, sizeof(file_name));
+  FAR FILE *index_fp = fopen(file_name, "w+");
+  if (index_fp == NULL)
+    {
+      printf("%s cannot opened.\n", file_name);
+      return false;
+    }
+
+  /* Header is written again when the number of records is fixed. */
+
+  TrackIndexHeader header;
+  memset(&header, 0, sizeof(header));
+  header.magic       = TrackIndexMagic;
+  header.version     = TrackIndexVersion;
+  header.record_size = sizeof(TrackIndexRecord);
+  this->getTrackDbStat(&header.db_size, &header.db_mtime);
+  this->getTrackDbChecksum(&header.db_checksum);
+
+  bool ret = (fwrite(&header, sizeof(header), 1, index_fp) == 1);
+
+  /* Parse all lines of track database, and write them as records. */
+
+  clearerr(this->m_track_db_fp);
+  fseek(this->m_track_db_fp, 0, SEEK_SET);
+
+  while (ret)
+    {
+      fpos_t fp_offset = 0;
+      fgetpos(this->m_track_db_fp, &fp_offset);
+
+      char line[LineMaxLength] =
+        {
+          '\0'
+        };
+      if (this->readLine(line, sizeof(line)) != true)
+        {
+          break;
+        }
+
+      TrackIndexRecord record;
+      record.db_offset = static_cast<uint32_t>(fp_offset);
+      record.is_valid  = this->parseTrackInfo(&record.track,
+                                              line,
+                                              sizeof(line));
+
+      if (fwrite(&record, sizeof(record), 1, index_fp) != 1)
+        {
+          printf("File write error. %s\n", file_name);
+          ret = false;
+          break;
+        }
+
+      header.track_num++;
+    }
+
+  fseek(this->m_track_db_fp, 0, SEEK_SET);
+
+  /* Key sections are optional. Without them, lists of an artist or
+   * an album are made by reading all records.
+   */
+
+  if (ret && this->writeTrackIndexKey(index_fp, header.track_num))
+    {
+      header.key_num = header.track_num;
+    }
+
+  if (ret)
+    {
+      fseek(index_fp, 0, SEEK_SET);
+      ret = (fwrite(&header, sizeof(header), 1, index_fp) == 1);
+    }
+
+  fclose(index_fp);
+
+  if (!ret)
+    {
+      unlink(file_name);
+      return false;
+    }
+
+  _info("Track index is built. [%d tracks]\n", header.track_num);
+
+  return this->openTrackIndex();
+}
+
+/*--------------------------------------------------------------------------*/
+bool Playlist::openTrackIndex(void)
+{
+  char file_name[FileNameMaxLength];
+  this->getTrackIndexFileName(file_name, sizeof(file_name));
+  FAR FILE *index_fp = fopen(file_name, "r");
+  if (index_fp == NULL)
+    {
+      return false;
+    }
+
+  /* Use track index only when it is built from current track database.
+   * Size and mtime are checked first, and then the contents, since
+   * the database may be rewritten within the resolution of mtime.
+   */
+
+  uint32_t db_size     = 0;
+  uint32_t db_mtime    = 0;
+  uint32_t db_checksum = 0;
+  this->getTrackDbStat(&db_size, &db_mtime);
+
+  TrackIndexHeader header;
+  if ((fread(&header, sizeof(header), 1, index_fp) != 1) ||
+      (header.magic != TrackIndexMagic) ||
+      (header.version != TrackIndexVersion) ||
+      (header.record_size != sizeof(TrackIndexRecord)) ||
+      (header.db_size != db_size) ||
+      (header.db_mtime != db_mtime) ||
+      !this->getTrackDbChecksum(&db_checksum) ||
+      (header.db_checksum != db_checksum))
+    {
+      _info("Track index is old.\n");
+      fclose(index_fp);
+      return false;
+    }
+
+  this->m_track_index_fp = index_fp;
+  this->m_track_num = header.track_num;
+  this->m_track_db_size = header.db_size;
+  this->m_track_key_num = header.key_num;
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool Playlist::closeTrackIndex(void)
+{
+  if (this->m_track_index_fp != NULL)
+    {
+      FAR FILE *index_fp = this->m_track_index_fp;
+
+      this->m_track_index_fp = NULL;
+      this->m_track_num = 0;
+      this->m_track_db_size = 0;
+      this->m_track_key_num = 0;
+
+      if (fclose(index_fp) != 0)
+        {
+          return false;
+        }
+    }
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool Playlist::readTrackIndex(uint32_t record_no,
+                              FAR TrackIndexRecord *record)
+{
+  if (record_no >= this->m_track_num)
+    {
+      return false;
+    }
+
+  clearerr(this->m_track_index_fp);
+
+  long pos = sizeof(TrackIndexHeader) + record_no * sizeof(TrackIndexRecord);
+  if (fseek(this->m_track_index_fp, pos, SEEK_SET) != 0)
+    {
+      return false;
+    }
+
+  return (fread(record, sizeof(*record), 1, this->m_track_index_fp) == 1);
+}
+
+/*--------------------------------------------------------------------------*/
+bool Playlist::searchTrackIndex(uint32_t db_offset,
+                                FAR TrackIndexRecord *record)
+{
+  /* Records are in the order of db_offset, and lines of track database
+   * have similar length. So the position of the record is estimated
+   * from db_offset, and it usually hits at the first read.
+   * Estimation and bisection are used in turn not to be slower than
+   * binary search in the worst case.
+   */
+
+  uint32_t low         = 0;
+  uint32_t high        = this->m_track_num;
+  uint32_t low_offset  = 0;
+  uint32_t high_offset = this->m_track_db_size;
+  bool     estimate    = true;
+
+  while ((low < high) &&
+         (low_offset <= db_offset) && (db_offset < high_offset))
+    {
+      uint32_t mid;
+
+      if (estimate)
+        {
+          mid = low + static_cast<uint32_t>(
+                  static_cast<uint64_t>(db_offset - low_offset) *
+                  (high - low) / (high_offset - low_offset));
+        }
+      else
+        {
+          mid = low + (high - low) / 2;
+        }
+      estimate = !estimate;
+
+      if (!this->readTrackIndex(mid, record))
+        {
+          return false;
+        }
+
+      if (record->db_offset == db_offset)
+        {
+          return true;
+        }
+
+      if (record->db_offset < db_offset)
+        {
+          low        = mid + 1;
+          low_offset = record->db_offset + 1;
+        }
+      else
+        {
+          high        = mid;
+          high_offset = record->db_offset;
+        }
+    }
+
+  _err("Track of offset %d is not exist.\n", db_offset);
+
+  return false;
+}
+
+/*--------------------------------------------------------------------------*/
+bool Playlist::writeTrackIndexKey(FAR FILE *index_fp, uint32_t track_num)
+{
+  /* Records are read back from index_fp, and the sorted keys of
+   * artist and album are appended in this order.
+   */
+
+  if (track_num == 0)
+    {
+      return false;
+    }
+
+  FAR TrackIndexKey *keys =
+    static_cast<FAR TrackIndexKey *>(malloc(track_num *
+                                            sizeof(TrackIndexKey)));
+  if (keys == NULL)
+    {
+      _info("No memory for key sections of track index.\n");
+      return false;
+    }
+
+  bool ret = true;
+
+  for (int section = 0; (section < 2) && ret; section++)
+    {
+      fseek(index_fp, sizeof(TrackIndexHeader), SEEK_SET);
+
+      for (uint32_t i = 0; i < track_num; i++)
+        {
+          TrackIndexRecord record;
+          if (fread(&record, sizeof(record), 1, index_fp) != 1)
+            {
+              ret = false;
+              break;
+            }
+
+          keys[i].hash = hashTrackKey((section == 0) ?
+                                      record.track.author :
+                                      record.track.album);
+          keys[i].record_no = i;
+        }
+
+      if (ret)
+        {
+          qsort(keys, track_num, sizeof(TrackIndexKey), compareTrackIndexKey);
+
+          fseek(index_fp, 0, SEEK_END);
+          ret = (fwrite(keys, sizeof(TrackIndexKey), track_num, index_fp) ==
+                 track_num);
+        }
+    }
+
+  free(keys);
+
+  return ret;
+}
+
+/*--------------------------------------------------------------------------*/
+int Playlist::compareTrackIndexKey(FAR const void *a, FAR const void *b)
+{
+  /* Sort by hash, and by record in the same hash to keep the order of
+   * track database in alias lists.
+   */
+
+  FAR const TrackIndexKey *key_a = static_cast<FAR const TrackIndexKey *>(a);
+  FAR const TrackIndexKey *key_b = static_cast<FAR const TrackIndexKey *>(b);
+
+  if (key_a->hash != key_b->hash)
+    {
+      return (key_a->hash < key_b->hash) ? -1 : 1;
+    }
+
+  if (key_a->record_no != key_b->record_no)
+    {
+      return (key_a->record_no < key_b->record_no) ? -1 : 1;
+    }
+
+  return 0;
+}
+
+/*--------------------------------------------------------------------------*/
+bool Playlist::readTrackIndexKey(ListType          type,
+                                 uint32_t          key_no,
+                                 FAR TrackIndexKey *key)
+{
+  if (key_no >= this->m_track_key_num)
+    {
+      return false;
+    }
+
+  clearerr(this->m_track_index_fp);
+
+  uint32_t section = (type == ListTypeArtist) ? 0 : 1;
+  long pos = sizeof(TrackIndexHeader) +
+             this->m_track_num * sizeof(TrackIndexRecord) +
+             (section * this->m_track_key_num + key_no) *
+               sizeof(TrackIndexKey);
+  if (fseek(this->m_track_index_fp, pos, SEEK_SET) != 0)
+    {
+      return false;
+    }
+
+  return (fread(key, sizeof(*key), 1, this->m_track_index_fp) == 1);
+}
+
+/*--------------------------------------------------------------------------*/
+uint32_t Playlist::searchTrackIndexKey(ListType type, uint32_t hash)
+{
+  /* Binary search of the first key which is not less than hash. */
+
+  uint32_t low  = 0;
+  uint32_t high = this->m_track_key_num;
+
+  while (low < high)
+    {
+      uint32_t mid = low + (high - low) / 2;
+
+      TrackIndexKey key;
+      if (!this->readTrackIndexKey(type, mid, &key))
+        {
+          return this->m_track_key_num;
+        }
+
+      if (key.hash < hash)
+        {
+          low = mid + 1;
+        }
+      else
+        {
+          high = mid;
+        }
+    }
+
+  return low;
+}
+
+/*--------------------------------------------------------------------------*/
+bool Playlist::updatePlaylistByKey(ListType       type,
+                                   FAR const char *key_str,
+                                   FAR FILE       *list_fp)
+{
+  if ((this->m_track_index_fp == NULL) ||
+      (this->m_track_key_num == 0) ||
+      ((type != ListTypeArtist) && (type != ListTypeAlbum)))
+    {
+      return false;
+    }
+
+  /* Tracks of the same hash are checked by the name, as hashes of
+   * other names may collide.
+   */
+
+  uint32_t hash = hashTrackKey(key_str);
+
+  for (uint32_t key_no = this->searchTrackIndexKey(type, hash);
+       key_no < this->m_track_key_num;
+       key_no++)
+    {
+      TrackIndexKey    key;
+      TrackIndexRecord record;
+
+      if (!this->readTrackIndexKey(type, key_no, &key) ||
+          (key.hash != hash))
+        {
+          break;
+        }
+
+      if (!this->readTrackIndex(key.record_no, &record))
+        {
+          break;
+        }
+
+      if (this->isTargetTrack(type, key_str, &record.track))
+        {
+          fpos_t fp_offset = record.db_offset;
+          size_t wsize = fwrite(&fp_offset, sizeof(fp_offset), 1, list_fp);
+          if (wsize != 1)
+            {
+              printf("File write error. [%d]\n", wsize);
+            }
+        }
+    }
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool Playlist::getTrackIndexFileName(FAR char *file_name, uint8_t max_length)
+{
+  snprintf(file_name,
+           max_length,
+           "%s/%s",
+           m_playlist_path,
+           TrackIndexFileName);
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool Playlist::getTrackDbStat(FAR uint32_t *db_size, FAR uint32_t *db_mtime)
+{
+  char absolute_path[FileNameMaxLength];
+
+  snprintf(absolute_path,
+           sizeof(absolute_path),
+           "%s/%s", m_playlist_path,
+           this->m_track_db_file_name);
+
+  struct stat file_stat;
+  memset(&file_stat, 0, sizeof(file_stat));
+  if (stat(absolute_path, &file_stat) != 0)
+    {
+      *db_size  = 0;
+      *db_mtime = 0;
+      return false;
+    }
+
+  *db_size  = static_cast<uint32_t>(file_stat.st_size);
+  *db_mtime = static_cast<uint32_t>(file_stat.st_mtime);
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+bool Playlist::getTrackDbChecksum(FAR uint32_t *db_checksum)
+{
+  /* FNV-1a of whole track database. m_line_buffer is used to read it. */
+
+  *db_checksum = 0;
+
+  if (this->m_track_db_fp == NULL)
+    {
+      _err("file not opened.\n");
+      return false;
+    }
+
+  clearerr(this->m_track_db_fp);
+  if (fseek(this->m_track_db_fp, 0, SEEK_SET) != 0)
+    {
+      return false;
+    }
+
+  uint32_t hash = 0x811c9dc5;
+  size_t   read_size;
+
+  do
+    {
+      read_size = fread(this->m_line_buffer,
+                        1,
+                        sizeof(this->m_line_buffer),
+                        this->m_track_db_fp);
+
+      for (size_t i = 0; i < read_size; i++)
+        {
+          hash = (hash ^ static_cast<uint8_t>(this->m_line_buffer[i])) *
+                 0x01000193;
+        }
+    }
+  while (read_size == sizeof(this->m_line_buffer));
+
+  bool ret = (ferror(this->m_track_db_fp) == 0);
+
+  clearerr(this->m_track_db_fp);
+  fseek(this->m_track_db_fp, 0, SEEK_SET);
+
+  *db_checksum = hash;
+
+  return ret;
+}
+#endif /* CONFIG_AUDIOUTILS_PLAYLIST_TRACK_INDEX */
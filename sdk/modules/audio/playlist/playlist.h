@@ -36,6 +36,8 @@
 #ifndef MODULES_AUDIO_PLAYLIST_PLAYLIST_H
 #define MODULES_AUDIO_PLAYLIST_PLAYLIST_H
 
+#include <sdk/config.h>
+
 #include "memutils/s_stl/queue.h"
 #include "audio/audio_high_level_api.h"
 
@@ -84,6 +86,12 @@ public:
     m_list_type(ListTypeAllTrack),
     m_play_idx(-1),
     m_track_db_fp(NULL)
+#ifdef CONFIG_AUDIOUTILS_PLAYLIST_TRACK_INDEX
+    , m_track_index_fp(NULL),
+    m_track_num(0),
+    m_track_db_size(0),
+    m_track_key_num(0)
+#endif
   {
     strncpy(m_track_db_file_name, file_name, sizeof(m_track_db_file_name));
     memset(m_playlist_path, 0, sizeof(m_playlist_path));
@@ -107,6 +115,9 @@ public:
   bool getNextTrack(FAR Track *track);
   bool getPrevTrack(FAR Track *track);
   bool restart(void);
+#ifdef CONFIG_AUDIOUTILS_PLAYLIST_TRACK_INDEX
+  bool buildTrackIndex(void);
+#endif
 
 private:
   bool open(FAR const char *mode);
@@ -123,6 +134,65 @@ private:
                    FAR char       *file_name,
                    uint8_t        max_length);
 
+#ifdef CONFIG_AUDIOUTILS_PLAYLIST_TRACK_INDEX
+  /* Binary track index.
+   * A header followed by fixed-size records in the order of lines of
+   * the track database, so records are sorted by db_offset.
+   * Key sections of artist and album follow the records. Each holds
+   * key_num entries sorted by the hash of the key, so tracks of an
+   * artist or an album are found by binary search.
+   */
+
+  struct TrackIndexHeader
+  {
+    uint32_t magic;       /* TrackIndexMagic. */
+    uint16_t version;     /* TrackIndexVersion. */
+    uint16_t record_size; /* sizeof(TrackIndexRecord). */
+    uint32_t track_num;   /* Number of records. */
+    uint32_t db_size;     /* Size of track database when built. */
+    uint32_t db_mtime;    /* Modified time of track database when built. */
+    uint32_t db_checksum; /* Checksum of track database contents.
+                           * (mtime of FAT has 2 seconds resolution)
+                           */
+    uint32_t key_num;     /* Number of entries of a key section.
+                           * 0 if key sections are not built.
+                           */
+  };
+
+  struct TrackIndexRecord
+  {
+    uint32_t db_offset;   /* Offset of the line in track database. */
+    uint32_t is_valid;    /* Result of parsing the line. */
+    Track    track;       /* Parsed track info. */
+  };
+
+  struct TrackIndexKey
+  {
+    uint32_t hash;        /* Hash of artist or album name. */
+    uint32_t record_no;   /* Record of the track. */
+  };
+
+  bool openTrackIndex(void);
+  bool closeTrackIndex(void);
+  bool readTrackIndex(uint32_t record_no, FAR TrackIndexRecord *record);
+  bool searchTrackIndex(uint32_t db_offset, FAR TrackIndexRecord *record);
+  bool writeTrackIndexKey(FAR FILE *index_fp, uint32_t track_num);
+  bool readTrackIndexKey(ListType          type,
+                         uint32_t          key_no,
+                         FAR TrackIndexKey *key);
+  uint32_t searchTrackIndexKey(ListType type, uint32_t hash);
+  static int compareTrackIndexKey(FAR const void *a, FAR const void *b);
+  bool updatePlaylistByKey(ListType       type,
+                           FAR const char *key_str,
+                           FAR FILE       *list_fp);
+  bool getTrackIndexFileName(FAR char *file_name, uint8_t max_length);
+  bool getTrackDbStat(FAR uint32_t *db_size, FAR uint32_t *db_mtime);
+  bool getTrackDbChecksum(FAR uint32_t *db_checksum);
+
+  static const uint32_t TrackIndexMagic   = 0x58494c50; /* "PLIX" */
+  static const uint16_t TrackIndexVersion = 2;
+#endif
+
   static const int  FileNameMaxLength = 128;
   static const int  LineMaxLength     = 256;
 
@@ -135,6 +205,12 @@ private:
   char       m_line_buffer[LineMaxLength];
   char       m_track_db_file_name[FileNameMaxLength];
   FAR FILE   *m_track_db_fp;
+#ifdef CONFIG_AUDIOUTILS_PLAYLIST_TRACK_INDEX
+  FAR FILE   *m_track_index_fp;
+  uint32_t   m_track_num;
+  uint32_t   m_track_db_size;
+  uint32_t   m_track_key_num;
+#endif
 
   s_std::Queue<uint32_t, 256> m_alias_list;
 };
@@ -43,17 +43,33 @@
 #include <stdlib.h>
 
 #include "common/LatmAacLc.h"
+#include "common/SyncWordScanner.h"
 
-/* Syncword to use with LATM / LOAS.
+/* syncExtensionType of AudioSpecificConfig.
  * (Compare after obtaining with 11bit value -> long value)
  */
 
-#define LATM_LENGTH_OF_SYNCWORD  11
-#define LATM_LENGTH_OF_FRAME     13
-#define LATM_SYNCWORD_LOAS       0x2B7        /* -010 1011 0111 */
-#define LATM_SYNCWORD_EXT_LOAS   LATM_SYNCWORD_LOAS
+#define LATM_SYNCWORD_EXT_SBR    0x2B7        /* -010 1011 0111 */
 #define LATM_SYNCWORD_EXT_PS     0x548        /* -101 0100 1000 */
 
+/* LOAS (AudioSyncStream) frame header:
+ * syncword(11) = 0x2B7, audioMuxLengthBytes(13)
+ * The syncword is byte aligned, so it is searched as the upper
+ * 11 bits of 2 bytes.
+ */
+
+#define LOAS_SYNC_MASK           0xFFE0
+#define LOAS_SYNC_WORD           0x56E0       /* 0x2B7 << 5 */
+#define LOAS_HEADER_SIZE         3
+#define LOAS_GET_LENGTH(p)       ((((uint32_t)(p)[1] & 0x1F) << 8) | (p)[2])
+
+/* Number of following frame headers which must be valid to take a
+ * syncword as a frame. A random 11bit match passes each of them with
+ * 1/2048 chance.
+ */
+
+#define LOAS_SYNC_CONFIRM        2
+
 
 /* Channel_Configuration[ISO standard] */
 
@@ -69,6 +85,7 @@
 
 #define LATM_BIT_OF_BYTE  8
 #define LATM_BIT_OF_LONG  32
+#define LATM_BIT_OF_CACHE 64
 #define LATM_VAL_OF_5BIT  0x1F
 
 /* AudioObjectType[ISO standard] */
@@ -150,6 +167,12 @@ struct latm_local_info_s
   /* Temporarily use for data passing purpose. */
 
   uint32_t  temp_long;        /* long value */
+
+  /* Bit cache. (64bit big endian word loaded from cache_ptr) */
+
+  uint8_t  *cache_ptr;
+  uint64_t  cache_word;
+  uint8_t  *ptr_end_latm;     /* End of the data. (Not read beyond) */
 };
 typedef struct latm_local_info_s LatmLocalInfo;
 
@@ -165,158 +188,113 @@ struct use_chunk_info_s
 };
 typedef struct use_chunk_info_s UseChunkInfo;
 
-/* Mask value at bit processing. */
-
-static const uint8_t BitMaskLessByteTable[9] =
-{
-  0x00,  /* 0-bit. */
-  0x80,  /* 1-bit. */
-  0xC0,  /* 2-bit. */
-  0xE0,  /* 3-bit. */
-  0xF0,  /* 4-bit. */
-  0xF8,  /* 5-bit. */
-  0xFC,  /* 6-bit. */
-  0xFE,  /* 7-bit. */
-  0xFF   /* 8-bit. */
-};
-
-#ifdef WINDOWS
 /*--------------------------------------------------------------------------*/
-static inline uint32_t convByteToLong(uint8_t byte_value[], uint8_t max_byte)
+static inline void bitInit(LatmLocalInfo *ptr_info,
+                           uint8_t *ptr_readbuff,
+                           uint32_t readbuff_size)
 {
-  uint32_t rtn_value = 0;
-
-  for (int32_t i = 0, j = max_byte - 1; i < max_byte; i++, j--)
-    {
-      rtn_value |= (uint32_t)(byte_value[i] << (j * LATM_BIT_OF_BYTE));
-    }
-
-  return rtn_value;
-}
-#else
-/*--------------------------------------------------------------------------*/
-static inline uint32_t convByteToLong(uint8_t byte_value[], uint8_t max_byte)
-{
-  uint32_t rtn_value = 0;
-
-  for (int32_t i = 0; i < max_byte; i++)
-    {
-      rtn_value |= (uint32_t)(byte_value[i] << (i * LATM_BIT_OF_BYTE));
-    }
-
-  return rtn_value;
+  ptr_info->ptr_check_latm = ptr_readbuff;
+  ptr_info->total_bit_length = 0;
+  ptr_info->cache_ptr = NULL;
+  ptr_info->cache_word = 0;
+  ptr_info->ptr_end_latm = ptr_readbuff + readbuff_size;
 }
-#endif
 
 /*--------------------------------------------------------------------------*/
-static uint8_t bitReadLessByte(LatmLocalInfo *ptr_info,
+static inline uint32_t bitPeek(LatmLocalInfo *ptr_info,
                                uint32_t length_for_read)
 {
-  uint8_t rtn_value = 0;
-
-  uint8_t modulo_bit =
-    (uint8_t)(ptr_info->total_bit_length % LATM_BIT_OF_BYTE);
-
-  /* Check if it spans 2 bytes.(modulo_bit is the start bit) */
+  /* The current bit is at (total_bit_length % 8) of ptr_check_latm.
+   * Up to 32 bits are taken from the 64bit cache, which is refilled
+   * from the current pointer only when the bits are out of it.
+   * Bytes at or after ptr_end_latm are not loaded and read as 0.
+   */
 
-  if ((LATM_BIT_OF_BYTE - modulo_bit) >= (uint8_t)length_for_read)
+  if (length_for_read == 0)
     {
-      /* When it does not span 2 byte. */
+      return 0;
+    }
 
-      rtn_value =
-        (*(ptr_info->ptr_check_latm) &
-          (BitMaskLessByteTable[length_for_read] >> modulo_bit));
-      ptr_info->total_bit_length += length_for_read;
+  uint32_t bit_pos = (ptr_info->total_bit_length % LATM_BIT_OF_BYTE);
 
-      if (ptr_info->total_bit_length % LATM_BIT_OF_BYTE)
-        {
-          rtn_value >>=
-            (LATM_BIT_OF_BYTE - (ptr_info->total_bit_length %
-              LATM_BIT_OF_BYTE));
-        }
+  if ((ptr_info->cache_ptr != NULL) &&
+      (ptr_info->ptr_check_latm >= ptr_info->cache_ptr) &&
+      ((ptr_info->ptr_check_latm - ptr_info->cache_ptr) <
+        (LATM_BIT_OF_CACHE / LATM_BIT_OF_BYTE)))
+    {
+      bit_pos += (ptr_info->ptr_check_latm - ptr_info->cache_ptr) *
+                 LATM_BIT_OF_BYTE;
     }
   else
     {
-      /* Read 1st byte. */
-
-      rtn_value =
-        (*(ptr_info->ptr_check_latm) & ~BitMaskLessByteTable[modulo_bit]);
+      /* Mark the cache as not covering the current pointer. */
 
-      /* Since the return value is 1 byte, it shifts to the upper bit side. */
-
-      rtn_value <<= (length_for_read - (LATM_BIT_OF_BYTE - modulo_bit));
-
-      /* If total_bit_length is last added with length_for_read,
-       * this line is not needed
-       */
-
-      ptr_info->total_bit_length += (LATM_BIT_OF_BYTE - modulo_bit);
-
-      /* Advance pointer for byte again. */
-
-      (ptr_info->ptr_check_latm)++;
-
-      /* Calculate the number of bits in 2nd byte. */
+      bit_pos += LATM_BIT_OF_CACHE;
+    }
 
-      modulo_bit = (length_for_read - (LATM_BIT_OF_BYTE - modulo_bit));
+  if ((bit_pos + length_for_read) > LATM_BIT_OF_CACHE)
+    {
+      uint64_t word = 0;
+      uint32_t rest_byte = 0;
 
-      /* Reads the 2nd byte and sets the value combined with 1st byte
-       * as the return value.
-       */
+      if (ptr_info->ptr_check_latm < ptr_info->ptr_end_latm)
+        {
+          rest_byte = ptr_info->ptr_end_latm - ptr_info->ptr_check_latm;
+        }
 
-      rtn_value |=
-        ((*(ptr_info->ptr_check_latm) & BitMaskLessByteTable[modulo_bit]) >>
-          (LATM_BIT_OF_BYTE - modulo_bit));
-      ptr_info->total_bit_length += modulo_bit;
-    }
+      if (rest_byte >= (LATM_BIT_OF_CACHE / LATM_BIT_OF_BYTE))
+        {
+          /* Whole word is in the data. (The usual case) */
 
-  /* Advance the pointer when there are no remaining bits after processing. */
+          const uint8_t *p = ptr_info->ptr_check_latm;
 
-  if (!(ptr_info->total_bit_length % LATM_BIT_OF_BYTE))
-    {
-      (ptr_info->ptr_check_latm)++;
+          word = ((uint64_t)p[0] << 56) | ((uint64_t)p[1] << 48) |
+                 ((uint64_t)p[2] << 40) | ((uint64_t)p[3] << 32) |
+                 ((uint64_t)p[4] << 24) | ((uint64_t)p[5] << 16) |
+                 ((uint64_t)p[6] << 8)  | (uint64_t)p[7];
+        }
+      else
+        {
+          for (uint32_t i = 0; i < (LATM_BIT_OF_CACHE / LATM_BIT_OF_BYTE);
+               i++)
+            {
+              word <<= LATM_BIT_OF_BYTE;
+              if (i < rest_byte)
+                {
+                  word |= ptr_info->ptr_check_latm[i];
+                }
+            }
+        }
+      ptr_info->cache_word = word;
+      ptr_info->cache_ptr = ptr_info->ptr_check_latm;
+      bit_pos = (ptr_info->total_bit_length % LATM_BIT_OF_BYTE);
     }
 
-  return rtn_value;
+  return (uint32_t)((ptr_info->cache_word << bit_pos) >>
+                    (LATM_BIT_OF_CACHE - length_for_read));
 }
 
 /*--------------------------------------------------------------------------*/
-static uint32_t bitReadLessLong(LatmLocalInfo *ptr_info,
-                                uint32_t length_for_read)
+static inline void bitSkip(LatmLocalInfo *ptr_info, uint32_t length_for_skip)
 {
-  uint32_t i = 0;
-  uint8_t  byte_value[4] =
-  {
-    0
-  };
-
-  uint8_t max_byte = (length_for_read / LATM_BIT_OF_BYTE);
-  uint8_t modulo_bit = (length_for_read % LATM_BIT_OF_BYTE);
+  /* Advance the pointer by the bytes which are finished. */
 
-  /* Read the bit remainder first. */
+  uint32_t bit_pos =
+    (ptr_info->total_bit_length % LATM_BIT_OF_BYTE) + length_for_skip;
 
-  if (modulo_bit)
-    {
-      byte_value[0] = bitReadLessByte(ptr_info, modulo_bit);
-      i = 1;
-      max_byte++;
-    }
-
-  /* Process remaining by byte unit.
-   * (ptr_check_latm and total_bit_length are updated in bitReadLessByte ())
-   */
-
-  while ((i < (int32_t)max_byte) && (i < sizeof(byte_value)))
-    {
-      byte_value[i] = bitReadLessByte(ptr_info, LATM_BIT_OF_BYTE);
-      i++;
-    }
+  ptr_info->total_bit_length += length_for_skip;
+  ptr_info->ptr_check_latm += (bit_pos / LATM_BIT_OF_BYTE);
+}
 
-  /* Convert byte array to long. */
+/*--------------------------------------------------------------------------*/
+static inline uint32_t bitRead(LatmLocalInfo *ptr_info,
+                               uint32_t length_for_read)
+{
+  uint32_t rtn_value = bitPeek(ptr_info, length_for_read);
 
-  uint32_t rtn_long_value = convByteToLong(&byte_value[0], max_byte);
+  bitSkip(ptr_info, length_for_read);
 
-  return rtn_long_value;
+  return rtn_value;
 }
 
 /*--------------------------------------------------------------------------*/
@@ -444,79 +422,6 @@ static int copyAudioSpecificConfig(InfoStreamMuxConfig *ptr_stream_mux_config,
   return prev_cnt;
 }
 
-/*--------------------------------------------------------------------------*/
-static bool serachNextBitsForSyncWord(LatmLocalInfo *ptr_info,
-                                      uint32_t sync_length,
-                                      uint32_t search_word)
-{
-  LatmLocalInfo backup;
-
-  /* Search for syncword while bit shifting.
-   * (Avoid searching indefinitely, with 8 bits as the upper limit)
-   */
-
-  for (int32_t i = 0; i < 8; i++)
-    {
-      /* Pointers and cumulative bit are updated,
-       * so copy it temporarily and use it.
-       */
-
-      backup.total_bit_length = (ptr_info->total_bit_length + i);
-      uint32_t byte_of_total = (backup.total_bit_length / 8);
-
-      /* Fit the read pointer to the cumulative bit. */
-
-      backup.ptr_check_latm = (ptr_info->ptr_check_latm + byte_of_total);
-
-      /* Read specified bit length. */
-
-      uint32_t dummy_read = bitReadLessLong(&backup, sync_length);
-      if (dummy_read == search_word)
-        {
-          /* Set the next bit position of syncword. */
-
-          ptr_info->temp_long = backup.total_bit_length;
-          return true;
-        }
-    }
-
-  return false;
-}
-
-/*--------------------------------------------------------------------------*/
-static int32_t AACLC_checkLOAS(LatmLocalInfo *ptr_info)
-{
-  LatmLocalInfo temp;
-  int32_t length_latm_frame = 0;
-
-  /* Pointers and cumulative bit are updated,
-   * so copy it temporarily and use it.
-   */
-
-  temp.ptr_check_latm = ptr_info->ptr_check_latm;
-  temp.total_bit_length = ptr_info->total_bit_length;
-
-  /* Search syncword. */
-
-  if (serachNextBitsForSyncWord(&temp,
-                                LATM_LENGTH_OF_SYNCWORD,
-                                LATM_SYNCWORD_LOAS))
-    {
-      /* In the case of syncword, get the LATM frame length. */
-
-      temp.total_bit_length = temp.temp_long;
-      temp.ptr_check_latm =
-        (ptr_info->ptr_check_latm +
-          (temp.total_bit_length / LATM_BIT_OF_BYTE));
-
-      /* Get the frame length after updating pointer and cumulative bit. */
-
-      length_latm_frame = bitReadLessLong(&temp, LATM_LENGTH_OF_FRAME);
-    }
-
-  return length_latm_frame;
-}
-
 /*--------------------------------------------------------------------------*/
 static int32_t iso_byteAlignment(LatmLocalInfo *ptr_info)
 {
@@ -529,7 +434,7 @@ static int32_t iso_byteAlignment(LatmLocalInfo *ptr_info)
     {
       /* Idle read . */
 
-      bitReadLessByte(ptr_info, modulo_bit);
+      bitRead(ptr_info, modulo_bit);
     }
 
   return modulo_bit;
@@ -540,13 +445,13 @@ static uint32_t isoLatmGetValue(LatmLocalInfo *ptr_info)
 {
   uint32_t helper_value = 0;
 
-  uint8_t bytes_for_value = bitReadLessByte(ptr_info, 2);
+  uint8_t bytes_for_value = bitRead(ptr_info, 2);
 
   /* Below is the ISO standard. */
 
   for (int32_t i = 0; i <= (int32_t)bytes_for_value; i++)
     {
-      uint8_t value_tmp = bitReadLessByte(ptr_info, 8);
+      uint8_t value_tmp = bitRead(ptr_info, 8);
       helper_value *= (2 ^ 8);
       helper_value += value_tmp;
     }
@@ -567,88 +472,88 @@ static int32_t
 
   /* Element_instance_tag processing. */
 
-  uint32_t dummy_read = bitReadLessByte(ptr_info, 4);
+  uint32_t dummy_read = bitRead(ptr_info, 4);
   bit_length += 4;
 
   /* Object_type processing. */
 
   ptr_stream_mux_config->info_stream_id[ptr_info->stream_cnt].
-    asc.pce_object_type = bitReadLessByte(ptr_info, 2);
+    asc.pce_object_type = bitRead(ptr_info, 2);
   bit_length += 2;
 
   /* Sampling_frequency_index processing. */
 
   ptr_stream_mux_config->info_stream_id[ptr_info->stream_cnt].
-    asc.pce_sampling_frequency_index = bitReadLessByte(ptr_info, 4);
+    asc.pce_sampling_frequency_index = bitRead(ptr_info, 4);
   bit_length += 4;
 
   /* Num_front_channel_elements processing. */
 
-  uint32_t num_front_channel_elements = bitReadLessByte(ptr_info, 4);
+  uint32_t num_front_channel_elements = bitRead(ptr_info, 4);
   bit_length += 4;
 
   /* Num_side_channel_elements processing. */
 
-  uint32_t num_side_channel_elements = bitReadLessByte(ptr_info, 4);
+  uint32_t num_side_channel_elements = bitRead(ptr_info, 4);
   bit_length += 4;
 
   /* Num_back_channel_elements processing. */
 
-  uint32_t num_back_channel_elements = bitReadLessByte(ptr_info, 4);
+  uint32_t num_back_channel_elements = bitRead(ptr_info, 4);
   bit_length += 4;
 
   /* Bum_lfe_channel_elements processing. */
 
-  uint32_t num_lfe_channel_elements = bitReadLessByte(ptr_info, 2);
+  uint32_t num_lfe_channel_elements = bitRead(ptr_info, 2);
   bit_length += 2;
 
   /* Num_assoc_data_elements processing. */
 
-  uint32_t num_assoc_data_elements = bitReadLessByte(ptr_info, 3);
+  uint32_t num_assoc_data_elements = bitRead(ptr_info, 3);
   bit_length += 3;
 
   /* Num_valid_cc_elements processing. */
 
-  uint32_t num_valid_cc_elements = bitReadLessByte(ptr_info, 4);
+  uint32_t num_valid_cc_elements = bitRead(ptr_info, 4);
   bit_length += 4;
 
   /* Mono_mixdown_present processing. */
 
-  dummy_read = bitReadLessByte(ptr_info, 1);
+  dummy_read = bitRead(ptr_info, 1);
   bit_length++;
   if (dummy_read)
     {
       /* Mono_mixdown_element_number processing. */
 
-      dummy_read = bitReadLessByte(ptr_info, 4);
+      dummy_read = bitRead(ptr_info, 4);
       bit_length += 4;
     }
 
   /* Stereo_mixdown_present processing. */
 
-  dummy_read = bitReadLessByte(ptr_info, 1);
+  dummy_read = bitRead(ptr_info, 1);
   bit_length++;
   if (dummy_read)
     {
       /* Stereo_mixdown_element_number processing. */
 
-      dummy_read = bitReadLessByte(ptr_info, 4);
+      dummy_read = bitRead(ptr_info, 4);
       bit_length += 4;
     }
 
   /* Matrix_mixdown_idx_present processing.. */
 
-  dummy_read = bitReadLessByte(ptr_info, 1);
+  dummy_read = bitRead(ptr_info, 1);
   bit_length++;
   if (dummy_read)
     {
       /* Matrix_mixdown_idx processing. */
 
-      dummy_read = bitReadLessByte(ptr_info, 2);
+      dummy_read = bitRead(ptr_info, 2);
       bit_length += 2;
 
       /* Pseudo_surround_enable processing. */
-      dummy_read = bitReadLessByte(ptr_info, 1);
+      dummy_read = bitRead(ptr_info, 1);
       bit_length += 1;
     }
 
@@ -657,61 +562,61 @@ static int32_t
     {
       /* Front_element_is_cpe[i] processing. */
 
-      dummy_read = bitReadLessByte(ptr_info, 1);
+      dummy_read = bitRead(ptr_info, 1);
       bit_length += 1;
 
       /* Front_element_tag_select[i] processing.. */
 
-      dummy_read = bitReadLessByte(ptr_info, 4);
+      dummy_read = bitRead(ptr_info, 4);
       bit_length += 4;
     }
   for (i = 0; i < (int32_t)num_side_channel_elements; i++)
     {
       /* Side_element_is_cpe[i] processing. */
 
-      dummy_read = bitReadLessByte(ptr_info, 1);
+      dummy_read = bitRead(ptr_info, 1);
       bit_length += 1;
 
       /* Side_element_tag_select[i] processing. */
 
-      dummy_read = bitReadLessByte(ptr_info, 4);
+      dummy_read = bitRead(ptr_info, 4);
       bit_length += 4;
     }
   for (i = 0; i < (int32_t)num_back_channel_elements; i++)
     {
       /* Back_element_is_cpe[i] processing. */
 
-      dummy_read = bitReadLessByte(ptr_info, 1);
+      dummy_read = bitRead(ptr_info, 1);
       bit_length += 1;
 
       /* Back_element_tag_select[i] processing. */
 
-      dummy_read = bitReadLessByte(ptr_info, 4);
+      dummy_read = bitRead(ptr_info, 4);
       bit_length += 4;
     }
   for (i = 0; i < (int32_t)num_lfe_channel_elements; i++)
     {
       /* Lfe_element_tag_select[i] processing. */
 
-      dummy_read = bitReadLessByte(ptr_info, 4);
+      dummy_read = bitRead(ptr_info, 4);
       bit_length += 4;
     }
   for (i = 0; i < (int32_t)num_assoc_data_elements; i++)
     {
       /* Assoc_data_element_tag_select[i] processing. */
 
-      dummy_read = bitReadLessByte(ptr_info, 4);
+      dummy_read = bitRead(ptr_info, 4);
       bit_length += 4;
     }
   for (i = 0; i < (int32_t)num_valid_cc_elements; i++)
     {
       /* Cc_element_is_ind_sw[i] processing. */
 
-      dummy_read = bitReadLessByte(ptr_info, 1);
+      dummy_read = bitRead(ptr_info, 1);
       bit_length += 1;
 
       /* Valid_cc_element_tag_select[i] processing. */
-      dummy_read = bitReadLessByte(ptr_info, 4);
+      dummy_read = bitRead(ptr_info, 4);
       bit_length += 4;
     }
 
@@ -721,13 +626,13 @@ static int32_t
 
   /* Comment_field_bytes processing. */
 
-  uint32_t comment_field_bytes = bitReadLessByte(ptr_info, 8);
+  uint32_t comment_field_bytes = bitRead(ptr_info, 8);
   bit_length += 8;
   for (i = 0; i < (int32_t)comment_field_bytes; i++)
     {
       /* Comment_field_data[i] processing. */
 
-      dummy_read = bitReadLessByte(ptr_info, 8);
+      dummy_read = bitRead(ptr_info, 8);
       bit_length += 8;
     }
 
@@ -746,24 +651,24 @@ static int32_t isoGASpecificConfig(LatmLocalInfo *ptr_info,
 
   /* [ISO standard] frameLengthFlag processing. */
 
-  uint32_t dummy_read = bitReadLessByte(ptr_info, 1);
+  uint32_t dummy_read = bitRead(ptr_info, 1);
   bit_length++;
 
   /* [ISO standard] dependsOnCoreCoder processing. */
 
-  dummy_read = bitReadLessByte(ptr_info, 1);
+  dummy_read = bitRead(ptr_info, 1);
   bit_length++;
   if (dummy_read)
     {
       /* [ISO standard] coreCoderDelay processing. */
 
-      dummy_read = bitReadLessLong(ptr_info, 14);
+      dummy_read = bitRead(ptr_info, 14);
       bit_length += 14;
     }
 
   /* [ISO standard] extensionFlag processing. */
 
-  uint32_t extensionFlag = bitReadLessByte(ptr_info, 1);
+  uint32_t extensionFlag = bitRead(ptr_info, 1);
   bit_length++;
 
   /* [ISO standard] channel_configuration processing. */
@@ -836,7 +741,7 @@ static int32_t isoGASpecificConfig(LatmLocalInfo *ptr_info,
 
       /* [ISO standard] extensionFlag3 processing. */
 
-      dummy_read = bitReadLessByte(ptr_info, 1);
+      dummy_read = bitRead(ptr_info, 1);
       bit_length++;
     }
 
@@ -848,10 +753,10 @@ static uint32_t isoGetAudioObjectType(LatmLocalInfo *ptr_info)
 {
   /* According to ISO standard. */
 
-  uint32_t audioObjectType = bitReadLessByte(ptr_info, 5);
+  uint32_t audioObjectType = bitRead(ptr_info, 5);
   if (audioObjectType == LATM_VAL_OF_5BIT)
     {
-      audioObjectType += bitReadLessByte(ptr_info, 6);
+      audioObjectType += bitRead(ptr_info, 6);
     }
 
   return audioObjectType;
@@ -885,7 +790,7 @@ static int32_t
 
   ptr_stream_mux_config->
    info_stream_id[ptr_info->stream_cnt].asc.sampling_frequency_index =
-     bitReadLessByte(ptr_info, 4);
+     bitRead(ptr_info, 4);
   bit_length += 4;
 
   /* [ISO standard] Check esc_value. */
@@ -897,7 +802,7 @@ static int32_t
 
       ptr_stream_mux_config->
         info_stream_id[ptr_info->stream_cnt].asc.sampling_frequency =
-          bitReadLessLong(ptr_info, 24);
+          bitRead(ptr_info, 24);
       bit_length += 24;
     }
   else
@@ -912,7 +817,7 @@ static int32_t
 
   ptr_stream_mux_config->
     info_stream_id[ptr_info->stream_cnt].asc.channel_configuration =
-      bitReadLessByte(ptr_info, 4);
+      bitRead(ptr_info, 4);
   bit_length += 4;
   ptr_stream_mux_config->
     info_stream_id[ptr_info->stream_cnt].asc.ps_present_flag = (-1);
@@ -943,7 +848,7 @@ static int32_t
       ptr_stream_mux_config->
         info_stream_id[ptr_info->stream_cnt].
           asc.extension_sampling_frequency_index =
-            bitReadLessByte(ptr_info, 4);
+            bitRead(ptr_info, 4);
       bit_length += 4;
 
       /* [ISO standard] Check esc_value. */
@@ -956,7 +861,7 @@ static int32_t
 
           ptr_stream_mux_config->
             info_stream_id[ptr_info->stream_cnt].
-              asc.extension_sampling_frequency = bitReadLessLong(ptr_info, 24);
+              asc.extension_sampling_frequency = bitRead(ptr_info, 24);
           bit_length += 24;
         }
       else
@@ -1053,12 +958,12 @@ static int32_t
     {
       /* [ISO standard] syncExtensionType processing. */
 
-      uint32_t sync_ext_type = bitReadLessLong(ptr_info, 11);
+      uint32_t sync_ext_type = bitRead(ptr_info, 11);
       bit_length += 11;
 
       /* [ISO standard] Check extended syncword. */
 
-      if (sync_ext_type == LATM_SYNCWORD_EXT_LOAS)
+      if (sync_ext_type == LATM_SYNCWORD_EXT_SBR)
         {
           /* [ISO standard] GetAudioObjectType() */
 
@@ -1085,7 +990,7 @@ static int32_t
                 /* [ISO standard] sbrPresentFlag processing. */
 
                 ptr_stream_mux_config->info_stream_id[ptr_info->stream_cnt].
-                  asc.sbr_present_flag = bitReadLessByte(ptr_info, 1);
+                  asc.sbr_present_flag = bitRead(ptr_info, 1);
                 bit_length++;
 
                 /* [ISO standard] Check acquisition SBR flag. */
@@ -1101,7 +1006,7 @@ static int32_t
                     ptr_stream_mux_config->
                       info_stream_id[ptr_info->stream_cnt].
                         asc.extension_sampling_frequency_index =
-                          bitReadLessByte(ptr_info, 4);
+                          bitRead(ptr_info, 4);
                     bit_length += 4;
                   }
                 else
@@ -1132,7 +1037,7 @@ static int32_t
                     ptr_stream_mux_config->
                       info_stream_id[ptr_info->stream_cnt].
                         asc.extension_sampling_frequency =
-                          bitReadLessLong(ptr_info, 24);
+                          bitRead(ptr_info, 24);
                     bit_length += 24;
                   }
 
@@ -1146,7 +1051,7 @@ static int32_t
                      * According to the ISO standard, nextbits () is not used.
                      */
 
-                    sync_ext_type = bitReadLessLong(ptr_info, 11);
+                    sync_ext_type = bitRead(ptr_info, 11);
                     bit_length += 11;
                     if (sync_ext_type == LATM_SYNCWORD_EXT_PS)
                       {
@@ -1155,7 +1060,7 @@ static int32_t
                         ptr_stream_mux_config->
                           info_stream_id[ptr_info->stream_cnt].
                             asc.ps_present_flag =
-                              bitReadLessByte(ptr_info, 1);
+                              bitRead(ptr_info, 1);
                         bit_length++;
                       }
                   }
@@ -1216,7 +1121,7 @@ static int32_t isoPayloadLengthInfo(LatmLocalInfo *ptr_info,
                   uint8_t tmp = 0;
                   do
                     {
-                      tmp = bitReadLessByte(ptr_info, 8);
+                      tmp = bitRead(ptr_info, 8);
                       dummy_length += 8;
 
                       /* [ISO standard] MuxSlotLengthBytes processing*/
@@ -1255,14 +1160,14 @@ static int32_t isoPayloadLengthInfo(LatmLocalInfo *ptr_info,
     {
       /* [ISO standard] numChunk processing. */
 
-      ptr_chunk_info->num_chunk = bitReadLessByte(ptr_info, 4);
+      ptr_chunk_info->num_chunk = bitRead(ptr_info, 4);
       dummy_length += 4;
 
       for (i = 0; i <= (int32_t)ptr_chunk_info->num_chunk; i++)
         {
           /* [ISO standard] streamIndx processing. */
 
-          uint8_t tmp = bitReadLessByte(ptr_info, 4);
+          uint8_t tmp = bitRead(ptr_info, 4);
           dummy_length += 4;
           uint8_t prog = ptr_stream_mux_config->prog_stream_indx[tmp];
           uint8_t lay = ptr_stream_mux_config->lay_stream_indx[tmp];
@@ -1297,7 +1202,7 @@ static int32_t isoPayloadLengthInfo(LatmLocalInfo *ptr_info,
                     {
                       /* [ISO standard] tmp processing. */
 
-                      tmp = bitReadLessByte(ptr_info, 8);
+                      tmp = bitRead(ptr_info, 8);
                       dummy_length += 8;
                       ptr_stream_mux_config->
                         info_stream_id[(ptr_chunk_info->stream_cnt_chunk[i])].
@@ -1307,7 +1212,7 @@ static int32_t isoPayloadLengthInfo(LatmLocalInfo *ptr_info,
 
                   /* [ISO standard] AuEndFlag processing. */
 
-                  tmp = bitReadLessByte(ptr_info, 1);
+                  tmp = bitRead(ptr_info, 1);
                   dummy_length += 1;
                 }
                 break;
@@ -1471,7 +1376,7 @@ static int32_t isoStreamMuxConfig(LatmLocalInfo *ptr_info,
 
   /* [ISO standard] audioMuxVersion processing. */
 
-  ptr_stream_mux_config->audio_muxversion = bitReadLessByte(ptr_info, 1);
+  ptr_stream_mux_config->audio_muxversion = bitRead(ptr_info, 1);
 
   if (!ptr_stream_mux_config->audio_muxversion)
     {
@@ -1482,7 +1387,7 @@ static int32_t isoStreamMuxConfig(LatmLocalInfo *ptr_info,
       /* [ISO standard] audioMuxVersionA processing. */
 
       ptr_stream_mux_config->audio_muxversion_a =
-        bitReadLessByte(ptr_info, 1);
+        bitRead(ptr_info, 1);
     }
 
   int32_t dummy_length = 0;
@@ -1506,15 +1411,15 @@ static int32_t isoStreamMuxConfig(LatmLocalInfo *ptr_info,
       /* [ISO standard] allStreamsSameTimeFraming processing. */
 
       ptr_stream_mux_config->all_streams_sametime_framing =
-        bitReadLessByte(ptr_info, 1);
+        bitRead(ptr_info, 1);
 
       /* [ISO standard] numSubFrames processing. */
 
-      ptr_stream_mux_config->num_sub_frames = bitReadLessByte(ptr_info, 6);
+      ptr_stream_mux_config->num_sub_frames = bitRead(ptr_info, 6);
 
       /* [ISO standard] numProgram processing. */
 
-      ptr_stream_mux_config->num_program = bitReadLessByte(ptr_info, 4);
+      ptr_stream_mux_config->num_program = bitRead(ptr_info, 4);
 
       ptr_stream_mux_config->info_stream_id[ptr_info->stream_cnt].
         stream_id = (-1);
@@ -1526,7 +1431,7 @@ static int32_t isoStreamMuxConfig(LatmLocalInfo *ptr_info,
           /* [ISO standard] numLayer processing. */
 
           ptr_stream_mux_config->num_layer[ptr_info->stream_cnt] =
-            bitReadLessByte(ptr_info, 3);
+            bitRead(ptr_info, 3);
 
           /* Although it is the upper limit value of the loop,
            * since stream_cnt changes within the loop, use another variable.
@@ -1571,7 +1476,7 @@ static int32_t isoStreamMuxConfig(LatmLocalInfo *ptr_info,
 
                   ptr_stream_mux_config->
                     info_stream_id[ptr_info->stream_cnt].use_same_config =
-                      bitReadLessByte(ptr_info, 1);
+                      bitRead(ptr_info, 1);
                 }
 
               /* [ISO standard] When AudioSpecificConfig exists. */
@@ -1642,8 +1547,8 @@ static int32_t isoStreamMuxConfig(LatmLocalInfo *ptr_info,
                                       LATM_BIT_OF_LONG); i++)
                                 {
                                   dummy_read =
-                                    bitReadLessLong(ptr_info,
-                                                    LATM_BIT_OF_LONG);
+                                    bitRead(ptr_info,
+                                            LATM_BIT_OF_LONG);
                                 }
                             }
 
@@ -1652,9 +1557,9 @@ static int32_t isoStreamMuxConfig(LatmLocalInfo *ptr_info,
                           if (asc_length % LATM_BIT_OF_LONG)
                             {
                               dummy_read =
-                                bitReadLessLong(ptr_info,
-                                                (asc_length %
-                                                LATM_BIT_OF_LONG));
+                                bitRead(ptr_info,
+                                        (asc_length %
+                                        LATM_BIT_OF_LONG));
                             }
                         }
                     }
@@ -1681,7 +1586,7 @@ static int32_t isoStreamMuxConfig(LatmLocalInfo *ptr_info,
 
               ptr_stream_mux_config->
                 info_stream_id[ptr_info->stream_cnt].frame_length_type =
-                  bitReadLessByte(ptr_info, 3);
+                  bitRead(ptr_info, 3);
 
               /* [ISO standard] Sort by FrameLengthType. */
 
@@ -1693,7 +1598,7 @@ static int32_t isoStreamMuxConfig(LatmLocalInfo *ptr_info,
 
                     ptr_stream_mux_config->
                       info_stream_id[ptr_info->stream_cnt].
-                        latm_buffer_fullness = bitReadLessByte(ptr_info, 8);
+                        latm_buffer_fullness = bitRead(ptr_info, 8);
                     if (!ptr_stream_mux_config->all_streams_sametime_framing)
                       {
                         if ((ptr_stream_mux_config->
@@ -1726,7 +1631,7 @@ static int32_t isoStreamMuxConfig(LatmLocalInfo *ptr_info,
 
                     ptr_stream_mux_config->
                       info_stream_id[ptr_info->stream_cnt].frame_length =
-                        bitReadLessLong(ptr_info, 9);
+                        bitRead(ptr_info, 9);
 
                     /* Clear unused items. */
 
@@ -1780,7 +1685,7 @@ static int32_t isoStreamMuxConfig(LatmLocalInfo *ptr_info,
       /* [ISO standard] otherDataPresent processing. */
 
       ptr_stream_mux_config->other_data_present =
-        bitReadLessByte(ptr_info, 1);
+        bitRead(ptr_info, 1);
       if (ptr_stream_mux_config->other_data_present)
         {
           if (ptr_stream_mux_config->audio_muxversion)
@@ -1801,12 +1706,12 @@ static int32_t isoStreamMuxConfig(LatmLocalInfo *ptr_info,
 
                   /* [ISO standard] otherDataLenEsc processing. */
 
-                  dummy_read = bitReadLessByte(ptr_info, 1);
+                  dummy_read = bitRead(ptr_info, 1);
 
                   /* [ISO standard] otherDataLenTmp processing. */
 
                   ptr_stream_mux_config->other_data_len_bits +=
-                    bitReadLessByte(ptr_info, 8);
+                    bitRead(ptr_info, 8);
                 }
               while (dummy_read);
             }
@@ -1820,12 +1725,12 @@ static int32_t isoStreamMuxConfig(LatmLocalInfo *ptr_info,
 
       /* [ISO standard] crcCheckPresent processing. */
 
-      dummy_read = bitReadLessByte(ptr_info, 1);
+      dummy_read = bitRead(ptr_info, 1);
       if (dummy_read)
         {
           /* [ISO standard] crcCheckSum processing. */
 
-          dummy_read = bitReadLessByte(ptr_info, 8);
+          dummy_read = bitRead(ptr_info, 8);
         }
     }
   else
@@ -1853,14 +1758,13 @@ static int32_t isoAudioMuxElement(LatmLocalInfo *ptr_info,
 
   /* [ISO standard] Check the first bit. */
 
-  if (!(*(ptr_info->ptr_check_latm) & 0x80))
-    {
-      /* UseSameStreamMux processing. */
-
-      ptr_info->total_bit_length++;
-      rtn_length++;
+  uint32_t use_same_stream_mux = bitRead(ptr_info, 1);
+  rtn_length++;
 
-      /* Set information in StreamMuxConfig to local table. */
+  if (!use_same_stream_mux)
+    {
+      /* UseSameStreamMux processing.
+       * Set information in StreamMuxConfig to local table. */
 
       dummy_length = isoStreamMuxConfig(ptr_info, ptr_stream_mux_config);
       if (dummy_length == LOCAL_CHECK_NG)
@@ -1876,9 +1780,6 @@ static int32_t isoAudioMuxElement(LatmLocalInfo *ptr_info,
     }
   else
     {
-      ptr_info->total_bit_length++;
-      rtn_length++;
-
       /* Check if there is StreamMuxConfig information for the last time. */
 
       if ((ptr_stream_mux_config->max_stream_id < LATM_MIN_STREAM_ID) ||
@@ -1953,26 +1854,71 @@ static int32_t isoAudioMuxElement(LatmLocalInfo *ptr_info,
 }
 
 /*--------------------------------------------------------------------------*/
-uint8_t *AACLC_getNextLatm(uint8_t *ptr_readbuff,
-                           InfoStreamMuxConfig *ptr_stream_mux_config)
+static bool isLoasFollowed(uint8_t *ptr_readbuff,
+                           uint32_t readbuff_size,
+                           uint32_t next)
 {
-  LatmLocalInfo info;
+  for (uint32_t i = 0; i < LOAS_SYNC_CONFIRM; i++)
+    {
+      /* Headers out of the data can not be checked, so trusted. */
 
-  info.total_bit_length = 0;
-  info.ptr_check_latm = ptr_readbuff;
+      if (next + LOAS_HEADER_SIZE > readbuff_size)
+        {
+          return true;
+        }
 
-  /* Check LOAS.(If LOAS 2 bytes later LATM header) */
+      uint8_t *ptr_next = ptr_readbuff + next;
 
-  if (AACLC_checkLOAS(&info))
+      if (((((uint16_t)ptr_next[0] << 8) | ptr_next[1]) & LOAS_SYNC_MASK) !=
+            LOAS_SYNC_WORD ||
+          LOAS_GET_LENGTH(ptr_next) == 0)
+        {
+          return false;
+        }
+
+      next += LOAS_HEADER_SIZE + LOAS_GET_LENGTH(ptr_next);
+    }
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+static bool isLoasChainedTo(uint8_t *ptr_readbuff,
+                            uint32_t pos,
+                            uint32_t end)
+{
+  while (pos < end)
     {
-      info.ptr_check_latm = (ptr_readbuff + 2);
-      return info.ptr_check_latm;
+      uint8_t *ptr_frame = ptr_readbuff + pos;
+
+      if ((pos + LOAS_HEADER_SIZE > end) ||
+          ((((uint16_t)ptr_frame[0] << 8) | ptr_frame[1]) & LOAS_SYNC_MASK) !=
+            LOAS_SYNC_WORD ||
+          LOAS_GET_LENGTH(ptr_frame) == 0)
+        {
+          return false;
+        }
+
+      pos += LOAS_HEADER_SIZE + LOAS_GET_LENGTH(ptr_frame);
     }
 
-  /* When it is not LOAS.(syncword not found) */
+  return (pos == end);
+}
+
+/*--------------------------------------------------------------------------*/
+uint8_t *AACLC_getNextLatm(uint8_t *ptr_readbuff,
+                           uint32_t readbuff_size,
+                           InfoStreamMuxConfig *ptr_stream_mux_config)
+{
+  LatmLocalInfo info;
+
+  /* The payload is an AudioMuxElement (LATM without LOAS, as carried
+   * by A2DP). LOAS is not probed here, since a LATM frame whose first
+   * bits happen to form the LOAS syncword would be dropped.
+   * LOAS streams are synchronized by AACLC_findLoas().
+   */
 
-  info.total_bit_length = 0;
-  info.ptr_check_latm = ptr_readbuff;
+  bitInit(&info, ptr_readbuff, readbuff_size);
 
   /* [ISO standard] AudioMuxElement () processing. */
 
@@ -1991,6 +1937,79 @@ uint8_t *AACLC_getNextLatm(uint8_t *ptr_readbuff,
   return info.ptr_check_latm;
 }
 
+/*--------------------------------------------------------------------------*/
+uint8_t *AACLC_findLoas(uint8_t *ptr_readbuff,
+                        uint32_t readbuff_size,
+                        uint32_t *ptr_frame_size)
+{
+  uint32_t pos = 0;
+
+  while (pos + LOAS_HEADER_SIZE <= readbuff_size)
+    {
+      /* The 2 bytes syncword is found at most (size - 2), and 3 bytes
+       * of the header must be there.
+       */
+
+      pos += SyncWordScanner_find(ptr_readbuff + pos,
+                                  readbuff_size - pos - 1,
+                                  LOAS_SYNC_MASK,
+                                  LOAS_SYNC_WORD);
+      if (pos + LOAS_HEADER_SIZE > readbuff_size)
+        {
+          break;
+        }
+
+      uint8_t *ptr_frame  = ptr_readbuff + pos;
+      uint32_t frame_size = LOAS_HEADER_SIZE + LOAS_GET_LENGTH(ptr_frame);
+
+      /* An empty AudioMuxElement is not a frame, and the following
+       * frames must begin with a valid header too.
+       */
+
+      if ((frame_size > LOAS_HEADER_SIZE) &&
+          isLoasFollowed(ptr_readbuff, readbuff_size, pos + frame_size))
+        {
+          /* The frame may be a false one, such as a syncword in the
+           * payload or a cut frame, which leads into the stream over
+           * some real frames. Then the first frame within it whose
+           * frames end at the same place is taken instead.
+           */
+
+          uint32_t end   = pos + frame_size;
+          uint32_t inner = pos + 1;
+
+          while ((end <= readbuff_size) &&
+                 (inner + LOAS_HEADER_SIZE <= end))
+            {
+              inner += SyncWordScanner_find(ptr_readbuff + inner,
+                                            end - inner - 1,
+                                            LOAS_SYNC_MASK,
+                                            LOAS_SYNC_WORD);
+              if (inner + LOAS_HEADER_SIZE > end)
+                {
+                  break;
+                }
+
+              if (isLoasChainedTo(ptr_readbuff, inner, end))
+                {
+                  ptr_frame  = ptr_readbuff + inner;
+                  frame_size = LOAS_HEADER_SIZE + LOAS_GET_LENGTH(ptr_frame);
+                  break;
+                }
+
+              inner++;
+            }
+
+          *ptr_frame_size = frame_size;
+          return ptr_frame;
+        }
+
+      pos++;
+    }
+
+  return 0;
+}
+
 #ifdef LATMTEST_BY_CUNIT
 #  include "LatmTest_Wrapper"
 #endif
@@ -40,6 +40,7 @@
 
 #include "common/RamAdtsParser.h"
 #include "common/RamAdtsParser_Common.h"
+#include "common/SyncWordScanner.h"
 
 static uint8_t poll_buff[PARSER_LOCAL_POLL_BUFFERSIZE];
 
@@ -146,29 +147,38 @@ static int32_t adtsparser_peek_data(AdtsHandle *pHandle,
 }
 
 /*--------------------------------------------------------------------------*/
-static int32_t adtsparser_syncword_search(uint8_t *pReadData,
-                                          uint8_t *syncword_idx)
+static int32_t adtsparser_syncword_search(AdtsHandle *pHandle)
 {
-  for (int i = 0; i < 2; i++)
+  CMN_SimpleFifoPeekHandle regions;
+
+  /* Scan all the data in the FIFO in place instead of peeking it
+   * a few bytes at a time.
+   * As before, nothing is searched until 3 bytes are stored, and then
+   * a syncword in the last 2 bytes is accepted (the former loop found
+   * it by peeking 3 bytes from the byte before it).
+   */
+
+  size_t occupied_size =
+    CMN_SimpleFifoGetReadRegions(pHandle->pSimpleFifoHandler, &regions);
+  if (occupied_size < ADTSPARSER_SYNCWORD_SEARCH_SIZE)
     {
-      if (ADTS_CHECK_SYNCWORD(*(pReadData+(i)), *(pReadData+(i + 1))) ==
-           ADTS_OK)
-        {
-          /* Because it is conceivable that a coincident sync word matches,
-           * check the following data.
-           */
-
-          uint8_t consistency_check;
-          consistency_check = *(pReadData+(i + 1));
-          if (((consistency_check & 0x0F) == 1) ||
-               ((consistency_check & 0x0F) == 0))
-            {
-              *syncword_idx = i;
-              return AdtsParserNormal;
-            }
-        }
+      return AdtsParserConnotDataAccess;
+    }
+
+  uint32_t pos = SyncWordScanner_findSplit(regions.m_pChunk[0],
+                                           regions.m_szChunk[0],
+                                           regions.m_pChunk[1],
+                                           regions.m_szChunk[1],
+                                           pHandle->search_pos,
+                                           ADTSPARSER_SYNCWORD_MASK,
+                                           ADTSPARSER_SYNCWORD_PATTERN);
+  if (pos >= occupied_size)
+    {
+      return AdtsParserConnotDataAccess;
     }
-  return AdtsParserCannotGetHeader;
+  pHandle->search_pos = pos;
+
+  return AdtsParserNormal;
 }
 
 /*--------------------------------------------------------------------------*/
@@ -220,33 +230,14 @@ int32_t AdtsParser_ReadFrame(AdtsHandle *pHandle,
       size_t occupied_size = 0;
       pHandle->current_pos = 0;
       pHandle->search_pos  = 0;
-      while (1)
+      if (adtsparser_syncword_search(pHandle) != AdtsParserNormal)
         {
-          int32_t rst = adtsparser_peek_data(pHandle,
-                                             poll_buff,
-                                             ADTSPARSER_SYNCWORD_SEARCH_SIZE);
-          if (rst != AdtsParserNormal)
-            {
-              occupied_size =
-                CMN_SimpleFifoGetOccupiedSize(pHandle->pSimpleFifoHandler);
-              pHandle->parse_size = occupied_size;
-              adtsparser_skip_data(pHandle, poll_buff);
-              *uipErrDetail = AdtsParserConnotDataAccess;
-              return rc;
-            }
-          pHandle->search_pos++;
-          pHandle->current_pos = pHandle->search_pos;
-
-          uint8_t syncword_idx;
-          if (adtsparser_syncword_search(poll_buff, &syncword_idx) ==
-               AdtsParserNormal)
-            {
-              if (syncword_idx == 0)
-                {
-                  pHandle->search_pos = (pHandle->search_pos - 1);
-                }
-              break;
-            }
+          occupied_size =
+            CMN_SimpleFifoGetOccupiedSize(pHandle->pSimpleFifoHandler);
+          pHandle->parse_size = occupied_size;
+          adtsparser_skip_data(pHandle, poll_buff);
+          *uipErrDetail = AdtsParserConnotDataAccess;
+          return rc;
         }
       if (pHandle->search_pos != 0)
         {
@@ -382,26 +373,10 @@ int32_t AdtsParser_GetSamplingRate(AdtsHandle *pHandle,
     {
       pHandle->current_pos = 0;
       pHandle->search_pos  = 0;
-      while (1)
+      if (adtsparser_syncword_search(pHandle) != AdtsParserNormal)
         {
-          if (adtsparser_peek_data(pHandle, poll_buff, 3) != AdtsParserNormal)
-            {
-              *uipErrDetail = AdtsParserConnotDataAccess;
-              return rc;
-            }
-          pHandle->search_pos++;
-          pHandle->current_pos = pHandle->search_pos;
-
-          uint8_t syncword_idx;
-          if (adtsparser_syncword_search(poll_buff, &syncword_idx) ==
-               AdtsParserNormal)
-            {
-              if (syncword_idx == 0)
-                {
-                  pHandle->search_pos = (pHandle->search_pos - 1);
-                }
-              break;
-            }
+          *uipErrDetail = AdtsParserConnotDataAccess;
+          return rc;
         }
 
       /* Read header information. */
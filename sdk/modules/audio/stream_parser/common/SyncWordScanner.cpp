@@ -0,0 +1,167 @@
+/****************************************************************************
+ * modules/audio/stream_parser/common/SyncWordScanner.cpp
+ *
+ *   Copyright 2026 Sony Semiconductor Solutions Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Semiconductor Solutions Corporation nor
+ *    the names of its contributors may be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include <string.h>
+
+#include "common/SyncWordScanner.h"
+
+/* Helpers of the word-at-a-time search. */
+
+#define SYNCWORD_SCANNER_ONES   0x01010101u
+#define SYNCWORD_SCANNER_HIGHS  0x80808080u
+#define SYNCWORD_SCANNER_WORD   sizeof(uint32_t)
+
+/*--------------------------------------------------------------------------*/
+static inline bool syncword_scanner_match(const uint8_t *ptr,
+                                          uint16_t mask,
+                                          uint16_t word)
+{
+  return ((((uint16_t)ptr[0] << 8) | ptr[1]) & mask) == word;
+}
+
+/*--------------------------------------------------------------------------*/
+uint32_t SyncWordScanner_find(const uint8_t *buf,
+                              uint32_t size,
+                              uint16_t mask,
+                              uint16_t word)
+{
+  if (size < 2)
+    {
+      return size;
+    }
+
+  /* Offsets 0 .. (last - 1) can hold a whole syncword. */
+
+  uint32_t last = size - 1;
+  uint32_t i = 0;
+
+  if ((mask & 0xFF00) == 0xFF00)
+    {
+      /* The 1st byte of the syncword is fixed. XOR a word of data with
+       * the 1st byte repeated in every lane, and a lane becomes zero
+       * only where the 1st byte is. Words without a zero lane are skipped
+       * as a whole.
+       */
+
+      uint32_t lead = (uint32_t)(word >> 8) * SYNCWORD_SCANNER_ONES;
+
+      /* Walk byte by byte up to a word boundary. */
+
+      for (; (i < last) && ((uintptr_t)(buf + i) % SYNCWORD_SCANNER_WORD);
+           i++)
+        {
+          if (syncword_scanner_match(buf + i, mask, word))
+            {
+              return i;
+            }
+        }
+
+      for (; (i + SYNCWORD_SCANNER_WORD) <= last; i += SYNCWORD_SCANNER_WORD)
+        {
+          uint32_t lanes;
+          memcpy(&lanes, buf + i, SYNCWORD_SCANNER_WORD);
+          lanes ^= lead;
+
+          if (((lanes - SYNCWORD_SCANNER_ONES) & ~lanes &
+               SYNCWORD_SCANNER_HIGHS) == 0)
+            {
+              continue;
+            }
+
+          for (uint32_t j = 0; j < SYNCWORD_SCANNER_WORD; j++)
+            {
+              if (syncword_scanner_match(buf + i + j, mask, word))
+                {
+                  return i + j;
+                }
+            }
+        }
+    }
+
+  for (; i < last; i++)
+    {
+      if (syncword_scanner_match(buf + i, mask, word))
+        {
+          return i;
+        }
+    }
+
+  return size;
+}
+
+/*--------------------------------------------------------------------------*/
+uint32_t SyncWordScanner_findSplit(const uint8_t *buf0,
+                                   uint32_t size0,
+                                   const uint8_t *buf1,
+                                   uint32_t size1,
+                                   uint32_t offset,
+                                   uint16_t mask,
+                                   uint16_t word)
+{
+  uint32_t total = size0 + size1;
+
+  if (offset < size0)
+    {
+      uint32_t pos = offset +
+        SyncWordScanner_find(buf0 + offset, size0 - offset, mask, word);
+      if (pos < size0)
+        {
+          return pos;
+        }
+
+      /* Check the syncword straddling the two regions. */
+
+      if (size1 > 0)
+        {
+          uint8_t edge[2] = { buf0[size0 - 1], buf1[0] };
+          if (syncword_scanner_match(edge, mask, word))
+            {
+              return size0 - 1;
+            }
+        }
+
+      offset = size0;
+    }
+
+  if (offset < total)
+    {
+      return offset + SyncWordScanner_find(buf1 + (offset - size0),
+                                           total - offset,
+                                           mask,
+                                           word);
+    }
+
+  return total;
+}
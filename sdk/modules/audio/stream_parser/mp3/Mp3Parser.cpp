@@ -39,6 +39,7 @@
 #include <string.h>
 
 #include "common/Mp3Parser.h"
+#include "common/SyncWordScanner.h"
 
 /*--------------------------------------------------------------------------*/
 static inline
@@ -110,6 +111,7 @@ static inline
             }
         }
     }
+  ptr_hndl->seek.stream_offset += ptr_hndl->current_offset;
   return Mp3ParserReturnFileFavorable;
 }
 
@@ -131,6 +133,7 @@ static inline
     {
       return Mp3ParserReturnFileAccesError;
     }
+  ptr_hndl->seek.stream_offset += size;
 
   return Mp3ParserReturnFileFavorable;
 }
@@ -150,85 +153,87 @@ static Mp3ParserReturnValueOfSyncSearch
     }
 
   uint32_t i = 0;
-  for (i = 0, ptr_check = ptr_info->ptr_start;
-        i < (ptr_info->max_search_byte - MP3PARSER_SYNCWORD_LENGTH);
-          i++, ptr_check++)
+  uint32_t search_size =
+    (ptr_info->max_search_byte - MP3PARSER_SYNCWORD_LENGTH) + 1;
+  for (i = 0; i < (ptr_info->max_search_byte - MP3PARSER_SYNCWORD_LENGTH);
+        i++)
     {
-      /* Check 1st byte. */
+      /* Jump to the next position where 1st and 2nd byte match. */
 
-      if ((*ptr_check & MP3PARSER_SYNCWORD_1) == MP3PARSER_SYNCWORD_1)
+      i += SyncWordScanner_find(ptr_info->ptr_start + i,
+                                search_size - i,
+                                MP3PARSER_SYNCWORD_MASK,
+                                MP3PARSER_SYNCWORD_PATTERN);
+      if (i >= (ptr_info->max_search_byte - MP3PARSER_SYNCWORD_LENGTH))
         {
-          /* When 1st byte matches, 2nd byte is checked. */
+          break;
+        }
+      ptr_check = ptr_info->ptr_start + i;
 
-          if ((*(ptr_check + 1) & MP3PARSER_SYNCWORD_2) ==
-               MP3PARSER_SYNCWORD_2)
-            {
-              /* When the 2nd byte matches, check the information
-               * in the header.
-               */
+      /* When the 1st and 2nd byte match, check the information
+       * in the header.
+       */
 
-              ptr_info->uhd.copy_byte[0] = *ptr_check;
-              ptr_info->uhd.copy_byte[1] = *(ptr_check + 1);
-              ptr_info->uhd.copy_byte[2] = *(ptr_check + 2);
-              ptr_info->uhd.copy_byte[3] = *(ptr_check + 3);
-
-              /*  Check data integrity. */
-
-              if (MP3PARSER_GET_LAYER(ptr_info->uhd.copy_byte[1]) ==
-                   Mp3ParserLayerReserved)
-                {
-                  /* As layer is reserved, continue syncword search. */
-
-                  continue;
-                }
-              if (MP3PARSER_GET_FS(ptr_info->uhd.copy_byte[2]) ==
-                   MP3PARSER_FS_RESERVED)
-                {
-                  /* As sampling_frequency is reserved,
-                   * continue syncword search.
-                   */
-
-                  continue;
-                }
-              if ((MP3PARSER_GET_BR(ptr_info->uhd.copy_byte[2]) ==
-                   MP3PARSER_BITRATE_FREE) ||
-                   (MP3PARSER_GET_BR(ptr_info->uhd.copy_byte[2]) ==
-                   MP3PARSER_BITRATE_UNUSED))
-                {
-                  /* As bitrate_index is free or unused,
-                   * continue syncword search.
-                   */
-
-                  continue;
-                }
-              if (MP3PARSER_GET_PRIVATE(ptr_info->uhd.copy_byte[2]) ==
-                   MP3PARSER_PRIVATEBIT_ISOUSED)
-                {
-                  /* Since unusable private_bit is used,
-                   * continue syncword search.
-                   */
-
-                  continue;
-                }
-              if (MP3PARSER_GET_EMPHAS(ptr_info->uhd.copy_byte[3]) ==
-                   MP3PARSER_EMPHASIS_RESERVED)
-                {
-                  /* As emphasis is reserved, continue syncword search. */
-
-                  continue;
-                }
-
-              /* If you come this far, you are certified as a syncword for
-               * mp3 for the time being.
-               * Set the offset from the beginning.
-               */
+      ptr_info->uhd.copy_byte[0] = *ptr_check;
+      ptr_info->uhd.copy_byte[1] = *(ptr_check + 1);
+      ptr_info->uhd.copy_byte[2] = *(ptr_check + 2);
+      ptr_info->uhd.copy_byte[3] = *(ptr_check + 3);
 
-             ptr_info->found_offset =
-                (uint32_t)(ptr_check - ptr_info->ptr_start);
-              exist_syncword = true;
-              break;
-            }
+      /*  Check data integrity. */
+
+      if (MP3PARSER_GET_LAYER(ptr_info->uhd.copy_byte[1]) ==
+           Mp3ParserLayerReserved)
+        {
+          /* As layer is reserved, continue syncword search. */
+
+          continue;
+        }
+      if (MP3PARSER_GET_FS(ptr_info->uhd.copy_byte[2]) ==
+           MP3PARSER_FS_RESERVED)
+        {
+          /* As sampling_frequency is reserved,
+           * continue syncword search.
+           */
+
+          continue;
+        }
+      if ((MP3PARSER_GET_BR(ptr_info->uhd.copy_byte[2]) ==
+           MP3PARSER_BITRATE_FREE) ||
+           (MP3PARSER_GET_BR(ptr_info->uhd.copy_byte[2]) ==
+           MP3PARSER_BITRATE_UNUSED))
+        {
+          /* As bitrate_index is free or unused,
+           * continue syncword search.
+           */
+
+          continue;
         }
+      if (MP3PARSER_GET_PRIVATE(ptr_info->uhd.copy_byte[2]) ==
+           MP3PARSER_PRIVATEBIT_ISOUSED)
+        {
+          /* Since unusable private_bit is used,
+           * continue syncword search.
+           */
+
+          continue;
+        }
+      if (MP3PARSER_GET_EMPHAS(ptr_info->uhd.copy_byte[3]) ==
+           MP3PARSER_EMPHASIS_RESERVED)
+        {
+          /* As emphasis is reserved, continue syncword search. */
+
+          continue;
+        }
+
+      /* If you come this far, you are certified as a syncword for
+       * mp3 for the time being.
+       * Set the offset from the beginning.
+       */
+
+      ptr_info->found_offset =
+        (uint32_t)(ptr_check - ptr_info->ptr_start);
+      exist_syncword = true;
+      break;
     }
 
   if (!exist_syncword)
@@ -279,6 +284,39 @@ static Mp3ParserReturnValueOfSyncSearch
   return Mp3ParserReturnFoundSyncword;
 }
 
+/*--------------------------------------------------------------------------*/
+static uint32_t skip_mp3parser_search_sync(MP3PARSER_Handle *ptr_hndl,
+                                           uint32_t search_offset)
+{
+  CMN_SimpleFifoPeekHandle regions;
+
+  /* Find the next candidate of syncword in the FIFO in place, so that
+   * the data without any syncword is not copied out window by window.
+   */
+
+  size_t occupied_size =
+    CMN_SimpleFifoGetReadRegions(ptr_hndl->src.simple_fifo_handler,
+                                 &regions);
+  if (occupied_size < (search_offset + MP3PARSER_LOCAL_READFILE_BUFFERSIZE))
+    {
+      return search_offset;
+    }
+
+  uint32_t candidate = SyncWordScanner_findSplit(regions.m_pChunk[0],
+                                                 regions.m_szChunk[0],
+                                                 regions.m_pChunk[1],
+                                                 regions.m_szChunk[1],
+                                                 search_offset,
+                                                 MP3PARSER_SYNCWORD_MASK,
+                                                 MP3PARSER_SYNCWORD_PATTERN);
+
+  /* Keep a whole window readable, as the last window did before. */
+
+  uint32_t last_window = occupied_size - MP3PARSER_LOCAL_READFILE_BUFFERSIZE;
+
+  return (candidate < last_window) ? candidate : last_window;
+}
+
 /*--------------------------------------------------------------------------*/
 static Mp3ParserReturnValueOfSyncSearch
   loopbuffer_mp3parser_search_sync(MP3PARSER_Handle *ptr_hndl,
@@ -292,6 +330,10 @@ static Mp3ParserReturnValueOfSyncSearch
 
   do
     {
+      ptr_info->search_offset =
+        skip_mp3parser_search_sync(ptr_hndl, ptr_info->search_offset);
+      ptr_hndl->current_offset = ptr_info->search_offset;
+
       if (peekbuffer_mp3parser(ptr_hndl,
                                &local_buff[0],
                                MP3PARSER_LOCAL_READFILE_BUFFERSIZE) !=
@@ -661,6 +703,335 @@ Mp3ParserReturnValueOfSyncSearch
   return status;
 }
 
+/*--------------------------------------------------------------------------*/
+static inline uint32_t mp3parser_get_be32(const uint8_t *ptr)
+{
+  return ((uint32_t)ptr[0] << 24) | ((uint32_t)ptr[1] << 16) |
+         ((uint32_t)ptr[2] << 8) | (uint32_t)ptr[3];
+}
+
+/*--------------------------------------------------------------------------*/
+static inline uint32_t mp3parser_get_be(const uint8_t *ptr, uint32_t len)
+{
+  uint32_t val = 0;
+  for (uint32_t i = 0; i < len; i++)
+    {
+      val = (val << 8) | ptr[i];
+    }
+  return val;
+}
+
+/*--------------------------------------------------------------------------*/
+static void mp3parser_set_stream_info(MP3PARSER_SeekInfo *ptr_seek,
+                                      const Mp3ParserUnionHead *ptr_uhd)
+{
+  uint8_t  id     = MP3PARSER_GET_ID(ptr_uhd->copy_byte[1]);
+  uint8_t  layer  = MP3PARSER_GET_LAYER(ptr_uhd->copy_byte[1]);
+  uint8_t  br_idx = MP3PARSER_GET_BR(ptr_uhd->copy_byte[2]);
+  uint8_t  fs_idx = MP3PARSER_GET_FS(ptr_uhd->copy_byte[2]);
+
+  if (id == Mp3ParserMpeg1)
+    {
+      ptr_seek->sampling_rate     = mp3_parser_v1_sampling_frequency[fs_idx];
+      ptr_seek->samples_per_frame = mp3_parser_v1_num_samples_frame[layer];
+      ptr_seek->bitrate           = mp3_parser_v1_bitrate[layer][br_idx];
+    }
+  else
+    {
+      ptr_seek->sampling_rate     = mp3_parser_v2_sampling_frequency[fs_idx];
+      ptr_seek->samples_per_frame = mp3_parser_v2_num_samples_frame[layer];
+      ptr_seek->bitrate           = mp3_parser_v2_bitrate[layer][br_idx];
+    }
+}
+
+/*--------------------------------------------------------------------------*/
+static void mp3parser_check_lame(MP3PARSER_Handle *ptr_hndl,
+                                 MP3PARSER_SeekInfo *ptr_seek,
+                                 uint32_t lame_offset)
+{
+  uint8_t local_buff[MP3PARSER_LAME_TAG_LEN];
+
+  ptr_hndl->current_offset = lame_offset;
+  if (peekbuffer_mp3parser(ptr_hndl, &local_buff[0], sizeof(local_buff)) !=
+       Mp3ParserReturnFileFavorable)
+    {
+      return;
+    }
+
+  /* Encoders based on libmp3lame (incl. FFmpeg) write the same tag. */
+
+  if (memcmp(&local_buff[0], "LAME", 4) &&
+      memcmp(&local_buff[0], "Lavf", 4) &&
+      memcmp(&local_buff[0], "Lavc", 4))
+    {
+      return;
+    }
+
+  uint32_t val = mp3parser_get_be(&local_buff[MP3PARSER_LAME_DELAY_OFFSET], 3);
+
+  ptr_seek->enc_delay   = (uint16_t)(val >> 12);
+  ptr_seek->enc_padding = (uint16_t)(val & 0xfff);
+  ptr_seek->enc_info    = 1;
+}
+
+/*--------------------------------------------------------------------------*/
+static bool mp3parser_check_xing(MP3PARSER_Handle *ptr_hndl,
+                                 MP3PARSER_SeekInfo *ptr_seek,
+                                 uint32_t xing_offset)
+{
+  uint8_t local_buff[16]; /* tag(4) + flags(4) + frames(4) + bytes(4) */
+
+  ptr_hndl->current_offset = xing_offset;
+  if (peekbuffer_mp3parser(ptr_hndl, &local_buff[0], sizeof(local_buff)) !=
+       Mp3ParserReturnFileFavorable)
+    {
+      return false;
+    }
+
+  if (memcmp(&local_buff[0], "Xing", 4) && memcmp(&local_buff[0], "Info", 4))
+    {
+      return false;
+    }
+
+  uint32_t flags = mp3parser_get_be32(&local_buff[4]);
+  uint32_t pos   = 8;
+
+  if (flags & MP3PARSER_XING_FLAG_FRAMES)
+    {
+      ptr_seek->total_frames = mp3parser_get_be32(&local_buff[pos]);
+      pos += 4;
+    }
+  if (flags & MP3PARSER_XING_FLAG_BYTES)
+    {
+      ptr_seek->total_bytes = mp3parser_get_be32(&local_buff[pos]);
+      pos += 4;
+    }
+  if ((flags & MP3PARSER_XING_FLAG_TOC) && ptr_seek->total_bytes)
+    {
+      /* TOC is already in the same form as seek info. */
+
+      ptr_hndl->current_offset = xing_offset + pos;
+      if (peekbuffer_mp3parser(ptr_hndl,
+                               &ptr_seek->toc[0],
+                               MP3PARSER_TOC_NUM) ==
+           Mp3ParserReturnFileFavorable)
+        {
+          ptr_seek->toc_type = MP3PARSER_TOC_XING;
+        }
+    }
+  if (flags & MP3PARSER_XING_FLAG_TOC)
+    {
+      pos += MP3PARSER_TOC_NUM;
+    }
+  if (flags & MP3PARSER_XING_FLAG_QUALITY)
+    {
+      pos += 4;
+    }
+
+  mp3parser_check_lame(ptr_hndl, ptr_seek, xing_offset + pos);
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+static bool mp3parser_check_vbri(MP3PARSER_Handle *ptr_hndl,
+                                 MP3PARSER_SeekInfo *ptr_seek)
+{
+  uint8_t local_buff[MP3PARSER_LOCAL_READFILE_BUFFERSIZE];
+
+  /* tag(4) version(2) delay(2) quality(2) bytes(4) frames(4)
+   * entries(2) scale(2) entry_size(2) frames_per_entry(2)
+   */
+
+  const uint32_t head_len = 26;
+
+  ptr_hndl->current_offset = MP3PARSER_VBRI_OFFSET;
+  if (peekbuffer_mp3parser(ptr_hndl, &local_buff[0], head_len) !=
+       Mp3ParserReturnFileFavorable)
+    {
+      return false;
+    }
+
+  if (memcmp(&local_buff[0], "VBRI", 4))
+    {
+      return false;
+    }
+
+  ptr_seek->total_bytes  = mp3parser_get_be32(&local_buff[10]);
+  ptr_seek->total_frames = mp3parser_get_be32(&local_buff[14]);
+
+  uint32_t num   = mp3parser_get_be(&local_buff[18], 2);
+  uint32_t scale = mp3parser_get_be(&local_buff[20], 2);
+  uint32_t esize = mp3parser_get_be(&local_buff[22], 2);
+
+  if ((num == 0) || (num > MP3PARSER_VBRI_TOC_MAX) ||
+       (esize == 0) || (esize > 4) || (ptr_seek->total_bytes == 0))
+    {
+      return true;
+    }
+
+  /* Entries split the stream into equal durations, so convert the
+   * byte count of each entry to the 1% step TOC.
+   */
+
+  uint32_t per_read = sizeof(local_buff) / esize;
+  uint64_t sum = 0;
+  uint32_t percent = 0;
+  uint32_t entry = 0;
+
+  while (entry < num)
+    {
+      uint32_t cnt = (num - entry < per_read) ? (num - entry) : per_read;
+
+      ptr_hndl->current_offset =
+        MP3PARSER_VBRI_OFFSET + head_len + entry * esize;
+      if (peekbuffer_mp3parser(ptr_hndl, &local_buff[0], cnt * esize) !=
+           Mp3ParserReturnFileFavorable)
+        {
+          return true;
+        }
+
+      for (uint32_t i = 0; i < cnt; i++, entry++)
+        {
+          while ((percent < MP3PARSER_TOC_NUM) &&
+                  (percent * num / MP3PARSER_TOC_NUM <= entry))
+            {
+              uint64_t toc = (sum << 8) / ptr_seek->total_bytes;
+              ptr_seek->toc[percent++] = (toc > 255) ? 255 : (uint8_t)toc;
+            }
+          sum += (uint64_t)mp3parser_get_be(&local_buff[i * esize], esize) *
+                   scale;
+        }
+    }
+
+  ptr_seek->toc_type = MP3PARSER_TOC_VBRI;
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+static bool mp3parser_check_vbr_header(MP3PARSER_Handle *ptr_hndl,
+                                       Mp3ParserLocalInfo *ptr_info,
+                                       MP3PARSER_SeekInfo *ptr_seek)
+{
+  uint8_t copy_byte1 = ptr_info->uhd.copy_byte[1];
+  uint8_t copy_byte3 = ptr_info->uhd.copy_byte[3];
+
+  if (MP3PARSER_GET_LAYER(copy_byte1) != Mp3ParserLayer3)
+    {
+      return false;
+    }
+
+  /* Xing tag is placed after the side information,
+   * whose length depends on version and channel mode.
+   */
+
+  bool mono = (MP3PARSER_GET_MODE(copy_byte3) == 3);
+  uint32_t side_info_len = (MP3PARSER_GET_ID(copy_byte1) == Mp3ParserMpeg1) ?
+                             (mono ? 17 : 32) : (mono ? 9 : 17);
+
+  uint32_t temp_current_offset = ptr_hndl->current_offset;
+
+  bool found = mp3parser_check_xing(ptr_hndl,
+                                    ptr_seek,
+                                    MP3PARSER_HEADSIZE + side_info_len);
+  if (!found)
+    {
+      found = mp3parser_check_vbri(ptr_hndl, ptr_seek);
+    }
+
+  ptr_hndl->current_offset = temp_current_offset;
+
+  return found;
+}
+
+/*--------------------------------------------------------------------------*/
+static void mp3parser_add_index(MP3PARSER_SeekInfo *ptr_seek,
+                                uint32_t frame_offset)
+{
+  if ((!ptr_seek->index) || ptr_seek->index_suspend)
+    {
+      return;
+    }
+
+  if (ptr_seek->frame_count % ptr_seek->index_interval)
+    {
+      return;
+    }
+
+  if (ptr_seek->index_num == ptr_seek->index_size)
+    {
+      /* Thin out to every other entry and double the interval. */
+
+      uint32_t i = 0;
+      for (i = 0; i * 2 < ptr_seek->index_num; i++)
+        {
+          ptr_seek->index[i] = ptr_seek->index[i * 2];
+        }
+      ptr_seek->index_num = i;
+      ptr_seek->index_interval *= 2;
+
+      if (ptr_seek->frame_count % ptr_seek->index_interval)
+        {
+          return;
+        }
+    }
+
+  /* Only append. (Frames replayed after seeking back are indexed) */
+
+  if (ptr_seek->frame_count / ptr_seek->index_interval == ptr_seek->index_num)
+    {
+      ptr_seek->index[ptr_seek->index_num++] = frame_offset;
+    }
+}
+
+/*--------------------------------------------------------------------------*/
+static bool mp3parser_probe_1st_frame(MP3PARSER_Handle *ptr_hndl,
+                                      Mp3ParserLocalInfo *ptr_info,
+                                      MP3PARSER_SeekInfo *ptr_seek)
+{
+  /* It may be a Xing/VBRI frame which has no audio. */
+
+  mp3parser_set_stream_info(ptr_seek, &ptr_info->uhd);
+  ptr_seek->audio_offset = ptr_seek->stream_offset;
+  if (mp3parser_check_vbr_header(ptr_hndl, ptr_info, ptr_seek))
+    {
+      ptr_seek->audio_offset += ptr_info->frame_length_1;
+      ptr_seek->toc_offset = (ptr_seek->toc_type == MP3PARSER_TOC_XING) ?
+                               ptr_seek->stream_offset :
+                               ptr_seek->audio_offset;
+      return false;
+    }
+
+  return true;
+}
+
+/*--------------------------------------------------------------------------*/
+static void mp3parser_update_seek_info(MP3PARSER_Handle *ptr_hndl,
+                                       const MP3PARSER_SeekInfo *ptr_1st,
+                                       uint32_t frame_offset,
+                                       bool is_audio)
+{
+  MP3PARSER_SeekInfo *ptr_seek = &ptr_hndl->seek;
+
+  if (ptr_1st)
+    {
+      /* Take what was probed in the 1st frame, except the stream offset
+       * which the extraction advanced.
+       */
+
+      uint32_t stream_offset = ptr_seek->stream_offset;
+      *ptr_seek = *ptr_1st;
+      ptr_seek->stream_offset = stream_offset;
+    }
+
+  if (is_audio)
+    {
+      mp3parser_add_index(ptr_seek, frame_offset);
+      ptr_seek->frame_count++;
+    }
+}
+
 /*--------------------------------------------------------------------------*/
 int32_t  Mp3Parser_initialize(MP3PARSER_Handle *ptr_hndl,
                               CMN_SimpleFifoHandle *simple_fifo_handler,
@@ -680,6 +1051,9 @@ int32_t  Mp3Parser_initialize(MP3PARSER_Handle *ptr_hndl,
   ptr_hndl->current_offset          = MP3PARSER_DEFAULT_RAM_OFFSET;
   ptr_hndl->extraction_mode         = MP3PARSER_DEFAULT_EXTRACTION_MODE;
 
+  memset(&ptr_hndl->seek, 0, sizeof(ptr_hndl->seek));
+  ptr_hndl->seek.index_interval = 1;
+
   return MP3PARSER_SUCCESS;
 }
 
@@ -720,6 +1094,24 @@ int32_t  Mp3Parser_pollSingleFrame(MP3PARSER_Handle *ptr_hndl,
       return MP3PARSER_NO_OUTPUT_REGION;
     }
 
+  /* The Xing/VBRI header of the 1st frame is read while the frame is
+   * still in the FIFO, into a copy of seek information which is taken
+   * only when the frame is extracted.
+   */
+
+  uint32_t frame_offset = ptr_hndl->seek.stream_offset;
+  bool is_1st = (ptr_hndl->seek.sampling_rate == 0);
+  bool is_audio = true;
+  MP3PARSER_SeekInfo seek_1st;
+
+  if (is_1st)
+    {
+      seek_1st = ptr_hndl->seek;
+      is_audio = mp3parser_probe_1st_frame(ptr_hndl,
+                                           (Mp3ParserLocalInfo *)&local_info,
+                                           &seek_1st);
+    }
+
   /* Frame cutting out process. */
 
   *out_frame_size =
@@ -728,6 +1120,11 @@ int32_t  Mp3Parser_pollSingleFrame(MP3PARSER_Handle *ptr_hndl,
                             out_buffer);
   if (*out_frame_size != 0)
     {
+      mp3parser_update_seek_info(ptr_hndl,
+                                 (is_1st) ? &seek_1st : NULL,
+                                 frame_offset,
+                                 is_audio);
+
       *ready_to_extract_frames = MP3PARSER_NEXT_SYNC_FOUND;
       return MP3PARSER_SUCCESS;
     }
@@ -756,6 +1153,8 @@ int32_t  Mp3Parser_finalize(MP3PARSER_Handle *ptr_hndl)
   ptr_hndl->size_of_src                = 0;
   ptr_hndl->current_offset             = 0;
 
+  memset(&ptr_hndl->seek, 0, sizeof(ptr_hndl->seek));
+
   return MP3PARSER_SUCCESS;
 }
 
@@ -799,3 +1198,190 @@ int32_t  Mp3Parser_getSamplingRate(MP3PARSER_Handle *ptr_hndl,
 
   return MP3PARSER_SUCCESS;
 }
+
+/*--------------------------------------------------------------------------*/
+int32_t  Mp3Parser_setSeekIndex(MP3PARSER_Handle *ptr_hndl,
+                                uint32_t *index,
+                                uint32_t index_size,
+                                uint32_t interval,
+                                uint32_t num)
+{
+  if ((!ptr_hndl) || (!index && index_size) || (num > index_size))
+    {
+      return MP3PARSER_PARAMETER_ERROR;
+    }
+
+  ptr_hndl->seek.index          = index;
+  ptr_hndl->seek.index_size     = index_size;
+  ptr_hndl->seek.index_num      = num;
+  ptr_hndl->seek.index_interval = (interval) ? interval : 1;
+
+  return MP3PARSER_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------*/
+int32_t  Mp3Parser_getSeekIndex(MP3PARSER_Handle *ptr_hndl,
+                                uint32_t *ptr_interval,
+                                uint32_t *ptr_num)
+{
+  if ((!ptr_hndl) || (!ptr_interval) || (!ptr_num))
+    {
+      return MP3PARSER_PARAMETER_ERROR;
+    }
+
+  *ptr_interval = ptr_hndl->seek.index_interval;
+  *ptr_num      = ptr_hndl->seek.index_num;
+
+  return MP3PARSER_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------*/
+int32_t  Mp3Parser_getDuration(MP3PARSER_Handle *ptr_hndl,
+                               uint32_t file_size,
+                               uint32_t *ptr_duration_ms)
+{
+  if ((!ptr_hndl) || (!ptr_duration_ms))
+    {
+      return MP3PARSER_PARAMETER_ERROR;
+    }
+
+  MP3PARSER_SeekInfo *ptr_seek = &ptr_hndl->seek;
+
+  if (ptr_seek->sampling_rate == 0)
+    {
+      /* 1st frame is not extracted yet. */
+
+      return MP3PARSER_NO_FRAME_HEADER;
+    }
+
+  if (ptr_seek->total_frames)
+    {
+      *ptr_duration_ms =
+        (uint32_t)((uint64_t)ptr_seek->total_frames *
+                     ptr_seek->samples_per_frame * 1000 /
+                       ptr_seek->sampling_rate);
+    }
+  else if ((file_size > ptr_seek->audio_offset) && (ptr_seek->bitrate > 0))
+    {
+      /* No VBR header. Assume constant bitrate. */
+
+      *ptr_duration_ms =
+        (uint32_t)((uint64_t)(file_size - ptr_seek->audio_offset) * 8000 /
+                     ptr_seek->bitrate);
+    }
+  else
+    {
+      return MP3PARSER_NO_CAPABILITY;
+    }
+
+  return MP3PARSER_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------*/
+int32_t  Mp3Parser_getEncoderDelay(MP3PARSER_Handle *ptr_hndl,
+                                   uint32_t *ptr_delay,
+                                   uint32_t *ptr_padding)
+{
+  if ((!ptr_hndl) || (!ptr_delay) || (!ptr_padding))
+    {
+      return MP3PARSER_PARAMETER_ERROR;
+    }
+
+  if (ptr_hndl->seek.sampling_rate == 0)
+    {
+      /* 1st frame is not extracted yet. */
+
+      return MP3PARSER_NO_FRAME_HEADER;
+    }
+
+  if (!ptr_hndl->seek.enc_info)
+    {
+      return MP3PARSER_NO_CAPABILITY;
+    }
+
+  *ptr_delay   = ptr_hndl->seek.enc_delay;
+  *ptr_padding = ptr_hndl->seek.enc_padding;
+
+  return MP3PARSER_SUCCESS;
+}
+
+/*--------------------------------------------------------------------------*/
+int32_t  Mp3Parser_seekToTime(MP3PARSER_Handle *ptr_hndl,
+                              uint32_t time_ms,
+                              uint32_t *ptr_offset)
+{
+  if ((!ptr_hndl) || (!ptr_offset))
+    {
+      return MP3PARSER_PARAMETER_ERROR;
+    }
+
+  MP3PARSER_SeekInfo *ptr_seek = &ptr_hndl->seek;
+
+  if ((ptr_seek->sampling_rate == 0) || (ptr_seek->bitrate == 0))
+    {
+      return MP3PARSER_NO_FRAME_HEADER;
+    }
+
+  uint32_t frame =
+    (uint32_t)((uint64_t)time_ms * ptr_seek->sampling_rate /
+                 ((uint64_t)ptr_seek->samples_per_frame * 1000));
+  uint32_t pos = frame / ptr_seek->index_interval;
+  uint32_t offset = 0;
+
+  if (ptr_seek->index && (pos < ptr_seek->index_num))
+    {
+      /* Exact position from the frame offset index. */
+
+      frame  = pos * ptr_seek->index_interval;
+      offset = ptr_seek->index[pos];
+      ptr_seek->index_suspend = 0;
+    }
+  else if ((ptr_seek->toc_type != MP3PARSER_TOC_NONE) &&
+            ptr_seek->total_frames)
+    {
+      /* Interpolate between 1% points of the TOC. */
+
+      uint64_t scaled = (uint64_t)frame * MP3PARSER_TOC_NUM;
+      uint32_t percent = (uint32_t)(scaled / ptr_seek->total_frames);
+      uint64_t rem = scaled % ptr_seek->total_frames;
+
+      if (percent >= MP3PARSER_TOC_NUM)
+        {
+          frame  = ptr_seek->total_frames;
+          offset = ptr_seek->toc_offset + ptr_seek->total_bytes;
+        }
+      else
+        {
+          uint32_t lo = ptr_seek->toc[percent];
+          uint32_t hi = (percent + 1 < MP3PARSER_TOC_NUM) ?
+                          ptr_seek->toc[percent + 1] : 256;
+          uint64_t pos256 = (uint64_t)lo * ptr_seek->total_frames +
+                              (uint64_t)(hi - lo) * rem;
+          offset = ptr_seek->toc_offset +
+                     (uint32_t)(pos256 * ptr_seek->total_bytes /
+                       ((uint64_t)ptr_seek->total_frames << 8));
+        }
+      ptr_seek->index_suspend = 1;
+    }
+  else
+    {
+      /* Assume constant bitrate. */
+
+      offset = ptr_seek->audio_offset +
+                 (uint32_t)((uint64_t)frame * ptr_seek->samples_per_frame *
+                   ptr_seek->bitrate /
+                     ((uint64_t)MP3PARSER_BITLENGTH_BYTE *
+                       ptr_seek->sampling_rate));
+      ptr_seek->index_suspend = 1;
+    }
+
+  /* Extraction restarts from offset after the FIFO is refilled. */
+
+  ptr_seek->stream_offset  = offset;
+  ptr_seek->frame_count    = frame;
+  ptr_hndl->current_offset = 0;
+
+  *ptr_offset = offset;
+
+  return MP3PARSER_SUCCESS;
+}
@@ -0,0 +1,593 @@
+/****************************************************************************
+ * modules/audio/test/file_sink/file_sink_test.cpp
+ *
+ *   Copyright 2018 Sony Semiconductor Solutions Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Semiconductor Solutions Corporation nor
+ *    the names of its contributors may be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/* Host test of AudioRecorderFileSink on a simulated slow block device.
+ *
+ * write() of the test file is replaced by the one below, which sleeps
+ * for each write like an SD card, stalls periodically and can fail with
+ * ENOSPC. Written file is compared with the data given by the recorder,
+ * and WAV header is checked by WavContainerFormatParser, also while
+ * recording (as if power was lost).
+ *
+ *   $ make && ./file_sink_test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#include "objects/media_recorder/audio_recorder_file_sink.h"
+
+/* Writer and parser define chunk ids in different forms. */
+
+#undef CHUNKID_RF64
+#undef SUBCHUNKID_DS64
+#undef SUBCHUNKID_JUNK
+#undef SUBCHUNKID_FMT
+#undef SUBCHUNKID_DATA
+#undef CHUNKID_RIFF
+
+#include "container_format_lib/wav_containerformat_parser.h"
+
+using namespace Wien2;
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define TEST_FILE      "file_sink_test.out"
+#define SNAPSHOT_FILE  "file_sink_test.snap"
+
+#define WRITE_SIZE     4096
+#define BUFFER_SIZE    (64 * 1024)
+#define STALL_MSEC     20
+
+/* Device takes WRITE_USEC for each write and STALL_USEC for every
+ * STALL_PERIOD writes. Recorder gives a frame every FRAME_USEC.
+ */
+
+#define WRITE_USEC     1000
+#define STALL_USEC     40000
+#define STALL_PERIOD   20
+#define FRAME_USEC     1000
+
+#define CHECK(cond, ...) \
+  do \
+    { \
+      if (!(cond)) \
+        { \
+          printf("  NG: "); \
+          printf(__VA_ARGS__); \
+          printf("\n"); \
+          s_fail++; \
+        } \
+    } \
+  while (0)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct test_param_s
+{
+  uint32_t frame_size;
+  uint32_t frame_num;
+  uint32_t header_size;
+  uint32_t prealloc_size;
+  uint8_t  container;
+  uint32_t header_update_interval;
+  uint8_t  channel_num;
+  uint8_t  bit_width;
+
+  /* ENOSPC at this data write, -1 for none. */
+
+  int      fail_at;
+
+  /* File is copied before this data write, -1 for none. */
+
+  int      snapshot_at;
+};
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+int g_attention_err;
+int g_attention_warn;
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static int s_fail;
+
+/* Simulated device */
+
+static int s_data_writes;
+static int s_header_writes;
+static int s_unaligned_writes;
+static int s_short_writes;
+static int s_fail_at;
+static int s_snapshot_at;
+static bool s_snapshot_taken;
+
+static uint32_t s_callback_size;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/*--------------------------------------------------------------------------*/
+static void copy_file(const char *from, const char *to)
+{
+  FILE *in  = fopen(from, "rb");
+  FILE *out = fopen(to, "wb");
+  char buf[4096];
+  size_t n;
+
+  while (in != NULL && out != NULL && (n = fread(buf, 1, sizeof(buf), in)) > 0)
+    {
+      fwrite(buf, 1, n, out);
+    }
+
+  if (in != NULL)
+    {
+      fclose(in);
+    }
+
+  if (out != NULL)
+    {
+      fclose(out);
+    }
+}
+
+/*--------------------------------------------------------------------------*/
+extern "C" ssize_t write(int fd, const void *buf, size_t size)
+{
+  if (fd <= 2)
+    {
+      return syscall(SYS_write, fd, buf, size);
+    }
+
+  off_t pos = lseek(fd, 0, SEEK_CUR);
+
+  if (pos == 0 && size == sizeof(WAVHEADER64))
+    {
+      /* Header update in place. */
+
+      s_header_writes++;
+    }
+  else
+    {
+      if ((pos % WRITE_SIZE) != 0)
+        {
+          s_unaligned_writes++;
+        }
+
+      if (size != WRITE_SIZE)
+        {
+          s_short_writes++;
+        }
+
+      if (s_data_writes == s_snapshot_at)
+        {
+          copy_file(TEST_FILE, SNAPSHOT_FILE);
+          s_snapshot_taken = true;
+        }
+
+      if (s_data_writes++ == s_fail_at)
+        {
+          errno = ENOSPC;
+          return -1;
+        }
+
+      usleep((s_data_writes % STALL_PERIOD) == 0 ? STALL_USEC : WRITE_USEC);
+    }
+
+  return syscall(SYS_write, fd, buf, size);
+}
+
+/*--------------------------------------------------------------------------*/
+static void write_done(uint32_t size)
+{
+  s_callback_size += size;
+}
+
+/*--------------------------------------------------------------------------*/
+static uint8_t pattern(uint32_t offset)
+{
+  return (uint8_t)(offset ^ (offset >> 8) ^ (offset >> 16));
+}
+
+/*--------------------------------------------------------------------------*/
+static uint8_t *read_file(const char *path, uint32_t *size)
+{
+  struct stat sb;
+
+  if (stat(path, &sb) != 0)
+    {
+      *size = 0;
+      return NULL;
+    }
+
+  uint8_t *data = (uint8_t *)malloc(sb.st_size + 1);
+  FILE *fp = fopen(path, "rb");
+
+  *size = fread(data, 1, sb.st_size, fp);
+  fclose(fp);
+
+  return data;
+}
+
+/*--------------------------------------------------------------------------*/
+static uint32_t check_data(const uint8_t *data, uint32_t size)
+{
+  for (uint32_t i = 0; i < size; i++)
+    {
+      if (data[i] != pattern(i))
+        {
+          return i;
+        }
+    }
+
+  return size;
+}
+
+/*--------------------------------------------------------------------------*/
+static void check_wav(const char *path,
+                      const struct test_param_s &tp,
+                      uint64_t expect_data_size,
+                      bool complete)
+{
+  uint32_t file_size;
+  uint8_t *file = read_file(path, &file_size);
+
+  CHECK(file_size >= sizeof(WAVHEADER64), "no WAV header (%u bytes)",
+        file_size);
+  if (file_size < sizeof(WAVHEADER64))
+    {
+      free(file);
+      return;
+    }
+
+  WAVHEADER64 header;
+  memcpy(&header, file, sizeof(header));
+
+  uint32_t block = tp.channel_num * (tp.bit_width / 8);
+
+  CHECK(memcmp(header.riff, "RIFF", 4) == 0, "not RIFF");
+  CHECK(memcmp(header.data, "data", 4) == 0, "no data chunk");
+  CHECK(header.data_size == expect_data_size,
+        "data size %u, expected %llu", header.data_size,
+        (unsigned long long)expect_data_size);
+  CHECK(header.data_size % block == 0, "data size %u is not in block %u",
+        header.data_size, block);
+  CHECK(header.data_size + sizeof(WAVHEADER64) <= file_size,
+        "data size %u is over the file (%u bytes)", header.data_size,
+        file_size);
+
+  if (complete)
+    {
+      CHECK(header.total_size == header.data_size + sizeof(WAVHEADER64) - 8,
+            "RIFF size %u for data size %u", header.total_size,
+            header.data_size);
+      CHECK(file_size == sizeof(WAVHEADER64) + header.data_size,
+            "file size %u for data size %u", file_size, header.data_size);
+    }
+
+  /* Parse as application does. */
+
+  WavContainerFormatParser parser;
+  fmt_chunk_t fmt;
+  handel_wav_parser handle = parser.parseChunk(path, &fmt);
+
+  CHECK(handle != NULL, "parseChunk failed");
+  if (handle == NULL)
+    {
+      free(file);
+      return;
+    }
+
+  CHECK(fmt.format == WAVE_FORMAT_PCM && fmt.channel == tp.channel_num &&
+        fmt.rate == 48000 && fmt.bit == tp.bit_width &&
+        fmt.block == block && fmt.avgbyte == 48000 * block,
+        "fmt %u ch %u rate %u bit %u block %u avg %u", fmt.format,
+        fmt.channel, fmt.rate, fmt.bit, fmt.block, fmt.avgbyte);
+
+  /* JUNK (space for ds64), fmt and data. */
+
+  uint32_t chunk_num = parser.getChunkNum(handle);
+  wav_chunk_info_t info;
+
+  uint64_t data_size = parser.getDataSize(handle);
+
+  CHECK(chunk_num == 3, "%u chunks", chunk_num);
+  CHECK(parser.getChunkInfo(handle, 0, &info) &&
+        info.chunk_id == SUBCHUNKID_JUNK, "first chunk is not JUNK");
+  CHECK(parser.getChunkInfo(handle, chunk_num - 1, &info) &&
+        info.chunk_id == SUBCHUNKID_DATA &&
+        info.offset == sizeof(WAVHEADER64) &&
+        info.size == data_size,
+        "data chunk 0x%08x offset %llu size %llu", info.chunk_id,
+        (unsigned long long)info.offset, (unsigned long long)info.size);
+  CHECK(!parser.getChunkInfo(handle, chunk_num, &info),
+        "chunk %u is returned", chunk_num);
+
+  /* Data read by parser is the data given by recorder. */
+
+  int8_t *data = (int8_t *)malloc(data_size + 1);
+  uint32_t read_size = 0;
+  int32_t ret;
+
+  while ((ret = parser.getDataChunk(handle, WAVE_FORMAT_PCM,
+                                    data + read_size, 4000)) > 0)
+    {
+      read_size += ret;
+    }
+
+  /* Without size in header, parser takes the rest of file. */
+
+  uint32_t expect_read = (header.data_size != 0) ?
+                           header.data_size : file_size - sizeof(WAVHEADER64);
+
+  CHECK(read_size == expect_read, "read %u bytes of %u", read_size,
+        expect_read);
+  CHECK(check_data((uint8_t *)data, read_size) == read_size,
+        "parsed data mismatch at %u", check_data((uint8_t *)data, read_size));
+
+  parser.resetParser(handle);
+  free(data);
+  free(file);
+}
+
+/*--------------------------------------------------------------------------*/
+static void run(const char *name, const struct test_param_s &tp)
+{
+  printf("%s\n", name);
+
+  s_data_writes      = 0;
+  s_header_writes    = 0;
+  s_unaligned_writes = 0;
+  s_short_writes     = 0;
+  s_fail_at          = tp.fail_at;
+  s_snapshot_at      = tp.snapshot_at;
+  s_snapshot_taken   = false;
+  s_callback_size    = 0;
+  g_attention_err    = 0;
+  g_attention_warn   = 0;
+
+  AsRecorderFileSinkStats stats;
+  AsRecorderFileSinkParam param;
+
+  memset(&param, 0, sizeof(param));
+  param.path                   = TEST_FILE;
+  param.buffer_size            = BUFFER_SIZE;
+  param.write_size             = WRITE_SIZE;
+  param.prealloc_size          = tp.prealloc_size;
+  param.header_size            = tp.header_size;
+  param.stall_threshold        = STALL_MSEC;
+  param.stats                  = &stats;
+  param.container              = tp.container;
+  param.header_update_interval = tp.header_update_interval;
+
+  AudioRecorderFileSink sink;
+
+  uint32_t result = sink.open(param, write_done, tp.channel_num, 48000,
+                              tp.bit_width);
+
+  CHECK(result == AS_ECODE_OK, "open 0x%x", result);
+  if (result != AS_ECODE_OK)
+    {
+      return;
+    }
+
+  uint32_t header_size = (tp.container == AS_RECORDER_FILE_SINK_CONTAINER_WAV) ?
+                           sizeof(WAVHEADER64) : tp.header_size;
+  uint8_t *frame = (uint8_t *)malloc(tp.frame_size);
+  uint32_t total = 0;
+  uint32_t i;
+
+  for (i = 0; i < tp.frame_num; i++)
+    {
+      for (uint32_t k = 0; k < tp.frame_size; k++)
+        {
+          frame[k] = pattern(total + k);
+        }
+
+      if (!sink.write(frame, tp.frame_size))
+        {
+          break;
+        }
+
+      total += tp.frame_size;
+      usleep(FRAME_USEC);
+    }
+
+  bool closed = sink.close();
+
+  printf("  %u frames, %u writes (max %u usec, avg %u usec), "
+         "%u stalls, max buffered %u, %d header writes\n",
+         i, stats.write_num, stats.max_write_time, stats.avg_write_time,
+         stats.stall_num, stats.max_buffered_size, s_header_writes);
+
+  uint32_t file_size;
+  uint8_t *file = read_file(TEST_FILE, &file_size);
+
+  /* Only the last write at close can be short. */
+
+  CHECK(s_unaligned_writes == 0, "%d unaligned writes", s_unaligned_writes);
+  CHECK(s_short_writes <= 1, "%d short writes", s_short_writes);
+
+  if (tp.fail_at >= 0)
+    {
+      /* Recorder is stopped by the error, written part is kept. */
+
+      CHECK(!closed, "close succeeded after ENOSPC");
+      CHECK(stats.error == ENOSPC, "error %d", stats.error);
+      CHECK(i < tp.frame_num, "write did not fail");
+      CHECK(g_attention_err != 0, "no error attention");
+      CHECK(file_size == header_size + stats.written_size,
+            "file size %u, written %llu", file_size,
+            (unsigned long long)stats.written_size);
+    }
+  else
+    {
+      CHECK(closed, "close failed (error %d)", stats.error);
+      CHECK(stats.error == 0, "error %d", stats.error);
+      CHECK(g_attention_err == 0, "%d error attentions", g_attention_err);
+      CHECK(file_size == header_size + total, "file size %u, expected %u",
+            file_size, header_size + total);
+      CHECK(s_callback_size == total, "callback %u, expected %u",
+            s_callback_size, total);
+      CHECK(stats.stall_num != 0 && g_attention_warn != 0,
+            "stall of device is not seen");
+      CHECK(stats.max_buffered_size < BUFFER_SIZE,
+            "buffer overflow (%u)", stats.max_buffered_size);
+    }
+
+  uint32_t data_size = (file_size > header_size) ? file_size - header_size : 0;
+
+  CHECK(check_data(file + header_size, data_size) == data_size,
+        "data mismatch at %u", check_data(file + header_size, data_size));
+
+  if (tp.container == AS_RECORDER_FILE_SINK_CONTAINER_NONE)
+    {
+      for (uint32_t k = 0; k < header_size && k < file_size; k++)
+        {
+          if (file[k] != 0)
+            {
+              CHECK(false, "header area is not 0 at %u", k);
+              break;
+            }
+        }
+    }
+  else
+    {
+      check_wav(TEST_FILE, tp, data_size, true);
+
+      /* Header is updated at every interval and at close. */
+
+      int expect = 1;
+      if (tp.header_update_interval != 0)
+        {
+          expect += s_data_writes / tp.header_update_interval;
+        }
+
+      CHECK(s_header_writes <= expect && s_header_writes >= expect - 1,
+            "%d header writes, expected %d", s_header_writes, expect);
+    }
+
+  if (tp.snapshot_at >= 0)
+    {
+      /* File as it was at the power loss. Header has the size of the
+       * last update.
+       */
+
+      CHECK(s_snapshot_taken, "no snapshot");
+
+      int updated = (tp.header_update_interval == 0) ?
+                      0 : tp.snapshot_at / tp.header_update_interval;
+      uint64_t size = (updated == 0) ?
+                        0 : (uint64_t)updated * tp.header_update_interval *
+                            WRITE_SIZE - sizeof(WAVHEADER64);
+
+      printf("  snapshot at write %d: data size %llu\n", tp.snapshot_at,
+             (unsigned long long)size);
+      check_wav(SNAPSHOT_FILE, tp, size, false);
+      unlink(SNAPSHOT_FILE);
+    }
+
+  free(frame);
+  free(file);
+  unlink(TEST_FILE);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(void)
+{
+  struct test_param_s tp;
+
+  memset(&tp, 0, sizeof(tp));
+  tp.frame_size  = 768;
+  tp.frame_num   = 2000;
+  tp.header_size = 44;
+  tp.fail_at     = -1;
+  tp.snapshot_at = -1;
+  run("raw with header area", tp);
+
+  tp.frame_size    = 1000;
+  tp.frame_num     = 1500;
+  tp.header_size   = 0;
+  tp.prealloc_size = 4 << 20;
+  run("raw with preallocation", tp);
+
+  tp.frame_size    = 500;
+  tp.frame_num     = 2000;
+  tp.header_size   = 80;
+  tp.prealloc_size = 1 << 20;
+  tp.fail_at       = 50;
+  run("ENOSPC", tp);
+
+  tp.frame_size             = 768;
+  tp.frame_num              = 2000;
+  tp.prealloc_size          = 4 << 20;
+  tp.fail_at                = -1;
+  tp.container              = AS_RECORDER_FILE_SINK_CONTAINER_WAV;
+  tp.channel_num            = 2;
+  tp.bit_width              = 16;
+  tp.header_update_interval = 8;
+  tp.snapshot_at            = 100;
+  run("WAV with header update", tp);
+
+  tp.frame_size             = 576;
+  tp.prealloc_size          = 0;
+  tp.channel_num            = 1;
+  tp.bit_width              = 24;
+  tp.header_update_interval = 0;
+  tp.snapshot_at            = 100;
+  run("WAV updated only at close", tp);
+
+  printf("%s (%d failure)\n", (s_fail == 0) ? "PASS" : "FAIL", s_fail);
+
+  return (s_fail == 0) ? 0 : 1;
+}
@@ -0,0 +1,423 @@
+/****************************************************************************
+ * modules/audio/test/gapless/gapless_test.cpp
+ *
+ *   Copyright 2018 Sony Semiconductor Solutions Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Semiconductor Solutions Corporation nor
+ *    the names of its contributors may be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/* Host test of gapless trimming of the media player.
+ *
+ * Decoded PCM of a sequence of MP3 streams is simulated, and each output
+ * frame is tagged with its position. GaplessTrimmer must keep exactly
+ * the frames between encoder delay and padding of each stream. PCM
+ * joined as the player does must keep all of them in order, in chunks
+ * which the output mixer does not drop.
+ *
+ *   $ make && ./gapless_test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "objects/media_player/gapless_trimmer.h"
+
+using namespace Wien2;
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define DEC_DELAY      529     /* MP3 decoder delay */
+#define SPF            1152    /* Samples per MP3 frame */
+#define MAX_STREAMS    4
+#define MAX_CHUNK      1400    /* Frames of the largest decoder output */
+#define MAX_FRAME_SIZE 8
+#define MAX_OUT        (2 * 1024 * 1024)
+
+#define CHECK(cond, ...) \
+  do \
+    { \
+      if (!(cond)) \
+        { \
+          printf("  NG: "); \
+          printf(__VA_ARGS__); \
+          printf("\n"); \
+          s_fail++; \
+        } \
+    } \
+  while (0)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct stream_s
+{
+  bool     trim;     /* Has LAME tag */
+  uint32_t delay;
+  uint32_t length;   /* 0: unknown */
+  uint32_t frames;   /* MP3 frames */
+};
+
+struct format_s
+{
+  uint32_t in_fs;
+  uint32_t out_fs;
+  uint32_t frame_size;
+  uint32_t chunk;    /* Frames of decoder output (varies by +0..2) */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static int s_fail;
+
+static GaplessTrimmer s_trimmer;
+
+/* Positions of frames delivered to the output mixer */
+
+static uint32_t s_out[MAX_OUT];
+static uint32_t s_out_num;
+static uint32_t s_short_num;
+
+/* Held PCM stays in a buffer of decoder output. */
+
+static uint8_t  s_hold[MAX_CHUNK * MAX_FRAME_SIZE];
+static uint32_t s_hold_size;
+static bool     s_holding;
+static uint32_t s_max_size;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/*--------------------------------------------------------------------*/
+static uint64_t to_out(const struct format_s *fmt, uint64_t samples)
+{
+  return (samples + DEC_DELAY) * fmt->out_fs / fmt->in_fs;
+}
+
+/*--------------------------------------------------------------------*/
+static void tag_frames(uint8_t *pcm, uint32_t pos, uint32_t frames,
+                       uint32_t frame_size)
+{
+  /* Position in the lower bytes of each frame (as much as fits). */
+
+  memset(pcm, 0, frames * frame_size);
+  for (uint32_t i = 0; i < frames; i++)
+    {
+      uint32_t tag = pos + i;
+
+      memcpy(pcm + i * frame_size, &tag,
+             (frame_size < sizeof(tag)) ? frame_size : sizeof(tag));
+    }
+}
+
+/*--------------------------------------------------------------------*/
+static void deliver(const uint8_t *pcm, uint32_t size, bool is_end,
+                    uint32_t frame_size)
+{
+  if (size < s_trimmer.getMinSize() && !is_end)
+    {
+      s_short_num++;
+    }
+
+  for (uint32_t i = 0; i < size / frame_size && s_out_num < MAX_OUT; i++)
+    {
+      uint32_t tag = 0;
+
+      memcpy(&tag, pcm + i * frame_size,
+             (frame_size < sizeof(tag)) ? frame_size : sizeof(tag));
+      s_out[s_out_num++] = tag;
+    }
+}
+
+/*--------------------------------------------------------------------*/
+static void send_pcm(uint8_t *pcm, uint32_t size, bool is_end,
+                     uint32_t frame_size)
+{
+  /* Same as PlayerObj::sendPcmToOwner() */
+
+  uint32_t min_size = s_trimmer.getMinSize();
+
+  s_max_size = (size > s_max_size) ? size : s_max_size;
+  size = s_trimmer.trim(pcm, size);
+
+  if (s_holding)
+    {
+      uint32_t move = s_trimmer.join(s_hold, s_hold_size, pcm, size);
+
+      s_hold_size += move;
+      size        -= move;
+
+      CHECK(s_hold_size <= ((s_max_size > min_size) ? s_max_size : min_size),
+            "held PCM of %u bytes overflows", s_hold_size);
+
+      if ((s_hold_size >= min_size) || is_end)
+        {
+          deliver(s_hold, s_hold_size, is_end && size == 0, frame_size);
+          s_holding = false;
+        }
+    }
+
+  if (is_end || (size >= min_size))
+    {
+      deliver(pcm, size, is_end, frame_size);
+    }
+  else if (size > 0)
+    {
+      memcpy(s_hold, pcm, size);
+      s_hold_size = size;
+      s_holding   = true;
+    }
+}
+
+/*--------------------------------------------------------------------*/
+static void add_stream(const struct stream_s *st)
+{
+  /* Same as PlayerObj::startTrim() */
+
+  if (st->trim)
+    {
+      s_trimmer.addStream(st->delay, st->length);
+    }
+  else if (s_trimmer.isActive())
+    {
+      s_trimmer.addStream(0, 0);
+    }
+}
+
+/*--------------------------------------------------------------------*/
+static void play(const struct format_s *fmt, const struct stream_s *st,
+                 int num)
+{
+  static uint8_t pcm[MAX_CHUNK * MAX_FRAME_SIZE];
+  uint64_t base[MAX_STREAMS + 1];
+
+  base[0] = 0;
+  for (int i = 0; i < num; i++)
+    {
+      base[i + 1] = base[i] + (uint64_t)st[i].frames * SPF;
+    }
+
+  s_trimmer.reset();
+  s_trimmer.setOutput(fmt->in_fs, fmt->out_fs, DEC_DELAY, fmt->frame_size);
+  s_out_num   = 0;
+  s_short_num = 0;
+  s_holding   = false;
+  s_max_size  = 0;
+
+  add_stream(&st[0]);
+
+  /* Decoder output runs until all input is flushed out. ES of next
+   * stream is got some frames before its PCM comes out.
+   */
+
+  uint64_t total = to_out(fmt, base[num]) + SPF;
+  uint64_t pos   = 0;
+  int      next  = 1;
+
+  for (uint32_t n = 0; pos < total; n++)
+    {
+      uint32_t frames = fmt->chunk + n % 3;
+      bool     is_end = (pos + frames >= total);
+
+      if (is_end)
+        {
+          frames = total - pos;
+        }
+
+      while ((next < num) &&
+             (pos + 2 * fmt->chunk >= to_out(fmt, base[next])))
+        {
+          s_trimmer.endStream(st[next - 1].frames * SPF);
+          add_stream(&st[next]);
+          next++;
+        }
+
+      /* PCM is delivered untouched while not trimmed. */
+
+      if (!s_trimmer.isActive())
+        {
+          pos += frames;
+          continue;
+        }
+
+      tag_frames(pcm, pos, frames, fmt->frame_size);
+      send_pcm(pcm, frames * fmt->frame_size, is_end, fmt->frame_size);
+      pos += frames;
+    }
+}
+
+/*--------------------------------------------------------------------*/
+static uint32_t expect(const struct format_s *fmt, const struct stream_s *st,
+                       int num, uint32_t *out)
+{
+  /* Frames of each stream in output, in the order of streams. A stream
+   * without length ends at the top of next one, or the end of output.
+   */
+
+  uint64_t base  = 0;
+  uint32_t count = 0;
+  bool     active = false;
+
+  for (int i = 0; i < num; i++)
+    {
+      uint64_t next = base + (uint64_t)st[i].frames * SPF;
+      uint64_t from;
+      uint64_t to;
+
+      active |= st[i].trim;
+      if (active)
+        {
+          from = st[i].trim ? base + st[i].delay : base;
+          to   = (st[i].trim && st[i].length != 0) ?
+                   from + st[i].length :
+                   ((i + 1 < num) ? next : UINT64_MAX);
+
+          uint64_t end = (i + 1 < num) ? to_out(fmt, next) :
+                                         to_out(fmt, next) + SPF;
+          uint64_t top = to_out(fmt, from);
+          uint64_t btm = (to == UINT64_MAX) ? end : to_out(fmt, to);
+
+          if (btm > end)
+            {
+              btm = end;
+            }
+
+          for (uint64_t n = top; n < btm && count < MAX_OUT; n++)
+            {
+              uint32_t tag = n;
+
+              if (fmt->frame_size < sizeof(tag))
+                {
+                  tag &= (1u << (fmt->frame_size * 8)) - 1;
+                }
+              out[count++] = tag;
+            }
+        }
+
+      base = next;
+    }
+
+  return count;
+}
+
+/*--------------------------------------------------------------------*/
+static void test(const char *name, const struct format_s *fmt,
+                 const struct stream_s *st, int num)
+{
+  static uint32_t exp[MAX_OUT];
+  uint32_t exp_num = expect(fmt, st, num, exp);
+
+  printf("%s\n", name);
+
+  play(fmt, st, num);
+
+  uint32_t diff = 0;
+  while (diff < s_out_num && diff < exp_num && s_out[diff] == exp[diff])
+    {
+      diff++;
+    }
+
+  printf("  %u frames kept, %u expected\n", s_out_num, exp_num);
+
+  CHECK(s_out_num == exp_num, "%u frames kept, %u expected",
+        s_out_num, exp_num);
+  CHECK(diff == exp_num || diff == s_out_num,
+        "frame %u is %u, %u expected", diff, s_out[diff], exp[diff]);
+  CHECK(s_short_num == 0, "%u PCM shorter than minimum", s_short_num);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+  /* Decoder output of MP3 is always stereo, but any frame size is
+   * handled the same.
+   */
+
+  static const struct format_s fs48_16bit = { 48000, 48000, 4, 1152 };
+  static const struct format_s fs48_24bit = { 48000, 48000, 8, 1152 };
+  static const struct format_s fs48_mono  = { 48000, 48000, 2, 1152 };
+  static const struct format_s fs44_16bit = { 44100, 48000, 4, 1253 };
+  static const struct format_s fs32_24bit = { 32000, 48000, 8, 1152 };
+
+  /* Encoder delay and padding of LAME are 576 + 529 and so. */
+
+  static const struct stream_s album[] =
+  {
+    { true, 1105, 441000,  385 },
+    { true, 1105, 220500,  194 },
+    { true, 1105, 1000,    3   },
+    { true, 1105, 88200,   78  },
+  };
+
+  static const struct stream_s mixed[] =
+  {
+    { true,  1105, 100000, 89  },
+    { false, 0,    0,      50  },
+    { true,  576,  0,      40  },
+  };
+
+  static const struct stream_s plain[] =
+  {
+    { false, 0,    0,      20  },
+    { false, 0,    0,      20  },
+  };
+
+  /* Sizes kept are exact at the same rate of input and output. */
+
+  test("album, 48kHz 16bit", &fs48_16bit, album, 4);
+  test("album, 48kHz 24bit", &fs48_24bit, album, 4);
+  test("album, 48kHz mono", &fs48_mono, album, 4);
+  test("album, 44.1kHz to 48kHz", &fs44_16bit, album, 4);
+  test("album, 32kHz to 48kHz", &fs32_24bit, album, 4);
+
+  /* Stream without LAME tag is kept whole after a trimmed one.
+   * Stream without length is kept until next stream.
+   */
+
+  test("with untrimmed streams", &fs48_16bit, mixed, 3);
+  test("with untrimmed streams, 44.1kHz", &fs44_16bit, mixed, 3);
+
+  /* Streams without LAME tag are not trimmed at all. */
+
+  test("untrimmed only", &fs48_16bit, plain, 2);
+  CHECK(!s_trimmer.isActive(), "trimming of untrimmed streams");
+
+  printf("%s (%d failure)\n", s_fail == 0 ? "PASS" : "FAIL", s_fail);
+  return s_fail == 0 ? 0 : 1;
+}
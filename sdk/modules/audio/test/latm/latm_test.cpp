@@ -0,0 +1,816 @@
+/****************************************************************************
+ * modules/audio/test/latm/latm_test.cpp
+ *
+ *   Copyright 2018 Sony Semiconductor Solutions Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Semiconductor Solutions Corporation nor
+ *    the names of its contributors may be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/* Host test of the LATM/LOAS stream parser.
+ *
+ * 100k AudioMuxElements, bit flipped ones and random data are parsed
+ * by AACLC_getNextLatm(), and the return values and InfoStreamMuxConfig
+ * contents must be byte-identical to the ones of the former bit reader
+ * (a golden checksum). Then frames/s of typical A2DP headers is
+ * measured.
+ *
+ * A corpus of LOAS frames carrying AAC-LC AudioMuxElements is
+ * generated with a fixed seed, and damaged here and there by junk
+ * bytes and cut frames. AACLC_findLoas() must find the same frames as
+ * a byte by byte reference search, no false frame, and every frame
+ * which is followed by 2 frames. Finally the resync speed is measured
+ * in MB/s.
+ *
+ *   $ make && ./latm_test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+
+#include "common/LatmAacLc.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define CORPUS_FRAMES  20000
+#define CORPUS_SIZE    (CORPUS_FRAMES * 800)
+#define NOISE_SIZE     (16 * 1024 * 1024)
+#define BENCH_LOOP     5
+
+#define MAX_PAYLOAD    700
+
+/* One of DAMAGE_RATE frames is followed by junk or cut short. */
+
+#define DAMAGE_RATE    16
+
+/* Header corpus and its checksum made by the parser before the bit
+ * reader was replaced (the one of 519ed95^ built with WINDOWS, which
+ * assembles fields MSB first, and without its LOAS probe).
+ */
+
+#define HEADER_NUM        100000
+#define HEADER_PAYLOAD    24
+#define HEADER_MAX_SIZE   128
+#define HEADER_BUF_SIZE   (HEADER_MAX_SIZE + 16)
+
+/* The former parser read past the data. It is given zeros there, as
+ * the current one takes bits after the data as 0. A broken header may
+ * move the position up to 2^32 bits, so the zeros are mapped lazily.
+ */
+
+#define HEADER_PAD_SIZE   (512u * 1024 * 1024 + 4096)
+#define HEADER_BENCH_NUM  1000000
+#define GOLDEN_HEADERS    0xb40b96d9d6996977ull
+
+#define CHECK(cond, ...) \
+  do \
+    { \
+      if (!(cond)) \
+        { \
+          printf("  NG: "); \
+          printf(__VA_ARGS__); \
+          printf("\n"); \
+          s_fail++; \
+        } \
+    } \
+  while (0)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct bit_writer_s
+{
+  uint8_t  *buf;
+  uint32_t  bits;
+};
+
+/* Search function under test (AACLC_findLoas() or the reference) */
+
+typedef uint8_t *(*find_loas_t)(uint8_t *buf, uint32_t size,
+                                uint32_t *frame_size);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static int s_fail;
+
+static uint8_t  s_corpus[CORPUS_SIZE];
+static uint32_t s_corpus_size;
+
+/* Frame offsets of the corpus, and whether each must be found. */
+
+static uint32_t s_frame_pos[CORPUS_FRAMES];
+static bool     s_frame_must[CORPUS_FRAMES];
+static uint32_t s_frame_num;
+
+static uint32_t s_found_pos[CORPUS_FRAMES * 2];
+
+static uint32_t s_seed;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static double now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void put_bits(struct bit_writer_s *w, uint32_t val, uint32_t len)
+{
+  while (len--)
+    {
+      uint32_t bit = (val >> len) & 1;
+      uint8_t *p = &w->buf[w->bits / 8];
+
+      if (w->bits % 8 == 0)
+        {
+          *p = 0;
+        }
+      *p |= bit << (7 - w->bits % 8);
+      w->bits++;
+    }
+}
+
+/* AudioMuxElement(1) with StreamMuxConfig of AAC-LC and a random
+ * payload. Returns its size in bytes.
+ */
+
+static uint32_t make_mux_element(uint8_t *buf, uint32_t payload_len)
+{
+  struct bit_writer_s w = { buf, 0 };
+  static const uint8_t fs_idx[] = { 3, 4, 6 };  /* 48k, 44.1k, 24k */
+
+  put_bits(&w, 0, 1);                    /* useSameStreamMux */
+
+  /* StreamMuxConfig() */
+
+  put_bits(&w, 0, 1);                    /* audioMuxVersion */
+  put_bits(&w, 1, 1);                    /* allStreamsSameTimeFraming */
+  put_bits(&w, 0, 6);                    /* numSubFrames */
+  put_bits(&w, 0, 4);                    /* numProgram */
+  put_bits(&w, 0, 3);                    /* numLayer */
+  put_bits(&w, 2, 5);                    /* audioObjectType: AAC-LC */
+  put_bits(&w, fs_idx[rand() % 3], 4);   /* samplingFrequencyIndex */
+  put_bits(&w, 1 + rand() % 2, 4);       /* channelConfiguration */
+  put_bits(&w, 0, 3);                    /* GASpecificConfig flags */
+  put_bits(&w, 0, 3);                    /* frameLengthType */
+  put_bits(&w, 0xff, 8);                 /* latmBufferFullness */
+  put_bits(&w, 0, 1);                    /* otherDataPresent */
+  put_bits(&w, 0, 1);                    /* crcCheckPresent */
+
+  /* PayloadLengthInfo() and PayloadMux() */
+
+  uint32_t len = payload_len;
+  while (len >= 255)
+    {
+      put_bits(&w, 255, 8);
+      len -= 255;
+    }
+  put_bits(&w, len, 8);
+
+  for (uint32_t i = 0; i < payload_len; i++)
+    {
+      put_bits(&w, rand() & 0xff, 8);
+    }
+
+  return (w.bits + 7) / 8;
+}
+
+/* LOAS frames, each followed by junk or cut short now and then. */
+
+static void make_corpus(void)
+{
+  uint32_t pos = 0;
+
+  srand(1);
+  s_frame_num = 0;
+
+  while (s_frame_num < CORPUS_FRAMES)
+    {
+      uint8_t  elem[MAX_PAYLOAD + 16];
+      uint32_t len = make_mux_element(elem, 1 + rand() % MAX_PAYLOAD);
+      uint32_t junk = 0;
+      uint32_t cut = 0;
+
+      if (rand() % DAMAGE_RATE == 0)
+        {
+          if (rand() & 1)
+            {
+              junk = 1 + rand() % 64;
+            }
+          else
+            {
+              cut = 1 + rand() % len;
+            }
+        }
+
+      if (pos + 3 + len + junk > CORPUS_SIZE)
+        {
+          break;
+        }
+
+      s_frame_pos[s_frame_num] = pos;
+      s_frame_must[s_frame_num] = (junk == 0 && cut == 0);
+      s_frame_num++;
+
+      s_corpus[pos++] = 0x56;
+      s_corpus[pos++] = 0xe0 | (len >> 8);
+      s_corpus[pos++] = len & 0xff;
+      memcpy(&s_corpus[pos], elem, len - cut);
+      pos += len - cut;
+
+      for (uint32_t i = 0; i < junk; i++)
+        {
+          s_corpus[pos++] = rand() & 0xff;
+        }
+    }
+
+  s_corpus_size = pos;
+
+  /* A frame is found only if the next 2 frames follow it with no
+   * gap, as AACLC_findLoas() checks their headers.
+   */
+
+  bool chained_next = true;
+  for (uint32_t i = s_frame_num; i-- > 0; )
+    {
+      uint32_t end = s_frame_pos[i] + 3 +
+                     (((s_corpus[s_frame_pos[i] + 1] & 0x1f) << 8) |
+                      s_corpus[s_frame_pos[i] + 2]);
+      bool chained = (i + 1 < s_frame_num) ? (end == s_frame_pos[i + 1])
+                                           : (end == s_corpus_size);
+
+      s_frame_must[i] = s_frame_must[i] && chained && chained_next;
+      chained_next = chained;
+    }
+}
+
+/* Byte by byte search with the same rules as AACLC_findLoas(). */
+
+static bool is_header(uint8_t *buf, uint32_t pos, uint32_t size)
+{
+  return pos + 3 <= size && buf[pos] == 0x56 &&
+         (buf[pos + 1] & 0xe0) == 0xe0 &&
+         (((buf[pos + 1] & 0x1f) << 8) | buf[pos + 2]) != 0;
+}
+
+static uint32_t frame_end(uint8_t *buf, uint32_t pos)
+{
+  return pos + 3 + (((buf[pos + 1] & 0x1f) << 8) | buf[pos + 2]);
+}
+
+static uint8_t *find_loas_ref(uint8_t *buf, uint32_t size,
+                              uint32_t *frame_size)
+{
+  for (uint32_t pos = 0; pos + 3 <= size; pos++)
+    {
+      if (!is_header(buf, pos, size))
+        {
+          continue;
+        }
+
+      /* The next 2 headers, if they are in the data */
+
+      uint32_t next = frame_end(buf, pos);
+      bool followed = true;
+
+      for (int i = 0; i < 2 && next + 3 <= size; i++)
+        {
+          if (!is_header(buf, next, size))
+            {
+              followed = false;
+              break;
+            }
+          next = frame_end(buf, next);
+        }
+
+      if (!followed)
+        {
+          continue;
+        }
+
+      /* The first frame inside whose frames end at the same place */
+
+      uint32_t end = frame_end(buf, pos);
+      uint32_t found = pos;
+
+      for (uint32_t inner = pos + 1;
+           end <= size && inner + 3 <= end && found == pos;
+           inner++)
+        {
+          uint32_t chain = inner;
+
+          while (chain < end && is_header(buf, chain, end))
+            {
+              chain = frame_end(buf, chain);
+            }
+          if (chain == end)
+            {
+              found = inner;
+            }
+        }
+
+      *frame_size = frame_end(buf, found) - found;
+      return buf + found;
+    }
+  return 0;
+}
+
+static uint8_t *find_loas_dut(uint8_t *buf, uint32_t size,
+                              uint32_t *frame_size)
+{
+  return AACLC_findLoas(buf, size, frame_size);
+}
+
+/* Follow the stream as a player does: take a frame, and search again
+ * from its end. Returns the number of frames found.
+ */
+
+static uint32_t follow(find_loas_t find, uint8_t *buf, uint32_t size,
+                       uint32_t *found)
+{
+  uint32_t num = 0;
+  uint32_t pos = 0;
+
+  while (pos < size)
+    {
+      uint32_t frame_size = 0;
+      uint8_t *frame = find(buf + pos, size - pos, &frame_size);
+
+      if (!frame)
+        {
+          break;
+        }
+      if (found)
+        {
+          found[num] = frame - buf;
+        }
+      num++;
+      pos = (frame - buf) + frame_size;
+    }
+  return num;
+}
+
+static void test_loas(void)
+{
+  static uint32_t ref_pos[CORPUS_FRAMES * 2];
+  uint32_t num;
+  uint32_t ref_num;
+  uint32_t must = 0;
+  uint32_t fp = 0;
+
+  printf("LOAS corpus (%u frames, %u bytes)\n",
+         s_frame_num, s_corpus_size);
+
+  num = follow(find_loas_dut, s_corpus, s_corpus_size, s_found_pos);
+  ref_num = follow(find_loas_ref, s_corpus, s_corpus_size, ref_pos);
+
+  CHECK(num == ref_num, "%u frames found, reference %u", num, ref_num);
+  CHECK(!memcmp(s_found_pos, ref_pos,
+                (num < ref_num ? num : ref_num) * sizeof(uint32_t)),
+        "frames found differ from reference");
+
+  /* Frames followed by another frame must be found, and anything
+   * found must be a frame.
+   */
+
+  uint32_t j = 0;
+  for (uint32_t i = 0; i < s_frame_num; i++)
+    {
+      while (j < num && s_found_pos[j] < s_frame_pos[i])
+        {
+          fp++;
+          j++;
+        }
+      if (j < num && s_found_pos[j] == s_frame_pos[i])
+        {
+          j++;
+        }
+      else if (s_frame_must[i])
+        {
+          CHECK(0, "frame %u at %u was not found", i, s_frame_pos[i]);
+        }
+      must += s_frame_must[i];
+    }
+  fp += num - j;
+
+  printf("  %u found, %u of them must be, %u false\n", num, must, fp);
+  CHECK(fp == 0, "%u false frames", fp);
+
+  /* Empty, short and syncword only data. */
+
+  uint8_t hdr[5] = { 0x56, 0xe0, 0x00, 0x56, 0xe0 };
+  uint32_t frame_size = 0;
+  CHECK(AACLC_findLoas(hdr, 0, &frame_size) == 0, "empty data");
+  CHECK(AACLC_findLoas(hdr, 2, &frame_size) == 0, "2 bytes");
+  CHECK(AACLC_findLoas(hdr, 5, &frame_size) == 0, "frame of length 0");
+  hdr[2] = 0x02;
+  CHECK(AACLC_findLoas(hdr, 3, &frame_size) == hdr && frame_size == 5,
+        "header at the end");
+  CHECK(AACLC_findLoas(hdr, 5, &frame_size) == hdr,
+        "frame reaching the end");
+}
+
+static void bench_loas(const char *name, uint8_t *buf, uint32_t size)
+{
+  for (int dut = 0; dut < 2; dut++)
+    {
+      find_loas_t find = dut ? find_loas_dut : find_loas_ref;
+      double best = 1e9;
+      uint32_t num = 0;
+
+      for (int loop = 0; loop < BENCH_LOOP; loop++)
+        {
+          double start = now();
+          num = follow(find, buf, size, NULL);
+          double sec = now() - start;
+          best = (sec < best) ? sec : best;
+        }
+
+      printf("  %-16s %-16s %9.1f MB/s (%u frames)\n", name,
+             dut ? "AACLC_findLoas" : "byte by byte", size / best / 1e6,
+             num);
+    }
+}
+
+/* Random number of the header corpus. rand() is not used, as the
+ * golden checksum must not depend on the C library.
+ */
+
+static uint32_t next_rand(void)
+{
+  s_seed ^= s_seed << 13;
+  s_seed ^= s_seed >> 17;
+  s_seed ^= s_seed << 5;
+  return s_seed;
+}
+
+static uint32_t rand_bits(uint32_t len)
+{
+  return (len == 0) ? 0 : next_rand() >> (32 - len);
+}
+
+/* LatmGetValue() */
+
+static void put_latm_value(struct bit_writer_s *w, uint32_t val)
+{
+  uint32_t bytes = (val > 0xffff) ? 2 : (val > 0xff) ? 1 : 0;
+
+  put_bits(w, bytes, 2);
+  put_bits(w, val, (bytes + 1) * 8);
+}
+
+/* AudioSpecificConfig() of AAC-LC, SBR or PS with some escape values
+ * and extensions.
+ */
+
+static void put_audio_specific_config(struct bit_writer_s *w)
+{
+  static const uint8_t aot[] = { 2, 2, 2, 5, 29, 1, 31 };
+  uint32_t type = aot[next_rand() % sizeof(aot)];
+
+  if (type == 31)
+    {
+      put_bits(w, 31, 5);
+      put_bits(w, rand_bits(6), 6);
+    }
+  else
+    {
+      put_bits(w, type, 5);
+    }
+
+  uint32_t fs_idx = (next_rand() % 8 == 0) ? 0xf : next_rand() % 12;
+  put_bits(w, fs_idx, 4);
+  if (fs_idx == 0xf)
+    {
+      put_bits(w, rand_bits(24), 24);
+    }
+  put_bits(w, 1 + next_rand() % 7, 4);   /* channelConfiguration */
+
+  if (type == 5 || type == 29)
+    {
+      fs_idx = (next_rand() % 8 == 0) ? 0xf : next_rand() % 12;
+      put_bits(w, fs_idx, 4);
+      if (fs_idx == 0xf)
+        {
+          put_bits(w, rand_bits(24), 24);
+        }
+      put_bits(w, 2, 5);
+    }
+
+  put_bits(w, rand_bits(1), 1);          /* frameLengthFlag */
+  if (rand_bits(1))
+    {
+      put_bits(w, 1, 1);                 /* dependsOnCoreCoder */
+      put_bits(w, rand_bits(14), 14);
+    }
+  else
+    {
+      put_bits(w, 0, 1);
+    }
+  put_bits(w, 0, 1);                     /* extensionFlag */
+
+  if (type == 2 && next_rand() % 4 == 0)
+    {
+      put_bits(w, 0x2b7, 11);            /* syncExtensionType: SBR */
+      put_bits(w, 5, 5);
+      if (rand_bits(1))
+        {
+          put_bits(w, 1, 1);             /* sbrPresentFlag */
+          put_bits(w, next_rand() % 12, 4);
+          if (rand_bits(1))
+            {
+              put_bits(w, 0x548, 11);    /* syncExtensionType: PS */
+              put_bits(w, rand_bits(1), 1);
+            }
+        }
+      else
+        {
+          put_bits(w, 0, 1);
+        }
+    }
+}
+
+/* AudioMuxElement(1) with or without StreamMuxConfig. Returns its size
+ * in bytes.
+ */
+
+static uint32_t make_header(uint8_t *buf)
+{
+  struct bit_writer_s w = { buf, 0 };
+  uint32_t use_same = (next_rand() % 3 == 0);
+  uint32_t version = rand_bits(1);
+  uint32_t sub_frames = next_rand() % 3;
+  uint32_t other_data = (next_rand() % 4 == 0);
+
+  put_bits(&w, use_same, 1);
+
+  if (!use_same)
+    {
+      put_bits(&w, version, 1);          /* audioMuxVersion */
+      if (version)
+        {
+          put_bits(&w, 0, 1);            /* audioMuxVersionA */
+          put_latm_value(&w, rand_bits(8));
+        }
+      put_bits(&w, 1, 1);                /* allStreamsSameTimeFraming */
+      put_bits(&w, sub_frames, 6);
+      put_bits(&w, 0, 4);                /* numProgram */
+      put_bits(&w, 0, 3);                /* numLayer */
+
+      if (version)
+        {
+          /* ascLen is left 0: the parser takes the bits it reads. */
+
+          put_latm_value(&w, 0);
+        }
+      put_audio_specific_config(&w);
+
+      put_bits(&w, 0, 3);                /* frameLengthType */
+      put_bits(&w, rand_bits(8), 8);     /* latmBufferFullness */
+
+      put_bits(&w, other_data, 1);
+      if (other_data)
+        {
+          if (version)
+            {
+              put_latm_value(&w, rand_bits(6));
+            }
+          else
+            {
+              put_bits(&w, 0, 1);        /* otherDataLenEsc */
+              put_bits(&w, rand_bits(6), 8);
+            }
+        }
+
+      put_bits(&w, rand_bits(1), 1);     /* crcCheckPresent */
+      put_bits(&w, rand_bits(8), 8);
+    }
+
+  for (uint32_t i = 0; i <= sub_frames; i++)
+    {
+      uint32_t len = next_rand() % (HEADER_PAYLOAD + 1);
+
+      put_bits(&w, len, 8);              /* PayloadLengthInfo() */
+      for (uint32_t j = 0; j < len; j++)
+        {
+          put_bits(&w, rand_bits(8), 8); /* PayloadMux() */
+        }
+    }
+
+  return (w.bits + 7) / 8;
+}
+
+/* FNV-1a */
+
+static uint64_t hash(uint64_t h, const void *data, uint32_t size)
+{
+  const uint8_t *p = (const uint8_t *)data;
+
+  for (uint32_t i = 0; i < size; i++)
+    {
+      h = (h ^ p[i]) * 0x100000001b3ull;
+    }
+  return h;
+}
+
+/* Headers, bit flipped ones and random data are parsed in a row with
+ * one InfoStreamMuxConfig, and return values and the configs are
+ * checked against GOLDEN_HEADERS.
+ */
+
+static void test_headers(void)
+{
+  static InfoStreamMuxConfig config;
+  uint64_t h = 0xcbf29ce484222325ull;
+  uint32_t ng = 0;
+  uint8_t *buf = (uint8_t *)mmap(NULL, HEADER_BUF_SIZE + HEADER_PAD_SIZE,
+                                 PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                                 -1, 0);
+
+  if (buf == MAP_FAILED)
+    {
+      CHECK(0, "mmap failed");
+      return;
+    }
+
+  memset(&config, 0, sizeof(config));
+  s_seed = 1;
+
+  printf("LATM headers (%d)\n", HEADER_NUM);
+
+  for (int n = 0; n < HEADER_NUM; n++)
+    {
+      uint32_t size;
+      uint32_t kind = next_rand() % 8;
+
+      memset(buf, 0, HEADER_BUF_SIZE);
+
+      if (kind == 0)
+        {
+          size = 1 + next_rand() % HEADER_MAX_SIZE;
+          for (uint32_t i = 0; i < size; i++)
+            {
+              buf[i] = rand_bits(8);
+            }
+        }
+      else
+        {
+          size = make_header(buf);
+          for (uint32_t i = 0; i < kind / 2; i++)
+            {
+              uint32_t bit = next_rand() % (size * 8);
+              buf[bit / 8] ^= 0x80 >> (bit % 8);
+            }
+        }
+
+      uint8_t *next = AACLC_getNextLatm(buf, size, &config);
+      int32_t  offset = next ? (int32_t)(next - buf) : -1;
+
+      ng += (next == NULL);
+      h = hash(h, &offset, sizeof(offset));
+      h = hash(h, &config, sizeof(config));
+    }
+
+  munmap(buf, HEADER_BUF_SIZE + HEADER_PAD_SIZE);
+
+  printf("  %u NG, checksum %016llx\n", ng, (unsigned long long)h);
+  CHECK(h == GOLDEN_HEADERS, "checksum differs from %016llx",
+        (unsigned long long)GOLDEN_HEADERS);
+}
+
+static void bench_headers(void)
+{
+  static InfoStreamMuxConfig config;
+  uint8_t  buf[2][HEADER_BUF_SIZE];
+  uint32_t size[2];
+
+  /* An A2DP frame with StreamMuxConfig (AAC-LC, 44.1kHz, stereo)
+   * and one of the same config.
+   */
+
+  for (int i = 0; i < 2; i++)
+    {
+      struct bit_writer_s w = { buf[i], 0 };
+
+      memset(buf[i], 0, sizeof(buf[i]));
+      put_bits(&w, i, 1);                /* useSameStreamMux */
+      if (i == 0)
+        {
+          put_bits(&w, 0, 1);            /* audioMuxVersion */
+          put_bits(&w, 1, 1);            /* allStreamsSameTimeFraming */
+          put_bits(&w, 0, 6);            /* numSubFrames */
+          put_bits(&w, 0, 4);            /* numProgram */
+          put_bits(&w, 0, 3);            /* numLayer */
+          put_bits(&w, 2, 5);            /* audioObjectType */
+          put_bits(&w, 4, 4);            /* samplingFrequencyIndex */
+          put_bits(&w, 2, 4);            /* channelConfiguration */
+          put_bits(&w, 0, 3);            /* GASpecificConfig flags */
+          put_bits(&w, 0, 3);            /* frameLengthType */
+          put_bits(&w, 0xff, 8);         /* latmBufferFullness */
+          put_bits(&w, 0, 2);            /* otherData, crc */
+        }
+      put_bits(&w, 16, 8);
+      for (int j = 0; j < 16; j++)
+        {
+          put_bits(&w, j, 8);
+        }
+      size[i] = (w.bits + 7) / 8;
+    }
+
+  memset(&config, 0, sizeof(config));
+  printf("LATM header benchmark\n");
+
+  for (int i = 0; i < 2; i++)
+    {
+      double best = 1e9;
+
+      for (int loop = 0; loop < BENCH_LOOP; loop++)
+        {
+          double start = now();
+          for (int n = 0; n < HEADER_BENCH_NUM; n++)
+            {
+              if (!AACLC_getNextLatm(buf[i], size[i], &config))
+                {
+                  s_fail++;
+                }
+            }
+          double sec = now() - start;
+          best = (sec < best) ? sec : best;
+        }
+
+      printf("  %-24s %6.2f Mframes/s\n",
+             i ? "useSameStreamMux=1" : "with StreamMuxConfig",
+             HEADER_BENCH_NUM / best / 1e6);
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+  static uint8_t noise[NOISE_SIZE];
+
+  test_headers();
+  bench_headers();
+
+  make_corpus();
+  test_loas();
+
+  /* Random data is where resync spends its time: nothing but
+   * syncword candidates now and then.
+   */
+
+  srand(2);
+  for (uint32_t i = 0; i < NOISE_SIZE; i++)
+    {
+      noise[i] = rand() & 0xff;
+    }
+
+  printf("resync benchmark\n");
+  bench_loas("damaged corpus", s_corpus, s_corpus_size);
+  bench_loas("random data", noise, NOISE_SIZE);
+
+  printf("%s (%d failure)\n", s_fail == 0 ? "PASS" : "FAIL", s_fail);
+  return s_fail == 0 ? 0 : 1;
+}
@@ -0,0 +1,633 @@
+/****************************************************************************
+ * modules/audio/test/postfilter/postfilter_test.cpp
+ *
+ *   Copyright 2018 Sony Semiconductor Solutions Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Semiconductor Solutions Corporation nor
+ *    the names of its contributors may be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/* Host test of postfilter DSP kernels.
+ *
+ * Output of PostFilterEngine is compared with straightforward per-sample
+ * reference models, and output of the whole chain is compared with a
+ * golden checksum. Finally cycles per sample of each block is measured.
+ *
+ *   $ make && ./postfilter_test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "postfilter_engine.h"
+
+using namespace Wien2::Apu;
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define FS           48000
+#define TEST_FRAMES  (FS * 2)
+#define BENCH_LOOP   20
+
+/* FNV-1a hash of 16bit output of the whole chain (see test_golden()).
+ * Update only when the processing is intentionally changed.
+ */
+
+#define GOLDEN_CHAIN_HASH  0x75bd798bu
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static PostFilterEngine s_engine;
+
+static int16_t s_in16[TEST_FRAMES * 2];
+static int16_t s_out16[TEST_FRAMES * 2];
+static int32_t s_in32[TEST_FRAMES * 2];
+static int32_t s_out32[TEST_FRAMES * 2];
+
+static int s_fail;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+#define CHECK(cond, ...) \
+  do \
+    { \
+      if (!(cond)) \
+        { \
+          printf("  NG: "); \
+          printf(__VA_ARGS__); \
+          printf("\n"); \
+          s_fail++; \
+        } \
+    } \
+  while (0)
+
+/*--------------------------------------------------------------------*/
+static uint64_t read_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  uint32_t lo;
+  uint32_t hi;
+
+  __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+
+  return (static_cast<uint64_t>(hi) << 32) | lo;
+#else
+  /* Fallback to nanoseconds */
+
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+#endif
+}
+
+/*--------------------------------------------------------------------*/
+static int16_t sat16(int32_t val)
+{
+  return (val > 32767) ? 32767 : (val < -32768) ? -32768 : val;
+}
+
+/*--------------------------------------------------------------------*/
+static void make_stimulus(void)
+{
+  /* Amplitude modulated tone which exceeds full scale on left channel
+   * and chirp on right channel. Same data is made for 24bit.
+   */
+
+  for (int i = 0; i < TEST_FRAMES; i++)
+    {
+      double t = static_cast<double>(i) / FS;
+      double l = 1.6 * sin(2 * M_PI * 440 * t) *
+                   (0.5 + 0.5 * sin(2 * M_PI * 2 * t));
+      double r = 0.25 * sin(2 * M_PI * (100 + 4000 * t) * t);
+
+      s_in16[2 * i]     = sat16(static_cast<int32_t>(l * 32767));
+      s_in16[2 * i + 1] = sat16(static_cast<int32_t>(r * 32767));
+
+      s_in32[2 * i]     = static_cast<int32_t>(s_in16[2 * i]) << 16;
+      s_in32[2 * i + 1] = static_cast<int32_t>(s_in16[2 * i + 1]) << 16;
+    }
+}
+
+/*--------------------------------------------------------------------*/
+static void set_enable(uint32_t enable)
+{
+  ApuSetParamPostFilterCmd cmd;
+
+  cmd.param_type = PostFilterParamEnable;
+  cmd.enable     = enable;
+
+  CHECK(s_engine.set(cmd), "set enable 0x%x", enable);
+}
+
+/*--------------------------------------------------------------------*/
+static void set_eq(uint8_t band, const int32_t coef[5])
+{
+  ApuSetParamPostFilterCmd cmd;
+
+  cmd.param_type  = PostFilterParamEq;
+  cmd.set_eq.band = band;
+  memcpy(cmd.set_eq.coef, coef, sizeof(cmd.set_eq.coef));
+
+  CHECK(s_engine.set(cmd), "set eq band %d", band);
+}
+
+/*--------------------------------------------------------------------*/
+static void set_width(int32_t width)
+{
+  ApuSetParamPostFilterCmd cmd;
+
+  cmd.param_type      = PostFilterParamWidth;
+  cmd.set_width.width = width;
+
+  CHECK(s_engine.set(cmd), "set width");
+}
+
+/*--------------------------------------------------------------------*/
+static void set_limiter(uint16_t threshold, uint16_t ahead, uint16_t release)
+{
+  ApuSetParamPostFilterCmd cmd;
+
+  cmd.param_type            = PostFilterParamLimiter;
+  cmd.set_limiter.threshold = threshold;
+  cmd.set_limiter.lookahead = ahead;
+  cmd.set_limiter.release   = release;
+
+  CHECK(s_engine.set(cmd), "set limiter");
+}
+
+/*--------------------------------------------------------------------*/
+static void peaking_eq(double f0, double gain_db, double q, int32_t coef[5])
+{
+  /* RBJ peaking EQ in Q2.30 with a1, a2 sign inverted */
+
+  double a  = pow(10, gain_db / 40);
+  double w  = 2 * M_PI * f0 / FS;
+  double al = sin(w) / (2 * q);
+  double a0 = 1 + al / a;
+
+  coef[0] = lround((1 + al * a) / a0 * (1 << 30));
+  coef[1] = lround((-2 * cos(w)) / a0 * (1 << 30));
+  coef[2] = lround((1 - al * a) / a0 * (1 << 30));
+  coef[3] = lround((2 * cos(w)) / a0 * (1 << 30));
+  coef[4] = lround(-(1 - al / a) / a0 * (1 << 30));
+}
+
+/*--------------------------------------------------------------------*/
+static int32_t ref_clip_q31(int64_t val)
+{
+  return (val > INT32_MAX) ? INT32_MAX :
+         (val < INT32_MIN) ? INT32_MIN : static_cast<int32_t>(val);
+}
+
+/*--------------------------------------------------------------------*/
+static int16_t ref_round_q15(int32_t val)
+{
+  int64_t tmp = (static_cast<int64_t>(val) + 0x8000) >> 16;
+
+  return (tmp > 32767) ? 32767 : static_cast<int16_t>(tmp);
+}
+
+/*--------------------------------------------------------------------*/
+static void exec_in_chunks(const void *in, void *out,
+                           uint32_t frames, uint32_t frame_size)
+{
+  /* Odd chunk size to cross the internal work buffer boundary */
+
+  const uint8_t *src = static_cast<const uint8_t *>(in);
+  uint8_t       *dst = static_cast<uint8_t *>(out);
+
+  while (frames > 0)
+    {
+      uint32_t chunk = (frames < 700) ? frames : 700;
+
+      s_engine.exec(src, dst, chunk * frame_size);
+
+      src    += chunk * frame_size;
+      dst    += chunk * frame_size;
+      frames -= chunk;
+    }
+}
+
+/*--------------------------------------------------------------------*/
+static void test_through(void)
+{
+  printf("through\n");
+
+  s_engine.init(2, 16);
+  set_enable(0);
+
+  exec_in_chunks(s_in16, s_out16, TEST_FRAMES, 4);
+  CHECK(memcmp(s_in16, s_out16, sizeof(s_in16)) == 0, "16bit through");
+
+  s_engine.init(2, 24);
+
+  exec_in_chunks(s_in32, s_out32, TEST_FRAMES, 8);
+  CHECK(memcmp(s_in32, s_out32, sizeof(s_in32)) == 0, "24bit through");
+
+  /* Enabled but all blocks are neutral */
+
+  s_engine.init(2, 16);
+  set_enable(PostFilterBlockEq | PostFilterBlockWidth);
+
+  exec_in_chunks(s_in16, s_out16, TEST_FRAMES, 4);
+  CHECK(memcmp(s_in16, s_out16, sizeof(s_in16)) == 0, "neutral blocks");
+}
+
+/*--------------------------------------------------------------------*/
+static void test_eq(void)
+{
+  /* Bit exact with per-sample DF1 biquad cascade (postShift = 1) */
+
+  printf("eq\n");
+
+  int32_t coef[3][5];
+
+  peaking_eq(100, 6, 0.7, coef[0]);
+  peaking_eq(1000, -9, 1.0, coef[1]);
+  peaking_eq(8000, 3, 2.0, coef[2]);
+
+  s_engine.init(2, 16);
+
+  for (int band = 0; band < 3; band++)
+    {
+      set_eq(band * 2, coef[band]);
+    }
+
+  set_enable(PostFilterBlockEq);
+
+  exec_in_chunks(s_in16, s_out16, TEST_FRAMES, 4);
+
+  int mismatch = 0;
+  double err = 0;
+
+  for (int ch = 0; ch < 2; ch++)
+    {
+      int32_t st[3][4] = {{0}};
+      double  dst[3][4] = {{0}};
+
+      for (int i = 0; i < TEST_FRAMES; i++)
+        {
+          int32_t x = static_cast<int32_t>(s_in16[2 * i + ch]) << 16;
+          double  dx = x;
+
+          for (int band = 0; band < 3; band++)
+            {
+              int32_t *s = st[band];
+              int32_t *c = coef[band];
+              int64_t acc = static_cast<int64_t>(c[0]) * x
+                          + static_cast<int64_t>(c[1]) * s[0]
+                          + static_cast<int64_t>(c[2]) * s[1]
+                          + static_cast<int64_t>(c[3]) * s[2]
+                          + static_cast<int64_t>(c[4]) * s[3];
+              int32_t y = ref_clip_q31(acc >> 30);
+
+              s[1] = s[0];
+              s[0] = x;
+              s[3] = s[2];
+              s[2] = y;
+              x = y;
+
+              /* Floating point model to see precision */
+
+              double *d = dst[band];
+              double dy = (c[0] * dx + c[1] * d[0] + c[2] * d[1]
+                         + c[3] * d[2] + c[4] * d[3]) / (1 << 30);
+
+              d[1] = d[0];
+              d[0] = dx;
+              d[3] = d[2];
+              d[2] = dy;
+              dx = dy;
+            }
+
+          int16_t out = s_out16[2 * i + ch];
+
+          if (out != ref_round_q15(x))
+            {
+              mismatch++;
+            }
+
+          /* Left channel is clipped, see only right channel */
+
+          if (ch == 1)
+            {
+              double e = fabs(dx / 65536 - out);
+
+              err = (e > err) ? e : err;
+            }
+        }
+    }
+
+  CHECK(mismatch == 0, "eq mismatch %d samples", mismatch);
+  CHECK(err < 1.0, "eq error from float model %.3f LSB", err);
+
+  printf("  max error from float model %.3f LSB\n", err);
+
+  /* Out of range band is rejected */
+
+  ApuSetParamPostFilterCmd cmd;
+
+  cmd.param_type  = PostFilterParamEq;
+  cmd.set_eq.band = POSTFILTER_EQ_BAND_NUM;
+  CHECK(!s_engine.set(cmd), "band %d accepted", POSTFILTER_EQ_BAND_NUM);
+}
+
+/*--------------------------------------------------------------------*/
+static void test_width(void)
+{
+  printf("width\n");
+
+  static const int32_t widths[] =
+  {
+    0,                  /* mono */
+    1 << 29,            /* 0.5 */
+    3 << 29,            /* 1.5 */
+    INT32_MAX,          /* about 2.0 */
+  };
+
+  for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); w++)
+    {
+      s_engine.init(2, 24);
+      set_width(widths[w]);
+      set_enable(PostFilterBlockWidth);
+
+      exec_in_chunks(s_in32, s_out32, TEST_FRAMES, 8);
+
+      int mismatch = 0;
+
+      for (int i = 0; i < TEST_FRAMES; i++)
+        {
+          int32_t l    = s_in32[2 * i];
+          int32_t r    = s_in32[2 * i + 1];
+          int32_t mid  = (l >> 1) + (r >> 1);
+          int32_t side = (l >> 1) - (r >> 1);
+          int64_t wide = (static_cast<int64_t>(side) * widths[w]) >> 30;
+
+          if (s_out32[2 * i]     != ref_clip_q31(mid + wide)
+           || s_out32[2 * i + 1] != ref_clip_q31(mid - wide))
+            {
+              mismatch++;
+            }
+        }
+
+      CHECK(mismatch == 0, "width 0x%08x mismatch %d frames",
+            widths[w], mismatch);
+    }
+
+  /* Width 0 makes both channel same */
+
+  s_engine.init(2, 16);
+  set_width(0);
+  set_enable(PostFilterBlockWidth);
+
+  exec_in_chunks(s_in16, s_out16, TEST_FRAMES, 4);
+
+  int diff = 0;
+
+  for (int i = 0; i < TEST_FRAMES; i++)
+    {
+      diff += (s_out16[2 * i] != s_out16[2 * i + 1]);
+    }
+
+  CHECK(diff == 0, "mono width differs at %d frames", diff);
+
+  /* Negative width is rejected */
+
+  ApuSetParamPostFilterCmd cmd;
+
+  cmd.param_type      = PostFilterParamWidth;
+  cmd.set_width.width = -1;
+  CHECK(!s_engine.set(cmd), "negative width accepted");
+}
+
+/*--------------------------------------------------------------------*/
+static void test_limiter(void)
+{
+  printf("limiter\n");
+
+  static const uint16_t aheads[] = { 1, 2, 64, POSTFILTER_LIMITER_MAX_AHEAD };
+
+  for (size_t a = 0; a < sizeof(aheads) / sizeof(aheads[0]); a++)
+    {
+      uint16_t ahead = aheads[a];
+      uint16_t threshold = 16384;
+
+      s_engine.init(2, 16);
+      set_limiter(threshold, ahead, 14);
+      set_enable(PostFilterBlockLimiter);
+
+      exec_in_chunks(s_in16, s_out16, TEST_FRAMES, 4);
+
+      /* Output never exceeds threshold (+1 for rounding), is delayed by
+       * L - 1 frames and never louder than input.
+       */
+
+      int over = 0;
+      int louder = 0;
+      int peak = 0;
+
+      for (int i = 0; i < TEST_FRAMES; i++)
+        {
+          for (int ch = 0; ch < 2; ch++)
+            {
+              int out = abs(s_out16[2 * i + ch]);
+              int in  = (i < ahead - 1) ?
+                          0 : abs(s_in16[2 * (i - ahead + 1) + ch]);
+
+              over   += (out > threshold + 1);
+              louder += (out > in + 1);
+              peak    = (out > peak) ? out : peak;
+            }
+        }
+
+      CHECK(over == 0, "ahead %d: %d samples over threshold", ahead, over);
+      CHECK(louder == 0, "ahead %d: %d samples louder than input",
+            ahead, louder);
+
+      printf("  ahead %3d: peak %d (threshold %d)\n", ahead, peak, threshold);
+    }
+
+  /* Quiet input is passed through as it is (after delay) */
+
+  for (int i = 0; i < TEST_FRAMES * 2; i++)
+    {
+      s_out32[i] = s_in32[i] >> 3;
+    }
+
+  s_engine.init(2, 24);
+  set_limiter(32767, 32, 14);
+  set_enable(PostFilterBlockLimiter);
+
+  exec_in_chunks(s_out32, s_out32, TEST_FRAMES, 8);
+
+  int mismatch = 0;
+
+  for (int i = 31; i < TEST_FRAMES; i++)
+    {
+      mismatch += (s_out32[2 * i] != (s_in32[2 * (i - 31)] >> 3));
+    }
+
+  CHECK(mismatch == 0, "quiet input is changed at %d frames", mismatch);
+
+  /* Invalid parameters are rejected */
+
+  ApuSetParamPostFilterCmd cmd;
+
+  cmd.param_type            = PostFilterParamLimiter;
+  cmd.set_limiter.threshold = 32767;
+  cmd.set_limiter.release   = 14;
+
+  cmd.set_limiter.lookahead = 0;
+  CHECK(!s_engine.set(cmd), "ahead 0 accepted");
+
+  cmd.set_limiter.lookahead = POSTFILTER_LIMITER_MAX_AHEAD + 1;
+  CHECK(!s_engine.set(cmd), "ahead %d accepted",
+        POSTFILTER_LIMITER_MAX_AHEAD + 1);
+
+  cmd.set_limiter.lookahead = 1;
+  cmd.set_limiter.threshold = 32768;
+  CHECK(!s_engine.set(cmd), "threshold 32768 accepted");
+}
+
+/*--------------------------------------------------------------------*/
+static void setup_chain(uint32_t bit_width)
+{
+  int32_t coef[5];
+
+  s_engine.init(2, bit_width);
+
+  for (int band = 0; band < POSTFILTER_EQ_BAND_NUM; band++)
+    {
+      peaking_eq(60.0 * pow(4, band), (band & 1) ? -4 : 5, 1.0, coef);
+      set_eq(band, coef);
+    }
+
+  set_width((1 << 30) + (1 << 29));
+  set_limiter(30000, 64, 14);
+  set_enable(PostFilterBlockEq | PostFilterBlockWidth | PostFilterBlockLimiter);
+}
+
+/*--------------------------------------------------------------------*/
+static void test_golden(void)
+{
+  /* Whole chain must be bit exact on every target */
+
+  printf("golden\n");
+
+  setup_chain(16);
+
+  exec_in_chunks(s_in16, s_out16, TEST_FRAMES, 4);
+
+  uint32_t hash = 0x811c9dc5u;
+  const uint8_t *p = reinterpret_cast<const uint8_t *>(s_out16);
+
+  for (size_t i = 0; i < sizeof(s_out16); i++)
+    {
+      hash = (hash ^ p[i]) * 0x01000193u;
+    }
+
+  CHECK(hash == GOLDEN_CHAIN_HASH, "chain hash 0x%08x (expected 0x%08x)",
+        hash, GOLDEN_CHAIN_HASH);
+}
+
+/*--------------------------------------------------------------------*/
+static void bench(const char *name, uint32_t bit_width, uint32_t enable)
+{
+  setup_chain(bit_width);
+  set_enable(enable);
+
+  void     *buf   = (bit_width == 16) ?
+                      static_cast<void *>(s_out16) : static_cast<void *>(s_out32);
+  uint32_t  size  = (bit_width == 16) ? sizeof(s_out16) : sizeof(s_out32);
+  uint64_t  best  = UINT64_MAX;
+
+  for (int loop = 0; loop < BENCH_LOOP; loop++)
+    {
+      memcpy(buf, (bit_width == 16) ?
+                    static_cast<void *>(s_in16) : static_cast<void *>(s_in32),
+             size);
+
+      uint64_t start = read_cycles();
+
+      s_engine.exec(buf, buf, size);
+
+      uint64_t elapsed = read_cycles() - start;
+
+      best = (elapsed < best) ? elapsed : best;
+    }
+
+  printf("  %-24s %2dbit: %7.2f per sample\n",
+         name, bit_width,
+         static_cast<double>(best) / (TEST_FRAMES * 2));
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(void)
+{
+  make_stimulus();
+
+  test_through();
+  test_eq();
+  test_width();
+  test_limiter();
+  test_golden();
+
+#if defined(__x86_64__) || defined(__i386__)
+  printf("benchmark (TSC cycles)\n");
+#else
+  printf("benchmark (ns)\n");
+#endif
+
+  bench("through", 16, 0);
+  bench("eq (5 bands)", 16, PostFilterBlockEq);
+  bench("width", 16, PostFilterBlockWidth);
+  bench("limiter (ahead 64)", 16, PostFilterBlockLimiter);
+  bench("all", 16, PostFilterBlockEq | PostFilterBlockWidth |
+                   PostFilterBlockLimiter);
+  bench("all", 24, PostFilterBlockEq | PostFilterBlockWidth |
+                   PostFilterBlockLimiter);
+
+  printf("%s (%d failure)\n", (s_fail == 0) ? "PASS" : "FAIL", s_fail);
+
+  return (s_fail == 0) ? 0 : 1;
+}
@@ -49,6 +49,8 @@ CONTEXTDIRS += $(DNNDIR)
 endif
 
 SDKCLEANDIRS += $(DNNDIR)
+SDKCLEANDIRS += $(DNNDIR)$(DELIM)worker
+SDKCLEANDIRS += $(DNNDIR)$(DELIM)worker$(DELIM)lib
 
 $(DNNDIR)$(DELIM)$(LIBRT) $(DNNDIR)$(DELIM)$(LIBFUNC) $(DNNDIR)$(DELIM)$(LIBDNN): context
 	$(Q) $(MAKE) -C $(DNNDIR) TOPDIR="$(TOPDIR)" SDKDIR="$(SDKDIR)"
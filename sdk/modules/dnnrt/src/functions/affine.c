@@ -41,6 +41,9 @@
 #include <context.h>
 #include <implements/neural_network/affine/affine_internal.h>
 #include <runtime/runtime_common.h>
+#include <runtime/runtime_fusion.h>
+#include <runtime/runtime_mp.h>
+#include <runtime/runtime_quant.h>
 #include <runtime_internal.h>
 #include <arm_nnfunctions.h>
 
@@ -52,169 +55,113 @@
 typedef int16_t fixed16_t;
 typedef int8_t fixed8_t;
 
-static rt_function_error_t dnnrt_exec_affine_fixed16(rt_function_t * f)
+static rt_function_error_t
+dnnrt_exec_affine_kernel(rt_function_t * f, dnn_mp_kernel_t kernel,
+                         int elem_size)
 {
   affine_private_t *p =
     (affine_private_t
      *) (((affine_local_context_t *) (f->local_context))->data);
-  int k;
-  fixed16_t *input = (fixed16_t *) (p->input->data);
-  fixed16_t *weight = (fixed16_t *) (p->weight->data);
-  fixed16_t *output = (fixed16_t *) (p->output->data);
-  fixed16_t *bias = 0;
-  uint16_t bias_shift = 0;
-  uint16_t out_shift = p->input->fp_pos + p->weight->fp_pos - p->output->fp_pos;
-
-  if (p->bias)
+  const dnn_fusion_t *fu = dnn_fusion_of(f);
+  dnn_mp_job_t jobs[DNN_MP_MAX_CPUS];
+  dnn_mp_affine_t a;
+  const uint8_t *weight = (const uint8_t *)(p->weight->data);
+  const uint8_t *bias = p->bias ? (const uint8_t *)(p->bias->data) : 0;
+  uint8_t *output = (uint8_t *) (dnn_fusion_output(f, fu)->data);
+  int rows = p->output_loop_size;
+  int parts = dnn_mp_parts(rows, (unsigned long)p->base_loop_size * rows *
+                           p->input_loop_size);
+  int i;
+
+  memset(&a, 0, sizeof(a));
+  a.in = p->input->data;
+  a.batch = p->base_loop_size;
+  a.in_size = p->input_loop_size;
+  a.out_stride = rows;
+  if (kernel != DNN_MP_AFFINE_F32)
     {
-      bias = (fixed16_t *) (p->bias->data);
-      bias_shift = p->input->fp_pos + p->weight->fp_pos - p->bias->fp_pos;
-    }
-
-  for (k = 0; k < p->base_loop_size; k++)
-    {
-      int output_offset = k * p->output_loop_size;
-      int input_offset = k * p->input_loop_size;
-
-      fixed16_t *x = input + input_offset;
-      fixed16_t *y = output + output_offset;
-
-      arm_fully_connected_q15(x, weight, p->input_loop_size,
-                              p->output_loop_size, bias_shift, out_shift,
-                              bias, y, 0);
+      a.out_shift = p->input->fp_pos + p->weight->fp_pos - p->output->fp_pos;
+      if (p->bias)
+        {
+          a.bias_shift = p->input->fp_pos + p->weight->fp_pos -
+            p->bias->fp_pos;
+        }
     }
 
-  return RT_FUNCTION_ERROR_NOERROR;
-}
+  /* split output rows, weight and bias follow them */
 
-static rt_function_error_t dnnrt_exec_affine_fixed8(rt_function_t * f)
-{
-  affine_private_t *p =
-    (affine_private_t
-     *) (((affine_local_context_t *) (f->local_context))->data);
-  int k;
-  fixed8_t *input = (fixed8_t *) (p->input->data);
-  fixed8_t *weight = (fixed8_t *) (p->weight->data);
-  fixed8_t *output = (fixed8_t *) (p->output->data);
-  fixed8_t *bias = 0;
-  uint16_t bias_shift = 0;
-  uint16_t out_shift = p->input->fp_pos + p->weight->fp_pos - p->output->fp_pos;
-  q15_t *vec_buffer = (q15_t *) dnn_scratch_buf();
-
-  if (p->bias)
+  for (i = 0; i < parts; i++)
     {
-      bias = (fixed8_t *) (p->bias->data);
-      bias_shift = p->input->fp_pos + p->weight->fp_pos - p->bias->fp_pos;
+      int r0 = rows * i / parts;
+      int r1 = rows * (i + 1) / parts;
+
+      jobs[i].kernel = kernel;
+      jobs[i].scratch = dnn_scratch_buf_part(i);
+      jobs[i].u.affine = a;
+      jobs[i].u.affine.wt = weight + r0 * p->input_loop_size * elem_size;
+      jobs[i].u.affine.bias = bias ? bias + r0 * elem_size : 0;
+      jobs[i].u.affine.out = output + r0 * elem_size;
+      jobs[i].u.affine.out_size = r1 - r0;
+      dnn_fusion_post(fu, &jobs[i], 0, 0, elem_size);
     }
 
-  for (k = 0; k < p->base_loop_size; k++)
+  if (dnn_mp_exec(jobs, parts) != 0)
     {
-      int output_offset = k * p->output_loop_size;
-      int input_offset = k * p->input_loop_size;
-
-      fixed8_t *x = input + input_offset;
-      fixed8_t *y = output + output_offset;
-
-      arm_fully_connected_q7(x, weight, p->input_loop_size,
-                             p->output_loop_size, bias_shift, out_shift,
-                             bias, y, vec_buffer);
+      return RT_FUNCTION_ERROR_UNIMPLEMENTED;
     }
 
   return RT_FUNCTION_ERROR_NOERROR;
 }
 
-static rt_function_error_t dnnrt_exec_affine_float(rt_function_t * f)
+/* int8 affine quantized per output row */
+
+static rt_function_error_t dnnrt_exec_affine_quant(rt_function_t * f)
 {
   affine_private_t *p =
     (affine_private_t
      *) (((affine_local_context_t *) (f->local_context))->data);
-  int i, j, k;                  // Iterators.
-  float *input = (float *)(p->input->data);
-  float *output = (float *)(p->output->data);
-  float *bias = p->bias ? (float *)(p->bias->data) : 0;
-  int output_loop_size = p->output_loop_size;
-  int input_loop_size = p->input_loop_size;
-
-  for (k = 0; k < p->base_loop_size; k++)
+  const dnn_fusion_t *fu = dnn_fusion_of(f);
+  dnn_mp_job_t jobs[DNN_MP_MAX_CPUS];
+  dnn_mp_affine_t a;
+  dnn_mp_quant_t q;
+  const int8_t *weight = (const int8_t *)(p->weight->data);
+  const int32_t *bias = dnn_quant_bias(f);
+  uint8_t *output = (uint8_t *) (dnn_fusion_output(f, fu)->data);
+  int out_elem_size = dnn_quant_out_elem_size(f);
+  int rows = p->output_loop_size;
+  int parts = dnn_mp_parts(rows, (unsigned long)p->base_loop_size * rows *
+                           p->input_loop_size);
+  int i;
+
+  memset(&a, 0, sizeof(a));
+  a.in = dnn_quant_input(f, &q);
+  a.batch = p->base_loop_size;
+  a.in_size = p->input_loop_size;
+  a.out_stride = rows;
+
+  /* split output rows, weight and parameters follow them */
+
+  for (i = 0; i < parts; i++)
     {
-      int output_offset = k * output_loop_size;
-      int input_offset = k * input_loop_size;
-
-      float *x = input + input_offset;
-      float *y = output + output_offset;
-      float *weight = (float *)(p->weight->data);
-
-      int input_loop_size_bulk4 = (input_loop_size / 4) * 4;
-      int loop = output_loop_size / 2;
-
-      /* process two output in a loop */
-      for (i = 0; loop--;)
-        {
-          float sum1 = 0;
-          float sum2 = 0;
-          float *weight2 = weight + input_loop_size;
-
-          for (j = 0; j < input_loop_size_bulk4;)
-            {
-              sum1 += weight[j] * x[j];
-              sum2 += weight2[j] * x[j];
-              ++j;
-              sum1 += weight[j] * x[j];
-              sum2 += weight2[j] * x[j];
-              ++j;
-              sum1 += weight[j] * x[j];
-              sum2 += weight2[j] * x[j];
-              ++j;
-              sum1 += weight[j] * x[j];
-              sum2 += weight2[j] * x[j];
-              ++j;
-            }
-
-          for (; j < input_loop_size; j++)
-            {
-              sum1 += weight[j] * x[j];
-              sum2 += weight2[j] * x[j];
-            }
-
-          y[i++] = sum1;
-          y[i++] = sum2;
-
-          weight += 2 * input_loop_size;
-        }
-
-      /* process the last output if any */
-      if (output_loop_size & 1)
-        {
-          float sum1 = 0;
-
-          for (j = 0; j < input_loop_size_bulk4;)
-            {
-              sum1 += weight[j] * x[j];
-              ++j;
-              sum1 += weight[j] * x[j];
-              ++j;
-              sum1 += weight[j] * x[j];
-              ++j;
-              sum1 += weight[j] * x[j];
-              ++j;
-            }
-
-          for (; j < input_loop_size; j++)
-            {
-              sum1 += weight[j] * x[j];
-            }
-
-          y[i++] = sum1;
-        }
+      int r0 = rows * i / parts;
+      int r1 = rows * (i + 1) / parts;
+
+      jobs[i].kernel = DNN_MP_AFFINE_S8;
+      jobs[i].scratch = dnn_scratch_buf_part(i);
+      jobs[i].u.affine = a;
+      jobs[i].u.affine.wt = weight + r0 * p->input_loop_size;
+      jobs[i].u.affine.bias = bias + r0;
+      jobs[i].u.affine.out = output + r0 * out_elem_size;
+      jobs[i].u.affine.out_size = r1 - r0;
+      jobs[i].quant = q;
+      jobs[i].quant.mult = q.mult + r0;
+      jobs[i].quant.shift = q.shift + r0;
+      dnn_fusion_post(fu, &jobs[i], 0, 0, sizeof(int8_t));
+    }
 
-      if (bias)
-        {
-          float *b = bias + output_offset;
-          for (i = 0; i < output_loop_size; i++)
-            {
-              y[i] += b[i];
-            }
-        }
+  if (dnn_mp_exec(jobs, parts) != 0)
+    {
+      return RT_FUNCTION_ERROR_UNIMPLEMENTED;
     }
 
   return RT_FUNCTION_ERROR_NOERROR;
@@ -280,42 +227,79 @@ static int var_buf_size(rt_variable_t * var)
 
 rt_function_error_t dnnrt_exec_affine(rt_function_t * f)
 {
-  affine_private_t *p =
-    (affine_private_t
-     *) (((affine_local_context_t *) (f->local_context))->data);
+  if (dnn_quant_of(f))
+    {
+      uint32_t start = dnn_profile_begin();
+      rt_function_error_t ret = dnnrt_exec_affine_quant(f);
+
+      dnn_profile_end(NN_FUNCTION_AFFINE, start);
+      return ret;
+    }
+
   int same_type = ((f->inputs[X]->type == f->inputs[WEIGHT]->type) &&
                    (f->inputs[X]->type == f->inputs[BIAS]->type) &&
                    (f->inputs[X]->type == f->outputs[Y]->type));
 
-  memset(p->output->data, 0, var_buf_size(p->output));
+  rt_variable_t *output = dnn_fusion_output(f, dnn_fusion_of(f));
+  rt_function_error_t ret;
+  uint32_t start = dnn_profile_begin();
+
+  memset(output->data, 0, var_buf_size(output));
 
   if (same_type && (f->inputs[WEIGHT]->type == NN_DATA_TYPE_INT8))
     {
-      return dnnrt_exec_affine_fixed8(f);
+      ret = dnnrt_exec_affine_kernel(f, DNN_MP_AFFINE_Q7, sizeof(fixed8_t));
+    }
+  else if (same_type && (f->inputs[WEIGHT]->type == NN_DATA_TYPE_INT16))
+    {
+      ret = dnnrt_exec_affine_kernel(f, DNN_MP_AFFINE_Q15, sizeof(fixed16_t));
     }
-  if (same_type && (f->inputs[WEIGHT]->type == NN_DATA_TYPE_INT16))
+  else if (same_type && (f->inputs[WEIGHT]->type == NN_DATA_TYPE_FLOAT))
     {
-      return dnnrt_exec_affine_fixed16(f);
+      ret = dnnrt_exec_affine_kernel(f, DNN_MP_AFFINE_F32, sizeof(float));
     }
-  if (same_type && (f->inputs[WEIGHT]->type == NN_DATA_TYPE_FLOAT))
+  else
     {
-      return dnnrt_exec_affine_float(f);
+      ret = dnnrt_exec_affine_generic(f);
     }
 
-  return dnnrt_exec_affine_generic(f);
+  dnn_profile_end(NN_FUNCTION_AFFINE, start);
+  return ret;
 }
 
 rt_return_value_t dnnrt_affine_alloc(nn_network_t * net, void *function_context)
 {
   rt_function_context_t *func = (rt_function_context_t *) function_context;
 
-  if ((int)func->info->impl != DNNRT_IMPLEMENT)
+  if (!DNN_IMPLEMENTED((int)func->info->impl))
     {
       return RT_RET_FUNCTION_DONT_MATCH;
     }
 
   allocate_function_context(net, func->info, function_context);
   rt_function_t *f = (rt_function_t *) (&func->func);
+
+  if ((int)func->info->impl == DNNRT_IMPLEMENT_QINT8)
+    {
+      affine_private_t *p =
+        (affine_private_t
+         *) (((affine_local_context_t *) (f->local_context))->data);
+
+      if (!dnn_quant_validate(f, p->output_loop_size))
+        {
+          DNN_PRINT("this NNB is unsupported by dnnrt\n");
+          return RT_RET_FUNCTION_MATCH;
+        }
+      f->exec_func = dnnrt_exec_affine;
+      dnn_req_scratch_buf(sizeof(q15_t) * p->input_loop_size);
+      return RT_RET_FUNCTION_MATCH;
+    }
+  if (f->num_of_inputs > DNN_QUANT_PARAM)
+    {
+      DNN_PRINT("this NNB is unsupported by dnnrt\n");
+      return RT_RET_FUNCTION_MATCH;
+    }
+
   f->exec_func = dnnrt_exec_affine;
 
   int scratch_buf_bsize = 0;
@@ -41,6 +41,9 @@
 #include <context.h>
 #include <implements/neural_network/convolution/convolution_internal.h>
 #include <runtime/runtime_common.h>
+#include <runtime/runtime_fusion.h>
+#include <runtime/runtime_mp.h>
+#include <runtime/runtime_quant.h>
 #include <runtime_internal.h>
 #include <utilities/shape.h>
 #include <arm_nnfunctions_nnabla.h>
@@ -78,109 +81,105 @@ static inline void var_setpos(var_t * var, int *pos, int size)
   var->offset = var_calc_offset(var, pos, size);
 }
 
-static rt_function_error_t dnnrt_exec_convolution_fixed(rt_function_t * f)
+static rt_function_error_t
+dnnrt_exec_convolution_kernel(rt_function_t * f, dnn_mp_kernel_t kernel,
+                              int elem_size)
 {
   convolution_local_context_t *c =
     (convolution_local_context_t *) f->local_context;
   convolution_private_t ctx_copy;
   ctx_copy = *(convolution_private_t *) (c->data);
   convolution_private_t *p = &ctx_copy;
+  const dnn_fusion_t *fu = dnn_fusion_of(f);
+  rt_variable_t *dst = dnn_fusion_output(f, fu);
   nn_size_t g, b;
   var_t *out_var = &p->out_var;
   var_t *in_var = &p->in_var;
   var_t *w_var = &p->w_var;
   var_t *b_var = &p->b_var;
-  uint16_t out_shift =
-    in_var->v->fp_pos + w_var->v->fp_pos - out_var->v->fp_pos;
-  uint16_t bias_shift = 0;
-  uint16_t fixed16 = f->inputs[X]->type == NN_DATA_TYPE_INT16;
-  q15_t *bufferA = (q15_t *) dnn_scratch_buf();
+  dnn_mp_job_t jobs[DNN_MP_MAX_CPUS];
+  dnn_mp_conv_t a;
+  int out_ch = out_var->shape.data[I];
+  int out_size = out_var->shape.data[W] * out_var->shape.data[H];
+  int ker_size = w_var->shape.data[W] * w_var->shape.data[H] *
+    in_var->shape.data[I];
+  int parts = dnn_mp_parts(out_ch, (unsigned long)out_ch * out_size *
+                           ker_size);
+  int i;
+
+  memset(&a, 0, sizeof(a));
+  a.in_w = in_var->shape.data[W];
+  a.in_h = in_var->shape.data[H];
+  a.in_ch = in_var->shape.data[I];
+  a.out_w = out_var->shape.data[W];
+  a.out_h = out_var->shape.data[H];
+  a.ker_w = w_var->shape.data[W];
+  a.ker_h = w_var->shape.data[H];
+  a.pad_w = c->pad.data[1];
+  a.pad_h = c->pad.data[0];
+  a.stride_w = c->stride.data[1];
+  a.stride_h = c->stride.data[0];
+  if (kernel != DNN_MP_CONV_F32)
+    {
+      a.out_shift = in_var->v->fp_pos + w_var->v->fp_pos - out_var->v->fp_pos;
+      if (p->b_var.v)
+        {
+          a.bias_shift =
+            in_var->v->fp_pos + w_var->v->fp_pos - b_var->v->fp_pos;
+        }
+    }
 
   for (b = 0; b < p->in_var.shape.data[0]; ++b)
     {
       for (g = 0; g < c->group; ++g)
         {
-          if (fixed16)
+          int i_pos[] = { b, g, 0 };
+          var_setpos(in_var, i_pos, _S(i_pos));
+          a.in = (uint8_t *) in_var->v->data + in_var->offset * elem_size;
+
+          int w_pos[] = { g, 0, 0 };
+          var_setpos(w_var, w_pos, _S(w_pos));
+          const uint8_t *wt =
+            (uint8_t *) w_var->v->data + w_var->offset * elem_size;
+
+          const uint8_t *bias = 0;
+          if (p->b_var.v)
+            {
+              int b_pos[] = { g, 0 };
+              var_setpos(b_var, b_pos, _S(b_pos));
+              bias = (uint8_t *) b_var->v->data + b_var->offset * elem_size;
+            }
+
+          int o_pos[] = { b, g, 0 };
+          var_setpos(out_var, o_pos, _S(o_pos));
+
+          /* output of fused ReLU is written directly */
+
+          uint8_t *Im_out =
+            (uint8_t *) dst->data + out_var->offset * elem_size;
+          int plane = out_var->offset / out_size;
+
+          /* split output channels, weight and bias follow them */
+
+          for (i = 0; i < parts; i++)
             {
-              int i_pos[] = { b, g, 0 };
-              var_setpos(in_var, i_pos, _S(i_pos));
-              const q15_t *Im_in = (q15_t *) in_var->v->data + in_var->offset;
-
-              int w_pos[] = { g, 0, 0 };
-              var_setpos(w_var, w_pos, _S(w_pos));
-              const q15_t *wt = (q15_t *) w_var->v->data + w_var->offset;
-
-              const q15_t *bias = 0;
-              if (p->b_var.v)
-                {
-                  int b_pos[] = { g, 0 };
-                  var_setpos(b_var, b_pos, _S(b_pos));
-                  bias = (q15_t *) b_var->v->data + b_var->offset;
-                  bias_shift =
-                    in_var->v->fp_pos + w_var->v->fp_pos - b_var->v->fp_pos;
-                }
-
-              int o_pos[] = { b, g, 0 };
-              var_setpos(out_var, o_pos, _S(o_pos));
-              q15_t *Im_out = (q15_t *) out_var->v->data + out_var->offset;
-
-              arm_convolve_CHW_q15_basic_nonsquare(Im_in,
-                                                   in_var->shape.data[W],
-                                                   in_var->shape.data[H],
-                                                   in_var->shape.data[I], wt,
-                                                   p->out_var.shape.data[I],
-                                                   w_var->shape.data[W],
-                                                   w_var->shape.data[H],
-                                                   c->pad.data[1],
-                                                   c->pad.data[0],
-                                                   c->stride.data[1],
-                                                   c->stride.data[0], bias,
-                                                   bias_shift, out_shift,
-                                                   Im_out,
-                                                   out_var->shape.data[W],
-                                                   out_var->shape.data[H],
-                                                   bufferA, 0);
+              int ch0 = out_ch * i / parts;
+              int ch1 = out_ch * (i + 1) / parts;
+
+              jobs[i].kernel = kernel;
+              jobs[i].scratch = dnn_scratch_buf_part(i);
+              jobs[i].u.conv = a;
+              jobs[i].u.conv.wt = wt + ch0 * ker_size * elem_size;
+              jobs[i].u.conv.bias = bias ? bias + ch0 * elem_size : 0;
+              jobs[i].u.conv.out = Im_out + ch0 * out_size * elem_size;
+              jobs[i].u.conv.out_ch = ch1 - ch0;
+              dnn_fusion_post(fu, &jobs[i], plane + ch0, ch1 - ch0,
+                              elem_size);
             }
-          else
+
+          if (dnn_mp_exec(jobs, parts) != 0)
             {
-              int i_pos[] = { b, g, 0 };
-              var_setpos(in_var, i_pos, _S(i_pos));
-              const q7_t *Im_in = (q7_t *) in_var->v->data + in_var->offset;
-
-              int w_pos[] = { g, 0, 0 };
-              var_setpos(w_var, w_pos, _S(w_pos));
-              const q7_t *wt = (q7_t *) w_var->v->data + w_var->offset;
-
-              const q7_t *bias = 0;
-              if (p->b_var.v)
-                {
-                  int b_pos[] = { g, 0 };
-                  var_setpos(b_var, b_pos, _S(b_pos));
-                  bias = (q7_t *) b_var->v->data + b_var->offset;
-                  bias_shift =
-                    in_var->v->fp_pos + w_var->v->fp_pos - b_var->v->fp_pos;
-                }
-
-              int o_pos[] = { b, g, 0 };
-              var_setpos(out_var, o_pos, _S(o_pos));
-              q7_t *Im_out = (q7_t *) out_var->v->data + out_var->offset;
-
-              arm_convolve_CHW_q7_basic_nonsquare(Im_in,
-                                                  in_var->shape.data[W],
-                                                  in_var->shape.data[H],
-                                                  in_var->shape.data[I], wt,
-                                                  p->out_var.shape.data[I],
-                                                  w_var->shape.data[W],
-                                                  w_var->shape.data[H],
-                                                  c->pad.data[1],
-                                                  c->pad.data[0],
-                                                  c->stride.data[1],
-                                                  c->stride.data[0], bias,
-                                                  bias_shift, out_shift,
-                                                  Im_out,
-                                                  out_var->shape.data[W],
-                                                  out_var->shape.data[H],
-                                                  bufferA, 0);
+              return RT_FUNCTION_ERROR_UNIMPLEMENTED;
             }
         }
     }
@@ -188,61 +187,92 @@ static rt_function_error_t dnnrt_exec_convolution_fixed(rt_function_t * f)
   return RT_FUNCTION_ERROR_NOERROR;
 }
 
-static rt_function_error_t dnnrt_exec_convolution_float(rt_function_t * f)
+/* int8 convolution quantized per output channel */
+
+static rt_function_error_t dnnrt_exec_convolution_quant(rt_function_t * f)
 {
   convolution_local_context_t *c =
     (convolution_local_context_t *) f->local_context;
   convolution_private_t ctx_copy;
   ctx_copy = *(convolution_private_t *) (c->data);
   convolution_private_t *p = &ctx_copy;
-  nn_size_t group = c->group;
-  nn_size_t batch_size = p->in_var.shape.data[0];
+  const dnn_fusion_t *fu = dnn_fusion_of(f);
+  rt_variable_t *dst = dnn_fusion_output(f, fu);
   nn_size_t g, b;
   var_t *out_var = &p->out_var;
   var_t *in_var = &p->in_var;
   var_t *w_var = &p->w_var;
-  var_t *b_var = &p->b_var;
-  float *bufferA = (float *)dnn_scratch_buf();
+  dnn_mp_job_t jobs[DNN_MP_MAX_CPUS];
+  dnn_mp_conv_t a;
+  dnn_mp_quant_t q;
+  const int8_t *in = dnn_quant_input(f, &q);
+  const int32_t *bias = dnn_quant_bias(f);
+  int out_elem_size = dnn_quant_out_elem_size(f);
+  int out_ch = out_var->shape.data[I];
+  int out_size = out_var->shape.data[W] * out_var->shape.data[H];
+  int ker_size = w_var->shape.data[W] * w_var->shape.data[H] *
+    in_var->shape.data[I];
+  int parts = dnn_mp_parts(out_ch, (unsigned long)out_ch * out_size *
+                           ker_size);
+  int i;
+
+  memset(&a, 0, sizeof(a));
+  a.in_w = in_var->shape.data[W];
+  a.in_h = in_var->shape.data[H];
+  a.in_ch = in_var->shape.data[I];
+  a.out_w = out_var->shape.data[W];
+  a.out_h = out_var->shape.data[H];
+  a.ker_w = w_var->shape.data[W];
+  a.ker_h = w_var->shape.data[H];
+  a.pad_w = c->pad.data[1];
+  a.pad_h = c->pad.data[0];
+  a.stride_w = c->stride.data[1];
+  a.stride_h = c->stride.data[0];
 
-  for (b = 0; b < batch_size; ++b)
+  for (b = 0; b < p->in_var.shape.data[0]; ++b)
     {
-      for (g = 0; g < group; ++g)
+      for (g = 0; g < c->group; ++g)
         {
           int i_pos[] = { b, g, 0 };
           var_setpos(in_var, i_pos, _S(i_pos));
-          const float *Im_in = (float *)in_var->v->data + in_var->offset;
+          a.in = in + in_var->offset;
 
           int w_pos[] = { g, 0, 0 };
           var_setpos(w_var, w_pos, _S(w_pos));
-          const float *wt = (float *)w_var->v->data + w_var->offset;
+          const int8_t *wt = (const int8_t *)w_var->v->data + w_var->offset;
 
-          const float *bias = 0;
-          if (p->b_var.v)
+          int o_pos[] = { b, g, 0 };
+          var_setpos(out_var, o_pos, _S(o_pos));
+
+          uint8_t *Im_out =
+            (uint8_t *) dst->data + out_var->offset * out_elem_size;
+          int plane = out_var->offset / out_size;
+
+          /* split output channels, parameters of channels follow them */
+
+          for (i = 0; i < parts; i++)
             {
-              int b_pos[] = { g, 0 };
-              var_setpos(b_var, b_pos, _S(b_pos));
-              bias = (float *)b_var->v->data + b_var->offset;
+              int ch0 = out_ch * i / parts;
+              int ch1 = out_ch * (i + 1) / parts;
+
+              jobs[i].kernel = DNN_MP_CONV_S8;
+              jobs[i].scratch = dnn_scratch_buf_part(i);
+              jobs[i].u.conv = a;
+              jobs[i].u.conv.wt = wt + ch0 * ker_size;
+              jobs[i].u.conv.bias = bias + g * out_ch + ch0;
+              jobs[i].u.conv.out = Im_out + ch0 * out_size * out_elem_size;
+              jobs[i].u.conv.out_ch = ch1 - ch0;
+              jobs[i].quant = q;
+              jobs[i].quant.mult = q.mult + g * out_ch + ch0;
+              jobs[i].quant.shift = q.shift + g * out_ch + ch0;
+              dnn_fusion_post(fu, &jobs[i], plane + ch0, ch1 - ch0,
+                              sizeof(int8_t));
             }
 
-          int o_pos[] = { b, g, 0 };
-          var_setpos(out_var, o_pos, _S(o_pos));
-          float *Im_out = (float *)out_var->v->data + out_var->offset;
-
-          arm_convolve_CHW_f32_basic_nonsquare(Im_in,
-                                               in_var->shape.data[W],
-                                               in_var->shape.data[H],
-                                               in_var->shape.data[I], wt,
-                                               p->out_var.shape.data[I],
-                                               w_var->shape.data[W],
-                                               w_var->shape.data[H],
-                                               c->pad.data[1],
-                                               c->pad.data[0],
-                                               c->stride.data[1],
-                                               c->stride.data[0], bias,
-                                               Im_out,
-                                               out_var->shape.data[W],
-                                               out_var->shape.data[H],
-                                               bufferA, 0);
+          if (dnn_mp_exec(jobs, parts) != 0)
+            {
+              return RT_FUNCTION_ERROR_UNIMPLEMENTED;
+            }
         }
     }
 
@@ -276,23 +306,40 @@ static int var_buf_size(rt_variable_t * var)
 
 rt_function_error_t dnnrt_exec_convolution(rt_function_t * f)
 {
-  convolution_local_context_t *c =
-    (convolution_local_context_t *) f->local_context;
-  convolution_private_t *p = (convolution_private_t *) (c->data);
+  rt_variable_t *dst = dnn_fusion_output(f, dnn_fusion_of(f));
+  rt_function_error_t ret;
+  uint32_t start = dnn_profile_begin();
 
-  memset(p->out_var.v->data, 0, var_buf_size(p->out_var.v));
+  if (dnn_quant_of(f))
+    {
+      ret = dnnrt_exec_convolution_quant(f);
+      dnn_profile_end(NN_FUNCTION_CONVOLUTION, start);
+      return ret;
+    }
+
+  memset(dst->data, 0, var_buf_size(dst));
 
   if (f->inputs[X]->type == NN_DATA_TYPE_FLOAT)
     {
-      return dnnrt_exec_convolution_float(f);
+      ret = dnnrt_exec_convolution_kernel(f, DNN_MP_CONV_F32, sizeof(float));
+    }
+  else if (f->inputs[X]->type == NN_DATA_TYPE_INT16)
+    {
+      ret = dnnrt_exec_convolution_kernel(f, DNN_MP_CONV_Q15,
+                                          sizeof(fixed16_t));
     }
   else
     {
-      return dnnrt_exec_convolution_fixed(f);
+      ret = dnnrt_exec_convolution_kernel(f, DNN_MP_CONV_Q7,
+                                          sizeof(fixed8_t));
     }
+
+  dnn_profile_end(NN_FUNCTION_CONVOLUTION, start);
+  return ret;
 }
 
-static inline int validate_params(rt_function_t * f, int *scratch_buf_bsize)
+static inline int validate_params(rt_function_t * f, int impl,
+                                  int *scratch_buf_bsize)
 {
   convolution_local_context_t *c;
   c = (convolution_local_context_t *) f->local_context;
@@ -304,6 +351,17 @@ static inline int validate_params(rt_function_t * f, int *scratch_buf_bsize)
       return 0;
     };
 
+  if (impl == DNNRT_IMPLEMENT_QINT8)
+    {
+      *scratch_buf_bsize = sizeof(fixed16_t) * p->kernel_shape.data[0] *
+        p->kernel_shape.data[1] * p->in_var.shape.data[I];
+      return dnn_quant_validate(f, p->out_var.shape.data[I] * c->group);
+    }
+  if (f->num_of_inputs > DNN_QUANT_PARAM)
+    {
+      return 0;
+    }
+
   int cond1;
   cond1 = f->inputs[X]->type == NN_DATA_TYPE_INT16;
   cond1 &= f->inputs[WEIGHT]->type == NN_DATA_TYPE_INT16;
@@ -344,14 +402,15 @@ dnnrt_convolution_alloc(nn_network_t * net, void *function_context)
   rt_function_context_t *func = (rt_function_context_t *) function_context;
   int scratch_buf_bsize = 0;
 
-  if ((int)func->info->impl != DNNRT_IMPLEMENT)
+  if (!DNN_IMPLEMENTED((int)func->info->impl))
     {
       return RT_RET_FUNCTION_DONT_MATCH;
     }
 
   allocate_function_context(net, func->info, function_context);
 
-  if (!validate_params(&func->func, &scratch_buf_bsize))
+  if (!validate_params(&func->func, (int)func->info->impl,
+                       &scratch_buf_bsize))
     {
       DNN_PRINT("this NNB is unsupported by dnnrt\n");
       return RT_RET_FUNCTION_MATCH;
@@ -0,0 +1,272 @@
+/****************************************************************************
+ * modules/dnnrt/src/functions/depthwise_convolution.c
+ *
+ *   Copyright 2018 Sony Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Corporation nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/* Depthwise convolution of 2D inputs in CHW layout with multiplier 1
+ * and no dilation. Channels are split across CPUs. ReLU and pooling
+ * which follow it may be fused (see runtime_fusion.c).
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <nnablart/functions.h>
+#include <nnablart/runtime.h>
+#include <dnnrt/runtime.h>
+#include <context.h>
+#include <runtime/runtime_common.h>
+#include <runtime/runtime_fusion.h>
+#include <runtime/runtime_mp.h>
+#include <runtime/runtime_quant.h>
+#include <runtime_internal.h>
+#include <utilities/shape.h>
+
+#define X (0)                   // x input
+#define WEIGHT (1)              // weight
+#define BIAS (2)                // bias
+#define Y (0)                   // y output
+
+#define DIM_MAX (0xffff)
+
+static int elem_size_of(nn_data_type_t type)
+{
+  if (type == NN_DATA_TYPE_FLOAT)
+    {
+      return sizeof(float);
+    }
+  else if (type == NN_DATA_TYPE_INT16)
+    {
+      return sizeof(int16_t);
+    }
+  else if (type == NN_DATA_TYPE_INT8)
+    {
+      return sizeof(int8_t);
+    }
+  return 0;
+}
+
+static dnn_mp_kernel_t dwconv_kernel(nn_data_type_t type)
+{
+  if (type == NN_DATA_TYPE_FLOAT)
+    {
+      return DNN_MP_DWCONV_F32;
+    }
+  else if (type == NN_DATA_TYPE_INT16)
+    {
+      return DNN_MP_DWCONV_Q15;
+    }
+  return DNN_MP_DWCONV_Q7;
+}
+
+rt_function_error_t dnnrt_exec_depthwise_convolution(rt_function_t * f)
+{
+  depthwise_convolution_local_context_t *c =
+    (depthwise_convolution_local_context_t *) f->local_context;
+  const dnn_fusion_t *fu = dnn_fusion_of(f);
+  rt_variable_t *x = f->inputs[X];
+  rt_variable_t *w = f->inputs[WEIGHT];
+  rt_variable_t *bias = f->num_of_inputs > BIAS ? f->inputs[BIAS] : NULL;
+  rt_variable_t *y = dnn_fusion_output(f, fu);
+  int nx = x->shape.size;
+  int ny = y->shape.size;
+  int quant = dnn_quant_of(f);
+  int elem_size = quant ? sizeof(int8_t) : elem_size_of(x->type);
+  int out_elem_size = quant ? dnn_quant_out_elem_size(f) : elem_size;
+  const uint8_t *x_data = (const uint8_t *)x->data;
+  const uint8_t *bias_data = bias ? (const uint8_t *)bias->data : NULL;
+  int bias_elem_size = elem_size;
+  dnn_mp_kernel_t kernel = dwconv_kernel(x->type);
+  dnn_mp_quant_t q;
+  int batch = 1;
+  int ch = x->shape.data[nx - 3];
+  int in_size = x->shape.data[nx - 2] * x->shape.data[nx - 1];
+  int out_size = y->shape.data[ny - 2] * y->shape.data[ny - 1];
+  int ker_size = w->shape.data[1] * w->shape.data[2];
+  dnn_mp_job_t jobs[DNN_MP_MAX_CPUS];
+  dnn_mp_conv_t a;
+  int parts;
+  int b, i;
+  uint32_t start = dnn_profile_begin();
+
+  for (i = 0; i < c->base_axis; i++)
+    {
+      batch *= x->shape.data[i];
+    }
+  parts = dnn_mp_parts(ch, (unsigned long)ch * out_size * ker_size);
+
+  memset(&a, 0, sizeof(a));
+  a.in_w = x->shape.data[nx - 1];
+  a.in_h = x->shape.data[nx - 2];
+  a.out_w = y->shape.data[ny - 1];
+  a.out_h = y->shape.data[ny - 2];
+  a.ker_w = w->shape.data[2];
+  a.ker_h = w->shape.data[1];
+  a.pad_w = c->pad.data[1];
+  a.pad_h = c->pad.data[0];
+  a.stride_w = c->stride.data[1];
+  a.stride_h = c->stride.data[0];
+  if (quant)
+    {
+      kernel = DNN_MP_DWCONV_S8;
+      x_data = (const uint8_t *)dnn_quant_input(f, &q);
+      bias_data = (const uint8_t *)dnn_quant_bias(f);
+      bias_elem_size = sizeof(int32_t);
+    }
+  else if (x->type != NN_DATA_TYPE_FLOAT)
+    {
+      a.out_shift = x->fp_pos + w->fp_pos - y->fp_pos;
+      if (bias)
+        {
+          a.bias_shift = x->fp_pos + w->fp_pos - bias->fp_pos;
+        }
+    }
+
+  for (b = 0; b < batch; b++)
+    {
+      const uint8_t *in = x_data + b * ch * in_size * elem_size;
+      uint8_t *out = (uint8_t *) y->data + b * ch * out_size * out_elem_size;
+
+      /* split channels, weight and bias follow them */
+
+      for (i = 0; i < parts; i++)
+        {
+          int ch0 = ch * i / parts;
+          int ch1 = ch * (i + 1) / parts;
+
+          jobs[i].kernel = kernel;
+          jobs[i].scratch = NULL;
+          jobs[i].u.conv = a;
+          jobs[i].u.conv.in = in + ch0 * in_size * elem_size;
+          jobs[i].u.conv.wt =
+            (uint8_t *) w->data + ch0 * ker_size * elem_size;
+          jobs[i].u.conv.bias =
+            bias_data ? bias_data + ch0 * bias_elem_size : NULL;
+          jobs[i].u.conv.out = out + ch0 * out_size * out_elem_size;
+          jobs[i].u.conv.in_ch = ch1 - ch0;
+          jobs[i].u.conv.out_ch = ch1 - ch0;
+          if (quant)
+            {
+              jobs[i].quant = q;
+              jobs[i].quant.mult = q.mult + ch0;
+              jobs[i].quant.shift = q.shift + ch0;
+            }
+          dnn_fusion_post(fu, &jobs[i], b * ch + ch0, ch1 - ch0, elem_size);
+        }
+
+      if (dnn_mp_exec(jobs, parts) != 0)
+        {
+          return RT_FUNCTION_ERROR_UNIMPLEMENTED;
+        }
+    }
+
+  dnn_profile_end(NN_FUNCTION_DEPTHWISE_CONVOLUTION, start);
+  return RT_FUNCTION_ERROR_NOERROR;
+}
+
+static int validate_params(rt_function_t * f, int impl)
+{
+  depthwise_convolution_local_context_t *c =
+    (depthwise_convolution_local_context_t *) f->local_context;
+  rt_variable_t *x = f->inputs[X];
+  rt_variable_t *w = f->inputs[WEIGHT];
+  rt_variable_t *bias = f->num_of_inputs > BIAS ? f->inputs[BIAS] : NULL;
+  rt_variable_t *y = f->outputs[Y];
+  int nx = x->shape.size;
+  int i;
+
+  if (nx != c->base_axis + 3 || y->shape.size != nx ||
+      w->shape.size != 3 || c->multiplier != 1 ||
+      c->pad.size != 2 || c->stride.size != 2 || c->dilation.size != 2 ||
+      c->dilation.data[0] != 1 || c->dilation.data[1] != 1 ||
+      w->shape.data[0] != x->shape.data[nx - 3] ||
+      y->shape.data[nx - 3] != x->shape.data[nx - 3])
+    {
+      return 0;
+    }
+
+  for (i = nx - 3; i < nx; i++)
+    {
+      if (x->shape.data[i] > DIM_MAX || y->shape.data[i] > DIM_MAX)
+        {
+          return 0;
+        }
+    }
+
+  if (impl == DNNRT_IMPLEMENT_QINT8)
+    {
+      return dnn_quant_validate(f, x->shape.data[nx - 3]);
+    }
+  if (f->num_of_inputs > DNN_QUANT_PARAM)
+    {
+      return 0;
+    }
+
+  if (elem_size_of(x->type) == 0 || w->type != x->type ||
+      y->type != x->type || (bias && bias->type != x->type))
+    {
+      return 0;
+    }
+
+  /* shifts of CMSIS-NN style fixed point kernel */
+
+  if (x->type != NN_DATA_TYPE_FLOAT &&
+      (x->fp_pos + w->fp_pos < y->fp_pos ||
+       (bias && x->fp_pos + w->fp_pos < bias->fp_pos)))
+    {
+      return 0;
+    }
+
+  return 1;
+}
+
+rt_return_value_t
+dnnrt_depthwise_convolution_alloc(nn_network_t * net, void *function_context)
+{
+  rt_function_context_t *func = (rt_function_context_t *) function_context;
+
+  if (!DNN_IMPLEMENTED((int)func->info->impl))
+    {
+      return RT_RET_FUNCTION_DONT_MATCH;
+    }
+
+  allocate_function_context(net, func->info, function_context);
+
+  if (!validate_params(&func->func, (int)func->info->impl))
+    {
+      DNN_PRINT("this NNB is unsupported by dnnrt\n");
+      return RT_RET_FUNCTION_MATCH;
+    }
+
+  func->func.exec_func = dnnrt_exec_depthwise_convolution;
+  return RT_RET_FUNCTION_MATCH;
+}
@@ -0,0 +1,851 @@
+/****************************************************************************
+ * modules/dnnrt/src/functions/mp_kernel.c
+ *
+ *   Copyright 2018 Sony Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Corporation nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/* Kernels executed for a part of a layer. This file is also built into
+ * the ASMP worker, so it must not depend on nnabla-c-runtime or NuttX.
+ */
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <arm_nnfunctions.h>
+#include <arm_nnfunctions_nnabla.h>
+#include <arm_nnsupportfunctions.h>
+#include <runtime/runtime_mp.h>
+
+static void affine_float(const float *x, const float *weight, float *y,
+                         int input_loop_size, int output_loop_size)
+{
+  int i, j;
+  int input_loop_size_bulk4 = (input_loop_size / 4) * 4;
+  int loop = output_loop_size / 2;
+
+  /* process two output in a loop */
+  for (i = 0; loop--;)
+    {
+      float sum1 = 0;
+      float sum2 = 0;
+      const float *weight2 = weight + input_loop_size;
+
+      for (j = 0; j < input_loop_size_bulk4;)
+        {
+          sum1 += weight[j] * x[j];
+          sum2 += weight2[j] * x[j];
+          ++j;
+          sum1 += weight[j] * x[j];
+          sum2 += weight2[j] * x[j];
+          ++j;
+          sum1 += weight[j] * x[j];
+          sum2 += weight2[j] * x[j];
+          ++j;
+          sum1 += weight[j] * x[j];
+          sum2 += weight2[j] * x[j];
+          ++j;
+        }
+
+      for (; j < input_loop_size; j++)
+        {
+          sum1 += weight[j] * x[j];
+          sum2 += weight2[j] * x[j];
+        }
+
+      y[i++] = sum1;
+      y[i++] = sum2;
+
+      weight += 2 * input_loop_size;
+    }
+
+  /* process the last output if any */
+  if (output_loop_size & 1)
+    {
+      float sum1 = 0;
+
+      for (j = 0; j < input_loop_size_bulk4;)
+        {
+          sum1 += weight[j] * x[j];
+          ++j;
+          sum1 += weight[j] * x[j];
+          ++j;
+          sum1 += weight[j] * x[j];
+          ++j;
+          sum1 += weight[j] * x[j];
+          ++j;
+        }
+
+      for (; j < input_loop_size; j++)
+        {
+          sum1 += weight[j] * x[j];
+        }
+
+      y[i++] = sum1;
+    }
+}
+
+/* ReLU in place. arm_relu_q7/q15() take 16bit size, so the data is
+ * processed in chunks.
+ */
+
+#define RELU_CHUNK (0x8000)
+
+static void relu_f32(float *data, int size)
+{
+  int i;
+
+  for (i = 0; i < size; i++)
+    {
+      if (data[i] < 0.0f)
+        {
+          data[i] = 0.0f;
+        }
+    }
+}
+
+static void relu_q15(q15_t * data, int size)
+{
+  while (size > 0)
+    {
+      int n = size > RELU_CHUNK ? RELU_CHUNK : size;
+
+      arm_relu_q15(data, n);
+      data += n;
+      size -= n;
+    }
+}
+
+static void relu_q7(q7_t * data, int size)
+{
+  while (size > 0)
+    {
+      int n = size > RELU_CHUNK ? RELU_CHUNK : size;
+
+      arm_relu_q7(data, n);
+      data += n;
+      size -= n;
+    }
+}
+
+/* Window of one output along an axis. Window is clipped by input and
+ * the number of elements for average pooling is returned by *num.
+ * Padded elements are counted up to the end of padding if including_pad.
+ */
+
+static inline void pool_window(int o, int stride, int pad, int ker, int in,
+                               int including_pad, int *start, int *end,
+                               int *num)
+{
+  int s = o * stride - pad;
+  int e = s + ker;
+
+  if (e > in + pad)
+    {
+      e = in + pad;
+    }
+  *num = e - s;
+
+  if (s < 0)
+    {
+      s = 0;
+    }
+  if (e > in)
+    {
+      e = in;
+    }
+  if (!including_pad)
+    {
+      *num = e - s;
+    }
+  *start = s;
+  *end = e;
+}
+
+/* average of fixed point values, rounded to the nearest */
+
+static inline int32_t div_round(int32_t sum, int32_t num)
+{
+  return sum >= 0 ? (sum + num / 2) / num : (sum - num / 2) / num;
+}
+
+#define DIV_F32(sum, num) ((sum) / (num))
+
+#define DEFINE_POOL(name, type, acc_type, lowest, div)                        \
+  static void name(const dnn_mp_pool_t * a)                                   \
+  {                                                                           \
+    const type *in = (const type *)a->in;                                     \
+    type *out = (type *)a->out;                                               \
+    int in_size = a->in_w * a->in_h;                                          \
+    int c, oy, ox, y, x;                                                      \
+                                                                              \
+    for (c = 0; c < a->ch; c++, in += in_size)                                \
+      {                                                                       \
+        for (oy = 0; oy < a->out_h; oy++)                                     \
+          {                                                                   \
+            int y0, y1, ny;                                                   \
+                                                                              \
+            pool_window(oy, a->stride_h, a->pad_h, a->ker_h, a->in_h,        \
+                        a->including_pad, &y0, &y1, &ny);                     \
+            for (ox = 0; ox < a->out_w; ox++)                                 \
+              {                                                               \
+                int x0, x1, nx;                                               \
+                acc_type v;                                                   \
+                                                                              \
+                pool_window(ox, a->stride_w, a->pad_w, a->ker_w, a->in_w,    \
+                            a->including_pad, &x0, &x1, &nx);                 \
+                if (a->op == DNN_MP_POOL_MAX)                                 \
+                  {                                                           \
+                    v = lowest;                                               \
+                    for (y = y0; y < y1; y++)                                 \
+                      {                                                       \
+                        const type *row = in + y * a->in_w;                   \
+                        for (x = x0; x < x1; x++)                             \
+                          {                                                   \
+                            if (row[x] > v)                                   \
+                              {                                               \
+                                v = row[x];                                   \
+                              }                                               \
+                          }                                                   \
+                      }                                                       \
+                  }                                                           \
+                else                                                          \
+                  {                                                           \
+                    v = 0;                                                    \
+                    for (y = y0; y < y1; y++)                                 \
+                      {                                                       \
+                        const type *row = in + y * a->in_w;                   \
+                        for (x = x0; x < x1; x++)                             \
+                          {                                                   \
+                            v += row[x];                                      \
+                          }                                                   \
+                      }                                                       \
+                    v = (nx * ny > 0) ? div(v, nx * ny) : 0;                  \
+                  }                                                           \
+                *out++ = (type)v;                                             \
+              }                                                               \
+          }                                                                   \
+      }                                                                       \
+  }
+
+DEFINE_POOL(pool_f32, float, float, -3.402823466e+38f, DIV_F32)
+DEFINE_POOL(pool_q15, q15_t, int32_t, -32768, div_round)
+DEFINE_POOL(pool_q7, q7_t, int32_t, -128, div_round)
+
+/* Depthwise convolution with multiplier 1 in CHW layout.
+ * Range of kernel inside the input is computed once for each output
+ * row and column, so the inner loop has no bounds check.
+ */
+
+#define DWCONV_INIT_F32(a, bias, c) ((bias) ? (bias)[c] : 0.0f)
+#define DWCONV_STORE_F32(a, acc, bits) (acc)
+#define DWCONV_INIT_FIXED(a, bias, c)                                         \
+  (((bias) ? ((int32_t)(bias)[c] << (a)->bias_shift) : 0) +                   \
+   ((a)->out_shift ? (1 << ((a)->out_shift - 1)) : 0))
+#define DWCONV_STORE_FIXED(a, acc, bits) __SSAT((acc) >> (a)->out_shift, bits)
+
+#define DEFINE_DWCONV(name, type, acc_type, bits, init, store)               \
+  static void name(const dnn_mp_conv_t * a)                                   \
+  {                                                                           \
+    const type *in = (const type *)a->in;                                     \
+    const type *wt = (const type *)a->wt;                                     \
+    const type *bias = (const type *)a->bias;                                 \
+    type *out = (type *)a->out;                                               \
+    int in_size = a->in_w * a->in_h;                                          \
+    int ker_size = a->ker_w * a->ker_h;                                       \
+    int c, oy, ox, ky, kx;                                                    \
+                                                                              \
+    for (c = 0; c < a->out_ch; c++, in += in_size, wt += ker_size)            \
+      {                                                                       \
+        for (oy = 0; oy < a->out_h; oy++)                                     \
+          {                                                                   \
+            int iy = oy * a->stride_h - a->pad_h;                             \
+            int ky0 = iy < 0 ? -iy : 0;                                       \
+            int ky1 = a->in_h - iy < a->ker_h ? a->in_h - iy : a->ker_h;      \
+                                                                              \
+            for (ox = 0; ox < a->out_w; ox++)                                 \
+              {                                                               \
+                int ix = ox * a->stride_w - a->pad_w;                         \
+                int kx0 = ix < 0 ? -ix : 0;                                   \
+                int kx1 = a->in_w - ix < a->ker_w ? a->in_w - ix : a->ker_w;  \
+                acc_type acc = init(a, bias, c);                              \
+                                                                              \
+                for (ky = ky0; ky < ky1; ky++)                                \
+                  {                                                           \
+                    const type *pi = in + (iy + ky) * a->in_w + ix;           \
+                    const type *pw = wt + ky * a->ker_w;                      \
+                    for (kx = kx0; kx < kx1; kx++)                            \
+                      {                                                       \
+                        acc += (acc_type)pi[kx] * pw[kx];                     \
+                      }                                                       \
+                  }                                                           \
+                *out++ = (type)store(a, acc, bits);                           \
+              }                                                               \
+          }                                                                   \
+      }                                                                       \
+  }
+
+DEFINE_DWCONV(dwconv_f32, float, float, 0, DWCONV_INIT_F32, DWCONV_STORE_F32)
+DEFINE_DWCONV(dwconv_q15, q15_t, int32_t, 16, DWCONV_INIT_FIXED,
+              DWCONV_STORE_FIXED)
+DEFINE_DWCONV(dwconv_q7, q7_t, int32_t, 8, DWCONV_INIT_FIXED,
+              DWCONV_STORE_FIXED)
+
+/* Int8 kernels quantized per output channel (see dnn_mp_quant_t).
+ * Inputs are expanded to q15 with in_offset added, then multiplied with
+ * int8 weights by SMLAD, two weights per instruction.
+ */
+
+static inline q7_t requantize(int32_t acc, int32_t mult, int32_t shift,
+                              const dnn_mp_quant_t * q)
+{
+  int total = 31 - shift;
+  int32_t v = (int32_t)(((int64_t)acc * mult +
+                         ((int64_t)1 << (total - 1))) >> total);
+
+  v += q->out_offset;
+  if (v < q->act_min)
+    {
+      v = q->act_min;
+    }
+  if (v > q->act_max)
+    {
+      v = q->act_max;
+    }
+  return (q7_t)v;
+}
+
+/* acc0 += w0 . col, acc1 += w1 . col for n elements */
+
+static inline void dot2_s8(const q7_t * w0, const q7_t * w1,
+                           const q15_t * col, int n,
+                           int32_t * acc0, int32_t * acc1)
+{
+  int32_t sum0 = *acc0;
+  int32_t sum1 = *acc1;
+#if defined (ARM_MATH_DSP)
+  q7_t *pw0 = (q7_t *) w0;
+  q7_t *pw1 = (q7_t *) w1;
+  q15_t *pc = (q15_t *) col;
+  int cnt = n >> 2;
+
+  while (cnt--)
+    {
+      q31_t c1 = *__SIMD32(pc)++;
+      q31_t c2 = *__SIMD32(pc)++;
+      q31_t a1, a2, b1, b2;
+
+      pw0 = (q7_t *) read_and_pad(pw0, &a1, &a2);
+      pw1 = (q7_t *) read_and_pad(pw1, &b1, &b2);
+      sum0 = __SMLAD(a1, c1, sum0);
+      sum0 = __SMLAD(a2, c2, sum0);
+      sum1 = __SMLAD(b1, c1, sum1);
+      sum1 = __SMLAD(b2, c2, sum1);
+    }
+  w0 = pw0;
+  w1 = pw1;
+  col = pc;
+  n &= 3;
+#endif
+
+  while (n--)
+    {
+      sum0 += *w0++ * *col;
+      sum1 += *w1++ * *col++;
+    }
+  *acc0 = sum0;
+  *acc1 = sum1;
+}
+
+static inline int32_t dot_s8(const q7_t * w, const q15_t * col, int n,
+                             int32_t acc)
+{
+#if defined (ARM_MATH_DSP)
+  q7_t *pw = (q7_t *) w;
+  q15_t *pc = (q15_t *) col;
+  int cnt = n >> 2;
+
+  while (cnt--)
+    {
+      q31_t c1 = *__SIMD32(pc)++;
+      q31_t c2 = *__SIMD32(pc)++;
+      q31_t a1, a2;
+
+      pw = (q7_t *) read_and_pad(pw, &a1, &a2);
+      acc = __SMLAD(a1, c1, acc);
+      acc = __SMLAD(a2, c2, acc);
+    }
+  w = pw;
+  col = pc;
+  n &= 3;
+#endif
+
+  while (n--)
+    {
+      acc += *w++ * *col++;
+    }
+  return acc;
+}
+
+/* output channels of one column, out is strided by out_step */
+
+static void column_s8(const q7_t * wt, const int32_t * bias,
+                      const q15_t * col, int n, int out_ch,
+                      const dnn_mp_quant_t * q, q7_t * out, int out_step)
+{
+  int c;
+
+  for (c = 0; c + 1 < out_ch; c += 2)
+    {
+      int32_t acc0 = bias[c];
+      int32_t acc1 = bias[c + 1];
+
+      dot2_s8(wt, wt + n, col, n, &acc0, &acc1);
+      out[0] = requantize(acc0, q->mult[c], q->shift[c], q);
+      out[out_step] = requantize(acc1, q->mult[c + 1], q->shift[c + 1], q);
+      out += 2 * out_step;
+      wt += 2 * n;
+    }
+
+  if (c < out_ch)
+    {
+      int32_t acc = dot_s8(wt, col, n, bias[c]);
+
+      out[0] = requantize(acc, q->mult[c], q->shift[c], q);
+    }
+}
+
+/* Convolution in CHW layout. Kernel window of each output pixel is
+ * copied into col (ker_w * ker_h * in_ch q15), padding is 0.
+ */
+
+static void conv_s8(const dnn_mp_conv_t * a, const dnn_mp_quant_t * q,
+                    q15_t * col)
+{
+  const q7_t *in = (const q7_t *)a->in;
+  int in_size = a->in_w * a->in_h;
+  int out_size = a->out_w * a->out_h;
+  int n = a->ker_w * a->ker_h * a->in_ch;
+  int oy, ox, ic, ky, kx;
+
+  for (oy = 0; oy < a->out_h; oy++)
+    {
+      for (ox = 0; ox < a->out_w; ox++)
+        {
+          int iy0 = oy * a->stride_h - a->pad_h;
+          int ix0 = ox * a->stride_w - a->pad_w;
+          q15_t *pc = col;
+
+          for (ic = 0; ic < a->in_ch; ic++)
+            {
+              const q7_t *plane = in + ic * in_size;
+
+              for (ky = 0; ky < a->ker_h; ky++)
+                {
+                  int iy = iy0 + ky;
+
+                  for (kx = 0; kx < a->ker_w; kx++)
+                    {
+                      int ix = ix0 + kx;
+
+                      if (iy < 0 || iy >= a->in_h || ix < 0 || ix >= a->in_w)
+                        {
+                          *pc++ = 0;
+                        }
+                      else
+                        {
+                          *pc++ = plane[iy * a->in_w + ix] + q->in_offset;
+                        }
+                    }
+                }
+            }
+
+          column_s8((const q7_t *)a->wt, (const int32_t *)a->bias, col, n,
+                    a->out_ch, q, (q7_t *) a->out + oy * a->out_w + ox,
+                    out_size);
+        }
+    }
+}
+
+static void dwconv_s8(const dnn_mp_conv_t * a, const dnn_mp_quant_t * q)
+{
+  const q7_t *in = (const q7_t *)a->in;
+  const q7_t *wt = (const q7_t *)a->wt;
+  const int32_t *bias = (const int32_t *)a->bias;
+  q7_t *out = (q7_t *) a->out;
+  int in_size = a->in_w * a->in_h;
+  int ker_size = a->ker_w * a->ker_h;
+  int c, oy, ox, ky, kx;
+
+  for (c = 0; c < a->out_ch; c++, in += in_size, wt += ker_size)
+    {
+      for (oy = 0; oy < a->out_h; oy++)
+        {
+          int iy = oy * a->stride_h - a->pad_h;
+          int ky0 = iy < 0 ? -iy : 0;
+          int ky1 = a->in_h - iy < a->ker_h ? a->in_h - iy : a->ker_h;
+
+          for (ox = 0; ox < a->out_w; ox++)
+            {
+              int ix = ox * a->stride_w - a->pad_w;
+              int kx0 = ix < 0 ? -ix : 0;
+              int kx1 = a->in_w - ix < a->ker_w ? a->in_w - ix : a->ker_w;
+              int32_t acc = bias[c];
+
+              for (ky = ky0; ky < ky1; ky++)
+                {
+                  const q7_t *pi = in + (iy + ky) * a->in_w + ix;
+                  const q7_t *pw = wt + ky * a->ker_w;
+                  for (kx = kx0; kx < kx1; kx++)
+                    {
+                      acc += (pi[kx] + q->in_offset) * pw[kx];
+                    }
+                }
+              *out++ = requantize(acc, q->mult[c], q->shift[c], q);
+            }
+        }
+    }
+}
+
+/* int8 to float in place, from the end as float is wider */
+
+static void dequantize(void *data, int size, const dnn_mp_quant_t * q)
+{
+  const q7_t *in = (const q7_t *)data;
+  float *out = (float *)data;
+  int i;
+
+  for (i = size - 1; i >= 0; i--)
+    {
+      out[i] = (float)(in[i] - q->out_offset) * q->out_scale;
+    }
+}
+
+/* ReLU fused into an int8 kernel clamps at the zero point */
+
+static void fold_relu(dnn_mp_job_t * job)
+{
+  if (job->post_relu)
+    {
+      if (job->quant.act_min < job->quant.out_offset)
+        {
+          job->quant.act_min = job->quant.out_offset;
+        }
+      job->post_relu = 0;
+    }
+}
+
+static void exec_pool(const dnn_mp_pool_t * a, int elem_size)
+{
+  if (elem_size == sizeof(float))
+    {
+      pool_f32(a);
+    }
+  else if (elem_size == sizeof(q15_t))
+    {
+      pool_q15(a);
+    }
+  else
+    {
+      pool_q7(a);
+    }
+}
+
+/* ReLU and pooling fused into the kernel of this job */
+
+static void exec_post(dnn_mp_job_t * job, void *out, int size, int elem_size)
+{
+  if (job->post_relu)
+    {
+      if (elem_size == sizeof(float))
+        {
+          relu_f32((float *)out, size);
+        }
+      else if (elem_size == sizeof(q15_t))
+        {
+          relu_q15((q15_t *) out, size);
+        }
+      else
+        {
+          relu_q7((q7_t *) out, size);
+        }
+    }
+
+  if (job->post_pool.op != DNN_MP_POOL_NONE)
+    {
+      job->post_pool.in = out;
+      exec_pool(&job->post_pool, elem_size);
+    }
+}
+
+static int kernel_elem_size(uint32_t kernel)
+{
+  switch (kernel)
+    {
+    case DNN_MP_CONV_F32:
+    case DNN_MP_AFFINE_F32:
+    case DNN_MP_DWCONV_F32:
+    case DNN_MP_POOL_F32:
+      return sizeof(float);
+
+    case DNN_MP_CONV_Q15:
+    case DNN_MP_AFFINE_Q15:
+    case DNN_MP_DWCONV_Q15:
+    case DNN_MP_POOL_Q15:
+      return sizeof(q15_t);
+
+    default:
+      return sizeof(q7_t);
+    }
+}
+
+static int exec_conv(dnn_mp_job_t * job)
+{
+  dnn_mp_conv_t *a = &job->u.conv;
+
+  switch (job->kernel)
+    {
+    case DNN_MP_CONV_S8:
+      fold_relu(job);
+      conv_s8(a, &job->quant, (q15_t *) job->scratch);
+      break;
+
+    case DNN_MP_CONV_F32:
+      arm_convolve_CHW_f32_basic_nonsquare((const float *)a->in,
+                                           a->in_w, a->in_h, a->in_ch,
+                                           (const float *)a->wt, a->out_ch,
+                                           a->ker_w, a->ker_h,
+                                           a->pad_w, a->pad_h,
+                                           a->stride_w, a->stride_h,
+                                           (const float *)a->bias,
+                                           (float *)a->out,
+                                           a->out_w, a->out_h,
+                                           (float *)job->scratch, 0);
+      break;
+
+    case DNN_MP_CONV_Q15:
+      arm_convolve_CHW_q15_basic_nonsquare((const q15_t *) a->in,
+                                           a->in_w, a->in_h, a->in_ch,
+                                           (const q15_t *) a->wt, a->out_ch,
+                                           a->ker_w, a->ker_h,
+                                           a->pad_w, a->pad_h,
+                                           a->stride_w, a->stride_h,
+                                           (const q15_t *) a->bias,
+                                           a->bias_shift, a->out_shift,
+                                           (q15_t *) a->out,
+                                           a->out_w, a->out_h,
+                                           (q15_t *) job->scratch, 0);
+      break;
+
+    default:
+      arm_convolve_CHW_q7_basic_nonsquare((const q7_t *) a->in,
+                                          a->in_w, a->in_h, a->in_ch,
+                                          (const q7_t *) a->wt, a->out_ch,
+                                          a->ker_w, a->ker_h,
+                                          a->pad_w, a->pad_h,
+                                          a->stride_w, a->stride_h,
+                                          (const q7_t *) a->bias,
+                                          a->bias_shift, a->out_shift,
+                                          (q7_t *) a->out,
+                                          a->out_w, a->out_h,
+                                          (q15_t *) job->scratch, 0);
+      break;
+    }
+
+  exec_post(job, a->out, a->out_ch * a->out_w * a->out_h,
+            kernel_elem_size(job->kernel));
+  if (job->kernel == DNN_MP_CONV_S8 && job->quant.out_scale != 0.0f)
+    {
+      dequantize(a->out, a->out_ch * a->out_w * a->out_h, &job->quant);
+    }
+  return 0;
+}
+
+static int exec_dwconv(dnn_mp_job_t * job)
+{
+  dnn_mp_conv_t *a = &job->u.conv;
+
+  switch (job->kernel)
+    {
+    case DNN_MP_DWCONV_F32:
+      dwconv_f32(a);
+      break;
+
+    case DNN_MP_DWCONV_Q15:
+      dwconv_q15(a);
+      break;
+
+    case DNN_MP_DWCONV_S8:
+      fold_relu(job);
+      dwconv_s8(a, &job->quant);
+      break;
+
+    default:
+      dwconv_q7(a);
+      break;
+    }
+
+  exec_post(job, a->out, a->out_ch * a->out_w * a->out_h,
+            kernel_elem_size(job->kernel));
+  if (job->kernel == DNN_MP_DWCONV_S8 && job->quant.out_scale != 0.0f)
+    {
+      dequantize(a->out, a->out_ch * a->out_w * a->out_h, &job->quant);
+    }
+  return 0;
+}
+
+static int exec_affine(dnn_mp_job_t * job)
+{
+  dnn_mp_affine_t *a = &job->u.affine;
+  int elem_size = kernel_elem_size(job->kernel);
+  int i, k;
+
+  for (k = 0; k < a->batch; k++)
+    {
+      int input_offset = k * a->in_size;
+      int output_offset = k * a->out_stride;
+
+      switch (job->kernel)
+        {
+        case DNN_MP_AFFINE_F32:
+          {
+            float *y = (float *)a->out + output_offset;
+
+            affine_float((const float *)a->in + input_offset,
+                         (const float *)a->wt, y, a->in_size, a->out_size);
+            if (a->bias)
+              {
+                const float *b = (const float *)a->bias + output_offset;
+                for (i = 0; i < a->out_size; i++)
+                  {
+                    y[i] += b[i];
+                  }
+              }
+          }
+          break;
+
+        case DNN_MP_AFFINE_Q15:
+          arm_fully_connected_q15((const q15_t *) a->in + input_offset,
+                                  (const q15_t *) a->wt, a->in_size,
+                                  a->out_size, a->bias_shift, a->out_shift,
+                                  (const q15_t *) a->bias,
+                                  (q15_t *) a->out + output_offset, 0);
+          break;
+
+        default:
+          arm_fully_connected_q7((const q7_t *) a->in + input_offset,
+                                 (const q7_t *) a->wt, a->in_size,
+                                 a->out_size, a->bias_shift, a->out_shift,
+                                 (const q7_t *) a->bias,
+                                 (q7_t *) a->out + output_offset,
+                                 (q15_t *) job->scratch);
+          break;
+        }
+
+      exec_post(job, (uint8_t *) a->out + output_offset * elem_size,
+                a->out_size, elem_size);
+    }
+
+  return 0;
+}
+
+/* Output of batch k is written at k * out_stride elements, which are
+ * float if the output is dequantized.
+ */
+
+static int exec_affine_s8(dnn_mp_job_t * job)
+{
+  dnn_mp_affine_t *a = &job->u.affine;
+  dnn_mp_quant_t *q = &job->quant;
+  int out_elem_size = q->out_scale != 0.0f ? sizeof(float) : sizeof(q7_t);
+  q15_t *col = (q15_t *) job->scratch;
+  int i, k;
+
+  fold_relu(job);
+  for (k = 0; k < a->batch; k++)
+    {
+      const q7_t *x = (const q7_t *)a->in + k * a->in_size;
+      uint8_t *y = (uint8_t *) a->out + k * a->out_stride * out_elem_size;
+
+      for (i = 0; i < a->in_size; i++)
+        {
+          col[i] = x[i] + q->in_offset;
+        }
+
+      column_s8((const q7_t *)a->wt, (const int32_t *)a->bias, col,
+                a->in_size, a->out_size, q, (q7_t *) y, 1);
+      if (q->out_scale != 0.0f)
+        {
+          dequantize(y, a->out_size, q);
+        }
+    }
+
+  return 0;
+}
+
+static int exec_pool_job(dnn_mp_job_t * job)
+{
+  exec_pool(&job->u.pool, kernel_elem_size(job->kernel));
+  return 0;
+}
+
+int dnn_mp_exec_job(dnn_mp_job_t * job)
+{
+  switch (job->kernel)
+    {
+    case DNN_MP_CONV_F32:
+    case DNN_MP_CONV_Q15:
+    case DNN_MP_CONV_Q7:
+    case DNN_MP_CONV_S8:
+      return exec_conv(job);
+
+    case DNN_MP_AFFINE_F32:
+    case DNN_MP_AFFINE_Q15:
+    case DNN_MP_AFFINE_Q7:
+      return exec_affine(job);
+
+    case DNN_MP_AFFINE_S8:
+      return exec_affine_s8(job);
+
+    case DNN_MP_DWCONV_F32:
+    case DNN_MP_DWCONV_Q15:
+    case DNN_MP_DWCONV_Q7:
+    case DNN_MP_DWCONV_S8:
+      return exec_dwconv(job);
+
+    case DNN_MP_POOL_F32:
+    case DNN_MP_POOL_Q15:
+    case DNN_MP_POOL_Q7:
+      return exec_pool_job(job);
+
+    default:
+      return -EINVAL;
+    }
+}
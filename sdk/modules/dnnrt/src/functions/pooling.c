@@ -0,0 +1,249 @@
+/****************************************************************************
+ * modules/dnnrt/src/functions/pooling.c
+ *
+ *   Copyright 2018 Sony Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Corporation nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/* Max and average pooling over the last two axes in CHW layout.
+ * Planes (all the leading axes) are split across CPUs.
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <nnablart/functions.h>
+#include <nnablart/runtime.h>
+#include <dnnrt/runtime.h>
+#include <context.h>
+#include <runtime/runtime_common.h>
+#include <runtime/runtime_mp.h>
+#include <runtime_internal.h>
+#include <utilities/shape.h>
+
+#define X (0)                   // x input
+#define Y (0)                   // y output
+
+#define DIM_MAX (0xffff)
+
+static int elem_size_of(nn_data_type_t type)
+{
+  if (type == NN_DATA_TYPE_FLOAT)
+    {
+      return sizeof(float);
+    }
+  else if (type == NN_DATA_TYPE_INT16)
+    {
+      return sizeof(int16_t);
+    }
+  else if (type == NN_DATA_TYPE_INT8)
+    {
+      return sizeof(int8_t);
+    }
+  return 0;
+}
+
+static dnn_mp_kernel_t pool_kernel(nn_data_type_t type)
+{
+  if (type == NN_DATA_TYPE_FLOAT)
+    {
+      return DNN_MP_POOL_F32;
+    }
+  else if (type == NN_DATA_TYPE_INT16)
+    {
+      return DNN_MP_POOL_Q15;
+    }
+  return DNN_MP_POOL_Q7;
+}
+
+static int pooling_planes(rt_variable_t * var)
+{
+  int planes = 1;
+  int i;
+
+  for (i = 0; i < var->shape.size - 2; i++)
+    {
+      planes *= var->shape.data[i];
+    }
+  return planes;
+}
+
+int dnnrt_pooling_args(rt_function_t * f, int op, dnn_mp_pool_t * a)
+{
+  rt_variable_t *x = f->inputs[X];
+  rt_variable_t *y = f->outputs[Y];
+  const rt_list_t *kernel;
+  const rt_list_t *stride;
+  const rt_list_t *pad;
+  int nx = x->shape.size;
+  int ny = y->shape.size;
+
+  if (op == DNN_MP_POOL_MAX)
+    {
+      max_pooling_local_context_t *c =
+        (max_pooling_local_context_t *) f->local_context;
+      kernel = &c->kernel;
+      stride = &c->stride;
+      pad = &c->pad;
+      a->including_pad = 0;
+    }
+  else
+    {
+      average_pooling_local_context_t *c =
+        (average_pooling_local_context_t *) f->local_context;
+      kernel = &c->kernel;
+      stride = &c->stride;
+      pad = &c->pad;
+      a->including_pad = c->including_pad;
+    }
+
+  /* fixed point values are not rescaled */
+
+  if (kernel->size != 2 || stride->size != 2 || pad->size != 2 || nx < 2 ||
+      nx != ny || x->type != y->type || elem_size_of(x->type) == 0 ||
+      (x->type != NN_DATA_TYPE_FLOAT && x->fp_pos != y->fp_pos))
+    {
+      return 0;
+    }
+
+  a->in = NULL;
+  a->out = NULL;
+  a->op = op;
+  a->ch = 0;
+  a->in_h = x->shape.data[nx - 2];
+  a->in_w = x->shape.data[nx - 1];
+  a->out_h = y->shape.data[ny - 2];
+  a->out_w = y->shape.data[ny - 1];
+  a->ker_h = kernel->data[0];
+  a->ker_w = kernel->data[1];
+  a->stride_h = stride->data[0];
+  a->stride_w = stride->data[1];
+  a->pad_h = pad->data[0];
+  a->pad_w = pad->data[1];
+
+  if (pooling_planes(x) != pooling_planes(y) ||
+      pooling_planes(x) > DIM_MAX || a->stride_h == 0 || a->stride_w == 0 ||
+      x->shape.data[nx - 2] > DIM_MAX || x->shape.data[nx - 1] > DIM_MAX)
+    {
+      return 0;
+    }
+
+  return elem_size_of(x->type);
+}
+
+static rt_function_error_t dnnrt_exec_pooling(rt_function_t * f, int op)
+{
+  rt_variable_t *x = f->inputs[X];
+  rt_variable_t *y = f->outputs[Y];
+  dnn_mp_job_t jobs[DNN_MP_MAX_CPUS];
+  dnn_mp_pool_t a;
+  int elem_size = dnnrt_pooling_args(f, op, &a);
+  int planes = pooling_planes(x);
+  int in_size = a.in_w * a.in_h;
+  int out_size = a.out_w * a.out_h;
+  int parts = dnn_mp_parts(planes, (unsigned long)planes * out_size *
+                           a.ker_w * a.ker_h);
+  int i;
+
+  for (i = 0; i < parts; i++)
+    {
+      int p0 = planes * i / parts;
+      int p1 = planes * (i + 1) / parts;
+
+      jobs[i].kernel = pool_kernel(x->type);
+      jobs[i].scratch = NULL;
+      jobs[i].u.pool = a;
+      jobs[i].u.pool.in = (uint8_t *) x->data + p0 * in_size * elem_size;
+      jobs[i].u.pool.out = (uint8_t *) y->data + p0 * out_size * elem_size;
+      jobs[i].u.pool.ch = p1 - p0;
+      jobs[i].post_relu = 0;
+      jobs[i].post_pool.op = DNN_MP_POOL_NONE;
+    }
+
+  if (dnn_mp_exec(jobs, parts) != 0)
+    {
+      return RT_FUNCTION_ERROR_UNIMPLEMENTED;
+    }
+
+  return RT_FUNCTION_ERROR_NOERROR;
+}
+
+rt_function_error_t dnnrt_exec_max_pooling(rt_function_t * f)
+{
+  uint32_t start = dnn_profile_begin();
+  rt_function_error_t ret = dnnrt_exec_pooling(f, DNN_MP_POOL_MAX);
+
+  dnn_profile_end(NN_FUNCTION_MAX_POOLING, start);
+  return ret;
+}
+
+rt_function_error_t dnnrt_exec_average_pooling(rt_function_t * f)
+{
+  uint32_t start = dnn_profile_begin();
+  rt_function_error_t ret = dnnrt_exec_pooling(f, DNN_MP_POOL_AVG);
+
+  dnn_profile_end(NN_FUNCTION_AVERAGE_POOLING, start);
+  return ret;
+}
+
+static rt_return_value_t
+dnnrt_pooling_alloc(nn_network_t * net, void *function_context, int op)
+{
+  rt_function_context_t *func = (rt_function_context_t *) function_context;
+  dnn_mp_pool_t a;
+
+  if ((int)func->info->impl != DNNRT_IMPLEMENT)
+    {
+      return RT_RET_FUNCTION_DONT_MATCH;
+    }
+
+  allocate_function_context(net, func->info, function_context);
+
+  if (!dnnrt_pooling_args(&func->func, op, &a))
+    {
+      return RT_RET_FUNCTION_MATCH;
+    }
+
+  func->func.exec_func = (op == DNN_MP_POOL_MAX) ?
+    dnnrt_exec_max_pooling : dnnrt_exec_average_pooling;
+  return RT_RET_FUNCTION_MATCH;
+}
+
+rt_return_value_t
+dnnrt_max_pooling_alloc(nn_network_t * net, void *function_context)
+{
+  return dnnrt_pooling_alloc(net, function_context, DNN_MP_POOL_MAX);
+}
+
+rt_return_value_t
+dnnrt_average_pooling_alloc(nn_network_t * net, void *function_context)
+{
+  return dnnrt_pooling_alloc(net, function_context, DNN_MP_POOL_AVG);
+}
@@ -0,0 +1,141 @@
+/****************************************************************************
+ * modules/dnnrt/src/functions/relu.c
+ *
+ *   Copyright 2018 Sony Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Corporation nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <nnablart/functions.h>
+#include <nnablart/runtime.h>
+#include <dnnrt/runtime.h>
+#include <context.h>
+#include <runtime/runtime_common.h>
+#include <runtime_internal.h>
+#include <utilities/shape.h>
+#include <arm_nnfunctions.h>
+
+#define X (0)                   // x input
+#define Y (0)                   // y output
+
+/* arm_relu_q7/q15() take 16bit size */
+
+#define RELU_CHUNK (0x8000)
+
+static int elem_size_of(nn_data_type_t type)
+{
+  if (type == NN_DATA_TYPE_FLOAT)
+    {
+      return sizeof(float);
+    }
+  else if (type == NN_DATA_TYPE_INT16)
+    {
+      return sizeof(int16_t);
+    }
+  else if (type == NN_DATA_TYPE_INT8)
+    {
+      return sizeof(int8_t);
+    }
+  return 0;
+}
+
+rt_function_error_t dnnrt_exec_relu(rt_function_t * f)
+{
+  rt_variable_t *x = f->inputs[X];
+  rt_variable_t *y = f->outputs[Y];
+  int size = calc_shape_size(y->shape);
+  uint32_t start = dnn_profile_begin();
+  int i;
+
+  if (x->type == NN_DATA_TYPE_FLOAT)
+    {
+      const float *in = (const float *)x->data;
+      float *out = (float *)y->data;
+
+      for (i = 0; i < size; i++)
+        {
+          out[i] = in[i] > 0.0f ? in[i] : 0.0f;
+        }
+    }
+  else
+    {
+      /* CMSIS-NN ReLU is in place */
+
+      if (y->data != x->data)
+        {
+          memcpy(y->data, x->data, size * elem_size_of(x->type));
+        }
+
+      for (i = 0; i < size; i += RELU_CHUNK)
+        {
+          int n = size - i > RELU_CHUNK ? RELU_CHUNK : size - i;
+
+          if (x->type == NN_DATA_TYPE_INT16)
+            {
+              arm_relu_q15((q15_t *) y->data + i, n);
+            }
+          else
+            {
+              arm_relu_q7((q7_t *) y->data + i, n);
+            }
+        }
+    }
+
+  dnn_profile_end(NN_FUNCTION_RELU, start);
+  return RT_FUNCTION_ERROR_NOERROR;
+}
+
+rt_return_value_t dnnrt_relu_alloc(nn_network_t * net, void *function_context)
+{
+  rt_function_context_t *func = (rt_function_context_t *) function_context;
+  rt_function_t *f = &func->func;
+
+  if ((int)func->info->impl != DNNRT_IMPLEMENT)
+    {
+      return RT_RET_FUNCTION_DONT_MATCH;
+    }
+
+  allocate_function_context(net, func->info, function_context);
+
+  /* fixed point values are not rescaled */
+
+  if (f->inputs[X]->type != f->outputs[Y]->type ||
+      elem_size_of(f->inputs[X]->type) == 0 ||
+      (f->inputs[X]->type != NN_DATA_TYPE_FLOAT &&
+       f->inputs[X]->fp_pos != f->outputs[Y]->fp_pos))
+    {
+      return RT_RET_FUNCTION_MATCH;
+    }
+
+  f->exec_func = dnnrt_exec_relu;
+  return RT_RET_FUNCTION_MATCH;
+}
@@ -0,0 +1,194 @@
+/****************************************************************************
+ * modules/dnnrt/src/functions/softmax.c
+ *
+ *   Copyright 2018 Sony Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Corporation nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/* Softmax along an axis, computed in float.
+ *
+ * arm_softmax_q7/q15() of CMSIS-NN are not used, as they approximate
+ * exp(x) by 2^x and need a fixed Q0.7/Q0.15 output, which do not match
+ * results of nnabla. Fixed point inputs and outputs are converted by
+ * their fp_pos.
+ */
+
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <nnablart/functions.h>
+#include <nnablart/runtime.h>
+#include <dnnrt/runtime.h>
+#include <context.h>
+#include <runtime/runtime_common.h>
+#include <runtime_internal.h>
+#include <utilities/shape.h>
+
+#define X (0)                   // x input
+#define Y (0)                   // y output
+
+static int supported_type(nn_data_type_t type)
+{
+  return type == NN_DATA_TYPE_FLOAT || type == NN_DATA_TYPE_INT16 ||
+    type == NN_DATA_TYPE_INT8;
+}
+
+static inline float load(const rt_variable_t * var, int pos, float scale)
+{
+  if (var->type == NN_DATA_TYPE_FLOAT)
+    {
+      return ((const float *)var->data)[pos];
+    }
+  else if (var->type == NN_DATA_TYPE_INT16)
+    {
+      return ((const int16_t *)var->data)[pos] * scale;
+    }
+  return ((const int8_t *)var->data)[pos] * scale;
+}
+
+static inline void store(rt_variable_t * var, int pos, float v, float scale)
+{
+  if (var->type == NN_DATA_TYPE_FLOAT)
+    {
+      ((float *)var->data)[pos] = v;
+    }
+  else
+    {
+      /* softmax is in [0, 1], so only the upper bound is saturated */
+
+      int32_t q = (int32_t) (v * scale + 0.5f);
+
+      if (var->type == NN_DATA_TYPE_INT16)
+        {
+          ((int16_t *) var->data)[pos] = q > INT16_MAX ? INT16_MAX : q;
+        }
+      else
+        {
+          ((int8_t *) var->data)[pos] = q > INT8_MAX ? INT8_MAX : q;
+        }
+    }
+}
+
+rt_function_error_t dnnrt_exec_softmax(rt_function_t * f)
+{
+  softmax_local_context_t *c = (softmax_local_context_t *) f->local_context;
+  rt_variable_t *x = f->inputs[X];
+  rt_variable_t *y = f->outputs[Y];
+  float in_scale = ldexpf(1.0f, -x->fp_pos);
+  float out_scale = ldexpf(1.0f, y->fp_pos);
+  int outer = 1;
+  int size = x->shape.data[c->axis];
+  int inner = 1;
+  int i, j, k;
+  uint32_t start = dnn_profile_begin();
+
+  for (i = 0; i < c->axis; i++)
+    {
+      outer *= x->shape.data[i];
+    }
+  for (i = c->axis + 1; i < x->shape.size; i++)
+    {
+      inner *= x->shape.data[i];
+    }
+
+  for (i = 0; i < outer; i++)
+    {
+      for (k = 0; k < inner; k++)
+        {
+          int base = i * size * inner + k;
+          float max = load(x, base, in_scale);
+          float sum = 0.0f;
+
+          for (j = 1; j < size; j++)
+            {
+              float v = load(x, base + j * inner, in_scale);
+              if (v > max)
+                {
+                  max = v;
+                }
+            }
+
+          /* exp() is stored to the output when it is float, so that it is
+           * computed once for each element.
+           */
+
+          for (j = 0; j < size; j++)
+            {
+              float e = expf(load(x, base + j * inner, in_scale) - max);
+              if (y->type == NN_DATA_TYPE_FLOAT)
+                {
+                  ((float *)y->data)[base + j * inner] = e;
+                }
+              sum += e;
+            }
+
+          sum = 1.0f / sum;
+          for (j = 0; j < size; j++)
+            {
+              int pos = base + j * inner;
+              float e = (y->type == NN_DATA_TYPE_FLOAT) ?
+                ((float *)y->data)[pos] :
+                expf(load(x, pos, in_scale) - max);
+
+              store(y, pos, e * sum, out_scale);
+            }
+        }
+    }
+
+  dnn_profile_end(NN_FUNCTION_SOFTMAX, start);
+  return RT_FUNCTION_ERROR_NOERROR;
+}
+
+rt_return_value_t
+dnnrt_softmax_alloc(nn_network_t * net, void *function_context)
+{
+  rt_function_context_t *func = (rt_function_context_t *) function_context;
+  rt_function_t *f = &func->func;
+  softmax_local_context_t *c;
+
+  if ((int)func->info->impl != DNNRT_IMPLEMENT)
+    {
+      return RT_RET_FUNCTION_DONT_MATCH;
+    }
+
+  allocate_function_context(net, func->info, function_context);
+  c = (softmax_local_context_t *) f->local_context;
+
+  if (c->axis < 0 || c->axis >= f->inputs[X]->shape.size ||
+      !supported_type(f->inputs[X]->type) ||
+      !supported_type(f->outputs[Y]->type))
+    {
+      return RT_RET_FUNCTION_MATCH;
+    }
+
+  f->exec_func = dnnrt_exec_softmax;
+  return RT_RET_FUNCTION_MATCH;
+}
@@ -0,0 +1,327 @@
+/****************************************************************************
+ * modules/dnnrt/src/runtime/memory_plan.c
+ *
+ *   Copyright 2018 Sony Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Corporation nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/* Static memory planner of activations.
+ *
+ * nnabla-c-runtime allocates each buffer of the network by malloc().
+ * After rt_initialize_context(), the lifetime of each buffer is given by
+ * the first and the last function which reads or writes a variable on it,
+ * and its size by its record in the buffer list of the network.
+ * Buffers are placed into one arena from the largest, at the lowest offset
+ * which does not overlap any placed buffer alive at the same time
+ * (greedy by size), and the original buffers are freed.
+ *
+ * Buffers of network inputs and outputs are not planned, as applications
+ * access them outside of dnn_runtime_forward().
+ *
+ * Without CONFIG_DNN_RT_MEMORY_PLAN, only the total size of activations
+ * is counted and the buffers are left as they are.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <dnnrt/runtime.h>
+#include <context.h>
+#include <runtime_internal.h>
+#include "runtime_common.h"
+#include "runtime_fusion.h"
+
+#define ARENA_ALIGN(s) (((s) + 15) & ~15)
+
+typedef struct plan_buffer
+{
+  int id;                       /* index of rt_context_t::buffers */
+  int first;                    /* first function using this buffer */
+  int last;                     /* last function using this buffer */
+  size_t bsize;
+  size_t offset;
+  void *data;                   /* original buffer */
+} plan_buffer_t;
+
+/* size of a buffer record of the network. nnabla-c-runtime allocates
+ * a float for each element of a buffer, whatever the types of the
+ * variables placed on it.
+ */
+
+static size_t record_bsize(const nn_network_t * network, int id)
+{
+  const int32_t *list;
+
+  if (id >= network->buffers.size)
+    {
+      return 0;
+    }
+  list = (const int32_t *)((const uint8_t *)network + network->buffers.list);
+  return list[id] > 0 ? sizeof(float) * list[id] : 0;
+}
+
+static plan_buffer_t *find_buffer(plan_buffer_t * bufs, int num, void *data)
+{
+  int i;
+
+  for (i = 0; i < num; i++)
+    {
+      if (bufs[i].data == data)
+        {
+          return &bufs[i];
+        }
+    }
+  return NULL;
+}
+
+static void exclude_variable(plan_buffer_t * bufs, int num, void *data)
+{
+  plan_buffer_t *b = find_buffer(bufs, num, data);
+
+  if (b)
+    {
+      b->data = NULL;
+    }
+}
+
+static void use_variable(plan_buffer_t * bufs, int num, rt_variable_t * var,
+                         int func)
+{
+  plan_buffer_t *b = find_buffer(bufs, num, var->data);
+
+  if (b == NULL)
+    {
+      return;
+    }
+  if (func < b->first)
+    {
+      b->first = func;
+    }
+  if (func > b->last)
+    {
+      b->last = func;
+    }
+}
+
+#ifdef CONFIG_DNN_RT_MEMORY_PLAN
+static int compare_bsize(const void *a, const void *b)
+{
+  const plan_buffer_t *pa = (const plan_buffer_t *)a;
+  const plan_buffer_t *pb = (const plan_buffer_t *)b;
+
+  if (pa->bsize != pb->bsize)
+    {
+      return pa->bsize < pb->bsize ? 1 : -1;
+    }
+  return pa->first - pb->first;
+}
+
+/* place bufs[n] at the lowest offset free during its lifetime */
+
+static size_t place_buffer(plan_buffer_t * bufs, int n)
+{
+  plan_buffer_t *b = &bufs[n];
+  size_t offset = 0;
+  int i, moved;
+
+  do
+    {
+      moved = 0;
+      for (i = 0; i < n; i++)
+        {
+          plan_buffer_t *p = &bufs[i];
+
+          if (p->last < b->first || b->last < p->first)
+            {
+              continue;
+            }
+          if (offset < p->offset + p->bsize && p->offset < offset + b->bsize)
+            {
+              offset = ARENA_ALIGN(p->offset + p->bsize);
+              moved = 1;
+            }
+        }
+    }
+  while (moved);
+
+  b->offset = offset;
+  return offset + b->bsize;
+}
+#endif
+
+int dnn_memory_plan(dnn_runtime_t * rt, const nn_network_t * network)
+{
+  rt_context_t *c = (rt_context_t *) rt->impl_ctx;
+  plan_buffer_t *bufs;
+  int num = 0;
+  int i, j;
+
+  rt->arena = NULL;
+  memset(&rt->mem, 0, sizeof(rt->mem));
+
+  if (c->num_of_buffers == 0)
+    {
+      return 0;
+    }
+
+  bufs = (plan_buffer_t *) malloc(sizeof(plan_buffer_t) * c->num_of_buffers);
+  if (bufs == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  for (i = 0; i < c->num_of_buffers; i++)
+    {
+      if (c->buffers[i].allocate_type != RT_BUFFER_ALLOCATE_TYPE_MALLOC)
+        {
+          continue;
+        }
+      bufs[num].id = i;
+      bufs[num].first = c->num_of_functions;
+      bufs[num].last = -1;
+      bufs[num].bsize = record_bsize(network, i);
+      bufs[num].offset = 0;
+      bufs[num].data = c->buffers[i].buffer;
+      num++;
+    }
+
+  for (i = 0; i < c->num_of_inputs; i++)
+    {
+      exclude_variable(bufs, num, c->variables[c->input_variable_ids[i]].data);
+    }
+  for (i = 0; i < c->num_of_outputs; i++)
+    {
+      exclude_variable(bufs, num,
+                       c->variables[c->output_variable_ids[i]].data);
+    }
+
+  /* lifetime in the order of execution. Variables of fused functions
+   * are used when their head is executed.
+   */
+
+  for (i = 0; i < c->num_of_functions; i++)
+    {
+      rt_function_t *f = &c->functions[i].func;
+      int at = dnn_fusion_index(rt, i);
+
+      for (j = 0; j < f->num_of_inputs; j++)
+        {
+          use_variable(bufs, num, f->inputs[j], at);
+        }
+      for (j = 0; j < f->num_of_outputs; j++)
+        {
+          use_variable(bufs, num, f->outputs[j], at);
+        }
+    }
+
+  /* drop excluded and unused buffers, and those of unknown size */
+
+  for (i = 0, j = 0; i < num; i++)
+    {
+      if (bufs[i].data != NULL && bufs[i].last >= 0 && bufs[i].bsize > 0)
+        {
+          bufs[j++] = bufs[i];
+        }
+    }
+  num = j;
+
+  for (i = 0; i < num; i++)
+    {
+      rt->mem.activation_bsize += bufs[i].bsize;
+    }
+
+#ifdef CONFIG_DNN_RT_MEMORY_PLAN
+  size_t arena_bsize = 0;
+  int *var_plan;
+
+  qsort(bufs, num, sizeof(plan_buffer_t), compare_bsize);
+  for (i = 0; i < num; i++)
+    {
+      size_t end = place_buffer(bufs, i);
+
+      if (end > arena_bsize)
+        {
+          arena_bsize = end;
+        }
+    }
+
+  /* variables on each planned buffer, before any address is reused */
+
+  var_plan = (int *)malloc(sizeof(int) * c->num_of_variables);
+  if (var_plan == NULL)
+    {
+      free(bufs);
+      return -ENOMEM;
+    }
+  for (j = 0; j < c->num_of_variables; j++)
+    {
+      plan_buffer_t *b = find_buffer(bufs, num, c->variables[j].data);
+
+      var_plan[j] = b ? b - bufs : -1;
+    }
+
+  /* free the original buffers first, so that the arena can reuse them */
+
+  for (i = 0; i < num; i++)
+    {
+      free(bufs[i].data);
+      c->buffers[bufs[i].id].buffer = NULL;
+      c->buffers[bufs[i].id].allocate_type = RT_BUFFER_ALLOCATE_TYPE_ALLOCATED;
+    }
+
+  if (num > 0)
+    {
+      rt->arena = malloc(arena_bsize);
+      if (rt->arena == NULL)
+        {
+          free(var_plan);
+          free(bufs);
+          return -ENOMEM;
+        }
+    }
+  rt->mem.arena_bsize = arena_bsize;
+
+  for (i = 0; i < num; i++)
+    {
+      c->buffers[bufs[i].id].buffer = (char *)rt->arena + bufs[i].offset;
+    }
+  for (j = 0; j < c->num_of_variables; j++)
+    {
+      if (var_plan[j] >= 0)
+        {
+          c->variables[j].data = (char *)rt->arena + bufs[var_plan[j]].offset;
+        }
+    }
+
+  free(var_plan);
+#endif
+
+  free(bufs);
+  return 0;
+}
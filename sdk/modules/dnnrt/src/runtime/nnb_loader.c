@@ -0,0 +1,709 @@
+/****************************************************************************
+ * modules/dnnrt/src/runtime/nnb_loader.c
+ *
+ *   Copyright 2018 Sony Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Corporation nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/* Loader of .nnb files (dnn_nnb_open).
+ *
+ * nnabla-c-runtime refers to everything in nn_network_t by the offset from
+ * its head, and parameters are not copied by rt_initialize_context() but
+ * used where they are. So a network which the file system can map (XIP)
+ * is used in place.
+ *
+ * Otherwise, with a cache, only the graph is read into RAM. The converter
+ * of nnabla writes parameters (memory blocks) after the graph, so the file
+ * up to the first memory block is the graph. After rt_initialize_context(),
+ * variables pointing beyond the graph are parameters. Functions using them
+ * are wrapped to read the parameters into an LRU cache and repoint the
+ * variables before they are executed.
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <nuttx/fs/ioctl.h>
+#include <dnnrt/runtime.h>
+#include <context.h>
+#include <runtime_internal.h>
+#include <utilities/shape.h>
+#include "runtime_common.h"
+
+#define NNB_MAPPED (0)          /* used in place */
+#define NNB_COPIED (1)          /* whole file in RAM */
+#define NNB_PAGED  (2)          /* graph in RAM, parameters in the cache */
+
+typedef struct nnb_param
+{
+  struct nnb_param *prev;       /* LRU list while cached, latest first */
+  struct nnb_param *next;
+  uint32_t offset;              /* offset in the file */
+  uint32_t bsize;
+  void *data;                   /* cached data or NULL */
+  int pinned;                   /* used by the function being executed */
+} nnb_param_t;
+
+typedef struct nnb_impl
+{
+  struct nnb_impl *next;        /* list of opened files */
+  int mode;
+  int fd;
+  int users;                    /* runtimes of this network */
+  nn_network_t *network;
+  uint32_t file_bsize;
+  uint32_t graph_bsize;
+  unsigned long cache_bsize;
+  unsigned long cached_bsize;
+  int num_of_params;
+  nnb_param_t *params;
+  nnb_param_t lru;              /* head of LRU list */
+} nnb_impl_t;
+
+/* parameters used by a function */
+
+typedef struct nnb_use
+{
+  rt_variable_t *var;
+  nnb_param_t *param;
+} nnb_use_t;
+
+typedef struct nnb_func
+{
+  rt_function_error_t (*exec_func) (rt_function_t * f);
+  int first;                    /* index of pager->uses */
+  int num;
+} nnb_func_t;
+
+typedef struct nnb_pager
+{
+  nnb_impl_t *nnb;
+  rt_context_t *ctx;
+  nnb_func_t *funcs;
+  nnb_use_t *uses;
+} nnb_pager_t;
+
+static nnb_impl_t *s_dnn_nnb;
+
+/* pager of the runtime in dnn_runtime_forward() */
+
+static nnb_pager_t *s_dnn_pager;
+
+static size_t var_bsize(rt_variable_t * var)
+{
+  size_t elem_size;
+
+  if (var->type == NN_DATA_TYPE_FLOAT)
+    {
+      elem_size = sizeof(float);
+    }
+  else if (var->type == NN_DATA_TYPE_INT16)
+    {
+      elem_size = sizeof(int16_t);
+    }
+  else
+    {
+      elem_size = sizeof(int8_t);
+    }
+
+  return elem_size * calc_shape_size(var->shape);
+}
+
+static int read_at(int fd, uint32_t offset, void *buf, size_t bsize)
+{
+  uint8_t *p = (uint8_t *) buf;
+
+  if (lseek(fd, offset, SEEK_SET) != (off_t) offset)
+    {
+      return -EIO;
+    }
+  while (bsize > 0)
+    {
+      ssize_t n = read(fd, p, bsize);
+
+      if (n <= 0)
+        {
+          return -EIO;
+        }
+      p += n;
+      bsize -= n;
+    }
+  return 0;
+}
+
+static int list_in_graph(const nn_list_t * list, uint32_t graph_bsize)
+{
+  return list->size >= 0 && list->list >= 0 &&
+    (uint32_t) list->list + list->size * sizeof(int32_t) <= graph_bsize;
+}
+
+/* find the end of the graph from memory blocks */
+
+static int nnb_read_params(nnb_impl_t * nnb)
+{
+  nn_network_t header;
+  int32_t *blocks;
+  uint32_t graph_bsize = nnb->file_bsize;
+  int i;
+
+  if (nnb->file_bsize < sizeof(header) ||
+      read_at(nnb->fd, 0, &header, sizeof(header)) != 0 ||
+      header.memory_blocks.size <= 0 || header.memory_blocks.list < 0 ||
+      (uint32_t) header.memory_blocks.list +
+      header.memory_blocks.size * sizeof(int32_t) > nnb->file_bsize)
+    {
+      return -EINVAL;
+    }
+
+  blocks = (int32_t *) malloc(header.memory_blocks.size * sizeof(int32_t));
+  nnb->params = (nnb_param_t *) calloc(header.memory_blocks.size,
+                                       sizeof(nnb_param_t));
+  if (blocks == NULL || nnb->params == NULL)
+    {
+      free(blocks);
+      return -ENOMEM;
+    }
+  if (read_at(nnb->fd, header.memory_blocks.list, blocks,
+              header.memory_blocks.size * sizeof(int32_t)) != 0)
+    {
+      free(blocks);
+      return -EIO;
+    }
+
+  for (i = 0; i < header.memory_blocks.size; i++)
+    {
+      if (blocks[i] < (int32_t) sizeof(header) ||
+          (uint32_t) blocks[i] >= nnb->file_bsize)
+        {
+          free(blocks);
+          return -EINVAL;
+        }
+      if ((uint32_t) blocks[i] < graph_bsize)
+        {
+          graph_bsize = blocks[i];
+        }
+      nnb->params[i].offset = blocks[i];
+    }
+  nnb->num_of_params = header.memory_blocks.size;
+  free(blocks);
+
+  /* lists of the network must be in the graph */
+
+  if (!list_in_graph(&header.buffers, graph_bsize) ||
+      !list_in_graph(&header.variables, graph_bsize) ||
+      !list_in_graph(&header.functions, graph_bsize) ||
+      !list_in_graph(&header.inputs, graph_bsize) ||
+      !list_in_graph(&header.outputs, graph_bsize) ||
+      !list_in_graph(&header.memory_blocks, graph_bsize))
+    {
+      return -EINVAL;
+    }
+
+  nnb->graph_bsize = graph_bsize;
+  return 0;
+}
+
+static void nnb_free(nnb_impl_t * nnb)
+{
+  int i;
+
+  for (i = 0; i < nnb->num_of_params; i++)
+    {
+      free(nnb->params[i].data);
+    }
+  free(nnb->params);
+  if (nnb->mode != NNB_MAPPED)
+    {
+      free(nnb->network);
+    }
+  if (nnb->fd >= 0)
+    {
+      close(nnb->fd);
+    }
+  free(nnb);
+}
+
+int dnn_nnb_open(dnn_nnb_t * nnb, const char *path,
+                 const dnn_nnb_config_t * config)
+{
+  nnb_impl_t *impl;
+  struct stat st;
+  void *addr = NULL;
+  int err;
+
+  DNN_CHECK_NULL_RET(nnb, -EINVAL);
+  DNN_CHECK_NULL_RET(path, -EINVAL);
+  nnb->network = NULL;
+  nnb->impl = NULL;
+
+  impl = (nnb_impl_t *) calloc(1, sizeof(nnb_impl_t));
+  if (impl == NULL)
+    {
+      return -ENOMEM;
+    }
+  impl->lru.next = &impl->lru;
+  impl->lru.prev = &impl->lru;
+
+  impl->fd = open(path, O_RDONLY);
+  if (impl->fd < 0 || fstat(impl->fd, &st) != 0)
+    {
+      err = -errno;
+      goto error;
+    }
+  impl->file_bsize = st.st_size;
+  impl->cache_bsize = config ? config->cache_bsize : 0;
+
+#ifdef FIOC_MMAP
+  /* file systems on XIP flash return the address of the file */
+
+  if (ioctl(impl->fd, FIOC_MMAP, (unsigned long)((uintptr_t) & addr)) == 0 &&
+      addr != NULL)
+    {
+      impl->mode = NNB_MAPPED;
+      impl->network = (nn_network_t *) addr;
+      close(impl->fd);
+      impl->fd = -1;
+      goto done;
+    }
+#endif
+
+  impl->mode = NNB_COPIED;
+  impl->graph_bsize = impl->file_bsize;
+  if (impl->cache_bsize > 0)
+    {
+      err = nnb_read_params(impl);
+      if (err == -ENOMEM)
+        {
+          goto error;
+        }
+      if (err == 0)
+        {
+          impl->mode = NNB_PAGED;
+        }
+      else
+        {
+          DNN_PRINT("parameters of %s are not paged\n", path);
+          free(impl->params);
+          impl->params = NULL;
+          impl->num_of_params = 0;
+          impl->graph_bsize = impl->file_bsize;
+        }
+    }
+
+  impl->network = (nn_network_t *) malloc(impl->graph_bsize);
+  if (impl->network == NULL)
+    {
+      err = -ENOMEM;
+      goto error;
+    }
+  err = read_at(impl->fd, 0, impl->network, impl->graph_bsize);
+  if (err != 0)
+    {
+      goto error;
+    }
+  if (impl->mode == NNB_COPIED)
+    {
+      close(impl->fd);
+      impl->fd = -1;
+    }
+
+done:
+  impl->next = s_dnn_nnb;
+  s_dnn_nnb = impl;
+  nnb->network = impl->network;
+  nnb->impl = impl;
+  return 0;
+
+error:
+  nnb_free(impl);
+  return err;
+}
+
+int dnn_nnb_close(dnn_nnb_t * nnb)
+{
+  nnb_impl_t *impl;
+  nnb_impl_t **p;
+
+  DNN_CHECK_NULL_RET(nnb, -EINVAL);
+  impl = (nnb_impl_t *) nnb->impl;
+  DNN_CHECK_NULL_RET(impl, -EINVAL);
+
+  if (impl->users > 0)
+    {
+      return -EBUSY;
+    }
+
+  for (p = &s_dnn_nnb; *p; p = &(*p)->next)
+    {
+      if (*p == impl)
+        {
+          *p = impl->next;
+          break;
+        }
+    }
+
+  nnb_free(impl);
+  nnb->network = NULL;
+  nnb->impl = NULL;
+  return 0;
+}
+
+static nnb_impl_t *nnb_find(const nn_network_t * network)
+{
+  nnb_impl_t *nnb;
+
+  for (nnb = s_dnn_nnb; nnb; nnb = nnb->next)
+    {
+      if (nnb->network == network)
+        {
+          break;
+        }
+    }
+  return nnb;
+}
+
+int dnn_nnb_read(const nn_network_t * network, const void *data,
+                 void *buf, size_t bsize)
+{
+  nnb_impl_t *nnb = nnb_find(network);
+  uintptr_t base = (uintptr_t) network;
+  uintptr_t addr = (uintptr_t) data;
+
+  if (nnb && nnb->mode == NNB_PAGED && addr >= base + nnb->graph_bsize)
+    {
+      if (addr + bsize > base + nnb->file_bsize)
+        {
+          return -EINVAL;
+        }
+      return read_at(nnb->fd, addr - base, buf, bsize);
+    }
+
+  memcpy(buf, data, bsize);
+  return 0;
+}
+
+/* LRU cache of parameters */
+
+static void lru_unlink(nnb_param_t * param)
+{
+  param->prev->next = param->next;
+  param->next->prev = param->prev;
+}
+
+static void lru_push(nnb_impl_t * nnb, nnb_param_t * param)
+{
+  param->next = nnb->lru.next;
+  param->prev = &nnb->lru;
+  nnb->lru.next->prev = param;
+  nnb->lru.next = param;
+}
+
+static int param_load(nnb_impl_t * nnb, nnb_param_t * param)
+{
+  nnb_param_t *victim;
+  int err;
+
+  if (param->data != NULL)
+    {
+      lru_unlink(param);
+      lru_push(nnb, param);
+      return 0;
+    }
+
+  /* evict from the least recently used, except the current function's */
+
+  victim = nnb->lru.prev;
+  while (nnb->cached_bsize + param->bsize > nnb->cache_bsize &&
+         victim != &nnb->lru)
+    {
+      nnb_param_t *prev = victim->prev;
+
+      if (!victim->pinned)
+        {
+          lru_unlink(victim);
+          free(victim->data);
+          victim->data = NULL;
+          nnb->cached_bsize -= victim->bsize;
+        }
+      victim = prev;
+    }
+  if (nnb->cached_bsize + param->bsize > nnb->cache_bsize)
+    {
+      return -ENOMEM;
+    }
+
+  param->data = malloc(param->bsize);
+  if (param->data == NULL)
+    {
+      return -ENOMEM;
+    }
+  err = read_at(nnb->fd, param->offset, param->data, param->bsize);
+  if (err != 0)
+    {
+      free(param->data);
+      param->data = NULL;
+      return err;
+    }
+
+  nnb->cached_bsize += param->bsize;
+  lru_push(nnb, param);
+  return 0;
+}
+
+static rt_function_error_t nnb_exec(rt_function_t * f)
+{
+  nnb_pager_t *pager = s_dnn_pager;
+  rt_function_context_t *fc = (rt_function_context_t *)
+    ((uint8_t *) f - offsetof(rt_function_context_t, func));
+  nnb_func_t *func = &pager->funcs[fc - pager->ctx->functions];
+  nnb_use_t *uses = &pager->uses[func->first];
+  rt_function_error_t ret = RT_FUNCTION_ERROR_UNIMPLEMENTED;
+  int i, n;
+
+  for (n = 0; n < func->num; n++)
+    {
+      if (param_load(pager->nnb, uses[n].param) != 0)
+        {
+          DNN_PRINT("failed to read parameters\n");
+          goto unpin;
+        }
+      uses[n].param->pinned++;
+      uses[n].var->data = uses[n].param->data;
+    }
+
+  ret = func->exec_func(f);
+
+unpin:
+  for (i = 0; i < n; i++)
+    {
+      uses[i].param->pinned--;
+    }
+  return ret;
+}
+
+static nnb_param_t *find_param(nnb_impl_t * nnb, rt_variable_t * var)
+{
+  uintptr_t base = (uintptr_t) nnb->network;
+  uintptr_t addr = (uintptr_t) var->data;
+  int i;
+
+  if (addr < base + nnb->graph_bsize || addr >= base + nnb->file_bsize)
+    {
+      return NULL;
+    }
+  for (i = 0; i < nnb->num_of_params; i++)
+    {
+      if (base + nnb->params[i].offset == addr)
+        {
+          return &nnb->params[i];
+        }
+    }
+  return NULL;
+}
+
+static int nnb_check_params(nnb_impl_t * nnb, rt_context_t * c, int *num)
+{
+  uintptr_t base = (uintptr_t) nnb->network;
+  int i, j;
+
+  *num = 0;
+
+  /* size of each parameter, and the number of uses */
+
+  for (i = 0; i < c->num_of_functions; i++)
+    {
+      rt_function_t *f = &c->functions[i].func;
+
+      for (j = 0; j < f->num_of_inputs; j++)
+        {
+          uintptr_t addr = (uintptr_t) f->inputs[j]->data;
+          nnb_param_t *param = find_param(nnb, f->inputs[j]);
+          size_t bsize = var_bsize(f->inputs[j]);
+
+          if (param == NULL)
+            {
+              /* beyond the graph but not at a memory block */
+
+              if (addr >= base + nnb->graph_bsize &&
+                  addr < base + nnb->file_bsize)
+                {
+                  return -EINVAL;
+                }
+              continue;
+            }
+          if (param->offset + bsize > nnb->file_bsize)
+            {
+              return -EINVAL;
+            }
+          if (bsize > param->bsize)
+            {
+              param->bsize = bsize;
+            }
+          (*num)++;
+        }
+    }
+
+  /* parameters of any function must be in the cache at once */
+
+  for (i = 0; i < c->num_of_functions; i++)
+    {
+      rt_function_t *f = &c->functions[i].func;
+      unsigned long bsize = 0;
+
+      for (j = 0; j < f->num_of_inputs; j++)
+        {
+          nnb_param_t *param = find_param(nnb, f->inputs[j]);
+
+          if (param)
+            {
+              bsize += param->bsize;
+            }
+        }
+      if (bsize > nnb->cache_bsize)
+        {
+          DNN_PRINT("cache is smaller than parameters of a function\n");
+          return -ENOMEM;
+        }
+    }
+
+  return 0;
+}
+
+int dnn_nnb_attach(dnn_runtime_t * rt, const nn_network_t * network)
+{
+  rt_context_t *c = (rt_context_t *) rt->impl_ctx;
+  nnb_impl_t *nnb;
+  nnb_pager_t *pager;
+  int num = 0;
+  int err;
+  int i, j;
+
+  rt->pager = NULL;
+  nnb = nnb_find(network);
+  if (nnb == NULL)
+    {
+      return 0;
+    }
+
+  if (nnb->mode == NNB_PAGED)
+    {
+      err = nnb_check_params(nnb, c, &num);
+      if (err != 0)
+        {
+          return err;
+        }
+    }
+
+  pager = (nnb_pager_t *) calloc(1, sizeof(nnb_pager_t));
+  if (pager == NULL)
+    {
+      return -ENOMEM;
+    }
+  pager->nnb = nnb;
+  pager->ctx = c;
+
+  if (num > 0)
+    {
+      pager->funcs = (nnb_func_t *) calloc(c->num_of_functions,
+                                           sizeof(nnb_func_t));
+      pager->uses = (nnb_use_t *) malloc(sizeof(nnb_use_t) * num);
+      if (pager->funcs == NULL || pager->uses == NULL)
+        {
+          free(pager->funcs);
+          free(pager->uses);
+          free(pager);
+          return -ENOMEM;
+        }
+    }
+
+  /* wrap functions which use parameters */
+
+  for (i = 0, num = 0; pager->funcs && i < c->num_of_functions; i++)
+    {
+      rt_function_t *f = &c->functions[i].func;
+      nnb_func_t *func = &pager->funcs[i];
+
+      func->first = num;
+      for (j = 0; j < f->num_of_inputs; j++)
+        {
+          nnb_param_t *param = find_param(nnb, f->inputs[j]);
+
+          if (param)
+            {
+              pager->uses[num].var = f->inputs[j];
+              pager->uses[num].param = param;
+              num++;
+            }
+        }
+      func->num = num - func->first;
+      if (func->num > 0)
+        {
+          func->exec_func = f->exec_func;
+          f->exec_func = nnb_exec;
+        }
+    }
+
+  /* parameters are not in RAM until their function is executed */
+
+  for (i = 0; i < num; i++)
+    {
+      pager->uses[i].var->data = NULL;
+    }
+
+  nnb->users++;
+  rt->pager = pager;
+  return 0;
+}
+
+void dnn_nnb_detach(dnn_runtime_t * rt)
+{
+  nnb_pager_t *pager = (nnb_pager_t *) rt->pager;
+
+  if (pager == NULL)
+    {
+      return;
+    }
+
+  pager->nnb->users--;
+  free(pager->funcs);
+  free(pager->uses);
+  free(pager);
+  rt->pager = NULL;
+}
+
+void dnn_nnb_select(dnn_runtime_t * rt)
+{
+  s_dnn_pager = (nnb_pager_t *) rt->pager;
+}
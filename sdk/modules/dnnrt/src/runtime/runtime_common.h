@@ -37,6 +37,8 @@
 
 #  include <sdk/config.h>
 #  include <errno.h>
+#  include <stddef.h>
+#  include <stdint.h>
 #  include <nnablart/functions.h>
 #  include <nnablart/runtime.h>
 
@@ -122,17 +124,62 @@ extern "C"
       int req_scratch_buf_bsize;
       int scratch_buf_bsize;
       void *scratch_buf;
+      int req_shared_buf_bsize;
+      int shared_buf_bsize;     /* head of scratch_buf, before the parts */
     } dnn_global_context;
 
   rt_function_error_t dnnrt_exec_convolution(rt_function_t * f);
   rt_function_error_t dnnrt_exec_affine(rt_function_t * f);
+  rt_function_error_t dnnrt_exec_depthwise_convolution(rt_function_t * f);
+  rt_function_error_t dnnrt_exec_relu(rt_function_t * f);
+  rt_function_error_t dnnrt_exec_max_pooling(rt_function_t * f);
+  rt_function_error_t dnnrt_exec_average_pooling(rt_function_t * f);
+  rt_function_error_t dnnrt_exec_softmax(rt_function_t * f);
   rt_return_value_t dnnrt_affine_alloc(nn_network_t * net,
                                        void *function_context);
   rt_return_value_t dnnrt_convolution_alloc(nn_network_t * net,
                                             void *function_context);
+  rt_return_value_t dnnrt_depthwise_convolution_alloc(nn_network_t * net,
+                                                      void *function_context);
+  rt_return_value_t dnnrt_relu_alloc(nn_network_t * net,
+                                     void *function_context);
+  rt_return_value_t dnnrt_max_pooling_alloc(nn_network_t * net,
+                                            void *function_context);
+  rt_return_value_t dnnrt_average_pooling_alloc(nn_network_t * net,
+                                                void *function_context);
+  rt_return_value_t dnnrt_softmax_alloc(nn_network_t * net,
+                                        void *function_context);
 
   void dnn_req_scratch_buf(int size);
   void *dnn_scratch_buf(void);
+  void *dnn_scratch_buf_part(int part);
+
+  /* scratch buffer read by all the parts of a layer */
+
+  void dnn_req_shared_buf(int size);
+  void *dnn_shared_buf(void);
+
+  struct dnn_runtime;
+  int dnn_memory_plan(struct dnn_runtime *rt, const nn_network_t * network);
+
+  /* parameters of a network opened by dnn_nnb_open() */
+
+  int dnn_nnb_attach(struct dnn_runtime *rt, const nn_network_t * network);
+  void dnn_nnb_detach(struct dnn_runtime *rt);
+  void dnn_nnb_select(struct dnn_runtime *rt);
+
+  /* read data of a network, which is not in RAM if the network is paged */
+
+  int dnn_nnb_read(const nn_network_t * network, const void *data,
+                   void *buf, size_t bsize);
+
+#  ifdef CONFIG_DNN_RT_PROFILE
+  uint32_t dnn_profile_begin(void);
+  void dnn_profile_end(int function, uint32_t start);
+#  else
+#    define dnn_profile_begin() (0)
+#    define dnn_profile_end(function, start) ((void)(start))
+#  endif
 
 #  ifdef __cplusplus
 }
@@ -0,0 +1,312 @@
+/****************************************************************************
+ * modules/dnnrt/src/runtime/runtime_fusion.c
+ *
+ *   Copyright 2018 Sony Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Corporation nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <dnnrt/runtime.h>
+#include <context.h>
+#include <runtime_internal.h>
+#include "runtime_common.h"
+#include "runtime_fusion.h"
+#include "runtime_quant.h"
+
+#define Y (0)
+
+/* fusions of all the runtimes */
+
+static dnn_fusion_t *s_dnn_fusion;
+
+#ifdef CONFIG_DNN_RT_FUSION
+static int is_network_output(rt_context_t * c, rt_variable_t * var)
+{
+  int i;
+
+  for (i = 0; i < c->num_of_outputs; i++)
+    {
+      if (&c->variables[c->output_variable_ids[i]] == var)
+        {
+          return 1;
+        }
+    }
+  return 0;
+}
+
+/* the function reading var as its only input, if nothing else reads it */
+
+static rt_function_t *sole_consumer(rt_context_t * c, rt_variable_t * var)
+{
+  rt_function_t *consumer = NULL;
+  int i, j;
+
+  if (is_network_output(c, var))
+    {
+      return NULL;
+    }
+
+  for (i = 0; i < c->num_of_functions; i++)
+    {
+      rt_function_t *f = &c->functions[i].func;
+
+      for (j = 0; j < f->num_of_inputs; j++)
+        {
+          if (f->inputs[j] != var)
+            {
+              continue;
+            }
+          if (consumer != NULL || f->num_of_inputs != 1)
+            {
+              return NULL;
+            }
+          consumer = f;
+        }
+    }
+
+  return consumer;
+}
+
+static int is_head(rt_function_t * f)
+{
+  int i;
+
+  if (f->exec_func != dnnrt_exec_convolution &&
+      f->exec_func != dnnrt_exec_depthwise_convolution &&
+      f->exec_func != dnnrt_exec_affine)
+    {
+      return 0;
+    }
+
+  if (f->num_of_outputs != 1)
+    {
+      return 0;
+    }
+
+  /* int8 layers clamp fused ReLU at the zero point. Float output of
+   * them is converted in place, after which nothing can be fused.
+   */
+
+  if (dnn_quant_of(f))
+    {
+      return f->outputs[Y]->type == NN_DATA_TYPE_INT8;
+    }
+
+  /* affine of mixed types is not executed by the split kernels */
+
+  for (i = 0; i < f->num_of_inputs; i++)
+    {
+      if (f->inputs[i]->type != f->outputs[Y]->type)
+        {
+          return 0;
+        }
+    }
+  return 1;
+}
+
+static int pool_op_of(rt_function_t * f)
+{
+  if (f->exec_func == dnnrt_exec_max_pooling)
+    {
+      return DNN_MP_POOL_MAX;
+    }
+  else if (f->exec_func == dnnrt_exec_average_pooling)
+    {
+      return DNN_MP_POOL_AVG;
+    }
+  return DNN_MP_POOL_NONE;
+}
+#endif
+
+int dnn_fusion_build(dnn_runtime_t * rt)
+{
+#ifdef CONFIG_DNN_RT_FUSION
+  rt_context_t *c = (rt_context_t *) rt->impl_ctx;
+  int i;
+
+  for (i = 0; i < c->num_of_functions; i++)
+    {
+      rt_function_t *f = &c->functions[i].func;
+      rt_function_t *relu = NULL;
+      rt_function_t *pool = NULL;
+      rt_function_t *next;
+      rt_variable_t *out;
+      dnn_fusion_t *fu;
+      dnn_mp_pool_t a;
+      int op = DNN_MP_POOL_NONE;
+
+      if (!is_head(f))
+        {
+          continue;
+        }
+
+      out = f->outputs[Y];
+      next = sole_consumer(c, out);
+      if (next && next->exec_func == dnnrt_exec_relu)
+        {
+          relu = next;
+          out = relu->outputs[Y];
+          next = sole_consumer(c, out);
+        }
+
+      /* pooling needs whole planes, which affine does not have */
+
+      if (next && f->exec_func != dnnrt_exec_affine)
+        {
+          op = pool_op_of(next);
+          if (op != DNN_MP_POOL_NONE && out->shape.size >= 3 &&
+              dnnrt_pooling_args(next, op, &a))
+            {
+              pool = next;
+            }
+        }
+
+      if (relu == NULL && pool == NULL)
+        {
+          continue;
+        }
+
+      fu = (dnn_fusion_t *) malloc(sizeof(dnn_fusion_t));
+      if (fu == NULL)
+        {
+          dnn_fusion_free(rt);
+          return -ENOMEM;
+        }
+      fu->owner = c;
+      fu->head = f;
+      fu->index = i;
+      fu->relu = relu;
+      fu->pool = pool;
+      fu->pool_op = pool ? op : DNN_MP_POOL_NONE;
+      fu->next = s_dnn_fusion;
+      s_dnn_fusion = fu;
+
+      if (relu)
+        {
+          relu->exec_func = dnnrt_exec_fused;
+        }
+      if (pool)
+        {
+          pool->exec_func = dnnrt_exec_fused;
+        }
+    }
+#endif
+
+  return 0;
+}
+
+void dnn_fusion_free(dnn_runtime_t * rt)
+{
+  dnn_fusion_t **p = &s_dnn_fusion;
+
+  while (*p)
+    {
+      dnn_fusion_t *fu = *p;
+
+      if (fu->owner == rt->impl_ctx)
+        {
+          *p = fu->next;
+          free(fu);
+        }
+      else
+        {
+          p = &fu->next;
+        }
+    }
+}
+
+int dnn_fusion_index(dnn_runtime_t * rt, int i)
+{
+  rt_context_t *c = (rt_context_t *) rt->impl_ctx;
+  rt_function_t *f = &c->functions[i].func;
+  dnn_fusion_t *fu;
+
+  for (fu = s_dnn_fusion; fu; fu = fu->next)
+    {
+      if (fu->owner == c && (fu->relu == f || fu->pool == f))
+        {
+          return fu->index;
+        }
+    }
+  return i;
+}
+
+const dnn_fusion_t *dnn_fusion_of(rt_function_t * head)
+{
+  dnn_fusion_t *fu;
+
+  for (fu = s_dnn_fusion; fu; fu = fu->next)
+    {
+      if (fu->head == head)
+        {
+          return fu;
+        }
+    }
+  return NULL;
+}
+
+rt_variable_t *dnn_fusion_output(rt_function_t * head,
+                                 const dnn_fusion_t * fu)
+{
+  return (fu && fu->relu) ? fu->relu->outputs[Y] : head->outputs[Y];
+}
+
+void dnn_fusion_post(const dnn_fusion_t * fu, dnn_mp_job_t * job,
+                     int plane, int planes, int elem_size)
+{
+  dnn_mp_pool_t *a = &job->post_pool;
+
+  job->post_relu = (fu && fu->relu) ? 1 : 0;
+  a->op = DNN_MP_POOL_NONE;
+
+  if (fu == NULL || fu->pool == NULL)
+    {
+      return;
+    }
+  if (!dnnrt_pooling_args(fu->pool, fu->pool_op, a))
+    {
+      a->op = DNN_MP_POOL_NONE;
+      return;
+    }
+
+  /* input is set by the kernel to the output of the part */
+
+  a->out = (uint8_t *) fu->pool->outputs[Y]->data +
+    plane * a->out_w * a->out_h * elem_size;
+  a->ch = planes;
+}
+
+rt_function_error_t dnnrt_exec_fused(rt_function_t * f)
+{
+  /* executed by the head */
+
+  return RT_FUNCTION_ERROR_NOERROR;
+}
@@ -0,0 +1,94 @@
+/****************************************************************************
+ * modules/dnnrt/src/runtime/runtime_fusion.h
+ *
+ *   Copyright 2018 Sony Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Corporation nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef RUNTIME_FUSION_H
+#  define RUNTIME_FUSION_H
+
+/* Fusion of layers executed by dnnrt.
+ *
+ * A convolution, depthwise convolution or affine ("head") is fused with
+ * the ReLU which is the only consumer of its output, and a convolution is
+ * further fused with the max or average pooling which follows. The head
+ * writes to the output of ReLU directly, then each part applies ReLU and
+ * pooling to its own channels while they are computed on that CPU. The
+ * fused functions are left in the network and do nothing.
+ */
+
+#  include <nnablart/functions.h>
+#  include "runtime_mp.h"
+
+#  ifdef __cplusplus
+extern "C"
+{
+#  endif
+
+  struct dnn_runtime;
+
+  typedef struct dnn_fusion
+    {
+      struct dnn_fusion *next;
+      void *owner;              /* rt_context_t of the network */
+      rt_function_t *head;
+      int index;                /* index of head in the network */
+      rt_function_t *relu;      /* fused ReLU or NULL */
+      rt_function_t *pool;      /* fused pooling or NULL */
+      int pool_op;              /* DNN_MP_POOL_* of pool */
+    } dnn_fusion_t;
+
+  int dnn_fusion_build(struct dnn_runtime *rt);
+  void dnn_fusion_free(struct dnn_runtime *rt);
+
+  /* index of the function which executes the i-th function of rt */
+
+  int dnn_fusion_index(struct dnn_runtime *rt, int i);
+
+  /* Used by heads. fu is NULL for a function which is not fused. */
+
+  const dnn_fusion_t *dnn_fusion_of(rt_function_t * head);
+  rt_variable_t *dnn_fusion_output(rt_function_t * head,
+                                   const dnn_fusion_t * fu);
+  void dnn_fusion_post(const dnn_fusion_t * fu, dnn_mp_job_t * job,
+                       int plane, int planes, int elem_size);
+
+  rt_function_error_t dnnrt_exec_fused(rt_function_t * f);
+
+  /* pooling.c */
+
+  int dnnrt_pooling_args(rt_function_t * f, int op, dnn_mp_pool_t * a);
+
+#  ifdef __cplusplus
+}
+#  endif
+
+#endif                          /* RUNTIME_FUSION_H */
@@ -0,0 +1,270 @@
+/****************************************************************************
+ * modules/dnnrt/src/runtime/runtime_mp.c
+ *
+ *   Copyright 2018 Sony Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Corporation nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include <sdk/config.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#ifdef CONFIG_DNN_RT_MP
+#  include <asmp/asmp.h>
+#  include <asmp/mpmq.h>
+#  include <asmp/mptask.h>
+#endif
+#include "runtime_mp.h"
+
+#define DNN_MP_PRINT(...) printf(__VA_ARGS__)
+
+/* timeout of boot message from a worker */
+
+#define DNN_MP_BOOT_TIMEOUT_MS (1000)
+
+struct dnn_mp_context
+{
+  int cpu_num;                  /* number of CPUs including the main core */
+  int last_parts;               /* number of parts of the last layer */
+#ifdef CONFIG_DNN_RT_MP
+  mptask_t task[DNN_MP_MAX_CPUS - 1];
+  mpmq_t mq[DNN_MP_MAX_CPUS - 1];
+#endif
+};
+
+static struct dnn_mp_context s_mp = { 1, 1 };
+
+#ifdef CONFIG_DNN_RT_MP
+static int start_worker(int i)
+{
+  uint32_t data;
+  int ret;
+
+  ret = mptask_init(&s_mp.task[i], CONFIG_DNN_RT_MP_WORKER_PATH);
+  if (ret != 0)
+    {
+      DNN_MP_PRINT("mptask_init(%s) failure. %d\n",
+                   CONFIG_DNN_RT_MP_WORKER_PATH, ret);
+      return ret;
+    }
+
+  ret = mptask_assign(&s_mp.task[i]);
+  if (ret != 0)
+    {
+      DNN_MP_PRINT("mptask_assign() failure. %d\n", ret);
+      return ret;
+    }
+
+  ret = mpmq_init(&s_mp.mq[i], DNN_MP_KEY_MQ,
+                  mptask_getcpuid(&s_mp.task[i]));
+  if (ret < 0)
+    {
+      DNN_MP_PRINT("mpmq_init() failure. %d\n", ret);
+      goto task_error;
+    }
+
+  ret = mptask_bindobj(&s_mp.task[i], &s_mp.mq[i]);
+  if (ret < 0)
+    {
+      DNN_MP_PRINT("mptask_bindobj(mq) failure. %d\n", ret);
+      goto mq_error;
+    }
+
+  ret = mptask_exec(&s_mp.task[i]);
+  if (ret < 0)
+    {
+      DNN_MP_PRINT("mptask_exec() failure. %d\n", ret);
+      goto mq_error;
+    }
+
+  ret = mpmq_timedreceive(&s_mp.mq[i], &data, DNN_MP_BOOT_TIMEOUT_MS);
+  if (ret != DNN_MP_MSG_BOOT)
+    {
+      DNN_MP_PRINT("worker %d did not boot. %d\n", i, ret);
+      mptask_destroy(&s_mp.task[i], true, NULL);
+      mpmq_destroy(&s_mp.mq[i]);
+      return ret < 0 ? ret : -EIO;
+    }
+
+  return 0;
+
+mq_error:
+  mpmq_destroy(&s_mp.mq[i]);
+task_error:
+  mptask_destroy(&s_mp.task[i], false, NULL);
+  return ret;
+}
+
+static void stop_worker(int i)
+{
+  int wret = -1;
+
+  mpmq_send(&s_mp.mq[i], DNN_MP_MSG_EXIT, 0);
+  mptask_destroy(&s_mp.task[i], false, &wret);
+  mpmq_destroy(&s_mp.mq[i]);
+}
+#endif
+
+int dnn_mp_initialize(int cpu_num)
+{
+  if (cpu_num < 1 || cpu_num > DNN_MP_MAX_CPUS)
+    {
+      return -EINVAL;
+    }
+  if (s_mp.cpu_num > 1)
+    {
+      return -EBUSY;
+    }
+  if (cpu_num == 1)
+    {
+      return 0;
+    }
+
+#ifdef CONFIG_DNN_RT_MP
+  int i, ret;
+
+  for (i = 0; i < cpu_num - 1; i++)
+    {
+      ret = start_worker(i);
+      if (ret != 0)
+        {
+          while (i--)
+            {
+              stop_worker(i);
+            }
+          return ret;
+        }
+    }
+
+  s_mp.cpu_num = cpu_num;
+  return 0;
+#else
+  return -ENOTSUP;
+#endif
+}
+
+void dnn_mp_finalize(void)
+{
+#ifdef CONFIG_DNN_RT_MP
+  int i;
+
+  for (i = 0; i < s_mp.cpu_num - 1; i++)
+    {
+      stop_worker(i);
+    }
+#endif
+  s_mp.cpu_num = 1;
+}
+
+int dnn_mp_cpu_num(void)
+{
+  return s_mp.cpu_num;
+}
+
+int dnn_mp_parts(int units, unsigned long macs)
+{
+#ifdef CONFIG_DNN_RT_MP
+  /* small layers are faster on one CPU than paying for messaging */
+
+  if (macs < CONFIG_DNN_RT_MP_MIN_MACS)
+    {
+      return 1;
+    }
+#endif
+
+  return units < s_mp.cpu_num ? units : s_mp.cpu_num;
+}
+
+int dnn_mp_last_parts(void)
+{
+  int parts = s_mp.last_parts;
+
+  /* cleared, so that a layer executed without dnn_mp_exec() gets 1 */
+
+  s_mp.last_parts = 1;
+  return parts;
+}
+
+int dnn_mp_exec(dnn_mp_job_t * jobs, int num)
+{
+  int err = 0;
+  int ret;
+
+  s_mp.last_parts = num;
+
+#ifdef CONFIG_DNN_RT_MP
+  uint32_t data;
+  int i;
+
+  for (i = 1; i < num; i++)
+    {
+      jobs[i].result = 0;
+      ret = mpmq_send(&s_mp.mq[i - 1], DNN_MP_MSG_EXEC,
+                      (uint32_t) (uintptr_t) & jobs[i]);
+      if (ret < 0)
+        {
+          DNN_MP_PRINT("mpmq_send() failure. %d\n", ret);
+          err = ret;
+          num = i;
+          break;
+        }
+    }
+#endif
+
+  ret = dnn_mp_exec_job(&jobs[0]);
+  if (ret != 0 && err == 0)
+    {
+      err = ret;
+    }
+
+#ifdef CONFIG_DNN_RT_MP
+  /* Wait for all the parts, the next layer reads the whole output. */
+
+  for (i = 1; i < num; i++)
+    {
+      ret = mpmq_receive(&s_mp.mq[i - 1], &data);
+      if (ret != DNN_MP_MSG_DONE)
+        {
+          DNN_MP_PRINT("worker %d failure. %d\n", i - 1, ret);
+          ret = ret < 0 ? ret : -EIO;
+        }
+      else
+        {
+          ret = jobs[i].result;
+        }
+      if (ret != 0 && err == 0)
+        {
+          err = ret;
+        }
+    }
+#endif
+
+  return err;
+}
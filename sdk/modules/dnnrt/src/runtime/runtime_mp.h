@@ -0,0 +1,219 @@
+/****************************************************************************
+ * modules/dnnrt/src/runtime/runtime_mp.h
+ *
+ *   Copyright 2018 Sony Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Corporation nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef RUNTIME_MP_H
+#  define RUNTIME_MP_H
+
+/* Definitions shared by dnnrt and its ASMP worker (worker/dnnrt_worker.c).
+ *
+ * A layer is split into parts by channels (convolution, depthwise
+ * convolution and pooling) or output rows (affine). Part 0 is executed on the main core and the others are
+ * sent to workers by the address of dnn_mp_job_t. As memory of the main
+ * core is not remapped, the worker accesses the job, the network and the
+ * buffers by the same address as the main core.
+ */
+
+#  include <stdint.h>
+
+#  ifdef __cplusplus
+extern "C"
+{
+#  endif
+
+/* Maximum number of CPUs, including the main core */
+
+#  define DNN_MP_MAX_CPUS (6)
+
+#  define DNN_MP_KEY_MQ (2)
+
+/* Message IDs. Data of EXEC and DONE is an address of dnn_mp_job_t. */
+
+#  define DNN_MP_MSG_BOOT (1)
+#  define DNN_MP_MSG_EXEC (2)
+#  define DNN_MP_MSG_DONE (3)
+#  define DNN_MP_MSG_EXIT (4)
+
+  typedef enum dnn_mp_kernel
+    {
+      DNN_MP_CONV_F32 = 0,
+      DNN_MP_CONV_Q15,
+      DNN_MP_CONV_Q7,
+      DNN_MP_AFFINE_F32,
+      DNN_MP_AFFINE_Q15,
+      DNN_MP_AFFINE_Q7,
+      DNN_MP_DWCONV_F32,
+      DNN_MP_DWCONV_Q15,
+      DNN_MP_DWCONV_Q7,
+      DNN_MP_POOL_F32,
+      DNN_MP_POOL_Q15,
+      DNN_MP_POOL_Q7,
+      DNN_MP_CONV_S8,
+      DNN_MP_AFFINE_S8,
+      DNN_MP_DWCONV_S8,
+    } dnn_mp_kernel_t;
+
+#  define DNN_MP_POOL_NONE (0)
+#  define DNN_MP_POOL_MAX  (1)
+#  define DNN_MP_POOL_AVG  (2)
+
+  /* arguments of arm_convolve_CHW_*_basic_nonsquare().
+   * Depthwise convolution uses the same arguments with out_ch == in_ch.
+   */
+
+  typedef struct dnn_mp_conv
+    {
+      const void *in;
+      const void *wt;
+      const void *bias;
+      void *out;
+      uint16_t in_w;
+      uint16_t in_h;
+      uint16_t in_ch;
+      uint16_t out_ch;
+      uint16_t out_w;
+      uint16_t out_h;
+      uint16_t ker_w;
+      uint16_t ker_h;
+      uint16_t pad_w;
+      uint16_t pad_h;
+      uint16_t stride_w;
+      uint16_t stride_h;
+      uint16_t bias_shift;
+      uint16_t out_shift;
+    } dnn_mp_conv_t;
+
+  /* affine for "batch" inputs of in_size elements,
+   * which calculates out_size rows out of total out_stride rows.
+   */
+
+  typedef struct dnn_mp_affine
+    {
+      const void *in;
+      const void *wt;
+      const void *bias;
+      void *out;
+      uint16_t batch;
+      uint16_t in_size;
+      uint16_t out_size;
+      uint16_t out_stride;
+      uint16_t bias_shift;
+      uint16_t out_shift;
+    } dnn_mp_affine_t;
+
+  /* max or average pooling of ch planes in CHW layout */
+
+  typedef struct dnn_mp_pool
+    {
+      const void *in;
+      void *out;
+      uint16_t ch;
+      uint16_t in_w;
+      uint16_t in_h;
+      uint16_t out_w;
+      uint16_t out_h;
+      uint16_t ker_w;
+      uint16_t ker_h;
+      uint16_t pad_w;
+      uint16_t pad_h;
+      uint16_t stride_w;
+      uint16_t stride_h;
+      uint8_t op;               /* DNN_MP_POOL_* */
+      uint8_t including_pad;    /* average pooling counts padding */
+    } dnn_mp_pool_t;
+
+  /* Requantization of int8 kernels (DNN_MP_*_S8). Output channel c is
+   *
+   *   acc = bias[c] + sum((x + in_offset) * w)
+   *   y   = clamp(out_offset + round(acc * mult[c] / 2^(31 - shift[c])),
+   *               act_min, act_max)
+   *
+   * where bias is int32 and w is int8 quantized per output channel.
+   * If out_scale is not 0, y is converted to float (y - out_offset) *
+   * out_scale in place, so the output is given as a float buffer.
+   */
+
+  typedef struct dnn_mp_quant
+    {
+      const int32_t *mult;
+      const int32_t *shift;
+      int32_t in_offset;
+      int32_t out_offset;
+      int32_t act_min;
+      int32_t act_max;
+      float out_scale;
+    } dnn_mp_quant_t;
+
+  typedef struct dnn_mp_job
+    {
+      uint32_t kernel;          /* dnn_mp_kernel_t */
+      int32_t result;           /* 0 on success */
+      void *scratch;            /* scratch buffer of this part */
+      union
+        {
+          dnn_mp_conv_t conv;
+          dnn_mp_affine_t affine;
+          dnn_mp_pool_t pool;
+        } u;
+
+      /* Fused operations applied to the output of this part. ReLU is
+       * applied in place, then the output is pooled by post_pool unless
+       * its op is DNN_MP_POOL_NONE (convolutions only).
+       */
+
+      uint8_t post_relu;
+      dnn_mp_pool_t post_pool;
+
+      /* int8 kernels only. bias of the arguments is int32_t. */
+
+      dnn_mp_quant_t quant;
+    } dnn_mp_job_t;
+
+  /* Execute a job. Linked to both dnnrt and the worker. */
+
+  int dnn_mp_exec_job(dnn_mp_job_t * job);
+
+  /* Supervisor side (runtime_mp.c) */
+
+  int dnn_mp_initialize(int cpu_num);
+  void dnn_mp_finalize(void);
+  int dnn_mp_cpu_num(void);
+  int dnn_mp_parts(int units, unsigned long macs);
+  int dnn_mp_last_parts(void);
+  int dnn_mp_exec(dnn_mp_job_t * jobs, int num);
+
+#  ifdef __cplusplus
+}
+#  endif
+
+#endif                          /* RUNTIME_MP_H */
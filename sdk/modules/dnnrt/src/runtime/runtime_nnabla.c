@@ -42,18 +42,113 @@
 #include <context.h>
 #include <runtime_internal.h>
 #include "runtime_common.h"
+#include "runtime_fusion.h"
+#include "runtime_mp.h"
+#include "runtime_quant.h"
 
 #define WEIGHT (1)
 
+/* each part of a split layer has its own scratch buffer */
+
+#define SCRATCH_ALIGN(s) (((s) + 3) & ~3)
+
+#ifdef CONFIG_DNN_RT_PROFILE
+/* Cycle counter of Cortex-M4 (DWT) is used for profiling. */
+
+#  define DWT_CTRL        (*(volatile uint32_t *)0xe0001000)
+#  define DWT_CTRL_CYCENA (1u << 0)
+#  define DWT_CYCCNT      (*(volatile uint32_t *)0xe0001004)
+
+extern uint32_t cxd56_get_cpu_baseclk(void);
+
+struct dnn_profile_context
+{
+  dnn_runtime_t *rt;            /* runtime of the last forward */
+  int num;
+  dnn_profile_t prof[CONFIG_DNN_RT_PROFILE_NUM];
+};
+
+static struct dnn_profile_context s_dnn_prof;
+#endif
+
 static struct dnn_global_context s_dnn_gctx;
 
-int dnn_initialize(void *reserved)
+/* functions executed by dnnrt instead of nnabla-c-runtime */
+
+static const struct
+{
+  nn_function_type_t function;
+  rt_return_value_t (*alloc)(nn_network_t * net, void *function_context);
+} s_dnn_callbacks[] =
+{
+  { NN_FUNCTION_CONVOLUTION, dnnrt_convolution_alloc },
+  { NN_FUNCTION_DEPTHWISE_CONVOLUTION, dnnrt_depthwise_convolution_alloc },
+  { NN_FUNCTION_AFFINE, dnnrt_affine_alloc },
+  { NN_FUNCTION_RELU, dnnrt_relu_alloc },
+  { NN_FUNCTION_MAX_POOLING, dnnrt_max_pooling_alloc },
+  { NN_FUNCTION_AVERAGE_POOLING, dnnrt_average_pooling_alloc },
+  { NN_FUNCTION_SOFTMAX, dnnrt_softmax_alloc },
+};
+
+/* nnabla-c-runtime has no implementation of int8 layers quantized by
+ * tools/nnbquant.py. A QINT8 function not taken by dnnrt (its parameters
+ * are unsupported, or CONFIG_DNN_RT_QUANT is disabled) cannot run, nor
+ * can parameters written by another version of the tool.
+ */
+
+static int dnn_check_quant(rt_context_t * c, const nn_network_t * network)
+{
+  int32_t marker[2];
+  int err;
+  int i;
+
+  for (i = 0; i < c->num_of_functions; i++)
+    {
+      rt_function_t *f = &c->functions[i].func;
+
+      if ((int)c->functions[i].info->impl != DNNRT_IMPLEMENT_QINT8)
+        {
+          continue;
+        }
+      if (f->exec_func != dnnrt_exec_convolution &&
+          f->exec_func != dnnrt_exec_depthwise_convolution &&
+          f->exec_func != dnnrt_exec_affine)
+        {
+          DNN_PRINT("function %d: int8 quantized layer is unsupported "
+                    "by dnnrt\n", i);
+          return -ENOTSUP;
+        }
+
+      err = dnn_nnb_read(network, f->inputs[DNN_QUANT_PARAM]->data,
+                         marker, sizeof(marker));
+      if (err != 0)
+        {
+          return err;
+        }
+      if (marker[0] != DNN_QUANT_MAGIC || marker[1] != DNN_QUANT_VERSION)
+        {
+          DNN_PRINT("function %d: int8 quantized layer is not of "
+                    "nnbquant.py version %d\n", i, DNN_QUANT_VERSION);
+          return -ENOTSUP;
+        }
+    }
+
+  return 0;
+}
+
+int dnn_initialize(dnn_config_t * config)
 {
-  return reserved == NULL ? RT_RET_NOERROR : -EINVAL;
+  if (s_dnn_gctx.rt_count > 0)
+    {
+      return -EBUSY;
+    }
+
+  return dnn_mp_initialize(config ? config->cpu_num : 1);
 }
 
 int dnn_finalize(void)
 {
+  dnn_mp_finalize();
   return RT_RET_NOERROR;
 }
 
@@ -62,6 +157,11 @@ int dnn_runtime_initialize(dnn_runtime_t * rt, const nn_network_t * network)
   DNN_CHECK_NULL_RET(rt, -EINVAL);
   DNN_CHECK_NULL_RET(network, -EINVAL);
   void *tmp_buf;
+  int shared_bsize;
+  int parts_bsize;
+
+  rt->arena = NULL;
+  rt->pager = NULL;
 
   /* register dnnrt's callback with rt_context */
   int err;
@@ -71,20 +171,20 @@ int dnn_runtime_initialize(dnn_runtime_t * rt, const nn_network_t * network)
       goto alloc_error;
     }
   rt_context_pointer ctx = (rt_context_pointer) (rt->impl_ctx);
-  err =
-    (int)rt_add_callback(ctx, NN_FUNCTION_CONVOLUTION, dnnrt_convolution_alloc);
-  if (err != RT_RET_NOERROR)
+  for (int i = 0;
+       i < (int)(sizeof(s_dnn_callbacks) / sizeof(s_dnn_callbacks[0])); i++)
     {
-      goto error;
-    }
-  err = (int)rt_add_callback(ctx, NN_FUNCTION_AFFINE, dnnrt_affine_alloc);
-  if (err != RT_RET_NOERROR)
-    {
-      goto error;
+      err = (int)rt_add_callback(ctx, s_dnn_callbacks[i].function,
+                                 s_dnn_callbacks[i].alloc);
+      if (err != RT_RET_NOERROR)
+        {
+          goto error;
+        }
     }
 
   /* initialize rt_context and count up required minimum size of scratch_buf */
   s_dnn_gctx.req_scratch_buf_bsize = 0;
+  s_dnn_gctx.req_shared_buf_bsize = 0;
   /* remove const to use the as-is rt_initialize_context() */
   err = (int)rt_initialize_context(ctx, (nn_network_t *) network);
   if (err != RT_RET_NOERROR)
@@ -92,26 +192,68 @@ int dnn_runtime_initialize(dnn_runtime_t * rt, const nn_network_t * network)
       goto error;
     }
 
-  /* resize scratch buffer */
-  if (s_dnn_gctx.req_scratch_buf_bsize > s_dnn_gctx.scratch_buf_bsize)
+  /* fail rather than run int8 layers without dnnrt */
+  err = dnn_check_quant((rt_context_t *) ctx, network);
+  if (err != 0)
     {
-      tmp_buf =
-        realloc(s_dnn_gctx.scratch_buf, s_dnn_gctx.req_scratch_buf_bsize);
+      goto error;
+    }
+
+  /* fuse ReLU and pooling into the preceding layer */
+  err = dnn_fusion_build(rt);
+  if (err != 0)
+    {
+      goto error;
+    }
+
+  /* pack activations into one arena by their lifetimes */
+  err = dnn_memory_plan(rt, network);
+  if (err != 0)
+    {
+      goto error;
+    }
+
+  /* read parameters on demand if the network is paged */
+  err = dnn_nnb_attach(rt, network);
+  if (err != 0)
+    {
+      goto error;
+    }
+
+  /* resize scratch buffer, which is the shared part and the parts */
+  shared_bsize = s_dnn_gctx.shared_buf_bsize;
+  parts_bsize = s_dnn_gctx.scratch_buf_bsize - shared_bsize;
+  if (s_dnn_gctx.req_shared_buf_bsize > shared_bsize)
+    {
+      shared_bsize = s_dnn_gctx.req_shared_buf_bsize;
+    }
+  if (s_dnn_gctx.req_scratch_buf_bsize > parts_bsize)
+    {
+      parts_bsize = s_dnn_gctx.req_scratch_buf_bsize;
+    }
+  if (shared_bsize + parts_bsize > s_dnn_gctx.scratch_buf_bsize)
+    {
+      tmp_buf = realloc(s_dnn_gctx.scratch_buf, shared_bsize + parts_bsize);
       if (!tmp_buf)
         {
           err = -ENOMEM;
           goto error;
         }
       s_dnn_gctx.scratch_buf = tmp_buf;
-      s_dnn_gctx.scratch_buf_bsize = s_dnn_gctx.req_scratch_buf_bsize;
+      s_dnn_gctx.scratch_buf_bsize = shared_bsize + parts_bsize;
+      s_dnn_gctx.shared_buf_bsize = shared_bsize;
     }
   ++s_dnn_gctx.rt_count;
 
   return 0;
 
 error:
+  dnn_nnb_detach(rt);
+  dnn_fusion_free(rt);
   rt_free_context(&rt->impl_ctx);
   rt->impl_ctx = NULL;
+  free(rt->arena);
+  rt->arena = NULL;
 alloc_error:
   return err;
 }
@@ -126,9 +268,17 @@ int dnn_runtime_finalize(dnn_runtime_t * rt)
       s_dnn_gctx.scratch_buf = NULL;
       s_dnn_gctx.scratch_buf_bsize = 0;
       s_dnn_gctx.req_scratch_buf_bsize = 0;
+      s_dnn_gctx.shared_buf_bsize = 0;
+      s_dnn_gctx.req_shared_buf_bsize = 0;
     }
 
-  return (int)rt_free_context((rt_context_pointer *) & (rt->impl_ctx));
+  dnn_nnb_detach(rt);
+  dnn_fusion_free(rt);
+  int err = (int)rt_free_context((rt_context_pointer *) & (rt->impl_ctx));
+
+  free(rt->arena);
+  rt->arena = NULL;
+  return err;
 }
 
 int dnn_runtime_forward(dnn_runtime_t * rt, const void *inputs[],
@@ -147,6 +297,12 @@ int dnn_runtime_forward(dnn_runtime_t * rt, const void *inputs[],
       c->variables[c->input_variable_ids[i]].data = (void *)inputs[i];
     }
 
+#ifdef CONFIG_DNN_RT_PROFILE
+  s_dnn_prof.rt = rt;
+  s_dnn_prof.num = 0;
+#endif
+
+  dnn_nnb_select(rt);
   return (int)rt_forward(ctx);
 }
 
@@ -236,6 +392,7 @@ dnn_global_context *dnn_get_global_context(void)
 
 void dnn_req_scratch_buf(int size)
 {
+  size = SCRATCH_ALIGN(size) * dnn_mp_cpu_num();
   if (size > s_dnn_gctx.req_scratch_buf_bsize)
     {
       s_dnn_gctx.req_scratch_buf_bsize = size;
@@ -246,3 +403,87 @@ void *dnn_scratch_buf(void)
 {
   return s_dnn_gctx.scratch_buf;
 }
+
+void *dnn_scratch_buf_part(int part)
+{
+  int part_bsize = ((s_dnn_gctx.scratch_buf_bsize -
+                     s_dnn_gctx.shared_buf_bsize) / dnn_mp_cpu_num()) & ~3;
+
+  return (char *)s_dnn_gctx.scratch_buf + s_dnn_gctx.shared_buf_bsize +
+    part * part_bsize;
+}
+
+void dnn_req_shared_buf(int size)
+{
+  size = SCRATCH_ALIGN(size);
+  if (size > s_dnn_gctx.req_shared_buf_bsize)
+    {
+      s_dnn_gctx.req_shared_buf_bsize = size;
+    }
+}
+
+void *dnn_shared_buf(void)
+{
+  return s_dnn_gctx.scratch_buf;
+}
+
+#ifdef CONFIG_DNN_RT_PROFILE
+uint32_t dnn_profile_begin(void)
+{
+  if ((DWT_CTRL & DWT_CTRL_CYCENA) == 0)
+    {
+      DWT_CYCCNT = 0;
+      DWT_CTRL |= DWT_CTRL_CYCENA;
+    }
+
+  return DWT_CYCCNT;
+}
+
+void dnn_profile_end(int function, uint32_t start)
+{
+  uint32_t cycles = DWT_CYCCNT - start;
+  uint32_t mhz = cxd56_get_cpu_baseclk() / 1000000;
+  int parts = dnn_mp_last_parts();
+  dnn_profile_t *prof;
+
+  if (s_dnn_prof.num >= CONFIG_DNN_RT_PROFILE_NUM)
+    {
+      return;
+    }
+
+  prof = &s_dnn_prof.prof[s_dnn_prof.num++];
+  prof->function = function;
+  prof->cpu_num = parts;
+  prof->usec = mhz ? cycles / mhz : 0;
+}
+#endif
+
+int dnn_runtime_memory_info(dnn_runtime_t * rt, dnn_memory_info_t * info)
+{
+  DNN_CHECK_NULL_RET(rt, -EINVAL);
+  DNN_CHECK_NULL_RET(info, -EINVAL);
+
+  *info = rt->mem;
+  return 0;
+}
+
+int dnn_runtime_profile(dnn_runtime_t * rt, dnn_profile_t * prof, int num)
+{
+  DNN_CHECK_NULL_RET(rt, -EINVAL);
+  DNN_CHECK_NULL_RET(prof, -EINVAL);
+#ifdef CONFIG_DNN_RT_PROFILE
+  if (s_dnn_prof.rt != rt)
+    {
+      return 0;
+    }
+  if (num > s_dnn_prof.num)
+    {
+      num = s_dnn_prof.num;
+    }
+
+  memcpy(prof, s_dnn_prof.prof, num * sizeof(dnn_profile_t));
+  return num;
+#else
+  return -ENOTSUP;
+#endif
+}
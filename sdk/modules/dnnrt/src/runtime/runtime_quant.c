@@ -0,0 +1,152 @@
+/****************************************************************************
+ * modules/dnnrt/src/runtime/runtime_quant.c
+ *
+ *   Copyright 2018 Sony Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Corporation nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <dnnrt/runtime.h>
+#include <utilities/shape.h>
+#include "runtime_common.h"
+#include "runtime_quant.h"
+
+#define X (0)                   // x input
+#define WEIGHT (1)              // weight
+#define BIAS (2)                // bias
+#define Y (0)                   // y output
+
+#define PARAM_WORDS (sizeof(dnn_quant_param_t) / sizeof(int32_t))
+
+static const dnn_quant_param_t *param_of(rt_function_t * f)
+{
+  return (const dnn_quant_param_t *)f->inputs[DNN_QUANT_PARAM]->data;
+}
+
+static int is_activation_type(nn_data_type_t type)
+{
+  return type == NN_DATA_TYPE_INT8 || type == NN_DATA_TYPE_FLOAT;
+}
+
+int dnn_quant_validate(rt_function_t * f, int channels)
+{
+  rt_variable_t *x, *w, *b, *q, *y;
+
+  if (f->num_of_inputs != DNN_QUANT_PARAM + 1 || f->num_of_outputs != 1)
+    {
+      return 0;
+    }
+
+  x = f->inputs[X];
+  w = f->inputs[WEIGHT];
+  b = f->inputs[BIAS];
+  q = f->inputs[DNN_QUANT_PARAM];
+  y = f->outputs[Y];
+
+  if (!is_activation_type(x->type) || !is_activation_type(y->type) ||
+      w->type != NN_DATA_TYPE_INT8 || b->type != NN_DATA_TYPE_FLOAT ||
+      q->type != NN_DATA_TYPE_FLOAT)
+    {
+      return 0;
+    }
+
+  if (calc_shape_size(b->shape) != channels ||
+      calc_shape_size(q->shape) != PARAM_WORDS + 2 * channels)
+    {
+      return 0;
+    }
+
+  /* float x is quantized once and read by all the parts */
+
+  if (x->type == NN_DATA_TYPE_FLOAT)
+    {
+      dnn_req_shared_buf(calc_shape_size(x->shape));
+    }
+
+  return 1;
+}
+
+const int8_t *dnn_quant_input(rt_function_t * f, dnn_mp_quant_t * q)
+{
+  const dnn_quant_param_t *p = param_of(f);
+  const int32_t *words = (const int32_t *)p + PARAM_WORDS;
+  int channels = calc_shape_size(f->inputs[BIAS]->shape);
+  rt_variable_t *x = f->inputs[X];
+  const float *in;
+  int8_t *out;
+  float inv;
+  int size;
+  int i;
+
+  q->mult = words;
+  q->shift = words + channels;
+  q->in_offset = -p->in_zero;
+  q->out_offset = p->out_zero;
+  q->act_min = p->act_min;
+  q->act_max = p->act_max;
+  q->out_scale = f->outputs[Y]->type == NN_DATA_TYPE_FLOAT ?
+    p->out_scale : 0.0f;
+
+  if (x->type != NN_DATA_TYPE_FLOAT)
+    {
+      return (const int8_t *)x->data;
+    }
+
+  in = (const float *)x->data;
+  out = (int8_t *) dnn_shared_buf();
+  size = calc_shape_size(x->shape);
+  inv = 1.0f / p->in_scale;
+
+  for (i = 0; i < size; i++)
+    {
+      float v = in[i] * inv;
+      int32_t r;
+
+      /* rounded half away from zero, v is limited not to overflow */
+
+      v = v < -256.0f ? -256.0f : (v > 256.0f ? 256.0f : v);
+      r = (int32_t)(v >= 0.0f ? v + 0.5f : v - 0.5f) + p->in_zero;
+      out[i] = (int8_t)(r < -128 ? -128 : (r > 127 ? 127 : r));
+    }
+
+  return out;
+}
+
+const int32_t *dnn_quant_bias(rt_function_t * f)
+{
+  return (const int32_t *)f->inputs[BIAS]->data;
+}
+
+int dnn_quant_out_elem_size(rt_function_t * f)
+{
+  return f->outputs[Y]->type == NN_DATA_TYPE_FLOAT ?
+    sizeof(float) : sizeof(int8_t);
+}
@@ -0,0 +1,109 @@
+/****************************************************************************
+ * modules/dnnrt/src/runtime/runtime_quant.h
+ *
+ *   Copyright 2018 Sony Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Corporation nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef RUNTIME_QUANT_H
+#  define RUNTIME_QUANT_H
+
+/* Int8 layers converted by tools/nnbquant.py.
+ *
+ * A convolution, depthwise convolution or affine of DNNRT_IMPLEMENT_QINT8
+ * has 4 inputs: x, weight, bias and quantization parameters. Weight is
+ * int8 quantized per output channel. Bias and the parameters are int32
+ * words stored in FLOAT variables of nnb, so they are read (and paged)
+ * as any other parameter. x and y are int8 with a zero point, or float
+ * at the border of int8 layers, which is converted inside the layer.
+ */
+
+#  include <nnablart/functions.h>
+#  include "runtime_mp.h"
+
+#  ifdef __cplusplus
+extern "C"
+{
+#  endif
+
+#  define DNN_QUANT_PARAM (3)   /* index of the parameters in inputs */
+
+  /* Quantization parameters, followed by int32_t mult[channels] and
+   * int32_t shift[channels] (see dnn_mp_quant_t). They begin with a
+   * marker, as a FLOAT variable of int32 words is not told by its type.
+   */
+
+#  define DNN_QUANT_MAGIC   (0x51384e44)        /* "DN8Q" */
+#  define DNN_QUANT_VERSION (1)
+
+  typedef struct dnn_quant_param
+    {
+      int32_t magic;            /* DNN_QUANT_MAGIC */
+      int32_t version;          /* DNN_QUANT_VERSION */
+      int32_t in_zero;          /* zero point of x */
+      int32_t out_zero;         /* zero point of y */
+      int32_t act_min;          /* range of y, ReLU is folded into it */
+      int32_t act_max;
+      float in_scale;           /* scale of x, used if x is float */
+      float out_scale;          /* scale of y, used if y is float */
+    } dnn_quant_param_t;
+
+#  ifdef CONFIG_DNN_RT_QUANT
+#    define DNN_IMPLEMENTED(impl) \
+  ((impl) == DNNRT_IMPLEMENT || (impl) == DNNRT_IMPLEMENT_QINT8)
+#  else
+#    define DNN_IMPLEMENTED(impl) ((impl) == DNNRT_IMPLEMENT)
+#  endif
+
+  static inline int dnn_quant_of(rt_function_t * f)
+  {
+    return f->num_of_inputs > DNN_QUANT_PARAM;
+  }
+
+  /* Check types and shapes of f with channels output channels, and
+   * request buffers to execute it. Returns 0 if f is not supported.
+   */
+
+  int dnn_quant_validate(rt_function_t * f, int channels);
+
+  /* Read the parameters of f into q for all the channels, and return x
+   * as int8. Float x is quantized into the shared scratch buffer.
+   */
+
+  const int8_t *dnn_quant_input(rt_function_t * f, dnn_mp_quant_t * q);
+
+  const int32_t *dnn_quant_bias(rt_function_t * f);
+  int dnn_quant_out_elem_size(rt_function_t * f);
+
+#  ifdef __cplusplus
+}
+#  endif
+
+#endif                          /* RUNTIME_QUANT_H */
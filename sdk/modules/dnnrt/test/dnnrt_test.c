@@ -0,0 +1,1159 @@
+/****************************************************************************
+ * modules/dnnrt/test/dnnrt_test.c
+ *
+ *   Copyright 2018 Sony Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Corporation nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/* Host test of functions executed by dnnrt.
+ *
+ * ReLU, max and average pooling, softmax and depthwise convolution are
+ * executed by their dnnrt_exec_*() for float, q15 and q7 data, and
+ * compared with straightforward float reference implementations of
+ * nnabla semantics. ReLU and pooling fused into depthwise convolution
+ * are tested by the kernel jobs, as the ASMP worker executes them.
+ * Finally cycles per output element of dnnrt and of the reference are
+ * measured.
+ *
+ *   $ make && ./dnnrt_test
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <nnablart/functions.h>
+#include <runtime_internal.h>
+#include <runtime/runtime_common.h>
+#include <runtime/runtime_mp.h>
+
+#define CHECK(cond, ...)                                                      \
+  do                                                                          \
+    {                                                                         \
+      if (!(cond))                                                            \
+        {                                                                     \
+          printf("  NG: ");                                                   \
+          printf(__VA_ARGS__);                                                \
+          printf("\n");                                                       \
+          s_fail++;                                                           \
+        }                                                                     \
+    }                                                                         \
+  while (0)
+
+#define RANDOM_CASES (200)
+#define BENCH_LOOP (20)
+
+/* Fixed point positions (value = q * 2^-fp_pos) of test data */
+
+#define X_FP_POS (4)
+#define W_FP_POS (6)
+#define B_FP_POS (5)
+#define Y_FP_POS (3)
+
+/* A variable with its own shape and data */
+
+typedef struct test_var
+{
+  rt_variable_t var;
+  int shape[4];
+  void *data;
+} test_var_t;
+
+static int s_fail;
+static uint32_t s_seed = 1;
+
+/* Scratch buffers of runtime_nnabla.c */
+
+static int s_req_scratch;
+static int s_req_shared;
+static void *s_scratch;
+static void *s_shared;
+
+void dnn_req_scratch_buf(int size)
+{
+  s_req_scratch = size > s_req_scratch ? size : s_req_scratch;
+}
+
+void *dnn_scratch_buf(void)
+{
+  return s_scratch = realloc(s_scratch, s_req_scratch + 1);
+}
+
+void *dnn_scratch_buf_part(int part)
+{
+  return dnn_scratch_buf();
+}
+
+void dnn_req_shared_buf(int size)
+{
+  s_req_shared = size > s_req_shared ? size : s_req_shared;
+}
+
+void *dnn_shared_buf(void)
+{
+  return s_shared = realloc(s_shared, s_req_shared + 1);
+}
+
+/* Used by q7 CHW convolution of CMSIS-NN, which needs ARM_MATH_DSP and is
+ * not tested on the host.
+ */
+
+void *read_and_pad(void *source, int32_t * out1, int32_t * out2)
+{
+  abort();
+}
+
+static int rand_int(int n)
+{
+  s_seed = s_seed * 1103515245 + 12345;
+  return (int)((s_seed >> 8) % n);
+}
+
+/* a value of fixed point q7 grid at X_FP_POS, so that every type
+ * represents it exactly
+ */
+
+static float rand_value(void)
+{
+  return (rand_int(255) - 127) / (float)(1 << X_FP_POS);
+}
+
+static int elem_size_of(nn_data_type_t type)
+{
+  return type == NN_DATA_TYPE_FLOAT ? sizeof(float) :
+    type == NN_DATA_TYPE_INT16 ? sizeof(int16_t) : sizeof(int8_t);
+}
+
+static const char *type_name(nn_data_type_t type)
+{
+  return type == NN_DATA_TYPE_FLOAT ? "float" :
+    type == NN_DATA_TYPE_INT16 ? "q15" : "q7";
+}
+
+static void var_init(test_var_t * v, nn_data_type_t type, int fp_pos,
+                     int ndim, const int *dims)
+{
+  int size = 1;
+  int i;
+
+  memset(v, 0, sizeof(*v));
+  for (i = 0; i < ndim; i++)
+    {
+      v->shape[i] = dims[i];
+      size *= dims[i];
+    }
+  v->data = calloc(size, elem_size_of(type));
+  v->var.type = type;
+  v->var.fp_pos = type == NN_DATA_TYPE_FLOAT ? 0 : fp_pos;
+  v->var.shape.size = ndim;
+  v->var.shape.data = v->shape;
+  v->var.data = v->data;
+}
+
+static void var_free(test_var_t * v)
+{
+  free(v->data);
+  v->data = NULL;
+}
+
+static int var_size(const test_var_t * v)
+{
+  int size = 1;
+  int i;
+
+  for (i = 0; i < v->var.shape.size; i++)
+    {
+      size *= v->shape[i];
+    }
+  return size;
+}
+
+static float var_lsb(const test_var_t * v)
+{
+  return v->var.type == NN_DATA_TYPE_FLOAT ? 0.0f :
+    ldexpf(1.0f, -(int)v->var.fp_pos);
+}
+
+static float var_get(const test_var_t * v, int i)
+{
+  if (v->var.type == NN_DATA_TYPE_FLOAT)
+    {
+      return ((const float *)v->data)[i];
+    }
+  else if (v->var.type == NN_DATA_TYPE_INT16)
+    {
+      return ((const int16_t *)v->data)[i] * var_lsb(v);
+    }
+  return ((const int8_t *)v->data)[i] * var_lsb(v);
+}
+
+/* float of the range of the type, saturated as CMSIS-NN does */
+
+static float saturate(const test_var_t * v, float f)
+{
+  float max;
+
+  if (v->var.type == NN_DATA_TYPE_FLOAT)
+    {
+      return f;
+    }
+  max = (v->var.type == NN_DATA_TYPE_INT16 ? 32767 : 127) * var_lsb(v);
+  return f > max ? max : f < -max - var_lsb(v) ? -max - var_lsb(v) : f;
+}
+
+/* Quantized with rounding half up, as the fixed point kernels do */
+
+static void var_set(test_var_t * v, int i, float f)
+{
+  if (v->var.type == NN_DATA_TYPE_FLOAT)
+    {
+      ((float *)v->data)[i] = f;
+    }
+  else if (v->var.type == NN_DATA_TYPE_INT16)
+    {
+      ((int16_t *) v->data)[i] = (int16_t)floorf(saturate(v, f) /
+                                                   var_lsb(v) + 0.5f);
+    }
+  else
+    {
+      ((int8_t *) v->data)[i] = (int8_t)floorf(saturate(v, f) / var_lsb(v) +
+                                               0.5f);
+    }
+}
+
+static void var_rand(test_var_t * v)
+{
+  int size = var_size(v);
+  int i;
+
+  for (i = 0; i < size; i++)
+    {
+      var_set(v, i, rand_value());
+    }
+}
+
+static void func_init(rt_function_t * f, rt_variable_t ** inputs,
+                      int num_of_inputs, rt_variable_t ** outputs,
+                      void *local_context)
+{
+  memset(f, 0, sizeof(*f));
+  f->num_of_inputs = num_of_inputs;
+  f->inputs = inputs;
+  f->num_of_outputs = 1;
+  f->outputs = outputs;
+  f->local_context = local_context;
+}
+
+/* Compare y with reference. Fixed point output may differ by rounding
+ * (0.5 LSB) from the float reference.
+ */
+
+static int compare(const char *name, const test_var_t * y, const float *ref,
+                   float tolerance)
+{
+  int size = var_size(y);
+  float err = 0.0f;
+  int bad = 0;
+  int i;
+
+  tolerance += var_lsb(y) * 0.5f + 1e-5f;
+  for (i = 0; i < size; i++)
+    {
+      float d;
+
+      if (isinf(ref[i]))
+        {
+          continue;
+        }
+      d = fabsf(var_get(y, i) - saturate(y, ref[i]));
+      err = d > err ? d : err;
+      if (d > tolerance && bad++ < 3)
+        {
+          printf("  %s[%d] %f, expected %f\n", name, i, var_get(y, i),
+                 ref[i]);
+        }
+    }
+  CHECK(bad == 0, "%s: %d mismatch (max error %g)", name, bad, err);
+  return bad;
+}
+
+/****************************************************************************
+ * Reference implementations
+ ****************************************************************************/
+
+/* Window of nnabla pooling. Output out of the input by
+ * ignore_border == false has a partial window.
+ */
+
+static void ref_pool(const test_var_t * x, float *out, int planes,
+                     int in_h, int in_w, int out_h, int out_w,
+                     const int *ker, const int *stride, const int *pad,
+                     int op, int including_pad)
+{
+  int c, oy, ox, y, x0;
+
+  for (c = 0; c < planes; c++)
+    {
+      for (oy = 0; oy < out_h; oy++)
+        {
+          for (ox = 0; ox < out_w; ox++)
+            {
+              int hs = oy * stride[0] - pad[0];
+              int ws = ox * stride[1] - pad[1];
+              int he = hs + ker[0];
+              int we = ws + ker[1];
+              float max = -INFINITY;
+              float sum = 0.0f;
+              int num;
+
+              he = he > in_h + pad[0] ? in_h + pad[0] : he;
+              we = we > in_w + pad[1] ? in_w + pad[1] : we;
+              num = (he - hs) * (we - ws);
+              hs = hs < 0 ? 0 : hs;
+              ws = ws < 0 ? 0 : ws;
+              he = he > in_h ? in_h : he;
+              we = we > in_w ? in_w : we;
+              if (!including_pad)
+                {
+                  num = (he - hs) * (we - ws);
+                }
+
+              for (y = hs; y < he; y++)
+                {
+                  for (x0 = ws; x0 < we; x0++)
+                    {
+                      float v = var_get(x, (c * in_h + y) * in_w + x0);
+                      max = v > max ? v : max;
+                      sum += v;
+                    }
+                }
+
+              *out++ = op == DNN_MP_POOL_MAX ? max :
+                num > 0 ? sum / num : 0.0f;
+            }
+        }
+    }
+}
+
+static void ref_dwconv(const test_var_t * x, const test_var_t * w,
+                       const test_var_t * b, float *out, int batch,
+                       int ch, int in_h, int in_w, int out_h, int out_w,
+                       int ker_h, int ker_w, const int *stride,
+                       const int *pad, int relu)
+{
+  int n, c, oy, ox, ky, kx;
+
+  for (n = 0; n < batch; n++)
+    {
+      for (c = 0; c < ch; c++)
+        {
+          for (oy = 0; oy < out_h; oy++)
+            {
+              for (ox = 0; ox < out_w; ox++)
+                {
+                  float sum = b ? var_get(b, c) : 0.0f;
+
+                  for (ky = 0; ky < ker_h; ky++)
+                    {
+                      for (kx = 0; kx < ker_w; kx++)
+                        {
+                          int y = oy * stride[0] - pad[0] + ky;
+                          int x0 = ox * stride[1] - pad[1] + kx;
+
+                          if (y < 0 || y >= in_h || x0 < 0 || x0 >= in_w)
+                            {
+                              continue;
+                            }
+                          sum += var_get(x, ((n * ch + c) * in_h + y) *
+                                         in_w + x0) *
+                            var_get(w, (c * ker_h + ky) * ker_w + kx);
+                        }
+                    }
+                  *out++ = relu && sum < 0.0f ? 0.0f : sum;
+                }
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * Tests
+ ****************************************************************************/
+
+static const nn_data_type_t s_types[] =
+{
+  NN_DATA_TYPE_FLOAT, NN_DATA_TYPE_INT16, NN_DATA_TYPE_INT8
+};
+
+#define TYPE_NUM (sizeof(s_types) / sizeof(s_types[0]))
+
+static void test_relu(void)
+{
+  /* larger than the chunk of arm_relu_q7/q15() */
+
+  static const int sizes[] = { 1, 17, 0x8000 * 2 + 3 };
+  unsigned int t, s;
+  int inplace, i;
+
+  printf("relu\n");
+
+  for (t = 0; t < TYPE_NUM; t++)
+    {
+      for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+        {
+          for (inplace = 0; inplace < 2; inplace++)
+            {
+              test_var_t x, y;
+              rt_variable_t *in[1], *out[1];
+              relu_local_context_t c;
+              rt_function_t f;
+              float *ref;
+              char name[64];
+
+              var_init(&x, s_types[t], X_FP_POS, 1, &sizes[s]);
+              var_init(&y, s_types[t], X_FP_POS, 1, &sizes[s]);
+              var_rand(&x);
+              ref = malloc(sizes[s] * sizeof(float));
+              for (i = 0; i < sizes[s]; i++)
+                {
+                  float v = var_get(&x, i);
+                  ref[i] = v > 0.0f ? v : 0.0f;
+                }
+
+              if (inplace)
+                {
+                  y.var.data = x.data;
+                }
+              in[0] = &x.var;
+              out[0] = &y.var;
+              memset(&c, 0, sizeof(c));
+              c.inplace = inplace;
+              func_init(&f, in, 1, out, &c);
+
+              CHECK(dnnrt_exec_relu(&f) == RT_FUNCTION_ERROR_NOERROR,
+                    "relu failed");
+              if (inplace)
+                {
+                  memcpy(y.data, x.data, sizes[s] * elem_size_of(x.var.type));
+                }
+              snprintf(name, sizeof(name), "%s size %d%s",
+                       type_name(s_types[t]), sizes[s],
+                       inplace ? " inplace" : "");
+              compare(name, &y, ref, 0.0f);
+
+              free(ref);
+              var_free(&x);
+              var_free(&y);
+            }
+        }
+    }
+}
+
+static void test_softmax(void)
+{
+  static const int dims[] = { 3, 5, 7 };
+
+  /* input and output types, and fixed point position of output */
+
+  static const struct
+  {
+    nn_data_type_t in;
+    nn_data_type_t out;
+    int out_fp_pos;
+  } cases[] =
+  {
+    { NN_DATA_TYPE_FLOAT, NN_DATA_TYPE_FLOAT, 0 },
+    { NN_DATA_TYPE_INT16, NN_DATA_TYPE_INT16, 15 },
+    { NN_DATA_TYPE_INT8, NN_DATA_TYPE_INT8, 7 },
+    { NN_DATA_TYPE_FLOAT, NN_DATA_TYPE_INT8, 7 },
+    { NN_DATA_TYPE_INT8, NN_DATA_TYPE_FLOAT, 0 },
+  };
+  unsigned int t;
+  int axis;
+
+  printf("softmax\n");
+
+  for (t = 0; t < sizeof(cases) / sizeof(cases[0]); t++)
+    {
+      for (axis = 0; axis < 3; axis++)
+        {
+          test_var_t x, y;
+          rt_variable_t *in[1], *out[1];
+          softmax_local_context_t c;
+          rt_function_t f;
+          float ref[3 * 5 * 7];
+          int inner = 1;
+          int i, j, k;
+          char name[64];
+
+          var_init(&x, cases[t].in, X_FP_POS, 3, dims);
+          var_init(&y, cases[t].out, cases[t].out_fp_pos, 3, dims);
+          var_rand(&x);
+
+          for (i = axis + 1; i < 3; i++)
+            {
+              inner *= dims[i];
+            }
+
+          /* straightforward sum of exp() for each element */
+
+          for (i = 0; i < var_size(&x); i++)
+            {
+              int pos = i % inner + (i / inner / dims[axis]) * dims[axis] *
+                inner;
+              double sum = 0.0;
+
+              for (j = 0; j < dims[axis]; j++)
+                {
+                  sum += exp(var_get(&x, pos + j * inner) - var_get(&x, i));
+                }
+              ref[i] = (float)(1.0 / sum);
+            }
+
+          in[0] = &x.var;
+          out[0] = &y.var;
+          memset(&c, 0, sizeof(c));
+          c.axis = axis;
+          func_init(&f, in, 1, out, &c);
+
+          CHECK(dnnrt_exec_softmax(&f) == RT_FUNCTION_ERROR_NOERROR,
+                "softmax failed");
+          snprintf(name, sizeof(name), "%s to %s axis %d",
+                   type_name(cases[t].in), type_name(cases[t].out), axis);
+          compare(name, &y, ref, 1e-5f);
+
+          /* each row sums to 1 */
+
+          for (k = 0; cases[t].out == NN_DATA_TYPE_FLOAT &&
+               k < var_size(&y); k += dims[axis] * inner)
+            {
+              for (i = 0; i < inner; i++)
+                {
+                  float sum = 0.0f;
+
+                  for (j = 0; j < dims[axis]; j++)
+                    {
+                      sum += var_get(&y, k + i + j * inner);
+                    }
+                  CHECK(fabsf(sum - 1.0f) < 1e-5f, "%s: sum %f", name, sum);
+                }
+            }
+
+          var_free(&x);
+          var_free(&y);
+        }
+    }
+}
+
+static void test_pooling(void)
+{
+  int n, t;
+
+  printf("pooling\n");
+
+  for (n = 0; n < RANDOM_CASES; n++)
+    {
+      int ker[2], stride[2], pad[2];
+      int in_h = 1 + rand_int(9);
+      int in_w = 1 + rand_int(9);
+      int ch = 1 + rand_int(4);
+      int op = rand_int(2) ? DNN_MP_POOL_MAX : DNN_MP_POOL_AVG;
+      int ignore_border = rand_int(2);
+      int including_pad = rand_int(2);
+      int i;
+
+      for (i = 0; i < 2; i++)
+        {
+          ker[i] = 1 + rand_int(3);
+          stride[i] = 1 + rand_int(3);
+          pad[i] = rand_int(ker[i]);
+        }
+      if (ker[0] > in_h + 2 * pad[0] || ker[1] > in_w + 2 * pad[1])
+        {
+          continue;
+        }
+
+      for (t = 0; t < (int)TYPE_NUM; t++)
+        {
+          int out_h, out_w;
+          int xdims[4], ydims[4];
+          test_var_t x, y;
+          rt_variable_t *in[1], *out[1];
+          max_pooling_local_context_t mc;
+          average_pooling_local_context_t ac;
+          rt_function_t f;
+          float *ref;
+          char name[96];
+
+          if (ignore_border)
+            {
+              out_h = (in_h + 2 * pad[0] - ker[0]) / stride[0] + 1;
+              out_w = (in_w + 2 * pad[1] - ker[1]) / stride[1] + 1;
+            }
+          else
+            {
+              out_h = (in_h + 2 * pad[0] - ker[0] + stride[0] - 1) /
+                stride[0] + 1;
+              out_w = (in_w + 2 * pad[1] - ker[1] + stride[1] - 1) /
+                stride[1] + 1;
+            }
+
+          /* batch of 2 and ch planes */
+
+          xdims[0] = ydims[0] = 2;
+          xdims[1] = ydims[1] = ch;
+          xdims[2] = in_h;
+          xdims[3] = in_w;
+          ydims[2] = out_h;
+          ydims[3] = out_w;
+          var_init(&x, s_types[t], X_FP_POS, 4, xdims);
+          var_init(&y, s_types[t], X_FP_POS, 4, ydims);
+          var_rand(&x);
+
+          ref = malloc(var_size(&y) * sizeof(float));
+          ref_pool(&x, ref, 2 * ch, in_h, in_w, out_h, out_w, ker, stride,
+                   pad, op, including_pad);
+
+          in[0] = &x.var;
+          out[0] = &y.var;
+          memset(&mc, 0, sizeof(mc));
+          memset(&ac, 0, sizeof(ac));
+          if (op == DNN_MP_POOL_MAX)
+            {
+              mc.kernel.size = mc.stride.size = mc.pad.size = 2;
+              mc.kernel.data = ker;
+              mc.stride.data = stride;
+              mc.pad.data = pad;
+              mc.ignore_border = ignore_border;
+              func_init(&f, in, 1, out, &mc);
+              CHECK(dnnrt_exec_max_pooling(&f) == RT_FUNCTION_ERROR_NOERROR,
+                    "max pooling failed");
+            }
+          else
+            {
+              ac.kernel.size = ac.stride.size = ac.pad.size = 2;
+              ac.kernel.data = ker;
+              ac.stride.data = stride;
+              ac.pad.data = pad;
+              ac.ignore_border = ignore_border;
+              ac.including_pad = including_pad;
+              func_init(&f, in, 1, out, &ac);
+              CHECK(dnnrt_exec_average_pooling(&f) ==
+                    RT_FUNCTION_ERROR_NOERROR, "average pooling failed");
+            }
+
+          snprintf(name, sizeof(name),
+                   "%s %s in %dx%d ker %dx%d stride %dx%d pad %dx%d%s%s",
+                   op == DNN_MP_POOL_MAX ? "max" : "avg",
+                   type_name(s_types[t]), in_h, in_w, ker[0], ker[1],
+                   stride[0], stride[1], pad[0], pad[1],
+                   ignore_border ? "" : " !ignore_border",
+                   including_pad ? " including_pad" : "");
+          compare(name, &y, ref, 0.0f);
+
+          free(ref);
+          var_free(&x);
+          var_free(&y);
+        }
+    }
+
+  printf("  %d random cases\n", RANDOM_CASES);
+}
+
+static void test_depthwise_convolution(void)
+{
+  int n, t;
+
+  printf("depthwise_convolution\n");
+
+  for (n = 0; n < RANDOM_CASES; n++)
+    {
+      int stride[2], pad[2], dilation[2] = { 1, 1 };
+      int in_h = 1 + rand_int(9);
+      int in_w = 1 + rand_int(9);
+      int ch = 1 + rand_int(5);
+      int ker_h = 1 + rand_int(3);
+      int ker_w = 1 + rand_int(3);
+      int has_bias = rand_int(4) != 0;
+      int out_h, out_w;
+      int i;
+
+      for (i = 0; i < 2; i++)
+        {
+          stride[i] = 1 + rand_int(2);
+          pad[i] = rand_int(2);
+        }
+      if (ker_h > in_h + 2 * pad[0] || ker_w > in_w + 2 * pad[1])
+        {
+          continue;
+        }
+      out_h = (in_h + 2 * pad[0] - ker_h) / stride[0] + 1;
+      out_w = (in_w + 2 * pad[1] - ker_w) / stride[1] + 1;
+
+      for (t = 0; t < (int)TYPE_NUM; t++)
+        {
+          int xdims[4] = { 2, ch, in_h, in_w };
+          int ydims[4] = { 2, ch, out_h, out_w };
+          int wdims[3] = { ch, ker_h, ker_w };
+          test_var_t x, w, b, y;
+          rt_variable_t *in[3], *out[1];
+          depthwise_convolution_local_context_t c;
+          rt_function_t f;
+          float *ref;
+          char name[96];
+
+          var_init(&x, s_types[t], X_FP_POS, 4, xdims);
+          var_init(&w, s_types[t], W_FP_POS, 3, wdims);
+          var_init(&b, s_types[t], B_FP_POS, 1, &ch);
+          var_init(&y, s_types[t], Y_FP_POS, 4, ydims);
+          var_rand(&x);
+          for (i = 0; i < var_size(&w); i++)
+            {
+              var_set(&w, i, (rand_int(127) - 63) / (float)(1 << W_FP_POS));
+            }
+          for (i = 0; i < ch; i++)
+            {
+              var_set(&b, i, (rand_int(127) - 63) / (float)(1 << B_FP_POS));
+            }
+
+          ref = malloc(var_size(&y) * sizeof(float));
+          ref_dwconv(&x, &w, has_bias ? &b : NULL, ref, 2, ch, in_h, in_w,
+                     out_h, out_w, ker_h, ker_w, stride, pad, 0);
+
+          in[0] = &x.var;
+          in[1] = &w.var;
+          in[2] = &b.var;
+          out[0] = &y.var;
+          memset(&c, 0, sizeof(c));
+          c.base_axis = 1;
+          c.pad.size = c.stride.size = c.dilation.size = 2;
+          c.pad.data = pad;
+          c.stride.data = stride;
+          c.dilation.data = dilation;
+          c.multiplier = 1;
+          func_init(&f, in, has_bias ? 3 : 2, out, &c);
+
+          CHECK(dnnrt_exec_depthwise_convolution(&f) ==
+                RT_FUNCTION_ERROR_NOERROR, "depthwise convolution failed");
+          snprintf(name, sizeof(name),
+                   "%s ch %d in %dx%d ker %dx%d stride %dx%d pad %dx%d%s",
+                   type_name(s_types[t]), ch, in_h, in_w, ker_h, ker_w,
+                   stride[0], stride[1], pad[0], pad[1],
+                   has_bias ? "" : " no bias");
+          compare(name, &y, ref, 0.0f);
+
+          free(ref);
+          var_free(&x);
+          var_free(&w);
+          var_free(&b);
+          var_free(&y);
+        }
+    }
+
+  printf("  %d random cases\n", RANDOM_CASES);
+}
+
+/* Depthwise convolution with ReLU and pooling fused, as a job of
+ * mp_kernel.c split by channels.
+ */
+
+static void test_fused(void)
+{
+  static const dnn_mp_kernel_t kernels[] =
+  {
+    DNN_MP_DWCONV_F32, DNN_MP_DWCONV_Q15, DNN_MP_DWCONV_Q7
+  };
+  int n, t;
+
+  printf("fused depthwise_convolution + relu + pooling\n");
+
+  for (n = 0; n < RANDOM_CASES / 4; n++)
+    {
+      int stride[2] = { 1, 1 };
+      int pad[2] = { 1, 1 };
+      int pker[2] = { 2, 2 };
+      int pstride[2] = { 2, 2 };
+      int ppad[2] = { 0, 0 };
+      int in_h = 2 + rand_int(10);
+      int in_w = 2 + rand_int(10);
+      int ch = 1 + rand_int(6);
+      int op = rand_int(2) ? DNN_MP_POOL_MAX : DNN_MP_POOL_AVG;
+      int out_h = in_h;
+      int out_w = in_w;
+      int pool_h = (out_h - 2) / 2 + 1;
+      int pool_w = (out_w - 2) / 2 + 1;
+
+      for (t = 0; t < (int)TYPE_NUM; t++)
+        {
+          int xdims[4] = { 1, ch, in_h, in_w };
+          int cdims[4] = { 1, ch, out_h, out_w };
+          int pdims[4] = { 1, ch, pool_h, pool_w };
+          int wdims[3] = { ch, 3, 3 };
+          test_var_t x, w, b, conv, pool, relu;
+          dnn_mp_job_t jobs[2];
+          float *ref_conv, *ref;
+          int elem_size = elem_size_of(s_types[t]);
+          char name[64];
+          int i;
+
+          var_init(&x, s_types[t], X_FP_POS, 4, xdims);
+          var_init(&w, s_types[t], W_FP_POS, 3, wdims);
+          var_init(&b, s_types[t], B_FP_POS, 1, &ch);
+          var_init(&conv, s_types[t], Y_FP_POS, 4, cdims);
+          var_init(&pool, s_types[t], Y_FP_POS, 4, pdims);
+          var_init(&relu, s_types[t], Y_FP_POS, 4, cdims);
+          var_rand(&x);
+          var_rand(&w);
+          var_rand(&b);
+
+          /* reference is pooled from the quantized output of ReLU */
+
+          ref_conv = malloc(var_size(&conv) * sizeof(float));
+          ref = malloc(var_size(&pool) * sizeof(float));
+          ref_dwconv(&x, &w, &b, ref_conv, 1, ch, in_h, in_w, out_h, out_w,
+                     3, 3, stride, pad, 1);
+          for (i = 0; i < var_size(&relu); i++)
+            {
+              var_set(&relu, i, ref_conv[i]);
+            }
+          ref_pool(&relu, ref, ch, out_h, out_w, pool_h, pool_w, pker,
+                   pstride, ppad, op, 0);
+
+          /* two parts of channels as on two CPUs */
+
+          for (i = 0; i < 2; i++)
+            {
+              int ch0 = ch * i / 2;
+              int ch1 = ch * (i + 1) / 2;
+              dnn_mp_conv_t *a = &jobs[i].u.conv;
+              dnn_mp_pool_t *p = &jobs[i].post_pool;
+
+              memset(&jobs[i], 0, sizeof(jobs[i]));
+              jobs[i].kernel = kernels[t];
+              a->in = (uint8_t *) x.data + ch0 * in_h * in_w * elem_size;
+              a->wt = (uint8_t *) w.data + ch0 * 9 * elem_size;
+              a->bias = (uint8_t *) b.data + ch0 * elem_size;
+              a->out = (uint8_t *) conv.data + ch0 * out_h * out_w *
+                elem_size;
+              a->in_w = in_w;
+              a->in_h = in_h;
+              a->in_ch = a->out_ch = ch1 - ch0;
+              a->out_w = out_w;
+              a->out_h = out_h;
+              a->ker_w = a->ker_h = 3;
+              a->pad_w = a->pad_h = 1;
+              a->stride_w = a->stride_h = 1;
+              if (s_types[t] != NN_DATA_TYPE_FLOAT)
+                {
+                  a->out_shift = X_FP_POS + W_FP_POS - Y_FP_POS;
+                  a->bias_shift = X_FP_POS + W_FP_POS - B_FP_POS;
+                }
+
+              jobs[i].post_relu = 1;
+              p->op = op;
+              p->out = (uint8_t *) pool.data + ch0 * pool_h * pool_w *
+                elem_size;
+              p->ch = ch1 - ch0;
+              p->in_w = out_w;
+              p->in_h = out_h;
+              p->out_w = pool_w;
+              p->out_h = pool_h;
+              p->ker_w = p->ker_h = 2;
+              p->stride_w = p->stride_h = 2;
+
+              if (ch1 > ch0)
+                {
+                  CHECK(dnn_mp_exec_job(&jobs[i]) == 0, "job failed");
+                }
+            }
+
+          snprintf(name, sizeof(name), "%s %s ch %d in %dx%d",
+                   op == DNN_MP_POOL_MAX ? "max" : "avg",
+                   type_name(s_types[t]), ch, in_h, in_w);
+          compare(name, &pool, ref, 0.0f);
+
+          free(ref_conv);
+          free(ref);
+          var_free(&x);
+          var_free(&w);
+          var_free(&b);
+          var_free(&conv);
+          var_free(&pool);
+          var_free(&relu);
+        }
+    }
+
+  printf("  %d random cases\n", RANDOM_CASES / 4);
+}
+
+/****************************************************************************
+ * Benchmark
+ ****************************************************************************/
+
+static uint64_t read_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+  uint32_t lo, hi;
+
+  __asm__ volatile ("rdtsc":"=a" (lo), "=d"(hi));
+  return ((uint64_t) hi << 32) | lo;
+#else
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#endif
+}
+
+/* cycles per output element of dnnrt and of the reference, the best of
+ * BENCH_LOOP runs
+ */
+
+static void bench_report(const char *name, rt_function_t * f,
+                         rt_function_error_t (*exec) (rt_function_t *),
+                         void (*ref) (rt_function_t *, float *), int outputs)
+{
+  float *out = malloc(outputs * sizeof(float));
+  uint64_t best_rt = UINT64_MAX;
+  uint64_t best_ref = UINT64_MAX;
+  int i;
+
+  for (i = 0; i < BENCH_LOOP; i++)
+    {
+      uint64_t start = read_cycles();
+      exec(f);
+      uint64_t mid = read_cycles();
+      ref(f, out);
+      uint64_t end = read_cycles();
+
+      best_rt = mid - start < best_rt ? mid - start : best_rt;
+      best_ref = end - mid < best_ref ? end - mid : best_ref;
+    }
+
+  printf("  %-40s %7.2f %7.2f\n", name, (double)best_rt / outputs,
+         (double)best_ref / outputs);
+  free(out);
+}
+
+static test_var_t s_bx, s_bw, s_bb, s_by;
+static int s_bker[2], s_bstride[2], s_bpad[2];
+
+static void bench_ref_relu(rt_function_t * f, float *out)
+{
+  int i;
+
+  for (i = 0; i < var_size(&s_bx); i++)
+    {
+      float v = var_get(&s_bx, i);
+      out[i] = v > 0.0f ? v : 0.0f;
+    }
+}
+
+static void bench_ref_max_pooling(rt_function_t * f, float *out)
+{
+  ref_pool(&s_bx, out, s_bx.shape[0] * s_bx.shape[1], s_bx.shape[2],
+           s_bx.shape[3], s_by.shape[2], s_by.shape[3], s_bker, s_bstride,
+           s_bpad, DNN_MP_POOL_MAX, 0);
+}
+
+static void bench_ref_average_pooling(rt_function_t * f, float *out)
+{
+  ref_pool(&s_bx, out, s_bx.shape[0] * s_bx.shape[1], s_bx.shape[2],
+           s_bx.shape[3], s_by.shape[2], s_by.shape[3], s_bker, s_bstride,
+           s_bpad, DNN_MP_POOL_AVG, 0);
+}
+
+static void bench_ref_softmax(rt_function_t * f, float *out)
+{
+  int size = s_bx.shape[1];
+  int i, j;
+
+  for (i = 0; i < var_size(&s_bx); i += size)
+    {
+      float max = var_get(&s_bx, i);
+      float sum = 0.0f;
+
+      for (j = 1; j < size; j++)
+        {
+          float v = var_get(&s_bx, i + j);
+          max = v > max ? v : max;
+        }
+      for (j = 0; j < size; j++)
+        {
+          sum += out[i + j] = expf(var_get(&s_bx, i + j) - max);
+        }
+      for (j = 0; j < size; j++)
+        {
+          out[i + j] /= sum;
+        }
+    }
+}
+
+static void bench_ref_dwconv(rt_function_t * f, float *out)
+{
+  ref_dwconv(&s_bx, &s_bw, &s_bb, out, 1, s_bx.shape[1], s_bx.shape[2],
+             s_bx.shape[3], s_by.shape[2], s_by.shape[3], s_bw.shape[1],
+             s_bw.shape[2], s_bstride, s_bpad, 0);
+}
+
+static void bench(void)
+{
+  int t;
+
+#if defined(__x86_64__) || defined(__i386__)
+  printf("benchmark (TSC cycles per output, dnnrt / reference)\n");
+#else
+  printf("benchmark (ns per output, dnnrt / reference)\n");
+#endif
+
+  for (t = 0; t < (int)TYPE_NUM; t++)
+    {
+      int xdims[4] = { 1, 32, 32, 32 };
+      int pdims[4] = { 1, 32, 16, 16 };
+      int sdims[2] = { 64, 10 };
+      int wdims[3] = { 32, 3, 3 };
+      int ch = 32;
+      rt_variable_t *in[3], *out[1];
+      relu_local_context_t rc;
+      max_pooling_local_context_t mc;
+      average_pooling_local_context_t ac;
+      softmax_local_context_t sc;
+      depthwise_convolution_local_context_t dc;
+      int dilation[2] = { 1, 1 };
+      rt_function_t f;
+      char name[64];
+
+      /* ReLU of 32x32x32 */
+
+      var_init(&s_bx, s_types[t], X_FP_POS, 4, xdims);
+      var_init(&s_by, s_types[t], X_FP_POS, 4, xdims);
+      var_rand(&s_bx);
+      in[0] = &s_bx.var;
+      out[0] = &s_by.var;
+      memset(&rc, 0, sizeof(rc));
+      func_init(&f, in, 1, out, &rc);
+      snprintf(name, sizeof(name), "relu %s 32x32x32", type_name(s_types[t]));
+      bench_report(name, &f, dnnrt_exec_relu, bench_ref_relu,
+                   var_size(&s_by));
+      var_free(&s_by);
+
+      /* 2x2 pooling of 32x32x32 */
+
+      var_init(&s_by, s_types[t], X_FP_POS, 4, pdims);
+      out[0] = &s_by.var;
+      s_bker[0] = s_bker[1] = s_bstride[0] = s_bstride[1] = 2;
+      s_bpad[0] = s_bpad[1] = 0;
+      memset(&mc, 0, sizeof(mc));
+      mc.kernel.size = mc.stride.size = mc.pad.size = 2;
+      mc.kernel.data = s_bker;
+      mc.stride.data = s_bstride;
+      mc.pad.data = s_bpad;
+      mc.ignore_border = 1;
+      func_init(&f, in, 1, out, &mc);
+      snprintf(name, sizeof(name), "max_pooling %s 2x2", type_name(s_types[t]));
+      bench_report(name, &f, dnnrt_exec_max_pooling, bench_ref_max_pooling,
+                   var_size(&s_by));
+
+      memset(&ac, 0, sizeof(ac));
+      ac.kernel = mc.kernel;
+      ac.stride = mc.stride;
+      ac.pad = mc.pad;
+      ac.ignore_border = 1;
+      func_init(&f, in, 1, out, &ac);
+      snprintf(name, sizeof(name), "average_pooling %s 2x2",
+               type_name(s_types[t]));
+      bench_report(name, &f, dnnrt_exec_average_pooling,
+                   bench_ref_average_pooling, var_size(&s_by));
+      var_free(&s_by);
+
+      /* 3x3 depthwise convolution of 32x32x32 */
+
+      var_init(&s_bw, s_types[t], W_FP_POS, 3, wdims);
+      var_init(&s_bb, s_types[t], B_FP_POS, 1, &ch);
+      var_init(&s_by, s_types[t], Y_FP_POS, 4, xdims);
+      var_rand(&s_bw);
+      var_rand(&s_bb);
+      s_bstride[0] = s_bstride[1] = 1;
+      s_bpad[0] = s_bpad[1] = 1;
+      in[1] = &s_bw.var;
+      in[2] = &s_bb.var;
+      out[0] = &s_by.var;
+      memset(&dc, 0, sizeof(dc));
+      dc.base_axis = 1;
+      dc.pad.size = dc.stride.size = dc.dilation.size = 2;
+      dc.pad.data = s_bpad;
+      dc.stride.data = s_bstride;
+      dc.dilation.data = dilation;
+      dc.multiplier = 1;
+      func_init(&f, in, 3, out, &dc);
+      snprintf(name, sizeof(name), "depthwise_convolution %s 3x3",
+               type_name(s_types[t]));
+      bench_report(name, &f, dnnrt_exec_depthwise_convolution,
+                   bench_ref_dwconv, var_size(&s_by));
+      var_free(&s_bw);
+      var_free(&s_bb);
+      var_free(&s_by);
+      var_free(&s_bx);
+
+      /* softmax of 64 rows of 10 */
+
+      var_init(&s_bx, s_types[t], X_FP_POS, 2, sdims);
+      var_init(&s_by, s_types[t], t == 0 ? 0 : t == 1 ? 15 : 7, 2, sdims);
+      var_rand(&s_bx);
+      in[0] = &s_bx.var;
+      out[0] = &s_by.var;
+      memset(&sc, 0, sizeof(sc));
+      sc.axis = 1;
+      func_init(&f, in, 1, out, &sc);
+      snprintf(name, sizeof(name), "softmax %s 64x10", type_name(s_types[t]));
+      bench_report(name, &f, dnnrt_exec_softmax, bench_ref_softmax,
+                   var_size(&s_by));
+      var_free(&s_bx);
+      var_free(&s_by);
+    }
+}
+
+int main(void)
+{
+  test_relu();
+  test_softmax();
+  test_pooling();
+  test_depthwise_convolution();
+  test_fused();
+
+  bench();
+
+  printf("%s (%d failure)\n", s_fail == 0 ? "PASS" : "FAIL", s_fail);
+
+  free(s_scratch);
+  free(s_shared);
+  return s_fail == 0 ? 0 : 1;
+}
@@ -1,5 +1,5 @@
 /****************************************************************************
- * dnnrt_lenet/loader_nnb.h
+ * modules/dnnrt/test/include/dnnrt/nnablart/network.h
  *
  *   Copyright 2018 Sony Corporation
  *
@@ -32,21 +32,8 @@
  *
  ****************************************************************************/
 
-#ifndef _LOADER_NNB_H_
-#  define _LOADER_NNB_H_
+/* Installed by "make context" of dnnrt in SDK build. The test uses the
+ * header of nnabla-c-runtime directly.
+ */
 
-#  include <dnnrt/runtime.h>
-
-#  ifdef __cplusplus
-extern "C"
-{
-#  endif
-
-  nn_network_t *alloc_nnb_network(const char *nnb_path);
-  void destroy_nnb_network(nn_network_t * network);
-
-#  ifdef __cplusplus
-}
-#  endif
-
-#endif                          /* _LOADER_NNB_H_ */
+#include <nnablart/network.h>
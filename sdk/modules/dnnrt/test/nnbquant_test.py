@@ -0,0 +1,482 @@
+#!/usr/bin/env python
+############################################################################
+# modules/dnnrt/test/nnbquant_test.py
+#
+#   Copyright 2018 Sony Semiconductor Solutions Corporation
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#
+# 1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in
+#    the documentation and/or other materials provided with the
+#    distribution.
+# 3. Neither the name of Sony Semiconductor Solutions Corporation nor
+#    the names of its contributors may be used to endorse or promote
+#    products derived from this software without specific prior written
+#    permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+# FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+# COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+# INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+# BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+# OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+# AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+# ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+############################################################################
+
+# Round trip test of tools/nnbquant.py (not a part of SDK build).
+#
+#   $ python3 nnbquant_test.py
+#
+# Float nnb files of LeNet-5 and of a small depthwise CNN are generated
+# with random weights, and quantized by nnbquant.py. LeNet-5 is fed with
+# the digits of examples/dnnrt_lenet, shifted and with noise. The nnb
+# written by the tool is read back and checked: layout, types and the
+# marker of the quantization parameters which dnnrt checks. Then it is
+# executed from its own contents as dnnrt does, which must reproduce the
+# accuracy reported by the tool, and the accuracy must be in bounds.
+# Requires numpy.
+
+from __future__ import print_function
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+import numpy as np
+
+TEST_DIR = os.path.dirname(os.path.abspath(__file__))
+SDK_DIR = os.path.join(TEST_DIR, '..', '..', '..')
+TOOL = os.path.join(SDK_DIR, 'tools', 'nnbquant.py')
+DIGITS = os.path.join(SDK_DIR, '..', 'examples', 'dnnrt_lenet', 'lenet-5',
+                      'data')
+
+sys.path.insert(0, os.path.dirname(TOOL))
+import nnbquant as nq
+
+# accuracy of the int8 model against the float model
+
+MIN_SQNR = 25.0                 # dB
+MIN_TOP1 = 0.95
+
+s_fail = 0
+
+def check(cond, msg):
+    global s_fail
+    if not cond:
+        print('  NG: ' + msg)
+        s_fail += 1
+
+############################################################################
+# float nnb of nnabla-c-runtime layout
+
+class NnbBuilder(object):
+    def __init__(self, seed):
+        self.rand = np.random.RandomState(seed)
+        self.variables = []     # (shape, data or None)
+        self.functions = []     # (type, inputs, outputs, args)
+        self.inputs = []
+        self.outputs = []
+
+    def variable(self, shape, data=None):
+        self.variables.append((tuple(shape), data))
+        return len(self.variables) - 1
+
+    def weight(self, shape, fan_in):
+        w = self.rand.normal(0, np.sqrt(2.0 / fan_in), shape)
+        return self.variable(shape, w.astype(np.float32))
+
+    def bias(self, size):
+        b = self.rand.uniform(-0.1, 0.1, size)
+        return self.variable((size,), b.astype(np.float32))
+
+    def function(self, ftype, inputs, out_shape, args=()):
+        y = self.variable(out_shape)
+        self.functions.append((ftype, inputs, [y], args))
+        return y
+
+    def conv(self, x, ch, ker, pad=0, stride=1):
+        (_, in_ch, h, w) = self.variables[x][0]
+        oh = (h + 2 * pad - ker) // stride + 1
+        ow = (w + 2 * pad - ker) // stride + 1
+        wv = self.weight((ch, in_ch, ker, ker), in_ch * ker * ker)
+        args = [('i', 1), ('l', [pad, pad]), ('l', [stride, stride]),
+                ('l', [1, 1]), ('i', 1)]
+        return self.function(nq.CONVOLUTION, [x, wv, self.bias(ch)],
+                             (1, ch, oh, ow), args)
+
+    def dwconv(self, x, ker, pad=0):
+        (_, ch, h, w) = self.variables[x][0]
+        oh = h + 2 * pad - ker + 1
+        ow = w + 2 * pad - ker + 1
+        wv = self.weight((ch, ker, ker), ker * ker)
+        args = [('i', 1), ('l', [pad, pad]), ('l', [1, 1]),
+                ('l', [1, 1]), ('i', 1)]
+        return self.function(nq.DEPTHWISE_CONVOLUTION,
+                             [x, wv, self.bias(ch)], (1, ch, oh, ow), args)
+
+    def affine(self, x, size):
+        in_size = int(np.prod(self.variables[x][0][1:]))
+        wv = self.weight((size, in_size), in_size)
+        return self.function(nq.AFFINE, [x, wv, self.bias(size)],
+                             (1, size), [('i', 1)])
+
+    def relu(self, x):
+        return self.function(nq.RELU, [x], self.variables[x][0])
+
+    def pool(self, ftype, x, ker):
+        (n, ch, h, w) = self.variables[x][0]
+        args = [('l', [ker, ker]), ('l', [ker, ker]), ('B', 1),
+                ('l', [0, 0])]
+        if ftype == nq.AVERAGE_POOLING:
+            args.append(('B', 0))
+        return self.function(ftype, [x], (n, ch, h // ker, w // ker), args)
+
+    def softmax(self, x):
+        return self.function(nq.SOFTMAX, [x], self.variables[x][0],
+                             [('i', 1)])
+
+    def build(self):
+        w = nq.Writer.__new__(nq.Writer)
+        w.data = bytearray(8 + 8 * len(nq.NETWORK_LISTS))
+        w.patch(0, 'ii', 2, 1)          # version, api_level
+
+        buffers = []
+        blocks = []
+        var_offsets = []
+        for (shape, data) in self.variables:
+            shape_list = w.append_list(list(shape))
+            if data is None:
+                index = -len(buffers) - 1
+                buffers.append(int(np.prod(shape)))
+            else:
+                index = len(blocks)
+                blocks.append(data.astype('<f4').tobytes())
+            var_offsets.append(w.append('iiIi', shape_list[0],
+                                        shape_list[1], nq.TYPE_FLOAT, index))
+
+        func_offsets = []
+        for (ftype, inputs, outputs, args) in self.functions:
+            lists = []
+            for (fmt, value) in args:
+                lists.append(w.append_list(value) if fmt == 'l' else None)
+            in_list = w.append_list(inputs)
+            out_list = w.append_list(outputs)
+            func_offsets.append(w.append('HHiiii', ftype, 0,
+                                         in_list[0], in_list[1],
+                                         out_list[0], out_list[1]))
+            for ((fmt, value), lst) in zip(args, lists):
+                if fmt == 'l':
+                    w.append('ii', *lst)
+                elif fmt == 'B':
+                    w.append('B', value)
+                    w.align(4)
+                else:
+                    w.append(fmt, value)
+
+        lists = [w.append_list(buffers), w.append_list(var_offsets),
+                 w.append_list(func_offsets), w.append_list(self.inputs),
+                 w.append_list(self.outputs)]
+        blocks_pos = w.append('%di' % len(blocks), *([0] * len(blocks)))
+        lists.append((len(blocks), blocks_pos))
+        for (i, lst) in enumerate(lists):
+            w.patch_list(8 + 8 * i, lst)
+
+        w.align(16)
+        for (i, block) in enumerate(blocks):
+            w.patch(blocks_pos + 4 * i, 'i', len(w.data))
+            w.data += block
+            w.align(4)
+        return bytes(w.data)
+
+def lenet():
+    b = NnbBuilder(1)
+    x = b.variable((1, 1, 28, 28))
+    b.inputs = [x]
+    y = b.pool(nq.MAX_POOLING, b.relu(b.conv(x, 6, 5)), 2)
+    y = b.pool(nq.MAX_POOLING, b.relu(b.conv(y, 16, 5)), 2)
+    y = b.relu(b.affine(y, 120))
+    y = b.relu(b.affine(y, 84))
+    b.outputs = [b.softmax(b.affine(y, 10))]
+    return b
+
+def dwcnn():
+    b = NnbBuilder(2)
+    x = b.variable((1, 3, 16, 16))
+    b.inputs = [x]
+    y = b.relu(b.conv(x, 8, 3, pad=1, stride=2))
+    y = b.relu(b.dwconv(y, 3, pad=1))
+    y = b.relu(b.conv(y, 16, 1))
+    y = b.pool(nq.AVERAGE_POOLING, y, 2)
+    b.outputs = [b.affine(y, 10)]
+    return b
+
+def load_digits():
+    digits = []
+    for i in range(10):
+        with open(os.path.join(DIGITS, '%d.pgm' % i), 'rb') as f:
+            data = f.read()
+        # P5, 28 28, 255, then the pixels
+        digits.append(np.frombuffer(data[-28 * 28:], dtype=np.uint8)
+                      .reshape(1, 28, 28) / 255.0)
+    return digits
+
+def digit_samples(digits, num, seed):
+    rand = np.random.RandomState(seed)
+    x = []
+    for i in range(num):
+        d = np.roll(digits[i % 10], rand.randint(-2, 3, 2), axis=(1, 2))
+        x.append(np.clip(d + rand.normal(0, 0.05, d.shape), 0, 1))
+    return np.array(x, dtype=np.float32)
+
+def random_samples(shape, num, seed):
+    rand = np.random.RandomState(seed)
+    return rand.uniform(-1, 1, (num,) + shape).astype(np.float32)
+
+############################################################################
+# quantized nnb executed from its contents, as dnnrt does
+
+def block(nnb, v, dtype, count):
+    return np.frombuffer(nnb.data, dtype=dtype, count=count,
+                         offset=nnb.blocks[v.data_index])
+
+def requantize(acc, mult, shift, out_zero, act_min, act_max):
+    # requantize() of mp_kernel.c for each channel
+    y = np.empty(acc.shape, dtype=np.int64)
+    for c in range(acc.shape[0]):
+        total = 31 - int(shift[c])
+        v = (acc[c] * int(mult[c]) + (1 << (total - 1))) >> total
+        y[c] = np.clip(v + out_zero, act_min, act_max)
+    return y.astype(np.int8)
+
+def run_quantized(nnb, inputs):
+    values = dict(zip(nnb.inputs, inputs))
+
+    def get(vid):
+        if vid not in values:
+            v = nnb.variables[vid]
+            values[vid] = block(nnb, v, '<f4', v.size).reshape(v.shape)
+        return values[vid]
+
+    for f in nnb.functions:
+        x = get(f.inputs[0])
+        yv = nnb.variables[f.outputs[0]]
+        if f.impl != nq.DNNRT_IMPLEMENT_QINT8:
+            y = nq.run_function(f, x, get, yv.shape)
+            values[yv.index] = y if y.dtype == np.int8 else \
+                y.astype(np.float32)
+            continue
+
+        (wv, bv, qv) = [nnb.variables[vid] for vid in f.inputs[1:]]
+        ch = bv.size
+        w = block(nnb, wv, 'i1', wv.size).reshape(wv.shape)
+        b = block(nnb, bv, '<i4', ch)
+        words = block(nnb, qv, '<i4', qv.size)
+        (in_zero, out_zero, act_min, act_max) = words[2:6]
+        (in_scale, out_scale) = words[6:8].view('<f4')
+        mult = words[nq.PARAM_WORDS:nq.PARAM_WORDS + ch]
+        shift = words[nq.PARAM_WORDS + ch:]
+
+        if x.dtype != np.int8:
+            x = nq.quantize_input(x, in_scale, in_zero)
+        acc = nq.layer_acc(f, x.astype(np.int64) - in_zero,
+                           w.astype(np.int64), b.astype(np.int64),
+                           yv.shape)
+        acc = np.moveaxis(acc.reshape((-1,) + acc.shape[f.base_axis:]),
+                          1, 0)
+        y = requantize(acc.reshape(ch, -1), mult, shift, out_zero,
+                       act_min, act_max)
+        y = np.moveaxis(y.reshape((ch, -1) + acc.shape[2:]), 0, 1)
+        y = y.reshape(yv.shape)
+        if yv.type == nq.TYPE_FLOAT:
+            y = (y.astype(np.float32) - np.float32(out_zero)) * \
+                np.float32(out_scale)
+        values[yv.index] = y
+
+    for (vid, y) in values.items():
+        check((y.dtype == np.int8) ==
+              (nnb.variables[vid].type == nq.TYPE_INT8),
+              'variable %d is %s, but its type is %d'
+              % (vid, y.dtype, nnb.variables[vid].type))
+    return [values[vid] for vid in nnb.outputs]
+
+############################################################################
+# test
+
+def check_layout(src, out, keep):
+    folded = 0
+    for f in src.functions:
+        if f.type == nq.RELU and f.inputs[0] in \
+           [g.outputs[0] for g in src.functions if g.type in nq.QUANTIZED
+            and g.index not in keep]:
+            folded += 1
+    check(len(out.functions) == len(src.functions) - folded,
+          '%d functions, expected %d' % (len(out.functions),
+                                         len(src.functions) - folded))
+
+    for f in out.functions:
+        orig = [g for g in src.functions if g.offset == f.offset][0]
+        if f.type not in nq.QUANTIZED:
+            check(f.impl == 0, '%s %d has impl %d' % (f.name, orig.index,
+                                                     f.impl))
+            continue
+        if orig.index in keep:
+            check(f.impl == 0 and f.inputs == orig.inputs,
+                  '%s %d is not kept float' % (f.name, orig.index))
+            w = src.variables[orig.inputs[1]]
+            check(np.array_equal(block(out, out.variables[f.inputs[1]],
+                                       '<f4', w.size),
+                                 block(src, w, '<f4', w.size)),
+                  'weight of %s %d is changed' % (f.name, orig.index))
+            continue
+
+        check(f.impl == nq.DNNRT_IMPLEMENT_QINT8 and len(f.inputs) == 4,
+              '%s %d is not quantized' % (f.name, orig.index))
+        (wv, bv, qv) = [out.variables[vid] for vid in f.inputs[1:]]
+        ch = bv.size
+        check(wv.type == nq.TYPE_INT8 and wv.shape ==
+              src.variables[orig.inputs[1]].shape,
+              'weight of %s %d' % (f.name, orig.index))
+        check(bv.type == nq.TYPE_FLOAT and qv.type == nq.TYPE_FLOAT and
+              qv.size == nq.PARAM_WORDS + 2 * ch,
+              'bias or parameters of %s %d' % (f.name, orig.index))
+
+        words = block(out, qv, '<i4', qv.size)
+        check(words[0] == 0x51384e44 and words[1] == 1,
+              'marker of %s %d is %08x %d'
+              % (f.name, orig.index, words[0], words[1]))
+        mult = words[nq.PARAM_WORDS:nq.PARAM_WORDS + ch]
+        shift = words[nq.PARAM_WORDS + ch:]
+        check(np.all((mult == 0) | ((mult >= 1 << 30))) and
+              np.all(shift <= 30) and np.all(shift >= -31),
+              'multipliers of %s %d' % (f.name, orig.index))
+        (out_zero, act_min) = words[3:5]
+        relu = out.variables[f.outputs[0]].index != orig.outputs[0]
+        check(act_min == (out_zero if relu else -128),
+              'act_min of %s %d' % (f.name, orig.index))
+
+    # memory blocks follow the graph, aligned and not overlapping
+
+    used = []
+    for v in out.variables:
+        if v.data_index < 0:
+            continue
+        size = v.size * (1 if v.type == nq.TYPE_INT8 else 4)
+        used.append((out.blocks[v.data_index], size))
+    used.sort()
+    end = out.graph_bsize
+    for (pos, size) in used:
+        check(pos % 4 == 0 and pos >= end, 'memory block at %d' % pos)
+        end = pos + size
+    check(end <= len(out.data), 'memory blocks beyond the end')
+
+def accuracy(ref, out):
+    # as report() of nnbquant.py
+    r = np.array(ref).reshape(len(ref), -1).astype(np.float64)
+    q = np.array(out).reshape(len(out), -1).astype(np.float64)
+    err = q - r
+    noise = np.mean(err ** 2)
+    sqnr = 10 * np.log10(np.mean(r ** 2) / noise) if noise > 0 \
+        else float('inf')
+    top1 = np.mean(np.argmax(r, axis=1) == np.argmax(q, axis=1))
+    return (np.max(np.abs(err)), sqnr, top1)
+
+def test_model(tmp, name, builder, calib, evals, keep=()):
+    print('%s%s' % (name, ' (-k %s)' % ','.join(map(str, keep))
+                    if keep else ''))
+    src_path = os.path.join(tmp, name + '.nnb')
+    out_path = os.path.join(tmp, name + '_q.nnb')
+    calib_path = os.path.join(tmp, 'calib.npy')
+    eval_path = os.path.join(tmp, 'eval.npy')
+    with open(src_path, 'wb') as f:
+        f.write(builder.build())
+    np.save(calib_path, calib)
+    np.save(eval_path, evals)
+
+    args = [sys.executable, TOOL, '-c', calib_path, '-e', eval_path,
+            '-o', out_path]
+    for k in keep:
+        args += ['-k', str(k)]
+    args.append(src_path)
+    proc = subprocess.Popen(args, stdout=subprocess.PIPE,
+                            stderr=subprocess.STDOUT)
+    log = proc.communicate()[0].decode()
+    check(proc.returncode == 0, 'nnbquant.py failed:\n' + log)
+    if proc.returncode != 0:
+        return None
+
+    with open(src_path, 'rb') as f:
+        src = nq.Nnb(f.read())
+    with open(out_path, 'rb') as f:
+        out = nq.Nnb(f.read())
+    check_layout(src, out, set(keep))
+
+    # the nnb written must give what the tool reported
+
+    shape = src.variables[src.inputs[0]].shape
+    samples = [[x] for x in evals.reshape((-1,) + shape)]
+    ref = [nq.run_float(src, s)[0] for s in samples]
+    res = [run_quantized(out, s)[0] for s in samples]
+    (max_err, sqnr, top1) = accuracy(ref, res)
+    m = re.search(r'max \|err\| ([\d.]+), .* SQNR (\S+) dB, '
+                  r'top-1 agreement ([\d.]+)%', log)
+    check(m is not None, 'no accuracy reported:\n' + log)
+    if m:
+        check(m.group(1) == '%.6f' % max_err and
+              m.group(2) == '%.1f' % sqnr and
+              m.group(3) == '%.1f' % (top1 * 100),
+              'nnb gives max |err| %.6f, SQNR %.1f dB, top-1 %.1f%%, '
+              'reported %s, %s dB, %s%%'
+              % (max_err, sqnr, top1 * 100, m.group(1), m.group(2),
+                 m.group(3)))
+    check(sqnr >= MIN_SQNR, 'SQNR %.1f dB' % sqnr)
+    check(top1 >= MIN_TOP1, 'top-1 agreement %.1f%%' % (top1 * 100))
+
+    print('  %d -> %d bytes, max |err| %.6f, SQNR %.1f dB, '
+          'top-1 agreement %.1f%% (%d samples)'
+          % (len(src.data), len(out.data), max_err, sqnr, top1 * 100,
+             len(samples)))
+    return out_path
+
+def test_requantize(path):
+    # a quantized nnb is not a float nnb
+
+    proc = subprocess.Popen([sys.executable, TOOL, '-c', path, path],
+                            stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    err = proc.communicate()[1].decode()
+    check(proc.returncode != 0 and 'not a float nnb' in err,
+          'quantized nnb is quantized again')
+
+def main():
+    digits = load_digits()
+    calib = digit_samples(digits, 50, 1)
+    evals = digit_samples(digits, 200, 2)
+
+    tmp = tempfile.mkdtemp()
+    try:
+        path = test_model(tmp, 'lenet-5', lenet(), calib, evals)
+        test_model(tmp, 'lenet-5', lenet(), calib, evals, keep=(6,))
+        test_model(tmp, 'dwcnn', dwcnn(), random_samples((3, 16, 16), 50, 3),
+                   random_samples((3, 16, 16), 200, 4))
+        if path:
+            test_requantize(path)
+    finally:
+        shutil.rmtree(tmp)
+
+    print('%s (%d failure)' % ('PASS' if s_fail == 0 else 'FAIL', s_fail))
+    return 0 if s_fail == 0 else 1
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,359 @@
+/****************************************************************************
+ * modules/dnnrt/test/quant_bench.c
+ *
+ *   Copyright 2018 Sony Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Corporation nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/* Host benchmark of int8 kernels quantized by tools/nnbquant.py.
+ *
+ * Layers of LeNet-5 (as generated by nnbquant_test.py) and a wider
+ * convolution are executed by the float and the int8 kernel jobs of
+ * mp_kernel.c, as one ASMP worker executes them. Output of the int8
+ * kernels is checked against a straightforward reference with the same
+ * requantization, then time of each layer is measured.
+ *
+ * This runs the plain C code of the kernels (ARM_MATH_CM0) on the host.
+ * Times on the target, where int8 is executed by SMLAD, are measured by
+ * examples/dnnrt_bench.
+ *
+ *   $ make quant_bench && ./quant_bench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <runtime/runtime_mp.h>
+
+#define CHECK(cond, ...)                                                      \
+  do                                                                          \
+    {                                                                         \
+      if (!(cond))                                                            \
+        {                                                                     \
+          printf("  NG: ");                                                   \
+          printf(__VA_ARGS__);                                                \
+          printf("\n");                                                       \
+          s_fail++;                                                           \
+        }                                                                     \
+    }                                                                         \
+  while (0)
+
+#define BENCH_LOOP (20)
+#define SCRATCH_BSIZE (64 * 1024)
+
+/* A layer, affine if ker is 0 (in_ch is the number of inputs) */
+
+typedef struct bench_layer
+{
+  const char *name;
+  int in_ch;
+  int in_h;
+  int in_w;
+  int out_ch;
+  int ker;
+  int pad;
+  int stride;
+} bench_layer_t;
+
+static const bench_layer_t s_layers[] =
+{
+  { "lenet-5 conv 1x28x28 6@5x5", 1, 28, 28, 6, 5, 0, 1 },
+  { "lenet-5 conv 6x12x12 16@5x5", 6, 12, 12, 16, 5, 0, 1 },
+  { "lenet-5 affine 256 -> 120", 256, 1, 1, 120, 0, 0, 0 },
+  { "lenet-5 affine 120 -> 84", 120, 1, 1, 84, 0, 0, 0 },
+  { "lenet-5 affine 84 -> 10", 84, 1, 1, 10, 0, 0, 0 },
+  { "conv 32x32x32 32@3x3 pad 1", 32, 32, 32, 32, 3, 1, 1 },
+};
+
+static int s_fail;
+static uint32_t s_seed = 1;
+static void *s_scratch;
+
+/* Used by q7 CHW convolution of CMSIS-NN, which needs ARM_MATH_DSP and is
+ * not executed here.
+ */
+
+void *read_and_pad(void *source, int32_t * out1, int32_t * out2)
+{
+  abort();
+}
+
+static int rand_int(int n)
+{
+  s_seed = s_seed * 1103515245 + 12345;
+  return (int)((s_seed >> 8) % n);
+}
+
+static uint64_t now_ns(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+static uint64_t bench_job(dnn_mp_job_t * job)
+{
+  uint64_t best = UINT64_MAX;
+  int i;
+
+  for (i = 0; i < BENCH_LOOP; i++)
+    {
+      uint64_t start = now_ns();
+      dnn_mp_exec_job(job);
+      uint64_t time = now_ns() - start;
+
+      best = time < best ? time : best;
+    }
+  return best;
+}
+
+static int8_t ref_requantize(int64_t acc, int32_t mult, int32_t shift,
+                             const dnn_mp_quant_t * q)
+{
+  int total = 31 - shift;
+  int64_t v = (acc * mult + ((int64_t)1 << (total - 1))) >> total;
+
+  v += q->out_offset;
+  v = v < q->act_min ? q->act_min : (v > q->act_max ? q->act_max : v);
+  return (int8_t)v;
+}
+
+/* int8 layer of nnbquant.py: padding is 0 after the zero point of x is
+ * subtracted.
+ */
+
+static void ref_layer_s8(const bench_layer_t * l, int out_h, int out_w,
+                         const int8_t * x, const int8_t * w,
+                         const int32_t * b, const dnn_mp_quant_t * q,
+                         int8_t * y)
+{
+  int ker = l->ker ? l->ker : 1;
+  int oc, oy, ox, ic, ky, kx;
+
+  for (oc = 0; oc < l->out_ch; oc++)
+    {
+      for (oy = 0; oy < out_h; oy++)
+        {
+          for (ox = 0; ox < out_w; ox++)
+            {
+              int64_t acc = b[oc];
+
+              for (ic = 0; ic < l->in_ch; ic++)
+                {
+                  for (ky = 0; ky < ker; ky++)
+                    {
+                      for (kx = 0; kx < ker; kx++)
+                        {
+                          int iy = oy * l->stride - l->pad + ky;
+                          int ix = ox * l->stride - l->pad + kx;
+
+                          if (iy < 0 || iy >= l->in_h ||
+                              ix < 0 || ix >= l->in_w)
+                            {
+                              continue;
+                            }
+                          acc += (int64_t)
+                            (x[(ic * l->in_h + iy) * l->in_w + ix] +
+                             q->in_offset) *
+                            w[((oc * l->in_ch + ic) * ker + ky) * ker + kx];
+                        }
+                    }
+                }
+              *y++ = ref_requantize(acc, q->mult[oc], q->shift[oc], q);
+            }
+        }
+    }
+}
+
+static void bench_layer(const bench_layer_t * l)
+{
+  int affine = l->ker == 0;
+  int ker = affine ? 1 : l->ker;
+  int out_h = affine ? 1 : (l->in_h + 2 * l->pad - ker) / l->stride + 1;
+  int out_w = affine ? 1 : (l->in_w + 2 * l->pad - ker) / l->stride + 1;
+  int in_size = l->in_ch * l->in_h * l->in_w;
+  int w_size = l->out_ch * l->in_ch * ker * ker;
+  int out_size = l->out_ch * out_h * out_w;
+  float *xf = malloc(in_size * sizeof(float));
+  float *wf = malloc(w_size * sizeof(float));
+  float *bf = malloc(l->out_ch * sizeof(float));
+  float *yf = malloc(out_size * sizeof(float));
+  int8_t *x = malloc(in_size);
+  int8_t *w = malloc(w_size);
+  int32_t *b = malloc(l->out_ch * sizeof(int32_t));
+  int32_t *mult = malloc(l->out_ch * sizeof(int32_t));
+  int32_t *shift = malloc(l->out_ch * sizeof(int32_t));
+  int8_t *y = malloc(out_size);
+  int8_t *ref = malloc(out_size);
+  dnn_mp_job_t job;
+  dnn_mp_quant_t q;
+  uint64_t time_f32;
+  uint64_t time_s8;
+  int i;
+
+  for (i = 0; i < in_size; i++)
+    {
+      x[i] = (int8_t)(rand_int(256) - 128);
+      xf[i] = x[i] / 128.0f;
+    }
+  for (i = 0; i < w_size; i++)
+    {
+      w[i] = (int8_t)(rand_int(255) - 127);
+      wf[i] = w[i] / 128.0f;
+    }
+
+  /* scales of a quantized layer, acc is about 2^15 * sqrt(n) */
+
+  for (i = 0; i < l->out_ch; i++)
+    {
+      b[i] = rand_int(2001) - 1000;
+      bf[i] = b[i] / 16384.0f;
+      mult[i] = (1 << 30) + rand_int(1 << 30);
+      shift[i] = -10 - rand_int(4);
+    }
+
+  q.mult = mult;
+  q.shift = shift;
+  q.in_offset = rand_int(256) - 128;
+  q.out_offset = rand_int(32) - 16;
+  q.act_min = -128;
+  q.act_max = 127;
+  q.out_scale = 0.0f;
+
+  /* float */
+
+  memset(&job, 0, sizeof(job));
+  job.scratch = s_scratch;
+  job.post_pool.op = DNN_MP_POOL_NONE;
+  if (affine)
+    {
+      job.kernel = DNN_MP_AFFINE_F32;
+      job.u.affine.in = xf;
+      job.u.affine.wt = wf;
+      job.u.affine.bias = bf;
+      job.u.affine.out = yf;
+      job.u.affine.batch = 1;
+      job.u.affine.in_size = in_size;
+      job.u.affine.out_size = l->out_ch;
+      job.u.affine.out_stride = l->out_ch;
+    }
+  else
+    {
+      job.kernel = DNN_MP_CONV_F32;
+      job.u.conv.in = xf;
+      job.u.conv.wt = wf;
+      job.u.conv.bias = bf;
+      job.u.conv.out = yf;
+      job.u.conv.in_w = l->in_w;
+      job.u.conv.in_h = l->in_h;
+      job.u.conv.in_ch = l->in_ch;
+      job.u.conv.out_ch = l->out_ch;
+      job.u.conv.out_w = out_w;
+      job.u.conv.out_h = out_h;
+      job.u.conv.ker_w = ker;
+      job.u.conv.ker_h = ker;
+      job.u.conv.pad_w = l->pad;
+      job.u.conv.pad_h = l->pad;
+      job.u.conv.stride_w = l->stride;
+      job.u.conv.stride_h = l->stride;
+    }
+  time_f32 = bench_job(&job);
+
+  /* int8, the same job with int8 data */
+
+  job.quant = q;
+  if (affine)
+    {
+      job.kernel = DNN_MP_AFFINE_S8;
+      job.u.affine.in = x;
+      job.u.affine.wt = w;
+      job.u.affine.bias = b;
+      job.u.affine.out = y;
+    }
+  else
+    {
+      job.kernel = DNN_MP_CONV_S8;
+      job.u.conv.in = x;
+      job.u.conv.wt = w;
+      job.u.conv.bias = b;
+      job.u.conv.out = y;
+    }
+  time_s8 = bench_job(&job);
+
+  ref_layer_s8(l, out_h, out_w, x, w, b, &q, ref);
+  for (i = 0; i < out_size; i++)
+    {
+      if (y[i] != ref[i])
+        {
+          CHECK(0, "%s: output %d is %d, expected %d", l->name, i, y[i],
+                ref[i]);
+          break;
+        }
+    }
+
+  printf("  %-28s %9d %9.1f %9.1f %6.2fx %8d -> %d\n", l->name,
+         out_size * l->in_ch * ker * ker, time_f32 / 1000.0,
+         time_s8 / 1000.0, (double)time_f32 / time_s8,
+         w_size * (int)sizeof(float), w_size);
+
+  free(xf);
+  free(wf);
+  free(bf);
+  free(yf);
+  free(x);
+  free(w);
+  free(b);
+  free(mult);
+  free(shift);
+  free(y);
+  free(ref);
+}
+
+int main(void)
+{
+  int i;
+
+  s_scratch = malloc(SCRATCH_BSIZE);
+
+  printf("benchmark (us per layer, the best of %d runs)\n", BENCH_LOOP);
+  printf("  %-28s %9s %9s %9s %7s %s\n", "layer", "MACs", "float",
+         "int8", "speedup", "weight bytes");
+  for (i = 0; i < (int)(sizeof(s_layers) / sizeof(s_layers[0])); i++)
+    {
+      bench_layer(&s_layers[i]);
+    }
+
+  printf("%s (%d failure)\n", s_fail == 0 ? "PASS" : "FAIL", s_fail);
+
+  free(s_scratch);
+  return s_fail == 0 ? 0 : 1;
+}
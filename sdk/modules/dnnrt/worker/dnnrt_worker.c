@@ -1,5 +1,5 @@
 /****************************************************************************
- * dnnrt_lenet/loader_nnb.c
+ * modules/dnnrt/worker/dnnrt_worker.c
  *
  *   Copyright 2018 Sony Corporation
  *
@@ -32,73 +32,55 @@
  *
  ****************************************************************************/
 
-#include <stdio.h>
-#include <stdlib.h>
-#include <fcntl.h>
 #include <errno.h>
-#include <sys/stat.h>
-#include <dnnrt/runtime.h>
+#include <stdint.h>
 
-static int get_nnb_size(const char *nnb_path, uint32_t * size_ptr)
-{
-  int ret;
-  struct stat nnb_stat;
+#include <asmp/types.h>
+#include <asmp/mpmq.h>
 
-  if (nnb_path == NULL || size_ptr == NULL)
-    {
-      return -EINVAL;
-    }
-  ret = stat(nnb_path, &nnb_stat);
-  if (ret == 0)
-    {
-      *size_ptr = nnb_stat.st_size;
-    }
-  return ret;
-}
+#include "asmp.h"
 
-nn_network_t *alloc_nnb_network(const char *nnb_path)
+#include <runtime/runtime_mp.h>
+
+#define ASSERT(cond) if (!(cond)) wk_abort()
+
+int main(void)
 {
+  mpmq_t mq;
+  uint32_t msgdata;
+  dnn_mp_job_t *job;
   int ret;
-  FILE *nnb_file = NULL;
-  uint32_t exp_data_bsize, act_data_bsize;
-  nn_network_t *network = NULL;
 
-  if (nnb_path == NULL)
-    {
-      goto file_open_err;;
-    }
-  nnb_file = fopen(nnb_path, "r");
-  if (nnb_file == NULL)
-    {
-      goto file_open_err;
-    }
-  /* get size of nnb_file in units of bytes */
-  ret = get_nnb_size(nnb_path, &exp_data_bsize);
-  if (ret)
-    {
-      goto get_size_error;
-    }
-  /* store content of nnb_file in heap memory */
-  network = malloc(exp_data_bsize);
-  if (network == NULL)
-    {
-      goto malloc_error;
-    }
-  act_data_bsize = fread(network, 1, exp_data_bsize, nnb_file);
-  if (exp_data_bsize != act_data_bsize)
+  /* Initialize MP message queue,
+   * On the worker side, 3rd argument is ignored.
+   */
+
+  ret = mpmq_init(&mq, DNN_MP_KEY_MQ, 0);
+  ASSERT(ret == 0);
+
+  ret = mpmq_send(&mq, DNN_MP_MSG_BOOT, 0);
+  ASSERT(ret == 0);
+
+  while (1)
     {
-      free(network);
-      network = NULL;
-    }
+      /* Message data is the address of a job on the main core. */
 
-malloc_error:
-get_size_error:
-  fclose(nnb_file);
-file_open_err:
-  return network;
-}
+      ret = mpmq_receive(&mq, &msgdata);
+      if (ret == DNN_MP_MSG_EXIT)
+        {
+          break;
+        }
+      if (ret != DNN_MP_MSG_EXEC)
+        {
+          continue;
+        }
 
-void destroy_nnb_network(nn_network_t * network)
-{
-  free(network);
+      job = (dnn_mp_job_t *)(uintptr_t)msgdata;
+      job->result = dnn_mp_exec_job(job);
+
+      ret = mpmq_send(&mq, DNN_MP_MSG_DONE, msgdata);
+      ASSERT(ret == 0);
+    }
+
+  return 0;
 }
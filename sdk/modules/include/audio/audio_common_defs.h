@@ -595,7 +595,21 @@
 
 #define AS_ATTENTION_SUB_CODE_ALLOC_HEAP_MEMORY     0x21
 
-#define AS_ATTENTION_SUB_CODE_NUM   AS_ATTENTION_SUB_CODE_ALLOC_HEAP_MEMORY
+/*! \brief File Write Stall
+ *  \details Write to recording file took longer than the stall threshold.
+ *           Recording continues while the file sink buffer has space.
+ */
+
+#define AS_ATTENTION_SUB_CODE_FILE_WRITE_STALL      0x22
+
+/*! \brief File Write Error
+ *  \details Write to recording file failed. Recording stops with
+ *           overflow state.
+ */
+
+#define AS_ATTENTION_SUB_CODE_FILE_WRITE_ERROR      0x23
+
+#define AS_ATTENTION_SUB_CODE_NUM   AS_ATTENTION_SUB_CODE_FILE_WRITE_ERROR
 
 /** @} */
 
@@ -461,6 +461,10 @@
 
 #define AS_ECODE_SET_SPDRVMODE_ERROR             0x3C
 
+/*! \brief File Access Error */
+
+#define AS_ECODE_FILE_ACCESS_ERROR               0x3E
+
 /** @} */
 
 /****************************************************************************
@@ -163,8 +163,9 @@
 #define MSG_AUD_PLY_CMD_STOP            (MSG_AUD_PLY_REQ | MSG_SET_SUBTYPE(0x03))
 #define MSG_AUD_PLY_CMD_DEACT           (MSG_AUD_PLY_REQ | MSG_SET_SUBTYPE(0x04))
 #define MSG_AUD_PLY_CMD_SETGAIN         (MSG_AUD_PLY_REQ | MSG_SET_SUBTYPE(0x05))
+#define MSG_AUD_PLY_CMD_SETNEXT         (MSG_AUD_PLY_REQ | MSG_SET_SUBTYPE(0x06))
 
-#define LAST_AUD_PLY_MSG    (MSG_AUD_PLY_CMD_SETGAIN + 1)
+#define LAST_AUD_PLY_MSG    (MSG_AUD_PLY_CMD_SETNEXT + 1)
 #define AUD_PLY_MSG_NUM     (LAST_AUD_PLY_MSG & MSG_TYPE_SUBTYPE)
 
 #define MSG_AUD_PLY_CMD_NEXT_REQ        (MSG_AUD_PLY_RES | MSG_SET_SUBTYPE(0x00))
@@ -305,8 +306,9 @@
 #define MSG_AUD_MIX_CMD_PSTFLT_DONE (MSG_AUD_MIX_REQ | MSG_SET_SUBTYPE(0x03))
 #define MSG_AUD_MIX_CMD_RENDER_DONE (MSG_AUD_MIX_REQ | MSG_SET_SUBTYPE(0x04))
 #define MSG_AUD_MIX_CMD_CLKRECOVERY (MSG_AUD_MIX_REQ | MSG_SET_SUBTYPE(0x05))
+#define MSG_AUD_MIX_CMD_SETPFPARAM  (MSG_AUD_MIX_REQ | MSG_SET_SUBTYPE(0x06))
 
-#define LAST_AUD_MIX_MSG   (MSG_AUD_MIX_CMD_CLKRECOVERY + 1)
+#define LAST_AUD_MIX_MSG   (MSG_AUD_MIX_CMD_SETPFPARAM + 1)
 #define AUD_MIX_MSG_NUM    (LAST_AUD_MIX_MSG & MSG_TYPE_SUBTYPE)
 
 #define MSG_AUD_MIX_RST    (MSG_AUD_MIX_RES | MSG_SET_SUBTYPE(0x00))
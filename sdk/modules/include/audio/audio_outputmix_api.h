@@ -140,9 +140,53 @@ enum AsOutputMixDoneCmdType
 
   OutputMixSetClkRcvDone,
 
+  /*! \brief Set postfilter parameter done */
+
+  OutputMixSetPostFilterDone,
+
   OutputMixDoneCmdTypeNum
 };
 
+/**< Parameter type of postfilter */
+
+enum AsOutputMixPostFilterParamType
+{
+  /*! \brief Enable/disable processing blocks */
+
+  OutputMixPostFilterEnable = 0,
+
+  /*! \brief Coefficients of equalizer stage */
+
+  OutputMixPostFilterEq,
+
+  /*! \brief Look-ahead limiter */
+
+  OutputMixPostFilterLimiter,
+
+  /*! \brief Stereo widening */
+
+  OutputMixPostFilterWidth,
+
+  OutputMixPostFilterParamTypeNum
+};
+
+/**< Processing blocks of postfilter (bit mask) */
+
+enum AsOutputMixPostFilterBlock
+{
+  /*! \brief Equalizer (biquad cascade) */
+
+  OutputMixPostFilterBlockEq      = 0x01,
+
+  /*! \brief Stereo widening */
+
+  OutputMixPostFilterBlockWidth   = 0x02,
+
+  /*! \brief Look-ahead limiter */
+
+  OutputMixPostFilterBlockLimiter = 0x04,
+};
+
 /** Message queue ID parameter of activate function */
 
 typedef struct
@@ -275,16 +319,88 @@ typedef struct
 
 typedef struct
 {
-  /*! \brief [in] Recovery direction (advance or delay) */
+  /*! \brief [in] Recovery direction (advance, delay or auto) */
 
   int8_t   direction;
 
-  /*! \brief [in] Recovery term */
+  /*! \brief [in] Recovery term.
+   *         Target fill level in samples when direction is auto.
+   */
 
   uint32_t times;
 
 } AsFrameTermFineControl;
 
+/** Equalizer parameter of postfilter */
+
+typedef struct
+{
+  /*! \brief [in] Index of biquad stage (0 to 4) */
+
+  uint8_t band;
+
+  /*! \brief [in] b0, b1, b2, a1, a2 in Q2.30.
+   *         a1 and a2 are sign inverted, i.e.
+   *         y[n] = b0 * x[n] + ... + a1 * y[n-1] + a2 * y[n-2]
+   */
+
+  int32_t coef[5];
+
+} AsPostFilterEqParam;
+
+/** Limiter parameter of postfilter */
+
+typedef struct
+{
+  /*! \brief [in] Peak level in Q15 (32767 = 0dBFS) */
+
+  uint16_t threshold;
+
+  /*! \brief [in] Look-ahead length in frames (1 to 128) */
+
+  uint16_t lookahead;
+
+  /*! \brief [in] Gain recovery per frame in Q15 */
+
+  uint16_t release;
+
+} AsPostFilterLimiterParam;
+
+/** Set postfilter parameter function parameter */
+
+typedef struct
+{
+  /*! \brief [in] Parameter type
+   *
+   * Use #AsOutputMixPostFilterParamType enum type
+   */
+
+  uint8_t param_type;
+
+  union
+  {
+    /*! \brief [in] Enabled blocks
+     *
+     * Use #AsOutputMixPostFilterBlock enum type. 0 means through.
+     */
+
+    uint32_t                 enable;
+
+    /*! \brief [in] Equalizer stage */
+
+    AsPostFilterEqParam      eq;
+
+    /*! \brief [in] Limiter */
+
+    AsPostFilterLimiterParam limiter;
+
+    /*! \brief [in] Gain of side signal in Q2.30 (1.0 = unchanged) */
+
+    int32_t                  width;
+  };
+
+} AsSetPostFilterParam;
+
 /** Clock recovery function parameter */
 
 typedef struct
@@ -296,6 +412,7 @@ typedef struct
     AsActivateOutputMixer   act_param;
     AsDeactivateOutputMixer deact_param;
     AsFrameTermFineControl  fterm_param;
+    AsSetPostFilterParam    pfparam_param;
   };
 
 } OutputMixerCommand;
@@ -367,6 +484,39 @@ bool AS_SendDataOutputMixer(FAR AsSendDataOutputMixer *sendparam);
 
 bool AS_FrameTermFineControlOutputMixer(uint8_t handle, FAR AsFrameTermFineControl *ftermparam);
 
+/**
+ * @brief Set postfilter parameter
+ *
+ * Parameters are kept while the output mixer is activated and also
+ * applied to following streams. When the postfilter is not enabled
+ * by #AS_ActivateOutputMixer, this has no effect.
+ *
+ * @param[in] handle: Handle of OutputMixer
+ * @param[in] pfparam: Postfilter parameter
+ *
+ * @retval     true  : success
+ * @retval     false : failure
+ */
+
+bool AS_SetPostFilterParamOutputMixer(uint8_t handle,
+                                      FAR AsSetPostFilterParam *pfparam);
+
+/**
+ * @brief Notify fill level of source buffer
+ *
+ * Used by automatic clock recovery (#OutputMixAutoAdjust). Data which
+ * is buffered before the player (e.g. ES received from network) is
+ * added to the level of output path. Call whenever the level changes.
+ *
+ * @param[in] handle: Handle of OutputMixer
+ * @param[in] level: Buffered data in samples
+ *
+ * @retval     true  : success
+ * @retval     false : failure
+ */
+
+bool AS_SetSourceLevelOutputMixer(uint8_t handle, uint32_t level);
+
 /**
  * @brief Deactivate audio output mixer
  *
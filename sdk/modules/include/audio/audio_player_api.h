@@ -137,6 +137,14 @@ typedef enum
 
   AsPlayerEventSetGain,
 
+  /*! \brief Set next stream */
+
+  AsPlayerEventSetNext,
+
+  /*! \brief Switched to next stream (Notified only to callback) */
+
+  AsPlayerEventNextStream,
+
 } AsPlayerEvent;
 
 /** player id */
@@ -239,6 +247,13 @@ typedef enum
   /*! \brief Adjust to the - direction */
 
   OutputMixDelay = 1,
+
+  /*! \brief Track drift automatically by fractional resampling.
+   *         times is target fill level in samples (0: level at start).
+   *         (Requires CONFIG_AUDIOUTILS_OUTPUTMIX_AUTO_CLKRCV)
+   */
+
+  OutputMixAutoAdjust = 2,
 } AsClkRecoveryDirection;
 
 /**< Decodec PCM data send path  */
@@ -513,6 +528,54 @@ typedef struct
 
 } AsRequestNextParam;
 
+/** Set next stream (AS_SetNextPlayer) parameter
+ *  (Requires CONFIG_AUDIOUTILS_PLAYER_GAPLESS)
+ */
+
+typedef struct
+{
+  /*! \brief [in] Input device handler of next stream
+   *
+   * Must be other SimpleFifo than the one of current stream.
+   * ES of next stream can be written to it before current stream ends.
+   */
+
+  AsPlayerInputDeviceHdlrForRAM *ram_handler;
+
+  /*! \brief [in] Channels of next stream
+   *
+   * Use #AsInitPlayerChannelNumberIndex enum type
+   */
+
+  uint8_t  channel_number;
+
+  /*! \brief [in] Bit length of next stream
+   *
+   * Use #AsInitPlayerBitLength enum type
+   */
+
+  uint8_t  bit_length;
+
+  /*! \brief [in] Codec type of next stream
+   *
+   * Use #AsInitPlayerCodecType enum type
+   */
+
+  uint8_t  codec_type;
+
+  /*! \brief [in] reserved */
+
+  uint8_t  reserved;
+
+  /*! \brief [in] Sampling rate of next stream
+   *
+   * Use #AsInitPlayerSamplingRateIndex enum type
+   */
+
+  uint32_t sampling_rate;
+
+} AsSetNextPlayerParam;
+
 /** PlayerCommand definition */
 
 typedef struct
@@ -553,6 +616,12 @@ typedef struct
      */
   
     AsSetGainParam set_gain_param;
+
+    /*! \brief [in] for SetNext
+     * (Object Interface==AS_SetNextPlayer)
+     */
+
+    AsSetNextPlayerParam set_next_param;
   
     /*! \brief [in] for deactivate player
      * (header.command_code==#AUDCMD_SETREADYSTATUS)
@@ -746,6 +815,26 @@ bool AS_SetPlayerGain(AsPlayerId id, FAR AsSetGainParam *gainparam);
 
 bool AS_RequestNextPlayerProcess(AsPlayerId id, FAR AsRequestNextParam *nextparam);
 
+/**
+ * @brief Set next stream of (sub)player for gapless playback
+ *
+ * Call this after the last ES of current stream was written to its
+ * SimpleFifo. When the SimpleFifo becomes empty, the player continues
+ * with the next stream instead of underflow. If codec type, channels,
+ * bit length and sampling rate are the same as current stream, the
+ * decoder keeps running and no gap is inserted. Otherwise the decoder
+ * is stopped and restarted automatically.
+ * Switching is notified by #AsPlayerEventNextStream to the callback
+ * given at activation. Accepted only while playing.
+ *
+ * @param[in] nextparam: Parameters of next stream
+ *
+ * @retval     true  : success
+ * @retval     false : failure
+ */
+
+bool AS_SetNextPlayer(AsPlayerId id, FAR AsSetNextPlayerParam *nextparam);
+
 /**
  * @brief Deactivate (sub)player
  *
@@ -766,6 +855,34 @@ bool AS_DeactivatePlayer(AsPlayerId id, FAR AsDeactivatePlayer *deactparam);
 
 bool AS_DeletePlayer(AsPlayerId id);
 
+/**
+ * @brief Load decoder DSP of a codec in advance
+ *
+ * The decoder is kept resident and used by next initialization of
+ * (sub)player for the codec, so that loading of DSP from file system
+ * is skipped. Decoders unloaded by player are also kept resident up to
+ * CONFIG_AUDIOUTILS_DSP_CACHE_NUM. Requires CONFIG_AUDIOUTILS_DSP_CACHE.
+ *
+ * @param[in] codec_type: Codec type of decoder (#AS_CODECTYPE_MP3 etc.)
+ * @param[in] dsp_path: Path of DSP images. NULL for default path.
+ *
+ * @retval     true  : success
+ * @retval     false : failure
+ */
+
+bool AS_PreloadPlayerCodec(uint8_t codec_type, FAR const char *dsp_path);
+
+/**
+ * @brief Unload all resident decoder DSPs
+ *
+ * Decoders in use by players are not affected.
+ *
+ * @retval     true  : success
+ * @retval     false : failure
+ */
+
+bool AS_PurgePlayerCodec(void);
+
 #endif  /* __MODULES_INCLUDE_AUDIO_AUDIO_PLAYER_API_H */
 /**
  * @}
@@ -148,6 +148,10 @@ typedef enum
   /*! \brief RAM */
 
   AS_SETRECDR_STS_OUTPUTDEVICE_RAM,
+
+  /*! \brief File (CONFIG_AUDIOUTILS_RECORDER_FILE_SINK) */
+
+  AS_SETRECDR_STS_OUTPUTDEVICE_FILE,
   AS_SETRECDR_STS_OUTPUTDEVICE_NUM
 } AsSetRecorderStsOutputDevice;
 
@@ -211,6 +215,135 @@ typedef enum
 
 typedef void (*AudioSimpleFifoWriteDoneCallbackFunction)(uint32_t size);
 
+/** Statistics of file sink
+ *
+ * Updated by the writer thread of file sink while recording.
+ * Cleared at #AUDCMD_STARTREC.
+ */
+
+typedef struct
+{
+  /*! \brief [out] Total size written to file (bytes, without header) */
+
+  uint64_t written_size;
+
+  /*! \brief [out] Number of write calls */
+
+  uint32_t write_num;
+
+  /*! \brief [out] Maximum time of one write call (usec) */
+
+  uint32_t max_write_time;
+
+  /*! \brief [out] Average time of one write call (usec) */
+
+  uint32_t avg_write_time;
+
+  /*! \brief [out] Number of writes which exceeded stall threshold */
+
+  uint32_t stall_num;
+
+  /*! \brief [out] Maximum size of data waiting in buffer (bytes) */
+
+  uint32_t max_buffered_size;
+
+  /*! \brief [out] errno of failed file access, 0 if no error */
+
+  int32_t error;
+} AsRecorderFileSinkStats;
+
+/** Container written by file sink
+ * (used in AsRecorderFileSinkParam)
+ */
+
+typedef enum
+{
+  /*! \brief Encoded data only */
+
+  AS_RECORDER_FILE_SINK_CONTAINER_NONE = 0,
+
+  /*! \brief WAV (RIFF, or RF64 over 4GB). Only for LPCM. */
+
+  AS_RECORDER_FILE_SINK_CONTAINER_WAV,
+  AS_RECORDER_FILE_SINK_CONTAINER_NUM
+} AsRecorderFileSinkContainer;
+
+/** File sink parameter
+ * (used in AsRecorderOutputDeviceHdlr)
+ *
+ * Encoded data is stored to buffer and written to file by a writer
+ * thread in units of write_size, at file offsets aligned to write_size.
+ * Buffer absorbs latency of the storage. If buffer becomes full,
+ * recording stops with overflow state.
+ */
+
+typedef struct
+{
+  /*! \brief [in] Path of output file
+   *
+   * File is created (or truncated) at #AUDCMD_STARTREC.
+   */
+
+  const char *path;
+
+  /*! \brief [in] Buffer size (bytes)
+   *
+   * Rounded up to multiple of write_size.
+   * 0 means CONFIG_AUDIOUTILS_RECORDER_FILE_SINK_BUFFER_SIZE.
+   */
+
+  uint32_t buffer_size;
+
+  /*! \brief [in] Size of one write (bytes)
+   *
+   * Set cluster size of file system or its multiple. Must be power of 2.
+   * 0 means CONFIG_AUDIOUTILS_RECORDER_FILE_SINK_WRITE_SIZE.
+   */
+
+  uint32_t write_size;
+
+  /*! \brief [in] Size to preallocate file (bytes), 0 for none
+   *
+   * File is truncated to actual size at #AUDCMD_STOPREC.
+   */
+
+  uint32_t prealloc_size;
+
+  /*! \brief [in] Size reserved for container header (bytes)
+   *
+   * Encoded data is written after this area, which is filled by 0.
+   * Application writes the header after #AUDCMD_STOPREC.
+   * Not used if container is not #AS_RECORDER_FILE_SINK_CONTAINER_NONE.
+   */
+
+  uint32_t header_size;
+
+  /*! \brief [in] Stall threshold of one write (msec), 0 for no check */
+
+  uint32_t stall_threshold;
+
+  /*! \brief [out] Statistics, NULL if not used */
+
+  AsRecorderFileSinkStats *stats;
+
+  /*! \brief [in] Container of output file
+   *
+   * Use #AsRecorderFileSinkContainer enum type.
+   * Header is written by file sink and updated at #AUDCMD_STOPREC.
+   */
+
+  uint8_t container;
+
+  /*! \brief [in] Interval of updating header (number of writes)
+   *
+   * Header is updated by the size written so far and the file is
+   * flushed to media, so that the file is readable if recording is
+   * interrupted. 0 means only at #AUDCMD_STOPREC.
+   */
+
+  uint32_t header_update_interval;
+} AsRecorderFileSinkParam;
+
 /** internal of output_device_handler
  * (used in AsSetRecorderStatusParam) parameter
  */
@@ -220,6 +353,7 @@ typedef struct
   /*! \brief [in] Set SimpleFifo handler
    *
    * Use CMN_SimpleFifoHandle (refer to include file)
+   * Not used for #AS_SETRECDR_STS_OUTPUTDEVICE_FILE.
    */
 
   void *simple_fifo_handler;
@@ -227,9 +361,18 @@ typedef struct
   /*! \brief [in] Set callback function
    *
    * Call this function when SimpleFifo was read
+   * For #AS_SETRECDR_STS_OUTPUTDEVICE_FILE, called from writer thread
+   * with size written to file. NULL is allowed.
    */
 
   AudioSimpleFifoWriteDoneCallbackFunction callback_function;
+
+  /*! \brief [in] Set file sink parameter
+   *
+   * Used only for #AS_SETRECDR_STS_OUTPUTDEVICE_FILE.
+   */
+
+  AsRecorderFileSinkParam *file_sink;
 } AsRecorderOutputDeviceHdlr;
 
 /** SetRecorderStatus Command (#AUDCMD_SETRECORDERSTATUS) parameter */
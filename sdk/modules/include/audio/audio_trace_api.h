@@ -0,0 +1,168 @@
+/****************************************************************************
+ * modules/include/audio/audio_trace_api.h
+ *
+ *   Copyright 2018 Sony Semiconductor Solutions Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Semiconductor Solutions Corporation nor
+ *    the names of its contributors may be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __SONY_APPS_INCLUDE_AUDIOUTIL_AUDIO_TRACE_API_H
+#define __SONY_APPS_INCLUDE_AUDIOUTIL_AUDIO_TRACE_API_H
+
+/**
+ * @defgroup audioutils Audio Utility
+ * @{
+ */
+
+/**
+ * @defgroup audioutils_audio_trace_api Audio Trace API
+ * @{
+ *
+ * @file       audio_trace_api.h
+ * @brief      CXD5602 Audio Trace API
+ * @author     CXD5602 Audio SW Team
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/** Trace points of playback pipeline.
+ *
+ * Each trace point counts its own events from the last
+ * AudioTracePlayStart. Because every stage handles frames in order,
+ * events of the same count (sequence number) belong to the same frame.
+ */
+
+typedef enum
+{
+  /*! \brief Player started (sequence numbers are reset) */
+
+  AudioTracePlayStart = 0,
+
+  /*! \brief Player got ES of a frame */
+
+  AudioTraceEsRead,
+
+  /*! \brief Decode request was sent to DSP */
+
+  AudioTraceDecReq,
+
+  /*! \brief Decode result was received from DSP */
+
+  AudioTraceDecDone,
+
+  /*! \brief Player sent decoded PCM to output mixer */
+
+  AudioTracePcmSend,
+
+  /*! \brief Output mixer received PCM */
+
+  AudioTraceMixIn,
+
+  /*! \brief Output mixer requested rendering */
+
+  AudioTraceRenderReq,
+
+  /*! \brief DMA transfer of a render request completed */
+
+  AudioTraceDmaDone,
+
+  /*! \brief Output underflow was detected */
+
+  AudioTraceUnderflow,
+
+  AudioTraceStageNum
+} AudioTraceStage;
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/****************************************************************************
+ * Inline Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * @brief Record a trace event
+ *
+ * Safe to call from any task. Do not call from interrupt handler.
+ *
+ * @param[in] stage: AudioTraceStage Trace point
+ * @param[in] arg: uint8_t Additional information of the event
+ */
+
+void AS_TraceAudioEvent(AudioTraceStage stage, uint8_t arg);
+
+/**
+ * @brief Print recorded trace events to console
+ *
+ * Output can be analyzed by tools/audiotrace.py.
+ */
+
+void AS_DumpAudioTrace(void);
+
+/**
+ * @brief Discard recorded trace events
+ */
+
+void AS_ClearAudioTrace(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* __SONY_APPS_INCLUDE_AUDIOUTIL_AUDIO_TRACE_API_H */
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
@@ -56,17 +56,77 @@ extern "C"
 #endif
 
 #define DNNRT_IMPLEMENT (0)
+
+/* implement of int8 layers quantized per channel by tools/nnbquant.py */
+
+#define DNNRT_IMPLEMENT_QINT8 (0x51)
 /**
  * @defgroup dnnrt_datatype Data Types
  * @{
  */
 typedef struct dnn_runtime dnn_runtime_t;
 
+/**
+ * RAM used by activations of a dnn_runtime_t object
+ */
+typedef struct dnn_memory_info
+{
+  unsigned long activation_bsize; /**< total size of activation buffers without planning */
+  unsigned long arena_bsize;      /**< size of the arena where activations are packed.
+                                   *   0 if CONFIG_DNN_RT_MEMORY_PLAN is disabled. */
+} dnn_memory_info_t;
+
 struct dnn_runtime
 {
   void *impl_ctx;
+  void *arena;                    /**< activations packed by memory planner */
+  dnn_memory_info_t mem;
+  void *pager;                    /**< parameters read by dnn_nnb_open() */
 };
 
+/**
+ * Configuration of dnn_nnb_open()
+ */
+typedef struct dnn_nnb_config
+{
+  /** RAM for parameters of a .nnb file which cannot be mapped.
+   *  If 0, the whole file is read into RAM. Otherwise, only the graph is
+   *  read into RAM and parameters are read from the file into an LRU
+   *  cache of this size when a function uses them. It must be at least
+   *  the largest total size of parameters of one function. */
+  unsigned long cache_bsize;
+} dnn_nnb_config_t;
+
+/**
+ * .nnb file opened by dnn_nnb_open()
+ */
+typedef struct dnn_nnb
+{
+  nn_network_t *network;          /**< given to dnn_runtime_initialize() */
+  void *impl;
+} dnn_nnb_t;
+
+/**
+ * Configuration of the whole dnnrt subsystem given to dnn_initialize()
+ */
+typedef struct dnn_config
+{
+  /** number of CPUs used for inference including the main core (1 to 6).
+   *  More than 1 requires CONFIG_DNN_RT_MP, and convolution and affine
+   *  are split across ASMP workers running CONFIG_DNN_RT_MP_WORKER_PATH. */
+  unsigned char cpu_num;
+} dnn_config_t;
+
+/**
+ * Execution time of a function executed by dnnrt (CONFIG_DNN_RT_PROFILE)
+ */
+typedef struct dnn_profile
+{
+  unsigned short function;   /**< nn_function_type_t of the function */
+  unsigned char  cpu_num;    /**< number of CPUs the function was split to */
+  unsigned long  usec;       /**< execution time in microseconds */
+} dnn_profile_t;
+
 /** @} dnnrt_datatype */
 
 /********************************************************************************
@@ -80,13 +140,16 @@ struct dnn_runtime
 /**
  * Initialize the whole dnnrt subsystem
  *
- * @param [in] reserved: reserved argument. Currently, this argument must be NULL.
+ * @param [in] config: configuration of dnnrt, or NULL to run on the main core only.
  *
  * @return 0 on success, otherwise returns error code in errno_t.
  *
  * @note this function must be called before any dnn_runtime_t object is initialized.
+ * @note when config->cpu_num is more than 1, ASMP workers are started here
+ *       and all the buffers given to dnnrt (network, inputs) must be
+ *       on the main memory, not on the ASMP shared memory.
  */
-int dnn_initialize (void* reserved);
+int dnn_initialize (dnn_config_t * config);
 
 /**
  * Finalize the whole dnnrt subsystem.
@@ -110,6 +173,10 @@ int dnn_finalize (void);
   *       so applications don't have to give the network object to the other functions except this. <br>
   *       However, the runtime holds reference to the network object. <br>
   *       Applications must NOT free it until dnn_runtime_finalize().
+  * @note -ENOTSUP is returned if the network has a layer quantized by
+  *       tools/nnbquant.py which dnnrt cannot execute, if its parameters
+  *       were written by another version of the tool, or if
+  *       CONFIG_DNN_RT_QUANT is disabled.
   */
 int dnn_runtime_initialize (dnn_runtime_t * rt, const nn_network_t * network);
 
@@ -266,6 +333,67 @@ nn_variable_t *dnn_runtime_output_variable (dnn_runtime_t * rt,
 void *dnn_runtime_output_buffer (dnn_runtime_t * rt,
 				 unsigned char output_index);
 
+/**
+ * Get RAM used by activations of this network
+ *
+ * @param [in,out] rt:   dnnrt_runtime_t object
+ * @param [out]    info: sizes of activation buffers and the arena
+ *
+ * @return 0 on success, otherwise -EINVAL.
+ *
+ * @note with CONFIG_DNN_RT_MEMORY_PLAN, activation buffers whose lifetimes
+ *       do not overlap share the same region of the arena, which is
+ *       allocated in dnn_runtime_initialize().
+ */
+int dnn_runtime_memory_info (dnn_runtime_t * rt, dnn_memory_info_t * info);
+
+/**
+ * Get execution time of each function executed by dnnrt (i.e. convolution
+ * and affine) in the last dnn_runtime_forward().
+ *
+ * @param [in,out] rt:   dnnrt_runtime_t object
+ * @param [out]    prof: array of dnn_profile_t, in the order of execution
+ * @param [in]     num:  length of prof
+ *
+ * @return number of entries stored in prof on success,
+ *         otherwise returns error code in errno_t.
+ *
+ * @note available when CONFIG_DNN_RT_PROFILE is enabled, otherwise -ENOTSUP.
+ */
+int dnn_runtime_profile (dnn_runtime_t * rt, dnn_profile_t * prof, int num);
+
+
+/**
+ * Open a .nnb file for dnn_runtime_initialize()
+ *
+ * @param [out] nnb:    dnn_nnb_t object. nnb->network is the network.
+ * @param [in]  path:   path to the .nnb file
+ * @param [in]  config: configuration, or NULL to use the default (cache_bsize = 0)
+ *
+ * @return 0 on success, otherwise returns error code in errno_t.
+ *
+ * @note The file is used in one of the following ways.
+ *   - If the file system can map it (e.g. romfs on XIP flash), the network
+ *     is used in place and nothing is copied into RAM.
+ *   - If config->cache_bsize is 0, the whole file is read into RAM.
+ *   - Otherwise only the graph is read into RAM. Parameters are read from
+ *     the file when a function uses them, and the file is kept open.
+ * @note with cpu_num more than 1, mapped parameters must be accessible
+ *       from ASMP workers at the same address.
+ */
+int dnn_nnb_open (dnn_nnb_t * nnb, const char *path,
+                  const dnn_nnb_config_t * config);
+
+/**
+ * Close a .nnb file opened by dnn_nnb_open()
+ *
+ * @param [in,out] nnb: dnn_nnb_t object
+ *
+ * @return 0 on success, otherwise returns error code in errno_t.
+ *
+ * @note all the dnn_runtime_t of this network must be finalized before.
+ */
+int dnn_nnb_close (dnn_nnb_t * nnb);
 
 /** @} dnnrt_funcs */
 
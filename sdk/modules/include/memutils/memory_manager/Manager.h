@@ -54,6 +54,9 @@
 
 #include "memutils/common_utils/common_errcode.h"
 #include "memutils/memory_manager/MemPool.h"
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_STATISTICS
+#include "memutils/memory_manager/PoolStats.h"
+#endif
 
 /**
  * @namespace MemMgrLite
@@ -148,7 +151,14 @@ public:
   static PoolAddr  getPoolAddr(PoolId id) { return findPool(id)->getPoolAddr(); }
   static PoolSize  getPoolSize(PoolId id) { return findPool(id)->getPoolSize(); }
   static NumSeg  getPoolNumSegs(PoolId id) { return findPool(id)->getPoolNumSegs(); }
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_SEG_CACHE
+  static NumSeg  getPoolNumAvailSegs(PoolId id) {
+    SegCache* cache = getSegCache(id);
+    return findPool(id)->getPoolNumAvailSegs() + ((cache) ? cache->size() : 0);
+  }
+#else
   static NumSeg  getPoolNumAvailSegs(PoolId id) { return findPool(id)->getPoolNumAvailSegs(); }
+#endif
 #ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_USE_FENCE
   static bool  isPoolFenceEnable(PoolId id) { return findPool(id)->isPoolFenceEnable(); }
 #endif
@@ -160,6 +170,32 @@ public:
 //  void    printInfo(PoolId id);
 #endif
 
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_STATISTICS
+  /* Pool usage statistics of static pools.
+   * The area for the statistics is taken from the rest of the work area
+   * given to createStaticPools(). If it is not enough, the statistics
+   * is not available.
+   */
+
+  /** The getter method for the statistics of a static pool.
+    * @param[in]  id    The pool id.
+    * @param[out] stats The copy of the statistics.
+    * @return ERR_OK  : success
+    * @return ERR_STS : error, the statistics is not available
+    */
+  static err_t  getPoolStats(PoolId id, PoolStats* stats);
+
+  /** Clear the statistics of all static pools.
+    * @return void
+    */
+  static void  resetStats();
+
+  /** Print the statistics of all static pools.
+    * @return void
+    */
+  static void  dumpStats();
+#endif
+
 #ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_USE_FENCE
   /* Verify the fence and return the error detection count. */
 
@@ -197,6 +233,38 @@ private:
     return p;
   }
 
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_SEG_CACHE
+  /* Returns the segment cache of the pool, or NULL if the pool
+   * does not use the cache. Pools shared between CPUs always take
+   * the locked path.
+   */
+
+  static SegCache* getSegCache(PoolId id) {
+    if (id >= CONFIG_MEMUTILS_MEMORY_MANAGER_SEG_CACHE_POOLS) {
+      return NULL;
+    }
+#ifdef USE_MEMMGR_MULTI_CORE
+    if (findPool(id)->getPoolLockId() != NullLockId) {
+      return NULL;
+    }
+#endif
+    return &theManager->m_seg_caches[id];
+  }
+  static void  flushSegCache(PoolId id);
+#endif
+
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_STATISTICS
+  static void  initPoolStats(FastMemAlloc& fma);
+  static PoolStats* getPoolStatsArea(PoolId id) {
+    if (theManager->m_pool_stats == NULL || id >= theManager->m_pool_num) {
+      return NULL;
+    }
+    return &theManager->m_pool_stats[id];
+  }
+
+  friend class MemPool;
+#endif
+
   /* Memory segment allocate/free/get information. */
 
   friend class MemHandleBase;
@@ -221,6 +289,12 @@ private:
   uint32_t  m_fix_fene_num; /* Numver of fence. */
   uint32_t  m_pool_num;     /* Number of pool. */
   MemPool** m_static_pools;
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_SEG_CACHE
+  SegCache  m_seg_caches[CONFIG_MEMUTILS_MEMORY_MANAGER_SEG_CACHE_POOLS];
+#endif
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_STATISTICS
+  PoolStats* m_pool_stats;  /* Statistics of static pools. */
+#endif
 #ifdef USE_MEMMGR_DYNAMIC_POOL
   MemPool*  m_dynamic_pools[NUM_DYN_POOLS];
   RuntimeQue<PoolId, PoolId>  m_pool_no_que; /* 8bytes */
@@ -118,6 +118,9 @@ public:
 
 private:
   friend class MemPool;
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_SIZE_CLASS_POOL
+  friend class SizeClassPool;
+#endif
 
   struct SegInfo {
     PoolId    pool_id;  /* pool ID (1 origin) */
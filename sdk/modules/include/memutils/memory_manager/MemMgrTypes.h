@@ -100,6 +100,8 @@ enum
   /** the type number of fixed pools. (Now only support this type.) */
   BasicType,
   RingBufType,
+  /** the type number of pools with several segment sizes. */
+  SizeClassType,
   /** Number of types. */
   NumPoolTypes  /* number of pool types */
 };
@@ -138,6 +140,20 @@ const CpuId    MaskCpuId = 0x0f;  /* Lower 4 bits are valid. */
 const CpuId    MaxCpuId = MaskCpuId;
 #endif
 
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_SIZE_CLASS_POOL
+/*****************************************************************
+ * Segment Class Attributes of SizeClassType pool (8bytes)
+ *
+ * A SizeClassType pool is carved into the classes in order, so
+ * the classes must be sorted by seg_size in ascending order and
+ * the array is terminated by an entry whose num_segs is 0.
+ *****************************************************************/
+struct SegClassAttr {
+  PoolSize  seg_size;  /* segment size of the class (bytes) */
+  NumSeg    num_segs;  /* number of segments of the class */
+}; /* struct SegClassAttr */
+#endif
+
 /*****************************************************************
  * Memory Pool Attributes (12 or 16bytes)
  *****************************************************************/
@@ -153,6 +169,9 @@ struct PoolAttr {
 #endif
   PoolAddr  addr;    /* pool address */
   PoolSize  size;    /* pool size (bytes) */
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_SIZE_CLASS_POOL
+  const SegClassAttr* seg_classes; /* segment classes (SizeClassType only) */
+#endif
 
 #ifdef USE_MEMMGR_DEBUG_OUTPUT
   void printInfo(bool newline = true) const {
@@ -37,6 +37,9 @@
 
 #include "memutils/memory_manager/RuntimeQue.h"
 #include "memutils/memory_manager/MemMgrTypes.h"
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_SEG_CACHE
+#include "memutils/memory_manager/SegCache.h"
+#endif
 
 /* Virtual function is prohibited for the following reason.
  * - Text Non-shared multicore can not use virtual function.
@@ -100,6 +103,9 @@ protected:
    */
 
 	MemHandleProxy	allocSeg();
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_SEG_CACHE
+	MemHandleProxy	allocSeg(SegCache& cache);
+#endif
 
   /* Subtract the reference counter and return the segment
    * if there is no reference.
@@ -107,6 +113,25 @@ protected:
    */
 
 	void	freeSeg(MemHandleBase& mh);
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_SEG_CACHE
+	void	freeSeg(MemHandleBase& mh, SegCache& cache);
+
+  /* Return all the segments held by the cache to the pool.
+   * Exclusive control should be done on the caller side.
+   */
+
+	void	flushSegCache(SegCache& cache);
+#endif
+
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_STATISTICS
+  /* Update the statistics when a segment is taken from or
+   * returned to the pool.
+   */
+
+	void	statAllocSeg(NumSeg seg_no);
+	void	statFreeSeg(NumSeg seg_no);
+	void	statAllocFail();
+#endif
 
 protected:
   /* In the case of a static pool, it points to the corresponding part
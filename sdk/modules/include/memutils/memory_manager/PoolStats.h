@@ -0,0 +1,70 @@
+/****************************************************************************
+ * modules/include/memutils/memory_manager/PoolStats.h
+ *
+ *   Copyright 2018 Sony Semiconductor Solutions Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Semiconductor Solutions Corporation nor
+ *    the names of its contributors may be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+#ifndef POOLSTATS_H_INCLUDED
+#define POOLSTATS_H_INCLUDED
+
+#include "memutils/memory_manager/MemMgrTypes.h"
+
+namespace MemMgrLite {
+
+/** Number of bins of the segment hold time histogram.
+ *  Bin 0 counts hold times less than 1ms, bin n (n > 0) counts
+ *  hold times in [2^(n-1), 2^n) ms, and the last bin counts the rest.
+ */
+#define MEMMGR_HOLD_TIME_HIST_NUM  8
+
+/*****************************************************************
+ * Memory Pool Statistics (60bytes)
+ *****************************************************************/
+/**
+ * @struct PoolStats
+ * @brief Usage statistics of a memory pool.
+ *        Counters are updated without lock and are approximate
+ *        while segments are allocated and freed concurrently.
+ */
+struct PoolStats {
+  uint32_t  alloc_cnt;      /**< number of segments allocated */
+  uint32_t  free_cnt;       /**< number of segments returned to the pool */
+  uint32_t  fail_cnt;       /**< number of allocations failed by ERR_MEM_EMPTY */
+  uint32_t  start_time;     /**< time the statistics was reset (ms) */
+  uint32_t  max_hold_time;  /**< longest segment hold time (ms) */
+  uint32_t  hold_time_hist[MEMMGR_HOLD_TIME_HIST_NUM]; /**< hold time histogram */
+  uint32_t* alloc_time;     /**< allocated time of each segment (ms). NULL if no area */
+  NumSeg    min_avail_segs; /**< watermark of available segments */
+}; /* struct PoolStats */
+
+} /* namespace MemMgrLite */
+
+#endif /* POOLSTATS_H_INCLUDED */
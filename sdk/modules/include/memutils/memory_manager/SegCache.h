@@ -0,0 +1,140 @@
+/****************************************************************************
+ * modules/include/memutils/memory_manager/SegCache.h
+ *
+ *   Copyright 2018 Sony Semiconductor Solutions Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Semiconductor Solutions Corporation nor
+ *    the names of its contributors may be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+#ifndef SEGCACHE_H_INCLUDED
+#define SEGCACHE_H_INCLUDED
+
+#include "memutils/common_utils/common_assert.h"
+#include "memutils/memory_manager/MemMgrTypes.h"
+
+namespace MemMgrLite {
+
+/*****************************************************************
+ * Segment magazine
+ *
+ * A LIFO of up to Depth free segment numbers, used by one context
+ * at a time. A context owns the magazine with a single
+ * compare-and-swap and never waits for it, so it is safe from both
+ * task and ISR context. While owned, the magazine is accessed
+ * without any atomic operation.
+ *****************************************************************/
+class SegMagazine {
+public:
+  static const uint32_t Depth = CONFIG_MEMUTILS_MEMORY_MANAGER_SEG_CACHE_DEPTH;
+
+  /* Number of segments moved between the pool and the magazine
+   * at once when the magazine is refilled or drained.
+   */
+
+  static const uint32_t BatchSize = (Depth + 1) / 2;
+
+  void clear() {
+    m_count = 0;
+    __atomic_store_n(&m_owner, 0, __ATOMIC_RELEASE);
+  }
+
+  /* Own the magazine. Returns false if another context owns it. */
+
+  bool tryAcquire() {
+    uint32_t expected = 0;
+    return __atomic_compare_exchange_n(&m_owner, &expected, 1, false,
+                                       __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+  }
+
+  void release() { __atomic_store_n(&m_owner, 0, __ATOMIC_RELEASE); }
+
+  /* The following are called by the owner only. */
+
+  bool   empty() const { return m_count == 0; }
+  bool   full() const { return m_count == Depth; }
+  NumSeg pop() { return m_segs[--m_count]; }
+  void   push(NumSeg seg_no) { m_segs[m_count++] = seg_no; }
+
+  /* Number of cached segments, for statistics from any context. */
+
+  uint32_t size() const { return __atomic_load_n(&m_count, __ATOMIC_RELAXED); }
+
+private:
+  uint32_t m_owner;
+  uint32_t m_count;
+  NumSeg   m_segs[Depth];
+}; /* class SegMagazine */
+
+/*****************************************************************
+ * Segment cache of a pool
+ *
+ * Magazine 0 is used by interrupt handlers, and the others by tasks
+ * selected by the task ID, so each context usually finds its own
+ * magazine free. When the magazine is owned by the context which was
+ * interrupted (or by another task of the same slot), the caller goes
+ * to the pool under the lock instead.
+ *****************************************************************/
+class SegCache {
+public:
+  static const uint32_t NumMagazines =
+    CONFIG_MEMUTILS_MEMORY_MANAGER_SEG_CACHE_MAGAZINES;
+
+  void clear() {
+    for (uint32_t i = 0; i < NumMagazines; ++i) {
+      m_magazines[i].clear();
+    }
+  }
+
+  /* Own the magazine of the calling context. Returns NULL if it is
+   * owned by another context.
+   */
+
+  SegMagazine* acquire(bool is_task, uint32_t task_id) {
+    uint32_t i = (is_task && NumMagazines > 1) ?
+      1 + task_id % (NumMagazines - 1) : 0;
+    return m_magazines[i].tryAcquire() ? &m_magazines[i] : NULL;
+  }
+
+  SegMagazine& magazine(uint32_t i) { return m_magazines[i]; }
+
+  uint32_t size() const {
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < NumMagazines; ++i) {
+      n += m_magazines[i].size();
+    }
+    return n;
+  }
+
+private:
+  SegMagazine m_magazines[NumMagazines];
+}; /* class SegCache */
+
+} /* namespace MemMgrLite */
+
+#endif /* SEGCACHE_H_INCLUDED */
@@ -181,6 +181,99 @@ public:
   /* Transmission of message packet.(non task context, address range parameter) */
   static err_t sendIsr(MsgQueId dest, MsgPri pri, MsgType type, MsgQueId reply, const void* param, size_t param_size);
 
+  /* Transmission of multiple message packets.(task context, with parameter) */
+  /** Send num Objects to another task at once.
+   *  All packets are queued under one lock and the receiver is woken
+   *  up once. If the queue does not have space for all of them,
+   *  nothing is sent and ERR_QUE_FULL is returned.
+   *  @param[in] dest   Destination id
+   *  @param[in] pri    Priority
+   *  @param[in] type   Message Type
+   *  @param[in] reply  Reply id
+   *  @param[in] params Array of objects to send
+   *  @param[in] num    Number of objects
+   *  @return err_t error code.
+   */
+  template<typename T>
+  static err_t sendBatch(MsgQueId dest, MsgPri pri, MsgType type, MsgQueId reply, const T* params, uint16_t num)
+    {
+      FAR MsgQueBlock* que;
+      err_t            err_code = ERR_OK;
+
+      err_code = referMsgQueBlock(dest, &que);
+      if (err_code == ERR_OK)
+        {
+          return que->sendBatch(pri, type, reply, MsgPacket::MsgFlagWaitParam, params, num);
+        }
+
+      return err_code;
+    }
+
+  /* Transmission of multiple message packets.(non task context, with parameter) */
+  template<typename T>
+  static err_t sendBatchIsr(MsgQueId dest, MsgPri pri, MsgType type, MsgQueId reply, const T* params, uint16_t num)
+    {
+      FAR MsgQueBlock* que;
+      err_t            err_code = ERR_OK;
+
+      err_code = referMsgQueBlock(dest, &que);
+      if (err_code == ERR_OK)
+        {
+          return que->sendBatchIsr(pri, type, reply, params, num);
+        }
+
+      return err_code;
+    }
+
+#ifdef CONFIG_MEMUTILS_MESSAGE_REF_PARAM
+  /* Transmission of message packet.(task context, segment reference) */
+  /** Send a segment to another task without copying its contents.
+   *  Only the MemHandle travels through the queue, so the queue element
+   *  needs room for a 4 bytes parameter regardless of the payload size.
+   *  The receiver gets the payload by MsgPacket::moveRefParam() or
+   *  MsgPacket::peekRefParam(). The reference count of the segment
+   *  keeps it alive until both sides released their handles.
+   *  @param[in] dest   Destination id
+   *  @param[in] pri    Priority
+   *  @param[in] type   Message Type
+   *  @param[in] reply  Reply id
+   *  @param[in] mh     Handle of the segment holding the payload
+   *  @return err_t error code.
+   */
+  static err_t sendRef(MsgQueId dest, MsgPri pri, MsgType type, MsgQueId reply, const MemMgrLite::MemHandle& mh);
+
+  /* Transmission of message packet.(task context, payload copied to a segment) */
+  /** Place param in a segment allocated from pool and send its handle.
+   *  T is not destructed when the segment is released,
+   *  so it must be trivially destructible (descriptors, PODs).
+   *  @param[in] dest   Destination id
+   *  @param[in] pri    Priority
+   *  @param[in] type   Message Type
+   *  @param[in] reply  Reply id
+   *  @param[in] pool   Pool to allocate the segment from
+   *  @param[in] param  Object to send
+   *  @return err_t error code.
+   */
+  template<typename T>
+  static err_t sendRef(MsgQueId dest, MsgPri pri, MsgType type, MsgQueId reply, MemMgrLite::PoolId pool, const T& param)
+    {
+      MemMgrLite::MemHandle mh;
+
+      if (mh.allocSeg(pool, sizeof(T)) != ERR_OK)
+        {
+          return ERR_MEM_EMPTY;
+        }
+
+      new (mh.getVa()) T(param);
+
+      /* The local handle is released on return, and the one in the queue
+       * holds the segment.
+       */
+
+      return sendRef(dest, pri, type, reply, mh);
+    }
+#endif
+
   /* Notify message reception (call this API from inter-processor communication interrupt handler) */
   static err_t notifyRecv(MsgQueId dest);
 
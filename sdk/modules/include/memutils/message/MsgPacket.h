@@ -36,12 +36,16 @@
 #ifndef MSG_PACKET_H_INCLUDED
 #define MSG_PACKET_H_INCLUDED
 
+#include <sdk/config.h>
 #include <new>			/* placement new */
 #include <stdio.h>		/* printf */
 #include "memutils/common_utils/common_types.h"	/* MIN, uintN_t */
 #include "memutils/common_utils/common_assert.h"	/* D_ASSERT */
 //#include "SpinLock.h"		/* MEMORY_BARRIER */
 #include "memutils/message/type_holder.h"	/* TypeHolder */
+#ifdef CONFIG_MEMUTILS_MESSAGE_REF_PARAM
+#include "memutils/memory_manager/MemHandle.h"	/* MemHandle */
+#endif
 
 #ifdef USE_MULTI_CORE
 #include "get_cpu_id.h"		/* GET_CPU_ID */
@@ -87,6 +91,11 @@ public:
   /* Parameter is formatted with type. */
 
 	static const MsgFlags MsgFlagTypedParam = 0x40;
+
+  /* Parameter is a MemHandle of the segment holding the payload. */
+
+	static const MsgFlags MsgFlagRefParam = 0x20;
+
 	MsgPacketHeader(MsgType type, MsgQueId reply, MsgFlags flags, uint16_t size = 0) :
 		m_type(type),
 		m_reply(reply),
@@ -99,6 +108,7 @@ public:
 	MsgCpuId getSrcCpu() const { return m_src_cpu; }
 	MsgFlags getFlags() const { return m_flags; }
 	uint16_t getParamSize() const { return m_param_size; }
+	bool     isRefParam() const { return (m_flags & MsgFlagRefParam) != 0; }
 	void     popParamNoDestruct() { m_param_size = 0; }
 
 protected:
@@ -178,6 +188,30 @@ public:
 		m_param_size = 0;
 	}
 
+#ifdef CONFIG_MEMUTILS_MESSAGE_REF_PARAM
+  /* Take the handle of the segment holding the payload of a message
+   * sent by MsgLib::sendRef. The payload stays in the segment until
+   * the last handle referring to it is released.
+   */
+
+	MemMgrLite::MemHandle moveRefParam() {
+		D_ASSERT2(isRefParam(), AssertParamLog(AssertIdBadParam, m_flags));
+		return moveParam<MemMgrLite::MemHandle>();
+	}
+
+  /* Refer to the payload of a message sent by MsgLib::sendRef
+   * without taking the handle. Valid until the packet is popped.
+   */
+
+	template<typename T>
+	const T& peekRefParam() const {
+		D_ASSERT2(isRefParam(), AssertParamLog(AssertIdBadParam, m_flags));
+		const MemMgrLite::MemHandle& mh = peekParam<MemMgrLite::MemHandle>();
+		D_ASSERT2(sizeof(T) <= mh.getSize(), AssertParamLog(AssertIdSizeError, sizeof(T), mh.getSize()));
+		return *static_cast<const T*>(mh.getVa());
+	}
+#endif
+
 	void dump() const {
 		printf("T:%04x, R:%04x, C:%02x, F:%02x, S:%04x, P:",
 			m_type, m_reply, m_src_cpu, m_flags, m_param_size);
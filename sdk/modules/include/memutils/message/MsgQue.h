@@ -81,6 +81,21 @@ public:
 
 	MsgPacket* frontMsg() { return &front<MsgPacket>(); }
 	MsgPacket* backMsg()  { return &back<MsgPacket>(); }
+
+  /* Refer to the Nth (head is 0) message packet of the queue. */
+
+	MsgPacket* msgAt(uint16_t n) { return &writable_at<MsgPacket>(n); }
+
+  /* Get the message packet stored after the specified one.
+   * The position is calculated from the address, so it stays valid
+   * even if packets are popped from the head of the queue meanwhile.
+   */
+
+	MsgPacket* nextMsg(MsgPacket* msg) const {
+		uint8_t* next = reinterpret_cast<uint8_t*>(msg) + elem_size();
+		return (next == static_cast<uint8_t*>(getAddr(capacity()))) ?
+			static_cast<MsgPacket*>(getAddr(0)) : reinterpret_cast<MsgPacket*>(next);
+	}
 }; /* class MsgQue */
 
 #endif /* MSG_QUE_H_INCLUDED */
@@ -85,10 +85,28 @@ public:
    */
   err_t recv(uint32_t ms, FAR MsgPacket **packet);
 
+  /** Receive up to max Objects at once.
+   * Wait for the first packet as recv() does, then take the packets
+   * already ready behind it in the same priority queue without waiting.
+   * The received packets must be discarded with popBatch(*num).
+   * If the OS layer has no Chateau_PollingWaitSemaphore(),
+   * one packet is received per call.
+   * @param[in] ms timeout time(millisecond)
+   * @param[out] **packets array of received message packets
+   * @param[in] max number of elements of packets
+   * @param[out] *num number of received packets
+   * @return err_t error code
+   */
+  err_t recvBatch(uint32_t ms, FAR MsgPacket **packets, uint16_t max, FAR uint16_t *num);
+
   /* Discard message packet. */
 
   err_t pop();
 
+  /* Discard message packets received by recvBatch. */
+
+  err_t popBatch(uint16_t num);
+
   /* Get CPU-ID of queue owner (recipient). */
 
 	MsgCpuId getOwner() const { return m_owner; }
@@ -154,6 +172,23 @@ protected:
 	template<typename T>
 	err_t sendIsr(MsgPri pri, MsgType type, MsgQueId reply, const T& param);
 
+  /* Send multiple messages under a single lock and semaphore update.
+   * (All or nothing. If the queue does not have enough space,
+   * nothing is sent)
+   */
+
+	template<typename T>
+	err_t sendBatch(MsgPri pri, MsgType type, MsgQueId reply, MsgFlags flags,
+			const T* params, uint16_t num);
+
+	template<typename T>
+	err_t sendBatchIsr(MsgPri pri, MsgType type, MsgQueId reply,
+			const T* params, uint16_t num);
+
+  /* Update the total message count for num messages sent from task. */
+
+	void signalSend(uint16_t num);
+
   /* Notify other CPU that sending message.
    * (H/W dependent part. User implements for each CPU)
    */
@@ -475,6 +510,167 @@ err_t MsgQueBlock::sendIsr(MsgPri pri, MsgType type, MsgQueId reply, const T& pa
   return (msg) ? ERR_OK : ERR_QUE_FULL;
 }
 
+/*****************************************************************
+ * Message batch sending process from task context
+ *****************************************************************/
+template<typename T>
+err_t MsgQueBlock::sendBatch(MsgPri pri, MsgType type, MsgQueId reply,
+                             MsgFlags flags, const T* params, uint16_t num)
+{
+  if (params == NULL || num == 0)
+    {
+      return ERR_ARG;
+    }
+
+  /* Check that the message fits in the element size of the queue */
+
+  bool type_check = MSG_PARAM_TYPE_MATCH_CHECK && MsgPacketInfo<T>::typed_param && isOwn();
+  size_t send_size = getSendSize(params[0], type_check);
+  if (send_size > getElemSize(pri))
+    {
+      return ERR_DATA_SIZE;
+    }
+
+  /* Put all packet headers in the queue under one lock. */
+
+  lock();
+
+  if (m_que[pri].rest() < num)
+    {
+      unlock();
+      return ERR_QUE_FULL;
+    }
+
+  MsgPacket* top = NULL;
+  for (uint16_t i = 0; i < num; ++i)
+    {
+      MsgPacket* msg = pushHeader(pri, MsgPacketHeader(type, reply, flags));
+      if (top == NULL)
+        {
+          top = msg;
+        }
+
+      if (isShare())
+        {
+          Dcache_flush_clear(msg, ROUND_UP(sizeof(MsgPacketHeader), CACHE_BLOCK_SIZE));
+        }
+    }
+
+  unlock();
+
+  /* Add parameters after the interrupt is enabled, as send() does.
+   * Packets are followed by address because the receiver may pop
+   * the head of the queue meanwhile.
+   */
+
+  MsgPacket* msg = top;
+  for (uint16_t i = 0; i < num; ++i)
+    {
+      msg->setParam(params[i], type_check);
+
+      if (!MsgPacketInfo<T>::null_param && isShare())
+        {
+          Dcache_flush_clear(msg, ROUND_UP(send_size, CACHE_BLOCK_SIZE));
+        }
+
+      msg = m_que[pri].nextMsg(msg);
+    }
+
+  if (!MsgPacketInfo<T>::null_param && isShare())
+    {
+      cache_sync();
+    }
+
+  DUMP_MSG_SEQ_LOCK(MsgSeqLog('s', m_id, pri, m_que[pri].size(), top));
+
+  signalSend(num);
+
+  return ERR_OK;
+}
+
+/*****************************************************************
+ * Message batch transmission processing from ISR
+ * (Only to non-shared queue owned by own CPU)
+ *****************************************************************/
+template<typename T>
+err_t MsgQueBlock::sendBatchIsr(MsgPri pri, MsgType type, MsgQueId reply,
+                                const T* params, uint16_t num)
+{
+  /* Transmission from the ISR to the shared queue is prohibited. */
+
+  D_ASSERT2(isShare() == false, AssertParamLog(AssertIdBadMsgQueState, m_id));
+
+  if (params == NULL || num == 0)
+    {
+      return ERR_ARG;
+    }
+
+  /* Check that the message fits in the element size of the queue. */
+
+  bool type_check = MSG_PARAM_TYPE_MATCH_CHECK && MsgPacketInfo<T>::typed_param;
+  if (getSendSize(params[0], type_check) > getElemSize(pri))
+    {
+      return ERR_DATA_SIZE;
+    }
+
+  if (m_que[pri].rest() < num)
+    {
+      return ERR_QUE_FULL;
+    }
+
+  for (uint16_t i = 0; i < num; ++i)
+    {
+      MsgPacket* msg = pushHeader(pri, MsgPacketHeader(type, reply, MsgPacket::MsgFlagNull));
+      msg->setParam(params[i], type_check);
+      DUMP_MSG_SEQ(MsgSeqLog('i', m_id, pri, m_que[pri].size(), msg));
+    }
+
+  /* Update total message count.
+   * Dispatch is delayed until the ISR exits, so the receiver task
+   * wakes up only once for the whole batch.
+   */
+
+  for (uint16_t i = 0; i < num; ++i)
+    {
+      Chateau_SignalSemaphoreIsr(m_count_sem);
+    }
+
+  return ERR_OK;
+}
+
+/*****************************************************************
+ * Update the total message count for num messages sent from task
+ *****************************************************************/
+inline void MsgQueBlock::signalSend(uint16_t num)
+{
+  if (isShare() == false || isOwn())
+    {
+      /* Signal all counts with dispatch disabled, so that the receiver
+       * task is switched in only once for the whole batch.
+       */
+
+      uint32_t context = 0;
+
+      Chateau_LockInterrupt(&context);
+      while (num--)
+        {
+          Chateau_SignalSemaphoreTask(m_count_sem);
+        }
+      Chateau_UnlockInterrupt(&context);
+    }
+  else
+    {
+      /* Request to update the total number of messages
+       * by inter-CPU communication.
+       */
+
+      while (num--)
+        {
+          notifySend(m_owner, m_id);
+        }
+    }
+}
+
 /*****************************************************************
  * Insert a message packet header at the end of the queue
  * and return that address
@@ -633,6 +829,66 @@ retry:  /* Wait to receive. */
   return ERR_OK;
 }
 
+/*****************************************************************
+ * Receive multiple message packets
+ *****************************************************************/
+inline err_t MsgQueBlock::recvBatch(uint32_t ms, FAR MsgPacket **packets,
+                                    uint16_t max, FAR uint16_t *num)
+{
+  if (packets == NULL || num == NULL || max == 0)
+    {
+      return ERR_ARG;
+    }
+
+  /* Wait for the first packet. */
+
+  err_t err = recv(ms, &packets[0]);
+  if (err != ERR_OK)
+    {
+      return err;
+    }
+
+  uint16_t cnt = 1;
+
+  /* Take the following packets of the same queue as long as
+   * their parameters are written and the count semaphore
+   * can be taken without waiting. Without a polling wait in the OS
+   * layer, packets are received one by one.
+   */
+
+#ifdef Chateau_PollingWaitSemaphore
+  if (isShare())
+    {
+      lock();
+    }
+
+  for (; cnt < max && cnt < m_cur_que->size(); ++cnt)
+    {
+      MsgPacket* msg = m_cur_que->msgAt(cnt);
+      if (msg->getFlags() & MsgPacket::MsgFlagWaitParam)
+        {
+          break;
+        }
+
+      if (!Chateau_PollingWaitSemaphore(m_count_sem))
+        {
+          break;
+        }
+
+      packets[cnt] = msg;
+    }
+
+  if (isShare())
+    {
+      unlock();
+    }
+#endif
+
+  *num = cnt;
+
+  return ERR_OK;
+}
+
 /*****************************************************************
  * Discard message packet
  *****************************************************************/
@@ -688,6 +944,68 @@ inline err_t MsgQueBlock::pop()
   return ERR_OK;
 }
 
+/*****************************************************************
+ * Discard message packets received by recvBatch
+ *****************************************************************/
+inline err_t MsgQueBlock::popBatch(uint16_t num)
+{
+  /* Check if own CPU is owned, and check Packet Received */
+
+  if (!(isOwn() && m_cur_que != NULL))
+    {
+      return ERR_STS;
+    }
+
+  if (num == 0 || num > m_cur_que->size())
+    {
+      return ERR_ARG;
+    }
+
+  /* Check that the parameter length of all packets
+   * to be discarded is 0.
+   */
+
+  for (uint16_t i = 0; i < num; ++i)
+    {
+      if (m_cur_que->msgAt(i)->getParamSize() != 0)
+        {
+          return ERR_MEM_BUSY;
+        }
+    }
+
+  lock();
+
+  /* Discard the packets from the queue. (See pop() for cache) */
+
+  for (uint16_t i = 0; i < num; ++i)
+    {
+#if MSG_FILL_VALUE_AFTER_POP == 0x00
+      /* Nothing is written by pop, so the area can be cleared first. */
+
+      if (isShare())
+        {
+          Dcache_clear(m_cur_que->frontMsg(), m_cur_que->elem_size());
+        }
+
+      m_cur_que->pop();
+#else
+      MsgPacket* msg = m_cur_que->frontMsg();
+
+      m_cur_que->pop();
+
+      if (isShare())
+        {
+          Dcache_flush_clear(msg, m_cur_que->elem_size());
+        }
+#endif
+    }
+
+  m_cur_que = NULL; /* Make the packet unreceived state. */
+  unlock();
+
+  return ERR_OK;
+}
+
 /*****************************************************************
  * Lock queue
  *****************************************************************/
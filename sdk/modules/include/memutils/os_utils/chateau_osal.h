@@ -236,6 +236,7 @@ static INLINE size_t Chateau_CountSemaphore(Chateau_sem_handle_t h) {
 
 #define Chateau_GetInterruptMask() (0)
 #define Chateau_IsTaskContext() (getpid() != 0)
+#define Chateau_GetTaskId() (getpid())
 
 #define Chateau_LockInterrupt(pContext)					\
     do {                                                                \
@@ -273,6 +274,7 @@ typedef sem_t	Chateau_sem_handle_t;
 #define Chateau_SignalSemaphoreIsr(h)   F_ASSERT(sem_post(&h)		== 0)
 #define Chateau_TimedWaitSemaphore(h, tm)        (sem_timedwait(&h, &tm)	== 0)
 #define Chateau_WaitSemaphore(h)        (sem_wait(&h)	== 0)
+#define Chateau_PollingWaitSemaphore(h) (sem_trywait(&h)	== 0)
 //static INLINE bool Chateau_TimedWaitSemaphore(Chateau_sem_handle_t h,uint32_t ms) {
 //	if(ms != TIME_FOREVER){
 //		timespec t;
@@ -292,6 +294,7 @@ typedef short	Chateau_sem_handle_t;
 #define Chateau_LockInterruptIsr(pContext)	loc_cpu()
 #define Chateau_UnlockInterruptIsr(pContext)	unl_cpu()
 #define Chateau_IsTaskContext()			1
+#define Chateau_GetTaskId()			0
 #define Chateau_GetInterruptMask()		sns_loc()
 #define Chateau_LockInterrupt(h)		loc_cpu()
 #define Chateau_UnlockInterrupt(h)		unl_cpu()
@@ -496,6 +496,111 @@ static inline size_t CMN_SimpleFifoPeek(
 
 //@}
 
+/*!
+ * @name Direct Access
+ */
+//@{
+/*!
+ * @brief Get the regions of the FIFO buffer that can be written directly.
+ *
+ * The vacant space of the FIFO is returned as (up to) two contiguous
+ * regions in the same form as a peek handle. The writer can fill them
+ * in place, e.g. read() from a file straight into the FIFO, and then
+ * publish the written bytes with CMN_SimpleFifoCommitWrite().
+ *
+ * Only the single writer of the FIFO may call this API.
+ *
+ * @param[in] pHandle Pointer to the control block of the FIFO. NULL
+ *            is NOT allowed.
+ *            - Assertion Failure
+ *              - NULL
+ *
+ * @param[out] pRegions Pointer to the memory in which the writable
+ *             regions are stored. Unused region is cleared with NULL
+ *             and 0. NULL is NOT allowed.
+ *            - Assertion Failure
+ *              - NULL
+ *
+ * @return Total size of the writable regions.
+ */
+size_t CMN_SimpleFifoGetWriteRegions(
+        CMN_SimpleFifoHandle* pHandle,
+        CMN_SimpleFifoPeekHandle* pRegions);
+
+/*!
+ * @brief Publish the data written in the regions got by
+ *        CMN_SimpleFifoGetWriteRegions().
+ *
+ * WP is advanced after the written data is made visible to the
+ * reader (release ordering).
+ *
+ * @param[in] pHandle Pointer to the control block of the FIFO. NULL
+ *            is NOT allowed.
+ *            - Assertion Failure
+ *              - NULL
+ *
+ * @param[in] sz Size of the written data. If it exceeds the vacant
+ *            size, FIFO is kept untouched and the API call fails.
+ *
+ * @return
+ *         - On success, size of committed data
+ *         - On failure, 0
+ */
+size_t CMN_SimpleFifoCommitWrite(
+        CMN_SimpleFifoHandle* pHandle,
+        size_t sz);
+
+/*!
+ * @brief Get the regions of the FIFO buffer that can be read directly.
+ *
+ * All data in the FIFO is returned as (up to) two contiguous regions,
+ * so the reader can parse it in place without copying. The data is
+ * kept in the FIFO until it is released with CMN_SimpleFifoReleaseRead().
+ *
+ * Only the single reader of the FIFO may call this API.
+ *
+ * @param[in] pHandle Pointer to the control block of the FIFO. NULL
+ *            is NOT allowed.
+ *            - Assertion Failure
+ *              - NULL
+ *
+ * @param[out] pRegions Pointer to the memory in which the readable
+ *             regions are stored. Unused region is cleared with NULL
+ *             and 0. NULL is NOT allowed.
+ *            - Assertion Failure
+ *              - NULL
+ *
+ * @return Total size of the readable regions.
+ */
+size_t CMN_SimpleFifoGetReadRegions(
+        const CMN_SimpleFifoHandle* pHandle,
+        CMN_SimpleFifoPeekHandle* pRegions);
+
+/*!
+ * @brief Remove the data read from the regions got by
+ *        CMN_SimpleFifoGetReadRegions().
+ *
+ * RP is advanced after all reads of the released data are completed,
+ * so the writer never overwrites data still being read.
+ *
+ * @param[in] pHandle Pointer to the control block of the FIFO. NULL
+ *            is NOT allowed.
+ *            - Assertion Failure
+ *              - NULL
+ *
+ * @param[in] sz Size of the data to remove. If it exceeds the
+ *            occupied size, FIFO is kept untouched and the API call
+ *            fails.
+ *
+ * @return
+ *         - On success, size of removed data
+ *         - On failure, 0
+ */
+size_t CMN_SimpleFifoReleaseRead(
+        CMN_SimpleFifoHandle* pHandle,
+        size_t sz);
+//@}
+
 /*!
  * @name Manupilation
  */
@@ -735,6 +840,20 @@ size_t CMN_SimpleFifoCopyFromPeekHandleWithSpecificCopier(
  *     CMN_SimpleFifoCopyFromPeekHandle(&peekHandle, dst, szPeekData);
  * 
  *     //
+ *     // Direct access usage example.
+ *     //
+ *     CMN_SimpleFifoPeekHandle regions;
+ *     CMN_SimpleFifoGetWriteRegions(pHandle, &regions);
+ *     size_t len = 0;
+ *     if (regions.m_pChunk[0] != NULL) {
+ *         len = fread(regions.m_pChunk[0], 1, regions.m_szChunk[0], fp); // fill in place
+ *     }
+ *     CMN_SimpleFifoCommitWrite(pHandle, len);
+ *     size_t szRead = CMN_SimpleFifoGetReadRegions(pHandle, &regions);
+ *     // ... parse regions.m_pChunk[0] and regions.m_pChunk[1] in place ...
+ *     CMN_SimpleFifoReleaseRead(pHandle, szRead);
+ *
+ *     //
  *     // Specific copier usage example.
  *     //
  *     CMN_SimpleFifoOfferWithSpecificCopier(pHandle, src, 2, myOwnCopier, NULL); // write
@@ -52,9 +52,15 @@ protected:
 
   /* allocate a memory segment */
   err_t allocSeg(size_t size_for_check, MemHandleProxy &proxy);
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_SEG_CACHE
+  err_t allocSeg(size_t size_for_check, MemHandleProxy &proxy, SegCache& cache);
+#endif
 
 	/* free a memory segment */
 	void 		freeSeg(MemHandleBase& mh);
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_SEG_CACHE
+	void 		freeSeg(MemHandleBase& mh, SegCache& cache);
+#endif
 
 	PoolAddr	getSegAddr(const MemHandleBase& mh) const;
 	PoolSize	getSegSize() const { return getPoolSize() / getPoolNumSegs(); }
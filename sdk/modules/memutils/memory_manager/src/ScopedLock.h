@@ -44,6 +44,8 @@ static uint32_t context;
 static inline bool isDisableInt() { return Chateau_GetInterruptMask(); }
 static inline void disableInt() { if (Chateau_IsTaskContext()) Chateau_LockInterrupt(&context); else Chateau_LockInterruptIsr(&context); }
 static inline void enableInt()  { if (Chateau_IsTaskContext()) Chateau_UnlockInterrupt(&context); else Chateau_UnlockInterruptIsr(&context); }
+static inline bool isTaskContext() { return Chateau_IsTaskContext(); }
+static inline uint32_t getTaskId() { return static_cast<uint32_t>(Chateau_GetTaskId()); }
 } /* namespace MemMgrLite */
 
 namespace MemMgrLite {
@@ -0,0 +1,233 @@
+/****************************************************************************
+ * modules/memutils/memory_manager/src/SizeClassPool.cpp
+ *
+ *   Copyright 2018 Sony Semiconductor Solutions Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Semiconductor Solutions Corporation nor
+ *    the names of its contributors may be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include "FastMemAlloc.h"
+#include "ScopedLock.h"
+#include "memutils/memory_manager/MemHandleBase.h"
+#include "SizeClassPool.h"
+
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_SIZE_CLASS_POOL
+
+namespace MemMgrLite {
+
+/*****************************************************************
+ * Size class pool constructor
+ *****************************************************************/
+SizeClassPool::SizeClassPool(const PoolAttr& attr, FastMemAlloc& fma) :
+  MemPool(attr, fma),
+  m_num_classes(0),
+  m_class_ques(NULL)
+{
+  D_ASSERT(attr.seg_classes);
+
+  uint32_t total_segs = 0;
+  PoolSize total_size = 0;
+
+  for (const SegClassAttr* cls = attr.seg_classes; cls->num_segs != 0; ++cls)
+    {
+      D_ASSERT(cls->seg_size % sizeof(uint32_t) == 0);
+      D_ASSERT(m_num_classes == 0 || (cls - 1)->seg_size < cls->seg_size);
+      total_segs += cls->num_segs;
+      total_size += cls->seg_size * cls->num_segs;
+      ++m_num_classes;
+    }
+  D_ASSERT(total_segs == attr.num_segs);
+  D_ASSERT(total_size <= attr.size);
+
+  if (MemPool::isFailed() || m_num_classes == 0)
+    {
+      return;
+    }
+
+  SegNoQue* ques = static_cast<SegNoQue*>(fma.alloc(sizeof(SegNoQue) * m_num_classes,
+                                                    sizeof(uint32_t)));
+  if (ques == NULL)
+    {
+      return;
+    }
+
+  NumSeg seg_no = 1;
+
+  for (uint32_t i = 0; i < m_num_classes; ++i)
+    {
+      NumSeg num_segs = attr.seg_classes[i].num_segs;
+      void*  area = fma.alloc(sizeof(NumSeg) * num_segs, sizeof(NumSeg));
+      if (area == NULL)
+        {
+          return;
+        }
+
+      new(&ques[i]) SegNoQue(area, num_segs);
+      for (NumSeg n = 0; n < num_segs; ++n)
+        {
+          (void)ques[i].push(seg_no++);
+        }
+    }
+
+  m_class_ques = ques;
+
+#ifdef USE_MEMMGR_DEBUG_OUTPUT
+  printf("SizeClassPool: created. [fma.rest=%08x] classes=%d ", fma.rest(), m_num_classes);
+  attr.printInfo();
+#endif
+}
+
+/*****************************************************************
+ * Size class pool destructor
+ *****************************************************************/
+SizeClassPool::~SizeClassPool()
+{
+#ifdef USE_MEMMGR_DEBUG_OUTPUT
+  printf("~SizeClassPool: PoolId=%d\n", getPoolId());
+#endif
+}
+
+/*****************************************************************
+ * Get a segment handle of the smallest class which can hold
+ * size_for_check. If the class is empty, a larger one is used.
+ *****************************************************************/
+err_t SizeClassPool::allocSeg(size_t size_for_check, MemHandleProxy &proxy)
+{
+  if (size_for_check > m_attr.seg_classes[m_num_classes - 1].seg_size)
+    {
+      return ERR_DATA_SIZE;
+    }
+
+  ScopedLock lock;
+
+  for (uint32_t i = 0; i < m_num_classes; ++i)
+    {
+      if (size_for_check > m_attr.seg_classes[i].seg_size ||
+          m_class_ques[i].empty())
+        {
+          continue;
+        }
+
+      NumSeg seg_no = m_class_ques[i].top();
+      m_class_ques[i].pop();
+      m_seg_no_que.pop();
+
+      D_ASSERT(m_ref_cnt_array[seg_no - 1] == 0);
+      m_ref_cnt_array[seg_no - 1] = 1;
+
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_STATISTICS
+      statAllocSeg(seg_no);
+#endif
+
+      proxy = MemHandleBase::makeMemHandleProxy(getPoolId(), seg_no, 0);
+      return ERR_OK;
+    }
+
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_STATISTICS
+  statAllocFail();
+#endif
+  proxy = 0;
+  return ERR_MEM_EMPTY;
+}
+
+/*****************************************************************
+ * Free a segment of size class pool.
+ * When the last reference is released, the segment number is
+ * returned to the queue of its class.
+ *****************************************************************/
+void SizeClassPool::freeSeg(MemHandleBase& mh)
+{
+  ScopedLock lock;
+
+  NumSeg seg_no = mh.getSegNo();
+  D_ASSERT(seg_no != NullSegNo && seg_no <= getPoolNumSegs());
+
+  if (m_ref_cnt_array[seg_no - 1] == 1)
+    {
+      const SegClassAttr* cls = findSegClass(seg_no, NULL);
+      SegNoQue& que = m_class_ques[cls - m_attr.seg_classes];
+      D_ASSERT(que.full() == false);
+      (void)que.push(seg_no);
+    }
+
+  MemPool::freeSeg(mh);
+}
+
+/*****************************************************************
+ * Get the segment address
+ *****************************************************************/
+PoolAddr SizeClassPool::getSegAddr(const MemHandleBase& mh) const
+{
+  PoolAddr addr;
+  (void)findSegClass(mh.getSegNo(), &addr);
+  return addr;
+}
+
+/*****************************************************************
+ * Get the segment size
+ *****************************************************************/
+PoolSize SizeClassPool::getSegSize(const MemHandleBase& mh) const
+{
+  return findSegClass(mh.getSegNo(), NULL)->seg_size;
+}
+
+/*****************************************************************
+ * Find the class of the segment and, if addr is given, set the
+ * address of the segment to it
+ *****************************************************************/
+const SegClassAttr* SizeClassPool::findSegClass(NumSeg seg_no, PoolAddr* addr) const
+{
+  D_ASSERT(seg_no != NullSegNo && seg_no <= getPoolNumSegs());
+
+  PoolAddr class_addr = getPoolAddr();
+  uint32_t first_no   = 1;
+  const SegClassAttr* cls = m_attr.seg_classes;
+
+  while (seg_no >= first_no + cls->num_segs)
+    {
+      class_addr += cls->seg_size * cls->num_segs;
+      first_no   += cls->num_segs;
+      ++cls;
+      D_ASSERT(cls->num_segs != 0);
+    }
+
+  if (addr)
+    {
+      *addr = class_addr + (seg_no - first_no) * cls->seg_size;
+    }
+
+  return cls;
+}
+
+} /* end of namespace MemMgrLite */
+
+#endif /* CONFIG_MEMUTILS_MEMORY_MANAGER_SIZE_CLASS_POOL */
+
+/* SizeClassPool.cxx */
@@ -0,0 +1,92 @@
+/****************************************************************************
+ * modules/memutils/memory_manager/src/SizeClassPool.h
+ *
+ *   Copyright 2018 Sony Semiconductor Solutions Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Semiconductor Solutions Corporation nor
+ *    the names of its contributors may be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef SIZECLASSPOOL_H_INCLUDED
+#define SIZECLASSPOOL_H_INCLUDED
+
+#include "memutils/common_utils/common_errcode.h"
+#include "memutils/memory_manager/MemPool.h"
+
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_SIZE_CLASS_POOL
+
+namespace MemMgrLite {
+
+/*****************************************************************
+ * Size class memory pool class (24 or 28bytes)
+ *
+ * The pool area is carved into several segment classes of
+ * different sizes (see SegClassAttr). Segment numbers are given
+ * through all classes in order, so a MemHandle is the same as
+ * the one of BasicPool.
+ *****************************************************************/
+class SizeClassPool : public MemPool {
+	friend class Manager;
+protected:
+	SizeClassPool(const PoolAttr& attr, FastMemAlloc& fma);
+	~SizeClassPool();
+
+	bool isFailed() { return MemPool::isFailed() || m_class_ques == NULL; }
+
+  /* allocate a segment of the smallest class which can hold the size */
+  err_t allocSeg(size_t size_for_check, MemHandleProxy &proxy);
+
+	/* free a memory segment */
+	void 		freeSeg(MemHandleBase& mh);
+
+	PoolAddr	getSegAddr(const MemHandleBase& mh) const;
+	PoolSize	getSegSize(const MemHandleBase& mh) const;
+
+private:
+	typedef RuntimeQue<NumSeg, NumSeg>	SegNoQue;
+
+  /* Returns the class of the segment and its address. */
+
+	const SegClassAttr* findSegClass(NumSeg seg_no, PoolAddr* addr) const;
+
+	uint32_t	m_num_classes;
+
+  /* Queues holding usable segment numbers of each class.
+   * MemPool::m_seg_no_que is kept as the whole of usable segments,
+   * so that the common functions of MemPool are available as is.
+   */
+
+	SegNoQue*	m_class_ques;
+}; /* class SizeClassPool */
+
+} /* namespace MemMgrLite */
+
+#endif /* CONFIG_MEMUTILS_MEMORY_MANAGER_SIZE_CLASS_POOL */
+
+#endif /* SIZECLASSPOOL_H_INCLUDED */
@@ -36,6 +36,7 @@
 #include "ScopedLock.h"
 #include "memutils/memory_manager/MemHandleBase.h"
 #include "BasicPool.h"
+#include "SizeClassPool.h"
 
 namespace MemMgrLite {
 
@@ -68,6 +69,19 @@ err_t Manager::allocSeg(PoolId id, size_t size_for_check, MemHandleProxy &proxy)
     return MemHandleProxy();  /* default constructor */
   }
 #else
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_SIZE_CLASS_POOL
+  if (pool->getPoolType() == SizeClassType)
+    {
+      return static_cast<SizeClassPool*>(pool)->allocSeg(size_for_check, proxy);
+    }
+#endif
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_SEG_CACHE
+  SegCache* cache = getSegCache(id);
+  if (cache)
+    {
+      return static_cast<BasicPool*>(pool)->allocSeg(size_for_check, proxy, *cache);
+    }
+#endif
   /* BasicPoolのみ使用時は、各種チェックを省略する */
   return static_cast<BasicPool*>(pool)->allocSeg(size_for_check, proxy);
 #endif
@@ -88,12 +102,97 @@ err_t BasicPool::allocSeg(size_t size_for_check, MemHandleProxy &proxy)
 
   if (proxy == 0)
     {
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_STATISTICS
+      statAllocFail();
+#endif
+      return ERR_MEM_EMPTY;
+    }
+
+  return ERR_OK;
+}
+
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_SEG_CACHE
+/*****************************************************************
+ * Get a segment handle of Basic pool through the segment cache
+ *****************************************************************/
+err_t BasicPool::allocSeg(size_t size_for_check, MemHandleProxy &proxy, SegCache& cache)
+{
+  if (size_for_check > getSegSize())
+    {
+      return ERR_DATA_SIZE;
+    }
+
+  proxy = MemPool::allocSeg(cache);
+
+  if (proxy == 0)
+    {
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_STATISTICS
+      statAllocFail();
+#endif
       return ERR_MEM_EMPTY;
     }
 
   return ERR_OK;
 }
 
+/*****************************************************************
+ * Get a segment handle from the magazine of the calling context.
+ * Only when the magazine is empty (or owned by another context),
+ * the pool is locked, and an empty magazine is refilled with a
+ * batch of segments at once.
+ *****************************************************************/
+MemHandleProxy MemPool::allocSeg(SegCache& cache)
+{
+  NumSeg seg_no = NullSegNo;
+  SegMagazine* mag = cache.acquire(isTaskContext(), getTaskId());
+
+  if (mag != NULL && !mag->empty())
+    {
+      seg_no = mag->pop();
+    }
+  else
+    {
+      ScopedLock lock;
+
+      if (m_seg_no_que.size() != 0)
+        {
+          seg_no = m_seg_no_que.top();
+          m_seg_no_que.pop();
+
+          for (uint32_t i = 0; mag != NULL && i < SegMagazine::BatchSize &&
+               m_seg_no_que.size() != 0; ++i)
+            {
+              mag->push(m_seg_no_que.top());
+              m_seg_no_que.pop();
+            }
+        }
+    }
+
+  if (mag != NULL)
+    {
+      mag->release();
+    }
+
+  if (seg_no == NullSegNo)
+    {
+      return 0;
+    }
+
+  /* The segment is owned by nobody else until the handle is returned,
+   * so the reference counter can be set without lock.
+   */
+
+  D_ASSERT(m_ref_cnt_array[seg_no - 1] == 0);
+  __atomic_store_n(&m_ref_cnt_array[seg_no - 1], 1, __ATOMIC_RELEASE);
+
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_STATISTICS
+  statAllocSeg(seg_no);
+#endif
+
+  return MemHandleBase::makeMemHandleProxy(getPoolId(), seg_no, 0);
+}
+#endif /* CONFIG_MEMUTILS_MEMORY_MANAGER_SEG_CACHE */
+
 /*****************************************************************
  * メモリプールからセグメントハンドルを取得する
  * 排他制御は呼出し側で行うこと
@@ -111,6 +210,10 @@ MemHandleProxy MemPool::allocSeg()
     D_ASSERT(m_ref_cnt_array[seg_no - 1] == 0);  /* 未使用のはず */
     m_ref_cnt_array[seg_no - 1] = 1;  /* インクリメントより代入の方が効率が良い */
 
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_STATISTICS
+    statAllocSeg(seg_no);
+#endif
+
     mhp = MemHandleBase::makeMemHandleProxy(getPoolId(), seg_no, 0);
   }
   return mhp;
@@ -37,6 +37,7 @@
 #include "FastMemAlloc.h"  /* FastMemAlloc class */
 #include "memutils/memory_manager/Manager.h"
 #include "BasicPool.h"
+#include "SizeClassPool.h"
 
 namespace MemMgrLite {
 
@@ -59,6 +60,12 @@ MemPool* Manager::createPool(const PoolAttr& attr, FastMemAlloc& fma)
     break;
   }
 #else
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_SIZE_CLASS_POOL
+  if (attr.type == SizeClassType) {
+    SizeClassPool* sc_pool = new(fma, sizeof(uint32_t)) SizeClassPool(attr, fma);
+    return (sc_pool && !sc_pool->isFailed()) ? sc_pool : NULL;
+  }
+#endif
   /* BasicPoolのみ使用時は、各種チェックを省略する */
   pool = new(fma, sizeof(uint32_t)) BasicPool(attr, fma);
 #endif
@@ -84,6 +84,9 @@ err_t Manager::createStaticPools(NumLayout layout_no, void* work_area, uint32_t
       return ERR_DATA_SIZE; /* work_areaのサイズ不足 */
     }
   }
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_STATISTICS
+  initPoolStats(fma);  /* The rest of work area is used for statistics. */
+#endif
   theManager->m_layout_no = layout_no;  /* 生成に成功したのでレイアウト番号を設定する */
 
   return ERR_OK;
@@ -55,6 +55,9 @@ void Manager::destroyDynamicPool(PoolId id)
 
 	ScopedLock lock;
 
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_SEG_CACHE
+	flushSegCache(id);
+#endif
 	destroyPool(theManager->m_dynamic_pools[no]);
 	theManager->m_dynamic_pools[no] = NULL;
 
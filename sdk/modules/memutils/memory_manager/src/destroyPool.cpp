@@ -35,6 +35,7 @@
 
 #include "memutils/memory_manager/Manager.h"
 #include "BasicPool.h"
+#include "SizeClassPool.h"
 
 namespace MemMgrLite {
 
@@ -58,6 +59,12 @@ void Manager::destroyPool(MemPool* pool)
 		break;
 	}
 #else
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_SIZE_CLASS_POOL
+	if (pool->getPoolType() == SizeClassType) {
+		static_cast<SizeClassPool*>(pool)->~SizeClassPool();
+		return;
+	}
+#endif
 	/* BasicPoolのみ使用時は、各種チェックを省略する */
 	static_cast<BasicPool*>(pool)->~BasicPool();
 #endif
@@ -54,10 +54,16 @@ void Manager::destroyStaticPools()
 		/* プールID=0は予約 */
 		for (uint32_t i = 1; i < theManager->m_pool_num; ++i) {
 			if (theManager->m_static_pools[i] != NULL) {
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_SEG_CACHE
+				flushSegCache(i);
+#endif
 				destroyPool(theManager->m_static_pools[i]);
 				theManager->m_static_pools[i] = NULL;
 			}
 		}
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_STATISTICS
+		theManager->m_pool_stats = NULL;
+#endif
 		theManager->m_layout_no = BadLayoutNo;	/* レイアウト番号を無効化 */
 	}
 }
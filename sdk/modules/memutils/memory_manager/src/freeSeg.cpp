@@ -36,6 +36,7 @@
 #include "ScopedLock.h"
 #include "memutils/memory_manager/MemHandleBase.h"
 #include "BasicPool.h"
+#include "SizeClassPool.h"
 
 namespace MemMgrLite {
 
@@ -60,6 +61,19 @@ void Manager::freeSeg(MemHandleBase& mh)
 		break;
 	}
 #else
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_SIZE_CLASS_POOL
+	if (pool->getPoolType() == SizeClassType) {
+		static_cast<SizeClassPool*>(pool)->freeSeg(mh);
+		return;
+	}
+#endif
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_SEG_CACHE
+	SegCache* cache = getSegCache(mh.getPoolId());
+	if (cache) {
+		static_cast<BasicPool*>(pool)->freeSeg(mh, *cache);
+		return;
+	}
+#endif
 	/* BasicPoolのみ使用時は、各種チェックを省略する */
 	static_cast<BasicPool*>(pool)->freeSeg(mh);
 #endif
@@ -74,6 +88,87 @@ void BasicPool::freeSeg(MemHandleBase& mh)
 	MemPool::freeSeg(mh);
 }
 
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_SEG_CACHE
+/*****************************************************************
+ * Free a segment of Basic pool through the segment cache
+ *****************************************************************/
+void BasicPool::freeSeg(MemHandleBase& mh, SegCache& cache)
+{
+	MemPool::freeSeg(mh, cache);
+}
+
+/*****************************************************************
+ * Decrement the reference counter without lock and, when it reaches
+ * zero, put the segment into the magazine of the calling context.
+ * Only when the magazine is full (or owned by another context),
+ * the pool is locked, and a full magazine returns a batch of its
+ * segments to the pool at once.
+ *****************************************************************/
+void MemPool::freeSeg(MemHandleBase& mh, SegCache& cache)
+{
+	NumSeg seg_no = mh.getSegNo();
+	D_ASSERT(seg_no != NullSegNo && seg_no <= getPoolNumSegs());
+	D_ASSERT(m_ref_cnt_array[seg_no - 1] != 0);	/* It should be in use. */
+
+	if (__atomic_sub_fetch(&m_ref_cnt_array[seg_no - 1], 1, __ATOMIC_ACQ_REL) == 0) {
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_STATISTICS
+		statFreeSeg(seg_no);
+#endif
+		SegMagazine* mag = cache.acquire(isTaskContext(), getTaskId());
+
+		if (mag != NULL && !mag->full()) {
+			mag->push(seg_no);
+		} else {
+			ScopedLock lock;
+
+			D_ASSERT(m_seg_no_que.full() == false);
+			(void)m_seg_no_que.push(seg_no);
+
+			for (uint32_t i = 0; mag != NULL && i < SegMagazine::BatchSize; ++i) {
+				D_ASSERT(m_seg_no_que.full() == false);
+				(void)m_seg_no_que.push(mag->pop());
+			}
+		}
+
+		if (mag != NULL) {
+			mag->release();
+		}
+	}
+	mh.clear();
+}
+
+/*****************************************************************
+ * Return all the segments held by the segment cache to the pool
+ * Exclusive control should be done on the caller side, and no
+ * context should be using the pool.
+ *****************************************************************/
+void MemPool::flushSegCache(SegCache& cache)
+{
+	for (uint32_t i = 0; i < SegCache::NumMagazines; ++i) {
+		SegMagazine& mag = cache.magazine(i);
+
+		while (!mag.empty()) {
+			NumSeg seg_no = mag.pop();
+			D_ASSERT(m_ref_cnt_array[seg_no - 1] == 0);
+			D_ASSERT(m_seg_no_que.full() == false);
+			(void)m_seg_no_que.push(seg_no);
+		}
+	}
+}
+
+/*****************************************************************
+ * Return all the segments held by the segment cache of the pool
+ * Exclusive control should be done on the caller side.
+ *****************************************************************/
+void Manager::flushSegCache(PoolId id)
+{
+	SegCache* cache = getSegCache(id);
+	if (cache) {
+		findPool(id)->flushSegCache(*cache);
+	}
+}
+#endif /* CONFIG_MEMUTILS_MEMORY_MANAGER_SEG_CACHE */
+
 /*****************************************************************
  * 参照カウンタを減算し、参照がなくなった場合はセグメントを返却する
  * 排他制御は呼出し側で行うこと
@@ -87,6 +182,9 @@ void MemPool::freeSeg(MemHandleBase& mh)
 	--m_ref_cnt_array[seg_no - 1];
 	if (m_ref_cnt_array[seg_no - 1] == 0) {
 		D_ASSERT(m_seg_no_que.full() == false);
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_STATISTICS
+		statFreeSeg(seg_no);
+#endif
 #ifdef USE_MEMMGR_SEG_DELETER
 //		notifyFreeSeg(mh);
 #endif
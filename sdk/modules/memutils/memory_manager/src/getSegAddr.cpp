@@ -35,6 +35,7 @@
 
 #include "memutils/memory_manager/MemHandleBase.h"
 #include "BasicPool.h"
+#include "SizeClassPool.h"
 
 namespace MemMgrLite {
 
@@ -57,6 +58,11 @@ PoolAddr Manager::getSegAddr(const MemHandleBase& mh)
 		return BadPoolAddr;
 	}
 #else
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_SIZE_CLASS_POOL
+	if (pool->getPoolType() == SizeClassType) {
+		return static_cast<SizeClassPool*>(pool)->getSegAddr(mh);
+	}
+#endif
 	/* BasicPoolのみ使用時は、各種チェックを省略する */
 	return static_cast<BasicPool*>(pool)->getSegAddr(mh);
 #endif
@@ -35,6 +35,7 @@
 
 #include "memutils/memory_manager/MemHandleBase.h"
 #include "BasicPool.h"
+#include "SizeClassPool.h"
 
 namespace MemMgrLite {
 
@@ -60,6 +61,11 @@ PoolSize Manager::getSegSize(const MemHandleBase& mh)
 	}
 	return size;
 #else
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_SIZE_CLASS_POOL
+	if (pool->getPoolType() == SizeClassType) {
+		return static_cast<SizeClassPool*>(pool)->getSegSize(mh);
+	}
+#endif
 	/* BasicPoolのみ使用時は、各種チェックを省略する */
 	return static_cast<BasicPool*>(pool)->getSegSize();
 #endif
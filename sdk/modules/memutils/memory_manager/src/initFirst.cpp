@@ -101,6 +101,14 @@ Manager::Manager() :
 	}
 #else
 {
+#endif
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_STATISTICS
+	m_pool_stats = NULL;
+#endif
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_SEG_CACHE
+	for (int i = 0; i < CONFIG_MEMUTILS_MEMORY_MANAGER_SEG_CACHE_POOLS; ++i) {
+		m_seg_caches[i].clear();
+	}
 #endif
 	/* 処理の最後に署名(初期化済み判定とダンプ時の目印用)を設定する */
 	memcpy(m_signature, MEMMGR_SIGNATURE, sizeof(m_signature));
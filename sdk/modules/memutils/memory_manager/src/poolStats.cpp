@@ -0,0 +1,283 @@
+/****************************************************************************
+ * modules/memutils/memory_manager/src/poolStats.cpp
+ *
+ *   Copyright 2018 Sony Semiconductor Solutions Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Semiconductor Solutions Corporation nor
+ *    the names of its contributors may be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#include <string.h>
+#include <time.h>
+#include "FastMemAlloc.h"
+#include "ScopedLock.h"
+#include "memutils/memory_manager/Manager.h"
+
+#ifdef CONFIG_MEMUTILS_MEMORY_MANAGER_STATISTICS
+
+namespace MemMgrLite {
+
+/*****************************************************************
+ * Get the current time in milliseconds
+ *****************************************************************/
+static uint32_t get_time_ms()
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<uint32_t>(now.tv_sec * 1000 + now.tv_nsec / 1000000);
+}
+
+/*****************************************************************
+ * Get the bin of the hold time histogram
+ *****************************************************************/
+static uint32_t get_hold_time_bin(uint32_t hold_time)
+{
+  uint32_t bin = 0;
+
+  while (hold_time != 0 && bin < MEMMGR_HOLD_TIME_HIST_NUM - 1)
+    {
+      hold_time >>= 1;
+      ++bin;
+    }
+
+  return bin;
+}
+
+/*****************************************************************
+ * Clear the statistics of a pool
+ *****************************************************************/
+static void clear_pool_stats(PoolStats* stats, NumSeg num_segs, uint32_t now)
+{
+  uint32_t* alloc_time = stats->alloc_time;
+
+  memset(stats, 0, sizeof(PoolStats));
+  stats->alloc_time     = alloc_time;
+  stats->start_time     = now;
+  stats->min_avail_segs = num_segs;
+}
+
+/*****************************************************************
+ * Create the statistics of static pools from the rest of work area.
+ * Exclusive control should be done on the caller side.
+ *****************************************************************/
+void Manager::initPoolStats(FastMemAlloc& fma)
+{
+  PoolStats* stats = static_cast<PoolStats*>(
+    fma.alloc(sizeof(PoolStats) * theManager->m_pool_num, sizeof(uint32_t)));
+
+  theManager->m_pool_stats = stats;
+  if (stats == NULL)
+    {
+      return;
+    }
+
+  uint32_t now = get_time_ms();
+
+  memset(stats, 0, sizeof(PoolStats) * theManager->m_pool_num);
+
+  for (uint32_t id = 1; id < theManager->m_pool_num; ++id)
+    {
+      MemPool* pool = theManager->m_static_pools[id];
+      if (pool == NULL)
+        {
+          continue;
+        }
+
+      /* Without the area of allocated time, only the hold time
+       * histogram is not available.
+       */
+
+      stats[id].alloc_time = static_cast<uint32_t*>(
+        fma.alloc(sizeof(uint32_t) * pool->getPoolNumSegs(), sizeof(uint32_t)));
+      clear_pool_stats(&stats[id], pool->getPoolNumSegs(), now);
+    }
+}
+
+/*****************************************************************
+ * Get a copy of the statistics of a static pool
+ *****************************************************************/
+err_t Manager::getPoolStats(PoolId id, PoolStats* stats)
+{
+  D_ASSERT(stats);
+
+  PoolStats* area = getPoolStatsArea(id);
+  if (area == NULL || theManager->m_static_pools[id] == NULL)
+    {
+      return ERR_STS;
+    }
+
+  ScopedLock lock;
+  *stats = *area;
+
+  return ERR_OK;
+}
+
+/*****************************************************************
+ * Clear the statistics of all static pools
+ *****************************************************************/
+void Manager::resetStats()
+{
+  if (theManager->m_pool_stats == NULL)
+    {
+      return;
+    }
+
+  uint32_t now = get_time_ms();
+
+  ScopedLock lock;
+
+  for (uint32_t id = 1; id < theManager->m_pool_num; ++id)
+    {
+      MemPool* pool = theManager->m_static_pools[id];
+      if (pool)
+        {
+          clear_pool_stats(&theManager->m_pool_stats[id],
+                           getPoolNumAvailSegs(id), now);
+        }
+    }
+}
+
+/*****************************************************************
+ * Print the statistics of all static pools
+ *****************************************************************/
+void Manager::dumpStats()
+{
+  if (theManager->m_pool_stats == NULL)
+    {
+      printf("MemMgrLite: statistics is not available.\n");
+      return;
+    }
+
+  uint32_t now = get_time_ms();
+
+  printf("Id Segs Avail MinAvail   Alloc    Free Fail Alloc/s MaxHold(ms)"
+         " Hold(<1,<2,<4,...ms)\n");
+
+  for (PoolId id = 1; id < theManager->m_pool_num; ++id)
+    {
+      PoolStats stats;
+      if (getPoolStats(id, &stats) != ERR_OK)
+        {
+          continue;
+        }
+
+      uint32_t elapsed = now - stats.start_time;
+      uint32_t rate = (elapsed) ?
+        static_cast<uint32_t>(static_cast<uint64_t>(stats.alloc_cnt) * 1000 / elapsed) : 0;
+
+      printf("%2d %4d %5d %8d %7u %7u %4u %7u ",
+             id, getPoolNumSegs(id), getPoolNumAvailSegs(id),
+             stats.min_avail_segs, stats.alloc_cnt, stats.free_cnt,
+             stats.fail_cnt, rate);
+
+      if (stats.alloc_time)
+        {
+          printf("%11u ", stats.max_hold_time);
+          for (uint32_t i = 0; i < MEMMGR_HOLD_TIME_HIST_NUM; ++i)
+            {
+              printf("%u%c", stats.hold_time_hist[i],
+                     (i == MEMMGR_HOLD_TIME_HIST_NUM - 1) ? '\n' : ',');
+            }
+        }
+      else
+        {
+          printf("          - -\n");
+        }
+    }
+}
+
+/*****************************************************************
+ * Update the statistics on segment allocation
+ *****************************************************************/
+void MemPool::statAllocSeg(NumSeg seg_no)
+{
+  PoolStats* stats = Manager::getPoolStatsArea(getPoolId());
+  if (stats == NULL)
+    {
+      return;
+    }
+
+  __atomic_add_fetch(&stats->alloc_cnt, 1, __ATOMIC_RELAXED);
+
+  NumSeg avail = Manager::getPoolNumAvailSegs(getPoolId());
+  if (avail < stats->min_avail_segs)
+    {
+      stats->min_avail_segs = avail;
+    }
+
+  if (stats->alloc_time)
+    {
+      stats->alloc_time[seg_no - 1] = get_time_ms();
+    }
+}
+
+/*****************************************************************
+ * Update the statistics on segment return
+ *****************************************************************/
+void MemPool::statFreeSeg(NumSeg seg_no)
+{
+  PoolStats* stats = Manager::getPoolStatsArea(getPoolId());
+  if (stats == NULL)
+    {
+      return;
+    }
+
+  __atomic_add_fetch(&stats->free_cnt, 1, __ATOMIC_RELAXED);
+
+  if (stats->alloc_time)
+    {
+      uint32_t hold_time = get_time_ms() - stats->alloc_time[seg_no - 1];
+
+      __atomic_add_fetch(&stats->hold_time_hist[get_hold_time_bin(hold_time)],
+                         1, __ATOMIC_RELAXED);
+      if (hold_time > stats->max_hold_time)
+        {
+          stats->max_hold_time = hold_time;
+        }
+    }
+}
+
+/*****************************************************************
+ * Update the statistics on allocation failure
+ *****************************************************************/
+void MemPool::statAllocFail()
+{
+  PoolStats* stats = Manager::getPoolStatsArea(getPoolId());
+  if (stats)
+    {
+      __atomic_add_fetch(&stats->fail_cnt, 1, __ATOMIC_RELAXED);
+      stats->min_avail_segs = 0;
+    }
+}
+
+} /* end of namespace MemMgrLite */
+
+#endif /* CONFIG_MEMUTILS_MEMORY_MANAGER_STATISTICS */
+
+/* poolStats.cxx */
@@ -53,6 +53,16 @@ UseSegThreshold     = false
 UseRingBufPool      = false
 UseRingBufThreshold = false
 
+#####################################################################
+# Optional parameters of feature
+#
+# These can be set to true in the config file before requiring
+# this script.
+#
+
+UseSizeClassPool    = false unless defined?(UseSizeClassPool)
+UseStatistics       = false unless defined?(UseStatistics)
+
 #####################################################################
 # Fixed parameters of pool layout
 #
@@ -77,8 +87,9 @@ EnableOutputMacro = false
 # Constants
 #
 
-Basic   = "BasicType"
-RingBuf = "RingBufType"
+Basic     = "BasicType"
+RingBuf   = "RingBufType"
+SizeClass = "SizeClassType"
 
 MinNameSize   = 3
 FenceSize     = 4
@@ -345,6 +356,25 @@ class FixedAreas
   end
 end
 
+#######################################################################
+# Segment classes of SizeClass pool are given as an array of
+# [seg_size, num_segs] instead of the number of segments.
+# Returns the total number of segments and the total size.
+def verify_seg_classes(name, classes)
+  abort("Don't use SizeClass type at #{name}") if !UseSizeClassPool
+  abort("Bad seg classes found at #{name}")    if classes.size == 0
+  num_seg = total_size = prev_size = 0
+  classes.each do |seg_size, seg|
+    abort("Bad class seg size found at #{name}") if !seg_size or seg_size % MinAlign != 0 or seg_size <= prev_size
+    abort("Bad class seg found at #{name}")      if !seg or seg <= 0
+    num_seg    += seg
+    total_size += seg_size * seg
+    prev_size   = seg_size
+  end
+  abort("Bad pool seg found at #{name}")       if num_seg > MaxSegs
+  return num_seg, total_size
+end
+
 #######################################################################
 class PoolEntry < BaseEntry
   def initialize(name, area, type, align, size, seg, fence, spinlock)
@@ -352,6 +382,7 @@ class PoolEntry < BaseEntry
     @type = type
     @align = align
     @num_seg = seg
+    @seg_classes = nil
     @skip_size = 0
     @fence_flag = fence
     @spinlock = spinlock
@@ -360,8 +391,16 @@ class PoolEntry < BaseEntry
     abort("Area not found at #{name}")         if !area_entry
     abort("Not RAM area found at #{name}")     if !area_entry.dev_entry.ram
     abort("Redefine name found at #{name}")    if MemoryDevices[name]
-    abort("Bad pool type found at #{name}")    if type != Basic and type != RingBuf
+    abort("Bad pool type found at #{name}")    if type != Basic and type != RingBuf and type != SizeClass
     abort("Don't use RingBuf type at #{name}") if type == RingBuf and !UseRingBufPool
+    if type == SizeClass
+      abort("Bad seg classes found at #{name}") if !seg.instance_of?(Array)
+      @seg_classes = seg
+      @num_seg, class_size = verify_seg_classes(name, seg)
+      size = class_size if size == RemainderSize
+      abort("Too small pool size at #{name}")  if size < class_size
+      seg = @num_seg
+    end
     abort("Bad pool align found at #{name}")   if align % MinAlign != 0 or align == 0
     abort("Too big pool align at #{name}")     if align >= area_entry.last_addr
     if size != RemainderSize
@@ -378,7 +417,7 @@ class PoolEntry < BaseEntry
     # set base class
     super(name, addr, size)
   end
-  attr_reader :area_entry, :type, :align, :num_seg, :skip_size, :fence_flag, :spinlock
+  attr_reader :area_entry, :type, :align, :num_seg, :skip_size, :fence_flag, :spinlock, :seg_classes
 end
 
 #######################################################################
@@ -388,6 +427,7 @@ class PoolEntryFixParam < BaseEntry
     @type = Basic
     @align = align
     @num_seg = seg
+    @seg_classes = nil
     @skip_size = 0
     @fence_flag = fence
     @spinlock = "SPL_NULL"
@@ -398,6 +438,14 @@ class PoolEntryFixParam < BaseEntry
     abort("Redefine name found at #{name}")    if MemoryDevices[name]
     abort("Bad pool align found at #{name}")   if align % MinAlign != 0 or align == 0
     abort("Too big pool align at #{name}")     if align >= area_entry.last_addr
+    if seg.instance_of?(Array)
+      @type = SizeClass
+      @seg_classes = seg
+      @num_seg, class_size = verify_seg_classes(name, seg)
+      size = class_size if size == RemainderSize
+      abort("Too small pool size at #{name}")  if size < class_size
+      seg = @num_seg
+    end
     if size != RemainderSize
       abort("Bad pool size found at #{name}")  if size % MinAlign != 0 or size == 0
       abort("Too big pool size at #{name}. remainder=#{area_entry.remainder}") if size > area_entry.remainder
@@ -411,7 +459,7 @@ class PoolEntryFixParam < BaseEntry
     # set base class
     super(name, addr, size)
   end
-  attr_reader :area_entry, :type, :align, :num_seg, :skip_size, :fence_flag, :spinlock
+  attr_reader :area_entry, :type, :align, :num_seg, :skip_size, :fence_flag, :spinlock, :seg_classes
 end
 
 # When creating a memory pool, the necessary work area size for each pool
@@ -419,15 +467,23 @@ end
 #  - Pool attribute area(Usually in static pool 0): 0, 12 or 16
 #  - BasicPool(=MemPool) area                      : 12 + 4 * sizeof(NumSeg)
 #  - RingBufPool area                              : To be determined(MemPool Area+alpha)
+#  - SizeClassPool area                            : MemPool area + 8
+#  - Queue objects of each segment class           : Number of classes * (4 + 4 * sizeof(NumSeg))
+#  - Data area of the queue of each segment class  : Number of segments * sizeof(NumSeg)
 #  - Data area of the segment number queue         : Number of segments * sizeof(NumSeg)
 #  - Reference counter area                        : Number of segments * sizeof(SegRefCnt)
 NumSegSize              = UseOver255Segments ? 2 : 1
 SegRefCntSize           = 1
-PoolAttrSize            = round_up(10 + NumSegSize + (UseFence ? 1 : 0) + (UseMultiCore ? 1 : 0), 4)
+PoolAttrSize            = round_up(10 + NumSegSize + (UseFence ? 1 : 0) + (UseMultiCore ? 1 : 0), 4) +
+                          (UseSizeClassPool ? 4 : 0)
 MemPoolDataSize         = 12 + 4 * NumSegSize   # 16 or 20
 BasicPoolDataSize       = MemPoolDataSize
 RingBufPoolDataSize     = MemPoolDataSize + 32  # Tentative value for details unexamined
 RingBufPoolSegDataSize  = 8                     # Tentative value for details unexamined
+SizeClassPoolDataSize   = MemPoolDataSize + 8   # 24 or 28
+SegClassQueSize         = 4 + 4 * NumSegSize    # 8 or 12
+PoolStatsSize           = 60                    # Statistics of each pool ID
+AllocTimeSize           = 4                     # Allocated time of each segment
 
 #######################################################################
 class PoolLayout
@@ -460,9 +516,17 @@ class PoolLayout
     layout_work_size = 0
     @pools.each do |pool|
       pool_work_size = (UseCopiedPoolAttr) ? PoolAttrSize : 0
-      pool_work_size += (pool.type == Basic) ? BasicPoolDataSize : RingBufPoolDataSize
+      if pool.type == SizeClass
+        # Alignment adjustment of the class queues, the class queues and their data area
+        pool_work_size += SizeClassPoolDataSize + MinAlign - 1
+        pool_work_size += pool.seg_classes.size * SegClassQueSize
+        pool_work_size += pool.num_seg * NumSegSize
+      else
+        pool_work_size += (pool.type == Basic) ? BasicPoolDataSize : RingBufPoolDataSize
+      end
       pool_work_size += pool.num_seg * NumSegSize    # Data area of the segment number queue
       pool_work_size += pool.num_seg * SegRefCntSize # Reference counter area
+      pool_work_size += pool.num_seg * AllocTimeSize if UseStatistics
       # Round up to the MinAlign unit and integrate
       layout_work_size += round_up(pool_work_size, MinAlign)
     end
@@ -494,8 +558,13 @@ class PoolAreas
     abort("Too many pool IDs.") if @@pool_ids.size - 1 > max_pool_id
   end
 
+  # Statistics area is taken after all pools are created
+  def self.work_size(layout)
+    layout.work_size + ((UseStatistics) ? PoolStatsSize * @@pool_ids.size : 0)
+  end
+
   def self.max_work_size
-    @@layouts.collect{|layout| layout.work_size}.max
+    @@layouts.collect{|layout| work_size(layout)}.max
   end
 
   def self.output_macros(io)
@@ -519,7 +588,7 @@ class PoolAreas
     io.print("\n/*\n * Pool areas\n */\n")
     @@layouts.each_with_index do |layout, index|
       io.print("/* Layout#{index}: */\n")
-      io.printf("#define MEMMGR_L#{index}_WORK_SIZE   0x%08x\n\n", layout.work_size)
+      io.printf("#define MEMMGR_L#{index}_WORK_SIZE   0x%08x\n\n", work_size(layout))
       layout.pools.each do |pool|
         io.printf("/* Skip 0x%04x bytes for alignment. */\n", pool.skip_size) if pool.skip_size > 0
         io.printf("#define L#{index}_#{pool.name}_ALIGN    0x%08x\n", pool.align)
@@ -529,6 +598,12 @@ class PoolAreas
         io.printf("#define L#{index}_#{pool.name}_U_FENCE  0x%08x\n", pool.begin_addr + pool.size) if pool.fence_flag
         io.printf("#define L#{index}_#{pool.name}_NUM_SEG  0x%08x\n", pool.num_seg)
         io.printf("#define L#{index}_#{pool.name}_SEG_SIZE 0x%08x\n", pool.size / pool.num_seg) if pool.type == Basic
+        if pool.type == SizeClass
+          pool.seg_classes.each_with_index do |(seg_size, seg), no|
+            io.printf("#define L#{index}_#{pool.name}_CLASS#{no}_NUM_SEG  0x%08x\n", seg)
+            io.printf("#define L#{index}_#{pool.name}_CLASS#{no}_SEG_SIZE 0x%08x\n", seg_size)
+          end
+        end
         io.print("\n")
       end
       layout.used_area_info.each do |name_remainder|
@@ -540,18 +615,35 @@ class PoolAreas
 
   def self.output_table(io)
     io.print("MemPool* static_pools[NUM_MEM_POOLS];\n\n")
+    if UseSizeClassPool
+      @@layouts.each_with_index do |layout, index|
+        layout.pools.each do |pool|
+          next if pool.type != SizeClass
+          io.print("static const SegClassAttr L#{index}_#{pool.name}_CLASSES[] = {\n")
+          pool.seg_classes.each do |seg_size, seg|
+            io.printf("  { 0x%08x, %3u },\n", seg_size, seg)
+          end
+          io.print("  { 0, 0 }\n};\n\n")
+        end
+      end
+    end
     io.print("extern const PoolAttr MemoryPoolLayouts[NUM_MEM_LAYOUTS][NUM_MEM_POOLS] = {\n")
     @@layouts.each_with_index do |layout, index|
       io.print(" {/* Layout:#{index} */\n")
       io.print("  /* pool_ID          type       seg")
       io.print(" fence") if UseFence
       io.print(" spinlock") if UseMultiCore
-      io.print("  addr        size         */\n")
+      io.print("  addr        size       ")
+      io.print("  seg_classes") if UseSizeClassPool
+      io.print("  */\n")
       layout.pools.each do |pool|
         io.printf("  { %-16s, %-6s, %3u", pool.name, pool.type, pool.num_seg)
         io.printf(", #{pool.fence_flag}") if UseFence
         io.printf(", #{pool.spinlock}") if UseMultiCore
         io.printf(", 0x%08x, 0x%08x", pool.begin_addr, pool.size)
+        if UseSizeClassPool
+          io.printf(", %s", (pool.type == SizeClass) ? "L#{index}_#{pool.name}_CLASSES" : "NULL")
+        end
         io.printf(" },  /* #{pool.area_entry.name} */\n")
       end
       io.print(" },\n")
@@ -353,6 +353,32 @@ err_t MsgLib::sendIsr(MsgQueId dest, MsgPri pri, MsgType type, MsgQueId reply, c
   return err_code;
 }
 
+#ifdef CONFIG_MEMUTILS_MESSAGE_REF_PARAM
+err_t MsgLib::sendRef(MsgQueId dest, MsgPri pri, MsgType type, MsgQueId reply, const MemMgrLite::MemHandle& mh)
+{
+  FAR MsgQueBlock* que;
+  err_t            err_code = ERR_OK;
+
+  if (mh.isNull())
+    {
+      return ERR_ARG;
+    }
+
+  err_code = referMsgQueBlock(dest, &que);
+  if (err_code == ERR_OK)
+    {
+      /* The copy in the queue element increments the reference count,
+       * so the segment survives the release of the sender's handle.
+       */
+
+      return que->send(pri, type, reply,
+                       MsgPacket::MsgFlagWaitParam | MsgPacket::MsgFlagRefParam, mh);
+    }
+
+  return err_code;
+}
+#endif
+
 /*****************************************************************
  * Notify message reception.
  *****************************************************************
@@ -38,8 +38,14 @@
 #include <stddef.h>
 #include <assert.h>
 
+#if defined(__arm__)
 static inline void __DMB(void) { asm volatile ("dmb"); }
 static inline void __DSB(void) { asm volatile ("dsb"); }
+#else
+/* Host build (test/simple_fifo) */
+static inline void __DMB(void) { __sync_synchronize(); }
+static inline void __DSB(void) { __sync_synchronize(); }
+#endif
 
 #include "memutils/simple_fifo/CMN_SimpleFifo.h"
 
@@ -434,6 +440,114 @@ size_t CMN_SimpleFifoPeekWithOffset(
     return ret;
 }
 
+/*!
+ * @brief Set chunks of the region handle from buffer indexes.
+ */
+static void setRegions(
+        volatile const CMN_SimpleFifoHandle* pHandle,
+        CMN_SimpleFifoPeekHandle* pRegions,
+        size_t idx0,
+        size_t sz0,
+        size_t sz1) {
+    pRegions->m_szChunk[0] = sz0;
+    pRegions->m_pChunk[0] = sz0 == 0 ? NULL : &pHandle->m_pBuf[idx0];
+    pRegions->m_szChunk[1] = sz1;
+    pRegions->m_pChunk[1] = sz1 == 0 ? NULL : &pHandle->m_pBuf[0];
+}
+
+size_t CMN_SimpleFifoGetWriteRegions(
+        CMN_SimpleFifoHandle* pHandle0,
+        CMN_SimpleFifoPeekHandle* pRegions) {
+    assert(pHandle0 != NULL);
+    assert(pRegions != NULL);
+
+    volatile CMN_SimpleFifoHandle* pHandle = pHandle0;
+    const size_t rp = pHandle->m_rp;
+    const size_t wp = pHandle->m_wp;
+    const size_t bufsz = pHandle->m_size;
+
+    // the reader has finished with the region before RP is seen updated
+    __DMB();
+
+    const size_t szVacant = getVacantSize(bufsz, wp, rp);
+    const size_t szRegion1 = getVacantSizeContinuous(bufsz, wp, rp);
+    setRegions(pHandle, pRegions, wp, szRegion1, szVacant - szRegion1);
+    return szVacant;
+}
+
+size_t CMN_SimpleFifoCommitWrite(
+        CMN_SimpleFifoHandle* pHandle0,
+        size_t sz) {
+    assert(pHandle0 != NULL);
+
+    volatile CMN_SimpleFifoHandle* pHandle = pHandle0;
+    const size_t rp = pHandle->m_rp;
+    const size_t wp = pHandle->m_wp;
+    const size_t bufsz = pHandle->m_size;
+
+    if (getVacantSize(bufsz, wp, rp) < sz) {
+        return 0;
+    }
+
+    size_t newWp = wp + sz;
+    if (bufsz <= newWp) {
+        newWp -= bufsz;
+    }
+    // data written in the regions is visible before WP
+    __DMB();
+    pHandle->m_wp = newWp;
+    __DSB();
+    return sz;
+}
+
+size_t CMN_SimpleFifoGetReadRegions(
+        const CMN_SimpleFifoHandle* pHandle0,
+        CMN_SimpleFifoPeekHandle* pRegions) {
+    assert(pHandle0 != NULL);
+    assert(pRegions != NULL);
+
+    volatile const CMN_SimpleFifoHandle* pHandle = pHandle0;
+    const size_t rp = pHandle->m_rp;
+    const size_t wp = pHandle->m_wp;
+    const size_t bufsz = pHandle->m_size;
+
+    // data is read only after WP is seen updated
+    __DMB();
+
+    const size_t szOccupied = getOccupiedSize(bufsz, wp, rp);
+    size_t szRegion1 = bufsz - rp;
+    if (szOccupied < szRegion1) {
+        szRegion1 = szOccupied;
+    }
+    setRegions(pHandle, pRegions, rp, szRegion1, szOccupied - szRegion1);
+    return szOccupied;
+}
+
+size_t CMN_SimpleFifoReleaseRead(
+        CMN_SimpleFifoHandle* pHandle0,
+        size_t sz) {
+    assert(pHandle0 != NULL);
+
+    volatile CMN_SimpleFifoHandle* pHandle = pHandle0;
+    const size_t rp = pHandle->m_rp;
+    const size_t wp = pHandle->m_wp;
+    const size_t bufsz = pHandle->m_size;
+
+    if (getOccupiedSize(bufsz, wp, rp) < sz) {
+        return 0;
+    }
+
+    size_t newRp = rp + sz;
+    if (bufsz <= newRp) {
+        newRp -= bufsz;
+    }
+    // reads of the released data complete before RP
+    __DMB();
+    pHandle->m_rp = newRp;
+    __DSB();
+    return sz;
+}
+
 /*
 size_t CMN_SimpleFifoPeek(
         const CMN_SimpleFifoHandle* pHandle0,
@@ -0,0 +1,570 @@
+/****************************************************************************
+ * modules/memutils/test/msg_batch/msg_batch_test.cpp
+ *
+ *   Copyright 2018 Sony Semiconductor Solutions Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Semiconductor Solutions Corporation nor
+ *    the names of its contributors may be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/* Host test and benchmark of batch send/receive of MsgLib.
+ *
+ * One message queue is made on host memory below 4GB and used by a
+ * sender thread and a receiver thread, packet by packet (send/recv)
+ * and in batches (sendBatch/recvBatch). The count semaphore counts how
+ * many times the receiver had to block, and getrusage() gives the
+ * context switches of both threads.
+ *
+ *   $ make && ./msg_batch_test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+
+#include "memutils/message/Message.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define MSGQ_RECV      1
+#define NUM_MSGQ_POOLS 2
+
+#define MSG_TYPE       0x1234
+#define ELEM_SIZE      16
+#define ELEM_NUM       64
+#define AREA_SIZE      0x10000
+
+#define BENCH_MSGS     400000
+#define MAX_BATCH      16
+
+#define CHECK(cond, ...) \
+  do \
+    { \
+      if (!(cond)) \
+        { \
+          printf("  NG: "); \
+          printf(__VA_ARGS__); \
+          printf("\n"); \
+          s_fail++; \
+        } \
+    } \
+  while (0)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct bench_s
+{
+  int           batch;
+  unsigned long full;
+  unsigned long switches;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static int s_fail;
+static pthread_mutex_t s_irq_lock;
+static unsigned long s_sem_blocks;
+static sem_t *s_count_sem;  /* Count semaphore of the queue */
+
+/* Queue area: MsgQueBlock array first, then the packets of the queue. */
+
+static uint8_t *map_area(void)
+{
+  void *area = mmap(NULL, AREA_SIZE, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);
+
+  if (area == MAP_FAILED)
+    {
+      perror("mmap");
+      exit(1);
+    }
+  return static_cast<uint8_t *>(area);
+}
+
+static uint8_t *s_area = map_area();
+
+static drm_t area_drm(uint32_t offset)
+{
+  return static_cast<drm_t>(reinterpret_cast<uintptr_t>(s_area)) + offset;
+}
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* What msgq_layout.rb generates: pool 0 is the library header. */
+
+extern const MsgQueDef MsgqPoolDefs[NUM_MSGQ_POOLS] =
+{
+  { 0, 0, 0, INVALID_DRM, 0, 0, 0, 0 },
+  { area_drm(0x1000), ELEM_SIZE, ELEM_NUM, INVALID_DRM, 0, 0, 0, 0 },
+};
+
+/****************************************************************************
+ * Stubs of NuttX
+ ****************************************************************************/
+
+extern "C" void up_irq_disable(void)
+{
+  pthread_mutex_lock(&s_irq_lock);
+}
+
+extern "C" void up_irq_enable(void)
+{
+  pthread_mutex_unlock(&s_irq_lock);
+}
+
+extern "C" void up_enable_irq(int irq)
+{
+}
+
+extern "C" void up_disable_irq(int irq)
+{
+}
+
+extern "C" void sched_lock(void)
+{
+}
+
+extern "C" void sched_unlock(void)
+{
+}
+
+extern "C" int sem_init(sem_t *sem, int pshared, unsigned int value)
+{
+  sem->semcount = value;
+  s_count_sem = sem;
+  pthread_mutex_init(&sem->lock, NULL);
+  pthread_cond_init(&sem->cond, NULL);
+  return 0;
+}
+
+extern "C" int sem_destroy(sem_t *sem)
+{
+  pthread_cond_destroy(&sem->cond);
+  pthread_mutex_destroy(&sem->lock);
+  return 0;
+}
+
+extern "C" int sem_post(sem_t *sem)
+{
+  pthread_mutex_lock(&sem->lock);
+  if (sem->semcount++ < 0)
+    {
+      pthread_cond_signal(&sem->cond);
+    }
+  pthread_mutex_unlock(&sem->lock);
+  return 0;
+}
+
+static int sem_take(sem_t *sem, const struct timespec *abstime)
+{
+  int ret = 0;
+
+  pthread_mutex_lock(&sem->lock);
+  if (--sem->semcount < 0)
+    {
+      s_sem_blocks++;
+      while (sem->semcount < 0 && ret == 0)
+        {
+          /* semcount goes back to 0 or more by sem_post. */
+
+          int err = (abstime) ?
+            pthread_cond_timedwait(&sem->cond, &sem->lock, abstime) :
+            pthread_cond_wait(&sem->cond, &sem->lock);
+
+          if (err == ETIMEDOUT && sem->semcount < 0)
+            {
+              sem->semcount++;
+              errno = ETIMEDOUT;
+              ret = -1;
+            }
+        }
+    }
+  pthread_mutex_unlock(&sem->lock);
+  return ret;
+}
+
+extern "C" int sem_wait(sem_t *sem)
+{
+  return sem_take(sem, NULL);
+}
+
+extern "C" int sem_timedwait(sem_t *sem, const struct timespec *abstime)
+{
+  return sem_take(sem, abstime);
+}
+
+extern "C" int sem_trywait(sem_t *sem)
+{
+  int ret = 0;
+
+  pthread_mutex_lock(&sem->lock);
+  if (sem->semcount > 0)
+    {
+      sem->semcount--;
+    }
+  else
+    {
+      errno = EAGAIN;
+      ret = -1;
+    }
+  pthread_mutex_unlock(&sem->lock);
+  return ret;
+}
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static double now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned long thread_switches(void)
+{
+  struct rusage ru;
+
+  getrusage(RUSAGE_THREAD, &ru);
+  return ru.ru_nvcsw + ru.ru_nivcsw;
+}
+
+static MsgQueBlock *recv_que(void)
+{
+  MsgQueBlock *que = NULL;
+
+  MsgLib::referMsgQueBlock(MSGQ_RECV, &que);
+  return que;
+}
+
+static int sem_count(void)
+{
+  return s_count_sem->semcount;
+}
+
+/* Receive up to max packets and check that their parameters
+ * follow expect. Returns the number of packets received.
+ */
+
+static uint16_t recv_check(uint16_t max, uint32_t *expect)
+{
+  MsgQueBlock *que = recv_que();
+  MsgPacket *packets[MAX_BATCH];
+  uint16_t num = 0;
+  err_t err;
+
+  err = que->recvBatch(TIME_FOREVER, packets, max, &num);
+  CHECK(err == ERR_OK, "recvBatch %d", err);
+  if (err != ERR_OK)
+    {
+      return 0;
+    }
+
+  for (uint16_t i = 0; i < num; i++)
+    {
+      uint32_t param = packets[i]->moveParam<uint32_t>();
+
+      CHECK(packets[i]->getType() == MSG_TYPE, "type %04x",
+            packets[i]->getType());
+      CHECK(param == *expect, "param %u, expected %u", param, *expect);
+      (*expect)++;
+    }
+
+  err = que->popBatch(num);
+  CHECK(err == ERR_OK, "popBatch %d", err);
+  return num;
+}
+
+static void test_batch(void)
+{
+  MsgQueBlock *que = recv_que();
+  MsgPacket *packet;
+  uint32_t params[ELEM_NUM];
+  uint32_t expect = 0;
+  uint16_t num;
+  err_t err;
+
+  printf("batch send and receive\n");
+
+  for (uint32_t i = 0; i < ELEM_NUM; i++)
+    {
+      params[i] = i;
+    }
+
+  /* recvBatch takes at most max packets, the rest stay queued. */
+
+  err = MsgLib::sendBatch(MSGQ_RECV, MsgPriNormal, MSG_TYPE, MSG_QUE_NULL,
+                          params, 5);
+  CHECK(err == ERR_OK, "sendBatch %d", err);
+  CHECK(sem_count() == 5, "count %d after send of 5", sem_count());
+
+  num = recv_check(3, &expect);
+  CHECK(num == 3, "%u received with max 3", num);
+  CHECK(que->getNumMsg(MsgPriNormal) == 2, "%u queued",
+        que->getNumMsg(MsgPriNormal));
+
+  num = recv_check(MAX_BATCH, &expect);
+  CHECK(num == 2, "%u received", num);
+  CHECK(sem_count() == 0, "count %d after receive", sem_count());
+
+  /* A batch which does not fit is not sent at all. */
+
+  expect = 0;
+  err = MsgLib::sendBatch(MSGQ_RECV, MsgPriNormal, MSG_TYPE, MSG_QUE_NULL,
+                          params, ELEM_NUM - 2);
+  CHECK(err == ERR_OK, "sendBatch %d", err);
+  err = MsgLib::sendBatch(MSGQ_RECV, MsgPriNormal, MSG_TYPE, MSG_QUE_NULL,
+                          &params[ELEM_NUM - 2], 3);
+  CHECK(err == ERR_QUE_FULL, "sendBatch to full queue %d", err);
+  CHECK(que->getNumMsg(MsgPriNormal) == ELEM_NUM - 2, "%u queued",
+        que->getNumMsg(MsgPriNormal));
+  CHECK(sem_count() == ELEM_NUM - 2, "count %d", sem_count());
+
+  /* Packets sent one by one are received in a batch after them. */
+
+  err = MsgLib::send<uint32_t>(MSGQ_RECV, MsgPriNormal, MSG_TYPE,
+                               MSG_QUE_NULL, ELEM_NUM - 2);
+  CHECK(err == ERR_OK, "send %d", err);
+
+  while (expect < ELEM_NUM - 1)
+    {
+      if (recv_check(MAX_BATCH, &expect) == 0)
+        {
+          break;
+        }
+    }
+  CHECK(expect == ELEM_NUM - 1, "%u received", expect);
+  CHECK(sem_count() == 0, "count %d after receive", sem_count());
+
+  /* Parameters must be taken before popBatch. */
+
+  err = MsgLib::sendBatch(MSGQ_RECV, MsgPriNormal, MSG_TYPE, MSG_QUE_NULL,
+                          params, 2);
+  CHECK(err == ERR_OK, "sendBatch %d", err);
+
+  MsgPacket *packets[2];
+  err = que->recvBatch(TIME_FOREVER, packets, 2, &num);
+  CHECK(err == ERR_OK && num == 2, "recvBatch %d, %u", err, num);
+  CHECK(que->popBatch(0) == ERR_ARG, "popBatch of 0");
+  CHECK(que->popBatch(3) == ERR_ARG, "popBatch of 3");
+  CHECK(que->popBatch(2) == ERR_MEM_BUSY, "popBatch with parameters");
+  packets[0]->moveParam<uint32_t>();
+  packets[1]->moveParam<uint32_t>();
+  CHECK(que->popBatch(2) == ERR_OK, "popBatch");
+
+  /* recv and pop keep working packet by packet. */
+
+  err = MsgLib::send<uint32_t>(MSGQ_RECV, MsgPriNormal, MSG_TYPE,
+                               MSG_QUE_NULL, 7);
+  CHECK(err == ERR_OK, "send %d", err);
+  err = que->recv(TIME_FOREVER, &packet);
+  CHECK(err == ERR_OK, "recv %d", err);
+  CHECK(packet->moveParam<uint32_t>() == 7, "param");
+  CHECK(que->pop() == ERR_OK, "pop");
+
+  CHECK(que->getNumMsg(MsgPriNormal) == 0, "%u left",
+        que->getNumMsg(MsgPriNormal));
+  CHECK(sem_count() == 0, "count %d left", sem_count());
+}
+
+static void *sender(void *arg)
+{
+  struct bench_s *b = static_cast<struct bench_s *>(arg);
+  uint32_t params[MAX_BATCH];
+  unsigned long switches = thread_switches();
+
+  for (uint32_t seq = 0; seq < BENCH_MSGS; seq += b->batch)
+    {
+      err_t err;
+
+      for (int i = 0; i < b->batch; i++)
+        {
+          params[i] = seq + i;
+        }
+
+      do
+        {
+          if (b->batch == 1)
+            {
+              err = MsgLib::send<uint32_t>(MSGQ_RECV, MsgPriNormal, MSG_TYPE,
+                                           MSG_QUE_NULL, params[0]);
+            }
+          else
+            {
+              err = MsgLib::sendBatch(MSGQ_RECV, MsgPriNormal, MSG_TYPE,
+                                      MSG_QUE_NULL, params, b->batch);
+            }
+
+          if (err == ERR_QUE_FULL)
+            {
+              b->full++;
+              sched_yield();
+            }
+        }
+      while (err == ERR_QUE_FULL);
+
+      if (err != ERR_OK)
+        {
+          printf("  NG: send %d\n", err);
+          __atomic_add_fetch(&s_fail, 1, __ATOMIC_RELAXED);
+          break;
+        }
+    }
+
+  b->switches += thread_switches() - switches;
+  return NULL;
+}
+
+static void bench(int batch)
+{
+  MsgQueBlock *que = recv_que();
+  struct bench_s b;
+  pthread_t thread;
+  unsigned long switches;
+  unsigned long blocks;
+  uint32_t expect = 0;
+  uint32_t calls = 0;
+  double start;
+  double sec;
+
+  b.batch    = batch;
+  b.full     = 0;
+  b.switches = 0;
+
+  blocks   = s_sem_blocks;
+  switches = thread_switches();
+  start    = now();
+
+  pthread_create(&thread, NULL, sender, &b);
+
+  while (expect < BENCH_MSGS)
+    {
+      MsgPacket *packets[MAX_BATCH];
+      uint16_t num = 1;
+      err_t err;
+
+      if (batch == 1)
+        {
+          err = que->recv(TIME_FOREVER, &packets[0]);
+        }
+      else
+        {
+          err = que->recvBatch(TIME_FOREVER, packets, MAX_BATCH, &num);
+        }
+
+      if (err != ERR_OK)
+        {
+          CHECK(false, "receive %d", err);
+          break;
+        }
+
+      for (uint16_t i = 0; i < num; i++)
+        {
+          uint32_t param = packets[i]->moveParam<uint32_t>();
+
+          if (param != expect)
+            {
+              CHECK(false, "param %u, expected %u", param, expect);
+              expect = param;
+            }
+          expect++;
+        }
+
+      err = (batch == 1) ? que->pop() : que->popBatch(num);
+      CHECK(err == ERR_OK, "pop %d", err);
+      calls++;
+    }
+
+  b.switches += thread_switches() - switches;
+  pthread_join(thread, NULL);
+  sec    = now() - start;
+  blocks = s_sem_blocks - blocks;
+
+  printf("  %-22s %8.2f Mmsg/s %6.1f recv calls %6.1f blocks "
+         "%6.1f switches /1000 msg\n",
+         batch == 1 ? "send/recv" : batch == 4 ? "sendBatch 4/recvBatch" :
+                                                 "sendBatch 16/recvBatch",
+         BENCH_MSGS / sec / 1e6, calls * 1000.0 / BENCH_MSGS,
+         blocks * 1000.0 / BENCH_MSGS, b.switches * 1000.0 / BENCH_MSGS);
+
+  CHECK(que->getNumMsg(MsgPriNormal) == 0, "%u left",
+        que->getNumMsg(MsgPriNormal));
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+  pthread_mutexattr_t attr;
+  err_t err;
+
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&s_irq_lock, &attr);
+
+  err = MsgLib::initFirst(NUM_MSGQ_POOLS, area_drm(0));
+  CHECK(err == ERR_OK, "initFirst %d", err);
+  err = MsgLib::initPerCpu();
+  CHECK(err == ERR_OK, "initPerCpu %d", err);
+  if (s_fail)
+    {
+      printf("FAIL (%d failure)\n", s_fail);
+      return 1;
+    }
+
+  test_batch();
+
+  printf("benchmark (%d messages, queue of %d)\n", BENCH_MSGS, ELEM_NUM);
+
+  bench(1);
+  bench(4);
+  bench(MAX_BATCH);
+
+  printf("%s (%d failure)\n", s_fail == 0 ? "PASS" : "FAIL", s_fail);
+  return s_fail == 0 ? 0 : 1;
+}
@@ -0,0 +1,552 @@
+/****************************************************************************
+ * modules/memutils/test/seg_cache/seg_cache_test.cpp
+ *
+ *   Copyright 2018 Sony Semiconductor Solutions Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Semiconductor Solutions Corporation nor
+ *    the names of its contributors may be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/* Host test and benchmark of segment magazines of MemMgrLite.
+ *
+ * A BasicPool is made on host memory and used by allocSeg/freeSeg with
+ * magazines (SegCache) and without them (locked path). Tasks are
+ * threads: getpid() below gives each of them its task ID as NuttX does,
+ * and task ID 0 plays an interrupt handler. Disabling interrupts is a
+ * mutex, which counts how many times the pool is locked.
+ *
+ *   $ make && ./seg_cache_test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "memutils/memory_manager/MemHandleBase.h"
+#include "FastMemAlloc.h"
+#include "BasicPool.h"
+
+using namespace MemMgrLite;
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define POOL_ID     1
+#define NUM_SEGS    64
+#define SEG_SIZE    64
+
+/* Each task takes BURST segments and frees them, BENCH_PAIRS times. */
+
+#define BURST       4
+#define BENCH_PAIRS 400000
+#define MAX_TASKS   8
+#define RING_SIZE   16
+
+#define CHECK(cond, ...) \
+  do \
+    { \
+      if (!(cond)) \
+        { \
+          printf("  NG: "); \
+          printf(__VA_ARGS__); \
+          printf("\n"); \
+          s_fail++; \
+        } \
+    } \
+  while (0)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* A handle is a MemHandleProxy word. Pool sets and clears it as
+ * MemHandleBase does.
+ */
+
+static void set_proxy(MemMgrLite::MemHandleBase& mh,
+                      MemMgrLite::MemHandleProxy proxy)
+{
+  memcpy(static_cast<void *>(&mh), &proxy, sizeof(proxy));
+}
+
+/* Gives the test access to the protected allocSeg/freeSeg of the pool,
+ * as Manager does.
+ */
+
+class TestPool : public BasicPool {
+public:
+  TestPool(const PoolAttr& attr, FastMemAlloc& fma) : BasicPool(attr, fma) {}
+
+  bool alloc(SegCache* cache, MemHandleBase& mh) {
+    MemHandleProxy proxy;
+    err_t err = (cache) ? BasicPool::allocSeg(SEG_SIZE, proxy, *cache) :
+                          BasicPool::allocSeg(SEG_SIZE, proxy);
+    if (err != ERR_OK) {
+      return false;
+    }
+    set_proxy(mh, proxy);
+    return true;
+  }
+
+  void free(SegCache* cache, MemHandleBase& mh) {
+    if (cache) {
+      BasicPool::freeSeg(mh, *cache);
+    } else {
+      BasicPool::freeSeg(mh);
+    }
+  }
+
+  void flush(SegCache& cache) { flushSegCache(cache); }
+
+  uint32_t avail() const { return getPoolNumAvailSegs(); }
+  bool     failed() { return isFailed(); }
+};
+
+struct task_param_s
+{
+  TestPool *pool;
+  SegCache *cache;
+  int       task_id;
+  int       pairs;
+
+  /* 0: alloc and free BURST segments, 1: producer, 2: consumer */
+
+  int       role;
+};
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+/* Manager is not made by the test. Handles are freed by the pool. */
+
+Manager *Manager::theManager;
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static int s_fail;
+
+static pthread_mutex_t s_irq_lock;
+static unsigned long s_lock_count;
+
+static __thread int t_task_id = 1;
+
+/* Owner flag of each segment, to find a segment given twice. */
+
+static int s_in_use[NUM_SEGS + 1];
+static int s_double_alloc;
+
+/* Handles from producer to consumer */
+
+static MemHandleProxy s_ring[RING_SIZE];
+static unsigned int s_ring_head;
+static unsigned int s_ring_tail;
+
+static uint32_t s_pool_area[NUM_SEGS * SEG_SIZE / 4];
+static uint32_t s_work_area[1024];
+static PoolAttr s_attr;
+
+/****************************************************************************
+ * Stubs of NuttX
+ ****************************************************************************/
+
+extern "C" pid_t getpid(void)
+{
+  return t_task_id;
+}
+
+extern "C" void up_irq_disable(void)
+{
+  pthread_mutex_lock(&s_irq_lock);
+  s_lock_count++;
+}
+
+extern "C" void up_irq_enable(void)
+{
+  pthread_mutex_unlock(&s_irq_lock);
+}
+
+extern "C" void up_enable_irq(int irq)
+{
+}
+
+extern "C" void up_disable_irq(int irq)
+{
+}
+
+extern "C" void sched_lock(void)
+{
+}
+
+extern "C" void sched_unlock(void)
+{
+}
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static unsigned long lock_count(void)
+{
+  return __atomic_load_n(&s_lock_count, __ATOMIC_RELAXED);
+}
+
+static double now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static TestPool *make_pool(SegCache *cache)
+{
+  static FastMemAlloc fma;
+
+  fma.set(s_work_area, sizeof(s_work_area));
+
+  s_attr.id       = POOL_ID;
+  s_attr.type     = BasicType;
+  s_attr.num_segs = NUM_SEGS;
+  s_attr.addr     = 0;
+  s_attr.size     = sizeof(s_pool_area);
+
+  cache->clear();
+  return new TestPool(s_attr, fma);
+}
+
+static bool take(TestPool *pool, SegCache *cache, MemHandleBase &mh)
+{
+  if (!pool->alloc(cache, mh))
+    {
+      return false;
+    }
+  if (__atomic_exchange_n(&s_in_use[mh.getSegNo()], 1, __ATOMIC_ACQ_REL))
+    {
+      __atomic_add_fetch(&s_double_alloc, 1, __ATOMIC_RELAXED);
+    }
+  return true;
+}
+
+static void give(TestPool *pool, SegCache *cache, MemHandleBase &mh)
+{
+  __atomic_store_n(&s_in_use[mh.getSegNo()], 0, __ATOMIC_RELEASE);
+  pool->free(cache, mh);
+}
+
+static void *task_main(void *arg)
+{
+  task_param_s *p = static_cast<task_param_s *>(arg);
+  MemHandleBase mh[BURST];
+  int i;
+  int j;
+
+  t_task_id = p->task_id;
+
+  for (i = 0; i < p->pairs; )
+    {
+      if (p->role == 1)
+        {
+          unsigned int tail = __atomic_load_n(&s_ring_tail, __ATOMIC_ACQUIRE);
+
+          if (s_ring_head - tail == RING_SIZE || !take(p->pool, p->cache, mh[0]))
+            {
+              sched_yield();
+              continue;
+            }
+          memcpy(&s_ring[s_ring_head % RING_SIZE], &mh[0],
+                 sizeof(MemHandleProxy));
+          set_proxy(mh[0], 0);
+          __atomic_store_n(&s_ring_head, s_ring_head + 1, __ATOMIC_RELEASE);
+          i++;
+        }
+      else if (p->role == 2)
+        {
+          unsigned int head = __atomic_load_n(&s_ring_head, __ATOMIC_ACQUIRE);
+
+          if (head == s_ring_tail)
+            {
+              sched_yield();
+              continue;
+            }
+          set_proxy(mh[0], s_ring[s_ring_tail % RING_SIZE]);
+          __atomic_store_n(&s_ring_tail, s_ring_tail + 1, __ATOMIC_RELEASE);
+          give(p->pool, p->cache, mh[0]);
+          i++;
+        }
+      else
+        {
+          for (j = 0; j < BURST; j++)
+            {
+              while (!take(p->pool, p->cache, mh[j]))
+                {
+                  sched_yield();
+                }
+            }
+          for (j = 0; j < BURST; j++)
+            {
+              give(p->pool, p->cache, mh[j]);
+            }
+          i += BURST;
+        }
+    }
+
+  return NULL;
+}
+
+/* All the segments are back in the pool or in the magazines. */
+
+static void check_all_free(const char *name, TestPool *pool, SegCache *cache)
+{
+  uint32_t cached = (cache) ? cache->size() : 0;
+
+  CHECK(pool->avail() + cached == NUM_SEGS, "%s: %u in pool + %u cached",
+        name, pool->avail(), cached);
+  CHECK(s_double_alloc == 0, "%s: %d segments given twice", name,
+        s_double_alloc);
+}
+
+/* Run tasks (and an interrupt handler if isr) on a pool with or without
+ * magazines, and print alloc+free operations per second and locks per
+ * 1000 operations.
+ */
+
+static void bench(const char *name, int tasks, bool isr, bool pipe,
+                  bool use_cache)
+{
+  SegCache cache;
+  SegCache *c = (use_cache) ? &cache : NULL;
+  TestPool *pool = make_pool(&cache);
+  pthread_t th[MAX_TASKS];
+  task_param_s param[MAX_TASKS];
+  int num = tasks + ((isr) ? 1 : 0);
+  unsigned long locks;
+  double start;
+  double sec;
+  double ops = 0;
+  int i;
+
+  s_ring_head = s_ring_tail = 0;
+  s_double_alloc = 0;
+  memset(s_in_use, 0, sizeof(s_in_use));
+
+  for (i = 0; i < num; i++)
+    {
+      param[i].pool    = pool;
+      param[i].cache   = c;
+      param[i].task_id = (isr && i == tasks) ? 0 : i + 1;
+      param[i].pairs   = BENCH_PAIRS;
+      param[i].role    = (pipe) ? i + 1 : 0;
+      ops += 2.0 * BENCH_PAIRS / ((pipe) ? 2 : 1);
+    }
+
+  locks = lock_count();
+  start = now();
+
+  for (i = 0; i < num; i++)
+    {
+      pthread_create(&th[i], NULL, task_main, &param[i]);
+    }
+  for (i = 0; i < num; i++)
+    {
+      pthread_join(th[i], NULL);
+    }
+
+  sec = now() - start;
+  locks = lock_count() - locks;
+
+  printf("  %-34s %-9s %7.2f Mops/s %7.1f locks/1000 ops\n", name,
+         (use_cache) ? "magazine" : "lock", ops / sec / 1e6,
+         locks * 1000.0 / ops);
+
+  check_all_free(name, pool, c);
+}
+
+/****************************************************************************
+ * Tests
+ ****************************************************************************/
+
+/* The pool is locked once per BatchSize allocations, and frees go to
+ * the magazine until it is full.
+ */
+
+static void test_refill(void)
+{
+  SegCache cache;
+  TestPool *pool = make_pool(&cache);
+  MemHandleBase mh[NUM_SEGS];
+  unsigned long locks;
+  uint32_t i;
+
+  printf("refill and drain\n");
+
+  t_task_id = 1;
+  locks = lock_count();
+  for (i = 0; i < 1 + SegMagazine::BatchSize; i++)
+    {
+      CHECK(pool->alloc(&cache, mh[i]), "alloc %u", i);
+    }
+  CHECK(lock_count() - locks == 1, "%lu locks for %u allocs",
+        lock_count() - locks, i);
+  CHECK(cache.size() == 0, "%u cached", cache.size());
+
+  CHECK(pool->alloc(&cache, mh[i]), "alloc %u", i);
+  CHECK(lock_count() - locks == 2, "%lu locks after refill",
+        lock_count() - locks);
+
+  /* Frees fill the magazine without lock, and one more returns a batch
+   * to the pool.
+   */
+
+  for (i = 0; i < SegMagazine::Depth - SegMagazine::BatchSize; i++)
+    {
+      pool->free(&cache, mh[i]);
+    }
+  CHECK(lock_count() - locks == 2, "%lu locks after free",
+        lock_count() - locks);
+  CHECK(cache.size() == SegMagazine::Depth, "%u cached", cache.size());
+
+  pool->free(&cache, mh[i++]);
+  CHECK(lock_count() - locks == 3, "%lu locks after drain",
+        lock_count() - locks);
+  CHECK(cache.size() == SegMagazine::Depth - SegMagazine::BatchSize,
+        "%u cached", cache.size());
+  pool->free(&cache, mh[i++]);
+
+  /* Freeing more than the depth drains a batch each time it is full. */
+
+  for (i = 0; i < NUM_SEGS; i++)
+    {
+      CHECK(pool->alloc(&cache, mh[i]), "alloc %u", i);
+    }
+  CHECK(!pool->alloc(&cache, mh[i]), "alloc of empty pool");
+  CHECK(cache.size() == 0, "%u cached", cache.size());
+
+  locks = lock_count();
+  for (i = 0; i < NUM_SEGS; i++)
+    {
+      pool->free(&cache, mh[i]);
+    }
+  CHECK(lock_count() - locks ==
+        (NUM_SEGS - SegMagazine::Depth) / (SegMagazine::BatchSize + 1) +
+        ((NUM_SEGS - SegMagazine::Depth) % (SegMagazine::BatchSize + 1) ?
+         1 : 0),
+        "%lu locks for %d frees", lock_count() - locks, NUM_SEGS);
+  CHECK(cache.size() <= SegMagazine::Depth, "%u cached", cache.size());
+  check_all_free("refill and drain", pool, &cache);
+}
+
+/* A context whose magazine is owned by another one does not wait, and
+ * uses the pool under the lock.
+ */
+
+static void test_busy(void)
+{
+  SegCache cache;
+  TestPool *pool = make_pool(&cache);
+  SegMagazine *own;
+  MemHandleBase mh;
+  unsigned long locks;
+
+  printf("magazine owned by another context\n");
+
+  t_task_id = 1;
+  CHECK(pool->alloc(&cache, mh), "alloc");
+  pool->free(&cache, mh);
+
+  own = cache.acquire(true, 1);
+  CHECK(own != NULL, "acquire");
+  CHECK(cache.acquire(true, 1) == NULL, "acquire twice");
+
+  locks = lock_count();
+  CHECK(pool->alloc(&cache, mh), "alloc while owned");
+  CHECK(lock_count() - locks == 1, "%lu locks", lock_count() - locks);
+  pool->free(&cache, mh);
+  CHECK(lock_count() - locks == 2, "%lu locks", lock_count() - locks);
+  if (own != NULL)
+    {
+      own->release();
+    }
+
+  /* An interrupt handler has its own magazine. */
+
+  t_task_id = 0;
+  own = cache.acquire(true, 1);
+  CHECK(own != NULL, "acquire");
+  CHECK(pool->alloc(&cache, mh), "alloc of interrupt handler");
+  CHECK(cache.magazine(0).size() == SegMagazine::BatchSize,
+        "%u in magazine 0", cache.magazine(0).size());
+  pool->free(&cache, mh);
+  if (own != NULL)
+    {
+      own->release();
+    }
+  t_task_id = 1;
+
+  pool->flush(cache);
+  CHECK(cache.size() == 0, "%u cached after flush", cache.size());
+  CHECK(pool->avail() == NUM_SEGS, "%u in pool after flush", pool->avail());
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+  pthread_mutexattr_t attr;
+
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&s_irq_lock, &attr);
+
+  test_refill();
+  test_busy();
+
+  printf("benchmark (%d segments, %d magazines of %d)\n", NUM_SEGS,
+         SegCache::NumMagazines, SegMagazine::Depth);
+
+  for (int use_cache = 0; use_cache < 2; use_cache++)
+    {
+      bench("1 task", 1, false, false, use_cache);
+      bench("4 tasks", 4, false, false, use_cache);
+      bench("3 tasks and interrupt handler", 3, true, false, use_cache);
+      bench("producer and consumer tasks", 2, false, true, use_cache);
+    }
+
+  printf("%s (%d failure)\n", s_fail == 0 ? "PASS" : "FAIL", s_fail);
+  return s_fail == 0 ? 0 : 1;
+}
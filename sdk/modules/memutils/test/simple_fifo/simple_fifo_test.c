@@ -0,0 +1,524 @@
+/****************************************************************************
+ * modules/memutils/test/simple_fifo/simple_fifo_test.c
+ *
+ *   Copyright 2018 Sony Semiconductor Solutions Corporation
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of Sony Semiconductor Solutions Corporation nor
+ *    the names of its contributors may be used to endorse or promote
+ *    products derived from this software without specific prior written
+ *    permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/* Host test and benchmark of the direct region access of
+ * CMN_SimpleFifo.
+ *
+ * The regions are checked at every RP/WP position of a small FIFO,
+ * including the wrap-around at the end of the buffer, against a byte
+ * counter through random write/read cycles, and between a writer
+ * thread and a reader thread. The benchmark moves a byte stream with
+ * Offer/Poll through a staging buffer and with the regions in place.
+ *
+ *   $ make && ./simple_fifo_test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include "memutils/simple_fifo/CMN_SimpleFifo.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define SMALL_SIZE   16
+#define RANDOM_LOOPS 200000
+
+#define BENCH_SIZE   4096
+#define BENCH_BYTES  (256 * 1024 * 1024)
+#define THREAD_BYTES (16 * 1024 * 1024)
+
+#define CHECK(cond, ...) \
+  do \
+    { \
+      if (!(cond)) \
+        { \
+          printf("  NG: "); \
+          printf(__VA_ARGS__); \
+          printf("\n"); \
+          s_fail++; \
+        } \
+    } \
+  while (0)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct thread_s
+{
+  CMN_SimpleFifoHandle fifo;
+  size_t               chunk;
+  int                  error;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static int s_fail;
+static uint32_t s_small_buf[SMALL_SIZE / 4];
+static uint32_t s_bench_buf[BENCH_SIZE / 4];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static double now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static size_t region_size(const CMN_SimpleFifoPeekHandle *r)
+{
+  return r->m_szChunk[0] + r->m_szChunk[1];
+}
+
+/* Produce and consume a byte counter in a contiguous area. Both the
+ * copy and the region benchmarks use these, so that they differ only
+ * in the copy.
+ */
+
+static uint8_t put_bytes(uint8_t *p, size_t n, uint8_t seq)
+{
+  for (size_t i = 0; i < n; i++)
+    {
+      p[i] = (uint8_t)(seq + i);
+    }
+  return (uint8_t)(seq + n);
+}
+
+static int check_bytes(const uint8_t *p, size_t n, uint8_t seq)
+{
+  int ng = 0;
+
+  for (size_t i = 0; i < n; i++)
+    {
+      ng |= p[i] ^ (uint8_t)(seq + i);
+    }
+  return ng == 0;
+}
+
+/* Fill the regions with a byte counter starting from *seq. */
+
+static void fill(const CMN_SimpleFifoPeekHandle *r, size_t len,
+                 uint8_t *seq)
+{
+  for (int i = 0; i < 2 && len > 0; i++)
+    {
+      size_t n = r->m_szChunk[i] < len ? r->m_szChunk[i] : len;
+
+      *seq = put_bytes(r->m_pChunk[i], n, *seq);
+      len -= n;
+    }
+}
+
+/* Check that the regions hold the byte counter from *seq. */
+
+static int verify(const CMN_SimpleFifoPeekHandle *r, size_t len,
+                  uint8_t *seq)
+{
+  int ok = 1;
+
+  for (int i = 0; i < 2 && len > 0; i++)
+    {
+      size_t n = r->m_szChunk[i] < len ? r->m_szChunk[i] : len;
+
+      ok &= check_bytes(r->m_pChunk[i], n, *seq);
+      *seq += n;
+      len -= n;
+    }
+  return ok;
+}
+
+/* Check the regions against the buffer layout for given RP and WP. */
+
+static void check_layout(CMN_SimpleFifoHandle *fifo, size_t rp, size_t wp)
+{
+  CMN_SimpleFifoPeekHandle r;
+  uint8_t *buf = (uint8_t *)s_small_buf;
+  size_t occupied = (wp + SMALL_SIZE - rp) % SMALL_SIZE;
+  size_t vacant = SMALL_SIZE - 1 - occupied;
+  size_t sz;
+
+  /* Vacant space starts at WP and wraps to the top of the buffer
+   * unless that would make WP reach RP.
+   */
+
+  sz = CMN_SimpleFifoGetWriteRegions(fifo, &r);
+  CHECK(sz == vacant && region_size(&r) == vacant,
+        "rp %zu wp %zu: %zu writable, expected %zu", rp, wp, sz, vacant);
+  CHECK(sz == CMN_SimpleFifoGetVacantSize(fifo),
+        "rp %zu wp %zu: %zu writable, vacant size %zu", rp, wp, sz,
+        CMN_SimpleFifoGetVacantSize(fifo));
+  if (vacant > 0)
+    {
+      size_t head = (wp >= rp) ? SMALL_SIZE - wp - (rp == 0) : vacant;
+
+      CHECK(r.m_pChunk[0] == &buf[wp] && r.m_szChunk[0] == head,
+            "rp %zu wp %zu: write region 0 at %td size %zu", rp, wp,
+            r.m_pChunk[0] - buf, r.m_szChunk[0]);
+      CHECK(r.m_szChunk[1] == 0 ? r.m_pChunk[1] == NULL :
+                                  r.m_pChunk[1] == buf,
+            "rp %zu wp %zu: write region 1 at %p", rp, wp, r.m_pChunk[1]);
+    }
+  else
+    {
+      CHECK(r.m_pChunk[0] == NULL && r.m_pChunk[1] == NULL,
+            "rp %zu wp %zu: write region of full FIFO", rp, wp);
+    }
+
+  /* Occupied data starts at RP and wraps at the end of the buffer. */
+
+  sz = CMN_SimpleFifoGetReadRegions(fifo, &r);
+  CHECK(sz == occupied && region_size(&r) == occupied,
+        "rp %zu wp %zu: %zu readable, expected %zu", rp, wp, sz, occupied);
+  CHECK(sz == CMN_SimpleFifoGetOccupiedSize(fifo),
+        "rp %zu wp %zu: %zu readable, occupied size %zu", rp, wp, sz,
+        CMN_SimpleFifoGetOccupiedSize(fifo));
+  if (occupied > 0)
+    {
+      size_t head = (wp > rp) ? occupied : SMALL_SIZE - rp;
+
+      CHECK(r.m_pChunk[0] == &buf[rp] && r.m_szChunk[0] == head,
+            "rp %zu wp %zu: read region 0 at %td size %zu", rp, wp,
+            r.m_pChunk[0] - buf, r.m_szChunk[0]);
+      CHECK(r.m_szChunk[1] == 0 ? r.m_pChunk[1] == NULL :
+                                  r.m_pChunk[1] == buf,
+            "rp %zu wp %zu: read region 1 at %p", rp, wp, r.m_pChunk[1]);
+    }
+  else
+    {
+      CHECK(r.m_pChunk[0] == NULL && r.m_pChunk[1] == NULL,
+            "rp %zu wp %zu: read region of empty FIFO", rp, wp);
+    }
+}
+
+/* Every RP and every occupied size, so that both regions are seen
+ * split at the end of the buffer. Data written through the regions
+ * is read back with Poll, and data offered is read through them.
+ */
+
+static void test_wrap_around(void)
+{
+  CMN_SimpleFifoHandle fifo;
+  CMN_SimpleFifoPeekHandle r;
+  uint8_t out[SMALL_SIZE];
+
+  printf("regions at every position\n");
+
+  for (size_t rp = 0; rp < SMALL_SIZE; rp++)
+    {
+      for (size_t len = 0; len < SMALL_SIZE; len++)
+        {
+          size_t wp = (rp + len) % SMALL_SIZE;
+          uint8_t wseq = 0;
+          uint8_t rseq = 0;
+
+          /* Move RP and WP to rp with Offer/Poll. */
+
+          CMN_SimpleFifoInitialize(&fifo, s_small_buf, SMALL_SIZE, NULL);
+          if (rp > 0)
+            {
+              memset(out, 0, sizeof(out));
+              CMN_SimpleFifoOffer(&fifo, out, rp);
+              CMN_SimpleFifoPoll(&fifo, out, rp);
+            }
+
+          check_layout(&fifo, rp, rp);
+
+          /* Write len bytes in place. */
+
+          CMN_SimpleFifoGetWriteRegions(&fifo, &r);
+          fill(&r, len, &wseq);
+          CHECK(CMN_SimpleFifoCommitWrite(&fifo, len) == len,
+                "rp %zu: commit %zu", rp, len);
+
+          check_layout(&fifo, rp, wp);
+
+          /* Committing or releasing more than there is fails. */
+
+          CHECK(CMN_SimpleFifoCommitWrite(&fifo, SMALL_SIZE - len) == 0,
+                "rp %zu wp %zu: commit over vacant", rp, wp);
+          CHECK(CMN_SimpleFifoReleaseRead(&fifo, len + 1) == 0,
+                "rp %zu wp %zu: release over occupied", rp, wp);
+          check_layout(&fifo, rp, wp);
+
+          /* Read them in place, and release half of them. */
+
+          CMN_SimpleFifoGetReadRegions(&fifo, &r);
+          CHECK(verify(&r, len, &rseq),
+                "rp %zu wp %zu: data read in place", rp, wp);
+          CHECK(CMN_SimpleFifoReleaseRead(&fifo, len / 2) == len / 2,
+                "rp %zu wp %zu: release %zu", rp, wp, len / 2);
+
+          check_layout(&fifo, (rp + len / 2) % SMALL_SIZE, wp);
+
+          /* The rest is polled as it was written. */
+
+          size_t rest = len - len / 2;
+          memset(out, 0, sizeof(out));
+          CHECK(CMN_SimpleFifoPoll(&fifo, out, rest) == rest,
+                "rp %zu wp %zu: poll %zu", rp, wp, rest);
+          for (size_t i = 0; i < rest; i++)
+            {
+              CHECK(out[i] == (uint8_t)(len / 2 + i),
+                    "rp %zu wp %zu: polled byte %zu", rp, wp, i);
+            }
+
+          check_layout(&fifo, wp, wp);
+        }
+    }
+}
+
+/* Random sizes through the regions and Offer/Poll, checked against
+ * the byte counter and the size queries.
+ */
+
+static void test_random(void)
+{
+  CMN_SimpleFifoHandle fifo;
+  CMN_SimpleFifoPeekHandle r;
+  uint8_t tmp[SMALL_SIZE];
+  uint8_t wseq = 0;
+  uint8_t rseq = 0;
+  int bad = 0;
+
+  printf("random write/read cycles\n");
+
+  srand(1);
+  CMN_SimpleFifoInitialize(&fifo, s_small_buf, SMALL_SIZE, NULL);
+
+  for (int i = 0; i < RANDOM_LOOPS && bad < 10; i++)
+    {
+      size_t avail = CMN_SimpleFifoGetWriteRegions(&fifo, &r);
+      size_t len = rand() % (avail + 1);
+
+      if (rand() & 1)
+        {
+          fill(&r, len, &wseq);
+          CMN_SimpleFifoCommitWrite(&fifo, len);
+        }
+      else
+        {
+          for (size_t j = 0; j < len; j++)
+            {
+              tmp[j] = wseq++;
+            }
+          CMN_SimpleFifoOffer(&fifo, tmp, len);
+        }
+
+      avail = CMN_SimpleFifoGetReadRegions(&fifo, &r);
+      len = rand() % (avail + 1);
+
+      if (rand() & 1)
+        {
+          if (!verify(&r, len, &rseq))
+            {
+              CHECK(0, "loop %d: data read in place", i);
+              bad++;
+            }
+          CMN_SimpleFifoReleaseRead(&fifo, len);
+        }
+      else
+        {
+          CMN_SimpleFifoPoll(&fifo, tmp, len);
+          for (size_t j = 0; j < len; j++)
+            {
+              if (tmp[j] != rseq++)
+                {
+                  CHECK(0, "loop %d: polled data", i);
+                  bad++;
+                  break;
+                }
+            }
+        }
+
+      if (CMN_SimpleFifoGetOccupiedSize(&fifo) != (uint8_t)(wseq - rseq))
+        {
+          CHECK(0, "loop %d: occupied %zu, expected %u", i,
+                CMN_SimpleFifoGetOccupiedSize(&fifo),
+                (uint8_t)(wseq - rseq));
+          bad++;
+        }
+    }
+}
+
+static void *writer(void *arg)
+{
+  struct thread_s *t = (struct thread_s *)arg;
+  CMN_SimpleFifoPeekHandle r;
+  uint8_t seq = 0;
+  size_t done = 0;
+
+  while (done < THREAD_BYTES)
+    {
+      if (CMN_SimpleFifoGetWriteRegions(&t->fifo, &r) < t->chunk)
+        {
+          sched_yield();
+          continue;
+        }
+      fill(&r, t->chunk, &seq);
+      CMN_SimpleFifoCommitWrite(&t->fifo, t->chunk);
+      done += t->chunk;
+    }
+  return NULL;
+}
+
+/* A writer thread and a reader thread pass data through the regions
+ * only, relying on the ordering of the index updates.
+ */
+
+static void test_threads(size_t chunk)
+{
+  struct thread_s t;
+  CMN_SimpleFifoPeekHandle r;
+  pthread_t thread;
+  uint8_t seq = 0;
+  size_t done = 0;
+
+  printf("writer and reader threads, %zu byte chunks\n", chunk);
+
+  CMN_SimpleFifoInitialize(&t.fifo, s_bench_buf, BENCH_SIZE, NULL);
+  t.chunk = chunk;
+  t.error = 0;
+
+  pthread_create(&thread, NULL, writer, &t);
+
+  while (done < THREAD_BYTES)
+    {
+      if (CMN_SimpleFifoGetReadRegions(&t.fifo, &r) < chunk)
+        {
+          sched_yield();
+          continue;
+        }
+      t.error |= !verify(&r, chunk, &seq);
+      CMN_SimpleFifoReleaseRead(&t.fifo, chunk);
+      done += chunk;
+    }
+
+  pthread_join(thread, NULL);
+  CHECK(!t.error, "data through regions");
+}
+
+/* Each loop writes a chunk and reads it back, as a player fills the
+ * FIFO from a file and parses it. The FIFO size is not a multiple of
+ * the chunk, so the regions are split at the end of the buffer now
+ * and then.
+ */
+
+static void bench(size_t chunk, int regions)
+{
+  CMN_SimpleFifoHandle fifo;
+  CMN_SimpleFifoPeekHandle r;
+  uint8_t staging[BENCH_SIZE];
+  uint8_t wseq = 0;
+  uint8_t rseq = 0;
+  int error = 0;
+  double start;
+  double sec;
+
+  CMN_SimpleFifoInitialize(&fifo, s_bench_buf, BENCH_SIZE, NULL);
+
+  start = now();
+
+  for (size_t done = 0; done < BENCH_BYTES; done += chunk)
+    {
+      if (regions)
+        {
+          /* Produce the data in the FIFO buffer and parse it there. */
+
+          CMN_SimpleFifoGetWriteRegions(&fifo, &r);
+          fill(&r, chunk, &wseq);
+          CMN_SimpleFifoCommitWrite(&fifo, chunk);
+
+          CMN_SimpleFifoGetReadRegions(&fifo, &r);
+          error |= !verify(&r, chunk, &rseq);
+          CMN_SimpleFifoReleaseRead(&fifo, chunk);
+        }
+      else
+        {
+          /* Produce the data in a staging buffer and offer it,
+           * then poll it to a staging buffer and parse it there.
+           */
+
+          wseq = put_bytes(staging, chunk, wseq);
+          CMN_SimpleFifoOffer(&fifo, staging, chunk);
+
+          CMN_SimpleFifoPoll(&fifo, staging, chunk);
+          error |= !check_bytes(staging, chunk, rseq);
+          rseq += chunk;
+        }
+    }
+
+  sec = now() - start;
+
+  printf("  %-8s %5zu byte chunks %9.1f MB/s\n",
+         regions ? "regions" : "copy", chunk, BENCH_BYTES / sec / 1e6);
+  CHECK(!error, "data through %s", regions ? "regions" : "copy");
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, char *argv[])
+{
+  test_wrap_around();
+  test_random();
+  test_threads(64);
+  test_threads(1000);
+
+  printf("benchmark (%d MB through %d byte FIFO)\n",
+         BENCH_BYTES / (1024 * 1024), BENCH_SIZE);
+
+  for (int regions = 0; regions < 2; regions++)
+    {
+      bench(64, regions);
+      bench(512, regions);
+      bench(2048, regions);
+    }
+
+  printf("%s (%d failure)\n", s_fail == 0 ? "PASS" : "FAIL", s_fail);
+  return s_fail == 0 ? 0 : 1;
+}
@@ -0,0 +1,218 @@
+#!/usr/bin/env python
+############################################################################
+# tools/audiotrace.py
+#
+#   Copyright 2018 Sony Semiconductor Solutions Corporation
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#
+# 1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in
+#    the documentation and/or other materials provided with the
+#    distribution.
+# 3. Neither the name of Sony Semiconductor Solutions Corporation nor
+#    the names of its contributors may be used to endorse or promote
+#    products derived from this software without specific prior written
+#    permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+# FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+# COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+# INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+# BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+# OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+# AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+# ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+############################################################################
+
+# Analyze audio pipeline trace (CONFIG_AUDIOUTILS_TRACE).
+#
+# Usage: audiotrace.py <console log>
+#
+# The log must contain the output of AS_DumpAudioTrace(). Events of
+# the same frame are matched by the sequence number of each stage,
+# latency between adjacent stages and period jitter are printed and
+# the stage which was late is reported for each underflow.
+
+from __future__ import print_function
+
+import sys
+
+# Pipeline stages of one frame, in processing order.
+
+STAGES = ['EsRead', 'DecReq', 'DecDone', 'PcmSend',
+          'MixIn', 'RenderReq', 'DmaDone']
+
+CAUSES = {
+    'EsRead':    'ES is not supplied in time (input starvation)',
+    'DecReq':    'decode is not requested in time (player task is busy)',
+    'DecDone':   'DSP decode is too slow',
+    'PcmSend':   'decoded PCM is not sent in time (player task is busy)',
+    'MixIn':     'PCM does not reach output mixer in time',
+    'RenderReq': 'postfilter / output mixer processing is too slow',
+    'DmaDone':   'data was queued to renderer too late',
+}
+
+HIST_BINS = 10
+HIST_WIDTH = 40
+
+def parse(f):
+    clk = 0
+    events = []
+    last = None
+    wrap = 0
+
+    for line in f:
+        pos = line.find('audiotrace:')
+        if pos < 0:
+            continue
+        words = line[pos:].split()[1:]
+        if len(words) == 0:
+            continue
+        if words[0] == 'begin':
+            clk = int(words[2])
+            events = []
+            last = None
+            wrap = 0
+            continue
+        if words[0] == 'end' or len(words) < 4:
+            continue
+
+        cycle = int(words[0], 16)
+        if last is not None and cycle < last:
+            wrap += 1 << 32
+        last = cycle
+
+        events.append((cycle + wrap, words[1], int(words[2]), int(words[3])))
+
+    if clk == 0:
+        print('audiotrace: no trace found', file=sys.stderr)
+        sys.exit(1)
+
+    # Convert to usec from start of trace.
+
+    base = events[0][0] if events else 0
+    return [((t - base) * 1000000.0 / clk, s, q, a) for (t, s, q, a) in events]
+
+def split_sessions(events):
+    sessions = []
+    cur = []
+    for ev in events:
+        if ev[1] == 'PlayStart' and cur:
+            sessions.append(cur)
+            cur = []
+        cur.append(ev)
+    if cur:
+        sessions.append(cur)
+    return sessions
+
+def percentile(values, p):
+    s = sorted(values)
+    idx = int(round((len(s) - 1) * p / 100.0))
+    return s[idx]
+
+def print_stats(title, values):
+    if not values:
+        return
+    avg = sum(values) / len(values)
+    print('  %-22s n %5d  min %8.1f  avg %8.1f  p99 %8.1f  max %8.1f us'
+          % (title, len(values), min(values), avg,
+             percentile(values, 99), max(values)))
+
+def print_histogram(values):
+    lo = min(values)
+    hi = max(values)
+    step = (hi - lo) / HIST_BINS
+    if step <= 0:
+        return
+    bins = [0] * HIST_BINS
+    for v in values:
+        bins[min(int((v - lo) / step), HIST_BINS - 1)] += 1
+    peak = max(bins)
+    for i in range(HIST_BINS):
+        print('    %8.1f - %8.1f | %-*s %d'
+              % (lo + step * i, lo + step * (i + 1),
+                 HIST_WIDTH, '#' * (bins[i] * HIST_WIDTH // peak), bins[i]))
+
+def analyze(session, num):
+    # frames[stage][seq] = time
+
+    frames = dict((s, {}) for s in STAGES)
+    underflows = []
+
+    for (t, stage, seq, arg) in session:
+        if stage in frames:
+            frames[stage][seq] = t
+        elif stage == 'Underflow':
+            underflows.append((t, arg))
+
+    print('session %d: %d events' % (num, len(session)))
+
+    print(' stage latency')
+    for i in range(len(STAGES) - 1):
+        a = frames[STAGES[i]]
+        b = frames[STAGES[i + 1]]
+        values = [b[q] - a[q] for q in a if q in b and b[q] >= a[q]]
+        if values:
+            print_stats('%s -> %s' % (STAGES[i], STAGES[i + 1]), values)
+            print_histogram(values)
+
+    print(' period jitter')
+    for stage in ['MixIn', 'DmaDone']:
+        times = [frames[stage][q] for q in sorted(frames[stage])]
+        values = [times[i + 1] - times[i] for i in range(len(times) - 1)]
+        if values:
+            print_stats(stage + ' period', values)
+
+    # DMA driver reports underflow first (arg 1), output mixer reports
+    # the same underflow later (arg 0). Use the earliest of each burst.
+
+    reported = None
+    for (t, arg) in underflows:
+        if reported is not None and arg == 0:
+            continue
+        reported = t
+
+        # The frame DMA needed next is the one after the last completed.
+
+        need = len([q for q in frames['DmaDone']
+                    if frames['DmaDone'][q] <= t])
+        late = None
+        for stage in STAGES:
+            ts = frames[stage].get(need)
+            if ts is None or ts > t:
+                late = stage
+                break
+
+        print(' underflow at %.1f us (frame %d)' % (t, need))
+        if late is None:
+            print('   frame %d reached all stages before underflow' % need)
+        else:
+            ts = frames[late].get(need)
+            when = ('%.1f us late' % (ts - t)) if ts is not None \
+                else 'never reached'
+            print('   stopped before %s (%s)' % (late, when))
+            print('   cause: %s' % CAUSES[late])
+
+def main():
+    if len(sys.argv) < 2:
+        print('Usage: %s <console log>' % sys.argv[0], file=sys.stderr)
+        sys.exit(1)
+
+    with open(sys.argv[1]) as f:
+        events = parse(f)
+
+    for (num, session) in enumerate(split_sessions(events)):
+        analyze(session, num)
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,784 @@
+#!/usr/bin/env python
+############################################################################
+# tools/nnbquant.py
+#
+#   Copyright 2018 Sony Semiconductor Solutions Corporation
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#
+# 1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in
+#    the documentation and/or other materials provided with the
+#    distribution.
+# 3. Neither the name of Sony Semiconductor Solutions Corporation nor
+#    the names of its contributors may be used to endorse or promote
+#    products derived from this software without specific prior written
+#    permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+# FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+# COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+# INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+# BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+# OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+# AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+# ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+############################################################################
+
+# Convert a float nnb for dnnrt into int8 layers quantized per channel
+# (CONFIG_DNN_RT_QUANT), and report accuracy against the float model.
+#
+# Usage: nnbquant.py [-c calib.npy]... [-e eval.npy]... [-k index]...
+#                    [-o output.nnb] input.nnb
+#
+# Each npy holds samples of one network input (in order of the inputs),
+# as an array of any shape whose size is a multiple of the input size.
+# Calibration data (-c) gives the range of each activation, evaluation
+# data (-e, default: calibration data) is used for the report. Both the
+# float model and the int8 model, emulated exactly as dnnrt executes it,
+# are run on the host. Requires numpy.
+#
+# Convolution, depthwise convolution and affine are quantized unless
+# their index is given by -k. Weights are int8 with a scale for each
+# output channel, bias is int32 and activations between such layers
+# are int8 with a scale and a zero point. ReLU which follows a quantized
+# layer is folded into it. Inputs and outputs of the network stay float.
+# Parameters of each int8 layer begin with a magic number and the version
+# of their layout, which dnnrt checks.
+#
+# modules/dnnrt/test/nnbquant_test.py is the round trip test of this tool.
+#
+# The nnb layout assumed here is that of nnabla-c-runtime: a graph with
+# lists of int32 offsets, followed by the data of memory blocks.
+
+from __future__ import print_function
+
+import argparse
+import struct
+import sys
+
+import numpy as np
+
+# nnablart/network.h
+
+NETWORK_LISTS = ['buffers', 'variables', 'functions', 'inputs', 'outputs',
+                 'memory_blocks']
+
+TYPE_FLOAT = 0
+TYPE_INT16 = 1
+TYPE_INT8 = 2
+
+# nnablart/functions.h
+
+AFFINE = 0
+CONVOLUTION = 1
+DEPTHWISE_CONVOLUTION = 2
+MAX_POOLING = 5
+AVERAGE_POOLING = 6
+RELU = 14
+SOFTMAX = 16
+
+FUNCTION_NAMES = {
+    AFFINE: 'Affine',
+    CONVOLUTION: 'Convolution',
+    DEPTHWISE_CONVOLUTION: 'DWConv',
+    MAX_POOLING: 'MaxPooling',
+    AVERAGE_POOLING: 'AvgPooling',
+    RELU: 'ReLU',
+    SOFTMAX: 'Softmax',
+}
+
+FUNCTION_HEADER = 20            # type, impl, inputs, outputs
+
+# dnnrt/runtime.h
+
+DNNRT_IMPLEMENT_QINT8 = 0x51
+
+# dnn_quant_param_t of runtime_quant.h, followed by mult[] and shift[]
+
+QUANT_MAGIC = 0x51384e44        # "DN8Q"
+QUANT_VERSION = 1               # DNN_QUANT_VERSION, changed with the layout
+PARAM_WORDS = 8
+
+QUANTIZED = (CONVOLUTION, DEPTHWISE_CONVOLUTION, AFFINE)
+POOLING = (MAX_POOLING, AVERAGE_POOLING)
+
+def fail(msg):
+    print('nnbquant: ' + msg, file=sys.stderr)
+    sys.exit(1)
+
+############################################################################
+# nnb
+
+class Variable(object):
+    pass
+
+class Function(object):
+    pass
+
+class Nnb(object):
+    def __init__(self, data):
+        self.data = bytearray(data)
+        self.lists = {}
+        for (i, name) in enumerate(NETWORK_LISTS):
+            self.lists[name] = struct.unpack_from('<ii', self.data, 8 + i * 8)
+
+        self.buffers = self.ints(self.lists['buffers'])
+        self.blocks = self.ints(self.lists['memory_blocks'])
+        self.inputs = self.ints(self.lists['inputs'])
+        self.outputs = self.ints(self.lists['outputs'])
+        self.variables = [self.read_variable(i, off) for (i, off) in
+                          enumerate(self.ints(self.lists['variables']))]
+        self.functions = [self.read_function(i, off) for (i, off) in
+                          enumerate(self.ints(self.lists['functions']))]
+
+        # parameters must follow the graph
+
+        self.graph_bsize = min(self.blocks) if self.blocks else len(data)
+        for (size, pos) in self.lists.values():
+            if pos < 0 or pos + size * 4 > self.graph_bsize:
+                fail('memory blocks are not at the end of nnb')
+
+    def ints(self, lst, fmt='i'):
+        (size, pos) = lst
+        return list(struct.unpack_from('<%d%s' % (size, fmt), self.data, pos))
+
+    def read_variable(self, index, off):
+        v = Variable()
+        v.index = index
+        v.offset = off
+        shape = struct.unpack_from('<ii', self.data, off)
+        v.shape = tuple(self.ints(shape))
+        (v.bits, v.data_index) = struct.unpack_from('<Ii', self.data, off + 8)
+        v.type = v.bits & 0xf
+        v.size = int(np.prod(v.shape)) if v.shape else 1
+        return v
+
+    def read_function(self, index, off):
+        f = Function()
+        f.index = index
+        f.offset = off
+        (f.type, f.impl) = struct.unpack_from('<HH', self.data, off)
+        f.inputs = self.ints(struct.unpack_from('<ii', self.data, off + 4))
+        f.outputs = self.ints(struct.unpack_from('<ii', self.data, off + 12))
+        f.inputs_pos = struct.unpack_from('<ii', self.data, off + 4)[1]
+        f.outputs_pos = struct.unpack_from('<ii', self.data, off + 12)[1]
+        f.name = FUNCTION_NAMES.get(f.type, 'Function%d' % f.type)
+        self.read_args(f, off + FUNCTION_HEADER)
+        return f
+
+    def arg_list(self, pos):
+        return self.ints(struct.unpack_from('<ii', self.data, pos))
+
+    def arg_int(self, pos, fmt='<i'):
+        return struct.unpack_from(fmt, self.data, pos)[0]
+
+    def read_args(self, f, pos):
+        if f.type == AFFINE:
+            f.base_axis = self.arg_int(pos)
+        elif f.type in (CONVOLUTION, DEPTHWISE_CONVOLUTION):
+            f.base_axis = self.arg_int(pos)
+            f.pad = self.arg_list(pos + 4)
+            f.stride = self.arg_list(pos + 12)
+            f.dilation = self.arg_list(pos + 20)
+            f.group = self.arg_int(pos + 28)    # multiplier of DWConv
+        elif f.type in POOLING:
+            f.kernel = self.arg_list(pos)
+            f.stride = self.arg_list(pos + 8)
+            f.pad = self.arg_list(pos + 20)
+            f.including_pad = 0
+            if f.type == AVERAGE_POOLING:
+                f.including_pad = self.arg_int(pos + 28, '<B')
+        elif f.type == SOFTMAX:
+            f.axis = self.arg_int(pos)
+
+    def param(self, v):
+        if v.data_index < 0:
+            return None
+        pos = self.blocks[v.data_index]
+        return np.frombuffer(self.data, dtype='<f4', count=v.size,
+                             offset=pos).reshape(v.shape)
+
+############################################################################
+# kernels, as executed by dnnrt
+
+def pool_window(o, stride, pad, ker, size, including_pad):
+    s = o * stride - pad
+    e = min(s + ker, size + pad)
+    num = e - s
+    s = max(s, 0)
+    e = min(e, size)
+    if not including_pad:
+        num = e - s
+    return (s, e, num)
+
+def div_round(s, n):
+    # C division truncates toward zero
+    q = (np.abs(s) + n // 2) // n
+    return np.where(s >= 0, q, -q)
+
+def pooling(f, x, out_shape, fixed):
+    (kh, kw) = f.kernel[-2:]
+    (sh, sw) = f.stride[-2:]
+    (ph, pw) = f.pad[-2:] if len(f.pad) >= 2 else (0, 0)
+    planes = x.reshape((-1,) + x.shape[-2:])
+    (ih, iw) = planes.shape[-2:]
+    (oh, ow) = out_shape[-2:]
+    y = np.zeros((planes.shape[0], oh, ow), dtype=x.dtype)
+    for oy in range(oh):
+        (y0, y1, ny) = pool_window(oy, sh, ph, kh, ih, f.including_pad)
+        for ox in range(ow):
+            (x0, x1, nx) = pool_window(ox, sw, pw, kw, iw, f.including_pad)
+            win = planes[:, y0:y1, x0:x1].reshape(planes.shape[0], -1)
+            if f.type == MAX_POOLING:
+                y[:, oy, ox] = win.max(axis=1) if win.shape[1] else \
+                    (-128 if fixed else np.finfo(np.float32).min)
+            elif nx * ny <= 0:
+                y[:, oy, ox] = 0
+            elif fixed:
+                y[:, oy, ox] = div_round(win.astype(np.int64).sum(axis=1),
+                                         nx * ny)
+            else:
+                y[:, oy, ox] = win.sum(axis=1) / (nx * ny)
+    return y.reshape(out_shape)
+
+def im2col(x, kh, kw, sh, sw, ph, pw, oh, ow):
+    # x: [batch, ch, h, w] -> [batch, oh * ow, ch * kh * kw]
+    (n, c, h, w) = x.shape
+    xp = np.zeros((n, c, h + 2 * ph + sh * oh + kh,
+                   w + 2 * pw + sw * ow + kw), dtype=x.dtype)
+    xp[:, :, ph:ph + h, pw:pw + w] = x
+    cols = np.zeros((n, c, kh, kw, oh, ow), dtype=x.dtype)
+    for ky in range(kh):
+        for kx in range(kw):
+            cols[:, :, ky, kx] = xp[:, :, ky:ky + sh * oh:sh,
+                                    kx:kx + sw * ow:sw]
+    return cols.transpose(0, 4, 5, 1, 2, 3).reshape(n, oh * ow, -1)
+
+def conv_acc(f, x, w, b, out_shape):
+    # x is float or int (x - zero point), padding is 0
+    batch = int(np.prod(x.shape[:f.base_axis]))
+    x = x.reshape((batch,) + x.shape[f.base_axis:])
+    (oh, ow) = out_shape[-2:]
+    (kh, kw) = w.shape[-2:]
+    if f.type == DEPTHWISE_CONVOLUTION:
+        groups = x.shape[1]
+        w = w.reshape(groups, 1, kh, kw)
+    else:
+        groups = f.group
+    oc = w.shape[0]
+    cin = x.shape[1] // groups
+    y = np.zeros((batch, oc, oh * ow), dtype=np.result_type(x, w, b))
+    for g in range(groups):
+        xg = x[:, g * cin:(g + 1) * cin]
+        cols = im2col(xg, kh, kw, f.stride[0], f.stride[1],
+                      f.pad[0], f.pad[1], oh, ow)
+        wg = w[g * (oc // groups):(g + 1) * (oc // groups)]
+        wg = wg.reshape(wg.shape[0], -1)
+        y[:, g * wg.shape[0]:(g + 1) * wg.shape[0]] = \
+            np.einsum('npk,ok->nop', cols, wg)
+    y += b.reshape(1, oc, 1)
+    return y.reshape(out_shape)
+
+def affine_acc(f, x, w, b, out_shape):
+    batch = int(np.prod(x.shape[:f.base_axis]))
+    x = x.reshape(batch, -1)
+    # dnnrt reads the weight as [outputs][inputs]
+    w = w.reshape(-1, x.shape[1])
+    return (x.dot(w.T) + b.reshape(1, -1)).reshape(out_shape)
+
+def layer_acc(f, x, w, b, out_shape):
+    if f.type == AFFINE:
+        return affine_acc(f, x, w, b, out_shape)
+    return conv_acc(f, x, w, b, out_shape)
+
+def channel_axis(f):
+    # output channel of weight and y
+    return f.base_axis
+
+def softmax(f, x):
+    e = np.exp(x - x.max(axis=f.axis, keepdims=True))
+    return e / e.sum(axis=f.axis, keepdims=True)
+
+def out_channels(f, out_shape):
+    if f.type == AFFINE:
+        return int(np.prod(out_shape[f.base_axis:]))
+    return out_shape[channel_axis(f)]
+
+def run_function(f, x, get, out_shape):
+    # pooling of int8 x gives int8, everything else is float
+    if f.type in QUANTIZED:
+        w = get(f.inputs[1]).astype(np.float64)
+        if len(f.inputs) > 2:
+            b = get(f.inputs[2]).astype(np.float64)
+        else:
+            b = np.zeros(out_channels(f, out_shape))
+        return layer_acc(f, x.astype(np.float64), w, b, out_shape)
+    if f.type in POOLING:
+        return pooling(f, x, out_shape, x.dtype == np.int8)
+    if f.type == RELU:
+        return np.maximum(x, 0)
+    if f.type == SOFTMAX:
+        return softmax(f, x)
+    fail('%s is not supported' % f.name)
+
+############################################################################
+# float model
+
+def run_float(nnb, inputs, observe=None):
+    values = {}
+    for (vid, x) in zip(nnb.inputs, inputs):
+        values[vid] = x.astype(np.float32)
+
+    def get(vid):
+        if vid not in values:
+            values[vid] = nnb.param(nnb.variables[vid]).astype(np.float32)
+        return values[vid]
+
+    for f in nnb.functions:
+        x = get(f.inputs[0])
+        out_shape = nnb.variables[f.outputs[0]].shape
+        y = run_function(f, x, get, out_shape)
+        values[f.outputs[0]] = y.astype(np.float32)
+        if observe:
+            observe(f.outputs[0], values[f.outputs[0]])
+
+    return [values[vid] for vid in nnb.outputs]
+
+############################################################################
+# quantization
+
+def act_qparam(lo, hi):
+    lo = min(lo, 0.0)
+    hi = max(hi, 0.0)
+    if hi - lo < 1e-12:
+        hi = lo + 1e-12
+    scale = float(np.float32((hi - lo) / 255.0))
+    zero = int(np.clip(np.round(-128 - lo / scale), -128, 127))
+    return (scale, zero)
+
+def multiplier(m):
+    # m = mult / 2^31 * 2^shift, 2^30 <= mult < 2^31
+    if m <= 0:
+        return (0, 0)
+    (frac, shift) = np.frexp(m)
+    mult = int(np.round(frac * (1 << 31)))
+    if mult == 1 << 31:
+        mult //= 2
+        shift += 1
+    if shift < -31:
+        return (0, 0)
+    return (mult, int(min(shift, 30)))
+
+class Plan(object):
+    pass
+
+def consumers(nnb, vid):
+    return [f for f in nnb.functions if vid in f.inputs]
+
+def make_plan(nnb, keep, ranges):
+    plan = Plan()
+    plan.layers = {}            # function index -> layer
+    plan.folded = set()         # ReLU folded into a layer
+    plan.int8 = set()           # int8 activations
+    plan.root = {}              # activation -> the one with its qparam
+
+    weights = {}
+    for f in nnb.functions:
+        for vid in f.inputs[1:]:
+            weights[vid] = weights.get(vid, 0) + 1
+
+    for f in nnb.functions:
+        if f.type not in QUANTIZED or f.index in keep:
+            continue
+        if f.type == CONVOLUTION and (len(f.dilation) != 2 or
+                                      f.dilation != [1, 1]):
+            continue
+        if f.type == DEPTHWISE_CONVOLUTION and (f.group != 1 or
+                                                f.dilation != [1, 1]):
+            continue
+        if any(weights[vid] > 1 for vid in f.inputs[1:]):
+            continue
+        layer = Plan()
+        layer.f = f
+        layer.y = f.outputs[0]
+        layer.relu = None
+        plan.layers[f.index] = layer
+
+    # fold ReLU which is the only consumer of a layer
+
+    for layer in plan.layers.values():
+        users = consumers(nnb, layer.y)
+        if len(users) == 1 and users[0].type == RELU and \
+           layer.y not in nnb.outputs:
+            layer.relu = users[0]
+            layer.y = users[0].outputs[0]
+            plan.folded.add(users[0].index)
+
+    functions = [f for f in nnb.functions if f.index not in plan.folded]
+    producer = {}
+    for f in functions:
+        if f.index not in plan.layers:
+            producer[f.outputs[0]] = f
+    for layer in plan.layers.values():
+        producer[layer.y] = layer.f
+
+    def int8_user(f, vid):
+        if f.index in plan.layers:
+            return f.inputs[0] == vid and vid not in f.inputs[1:]
+        if f.type == MAX_POOLING:
+            return True
+        if f.type == AVERAGE_POOLING:
+            return not (f.including_pad and any(f.pad))
+        return False
+
+    # activations between int8 layers, pooling keeps the representation
+
+    cand = set(producer)
+    changed = True
+    while changed:
+        changed = False
+        for vid in list(cand):
+            f = producer[vid]
+            ok = vid not in nnb.outputs and vid not in nnb.inputs
+            if f.index not in plan.layers:
+                ok = ok and f.type in POOLING and f.inputs[0] in cand
+            users = [u for u in functions if vid in u.inputs]
+            ok = ok and all(int8_user(u, vid) for u in users)
+            ok = ok and all(u.outputs[0] in cand for u in users
+                            if u.type in POOLING and
+                            u.index not in plan.layers)
+            if not ok:
+                cand.discard(vid)
+                changed = True
+    plan.int8 = cand
+
+    for vid in plan.int8:
+        root = vid
+        while producer[root].index not in plan.layers:
+            root = producer[root].inputs[0]
+        plan.root[vid] = root
+
+    # parameters of each layer
+
+    for layer in plan.layers.values():
+        f = layer.f
+        xv = f.inputs[0]
+        (lo, hi) = ranges[plan.root.get(xv, xv)]
+        (layer.in_scale, layer.in_zero) = act_qparam(lo, hi)
+        (lo, hi) = ranges[layer.y]
+        (layer.out_scale, layer.out_zero) = act_qparam(lo, hi)
+        layer.act_min = layer.out_zero if layer.relu else -128
+        layer.act_max = 127
+
+        w = nnb.param(nnb.variables[f.inputs[1]]).astype(np.float64)
+        wshape = w.shape
+        ch = out_channels(f, nnb.variables[f.outputs[0]].shape)
+        w = w.reshape(ch, -1)
+        amax = np.abs(w).max(axis=1)
+        w_scale = np.where(amax > 0, amax / 127.0, 1.0)
+        layer.w_scale = w_scale
+        layer.wq = np.clip(np.round(w / w_scale[:, None]), -127, 127)
+        layer.wq = layer.wq.astype(np.int8).reshape(wshape)
+        if len(f.inputs) > 2:
+            b = nnb.param(nnb.variables[f.inputs[2]]).astype(np.float64)
+        else:
+            b = np.zeros(ch)
+        acc_scale = layer.in_scale * w_scale
+        layer.bq = np.clip(np.round(b.reshape(-1) / acc_scale),
+                           -(1 << 31), (1 << 31) - 1).astype(np.int32)
+        m = [multiplier(s / layer.out_scale) for s in acc_scale]
+        layer.mult = np.array([v[0] for v in m], dtype=np.int32)
+        layer.shift = np.array([v[1] for v in m], dtype=np.int32)
+        layer.channels = ch
+
+    return plan
+
+def quantize_input(x, scale, zero):
+    inv = np.float32(1.0) / np.float32(scale)
+    v = np.clip(x.astype(np.float32) * inv, -256.0, 256.0).astype(np.float32)
+    r = np.where(v >= 0, np.trunc(v + np.float32(0.5)),
+                 np.trunc(v - np.float32(0.5))).astype(np.int32) + zero
+    return np.clip(r, -128, 127).astype(np.int8)
+
+def requantize(acc, mult, shift, layer):
+    total = (31 - shift).astype(np.int64)
+    v = (acc.astype(np.int64) * mult.astype(np.int64) +
+         (np.int64(1) << (total - 1))) >> total
+    v = v + layer.out_zero
+    return np.clip(v, layer.act_min, layer.act_max).astype(np.int8)
+
+def run_int8(nnb, plan, inputs):
+    values = {}
+    for (vid, x) in zip(nnb.inputs, inputs):
+        values[vid] = x.astype(np.float32)
+
+    def get(vid):
+        if vid not in values:
+            values[vid] = nnb.param(nnb.variables[vid]).astype(np.float32)
+        return values[vid]
+
+    for f in nnb.functions:
+        if f.index in plan.folded:
+            continue
+        x = get(f.inputs[0])
+        if f.index in plan.layers:
+            layer = plan.layers[f.index]
+            out_shape = nnb.variables[layer.y].shape
+            if x.dtype != np.int8:
+                x = quantize_input(x, layer.in_scale, layer.in_zero)
+            xo = x.astype(np.int64) - layer.in_zero
+            acc = layer_acc(f, xo, layer.wq.astype(np.int64),
+                            layer.bq.astype(np.int64), out_shape)
+            ax = channel_axis(f)
+            shape = [1] * len(out_shape)
+            if f.type == AFFINE:
+                acc = acc.reshape(acc.shape[:ax] + (-1,))
+                shape = [1] * acc.ndim
+                ax = acc.ndim - 1
+            shape[ax] = layer.channels
+            y = requantize(acc, layer.mult.reshape(shape),
+                           layer.shift.reshape(shape), layer)
+            y = y.reshape(out_shape)
+            if layer.y not in plan.int8:
+                y = (y.astype(np.float32) - np.float32(layer.out_zero)) * \
+                    np.float32(layer.out_scale)
+            values[layer.y] = y
+            continue
+
+        out_shape = nnb.variables[f.outputs[0]].shape
+        y = run_function(f, x, get, out_shape)
+        values[f.outputs[0]] = y if y.dtype == np.int8 else \
+            y.astype(np.float32)
+
+    return [values[vid] for vid in nnb.outputs]
+
+############################################################################
+# output
+
+class Writer(object):
+    def __init__(self, nnb):
+        self.nnb = nnb
+        self.data = bytearray(nnb.data[:nnb.graph_bsize])
+        self.align(4)
+
+    def align(self, n):
+        while len(self.data) % n:
+            self.data.append(0)
+
+    def append(self, fmt, *values):
+        pos = len(self.data)
+        self.data += struct.pack('<' + fmt, *values)
+        return pos
+
+    def append_list(self, values):
+        return (len(values),
+                self.append('%di' % len(values), *values))
+
+    def patch(self, pos, fmt, *values):
+        struct.pack_into('<' + fmt, self.data, pos, *values)
+
+    def patch_list(self, pos, lst):
+        self.patch(pos, 'ii', *lst)
+
+def set_type(w, v, dtype):
+    v.bits = (v.bits & ~0xff) | dtype
+    v.type = dtype
+    w.patch(v.offset + 8, 'I', v.bits)
+
+def write_nnb(nnb, plan):
+    w = Writer(nnb)
+    variables = list(nnb.variables)
+    blocks = {}                 # variable index -> data of the block
+
+    def new_variable(shape, dtype, data):
+        v = Variable()
+        v.index = len(variables)
+        shape_list = w.append_list(list(shape))
+        v.bits = dtype
+        v.type = dtype
+        v.data_index = 0
+        v.offset = w.append('iiIi', shape_list[0], shape_list[1], v.bits, 0)
+        variables.append(v)
+        blocks[v.index] = data
+        return v
+
+    for vid in plan.int8:
+        set_type(w, nnb.variables[vid], TYPE_INT8)
+
+    for layer in plan.layers.values():
+        f = layer.f
+        wv = nnb.variables[f.inputs[1]]
+        set_type(w, wv, TYPE_INT8)
+        blocks[wv.index] = layer.wq.tobytes()
+
+        if len(f.inputs) > 2:
+            bv = nnb.variables[f.inputs[2]]
+            blocks[bv.index] = layer.bq.astype('<i4').tobytes()
+        else:
+            bv = new_variable((layer.channels,), TYPE_FLOAT,
+                              layer.bq.astype('<i4').tobytes())
+
+        param = struct.pack('<iiiiiiff', QUANT_MAGIC, QUANT_VERSION,
+                            layer.in_zero, layer.out_zero,
+                            layer.act_min, layer.act_max,
+                            layer.in_scale, layer.out_scale)
+        param += layer.mult.astype('<i4').tobytes()
+        param += layer.shift.astype('<i4').tobytes()
+        qv = new_variable((PARAM_WORDS + 2 * layer.channels,), TYPE_FLOAT,
+                          param)
+
+        inputs = w.append_list([f.inputs[0], wv.index, bv.index, qv.index])
+        w.patch(f.offset, 'HH', f.type, DNNRT_IMPLEMENT_QINT8)
+        w.patch_list(f.offset + 4, inputs)
+        if layer.relu:
+            w.patch(f.outputs_pos, 'i', layer.y)
+
+    # functions without folded ReLU, and added variables
+
+    functions = [f.offset for f in nnb.functions
+                 if f.index not in plan.folded]
+    w.patch_list(8 + 8 * NETWORK_LISTS.index('functions'),
+                 w.append_list(functions))
+    w.patch_list(8 + 8 * NETWORK_LISTS.index('variables'),
+                 w.append_list([v.offset for v in variables]))
+
+    # memory blocks in order of variables, unused ones are dropped
+
+    data = []
+    for v in variables:
+        if v.data_index < 0:
+            continue
+        if v.index in blocks:
+            block = blocks[v.index]
+        else:
+            pos = nnb.blocks[v.data_index]
+            size = v.size * (4 if v.type == TYPE_FLOAT else
+                             2 if v.type == TYPE_INT16 else 1)
+            block = bytes(nnb.data[pos:pos + size])
+        w.patch(v.offset + 12, 'i', len(data))
+        data.append(block)
+
+    offsets_pos = w.append('%di' % len(data), *([0] * len(data)))
+    w.patch_list(8 + 8 * NETWORK_LISTS.index('memory_blocks'),
+                 (len(data), offsets_pos))
+    w.align(16)
+    for (i, block) in enumerate(data):
+        w.patch(offsets_pos + i * 4, 'i', len(w.data))
+        w.data += block
+        w.align(4)
+
+    return bytes(w.data)
+
+############################################################################
+# report
+
+def load_samples(nnb, paths):
+    if not paths:
+        return None
+    if len(paths) != len(nnb.inputs):
+        fail('%d npy files are needed for the inputs' % len(nnb.inputs))
+    samples = []
+    for (vid, path) in zip(nnb.inputs, paths):
+        shape = nnb.variables[vid].shape
+        x = np.load(path).astype(np.float32).reshape((-1,) + shape)
+        samples.append(x)
+    num = min(len(x) for x in samples)
+    return [[x[i] for x in samples] for i in range(num)]
+
+def layer_macs(nnb, f):
+    y = nnb.variables[f.outputs[0]]
+    w = nnb.variables[f.inputs[1]]
+    if f.type == AFFINE:
+        return w.size * int(np.prod(y.shape[:f.base_axis]))
+    per_out = w.size // y.shape[channel_axis(f)]
+    return y.size * per_out
+
+def report(nnb, plan, samples):
+    print('layer function       x     y        MACs  weight bytes')
+    for f in nnb.functions:
+        if f.index in plan.folded:
+            print('%5d %-12s folded' % (f.index, f.name))
+            continue
+        if f.type not in QUANTIZED:
+            continue
+        wbytes = nnb.variables[f.inputs[1]].size * 4
+        if f.index in plan.layers:
+            layer = plan.layers[f.index]
+            x = 'int8' if f.inputs[0] in plan.int8 else 'float'
+            y = 'int8' if layer.y in plan.int8 else 'float'
+            print('%5d %-12s %-5s %-5s %11d  %d -> %d'
+                  % (f.index, f.name, x, y, layer_macs(nnb, f), wbytes,
+                     wbytes // 4))
+        else:
+            print('%5d %-12s float float %11d  %d'
+                  % (f.index, f.name, layer_macs(nnb, f), wbytes))
+
+    ref = [run_float(nnb, s) for s in samples]
+    out = [run_int8(nnb, plan, s) for s in samples]
+    for i in range(len(nnb.outputs)):
+        r = np.array([o[i] for o in ref]).reshape(len(samples), -1)
+        q = np.array([o[i] for o in out]).astype(np.float64)
+        q = q.reshape(len(samples), -1)
+        err = q - r
+        noise = np.mean(err ** 2)
+        sqnr = 10 * np.log10(np.mean(r ** 2) / noise) if noise > 0 \
+            else float('inf')
+        top1 = np.mean(np.argmax(r, axis=1) == np.argmax(q, axis=1))
+        print('output %d: max |err| %.6f, rms err %.6f, SQNR %.1f dB, '
+              'top-1 agreement %.1f%% (%d samples)'
+              % (i, np.max(np.abs(err)), np.sqrt(noise), sqnr, top1 * 100,
+                 len(samples)))
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Quantize a float nnb for dnnrt to int8 per channel')
+    parser.add_argument('-c', dest='calib', action='append', required=True,
+                        help='calibration data of an input (npy)')
+    parser.add_argument('-e', dest='eval', action='append',
+                        help='evaluation data of an input (npy)')
+    parser.add_argument('-k', dest='keep', action='append', type=int,
+                        default=[], help='index of a layer kept float')
+    parser.add_argument('-o', dest='output', help='output nnb')
+    parser.add_argument('nnb', help='float nnb')
+    args = parser.parse_args()
+
+    with open(args.nnb, 'rb') as f:
+        nnb = Nnb(f.read())
+    for v in nnb.variables:
+        if v.type != TYPE_FLOAT:
+            fail('%s is not a float nnb' % args.nnb)
+
+    ranges = {}
+
+    def observe(vid, y):
+        (lo, hi) = ranges.get(vid, (0.0, 0.0))
+        ranges[vid] = (min(lo, float(y.min())), max(hi, float(y.max())))
+
+    calib = load_samples(nnb, args.calib)
+    for s in calib:
+        for (vid, x) in zip(nnb.inputs, s):
+            observe(vid, x)
+        run_float(nnb, s, observe)
+
+    plan = make_plan(nnb, set(args.keep), ranges)
+    report(nnb, plan, load_samples(nnb, args.eval) or calib)
+
+    if args.output:
+        data = write_nnb(nnb, plan)
+        with open(args.output, 'wb') as f:
+            f.write(data)
+        print('%s: %d bytes -> %s: %d bytes'
+              % (args.nnb, len(nnb.data), args.output, len(data)))
+
+if __name__ == '__main__':
+    main()